@@ -0,0 +1,161 @@
+/* *****************************************************************************
+Performance Tests: HTTP Router
+
+Routes requests through 1,000 routes (static, `:param` and `*wildcard` routes)
+and reports lookups per second and the memory used by the routing tree.
+
+These tests are skipped in DEBUG mode. Run with: make benchmark/http-router
+***************************************************************************** */
+
+#define FIO_HTTP
+#include "tests/test-helpers.h"
+
+/* Skip all performance tests in DEBUG mode */
+#ifdef DEBUG
+int main(void) {
+  FIO_LOG_INFO("Performance tests skipped in DEBUG mode");
+  return 0;
+}
+#else
+
+/* number of routes (must be a multiple of 10) */
+#define FIO___BENCH_ROUTER_ROUTES 1000
+/* number of lookups performed by each benchmark round */
+#define FIO___BENCH_ROUTER_LOOKUPS (1UL << 22)
+
+/* *****************************************************************************
+Helpers
+***************************************************************************** */
+
+FIO_SFUNC void fio___bench_router_on_http(fio_http_s *h) { (void)h; }
+
+/* memory used by the routing tree, excluding the (embedded) root node */
+FIO_SFUNC size_t fio___bench_router_memory(fio___http_router_s *r,
+                                           size_t *nodes) {
+  size_t r_mem = fio_bstr_len(r->edge) + sizeof(size_t) * 2 + 1;
+  r_mem += r->kids_len * (sizeof(*r->kids) + sizeof(*r->keys));
+  for (size_t i = 0; i < r->kids_len; ++i)
+    r_mem += sizeof(*r) + fio___bench_router_memory(r->kids[i], nodes);
+  if (r->param)
+    r_mem += sizeof(*r) + fio___bench_router_memory(r->param, nodes);
+  if (r->wildcard)
+    r_mem += sizeof(*r) + fio___bench_router_memory(r->wildcard, nodes);
+  ++nodes[0];
+  return r_mem;
+}
+
+/* *****************************************************************************
+Benchmarks
+***************************************************************************** */
+
+FIO_SFUNC void fio___bench_router_lookups(fio___http_router_s *router,
+                                          char **paths,
+                                          size_t count,
+                                          const char *name,
+                                          int capture) {
+  size_t routed = 0;
+  fio_http_s *h = capture ? fio_http_new() : NULL;
+  uint64_t start = fio_time_micro();
+  for (size_t i = 0; i < FIO___BENCH_ROUTER_LOOKUPS; ++i) {
+    fio_str_info_s path = FIO_STR_INFO1(paths[i % count]);
+    fio_http_settings_s *s = fio___http_route_settings(router, &path, h);
+    routed += (s != &router->s);
+    FIO_COMPILER_GUARD;
+  }
+  uint64_t end = fio_time_micro();
+  FIO_ASSERT(routed == FIO___BENCH_ROUTER_LOOKUPS,
+             "all lookups should match a route (%zu / %zu)",
+             routed,
+             (size_t)FIO___BENCH_ROUTER_LOOKUPS);
+  fio_http_free(h);
+  fprintf(stderr,
+          "\t\t%-32s %8.2f M lookups/sec\n",
+          name,
+          (double)FIO___BENCH_ROUTER_LOOKUPS / (end - start + !(end - start)));
+}
+
+/* *****************************************************************************
+Main Entry Point
+***************************************************************************** */
+
+int main(void) {
+  char buf[128];
+  char *static_paths[FIO___BENCH_ROUTER_ROUTES / 2];
+  char *param_paths[FIO___BENCH_ROUTER_ROUTES / 2];
+  size_t nodes = 0;
+
+  fprintf(stderr, "===========================================\n");
+  fprintf(stderr, "Performance Tests: HTTP Router\n");
+  fprintf(stderr, "===========================================\n\n");
+
+  fio_http_listener_s *l =
+      fio_http_listen("tcp://127.0.0.1:0",
+                      .on_http = fio___bench_router_on_http);
+  FIO_ASSERT(l, "couldn't create an HTTP listener");
+  fio___http_protocol_s *p =
+      FIO_PTR_FROM_FIELD(fio___http_protocol_s,
+                         state[FIO___HTTP_PROTOCOL_ACCEPT].protocol,
+                         fio_io_listener_protocol((fio_io_listener_s *)l));
+
+  /* 500 static routes, 400 parameter routes and 100 wildcard routes */
+  for (size_t i = 0; i < FIO___BENCH_ROUTER_ROUTES / 2; ++i) {
+    snprintf(buf, sizeof(buf), "/docs/section%zu/page%zu", i / 10, i);
+    FIO_ASSERT(!fio_http_route(l, buf), "route error: %s", buf);
+    static_paths[i] = fio_bstr_write(NULL, buf, strlen(buf));
+  }
+  for (size_t i = 0; i < FIO___BENCH_ROUTER_ROUTES / 2; ++i) {
+    const size_t kind = i % 5;
+    if (kind == 4) {
+      snprintf(buf, sizeof(buf), "/assets%zu/*file", i);
+      FIO_ASSERT(!fio_http_route(l, buf), "route error: %s", buf);
+      snprintf(buf, sizeof(buf), "/assets%zu/img/logo%zu.png", i, i);
+    } else if (kind & 1) {
+      snprintf(buf, sizeof(buf), "/api/v%zu/res%zu/:id/sub/:sub", kind, i);
+      FIO_ASSERT(!fio_http_route(l, buf), "route error: %s", buf);
+      snprintf(buf, sizeof(buf), "/api/v%zu/res%zu/%zu/sub/x", kind, i, i * 7);
+    } else {
+      snprintf(buf, sizeof(buf), "/api/v%zu/res%zu/:id", kind, i);
+      FIO_ASSERT(!fio_http_route(l, buf), "route error: %s", buf);
+      snprintf(buf, sizeof(buf), "/api/v%zu/res%zu/%zu/extra", kind, i, i * 7);
+    }
+    param_paths[i] = fio_bstr_write(NULL, buf, strlen(buf));
+  }
+
+  size_t mem = fio___bench_router_memory(&p->router, &nodes);
+  fprintf(stderr,
+          "\t* %d routes: %zu tree nodes, ~%zu bytes (%zu bytes / route)\n",
+          FIO___BENCH_ROUTER_ROUTES,
+          nodes,
+          mem,
+          mem / FIO___BENCH_ROUTER_ROUTES);
+
+  fprintf(stderr, "\t* Lookups:\n");
+  fio___bench_router_lookups(&p->router,
+                             static_paths,
+                             FIO___BENCH_ROUTER_ROUTES / 2,
+                             "static routes",
+                             0);
+  fio___bench_router_lookups(&p->router,
+                             param_paths,
+                             FIO___BENCH_ROUTER_ROUTES / 2,
+                             "param / wildcard routes",
+                             0);
+  fio___bench_router_lookups(&p->router,
+                             param_paths,
+                             FIO___BENCH_ROUTER_ROUTES / 2,
+                             "param / wildcard (captured)",
+                             1);
+
+  for (size_t i = 0; i < FIO___BENCH_ROUTER_ROUTES / 2; ++i) {
+    fio_bstr_free(static_paths[i]);
+    fio_bstr_free(param_paths[i]);
+  }
+  fio_io_listen_stop((fio_io_listener_s *)l);
+
+  fprintf(stderr, "\n===========================================\n");
+  fprintf(stderr, "Performance tests complete.\n");
+  fprintf(stderr, "===========================================\n");
+  return 0;
+}
+
+#endif /* DEBUG */
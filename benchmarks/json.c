@@ -0,0 +1,176 @@
+/* *****************************************************************************
+Performance Tests: JSON Parser
+
+Parses a few typical documents (API objects, minified and indented JSON) using
+counting callbacks, so the result reflects the parser rather than allocations.
+
+These tests are skipped in DEBUG mode. Run with: make benchmark/json
+***************************************************************************** */
+
+#define FIO_JSON
+#define FIO_STR
+#include "tests/test-helpers.h"
+
+/* Skip all performance tests in DEBUG mode */
+#ifdef DEBUG
+int main(void) {
+  FIO_LOG_INFO("Performance tests skipped in DEBUG mode");
+  return 0;
+}
+#else
+
+/* number of bytes parsed by each benchmark round */
+#define FIO___BENCH_JSON_BYTES (1ULL << 28)
+
+/* *****************************************************************************
+Parser Callbacks (counting only)
+***************************************************************************** */
+
+static size_t fio___bench_json_count;
+
+static void *fio___bench_json_on_value(void *udata) {
+  ++fio___bench_json_count;
+  return udata;
+}
+static void *fio___bench_json_on_number(void *udata, int64_t i) {
+  ++fio___bench_json_count;
+  return (void)i, udata;
+}
+static void *fio___bench_json_on_float(void *udata, double f) {
+  ++fio___bench_json_count;
+  return (void)f, udata;
+}
+static void *fio___bench_json_on_string(void *udata,
+                                        const void *start,
+                                        size_t len) {
+  ++fio___bench_json_count;
+  return (void)start, (void)len, udata;
+}
+static void *fio___bench_json_on_container(void *udata, void *ctx, void *at) {
+  return (void)ctx, (void)at, udata;
+}
+static int fio___bench_json_map_push(void *udata,
+                                     void *ctx,
+                                     void *key,
+                                     void *value) {
+  return (void)udata, (void)ctx, (void)key, (void)value, 0;
+}
+static int fio___bench_json_array_push(void *udata, void *ctx, void *value) {
+  return (void)udata, (void)ctx, (void)value, 0;
+}
+static void fio___bench_json_free_unused(void *udata, void *ctx) {
+  (void)udata, (void)ctx;
+}
+
+static fio_json_parser_callbacks_s fio___bench_json_callbacks = {
+    .on_null = fio___bench_json_on_value,
+    .on_true = fio___bench_json_on_value,
+    .on_false = fio___bench_json_on_value,
+    .on_number = fio___bench_json_on_number,
+    .on_float = fio___bench_json_on_float,
+    .on_string = fio___bench_json_on_string,
+    .on_string_simple = fio___bench_json_on_string,
+    .on_map = fio___bench_json_on_container,
+    .on_array = fio___bench_json_on_container,
+    .map_push = fio___bench_json_map_push,
+    .array_push = fio___bench_json_array_push,
+    .free_unused_object = fio___bench_json_free_unused,
+};
+
+/* *****************************************************************************
+Benchmarks
+***************************************************************************** */
+
+static const char *fio___bench_json_user =
+    "{\"id\": 1234567, \"name\": \"Jane Doe\", \"email\": "
+    "\"jane.doe@example.com\", \"bio\": \"Writes about \\\"distributed\\\" "
+    "systems, caching and the occasional caf\\u00e9 review. Long strings "
+    "like this one are common in API payloads.\", \"tags\": [\"alpha\", "
+    "\"beta\", \"gamma\"], \"active\": true, \"score\": 12.5, \"manager\": "
+    "null}";
+
+/* writes an array of `count` user objects, `indent` spaces per level. */
+FIO_SFUNC void fio___bench_json_build(fio_str_info_s *dest,
+                                      size_t count,
+                                      size_t indent) {
+  fio_string_write(dest, NULL, "[", 1);
+  for (size_t i = 0; i < count; ++i) {
+    if (i)
+      fio_string_write(dest, NULL, ",", 1);
+    if (indent) {
+      fio_string_write(dest, NULL, "\n", 1);
+      for (size_t n = 0; n < indent; ++n)
+        fio_string_write(dest, NULL, " ", 1);
+    }
+    for (const char *p = fio___bench_json_user; *p; ++p) {
+      /* one member per line: `, "` becomes a new line */
+      if (indent && p[0] == ' ' && p[-1] == ',' && p[1] == '"') {
+        fio_string_write(dest, NULL, "\n", 1);
+        for (size_t n = 0; n < (indent << 1); ++n)
+          fio_string_write(dest, NULL, " ", 1);
+        continue;
+      }
+      fio_string_write(dest, NULL, p, 1);
+    }
+  }
+  if (indent)
+    fio_string_write(dest, NULL, "\n", 1);
+  fio_string_write(dest, NULL, "]", 1);
+}
+
+FIO_SFUNC void fio___bench_json_parse(const char *name,
+                                      size_t count,
+                                      size_t indent) {
+  char *buf = (char *)FIO_MEM_REALLOC(NULL, 0, (1UL << 20), 0);
+  FIO_ASSERT_ALLOC(buf);
+  fio_str_info_s json = FIO_STR_INFO3(buf, 0, (1UL << 20));
+  fio___bench_json_build(&json, count, indent);
+  json.buf[json.len] = 0; /* guard byte */
+  const size_t rounds = (size_t)(FIO___BENCH_JSON_BYTES / json.len) + 1;
+  fio___bench_json_count = 0;
+  uint64_t start = fio_time_micro();
+  for (size_t i = 0; i < rounds; ++i) {
+    fio_json_result_s r = fio_json_parse(&fio___bench_json_callbacks,
+                                         (void *)buf,
+                                         json.buf,
+                                         json.len);
+    FIO_ASSERT(!r.err && r.stop_pos == json.len, "JSON error (%s)", name);
+    FIO_COMPILER_GUARD;
+  }
+  uint64_t end = fio_time_micro();
+  FIO_ASSERT(fio___bench_json_count, "no values parsed");
+  end -= start;
+  end += !end;
+  fprintf(stderr,
+          "\t\t%-28s %9.2f MB/sec %8.2f M values/sec\n",
+          name,
+          (double)(rounds * json.len) / end,
+          (double)fio___bench_json_count / end);
+  FIO_MEM_FREE(buf, (1UL << 20));
+}
+
+/* *****************************************************************************
+Main Entry Point
+***************************************************************************** */
+
+int main(void) {
+  fprintf(stderr, "===========================================\n");
+  fprintf(stderr, "Performance Tests: JSON Parser\n");
+  fprintf(stderr, "===========================================\n\n");
+#if FIO___JSON_INDEX
+  fprintf(stderr, "\t* String / white space index: SIMD\n");
+#else
+  fprintf(stderr, "\t* String / white space index: none (scalar)\n");
+#endif
+  fprintf(stderr, "\t* Parsing (fio_json_parse):\n");
+  fio___bench_json_parse("one object (~300 B)", 1, 0);
+  fio___bench_json_parse("API response (~30 KB)", 100, 0);
+  fio___bench_json_parse("indented (~40 KB)", 100, 4);
+
+  fprintf(stderr, "\n===========================================\n");
+  fprintf(stderr, "Performance tests complete.\n");
+  fprintf(stderr, "===========================================\n");
+  return 0;
+}
+
+#endif /* DEBUG */
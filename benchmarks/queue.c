@@ -0,0 +1,191 @@
+/* *****************************************************************************
+Performance Tests: Task Queue Workers
+
+Compares `fio_queue_workers_add` (a single shared ring and lock) with
+`fio_queue_workers_add_stealing` (per-worker deques and work-stealing) while
+scaling producers and consumers from 1 to 64 threads.
+
+These tests are skipped in DEBUG mode. Run with: make benchmark/queue
+***************************************************************************** */
+
+#define FIO_LOG
+#define FIO_TIME
+#define FIO_RAND
+#define FIO_QUEUE
+#include "tests/test-helpers.h"
+
+/* Skip all performance tests in DEBUG mode */
+#ifdef DEBUG
+int main(void) {
+  FIO_LOG_INFO("Performance tests skipped in DEBUG mode");
+  return 0;
+}
+#else
+
+/* tasks performed by each benchmark round */
+#define FIO___BENCH_QUEUE_TASKS (1UL << 20)
+/* maximum number of threads (producers or consumers) */
+#define FIO___BENCH_QUEUE_THREADS 64
+
+/* *****************************************************************************
+Sharded completion counter (avoids measuring a single contended counter)
+***************************************************************************** */
+
+typedef struct {
+  volatile size_t count;
+  uint8_t padding_[64 - sizeof(size_t)];
+} fio___bench_queue_counter_s;
+
+static fio___bench_queue_counter_s
+    fio___bench_queue_done[FIO___BENCH_QUEUE_THREADS + 1];
+static volatile size_t fio___bench_queue_shards;
+static __thread size_t fio___bench_queue_shard;
+
+FIO_IFUNC void fio___bench_queue_mark_done(void) {
+  if (!fio___bench_queue_shard)
+    fio___bench_queue_shard =
+        1 + (fio_atomic_add(&fio___bench_queue_shards, 1) %
+             FIO___BENCH_QUEUE_THREADS);
+  fio_atomic_add(&fio___bench_queue_done[fio___bench_queue_shard].count, 1);
+}
+
+FIO_SFUNC size_t fio___bench_queue_total(void) {
+  size_t r = 0;
+  for (size_t i = 0; i <= FIO___BENCH_QUEUE_THREADS; ++i) {
+    size_t tmp;
+    fio_atomic_load(tmp, &fio___bench_queue_done[i].count);
+    r += tmp;
+  }
+  return r;
+}
+
+FIO_SFUNC void fio___bench_queue_reset(void) {
+  for (size_t i = 0; i <= FIO___BENCH_QUEUE_THREADS; ++i)
+    fio___bench_queue_done[i].count = 0;
+}
+
+/* *****************************************************************************
+Tasks and producers
+***************************************************************************** */
+
+/* a tiny unit of work */
+FIO_SFUNC void fio___bench_queue_task(void *ignr1, void *ignr2) {
+  fio___bench_queue_mark_done();
+  (void)ignr1, (void)ignr2;
+}
+
+/* fork-join: each task spawns two children until `depth` reaches zero */
+FIO_SFUNC void fio___bench_queue_spawn(void *q_, void *depth_) {
+  uintptr_t depth = (uintptr_t)depth_;
+  fio___bench_queue_mark_done();
+  if (!depth--)
+    return;
+  fio_queue_push((fio_queue_s *)q_, fio___bench_queue_spawn, q_, (void *)depth);
+  fio_queue_push((fio_queue_s *)q_, fio___bench_queue_spawn, q_, (void *)depth);
+}
+
+typedef struct {
+  fio_queue_s *q;
+  size_t tasks;
+} fio___bench_queue_producer_s;
+
+FIO_SFUNC void *fio___bench_queue_producer(void *p_) {
+  fio___bench_queue_producer_s *p = (fio___bench_queue_producer_s *)p_;
+  for (size_t i = 0; i < p->tasks; ++i)
+    fio_queue_push(p->q, fio___bench_queue_task);
+  return NULL;
+}
+
+/* *****************************************************************************
+Benchmarks
+***************************************************************************** */
+
+FIO_SFUNC uint64_t fio___bench_queue_wait(size_t expected) {
+  while (fio___bench_queue_total() < expected)
+    FIO_THREAD_RESCHEDULE();
+  return fio_time_micro();
+}
+
+/* producers push from outside of the queue's workers */
+FIO_SFUNC void fio___bench_queue_producers(size_t producers,
+                                           size_t consumers,
+                                           int steal) {
+  fio_queue_s q = FIO_QUEUE_STATIC_INIT(q);
+  fio_thread_t threads[FIO___BENCH_QUEUE_THREADS];
+  fio___bench_queue_producer_s info = {
+      .q = &q,
+      .tasks = FIO___BENCH_QUEUE_TASKS / producers,
+  };
+  const size_t expected = info.tasks * producers;
+  uint64_t start, end;
+  fio___bench_queue_reset();
+  if (steal)
+    fio_queue_workers_add_stealing(&q, consumers);
+  else
+    fio_queue_workers_add(&q, consumers);
+  start = fio_time_micro();
+  for (size_t i = 0; i < producers; ++i)
+    fio_thread_create(threads + i, fio___bench_queue_producer, &info);
+  for (size_t i = 0; i < producers; ++i)
+    fio_thread_join(threads + i);
+  end = fio___bench_queue_wait(expected);
+  fio_queue_workers_join(&q);
+  fio_queue_destroy(&q);
+  fprintf(stderr,
+          "\t\t%-10s %2zu producers, %2zu consumers: %8.2f M tasks/sec\n",
+          (steal ? "stealing" : "shared"),
+          producers,
+          consumers,
+          (double)expected / (end - start + !(end - start)));
+}
+
+/* tasks push their own sub-tasks (the work-stealing sweet spot) */
+FIO_SFUNC void fio___bench_queue_fork_join(size_t consumers, int steal) {
+  fio_queue_s q = FIO_QUEUE_STATIC_INIT(q);
+  const uintptr_t depth = 19; /* (2^20 - 1) tasks */
+  const size_t expected = ((size_t)2 << depth) - 1;
+  uint64_t start, end;
+  fio___bench_queue_reset();
+  if (steal)
+    fio_queue_workers_add_stealing(&q, consumers);
+  else
+    fio_queue_workers_add(&q, consumers);
+  start = fio_time_micro();
+  fio_queue_push(&q, fio___bench_queue_spawn, &q, (void *)depth);
+  end = fio___bench_queue_wait(expected);
+  fio_queue_workers_join(&q);
+  fio_queue_destroy(&q);
+  fprintf(stderr,
+          "\t\t%-10s fork-join, %2zu consumers:  %8.2f M tasks/sec\n",
+          (steal ? "stealing" : "shared"),
+          consumers,
+          (double)expected / (end - start + !(end - start)));
+}
+
+/* *****************************************************************************
+Main Entry Point
+***************************************************************************** */
+
+int main(void) {
+  fprintf(stderr, "===========================================\n");
+  fprintf(stderr, "Performance Tests: Task Queue Workers\n");
+  fprintf(stderr, "===========================================\n\n");
+
+  fprintf(stderr, "\t* External producers (shared ring):\n");
+  for (size_t threads = 1; threads <= FIO___BENCH_QUEUE_THREADS; threads <<= 1) {
+    fio___bench_queue_producers(threads, threads, 0);
+    fio___bench_queue_producers(threads, threads, 1);
+  }
+  fprintf(stderr, "\t* Tasks scheduling tasks (fork-join):\n");
+  for (size_t threads = 1; threads <= FIO___BENCH_QUEUE_THREADS; threads <<= 1) {
+    fio___bench_queue_fork_join(threads, 0);
+    fio___bench_queue_fork_join(threads, 1);
+  }
+
+  fprintf(stderr, "\n===========================================\n");
+  fprintf(stderr, "Performance tests complete.\n");
+  fprintf(stderr, "===========================================\n");
+  return 0;
+}
+
+#endif /* DEBUG */
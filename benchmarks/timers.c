@@ -0,0 +1,230 @@
+/* *****************************************************************************
+Performance Tests: Timer Queue
+
+Compares the hierarchical timing wheel behind `fio_timer_queue_s` with the
+sorted linked list it replaced, at 1K, 100K and 1M pending timers.
+
+These tests are skipped in DEBUG mode. Run with: make benchmark/timers
+***************************************************************************** */
+
+#define FIO_LOG
+#define FIO_TIME
+#define FIO_RAND
+#define FIO_QUEUE
+#include "tests/test-helpers.h"
+
+/* Skip all performance tests in DEBUG mode */
+#ifdef DEBUG
+int main(void) {
+  FIO_LOG_INFO("Performance tests skipped in DEBUG mode");
+  return 0;
+}
+#else
+
+/* timers are spread across one minute, like connection timeouts */
+#define FIO___BENCH_TIMER_SPREAD 60000
+/* milliseconds advanced by the tick benchmark */
+#define FIO___BENCH_TIMER_TICKS 1024
+
+/* *****************************************************************************
+Reference: the sorted linked list (previous implementation)
+***************************************************************************** */
+
+typedef struct fio___bench_list_timer_s {
+  struct fio___bench_list_timer_s *next;
+  void (*fn)(void *, void *);
+  void *udata1;
+  void *udata2;
+  int64_t due;
+} fio___bench_list_timer_s;
+
+typedef struct {
+  fio___bench_list_timer_s *next;
+  fio_lock_i lock;
+} fio___bench_list_s;
+
+FIO_SFUNC void fio___bench_list_schedule(fio___bench_list_s *l,
+                                         void (*fn)(void *, void *),
+                                         void *udata1,
+                                         int64_t due) {
+  fio___bench_list_timer_s *t =
+      (fio___bench_list_timer_s *)malloc(sizeof(*t));
+  FIO_ASSERT_ALLOC(t);
+  *t = (fio___bench_list_timer_s){.fn = fn, .udata1 = udata1, .due = due};
+  fio_lock(&l->lock);
+  fio___bench_list_timer_s **pos = &l->next;
+  while (*pos && t->due >= (*pos)->due)
+    pos = &((*pos)->next);
+  t->next = *pos;
+  *pos = t;
+  fio_unlock(&l->lock);
+}
+
+FIO_SFUNC size_t fio___bench_list_push2queue(fio_queue_s *q,
+                                             fio___bench_list_s *l,
+                                             int64_t now) {
+  size_t r = 0;
+  fio___bench_list_timer_s *t;
+  fio_lock(&l->lock);
+  t = l->next;
+  while (l->next && l->next->due <= now)
+    l->next = l->next->next;
+  fio_unlock(&l->lock);
+  while (t && t->due <= now) {
+    fio___bench_list_timer_s *tmp = t;
+    t = t->next;
+    fio_queue_push(q, tmp->fn, tmp->udata1, tmp->udata2);
+    free(tmp);
+    ++r;
+  }
+  return r;
+}
+
+FIO_SFUNC void fio___bench_list_destroy(fio___bench_list_s *l) {
+  while (l->next) {
+    fio___bench_list_timer_s *t = l->next;
+    l->next = t->next;
+    free(t);
+  }
+}
+
+/* sorting dues builds a large list without the O(n^2) insertion cost */
+FIO_SFUNC int fio___bench_int64_cmp(const void *a, const void *b) {
+  const int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+  return (x > y) - (x < y);
+}
+
+/* *****************************************************************************
+Benchmarks
+***************************************************************************** */
+
+static size_t fio___bench_timer_fired;
+FIO_SFUNC int fio___bench_timer_task(void *a, void *b) {
+  ++fio___bench_timer_fired;
+  return 0;
+  (void)a, (void)b;
+}
+
+FIO_SFUNC void fio___bench_list_task(void *a, void *b) {
+  ++fio___bench_timer_fired;
+  (void)a, (void)b;
+}
+
+FIO_SFUNC void fio___bench_timer_report(const char *name,
+                                        size_t ops,
+                                        uint64_t elapsed) {
+  if (!elapsed)
+    elapsed = 1;
+  fprintf(stderr,
+          "\t\t%-40s: %8.2f M ops/sec (%llu us, %zu ops)\n",
+          name,
+          (double)ops / elapsed,
+          (unsigned long long)elapsed,
+          ops);
+}
+
+FIO_SFUNC void fio___bench_timers(size_t pending) {
+  const int64_t start_at = 1000000;
+  /* the list's insert cost is O(n), limit the work for large lists */
+  const size_t inserts = pending > 1024 ? (1048576 / (pending >> 10)) : 1024;
+  int64_t *dues = (int64_t *)malloc(sizeof(*dues) * (pending + inserts));
+  FIO_ASSERT_ALLOC(dues);
+  for (size_t i = 0; i < pending + inserts; ++i)
+    dues[i] = start_at + 1 + (int64_t)(fio_rand64() % FIO___BENCH_TIMER_SPREAD);
+  fprintf(stderr, "\t* %zu pending timers\n", pending);
+
+  /* timing wheel */
+  {
+    fio_queue_s q = FIO_QUEUE_STATIC_INIT(q);
+    fio_timer_queue_s w = FIO_TIMER_QUEUE_INIT;
+    uint64_t start;
+    size_t fired = 0;
+    for (size_t i = 0; i < pending; ++i)
+      fio_timer_free(fio_timer_schedule(&w,
+                                        .fn = fio___bench_timer_task,
+                                        .every = (uint32_t)(dues[i] - start_at),
+                                        .start_at = start_at));
+    start = fio_time_micro();
+    for (size_t i = pending; i < pending + inserts; ++i)
+      fio_timer_free(fio_timer_schedule(&w,
+                                        .fn = fio___bench_timer_task,
+                                        .every = (uint32_t)(dues[i] - start_at),
+                                        .start_at = start_at));
+    fio___bench_timer_report("timing wheel: schedule",
+                             inserts,
+                             fio_time_micro() - start);
+    start = fio_time_micro();
+    for (int64_t t = 1; t <= FIO___BENCH_TIMER_TICKS; ++t) {
+      fired += fio_timer_push2queue(&q, &w, start_at + t);
+      fio_queue_perform_all(&q);
+    }
+    fio___bench_timer_report("timing wheel: tick + fire",
+                             fired,
+                             fio_time_micro() - start);
+    start = fio_time_micro();
+    for (int64_t t = 1; t <= FIO___BENCH_TIMER_TICKS; ++t) {
+      (void)fio_timer_next_at(&w);
+      FIO_COMPILER_GUARD;
+    }
+    fio___bench_timer_report("timing wheel: fio_timer_next_at",
+                             FIO___BENCH_TIMER_TICKS,
+                             fio_time_micro() - start);
+    fio_timer_destroy(&w);
+    fio_queue_destroy(&q);
+  }
+
+  /* sorted linked list */
+  {
+    fio_queue_s q = FIO_QUEUE_STATIC_INIT(q);
+    fio___bench_list_s l = {.lock = FIO_LOCK_INIT};
+    fio___bench_list_timer_s **pos = &l.next;
+    uint64_t start;
+    size_t fired = 0;
+    qsort(dues, pending, sizeof(*dues), fio___bench_int64_cmp);
+    for (size_t i = 0; i < pending; ++i) {
+      *pos = (fio___bench_list_timer_s *)malloc(sizeof(**pos));
+      FIO_ASSERT_ALLOC(*pos);
+      **pos = (fio___bench_list_timer_s){.fn = fio___bench_list_task,
+                                         .due = dues[i]};
+      pos = &((*pos)->next);
+    }
+    start = fio_time_micro();
+    for (size_t i = pending; i < pending + inserts; ++i)
+      fio___bench_list_schedule(&l, fio___bench_list_task, NULL, dues[i]);
+    fio___bench_timer_report("sorted list: schedule",
+                             inserts,
+                             fio_time_micro() - start);
+    start = fio_time_micro();
+    for (int64_t t = 1; t <= FIO___BENCH_TIMER_TICKS; ++t) {
+      fired += fio___bench_list_push2queue(&q, &l, start_at + t);
+      fio_queue_perform_all(&q);
+    }
+    fio___bench_timer_report("sorted list: tick + fire",
+                             fired,
+                             fio_time_micro() - start);
+    fio___bench_list_destroy(&l);
+    fio_queue_destroy(&q);
+  }
+  free(dues);
+}
+
+/* *****************************************************************************
+Main Entry Point
+***************************************************************************** */
+
+int main(void) {
+  fprintf(stderr, "===========================================\n");
+  fprintf(stderr, "Performance Tests: Timer Queue\n");
+  fprintf(stderr, "===========================================\n\n");
+
+  fio___bench_timers(1000);
+  fio___bench_timers(100000);
+  fio___bench_timers(1000000);
+
+  fprintf(stderr, "\n===========================================\n");
+  fprintf(stderr, "Performance tests complete.\n");
+  fprintf(stderr, "===========================================\n");
+  return 0;
+}
+
+#endif /* DEBUG */
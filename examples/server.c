@@ -198,17 +198,18 @@ int main(int argc, char const *argv[]) {
 
   /* schedule heartbeat */
   if (fio_cli_get_i("-ph"))
-    fio_io_run_every(.every = (fio_cli_get_i("-ph") * 1000),
-                     .fn = heartbeat,
-                     .udata1 = (void *)(uintptr_t)fio_cli_get_bool("-phw"),
-                     .repetitions = -1);
+    fio_timer_free(
+        fio_io_run_every(.every = (fio_cli_get_i("-ph") * 1000),
+                         .fn = heartbeat,
+                         .udata1 = (void *)(uintptr_t)fio_cli_get_bool("-phw"),
+                         .repetitions = -1));
 
   /* schedule server stop */
   if (fio_cli_get_i("-stop"))
-    fio_io_run_every(.every = (fio_cli_get_i("-stop") * 1000),
-                     .fn = autostop,
-                     .udata1 = NULL,
-                     .repetitions = -1);
+    fio_timer_free(fio_io_run_every(.every = (fio_cli_get_i("-stop") * 1000),
+                                    .fn = autostop,
+                                    .udata1 = NULL,
+                                    .repetitions = -1));
 
   if (fio_cli_get_bool("-C")) { /* container - place pub/sub socket in tmp */
     char *u = (char *)fio_ipc_url();
@@ -360,6 +360,8 @@ FIO_MAP Ordering & Naming Shortcut
 #if defined(FIO_HTTP)
 #undef FIO_HTTP1_PARSER
 #define FIO_HTTP1_PARSER
+#undef FIO_HTTP2_PARSER
+#define FIO_HTTP2_PARSER
 #endif
 
 #if defined(FIO_HTTP)
@@ -185,6 +185,182 @@ static int fio_http1___finish(fio_http1_parser_s *p,
   return 1;
 }
 
+/* *****************************************************************************
+Line Scanner
+***************************************************************************** */
+
+/* a scanned line: its `'\n'` and the first two separator bytes (or NULL). */
+typedef struct {
+  char *eol;
+  char *sep[2];
+} fio_http1___line_s;
+
+/* the first control byte of a line must be a LF or a CR LF sequence. */
+FIO_IFUNC int fio_http1___scan_line_end(fio_http1___line_s *l,
+                                        char *pos,
+                                        char *end) {
+  if (*pos == '\n')
+    goto found;
+  if (*pos != '\r')
+    return -1;
+  if (++pos == end)
+    return 1;
+  if (*pos != '\n')
+    return -1;
+found:
+  l->eol = pos;
+  return 0;
+}
+
+/* scans byte by byte, see `fio_http1___scan_line_scalar` (keeps `l->sep`). */
+FIO_IFUNC int fio_http1___scan_line_tail(fio_http1___line_s *l,
+                                         char *pos,
+                                         char *end,
+                                         char sep) {
+  for (; pos < end; ++pos) {
+    const uint8_t c = (uint8_t)*pos;
+    if (FIO_UNLIKELY((c < 0x20 && c != '\t') || c == 0x7F))
+      return fio_http1___scan_line_end(l, pos, end);
+    if (c != (uint8_t)sep)
+      continue;
+    if (!l->sep[0])
+      l->sep[0] = pos;
+    else if (!l->sep[1])
+      l->sep[1] = pos;
+  }
+  return 1;
+}
+
+/*
+ * Scans a line in a single pass, locating its end and the first two `sep`
+ * bytes, while rejecting control bytes (other than HTAB and the line's CR LF).
+ *
+ * Returns 0 if a line was found, 1 if more data is required and -1 on error.
+ */
+FIO_SFUNC int fio_http1___scan_line_scalar(fio_http1___line_s *l,
+                                           char *pos,
+                                           char *end,
+                                           char sep) {
+  l->sep[0] = l->sep[1] = NULL;
+  return fio_http1___scan_line_tail(l, pos, end, sep);
+}
+
+/*
+ * Classifies 32 bytes, setting a bit per control / `sep` byte in the masks.
+ *
+ * HTAB is marked as a control byte (it's rare), the scanner skips it.
+ */
+#if defined(FIO___HAS_X86_INTRIN) && defined(__AVX2__)
+#define FIO___HTTP1_SCAN_SIMD 1
+FIO_IFUNC void fio_http1___classify32(const char *p,
+                                      char sep,
+                                      uint32_t *ctl,
+                                      uint32_t *seps) {
+  const __m256i v = _mm256_loadu_si256((const __m256i *)p);
+  const __m256i c = /* v <= 0x1F || v == 0x7F */
+      _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_subs_epu8(v, _mm256_set1_epi8(0x1F)),
+                                        _mm256_setzero_si256()),
+                      _mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x7F)));
+  *ctl = (uint32_t)_mm256_movemask_epi8(c);
+  *seps = (uint32_t)_mm256_movemask_epi8(
+      _mm256_cmpeq_epi8(v, _mm256_set1_epi8(sep)));
+}
+#elif defined(FIO___HAS_X86_INTRIN) && defined(__SSE2__)
+#define FIO___HTTP1_SCAN_SIMD 1
+FIO_IFUNC void fio_http1___classify32(const char *p,
+                                      char sep,
+                                      uint32_t *ctl,
+                                      uint32_t *seps) {
+  const __m128i vsep = _mm_set1_epi8(sep);
+  const __m128i v1f = _mm_set1_epi8(0x1F);
+  const __m128i vdel = _mm_set1_epi8(0x7F);
+  const __m128i zero = _mm_setzero_si128();
+  __m128i v[2], c[2];
+  v[0] = _mm_loadu_si128((const __m128i *)p);
+  v[1] = _mm_loadu_si128((const __m128i *)(p + 16));
+  for (size_t i = 0; i < 2; ++i) { /* v <= 0x1F || v == 0x7F */
+    c[i] = _mm_or_si128(_mm_cmpeq_epi8(_mm_subs_epu8(v[i], v1f), zero),
+                        _mm_cmpeq_epi8(v[i], vdel));
+    v[i] = _mm_cmpeq_epi8(v[i], vsep);
+  }
+  *ctl = (uint32_t)_mm_movemask_epi8(c[0]) |
+         ((uint32_t)_mm_movemask_epi8(c[1]) << 16);
+  *seps = (uint32_t)_mm_movemask_epi8(v[0]) |
+          ((uint32_t)_mm_movemask_epi8(v[1]) << 16);
+}
+#elif defined(FIO___HAS_ARM_INTRIN) && defined(__aarch64__)
+#define FIO___HTTP1_SCAN_SIMD 1
+/* collects the (0x00 / 0xFF) bytes of two vectors into a 32 bit mask. */
+FIO_IFUNC uint32_t fio_http1___neon_mask32(uint8x16_t m0, uint8x16_t m1) {
+  const uint8x16_t bits =
+      {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+  m0 = vpaddq_u8(vandq_u8(m0, bits), vandq_u8(m1, bits));
+  m0 = vpaddq_u8(m0, m0);
+  m0 = vpaddq_u8(m0, m0);
+  return vgetq_lane_u32(vreinterpretq_u32_u8(m0), 0);
+}
+FIO_IFUNC void fio_http1___classify32(const char *p,
+                                      char sep,
+                                      uint32_t *ctl,
+                                      uint32_t *seps) {
+  const uint8x16_t vsep = vdupq_n_u8((uint8_t)sep);
+  const uint8x16_t v1f = vdupq_n_u8(0x1F);
+  const uint8x16_t vdel = vdupq_n_u8(0x7F);
+  uint8x16_t c[2], s[2];
+  for (size_t i = 0; i < 2; ++i) { /* v <= 0x1F || v == 0x7F */
+    uint8x16_t v = vld1q_u8((const uint8_t *)p + (i << 4));
+    c[i] = vorrq_u8(vcleq_u8(v, v1f), vceqq_u8(v, vdel));
+    s[i] = vceqq_u8(v, vsep);
+  }
+  *ctl = fio_http1___neon_mask32(c[0], c[1]);
+  *seps = fio_http1___neon_mask32(s[0], s[1]);
+}
+#endif
+
+#if FIO___HTTP1_SCAN_SIMD
+/* records the first two separators (`seps` bits set relative to `base`). */
+FIO_IFUNC void fio_http1___scan_seps(fio_http1___line_s *l,
+                                     char *base,
+                                     uint32_t seps) {
+  if (!l->sep[0]) {
+    l->sep[0] = base + fio_lsb_index_unsafe(seps);
+    if (!(seps &= seps - 1))
+      return;
+  }
+  if (!l->sep[1])
+    l->sep[1] = base + fio_lsb_index_unsafe(seps);
+}
+
+/* SIMD variant of `fio_http1___scan_line_scalar`, 32 bytes at a time. */
+FIO_IFUNC int fio_http1___scan_line_simd(fio_http1___line_s *l,
+                                         char *pos,
+                                         char *end,
+                                         char sep) {
+  l->sep[0] = l->sep[1] = NULL;
+  for (; end - pos >= 32; pos += 32) {
+    uint32_t ctl, seps;
+    fio_http1___classify32(pos, sep, &ctl, &seps);
+    while (ctl) {
+      char *c = pos + fio_lsb_index_unsafe(ctl);
+      if (FIO_UNLIKELY(*c == '\t')) { /* HTAB is allowed */
+        ctl &= ctl - 1;
+        continue;
+      }
+      if ((seps &= (ctl & (0 - ctl)) - 1)) /* separators before `c` */
+        fio_http1___scan_seps(l, pos, seps);
+      return fio_http1___scan_line_end(l, c, end);
+    }
+    if (seps)
+      fio_http1___scan_seps(l, pos, seps);
+  }
+  /* don't read past the end of the buffer */
+  return fio_http1___scan_line_tail(l, pos, end, sep);
+}
+#define fio_http1___scan_line fio_http1___scan_line_simd
+#else
+#define fio_http1___scan_line fio_http1___scan_line_scalar
+#endif
+
 /* *****************************************************************************
 Reading the first line
 ***************************************************************************** */
@@ -199,8 +375,8 @@ static int fio_http1___start(fio_http1_parser_s *p,
       (fio_buf2u64u("OPTIONS ") | (uint64_t)0x2020202020202020ULL);
   /* find line start/end and test */
   fio_buf_info_s wrd[3];
+  fio_http1___line_s line;
   char *start = buf->buf;
-  char *tmp;
   while (start < buf->buf + buf->len &&
          (start[0] == ' ' || start[0] == '\r' || start[0] == '\n'))
     ++start; /* skip white space */
@@ -208,15 +384,13 @@ static int fio_http1___start(fio_http1_parser_s *p,
     buf->buf = start;
     return 1;
   }
-  char *eol =
-      (char *)FIO_MEMCHR(start, '\n', (size_t)((buf->buf + buf->len) - start));
-  if (!eol)
-    return 1;
+  /* find the end of the line and the spaces, testing for `NUL` (etc') */
+  int r = fio_http1___scan_line(&line, start, buf->buf + buf->len, ' ');
+  if (r)
+    return r;
+  char *eol = line.eol;
   if (start + 13 > eol) /* test for minimal data GET HTTP/1 or ### HTTP/1 */
     return -1;
-  /* test for `NUL` in data */
-  if (FIO_MEMCHR(start, 0, (size_t)(eol - start)))
-    return -1;
 
   /* prep next stage */
   buf->len -= (eol - buf->buf) + 1;
@@ -225,14 +399,12 @@ static int fio_http1___start(fio_http1_parser_s *p,
 
   /* parse first line */
   /* request: method path version ; response: version code txt */
-  if (!(tmp = (char *)FIO_MEMCHR(start, ' ', (size_t)(eol - start))))
+  if (!line.sep[1])
     return -1;
-  wrd[0] = FIO_BUF_INFO2(start, (size_t)(tmp - start));
-  start = tmp + 1;
-  if (!(tmp = (char *)FIO_MEMCHR(start, ' ', eol - start)))
-    return -1;
-  wrd[1] = FIO_BUF_INFO2(start, (size_t)(tmp - start));
-  start = tmp + 1;
+  wrd[0] = FIO_BUF_INFO2(start, (size_t)(line.sep[0] - start));
+  start = line.sep[0] + 1;
+  wrd[1] = FIO_BUF_INFO2(start, (size_t)(line.sep[1] - start));
+  start = line.sep[1] + 1;
   if (start >= eol)
     return -1;
   wrd[2] = FIO_BUF_INFO2(start, (size_t)(eol - start));
@@ -386,7 +558,7 @@ static inline int fio_http1___on_trailer(fio_http1_parser_s *p,
 }
 
 /* seeks to the ':' divisor while testing and converting to downcase. */
-static char *fio_http1___seek_header_div(char *p) {
+static char *fio_http1___seek_header_div(char *p, char *end) {
   /* this is the subset of the forbidden chars that allows UTF-8 headers */
   static const _Bool forbidden_name_chars[256] = {
       1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
@@ -402,12 +574,12 @@ static char *fio_http1___seek_header_div(char *p) {
       0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
   FIO_ASSERT(forbidden_name_chars[' '] && forbidden_name_chars['\t'],
              "missing forbidden HTTP Header Name characters");
-  for (;;) {
+  for (; p < end; ++p) {
     if (FIO_UNLIKELY(forbidden_name_chars[((uint8_t)(*p))]))
       return p;
     *p = fio_ct_tolower(*p);
-    ++p;
   }
+  return p;
 }
 
 /* extract header name and value from a line and pass info to handler */
@@ -421,21 +593,35 @@ static inline int fio_http1___read_header_line(
                    void *)) {
   for (;;) {
     char *start = buf->buf;
-    char *eol = (char *)FIO_MEMCHR(start, '\n', buf->len);
-    char *div;
+    char *end = start + buf->len;
+    fio_http1___line_s line;
+    char *eol, *div;
     fio_buf_info_s name, value;
-    if (!eol)
+    int r;
+    if (start == end)
       return 1;
-
-    buf->len -= (eol - buf->buf) + 1;
-    buf->buf = eol + 1;
-    eol -= (eol != start && eol[-1] == '\r');
-    if (FIO_UNLIKELY(eol == start))
+    if (*start == '\r' || *start == '\n') {
+      if ((r = fio_http1___scan_line_end(&line, start, end)))
+        return r;
+      buf->len -= (line.eol - start) + 1;
+      buf->buf = line.eol + 1;
       goto headers_finished;
+    }
 
-    div = fio_http1___seek_header_div(start);
+    div = fio_http1___seek_header_div(start, end);
+    if (div == end)
+      return 1;
     if (div[0] != ':' || div == start)
       return -1;
+    /* find the end of the value, testing for control bytes */
+    if ((r = fio_http1___scan_line(&line, div + 1, end, 0)))
+      return r;
+
+    eol = line.eol;
+    buf->len -= (eol - start) + 1;
+    buf->buf = eol + 1;
+    eol -= (eol[-1] == '\r');
+
     name = FIO_BUF_INFO2(start, (size_t)(div - start));
     do {
       ++div;
@@ -446,9 +632,7 @@ static inline int fio_http1___read_header_line(
         --eol;
     value = FIO_BUF_INFO2((div == eol) ? NULL : div, (size_t)(eol - div));
 
-    if (FIO_MEMCHR(value.buf, 0, value.len))
-      return -1;
-    int r = handler(p, name, value, udata);
+    r = handler(p, name, value, udata);
     if (FIO_UNLIKELY(r))
       return r;
   }
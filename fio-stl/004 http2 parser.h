@@ -0,0 +1,881 @@
+/* ************************************************************************* */
+#if !defined(FIO_INCLUDE_FILE) /* Dev test - ignore line */
+#define FIO___DEV___           /* Development inclusion - ignore line */
+#define FIO_HTTP2_PARSER       /* Development inclusion - ignore line */
+#include "./include.h"         /* Development inclusion - ignore line */
+#endif                         /* Development inclusion - ignore line */
+/* *****************************************************************************
+
+
+
+
+                      HTTP/2 Framing and HPACK (RFC 9113, RFC 7541)
+                   Zero-allocation frame helpers and header codec.
+
+
+
+
+Copyright and License: see header file (000 copyright.h) or top of file
+***************************************************************************** */
+#if defined(FIO_HTTP2_PARSER) && !defined(H___FIO_HTTP2_PARSER___H) &&         \
+    (defined(FIO_EXTERN_COMPLETE) || !defined(FIO_EXTERN))
+/* *****************************************************************************
+The HTTP/2 parser provides static functions only, always as part or
+implementation.
+***************************************************************************** */
+#define H___FIO_HTTP2_PARSER___H
+
+/* *****************************************************************************
+HTTP/2 Constants
+***************************************************************************** */
+
+/** The client connection preface (RFC 9113, Section 3.4). */
+#define FIO_HTTP2_PREFACE     "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"
+/** The length of the client connection preface. */
+#define FIO_HTTP2_PREFACE_LEN 24
+
+/** The length of an HTTP/2 frame header. */
+#define FIO_HTTP2_FRAME_HEADER_LEN 9
+
+/** The initial flow control window size (connection and stream). */
+#define FIO_HTTP2_DEFAULT_WINDOW     65535
+/** The initial (and minimal) SETTINGS_MAX_FRAME_SIZE value. */
+#define FIO_HTTP2_DEFAULT_FRAME_SIZE 16384
+/** The largest legal SETTINGS_MAX_FRAME_SIZE value. */
+#define FIO_HTTP2_MAX_FRAME_SIZE     16777215
+/** The largest legal flow control window. */
+#define FIO_HTTP2_MAX_WINDOW         2147483647
+
+/** HTTP/2 frame types. */
+typedef enum {
+  FIO_HTTP2_FRAME_DATA = 0x0,
+  FIO_HTTP2_FRAME_HEADERS = 0x1,
+  FIO_HTTP2_FRAME_PRIORITY = 0x2,
+  FIO_HTTP2_FRAME_RST_STREAM = 0x3,
+  FIO_HTTP2_FRAME_SETTINGS = 0x4,
+  FIO_HTTP2_FRAME_PUSH_PROMISE = 0x5,
+  FIO_HTTP2_FRAME_PING = 0x6,
+  FIO_HTTP2_FRAME_GOAWAY = 0x7,
+  FIO_HTTP2_FRAME_WINDOW_UPDATE = 0x8,
+  FIO_HTTP2_FRAME_CONTINUATION = 0x9,
+} fio_http2_frame_type_e;
+
+/* HTTP/2 frame flags. */
+#define FIO_HTTP2_FLAG_END_STREAM  0x01
+#define FIO_HTTP2_FLAG_ACK         0x01
+#define FIO_HTTP2_FLAG_END_HEADERS 0x04
+#define FIO_HTTP2_FLAG_PADDED      0x08
+#define FIO_HTTP2_FLAG_PRIORITY    0x20
+
+/** HTTP/2 error codes (RFC 9113, Section 7). */
+typedef enum {
+  FIO_HTTP2_NO_ERROR = 0x0,
+  FIO_HTTP2_PROTOCOL_ERROR = 0x1,
+  FIO_HTTP2_INTERNAL_ERROR = 0x2,
+  FIO_HTTP2_FLOW_CONTROL_ERROR = 0x3,
+  FIO_HTTP2_SETTINGS_TIMEOUT = 0x4,
+  FIO_HTTP2_STREAM_CLOSED = 0x5,
+  FIO_HTTP2_FRAME_SIZE_ERROR = 0x6,
+  FIO_HTTP2_REFUSED_STREAM = 0x7,
+  FIO_HTTP2_CANCEL = 0x8,
+  FIO_HTTP2_COMPRESSION_ERROR = 0x9,
+  FIO_HTTP2_CONNECT_ERROR = 0xa,
+  FIO_HTTP2_ENHANCE_YOUR_CALM = 0xb,
+  FIO_HTTP2_INADEQUATE_SECURITY = 0xc,
+  FIO_HTTP2_HTTP_1_1_REQUIRED = 0xd,
+} fio_http2_error_e;
+
+/** HTTP/2 SETTINGS identifiers. */
+typedef enum {
+  FIO_HTTP2_SETTINGS_HEADER_TABLE_SIZE = 0x1,
+  FIO_HTTP2_SETTINGS_ENABLE_PUSH = 0x2,
+  FIO_HTTP2_SETTINGS_MAX_CONCURRENT_STREAMS = 0x3,
+  FIO_HTTP2_SETTINGS_INITIAL_WINDOW_SIZE = 0x4,
+  FIO_HTTP2_SETTINGS_MAX_FRAME_SIZE = 0x5,
+  FIO_HTTP2_SETTINGS_MAX_HEADER_LIST_SIZE = 0x6,
+} fio_http2_settings_e;
+
+/* *****************************************************************************
+HTTP/2 Frame Header Helpers
+***************************************************************************** */
+
+/** A decoded HTTP/2 frame header. */
+typedef struct {
+  uint32_t len;
+  uint32_t stream_id;
+  uint8_t type;
+  uint8_t flags;
+} fio_http2_frame_s;
+
+/** Reads a 9 byte frame header (the reserved stream bit is ignored). */
+FIO_IFUNC fio_http2_frame_s fio_http2_frame_read(const void *src);
+
+/** Writes a 9 byte frame header to `dest`. */
+FIO_IFUNC void fio_http2_frame_write(void *dest, fio_http2_frame_s f);
+
+/* *****************************************************************************
+HPACK API
+***************************************************************************** */
+
+/**
+ * The largest dynamic table size supported (and advertised) by the HPACK
+ * codec. Each `fio_hpack_s` object is roughly 2.5 times this size.
+ */
+#ifndef FIO_HPACK_TABLE_LIMIT
+#define FIO_HPACK_TABLE_LIMIT 4096
+#endif
+
+/** The HPACK dynamic table type (one per direction per connection). */
+typedef struct fio_hpack_s fio_hpack_s;
+
+/** Initializes an HPACK table (the RFC 7541 default size is 4096 bytes). */
+FIO_IFUNC void fio_hpack_init(fio_hpack_s *t);
+
+/**
+ * Sets an encoder's table size limit (i.e., SETTINGS_HEADER_TABLE_SIZE).
+ *
+ * The value is capped at `FIO_HPACK_TABLE_LIMIT` and the update is emitted at
+ * the beginning of the next header block.
+ */
+FIO_IFUNC void fio_hpack_max_size_set(fio_hpack_s *t, size_t max_size);
+
+/**
+ * Decodes a complete header block, calling `on_header` for each field.
+ *
+ * Huffman encoded strings are decoded into `scratch` (reset per field). When
+ * a field might not fit, `reserve` (if any) is called to grow `scratch` to
+ * `capa` bytes (or less, if capped), returning non-zero to refuse.
+ *
+ * Returns 0 on success, or -1 on error (a connection level
+ * COMPRESSION_ERROR), if `reserve` failed or if `on_header` returned a
+ * non-zero value.
+ */
+FIO_SFUNC int fio_hpack_decode(fio_hpack_s *t,
+                               fio_buf_info_s block,
+                               fio_str_info_s *scratch,
+                               int (*reserve)(fio_str_info_s *scratch,
+                                              size_t capa,
+                                              void *udata),
+                               int (*on_header)(fio_buf_info_s name,
+                                                fio_buf_info_s value,
+                                                void *udata),
+                               void *udata);
+
+/** Header field indexing preferences for `fio_hpack_encode`. */
+typedef enum {
+  /** Adds the field to the dynamic table (if it isn't already indexed). */
+  FIO_HPACK_INDEX = 0,
+  /** A literal that isn't added to the dynamic table. */
+  FIO_HPACK_NO_INDEX = 1,
+  /** A literal that intermediaries must never index (sensitive data). */
+  FIO_HPACK_NEVER_INDEX = 2,
+} fio_hpack_indexing_e;
+
+/** The number of bytes `fio_hpack_encode` may require for a header field. */
+#define FIO_HPACK_ENCODE_BOUND(name_len, value_len)                            \
+  ((size_t)(name_len) + (size_t)(value_len) + 16)
+
+/**
+ * Encodes a header field into `dest`, returning the number of bytes written.
+ *
+ * `dest` must have room for `FIO_HPACK_ENCODE_BOUND(name.len, value.len)`
+ * bytes. Header names should be lower case.
+ */
+FIO_SFUNC size_t fio_hpack_encode(fio_hpack_s *t,
+                                  void *dest,
+                                  fio_buf_info_s name,
+                                  fio_buf_info_s value,
+                                  fio_hpack_indexing_e indexing);
+
+/** Returns the length of `src` once Huffman encoded. */
+FIO_SFUNC size_t fio_hpack_huffman_len(const void *src, size_t len);
+
+/** Huffman encodes `src` into `dest`, returning the number of bytes written. */
+FIO_SFUNC size_t fio_hpack_huffman_encode(void *dest,
+                                          const void *src,
+                                          size_t len);
+
+/**
+ * Huffman decodes `src` into `dest`, returning the number of bytes written.
+ *
+ * Returns `(size_t)-1` on error or if `capa` bytes aren't enough.
+ */
+FIO_SFUNC size_t fio_hpack_huffman_decode(void *dest,
+                                          size_t capa,
+                                          const void *src,
+                                          size_t len);
+
+/* *****************************************************************************
+HPACK Type
+***************************************************************************** */
+
+#define FIO___HPACK_ENTRIES_LIMIT (FIO_HPACK_TABLE_LIMIT / 32)
+
+struct fio_hpack_s {
+  uint32_t size;     /* RFC 7541 size of all entries (lengths + 32) */
+  uint32_t max_size; /* current table size limit */
+  uint32_t count;    /* number of entries */
+  uint32_t head;     /* ring position of the newest entry */
+  uint32_t start;    /* data offset of the oldest entry */
+  uint32_t end;      /* end of data */
+  uint32_t update;   /* encoder: a pending size update (emitted if set) */
+  struct {
+    uint32_t pos;
+    uint32_t nlen;
+    uint32_t vlen;
+  } e[FIO___HPACK_ENTRIES_LIMIT];
+  char data[FIO_HPACK_TABLE_LIMIT * 2];
+};
+
+/* *****************************************************************************
+Frame Header Implementation
+***************************************************************************** */
+
+/** Reads a 9 byte frame header (the reserved stream bit is ignored). */
+FIO_IFUNC fio_http2_frame_s fio_http2_frame_read(const void *src) {
+  const uint8_t *s = (const uint8_t *)src;
+  fio_http2_frame_s r = {
+      .len = fio_buf2u24_be(s),
+      .stream_id = fio_buf2u32_be(s + 5) & 0x7FFFFFFFUL,
+      .type = s[3],
+      .flags = s[4],
+  };
+  return r;
+}
+
+/** Writes a 9 byte frame header to `dest`. */
+FIO_IFUNC void fio_http2_frame_write(void *dest, fio_http2_frame_s f) {
+  uint8_t *d = (uint8_t *)dest;
+  fio_u2buf24_be(d, f.len);
+  d[3] = f.type;
+  d[4] = f.flags;
+  fio_u2buf32_be(d + 5, f.stream_id & 0x7FFFFFFFUL);
+}
+
+/* *****************************************************************************
+HPACK Static Table (RFC 7541, Appendix A)
+***************************************************************************** */
+
+#define FIO___HPACK_STATIC_LEN 61
+
+static const struct {
+  fio_buf_info_s name;
+  fio_buf_info_s value;
+} FIO___HPACK_STATIC[FIO___HPACK_STATIC_LEN] = {
+#define FIO___HPACK_S(n, v)                                                    \
+  {                                                                            \
+    {.buf = (char *)n, .len = sizeof(n) - 1},                                  \
+        {.buf = (char *)v, .len = sizeof(v) - 1},                              \
+  }
+    FIO___HPACK_S(":authority", ""),
+    FIO___HPACK_S(":method", "GET"),
+    FIO___HPACK_S(":method", "POST"),
+    FIO___HPACK_S(":path", "/"),
+    FIO___HPACK_S(":path", "/index.html"),
+    FIO___HPACK_S(":scheme", "http"),
+    FIO___HPACK_S(":scheme", "https"),
+    FIO___HPACK_S(":status", "200"),
+    FIO___HPACK_S(":status", "204"),
+    FIO___HPACK_S(":status", "206"),
+    FIO___HPACK_S(":status", "304"),
+    FIO___HPACK_S(":status", "400"),
+    FIO___HPACK_S(":status", "404"),
+    FIO___HPACK_S(":status", "500"),
+    FIO___HPACK_S("accept-charset", ""),
+    FIO___HPACK_S("accept-encoding", "gzip, deflate"),
+    FIO___HPACK_S("accept-language", ""),
+    FIO___HPACK_S("accept-ranges", ""),
+    FIO___HPACK_S("accept", ""),
+    FIO___HPACK_S("access-control-allow-origin", ""),
+    FIO___HPACK_S("age", ""),
+    FIO___HPACK_S("allow", ""),
+    FIO___HPACK_S("authorization", ""),
+    FIO___HPACK_S("cache-control", ""),
+    FIO___HPACK_S("content-disposition", ""),
+    FIO___HPACK_S("content-encoding", ""),
+    FIO___HPACK_S("content-language", ""),
+    FIO___HPACK_S("content-length", ""),
+    FIO___HPACK_S("content-location", ""),
+    FIO___HPACK_S("content-range", ""),
+    FIO___HPACK_S("content-type", ""),
+    FIO___HPACK_S("cookie", ""),
+    FIO___HPACK_S("date", ""),
+    FIO___HPACK_S("etag", ""),
+    FIO___HPACK_S("expect", ""),
+    FIO___HPACK_S("expires", ""),
+    FIO___HPACK_S("from", ""),
+    FIO___HPACK_S("host", ""),
+    FIO___HPACK_S("if-match", ""),
+    FIO___HPACK_S("if-modified-since", ""),
+    FIO___HPACK_S("if-none-match", ""),
+    FIO___HPACK_S("if-range", ""),
+    FIO___HPACK_S("if-unmodified-since", ""),
+    FIO___HPACK_S("last-modified", ""),
+    FIO___HPACK_S("link", ""),
+    FIO___HPACK_S("location", ""),
+    FIO___HPACK_S("max-forwards", ""),
+    FIO___HPACK_S("proxy-authenticate", ""),
+    FIO___HPACK_S("proxy-authorization", ""),
+    FIO___HPACK_S("range", ""),
+    FIO___HPACK_S("referer", ""),
+    FIO___HPACK_S("refresh", ""),
+    FIO___HPACK_S("retry-after", ""),
+    FIO___HPACK_S("server", ""),
+    FIO___HPACK_S("set-cookie", ""),
+    FIO___HPACK_S("strict-transport-security", ""),
+    FIO___HPACK_S("transfer-encoding", ""),
+    FIO___HPACK_S("user-agent", ""),
+    FIO___HPACK_S("vary", ""),
+    FIO___HPACK_S("via", ""),
+    FIO___HPACK_S("www-authenticate", ""),
+#undef FIO___HPACK_S
+};
+
+/* *****************************************************************************
+HPACK Huffman Code (RFC 7541, Appendix B)
+
+The code is canonical, so decoding only requires the symbols sorted by code
+length (and value) and the first code / symbol offset of each code length.
+***************************************************************************** */
+
+static const uint32_t FIO___HPACK_HUFFMAN_CODE[257] = {
+    0x1FF8,    0x7FFFD8,  0xFFFFFE2, 0xFFFFFE3,  0xFFFFFE4,  0xFFFFFE5,
+    0xFFFFFE6, 0xFFFFFE7, 0xFFFFFE8, 0xFFFFEA,   0x3FFFFFFC, 0xFFFFFE9,
+    0xFFFFFEA, 0x3FFFFFFD, 0xFFFFFEB, 0xFFFFFEC, 0xFFFFFED,  0xFFFFFEE,
+    0xFFFFFEF, 0xFFFFFF0, 0xFFFFFF1, 0xFFFFFF2,  0x3FFFFFFE, 0xFFFFFF3,
+    0xFFFFFF4, 0xFFFFFF5, 0xFFFFFF6, 0xFFFFFF7,  0xFFFFFF8,  0xFFFFFF9,
+    0xFFFFFFA, 0xFFFFFFB, 0x14,      0x3F8,      0x3F9,      0xFFA,
+    0x1FF9,    0x15,      0xF8,      0x7FA,      0x3FA,      0x3FB,
+    0xF9,      0x7FB,     0xFA,      0x16,       0x17,       0x18,
+    0x0,       0x1,       0x2,       0x19,       0x1A,       0x1B,
+    0x1C,      0x1D,      0x1E,      0x1F,       0x5C,       0xFB,
+    0x7FFC,    0x20,      0xFFB,     0x3FC,      0x1FFA,     0x21,
+    0x5D,      0x5E,      0x5F,      0x60,       0x61,       0x62,
+    0x63,      0x64,      0x65,      0x66,       0x67,       0x68,
+    0x69,      0x6A,      0x6B,      0x6C,       0x6D,       0x6E,
+    0x6F,      0x70,      0x71,      0x72,       0xFC,       0x73,
+    0xFD,      0x1FFB,    0x7FFF0,   0x1FFC,     0x3FFC,     0x22,
+    0x7FFD,    0x3,       0x23,      0x4,        0x24,       0x5,
+    0x25,      0x26,      0x27,      0x6,        0x74,       0x75,
+    0x28,      0x29,      0x2A,      0x7,        0x2B,       0x76,
+    0x2C,      0x8,       0x9,       0x2D,       0x77,       0x78,
+    0x79,      0x7A,      0x7B,      0x7FFE,     0x7FC,      0x3FFD,
+    0x1FFD,    0xFFFFFFC, 0xFFFE6,   0x3FFFD2,   0xFFFE7,    0xFFFE8,
+    0x3FFFD3,  0x3FFFD4,  0x3FFFD5,  0x7FFFD9,   0x3FFFD6,   0x7FFFDA,
+    0x7FFFDB,  0x7FFFDC,  0x7FFFDD,  0x7FFFDE,   0xFFFFEB,   0x7FFFDF,
+    0xFFFFEC,  0xFFFFED,  0x3FFFD7,  0x7FFFE0,   0xFFFFEE,   0x7FFFE1,
+    0x7FFFE2,  0x7FFFE3,  0x7FFFE4,  0x1FFFDC,   0x3FFFD8,   0x7FFFE5,
+    0x3FFFD9,  0x7FFFE6,  0x7FFFE7,  0xFFFFEF,   0x3FFFDA,   0x1FFFDD,
+    0xFFFE9,   0x3FFFDB,  0x3FFFDC,  0x7FFFE8,   0x7FFFE9,   0x1FFFDE,
+    0x7FFFEA,  0x3FFFDD,  0x3FFFDE,  0xFFFFF0,   0x1FFFDF,   0x3FFFDF,
+    0x7FFFEB,  0x7FFFEC,  0x1FFFE0,  0x1FFFE1,   0x3FFFE0,   0x1FFFE2,
+    0x7FFFED,  0x3FFFE1,  0x7FFFEE,  0x7FFFEF,   0xFFFEA,    0x3FFFE2,
+    0x3FFFE3,  0x3FFFE4,  0x7FFFF0,  0x3FFFE5,   0x3FFFE6,   0x7FFFF1,
+    0x3FFFFE0, 0x3FFFFE1, 0xFFFEB,   0x7FFF1,    0x3FFFE7,   0x7FFFF2,
+    0x3FFFE8,  0x1FFFFEC, 0x3FFFFE2, 0x3FFFFE3,  0x3FFFFE4,  0x7FFFFDE,
+    0x7FFFFDF, 0x3FFFFE5, 0xFFFFF1,  0x1FFFFED,  0x7FFF2,    0x1FFFE3,
+    0x3FFFFE6, 0x7FFFFE0, 0x7FFFFE1, 0x3FFFFE7,  0x7FFFFE2,  0xFFFFF2,
+    0x1FFFE4,  0x1FFFE5,  0x3FFFFE8, 0x3FFFFE9,  0xFFFFFFD,  0x7FFFFE3,
+    0x7FFFFE4, 0x7FFFFE5, 0xFFFEC,   0xFFFFF3,   0xFFFED,    0x1FFFE6,
+    0x3FFFE9,  0x1FFFE7,  0x1FFFE8,  0x7FFFF3,   0x3FFFEA,   0x3FFFEB,
+    0x1FFFFEE, 0x1FFFFEF, 0xFFFFF4,  0xFFFFF5,   0x3FFFFEA,  0x7FFFF4,
+    0x3FFFFEB, 0x7FFFFE6, 0x3FFFFEC, 0x3FFFFED,  0x7FFFFE7,  0x7FFFFE8,
+    0x7FFFFE9, 0x7FFFFEA, 0x7FFFFEB, 0xFFFFFFE,  0x7FFFFEC,  0x7FFFFED,
+    0x7FFFFEE, 0x7FFFFEF, 0x7FFFFF0, 0x3FFFFEE,  0x3FFFFFFF,
+};
+
+static const uint8_t FIO___HPACK_HUFFMAN_BITS[257] = {
+    13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28, 28, 30, 28, 28, 28, 28, 28,
+    28, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 28, 6,  10, 10, 12, 13, 6,
+    8,  11, 10, 10, 8,  11, 8,  6,  6,  6,  5,  5,  5,  6,  6,  6,  6,  6,  6,
+    6,  7,  8,  15, 6,  12, 10, 13, 6,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,
+    7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  8,  7,  8,  13, 19, 13, 14,
+    6,  15, 5,  6,  5,  6,  5,  6,  6,  6,  5,  7,  7,  6,  6,  6,  5,  6,  7,
+    6,  5,  5,  6,  7,  7,  7,  7,  7,  15, 11, 14, 13, 28, 20, 22, 20, 20, 22,
+    22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23, 24, 24, 22, 23, 24, 23, 23, 23,
+    23, 21, 22, 23, 22, 23, 23, 24, 22, 21, 20, 22, 22, 23, 23, 21, 23, 22, 22,
+    24, 21, 22, 23, 23, 21, 21, 22, 21, 23, 22, 23, 23, 20, 22, 22, 22, 23, 22,
+    22, 23, 26, 26, 20, 19, 22, 23, 22, 25, 26, 26, 26, 27, 27, 26, 24, 25, 19,
+    21, 26, 27, 27, 26, 27, 24, 21, 21, 26, 26, 28, 27, 27, 27, 20, 24, 20, 21,
+    22, 21, 21, 23, 22, 22, 25, 25, 24, 24, 26, 23, 26, 27, 26, 26, 27, 27, 27,
+    27, 27, 28, 27, 27, 27, 27, 27, 26, 30,
+};
+
+/* symbols, sorted by code length (and symbol value within each length) */
+static const uint16_t FIO___HPACK_HUFFMAN_SYMBOLS[257] = {
+    48,  49,  50,  97,  99,  101, 105, 111, 115, 116, 32,  37,  45,  46,  47,
+    51,  52,  53,  54,  55,  56,  57,  61,  65,  95,  98,  100, 102, 103, 104,
+    108, 109, 110, 112, 114, 117, 58,  66,  67,  68,  69,  70,  71,  72,  73,
+    74,  75,  76,  77,  78,  79,  80,  81,  82,  83,  84,  85,  86,  87,  89,
+    106, 107, 113, 118, 119, 120, 121, 122, 38,  42,  44,  59,  88,  90,  33,
+    34,  40,  41,  63,  39,  43,  124, 35,  62,  0,   36,  64,  91,  93,  126,
+    94,  125, 60,  96,  123, 92,  195, 208, 128, 130, 131, 162, 184, 194, 224,
+    226, 153, 161, 167, 172, 176, 177, 179, 209, 216, 217, 227, 229, 230, 129,
+    132, 133, 134, 136, 146, 154, 156, 160, 163, 164, 169, 170, 173, 178, 181,
+    185, 186, 187, 189, 190, 196, 198, 228, 232, 233, 1,   135, 137, 138, 139,
+    140, 141, 143, 147, 149, 150, 151, 152, 155, 157, 158, 165, 166, 168, 174,
+    175, 180, 182, 183, 188, 191, 197, 231, 239, 9,   142, 144, 145, 148, 159,
+    171, 206, 215, 225, 236, 237, 199, 207, 234, 235, 192, 193, 200, 201, 202,
+    205, 210, 213, 218, 219, 238, 240, 242, 243, 255, 203, 204, 211, 212, 214,
+    221, 222, 223, 241, 244, 245, 246, 247, 248, 250, 251, 252, 253, 254, 2,
+    3,   4,   5,   6,   7,   8,   11,  12,  14,  15,  16,  17,  18,  19,  20,
+    21,  23,  24,  25,  26,  27,  28,  29,  30,  31,  127, 220, 249, 10,  13,
+    22,  256,
+};
+
+/* per code length: first code, index of first symbol and number of symbols */
+static const struct {
+  uint32_t first;
+  uint16_t offset;
+  uint16_t count;
+} FIO___HPACK_HUFFMAN_LENGTHS[31] = {
+    {0, 0, 0},           {0, 0, 0},          {0, 0, 0},
+    {0, 0, 0},           {0, 0, 0},          {0x0, 0, 10},
+    {0x14, 10, 26},      {0x5C, 36, 32},     {0xF8, 68, 6},
+    {0, 0, 0},           {0x3F8, 74, 5},     {0x7FA, 79, 3},
+    {0xFFA, 82, 2},      {0x1FF8, 84, 6},    {0x3FFC, 90, 2},
+    {0x7FFC, 92, 3},     {0, 0, 0},          {0, 0, 0},
+    {0, 0, 0},           {0x7FFF0, 95, 3},   {0xFFFE6, 98, 8},
+    {0x1FFFDC, 106, 13}, {0x3FFFD2, 119, 26}, {0x7FFFD8, 145, 29},
+    {0xFFFFEA, 174, 12}, {0x1FFFFEC, 186, 4}, {0x3FFFFE0, 190, 15},
+    {0x7FFFFDE, 205, 19}, {0xFFFFFE2, 224, 29}, {0, 0, 0},
+    {0x3FFFFFFC, 253, 4},
+};
+
+/* *****************************************************************************
+HPACK Huffman Implementation
+***************************************************************************** */
+
+/** Returns the length of `src` once Huffman encoded. */
+FIO_SFUNC size_t fio_hpack_huffman_len(const void *src, size_t len) {
+  const uint8_t *s = (const uint8_t *)src;
+  size_t bits = 0;
+  for (size_t i = 0; i < len; ++i)
+    bits += FIO___HPACK_HUFFMAN_BITS[s[i]];
+  return (bits + 7) >> 3;
+}
+
+/** Huffman encodes `src` into `dest`, returning the number of bytes written. */
+FIO_SFUNC size_t fio_hpack_huffman_encode(void *dest,
+                                          const void *src,
+                                          size_t len) {
+  const uint8_t *s = (const uint8_t *)src;
+  uint8_t *d = (uint8_t *)dest;
+  uint64_t acc = 0;
+  size_t bits = 0;
+  for (size_t i = 0; i < len; ++i) {
+    acc = (acc << FIO___HPACK_HUFFMAN_BITS[s[i]]) |
+          FIO___HPACK_HUFFMAN_CODE[s[i]];
+    bits += FIO___HPACK_HUFFMAN_BITS[s[i]];
+    while (bits >= 8) {
+      bits -= 8;
+      *(d++) = (uint8_t)(acc >> bits);
+    }
+  }
+  if (bits) /* pad with the most significant bits of EOS (all ones) */
+    *(d++) = (uint8_t)((acc << (8 - bits)) | (0xFFU >> bits));
+  return (size_t)(d - (uint8_t *)dest);
+}
+
+/**
+ * Huffman decodes `src` into `dest`, returning the number of bytes written.
+ *
+ * Returns `(size_t)-1` on error or if `capa` bytes aren't enough.
+ */
+FIO_SFUNC size_t fio_hpack_huffman_decode(void *dest,
+                                          size_t capa,
+                                          const void *src,
+                                          size_t len) {
+  const uint8_t *s = (const uint8_t *)src;
+  const uint8_t *end = s + len;
+  uint8_t *d = (uint8_t *)dest;
+  uint8_t *dend = d + capa;
+  uint64_t acc = 0; /* bits are kept at the bottom of the accumulator */
+  size_t bits = 0;
+  for (;;) {
+    while (bits <= 56 && s < end) {
+      acc = (acc << 8) | *(s++);
+      bits += 8;
+    }
+    if (bits < 5)
+      break;
+    size_t l = 5;
+    uint32_t code;
+    for (;; ++l) {
+      if (l > bits)
+        goto tail;
+      code = (uint32_t)((acc >> (bits - l)) & ((1ULL << l) - 1));
+      if (code - FIO___HPACK_HUFFMAN_LENGTHS[l].first <
+          FIO___HPACK_HUFFMAN_LENGTHS[l].count)
+        break;
+      if (l == 30)
+        return (size_t)-1;
+    }
+    code = FIO___HPACK_HUFFMAN_SYMBOLS[FIO___HPACK_HUFFMAN_LENGTHS[l].offset +
+                                       code -
+                                       FIO___HPACK_HUFFMAN_LENGTHS[l].first];
+    if (code == 256 || d == dend) /* EOS is a decoding error */
+      return (size_t)-1;
+    *(d++) = (uint8_t)code;
+    bits -= l;
+  }
+tail: /* padding: fewer than 8 bits, all set (a prefix of EOS) */
+  if (bits > 7 || (acc & ((1ULL << bits) - 1)) != ((1ULL << bits) - 1))
+    return (size_t)-1;
+  return (size_t)(d - (uint8_t *)dest);
+}
+
+/* *****************************************************************************
+HPACK Primitives - Integers and Strings (RFC 7541, Section 5)
+***************************************************************************** */
+
+/* writes an integer with an N bit prefix, `flags` holds the high bits. */
+FIO_IFUNC size_t fio___hpack_int_write(uint8_t *d,
+                                       uint8_t flags,
+                                       size_t prefix,
+                                       size_t i) {
+  const size_t max = (1UL << prefix) - 1;
+  size_t r = 1;
+  if (i < max) {
+    d[0] = (uint8_t)(flags | i);
+    return r;
+  }
+  d[0] = (uint8_t)(flags | max);
+  i -= max;
+  while (i >= 128) {
+    d[r++] = (uint8_t)((i & 127) | 128);
+    i >>= 7;
+  }
+  d[r++] = (uint8_t)i;
+  return r;
+}
+
+/* reads an integer with an N bit prefix, returns -1 on error. */
+FIO_IFUNC int fio___hpack_int_read(const uint8_t **pos,
+                                   const uint8_t *end,
+                                   size_t prefix,
+                                   uint32_t *dest) {
+  const uint8_t *p = *pos;
+  const uint32_t max = (uint32_t)((1UL << prefix) - 1);
+  uint64_t i;
+  if (p >= end)
+    return -1;
+  i = *(p++) & max;
+  if (i == max) {
+    for (size_t shift = 0;; shift += 7) {
+      if (p >= end || shift > 28)
+        return -1;
+      i += (uint64_t)(*p & 127) << shift;
+      if (!(*(p++) & 128))
+        break;
+    }
+    if (i > 0xFFFFFFFFULL)
+      return -1;
+  }
+  *dest = (uint32_t)i;
+  *pos = p;
+  return 0;
+}
+
+/* writes a string literal, Huffman encoded if shorter. */
+FIO_IFUNC size_t fio___hpack_str_write(uint8_t *d, fio_buf_info_s s) {
+  size_t r;
+  size_t hlen = fio_hpack_huffman_len(s.buf, s.len);
+  if (hlen < s.len) {
+    r = fio___hpack_int_write(d, 0x80, 7, hlen);
+    return r + fio_hpack_huffman_encode(d + r, s.buf, s.len);
+  }
+  r = fio___hpack_int_write(d, 0, 7, s.len);
+  if (s.len)
+    FIO_MEMCPY(d + r, s.buf, s.len);
+  return r + s.len;
+}
+
+/* the HPACK decoder's scratch space and its (optional) reallocation. */
+typedef struct {
+  fio_str_info_s *buf;
+  int (*reserve)(fio_str_info_s *scratch, size_t capa, void *udata);
+  void *udata;
+} fio___hpack_scratch_s;
+
+/* grows the scratch space, rebasing `keep` (if it points into the scratch). */
+FIO_SFUNC int fio___hpack_reserve(fio___hpack_scratch_s *s,
+                                  size_t capa,
+                                  fio_buf_info_s *keep) {
+  char *old = s->buf->buf;
+  if (s->buf->capa >= capa)
+    return 0;
+  if (!s->reserve || s->reserve(s->buf, capa, s->udata))
+    return -1;
+  if (keep && old && keep->buf >= old && keep->buf < old + s->buf->len)
+    keep->buf = s->buf->buf + (keep->buf - old);
+  return 0;
+}
+
+/* reads a string literal, Huffman strings are decoded into the scratch. */
+FIO_IFUNC int fio___hpack_str_read(const uint8_t **pos,
+                                   const uint8_t *end,
+                                   fio___hpack_scratch_s *s,
+                                   fio_buf_info_s *dest,
+                                   fio_buf_info_s *keep) {
+  uint32_t len;
+  fio_str_info_s *scratch = s->buf;
+  const int huffman = (*pos < end) && (**pos & 0x80);
+  if (fio___hpack_int_read(pos, end, 7, &len) || (size_t)(end - *pos) < len)
+    return -1;
+  if (!huffman) {
+    *dest = FIO_BUF_INFO2((char *)*pos, len);
+    *pos += len;
+    return 0;
+  }
+  /* the shortest Huffman code is 5 bits long */
+  if (s->reserve &&
+      fio___hpack_reserve(s, scratch->len + (((size_t)len * 8) / 5), keep))
+    return -1;
+  size_t r = fio_hpack_huffman_decode(scratch->buf + scratch->len,
+                                      scratch->capa - scratch->len,
+                                      *pos,
+                                      len);
+  if (r == (size_t)-1)
+    return -1;
+  *dest = FIO_BUF_INFO2(scratch->buf + scratch->len, r);
+  scratch->len += r;
+  *pos += len;
+  return 0;
+}
+
+/* *****************************************************************************
+HPACK Dynamic Table
+***************************************************************************** */
+
+/** Initializes an HPACK table (the RFC 7541 default size is 4096 bytes). */
+FIO_IFUNC void fio_hpack_init(fio_hpack_s *t) {
+  t->size = t->count = t->head = t->start = t->end = t->update = 0;
+  t->max_size = (FIO_HPACK_TABLE_LIMIT < 4096 ? FIO_HPACK_TABLE_LIMIT : 4096);
+}
+
+/* evicts entries until `size` bytes fit within the table size limit. */
+FIO_IFUNC void fio___hpack_evict(fio_hpack_s *t, size_t size) {
+  while (t->count && t->size + size > t->max_size) {
+    --t->count;
+    const size_t i =
+        (t->head + FIO___HPACK_ENTRIES_LIMIT - t->count) %
+        FIO___HPACK_ENTRIES_LIMIT;
+    t->size -= t->e[i].nlen + t->e[i].vlen + 32;
+    t->start = t->e[i].pos + t->e[i].nlen + t->e[i].vlen;
+  }
+  if (!t->count)
+    t->start = t->end = 0;
+}
+
+/** Sets an encoder's table size limit (i.e., SETTINGS_HEADER_TABLE_SIZE). */
+FIO_IFUNC void fio_hpack_max_size_set(fio_hpack_s *t, size_t max_size) {
+  if (max_size > FIO_HPACK_TABLE_LIMIT)
+    max_size = FIO_HPACK_TABLE_LIMIT;
+  if (max_size == t->max_size)
+    return;
+  t->max_size = (uint32_t)max_size;
+  t->update = 1;
+  fio___hpack_evict(t, 0);
+}
+
+/* adds an entry (name / value must not point into the table's data). */
+FIO_SFUNC void fio___hpack_add(fio_hpack_s *t,
+                               fio_buf_info_s name,
+                               fio_buf_info_s value) {
+  const size_t len = name.len + value.len;
+  fio___hpack_evict(t, len + 32);
+  if (len + 32 > t->max_size)
+    return; /* an entry larger than the table empties the table */
+  if (t->end + len > sizeof(t->data)) { /* compact the live data */
+    for (size_t i = 0; i < t->count; ++i)
+      t->e[(t->head + FIO___HPACK_ENTRIES_LIMIT - i) %
+           FIO___HPACK_ENTRIES_LIMIT]
+          .pos -= t->start;
+    FIO_MEMMOVE(t->data, t->data + t->start, t->end - t->start);
+    t->end -= t->start;
+    t->start = 0;
+  }
+  t->head = (t->head + 1) % FIO___HPACK_ENTRIES_LIMIT;
+  t->e[t->head].pos = t->end;
+  t->e[t->head].nlen = (uint32_t)name.len;
+  t->e[t->head].vlen = (uint32_t)value.len;
+  if (name.len)
+    FIO_MEMCPY(t->data + t->end, name.buf, name.len);
+  if (value.len)
+    FIO_MEMCPY(t->data + t->end + name.len, value.buf, value.len);
+  t->end += (uint32_t)len;
+  t->size += (uint32_t)(len + 32);
+  ++t->count;
+}
+
+/* gets an entry by its (1 based) HPACK index, returns -1 if out of bounds. */
+FIO_IFUNC int fio___hpack_get(fio_hpack_s *t,
+                              size_t index,
+                              fio_buf_info_s *name,
+                              fio_buf_info_s *value) {
+  if (!index)
+    return -1;
+  if (index <= FIO___HPACK_STATIC_LEN) {
+    *name = FIO___HPACK_STATIC[index - 1].name;
+    *value = FIO___HPACK_STATIC[index - 1].value;
+    return 0;
+  }
+  index -= FIO___HPACK_STATIC_LEN + 1;
+  if (index >= t->count)
+    return -1;
+  index = (t->head + FIO___HPACK_ENTRIES_LIMIT - index) %
+          FIO___HPACK_ENTRIES_LIMIT;
+  *name = FIO_BUF_INFO2(t->data + t->e[index].pos, t->e[index].nlen);
+  *value = FIO_BUF_INFO2(t->data + t->e[index].pos + t->e[index].nlen,
+                         t->e[index].vlen);
+  return 0;
+}
+
+/* *****************************************************************************
+HPACK Decoding
+***************************************************************************** */
+
+/** Decodes a complete header block, calling `on_header` for each field. */
+FIO_SFUNC int fio_hpack_decode(fio_hpack_s *t,
+                               fio_buf_info_s block,
+                               fio_str_info_s *scratch,
+                               int (*reserve)(fio_str_info_s *scratch,
+                                              size_t capa,
+                                              void *udata),
+                               int (*on_header)(fio_buf_info_s name,
+                                                fio_buf_info_s value,
+                                                void *udata),
+                               void *udata) {
+  const uint8_t *pos = (const uint8_t *)block.buf;
+  const uint8_t *end = pos + block.len;
+  int may_update = 1; /* size updates are only allowed before any field */
+  fio___hpack_scratch_s s = {.buf = scratch,
+                             .reserve = reserve,
+                             .udata = udata};
+  while (pos < end) {
+    fio_buf_info_s name, value;
+    uint32_t index;
+    size_t prefix;
+    uint8_t kind = *pos;
+    scratch->len = 0;
+    if (kind & 0x80) { /* indexed header field */
+      if (fio___hpack_int_read(&pos, end, 7, &index) ||
+          fio___hpack_get(t, index, &name, &value))
+        return -1;
+      may_update = 0;
+      if (on_header(name, value, udata))
+        return -1;
+      continue;
+    }
+    if ((kind & 0xE0) == 0x20) { /* dynamic table size update */
+      if (!may_update || fio___hpack_int_read(&pos, end, 5, &index) ||
+          index > FIO_HPACK_TABLE_LIMIT)
+        return -1;
+      t->max_size = index;
+      fio___hpack_evict(t, 0);
+      continue;
+    }
+    may_update = 0;
+    /* literal: with incremental indexing (6 bit prefix) or without (4 bit) */
+    prefix = (kind & 0x40) ? 6 : 4;
+    if (fio___hpack_int_read(&pos, end, prefix, &index))
+      return -1;
+    if (index) {
+      if (fio___hpack_get(t, index, &name, &value))
+        return -1;
+      if (index > FIO___HPACK_STATIC_LEN && (kind & 0x40)) {
+        /* the entry might be evicted when adding - copy the name */
+        if (fio___hpack_reserve(&s, name.len, NULL) ||
+            scratch->capa < name.len)
+          return -1;
+        FIO_MEMCPY(scratch->buf, name.buf, name.len);
+        name.buf = scratch->buf;
+        scratch->len = name.len;
+      }
+    } else if (fio___hpack_str_read(&pos, end, &s, &name, NULL))
+      return -1;
+    if (fio___hpack_str_read(&pos, end, &s, &value, &name))
+      return -1;
+    if ((kind & 0x40))
+      fio___hpack_add(t, name, value);
+    if (on_header(name, value, udata))
+      return -1;
+  }
+  return 0;
+}
+
+/* *****************************************************************************
+HPACK Encoding
+***************************************************************************** */
+
+/* finds a field, returns its index (negative if only the name matched). */
+FIO_SFUNC int fio___hpack_find(fio_hpack_s *t,
+                               fio_buf_info_s name,
+                               fio_buf_info_s value) {
+  int r = 0;
+  for (size_t i = 0; i < FIO___HPACK_STATIC_LEN; ++i) {
+    if (FIO___HPACK_STATIC[i].name.len != name.len ||
+        FIO_MEMCMP(FIO___HPACK_STATIC[i].name.buf, name.buf, name.len))
+      continue;
+    if (FIO___HPACK_STATIC[i].value.len == value.len &&
+        (!value.len ||
+         !FIO_MEMCMP(FIO___HPACK_STATIC[i].value.buf, value.buf, value.len)))
+      return (int)i + 1;
+    if (!r)
+      r = 0 - ((int)i + 1);
+  }
+  for (size_t i = 0; i < t->count; ++i) {
+    const size_t e = (t->head + FIO___HPACK_ENTRIES_LIMIT - i) %
+                     FIO___HPACK_ENTRIES_LIMIT;
+    const char *n = t->data + t->e[e].pos;
+    if (t->e[e].nlen != name.len || FIO_MEMCMP(n, name.buf, name.len))
+      continue;
+    if (t->e[e].vlen == value.len &&
+        (!value.len || !FIO_MEMCMP(n + name.len, value.buf, value.len)))
+      return (int)(i + FIO___HPACK_STATIC_LEN + 1);
+    if (!r)
+      r = 0 - (int)(i + FIO___HPACK_STATIC_LEN + 1);
+  }
+  return r;
+}
+
+/** Encodes a header field into `dest`, returning the number of bytes written.
+ */
+FIO_SFUNC size_t fio_hpack_encode(fio_hpack_s *t,
+                                  void *dest,
+                                  fio_buf_info_s name,
+                                  fio_buf_info_s value,
+                                  fio_hpack_indexing_e indexing) {
+  uint8_t *d = (uint8_t *)dest;
+  size_t r = 0;
+  if (t->update) { /* emit a pending dynamic table size update */
+    t->update = 0;
+    r = fio___hpack_int_write(d, 0x20, 5, t->max_size);
+  }
+  int index = fio___hpack_find(t, name, value);
+  if (index > 0 && indexing != FIO_HPACK_NEVER_INDEX)
+    return r + fio___hpack_int_write(d + r, 0x80, 7, (size_t)index);
+  if (index < 0)
+    index = 0 - index;
+  if (indexing == FIO_HPACK_INDEX) {
+    r += fio___hpack_int_write(d + r, 0x40, 6, (size_t)index);
+  } else {
+    r += fio___hpack_int_write(d + r,
+                               (indexing == FIO_HPACK_NEVER_INDEX ? 0x10 : 0),
+                               4,
+                               (size_t)index);
+  }
+  if (!index)
+    r += fio___hpack_str_write(d + r, name);
+  r += fio___hpack_str_write(d + r, value);
+  if (indexing == FIO_HPACK_INDEX)
+    fio___hpack_add(t, name, value);
+  return r;
+}
+
+/* *****************************************************************************
+HTTP/2 Parser Cleanup
+***************************************************************************** */
+#undef FIO_HTTP2_PARSER
+#endif /* FIO_HTTP2_PARSER */
@@ -127,6 +127,37 @@ Note: a Helper API is provided for the parsing implementation.
 //   uint32_t count;
 // } fio___json_cb_queue_s;
 
+/* *****************************************************************************
+Stage 1 - String and White Space Index (SIMD)
+
+The input is classified in 64 byte blocks, just ahead of the consumer, into
+white space, (unescaped) quote and backslash bitmaps (simdjson style). The
+consumer (stage 2) uses the index to skip white space and to jump to the end of
+strings.
+
+Since the parser accepts comments, single quoted strings and quote-less keys,
+a structural index can't know which bytes are inside a string - so the index
+only marks what the consumer asks for.
+***************************************************************************** */
+#if (defined(FIO___HAS_X86_INTRIN) &&                                          \
+     (defined(__AVX2__) || defined(__SSE2__))) ||                              \
+    (defined(FIO___HAS_ARM_INTRIN) && defined(__aarch64__))
+#define FIO___JSON_INDEX 1
+#else
+#define FIO___JSON_INDEX 0
+#endif
+
+#if FIO___JSON_INDEX
+/* the classified block ending at `next` (blocks are classified in order). */
+typedef struct {
+  const char *next;
+  uint64_t ws;
+  uint64_t quote;
+  uint64_t escape;
+  uint64_t escaped; /* 1 if the first byte of the next block is escaped */
+} fio___json_index_s;
+#endif
+
 typedef struct {
   fio_json_parser_callbacks_s cb;
   void *ctx;
@@ -136,6 +167,9 @@ typedef struct {
   const char *end;
   uint32_t depth;
   int32_t error;
+#if FIO___JSON_INDEX
+  fio___json_index_s index;
+#endif
 } fio___json_state_s;
 
 FIO_SFUNC void *fio___json_consume(fio___json_state_s *s);
@@ -149,8 +183,146 @@ FIO_SFUNC void *fio___json_consume(fio___json_state_s *s);
 #define FIO_JSON___PRINT_STEP(s, step_name)
 #endif
 
+#if FIO___JSON_INDEX
+/* sets bits for white space, `"` and `\` bytes in 64 bytes. */
+#if defined(FIO___HAS_X86_INTRIN) && defined(__AVX2__)
+FIO_IFUNC void fio___json_classify64(const char *p,
+                                     uint64_t *ws,
+                                     uint64_t *quote,
+                                     uint64_t *escape) {
+  *ws = *quote = *escape = 0;
+  for (size_t i = 0; i < 2; ++i) {
+    const __m256i v = _mm256_loadu_si256((const __m256i *)(p + (i << 5)));
+    const __m256i w = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                        _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))),
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')),
+                        _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))));
+    *ws |= (uint64_t)(uint32_t)_mm256_movemask_epi8(w) << (i << 5);
+    *quote |= (uint64_t)(uint32_t)_mm256_movemask_epi8(
+                  _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')))
+              << (i << 5);
+    *escape |= (uint64_t)(uint32_t)_mm256_movemask_epi8(
+                   _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')))
+               << (i << 5);
+  }
+}
+#elif defined(FIO___HAS_X86_INTRIN)
+FIO_IFUNC void fio___json_classify64(const char *p,
+                                     uint64_t *ws,
+                                     uint64_t *quote,
+                                     uint64_t *escape) {
+  *ws = *quote = *escape = 0;
+  for (size_t i = 0; i < 4; ++i) {
+    const __m128i v = _mm_loadu_si128((const __m128i *)(p + (i << 4)));
+    const __m128i w =
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                                  _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))),
+                     _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')),
+                                  _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))));
+    *ws |= (uint64_t)(uint16_t)_mm_movemask_epi8(w) << (i << 4);
+    *quote |= (uint64_t)(uint16_t)_mm_movemask_epi8(
+                  _mm_cmpeq_epi8(v, _mm_set1_epi8('"')))
+              << (i << 4);
+    *escape |= (uint64_t)(uint16_t)_mm_movemask_epi8(
+                   _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')))
+               << (i << 4);
+  }
+}
+#else  /* NEON */
+/* collects the (0x00 / 0xFF) bytes of four vectors into a 64 bit mask. */
+FIO_IFUNC uint64_t fio___json_neon_mask64(uint8x16_t m[4]) {
+  const uint8x16_t bits =
+      {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+  uint8x16_t a = vpaddq_u8(vandq_u8(m[0], bits), vandq_u8(m[1], bits));
+  uint8x16_t b = vpaddq_u8(vandq_u8(m[2], bits), vandq_u8(m[3], bits));
+  a = vpaddq_u8(a, b);
+  a = vpaddq_u8(a, a);
+  return vgetq_lane_u64(vreinterpretq_u64_u8(a), 0);
+}
+FIO_IFUNC void fio___json_classify64(const char *p,
+                                     uint64_t *ws,
+                                     uint64_t *quote,
+                                     uint64_t *escape) {
+  uint8x16_t w[4], q[4], e[4];
+  for (size_t i = 0; i < 4; ++i) {
+    const uint8x16_t v = vld1q_u8((const uint8_t *)p + (i << 4));
+    w[i] = vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8(' ')),
+                             vceqq_u8(v, vdupq_n_u8('\n'))),
+                    vorrq_u8(vceqq_u8(v, vdupq_n_u8('\r')),
+                             vceqq_u8(v, vdupq_n_u8('\t'))));
+    q[i] = vceqq_u8(v, vdupq_n_u8('"'));
+    e[i] = vceqq_u8(v, vdupq_n_u8('\\'));
+  }
+  *ws = fio___json_neon_mask64(w);
+  *quote = fio___json_neon_mask64(q);
+  *escape = fio___json_neon_mask64(e);
+}
+#endif /* NEON */
+
+/* classifies the next 64 byte block (bytes past `end` are never marked). */
+FIO_SFUNC void fio___json_index_next(fio___json_index_s *ix, const char *end) {
+  const uint64_t even = 0x5555555555555555ULL;
+  const char *p = ix->next;
+  uint64_t bs, follows, odd_starts, even_starts;
+  ix->next += 64;
+  if (FIO_LIKELY(end - p >= 64)) {
+    fio___json_classify64(p, &ix->ws, &ix->quote, &ix->escape);
+  } else {
+    char tail[64] = {0}; /* don't read past the end of the buffer */
+    if (end > p)
+      FIO_MEMCPY(tail, p, (size_t)(end - p));
+    fio___json_classify64(tail, &ix->ws, &ix->quote, &ix->escape);
+  }
+  /* find bytes escaped by odd length backslash sequences (simdjson's way) */
+  bs = ix->escape & ~ix->escaped;
+  follows = (bs << 1) | ix->escaped;
+  odd_starts = bs & ~even & ~follows;
+  even_starts = odd_starts + bs;
+  ix->escaped = (even_starts < bs); /* a sequence ran past the block */
+  ix->quote &= ~((even ^ (even_starts << 1)) & follows);
+}
+#endif /* FIO___JSON_INDEX */
+
+#if FIO___JSON_INDEX
+/* skips white space (at `s->pos`) using the index. */
+FIO_SFUNC int fio___json_index_skip_whitespace(fio___json_state_s *s) {
+  fio___json_index_s *ix = &s->index;
+  uint64_t m;
+  while (s->pos >= ix->next) /* the consumer never moves backwards */
+    fio___json_index_next(ix, s->end);
+  m = ~ix->ws & (~(uint64_t)0 << (64 - (ix->next - s->pos)));
+  for (;;) {
+    if (m) {
+      s->pos = ix->next - 64 + fio_lsb_index_unsafe(m);
+      if (s->pos < s->end)
+        return 0;
+      break;
+    }
+    if (ix->next >= s->end)
+      break;
+    fio___json_index_next(ix, s->end);
+    m = ~ix->ws;
+  }
+  s->pos = s->end;
+  return (s->error = -1);
+}
+#endif /* FIO___JSON_INDEX */
+
 FIO_IFUNC int fio___json_consume_whitespace(fio___json_state_s *s) {
   FIO_JSON___PRINT_STEP(s, "white space");
+#if FIO___JSON_INDEX
+  /* short runs (i.e., `": "`) are faster to test than to look up */
+  for (size_t i = 0; i < 2 && s->pos < s->end; ++i) {
+    if (!(((uint8_t)*s->pos == 0x09U) | ((uint8_t)*s->pos == 0x0AU) |
+          ((uint8_t)*s->pos == 0x0DU) | ((uint8_t)*s->pos == 0x20U)))
+      return 0;
+    ++s->pos;
+  }
+  if (s->pos < s->end)
+    return fio___json_index_skip_whitespace(s);
+  return (s->error = -1);
+#else
   while (s->pos < s->end) {
     if (!(((uint8_t)*s->pos == 0x09U) | ((uint8_t)*s->pos == 0x0AU) |
           ((uint8_t)*s->pos == 0x0DU) | ((uint8_t)*s->pos == 0x20U)))
@@ -158,6 +330,7 @@ FIO_IFUNC int fio___json_consume_whitespace(fio___json_state_s *s) {
     ++s->pos;
   }
   return (s->error = -1);
+#endif
 }
 FIO_IFUNC int fio___json_consume_comma(fio___json_state_s *s) {
   FIO_JSON___PRINT_STEP(s, "comma");
@@ -316,7 +489,38 @@ FIO_IFUNC void *fio___json_consume_string_any(fio___json_state_s *s,
 
 FIO_SFUNC void *fio___json_consume_string(fio___json_state_s *s) {
   FIO_JSON___PRINT_STEP(s, "double quote string");
+#if FIO___JSON_INDEX
+  fio___json_index_s *ix = &s->index;
+  const char *start = ++s->pos;
+  uint64_t m, escaped = 0;
+  if (start >= s->end)
+    goto unterminated;
+  while (start >= ix->next)
+    fio___json_index_next(ix, s->end);
+  m = ~(uint64_t)0 << (64 - (ix->next - start));
+  for (;;) {
+    const uint64_t quote = ix->quote & m;
+    if (quote) { /* jump to the closing quote */
+      s->pos = ix->next - 64 + fio_lsb_index_unsafe(quote);
+      escaped |= ix->escape & m & ((quote & (0 - quote)) - 1);
+      return (escaped ? s->cb.on_string : s->cb.on_string_simple)(
+          s->udata,
+          start,
+          (size_t)((s->pos++) - start));
+    }
+    escaped |= ix->escape & m;
+    if (ix->next >= s->end)
+      break;
+    fio___json_index_next(ix, s->end);
+    m = ~(uint64_t)0;
+  }
+unterminated:
+  s->pos = s->end;
+  s->error = 1;
+  return NULL;
+#else
   return fio___json_consume_string_any(s, '"');
+#endif
 }
 
 FIO_SFUNC void *fio___json_consume_string_single_quote(fio___json_state_s *s) {
@@ -654,6 +858,9 @@ SFUNC fio_json_result_s fio_json_parse(fio_json_parser_callbacks_s *callbacks,
       .pos = start,
       .end = start + len,
   };
+#if FIO___JSON_INDEX
+  state.index.next = start;
+#endif
 
   /* skip BOM, if exists */
   if (len >= 3 && state.pos[0] == (char)0xEF && state.pos[1] == (char)0xBB &&
@@ -749,6 +956,9 @@ SFUNC fio_json_result_s fio_json_parse_update(fio_json_parser_callbacks_s *s,
       .pos = start,
       .end = start + len,
   };
+#if FIO___JSON_INDEX
+  state.index.next = start;
+#endif
   state.ctx = (void *)ex_data;
   /* skip BOM, if exists */
   if (len >= 3 && state.pos[0] == (char)0xEF && state.pos[1] == (char)0xBB &&
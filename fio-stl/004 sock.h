@@ -73,6 +73,19 @@ extern struct fio___winsock_fn_s {
  * WSASend/WSARecv are for IOCP/overlapped I/O which this library does not use.
  */
 IFUNC ssize_t fio_sock_write(fio_socket_i fd, const void *buf, size_t len);
+/** Acts as POSIX writev (emulated with `send`, stops at a partial write). */
+IFUNC ssize_t fio_sock_writev(fio_socket_i fd,
+                              const fio_buf_info_s *vec,
+                              size_t count);
+/** Zero-copy file transmission isn't available on Windows (sets `ENOTSUP`). */
+FIO_IFUNC ssize_t fio_sock_sendfile(fio_socket_i fd,
+                                    int file,
+                                    size_t offset,
+                                    size_t len) {
+  errno = ENOTSUP;
+  return -1;
+  (void)fd, (void)file, (void)offset, (void)len;
+}
 /** Acts as POSIX read. Use this function for portability with WinSock2. */
 IFUNC ssize_t fio_sock_read(fio_socket_i fd, void *buf, size_t len);
 /** Acts as POSIX close. Use this function for portability with WinSock2. */
@@ -169,15 +182,135 @@ typedef int fio_socket_i;
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #include <unistd.h>
 #ifndef FIO_SOCK_FD_ISVALID
 #define FIO_SOCK_FD_ISVALID(fd) ((fio_socket_i)(fd) != FIO_SOCKET_INVALID)
 #endif
+#ifndef FIO_SOCK_WRITEV_MAX
+/** Maximum number of buffers `fio_sock_writev` sends in a single call. */
+#define FIO_SOCK_WRITEV_MAX 64
+#endif
 /** Acts as POSIX write. Use this function for portability with WinSock2. */
 FIO_IFUNC ssize_t fio_sock_write(fio_socket_i fd, const void *buf, size_t len) {
   return write(fd, buf, len);
 }
+/**
+ * Acts as POSIX writev, gathering up to `FIO_SOCK_WRITEV_MAX` buffers into a
+ * single system call. Use this function for portability with WinSock2.
+ */
+FIO_IFUNC ssize_t fio_sock_writev(fio_socket_i fd,
+                                  const fio_buf_info_s *vec,
+                                  size_t count) {
+  struct iovec iov[FIO_SOCK_WRITEV_MAX];
+  if (count > FIO_SOCK_WRITEV_MAX)
+    count = FIO_SOCK_WRITEV_MAX;
+  for (size_t i = 0; i < count; ++i)
+    iov[i] = (struct iovec){.iov_base = vec[i].buf, .iov_len = vec[i].len};
+  return writev(fd, iov, (int)count);
+}
+
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#ifdef SPLICE_F_MOVE
+#include <pthread.h>
+static __thread int fio___sock_splice_pipe[2] = {-1, -1};
+static pthread_key_t fio___sock_splice_key;
+static pthread_once_t fio___sock_splice_once = PTHREAD_ONCE_INIT;
+static int fio___sock_splice_key_set;
+
+/* closes the `splice` pipe of a thread (called when the thread exits). */
+FIO_SFUNC void fio___sock_splice_pipe_close(void *pipe_) {
+  int *pipe_fd = (int *)pipe_;
+  if (pipe_fd[0] != -1) {
+    close(pipe_fd[0]);
+    close(pipe_fd[1]);
+  }
+  pipe_fd[0] = pipe_fd[1] = -1;
+}
+
+FIO_SFUNC void fio___sock_splice_key_init(void) {
+  fio___sock_splice_key_set =
+      !pthread_key_create(&fio___sock_splice_key, fio___sock_splice_pipe_close);
+}
+
+/* `splice` fallback through a per-thread pipe (re-created after `fork`). */
+FIO_SFUNC ssize_t fio___sock_splice(fio_socket_i fd,
+                                    int file,
+                                    size_t offset,
+                                    size_t len) {
+  static __thread pid_t pipe_pid = 0;
+  int *pipe_fd = fio___sock_splice_pipe;
+  char drain[4096];
+  if (pipe_pid != getpid()) {
+    fio___sock_splice_pipe_close(pipe_fd);
+    if (pipe2(pipe_fd, O_NONBLOCK | O_CLOEXEC))
+      return -1;
+    pipe_pid = getpid();
+    /* the pipe is closed when the thread exits */
+    pthread_once(&fio___sock_splice_once, fio___sock_splice_key_init);
+    if (fio___sock_splice_key_set)
+      pthread_setspecific(fio___sock_splice_key, pipe_fd);
+  }
+  if (len > 65536)
+    len = 65536; /* default pipe capacity */
+  loff_t off = (loff_t)offset;
+  ssize_t in = splice(file,
+                      &off,
+                      pipe_fd[1],
+                      NULL,
+                      len,
+                      SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  if (in <= 0)
+    return in;
+  ssize_t out = splice(pipe_fd[0],
+                       NULL,
+                       fd,
+                       NULL,
+                       (size_t)in,
+                       SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  if (out == in)
+    return out;
+  /* the socket is full: file data is re-read by offset, so discard leftovers */
+  const int old_errno = errno;
+  while (read(pipe_fd[0], drain, sizeof(drain)) > 0)
+    ;
+  errno = old_errno;
+  return out;
+}
+#endif /* SPLICE_F_MOVE */
+
+/**
+ * Sends up to `len` bytes from `file` (starting at `offset`) to the socket
+ * without copying the data to user space (`sendfile`, falling back to `splice`
+ * through a pipe). The file's position is never changed.
+ *
+ * Returns the number of bytes sent, or -1 on error (`ENOTSUP` if unavailable).
+ */
+FIO_IFUNC ssize_t fio_sock_sendfile(fio_socket_i fd,
+                                    int file,
+                                    size_t offset,
+                                    size_t len) {
+  off_t off = (off_t)offset;
+  ssize_t r = sendfile(fd, file, &off, len);
+#ifdef SPLICE_F_MOVE
+  if (r == -1 && (errno == EINVAL || errno == ENOSYS))
+    r = fio___sock_splice(fd, file, offset, len);
+#endif
+  return r;
+}
+#else
+/** Zero-copy file transmission is only implemented on Linux. */
+FIO_IFUNC ssize_t fio_sock_sendfile(fio_socket_i fd,
+                                    int file,
+                                    size_t offset,
+                                    size_t len) {
+  errno = ENOTSUP;
+  return -1;
+  (void)fd, (void)file, (void)offset, (void)len;
+}
+#endif /* __linux__ */
 /** Acts as POSIX read. Use this function for portability with WinSock2. */
 FIO_IFUNC ssize_t fio_sock_read(fio_socket_i fd, void *buf, size_t len) {
   return read(fd, buf, len);
@@ -293,6 +426,8 @@ typedef enum {
 #define FIO_SOCK_UNIX         0
 #define FIO_SOCK_UNIX_PRIVATE 0
 #endif
+  /* server sockets share the port with other `SO_REUSEPORT` sockets */
+  FIO_SOCK_REUSE_PORT = 64,
 } fio_sock_open_flags_e;
 
 /**
@@ -333,7 +468,12 @@ FIO_IFUNC void fio_sock_address_free(struct addrinfo *a);
  */
 SFUNC fio_buf_info_s fio_sock_peer_addr(fio_socket_i s);
 
-/** Creates a new network socket and binds it to a local address. */
+/**
+ * Creates a new network socket and binds it to a local address.
+ *
+ * Any `nonblock` bit other than `FIO_SOCK_REUSE_PORT` requests non-blocking
+ * mode. The `FIO_SOCK_REUSE_PORT` bit sets `SO_REUSEPORT` (where supported).
+ */
 SFUNC fio_socket_i fio_sock_open_local(struct addrinfo *addr, int nonblock);
 
 /** Creates a new network socket and connects it to a remote address. */
@@ -409,7 +549,9 @@ FIO_IFUNC fio_socket_i fio_sock_open(const char *restrict address,
     if ((flags & FIO_SOCK_CLIENT)) {
       fd = fio_sock_open_remote(addr, (flags & FIO_SOCK_NONBLOCK));
     } else {
-      fd = fio_sock_open_local(addr, (flags & FIO_SOCK_NONBLOCK));
+      fd = fio_sock_open_local(
+          addr,
+          (flags & (FIO_SOCK_NONBLOCK | FIO_SOCK_REUSE_PORT)));
       if (FIO_SOCK_FD_ISVALID(fd) && fio_sock_listen(fd, SOMAXCONN) == -1) {
         FIO_LOG_ERROR("(fio_sock_open) failed on call to listen: %s",
                       strerror(errno));
@@ -428,7 +570,9 @@ FIO_IFUNC fio_socket_i fio_sock_open(const char *restrict address,
     if ((flags & FIO_SOCK_CLIENT)) {
       fd = fio_sock_open_remote(addr, (flags & FIO_SOCK_NONBLOCK));
     } else {
-      fd = fio_sock_open_local(addr, (flags & FIO_SOCK_NONBLOCK));
+      fd = fio_sock_open_local(
+          addr,
+          (flags & (FIO_SOCK_NONBLOCK | FIO_SOCK_REUSE_PORT)));
     }
     fio_sock_address_free(addr);
     return fd;
@@ -680,7 +824,19 @@ SFUNC fio_socket_i fio_sock_open_local(struct addrinfo *addr, int nonblock) {
                           &optval,
                           sizeof(optval));
     }
-    if (nonblock && fio_sock_set_non_block(fd) == -1) {
+#ifdef SO_REUSEPORT
+    if ((nonblock & FIO_SOCK_REUSE_PORT)) { /* kernel load balanced accept */
+      int optval = 1;
+      if (fio_sock_setsockopt(fd,
+                              SOL_SOCKET,
+                              SO_REUSEPORT,
+                              &optval,
+                              sizeof(optval)) == -1)
+        FIO_LOG_DEBUG("Couldn't set SO_REUSEPORT %s", strerror(errno));
+    }
+#endif
+    if ((nonblock & ~(int)FIO_SOCK_REUSE_PORT) &&
+        fio_sock_set_non_block(fd) == -1) {
       FIO_LOG_DEBUG("Couldn't set socket to non-blocking mode %s",
                     strerror(errno));
       fio_sock_close(fd);
@@ -1089,6 +1245,21 @@ IFUNC ssize_t fio_sock_write(fio_socket_i fd, const void *buf, size_t len) {
   }
   return (ssize_t)r;
 }
+/** Acts as POSIX writev (emulated with `send`, stops at a partial write). */
+IFUNC ssize_t fio_sock_writev(fio_socket_i fd,
+                              const fio_buf_info_s *vec,
+                              size_t count) {
+  ssize_t total = 0;
+  for (size_t i = 0; i < count; ++i) {
+    const ssize_t r = fio_sock_write(fd, vec[i].buf, vec[i].len);
+    if (r < 0)
+      return (total ? total : r);
+    total += r;
+    if ((size_t)r != vec[i].len)
+      break;
+  }
+  return total;
+}
 /** Acts as POSIX read. Use this function for portability with WinSock2. */
 IFUNC ssize_t fio_sock_read(fio_socket_i fd, void *buf, size_t len) {
   const int r = fio___winsock_fn.recv(fd, (char *)buf, (int)len, 0);
@@ -164,6 +164,71 @@ SFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME, mmap)(size_t size);
  */
 SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_after_fork)(void);
 
+/* *****************************************************************************
+Memory Allocation - telemetry
+***************************************************************************** */
+#ifndef H___FIO_MALLOC_STATS___H
+#define H___FIO_MALLOC_STATS___H
+/** Allocator statistics, see `fio_malloc_stats`. */
+typedef struct {
+  /** bytes reserved by allocations (including freed slices of live blocks) */
+  size_t bytes_in_use;
+  /** bytes held by the allocator (system allocations, including cached) */
+  size_t bytes_held;
+  /** system allocations (chunks) held, including cached chunks */
+  size_t chunks;
+  /** chunks kept in the cache for reuse */
+  size_t chunks_cached;
+  /** blocks held by arenas or by live allocations */
+  size_t blocks;
+  /** free blocks, available without a system call */
+  size_t blocks_free;
+  /** full blocks kept alive by `FIO_MEMORY_PINNED_SLICES` or fewer slices */
+  size_t blocks_pinned;
+  /** chunks used for big allocations */
+  size_t big_blocks;
+  /** live page-backed (mmap) allocations */
+  size_t mmap_count;
+  /** bytes held by live page-backed (mmap) allocations */
+  size_t mmap_bytes;
+  /** chunk requests served by the chunk cache */
+  size_t chunk_cache_hits;
+  /** chunk requests that required a system call */
+  size_t chunk_cache_misses;
+  /** small allocations served by a thread cache */
+  size_t thread_cache_hits;
+  /** thread cache refills */
+  size_t thread_cache_misses;
+  /** arena lock contention (failed `trylock` attempts) */
+  size_t arena_contention;
+  /** size class lock contention (thread cache refills) */
+  size_t class_contention;
+  /** the number of arenas */
+  size_t arenas;
+} fio_malloc_stats_s;
+
+/** Adds the statistics in `src` to `dest` (i.e., to aggregate processes). */
+FIO_IFUNC void fio_malloc_stats_add(fio_malloc_stats_s *dest,
+                                    const fio_malloc_stats_s *src) {
+  size_t *d = (size_t *)dest;
+  const size_t *s = (const size_t *)src;
+  for (size_t i = 0; i < sizeof(*dest) / sizeof(size_t); ++i)
+    d[i] += s[i];
+}
+#endif /* H___FIO_MALLOC_STATS___H */
+
+/**
+ * Returns a snapshot of the allocator's statistics.
+ *
+ * The counters are maintained at all times and reading them doesn't lock the
+ * allocator, so this is cheap enough to poll in production. Values are
+ * collected without a lock and may be slightly out of sync with each other.
+ */
+SFUNC fio_malloc_stats_s FIO_NAME(FIO_MEMORY_NAME, malloc_stats)(void);
+
+/** Returns an arena's lock contention count (see `malloc_arenas`). */
+SFUNC size_t FIO_NAME(FIO_MEMORY_NAME, malloc_arena_contention)(size_t arena);
+
 /* *****************************************************************************
 Memory Allocation - configuration macros
 
@@ -288,6 +353,33 @@ NOTE: most configuration values should be a power of 2 or a logarithmic value.
 #define FIO_MEMORY_WARMUP 0
 #endif
 
+#ifndef FIO_MEMORY_THREAD_CACHE
+/**
+ * The number of freed small allocations each thread keeps for reuse, per size
+ * class (0 disables the per-thread caches).
+ *
+ * Cached allocations are reused without locking. Caches are refilled and
+ * drained in batches of half this number.
+ */
+#define FIO_MEMORY_THREAD_CACHE 64
+#endif
+
+#ifndef FIO_MEMORY_THREAD_CACHE_CLASSES
+/**
+ * The number of size classes served by the per-thread caches, where class `i`
+ * holds allocations of `(i + 1) * FIO_MEMORY_ALIGN_SIZE` bytes.
+ */
+#define FIO_MEMORY_THREAD_CACHE_CLASSES 8
+#endif
+
+#ifndef FIO_MEMORY_PINNED_SLICES
+/**
+ * A full block kept alive by this many live allocations (or fewer) is reported
+ * as "pinned" by `malloc_stats` (the rest of the block can't be reused).
+ */
+#define FIO_MEMORY_PINNED_SLICES 8
+#endif
+
 #ifndef FIO_MEMORY_USE_THREAD_MUTEX
 #if FIO_USE_THREAD_MUTEX_TMP
 #define FIO_MEMORY_USE_THREAD_MUTEX FIO_USE_THREAD_MUTEX
@@ -367,6 +459,18 @@ Memory Allocation - configuration value - results and constants
 #define FIO_MEMORY_ALLOC_LIMIT FIO_MEMORY_BLOCK_ALLOC_LIMIT
 #endif
 
+#if FIO_MEMORY_PINNED_SLICES < 1
+#undef FIO_MEMORY_PINNED_SLICES
+#define FIO_MEMORY_PINNED_SLICES 1
+#endif
+
+/* thread caches are flushed on thread exit (requires `pthread_key_create`) */
+#if !FIO_OS_POSIX || FIO_MEMORY_THREAD_CACHE_CLASSES < 1 ||                    \
+    FIO_MEMORY_THREAD_CACHE < 2
+#undef FIO_MEMORY_THREAD_CACHE
+#define FIO_MEMORY_THREAD_CACHE 0
+#endif
+
 /* *****************************************************************************
 Memory Allocation - configuration access - UNSTABLE API!!!
 ***************************************************************************** */
@@ -1023,6 +1127,14 @@ SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_print_settings)(void) {}
 SFUNC size_t FIO_NAME(FIO_MEMORY_NAME, malloc_block_size)(void) { return 0; }
 void fio_malloc_arenas___(void);
 SFUNC size_t FIO_NAME(FIO_MEMORY_NAME, malloc_arenas)(void) { return 0; }
+SFUNC fio_malloc_stats_s FIO_NAME(FIO_MEMORY_NAME, malloc_stats)(void) {
+  fio_malloc_stats_s r = {0};
+  return r;
+}
+SFUNC size_t FIO_NAME(FIO_MEMORY_NAME, malloc_arena_contention)(size_t arena) {
+  return 0;
+  (void)arena;
+}
 
 #ifdef FIO_TEST_ALL
 SFUNC void FIO_NAME_TEST(FIO_NAME(stl, FIO_MEMORY_NAME), mem)(void) {
@@ -1185,6 +1297,10 @@ Chunk and Block data / header
 typedef struct {
   volatile int32_t ref;
   volatile int32_t pos;
+#if FIO_MEMORY_THREAD_CACHE
+  /* thread cache size class + 1, or 0 for blocks shared by all sizes */
+  int32_t cls;
+#endif
 } FIO_NAME(FIO_MEMORY_NAME, __mem_block_s);
 
 typedef struct {
@@ -1209,11 +1325,16 @@ typedef struct {
 Arena type
 ***************************************************************************** */
 #define FIO___MEM_ARENA_CACHE_ALIGN_VAL                                        \
-  (sizeof(void *) + sizeof(int32_t) + sizeof(FIO_MEMORY_LOCK_TYPE))
+  (sizeof(void *) + sizeof(int32_t) + sizeof(FIO_MEMORY_LOCK_TYPE) +           \
+   (sizeof(size_t) << 1))
 typedef struct {
   void *block;
   int32_t last_pos;
   FIO_MEMORY_LOCK_TYPE lock;
+  /* allocation units sliced by the arena (telemetry, updated in lock) */
+  size_t sliced;
+  /* failed attempts to lock the arena (telemetry) */
+  volatile size_t contended;
   /* cache line padding */
   uint8_t pad_for_cache___[FIO___MEM_ARENA_CACHE_ALIGN_VAL >= 128
                                ? 0
@@ -1267,11 +1388,60 @@ struct FIO_NAME(FIO_MEMORY_NAME, __mem_state_s) {
                           ? sizeof(FIO_LIST_HEAD)
                           : sizeof(FIO_MEMORY_LOCK_TYPE))))];
 
+#if FIO_MEMORY_THREAD_CACHE
+  /** size class blocks, sliced in batches to refill thread caches */
+  FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) cls[FIO_MEMORY_THREAD_CACHE_CLASSES];
+#endif /* FIO_MEMORY_THREAD_CACHE */
+
+  /** telemetry counters (see `malloc_stats`) */
+  struct {
+    /* system allocations (chunks) held, including cached and big-blocks */
+    volatile size_t chunks;
+    volatile size_t chunk_cache_hits;
+    volatile size_t chunk_cache_misses;
+    /* blocks in the free list (updated in the state lock) */
+    size_t blocks_free;
+    volatile size_t blocks_pinned;
+    volatile size_t big_blocks;
+    /* allocation units sliced for big allocations (updated in big_lock) */
+    size_t big_sliced;
+    /* allocation units reclaimed when blocks (and big-blocks) are reset */
+    volatile size_t reclaimed;
+    volatile size_t thread_cache_hits;
+    volatile size_t thread_cache_misses;
+  } stats;
+
   /** the arena count for the allocator */
   size_t arena_count;
   FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) arena[];
 } * FIO_NAME(FIO_MEMORY_NAME, __mem_state) FIO_WEAK;
 
+/* page-backed (mmap) allocations are independent of the allocator state */
+static volatile size_t FIO_NAME(FIO_MEMORY_NAME, __mem_mmap_count);
+static volatile size_t FIO_NAME(FIO_MEMORY_NAME, __mem_mmap_bytes);
+
+#if FIO_MEMORY_THREAD_CACHE
+#include <pthread.h>
+/** A thread's cache of freed small allocations. */
+typedef struct {
+  struct {
+    /* freed slices, linked through their first word */
+    void *head;
+    size_t count;
+  } cls[FIO_MEMORY_THREAD_CACHE_CLASSES];
+  /* set once the thread exit destructor was registered */
+  size_t registered;
+  /* cache hits not yet published to the allocator's telemetry */
+  size_t hits;
+} FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_s);
+
+static __thread FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_s)
+    FIO_NAME(FIO_MEMORY_NAME, __mem_tcache);
+/* flushes the thread cache when a thread exits */
+static pthread_key_t FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_key);
+static volatile size_t FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_key_set);
+#endif /* FIO_MEMORY_THREAD_CACHE */
+
 /* *****************************************************************************
 Arena assignment
 ***************************************************************************** */
@@ -1327,6 +1497,9 @@ FIO_SFUNC FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *
     if (!FIO_MEMORY_TRYLOCK(
             FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[arena_index].lock))
       return (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena + arena_index);
+    fio_atomic_add(
+        &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[arena_index].contended,
+        1);
     FIO_LOG_DDEBUG("thread %p had to switch arena from %zu / %zu",
                    (void *)fio_thread_nid(),
                    arena_index,
@@ -1396,6 +1569,9 @@ FIO_SFUNC FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *
     if (!FIO_MEMORY_TRYLOCK(
             FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[arena_index].lock))
       return (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena + arena_index);
+    fio_atomic_add(
+        &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[arena_index].contended,
+        1);
     FIO_LOG_DDEBUG("thread %p had to switch arena from %zu / %zu",
                    (void *)fio_thread_nid(),
                    arena_index,
@@ -1491,6 +1667,9 @@ FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_block_free)(void *ptr);
 FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_big_block_free)(void *ptr);
 FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_free)(
     FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) * c);
+#if FIO_MEMORY_THREAD_CACHE
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_flush)(void *tcache);
+#endif
 
 /* IDE marker */
 void fio___mem_state_cleanup___(void);
@@ -1505,6 +1684,18 @@ FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_state_cleanup)(void *ignr_) {
   FIO_LOG_DDEBUG2(
       "starting facil.io memory allocator cleanup for " FIO_MACRO2STR(
           FIO_NAME(FIO_MEMORY_NAME, malloc)) ".");
+#if FIO_MEMORY_THREAD_CACHE
+  /* the exiting thread's cache (other threads flush when they exit) */
+  FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_flush)
+  (&FIO_NAME(FIO_MEMORY_NAME, __mem_tcache));
+  for (size_t i = 0; i < FIO_MEMORY_THREAD_CACHE_CLASSES; ++i) {
+    FIO_NAME(FIO_MEMORY_NAME, __mem_block_free)
+    (FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cls[i].block);
+    FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cls[i].block = NULL;
+    FIO_MEMORY_LOCK_TYPE_INIT(
+        FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cls[i].lock);
+  }
+#endif /* FIO_MEMORY_THREAD_CACHE */
   /* free arena blocks */
   for (size_t i = 0; i < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count;
        ++i) {
@@ -1607,6 +1798,12 @@ FIO_CONSTRUCTOR(FIO_NAME(FIO_MEMORY_NAME, __mem_state_setup)) {
   fio_state_callback_add(FIO_CALL_AFTER_EXIT,
                          FIO_NAME(FIO_MEMORY_NAME, __mem_state_cleanup),
                          NULL);
+#if FIO_MEMORY_THREAD_CACHE
+  if (!FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_key_set))
+    FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_key_set) =
+        !pthread_key_create(&FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_key),
+                            FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_flush));
+#endif /* FIO_MEMORY_THREAD_CACHE */
   /* allocate the state machine */
   {
 #if FIO_MEMORY_ARENA_COUNT > 0
@@ -1689,6 +1886,12 @@ SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_after_fork)(void) {
     FIO_MEMORY_LOCK_TYPE_INIT(
         FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[i].lock);
   }
+#if FIO_MEMORY_THREAD_CACHE
+  for (size_t i = 0; i < FIO_MEMORY_THREAD_CACHE_CLASSES; ++i) {
+    FIO_MEMORY_LOCK_TYPE_INIT(
+        FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cls[i].lock);
+  }
+#endif /* FIO_MEMORY_THREAD_CACHE */
 }
 
 /* *****************************************************************************
@@ -1786,6 +1989,8 @@ FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_dealloc)(
   if (!c)
     return;
   FIO_MEMORY_ON_CHUNK_FREE(c);
+  if (FIO_NAME(FIO_MEMORY_NAME, __mem_state))
+    fio_atomic_sub(&FIO_NAME(FIO_MEMORY_NAME, __mem_state)->stats.chunks, 1);
   FIO_MEM_SYS_FREE(((void *)c), FIO_MEMORY_SYS_ALLOCATION_SIZE);
 }
 
@@ -1821,6 +2026,7 @@ FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_free)(
     if (n->prev && n->next) {
       FIO_LIST_REMOVE(n);
       n->prev = n->next = NULL;
+      --FIO_NAME(FIO_MEMORY_NAME, __mem_state)->stats.blocks_free;
     }
   }
   FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_cache_or_dealloc)(c);
@@ -1848,10 +2054,16 @@ FIO_IFUNC FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *
   }
   if (c) {
     FIO_MEMORY_ON_CHUNK_UNCACHE(c);
+    fio_atomic_add(
+        &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->stats.chunk_cache_hits,
+        1);
     *c = (FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s)){.ref = 1};
     return c;
   }
 #endif /* FIO_MEMORY_CACHE_SLOTS */
+  fio_atomic_add(
+      &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->stats.chunk_cache_misses,
+      1);
 
   /* system allocation */
   c = (FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *)FIO_MEM_SYS_ALLOC(
@@ -1861,6 +2073,7 @@ FIO_IFUNC FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *
   if (!c)
     return c;
   FIO_MEMORY_ON_CHUNK_ALLOC(c);
+  fio_atomic_add(&FIO_NAME(FIO_MEMORY_NAME, __mem_state)->stats.chunks, 1);
   c->ref = 1;
   return c;
   (void)needs_lock; /* in case it isn't used */
@@ -1873,6 +2086,9 @@ block allocation / deallocation
 FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_block__reset_memory)(
     FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) * c,
     size_t b) {
+  if (c->blocks[b].pos && FIO_NAME(FIO_MEMORY_NAME, __mem_state))
+    fio_atomic_add(&FIO_NAME(FIO_MEMORY_NAME, __mem_state)->stats.reclaimed,
+                   (size_t)c->blocks[b].pos);
 #if FIO_MEMORY_INITIALIZE_ALLOCATIONS
   if (c->blocks[b].pos >= (int32_t)(FIO_MEMORY_UNITS_PER_BLOCK - 4)) {
     /* zero out the whole block */
@@ -1902,15 +2118,21 @@ FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_block__reset_memory)(
 
 /* SublimeText marker */
 void fio___mem_block_free___(void);
-/** frees a block / decreases it's reference count */
-FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_block_free)(void *p) {
+/* set in a block's reference count once its arena is done slicing it */
+#define FIO_MEMORY_BLOCK_RETIRED ((int32_t)1 << 30)
+
+/** adds `delta` to a block's reference count, freeing it when unused */
+FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_block_release)(void *p,
+                                                              int32_t delta) {
   FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *c =
       FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(p);
+  int32_t ref;
   if (!c)
     return;
   size_t b = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(c, p);
   FIO_ASSERT_DEBUG(
-      (uint32_t)c->blocks[b].ref <= FIO_MEMORY_UNITS_PER_BLOCK + 1,
+      (uint32_t)(c->blocks[b].ref & ~FIO_MEMORY_BLOCK_RETIRED) <=
+          FIO_MEMORY_UNITS_PER_BLOCK + 1,
       "(%d) block reference count corrupted, possible double free? (%zd)",
       fio_getpid(),
       (size_t)c->blocks[b].ref);
@@ -1919,7 +2141,25 @@ FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_block_free)(void *p) {
       "(%d) block allocation position corrupted, possible double free? (%zd)",
       fio_getpid(),
       (size_t)c->blocks[b].pos);
-  if (fio_atomic_sub_fetch(&c->blocks[b].ref, 1))
+  ref = fio_atomic_add_fetch(&c->blocks[b].ref, delta);
+  if ((ref & FIO_MEMORY_BLOCK_RETIRED)) {
+    /* a full block: track blocks kept alive by only a few slices */
+    ref &= ~FIO_MEMORY_BLOCK_RETIRED;
+    if (FIO_NAME(FIO_MEMORY_NAME, __mem_state)) {
+      if (delta < 0 ? (ref == FIO_MEMORY_PINNED_SLICES)
+                    : (ref && ref <= FIO_MEMORY_PINNED_SLICES))
+        fio_atomic_add(
+            &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->stats.blocks_pinned,
+            1);
+      else if (!ref && delta < 0)
+        fio_atomic_sub(
+            &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->stats.blocks_pinned,
+            1);
+    }
+    if (ref)
+      return;
+    c->blocks[b].ref = 0;
+  } else if (ref)
     return;
 
   /* reset memory */
@@ -1933,10 +2173,22 @@ FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_block_free)(void *p) {
   FIO_LIST_NODE *n =
       (FIO_LIST_NODE *)FIO_NAME(FIO_MEMORY_NAME, __mem_chunk2ptr)(c, b, 0);
   FIO_LIST_PUSH(&FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks, n);
+  ++FIO_NAME(FIO_MEMORY_NAME, __mem_state)->stats.blocks_free;
   /* free chunk reference while in locked state */
   FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_free)(c);
 }
 
+/** frees a block / decreases it's reference count */
+FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_block_free)(void *p) {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_block_release)(p, -1);
+}
+
+/** releases an arena's reference to a full block, marking it as retired */
+FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_block_retire)(void *p) {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_block_release)
+  (p, FIO_MEMORY_BLOCK_RETIRED - 1);
+}
+
 /* SublimeText marker */
 void fio___mem_block_new___(void);
 /** returns a new block with a reference count of 1 */
@@ -1953,6 +2205,7 @@ FIO_IFUNC void *FIO_NAME(FIO_MEMORY_NAME, __mem_block_new)(void) {
     FIO_LIST_NODE *n = FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks.prev;
     FIO_LIST_REMOVE(n);
     n->next = n->prev = NULL;
+    --FIO_NAME(FIO_MEMORY_NAME, __mem_state)->stats.blocks_free;
     c = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)((void *)n);
     fio_atomic_add_fetch(&c->ref, 1);
     p = (void *)n;
@@ -1974,6 +2227,8 @@ FIO_IFUNC void *FIO_NAME(FIO_MEMORY_NAME, __mem_block_new)(void) {
         (FIO_LIST_NODE *)FIO_NAME(FIO_MEMORY_NAME, __mem_chunk2ptr)(c, b, 0);
     FIO_LIST_PUSH(&FIO_NAME(FIO_MEMORY_NAME, __mem_state)->blocks, n);
   }
+  FIO_NAME(FIO_MEMORY_NAME, __mem_state)->stats.blocks_free +=
+      FIO_MEMORY_BLOCKS_PER_ALLOCATION - 1;
   /* set block index to zero */
   b = 0;
 
@@ -1984,6 +2239,9 @@ done:
   /* update block reference and allocation position */
   c->blocks[b].ref = 1;
   c->blocks[b].pos = 0;
+#if FIO_MEMORY_THREAD_CACHE
+  c->blocks[b].cls = 0;
+#endif
   return p;
 }
 
@@ -2031,6 +2289,7 @@ FIO_IFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME,
         !((uintptr_t)is_realloc & (alignment - 1)) &&
         c->blocks[b].pos + bytes < FIO_MEMORY_UNITS_PER_BLOCK) {
       c->blocks[b].pos += bytes;
+      a->sliced += bytes;
       fio_atomic_sub(&c->blocks[b].ref, 1); /* release reference added */
       FIO_NAME(FIO_MEMORY_NAME, __mem_arena_unlock)(a);
       return is_realloc;
@@ -2052,6 +2311,7 @@ FIO_IFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME,
       a->last_pos = c->blocks[b].pos + pad;
       p = FIO_NAME(FIO_MEMORY_NAME, __mem_chunk2ptr)(c, b, a->last_pos);
       c->blocks[b].pos += pad + bytes;
+      a->sliced += pad + bytes;
       FIO_NAME(FIO_MEMORY_NAME, __mem_arena_unlock)(a);
       return p;
     }
@@ -2067,7 +2327,7 @@ FIO_IFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME,
     /* release allocation reference added */
     fio_atomic_sub(&c->blocks[b].ref, 1);
     /* release the reference held by the arena (allocator) */
-    FIO_NAME(FIO_MEMORY_NAME, __mem_block_free)(block);
+    FIO_NAME(FIO_MEMORY_NAME, __mem_block_retire)(block);
   }
 
 no_mem:
@@ -2076,10 +2336,194 @@ no_mem:
   return p;
 }
 
+/* *****************************************************************************
+Per-thread caches of small allocations
+***************************************************************************** */
+#if FIO_MEMORY_THREAD_CACHE
+
+/* the number of slices moved between a thread cache and its blocks at once */
+#define FIO_MEMORY_THREAD_CACHE_BATCH (FIO_MEMORY_THREAD_CACHE >> 1)
+
+/* SublimeText marker */
+void fio___mem_tcache___(void);
+/** Returns the calling thread's cache, registering the exit destructor. */
+FIO_IFUNC FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_s) *
+    FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_get)(void) {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_s) *tc =
+      &FIO_NAME(FIO_MEMORY_NAME, __mem_tcache);
+  if (FIO_LIKELY(tc->registered))
+    return tc;
+  if (!FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_key_set) ||
+      pthread_setspecific(FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_key),
+                          (void *)tc))
+    return NULL;
+  tc->registered = 1;
+  return tc;
+}
+
+/** Adds a thread's cache hits to the allocator's telemetry. */
+FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_publish)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_s) * tc) {
+  if (!tc->hits || !FIO_NAME(FIO_MEMORY_NAME, __mem_state))
+    return;
+  fio_atomic_add(
+      &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->stats.thread_cache_hits,
+      tc->hits);
+  tc->hits = 0;
+}
+
+/** Releases all but the `keep` most recently cached slices of a class. */
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_release)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_s) * tc,
+    size_t k,
+    size_t keep) {
+  void **pos = &tc->cls[k].head;
+  void *p;
+  if (tc->cls[k].count <= keep)
+    return;
+  tc->cls[k].count = keep;
+  while (keep--)
+    pos = (void **)*pos;
+  p = *pos;
+  *pos = NULL;
+  while (p) {
+    void *next = *(void **)p;
+    FIO_NAME(FIO_MEMORY_NAME, __mem_block_free)(p);
+    p = next;
+  }
+}
+
+/** Empties a thread cache (also the thread exit destructor). */
+FIO_SFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_flush)(void *tc_) {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_s) *tc =
+      (FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_s) *)tc_;
+  tc->registered = 0;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_publish)(tc);
+  for (size_t k = 0; k < FIO_MEMORY_THREAD_CACHE_CLASSES; ++k)
+    FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_release)(tc, k, 0);
+}
+
+/* SublimeText marker */
+void fio___mem_tcache_refill___(void);
+/** Slices a batch of class `k` allocations from the class block, 0 = OK. */
+FIO_SFUNC int FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_refill)(
+    FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_s) * tc,
+    size_t k) {
+  const size_t units = k + 1;
+  size_t count = 0;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_arena_s) *a =
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->cls + k;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_publish)(tc);
+  fio_atomic_add(
+      &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->stats.thread_cache_misses,
+      1);
+  if (FIO_MEMORY_TRYLOCK(a->lock)) {
+    fio_atomic_add(&a->contended, 1);
+    FIO_MEMORY_LOCK(a->lock);
+  }
+  while (count < FIO_MEMORY_THREAD_CACHE_BATCH) {
+    if (!a->block) {
+      a->block = FIO_NAME(FIO_MEMORY_NAME, __mem_block_new)();
+      if (!a->block)
+        break;
+      FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(a->block)
+          ->blocks[FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(
+              FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(a->block),
+              a->block)]
+          .cls = (int32_t)units;
+    }
+    void *const block = a->block;
+    FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *const c =
+        FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(block);
+    const size_t b = FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(c, block);
+    int32_t ref;
+    fio_atomic_load(ref, &c->blocks[b].ref);
+    /* if the class holds the only reference to this block - reset. */
+    if (ref == 1 && c->blocks[b].pos) {
+      FIO_NAME(FIO_MEMORY_NAME, __mem_block__reset_memory)(c, b);
+      FIO_MEMORY_ON_BLOCK_RESET_IN_LOCK(c, b);
+    }
+    size_t n = (FIO_MEMORY_UNITS_PER_BLOCK - 1 - (size_t)c->blocks[b].pos) /
+               units;
+    if (n > FIO_MEMORY_THREAD_CACHE_BATCH - count)
+      n = FIO_MEMORY_THREAD_CACHE_BATCH - count;
+    if (!n) { /* block is full, replace it before releasing the old one */
+      a->block = NULL;
+      FIO_NAME(FIO_MEMORY_NAME, __mem_block_retire)(block);
+      continue;
+    }
+    fio_atomic_add(&c->blocks[b].ref, (int32_t)n);
+    a->sliced += n * units;
+    count += n;
+    while (n--) {
+      void *p = FIO_NAME(FIO_MEMORY_NAME,
+                         __mem_chunk2ptr)(c, b, (size_t)c->blocks[b].pos);
+      c->blocks[b].pos += (int32_t)units;
+      *(void **)p = tc->cls[k].head;
+      tc->cls[k].head = p;
+    }
+  }
+  FIO_MEMORY_UNLOCK(a->lock);
+  tc->cls[k].count += count;
+  return 0 - !count;
+}
+
+/* SublimeText marker */
+void fio___mem_tcache_pop___(void);
+/** Returns a class `k` allocation from the thread cache (or NULL). */
+FIO_IFUNC void *FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_pop)(size_t k) {
+  void *p;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_s) *tc =
+      FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_get)();
+  if (!tc)
+    return NULL;
+  if (tc->cls[k].head) {
+    /* publish hits in batches, keeping the fast path free of atomics */
+    if (++tc->hits == 1024)
+      FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_publish)(tc);
+  } else if (FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_refill)(tc, k))
+    return NULL;
+  p = tc->cls[k].head;
+  tc->cls[k].head = *(void **)p;
+  --tc->cls[k].count;
+  *(void **)p = NULL;
+  return p;
+}
+
+/* SublimeText marker */
+void fio___mem_tcache_push___(void);
+/** Places a freed class `k` allocation in the thread cache, 0 = OK. */
+FIO_IFUNC int FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_push)(void *p, size_t k) {
+  FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_s) *tc;
+  if (!FIO_NAME(FIO_MEMORY_NAME, __mem_state) ||
+      !(tc = FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_get)()))
+    return -1;
+#if FIO_MEMORY_INITIALIZE_ALLOCATIONS
+  FIO_MEMSET(p, 0, (k + 1) << FIO_MEMORY_ALIGN_LOG);
+#endif
+  *(void **)p = tc->cls[k].head;
+  tc->cls[k].head = p;
+  if (++tc->cls[k].count >= FIO_MEMORY_THREAD_CACHE)
+    FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_release)
+  (tc, k, FIO_MEMORY_THREAD_CACHE - FIO_MEMORY_THREAD_CACHE_BATCH);
+  return 0;
+}
+
+#endif /* FIO_MEMORY_THREAD_CACHE */
+
 /* SublimeText marker */
 void fio_____mem_slice_free___(void);
 /** slice a block to allocate a set number of bytes. */
 FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_slice_free)(void *p) {
+#if FIO_MEMORY_THREAD_CACHE
+  FIO_NAME(FIO_MEMORY_NAME, __mem_chunk_s) *c =
+      FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2chunk)(p);
+  const int32_t cls =
+      c->blocks[FIO_NAME(FIO_MEMORY_NAME, __mem_ptr2index)(c, p)].cls;
+  if (cls &&
+      !FIO_NAME(FIO_MEMORY_NAME, __mem_tcache_push)(p, (size_t)(cls - 1)))
+    return;
+#endif /* FIO_MEMORY_THREAD_CACHE */
   FIO_NAME(FIO_MEMORY_NAME, __mem_block_free)(p);
 }
 
@@ -2105,6 +2549,9 @@ void fio___mem_big_block__reset_memory___(void);
 /** zeros out a big-block's memory, keeping it's reference count at 1. */
 FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_big_block__reset_memory)(
     FIO_NAME(FIO_MEMORY_NAME, __mem_big_block_s) * b) {
+  if (b->pos && FIO_NAME(FIO_MEMORY_NAME, __mem_state))
+    fio_atomic_add(&FIO_NAME(FIO_MEMORY_NAME, __mem_state)->stats.reclaimed,
+                   (size_t)b->pos);
 
 #if FIO_MEMORY_INITIALIZE_ALLOCATIONS
   /* zero out memory */
@@ -2146,6 +2593,9 @@ FIO_IFUNC void FIO_NAME(FIO_MEMORY_NAME, __mem_big_block_free)(void *p) {
   if (!b || fio_atomic_sub_fetch(&b->ref, 1))
     return;
   FIO_MEMORY_ON_BIG_BLOCK_UNSET(b);
+  if (FIO_NAME(FIO_MEMORY_NAME, __mem_state))
+    fio_atomic_sub(&FIO_NAME(FIO_MEMORY_NAME, __mem_state)->stats.big_blocks,
+                   1);
 
   /* zero out memory */
   FIO_NAME(FIO_MEMORY_NAME, __mem_big_block__reset_memory)(b);
@@ -2173,6 +2623,7 @@ FIO_IFUNC FIO_NAME(FIO_MEMORY_NAME, __mem_big_block_s) *
   b->marker = FIO_MEMORY_BIG_BLOCK_MARKER;
   b->ref = 1;
   b->pos = 0;
+  fio_atomic_add(&FIO_NAME(FIO_MEMORY_NAME, __mem_state)->stats.big_blocks, 1);
   FIO_MEMORY_ON_BIG_BLOCK_SET(b);
   return b;
 no_mem:
@@ -2232,6 +2683,7 @@ FIO_NAME(FIO_MEMORY_NAME, __mem_big_slice_new)(size_t bytes,
         !((uintptr_t)is_realloc & (alignment - 1)) &&
         b->pos + bytes < FIO_MEMORY_UNITS_PER_BIG_BLOCK) {
       b->pos += bytes;
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->stats.big_sliced += bytes;
       FIO_MEMORY_UNLOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_lock);
       return is_realloc;
     }
@@ -2251,6 +2703,7 @@ FIO_NAME(FIO_MEMORY_NAME, __mem_big_slice_new)(size_t bytes,
       p = FIO_NAME(FIO_MEMORY_NAME, __mem_big2ptr)(b, b->pos + pad);
       fio_atomic_add(&b->ref, 1); /* keep inside lock to enable reset */
       b->pos += pad + bytes;
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state)->stats.big_sliced += pad + bytes;
       FIO_MEMORY_UNLOCK(FIO_NAME(FIO_MEMORY_NAME, __mem_state)->big_lock);
       return p;
     }
@@ -2305,6 +2758,9 @@ FIO_IFUNC void *FIO_NAME(FIO_MEMORY_NAME, __mem_mmap_aligned)(
   FIO_MEMORY_ON_ALLOC_FUNC();
   FIO_MEMORY_ON_CHUNK_ALLOC(c);
   c->marker = (uint32_t)(pages >> FIO_MEM_PAGE_SIZE_LOG);
+  fio_atomic_add(&FIO_NAME(FIO_MEMORY_NAME, __mem_mmap_count), 1);
+  fio_atomic_add(&FIO_NAME(FIO_MEMORY_NAME, __mem_mmap_bytes),
+                 (size_t)c->marker << FIO_MEM_PAGE_SIZE_LOG);
   return (void *)((uintptr_t)c + offset);
 no_mem:
   errno = ENOMEM;
@@ -2342,6 +2798,75 @@ SFUNC size_t FIO_NAME(FIO_MEMORY_NAME, malloc_arenas)(void) {
              : 0;
 }
 
+void fio_malloc_stats___(void);
+/** Returns a snapshot of the allocator's statistics. */
+SFUNC fio_malloc_stats_s FIO_NAME(FIO_MEMORY_NAME, malloc_stats)(void) {
+  fio_malloc_stats_s r = {0};
+  size_t sliced;
+  FIO_NAME(FIO_MEMORY_NAME, __mem_state_s) *const s =
+      FIO_NAME(FIO_MEMORY_NAME, __mem_state);
+  fio_atomic_load(r.mmap_count, &FIO_NAME(FIO_MEMORY_NAME, __mem_mmap_count));
+  fio_atomic_load(r.mmap_bytes, &FIO_NAME(FIO_MEMORY_NAME, __mem_mmap_bytes));
+  r.bytes_in_use = r.mmap_bytes;
+  r.bytes_held = r.mmap_bytes;
+  if (!s)
+    return r;
+  fio_atomic_load(r.chunks, &s->stats.chunks);
+  fio_atomic_load(r.blocks_free, &s->stats.blocks_free);
+  fio_atomic_load(r.blocks_pinned, &s->stats.blocks_pinned);
+  fio_atomic_load(r.big_blocks, &s->stats.big_blocks);
+  fio_atomic_load(r.chunk_cache_hits, &s->stats.chunk_cache_hits);
+  fio_atomic_load(r.chunk_cache_misses, &s->stats.chunk_cache_misses);
+  fio_atomic_load(r.thread_cache_hits, &s->stats.thread_cache_hits);
+  fio_atomic_load(r.thread_cache_misses, &s->stats.thread_cache_misses);
+#if FIO_MEMORY_CACHE_SLOTS
+  fio_atomic_load(r.chunks_cached, &s->cache.pos);
+#endif
+  r.arenas = s->arena_count;
+  fio_atomic_load(sliced, &s->stats.big_sliced);
+  for (size_t i = 0; i < s->arena_count; ++i) {
+    size_t tmp;
+    fio_atomic_load(tmp, &s->arena[i].sliced);
+    sliced += tmp;
+    fio_atomic_load(tmp, &s->arena[i].contended);
+    r.arena_contention += tmp;
+  }
+#if FIO_MEMORY_THREAD_CACHE
+  for (size_t i = 0; i < FIO_MEMORY_THREAD_CACHE_CLASSES; ++i) {
+    size_t tmp;
+    fio_atomic_load(tmp, &s->cls[i].sliced);
+    sliced += tmp;
+    fio_atomic_load(tmp, &s->cls[i].contended);
+    r.class_contention += tmp;
+  }
+#endif
+  {
+    size_t reclaimed;
+    fio_atomic_load(reclaimed, &s->stats.reclaimed);
+    if (sliced > reclaimed) /* counters are read without a lock */
+      r.bytes_in_use += (sliced - reclaimed) << FIO_MEMORY_ALIGN_LOG;
+  }
+  r.bytes_held += r.chunks * FIO_MEMORY_SYS_ALLOCATION_SIZE;
+  if (r.chunks > r.chunks_cached + r.big_blocks) {
+    r.blocks = ((r.chunks - r.chunks_cached - r.big_blocks) *
+                FIO_MEMORY_BLOCKS_PER_ALLOCATION);
+    r.blocks = (r.blocks > r.blocks_free) ? (r.blocks - r.blocks_free) : 0;
+  }
+  return r;
+}
+
+void fio_malloc_arena_contention___(void);
+/** Returns an arena's lock contention count (see `malloc_arenas`). */
+SFUNC size_t FIO_NAME(FIO_MEMORY_NAME, malloc_arena_contention)(size_t arena) {
+  size_t r = 0;
+  if (FIO_NAME(FIO_MEMORY_NAME, __mem_state) &&
+      arena < FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena_count)
+    fio_atomic_load(
+        r,
+        &FIO_NAME(FIO_MEMORY_NAME, __mem_state)->arena[arena].contended);
+  return r;
+}
+
 SFUNC void FIO_NAME(FIO_MEMORY_NAME, malloc_print_settings)(void) {
   // FIO_LOG_DEBUG2(
   fprintf(
@@ -2445,6 +2970,18 @@ FIO_IFUNC void *FIO_MEM_ALIGN_NEW FIO_NAME(FIO_MEMORY_NAME,
 
 #endif /* FIO_MEMORY_ENABLE_BIG_ALLOC */
 
+#if FIO_MEMORY_THREAD_CACHE
+  if (!is_realloc && alignment == FIO_MEMORY_ALIGN_SIZE &&
+      size <= ((size_t)FIO_MEMORY_THREAD_CACHE_CLASSES << FIO_MEMORY_ALIGN_LOG)) {
+    p = FIO_NAME(FIO_MEMORY_NAME,
+                 __mem_tcache_pop)((size - 1) >> FIO_MEMORY_ALIGN_LOG);
+    if (p) {
+      FIO_MEMORY_ON_ALLOC_FUNC();
+      return p;
+    }
+  }
+#endif /* FIO_MEMORY_THREAD_CACHE */
+
   p = FIO_NAME(FIO_MEMORY_NAME, __mem_slice_new)(size, is_realloc, alignment);
   if (p && p != is_realloc) {
     FIO_MEMORY_ON_ALLOC_FUNC();
@@ -2608,6 +3145,9 @@ mmap_free:
              ((size_t)c->marker << FIO_MEM_PAGE_SIZE_LOG) -
                  ((uintptr_t)ptr - (uintptr_t)c));
   FIO_MEMORY_ON_CHUNK_FREE(c);
+  fio_atomic_sub(&FIO_NAME(FIO_MEMORY_NAME, __mem_mmap_count), 1);
+  fio_atomic_sub(&FIO_NAME(FIO_MEMORY_NAME, __mem_mmap_bytes),
+                 (size_t)c->marker << FIO_MEM_PAGE_SIZE_LOG);
   FIO_MEM_SYS_FREE(c, (size_t)c->marker << FIO_MEM_PAGE_SIZE_LOG);
 }
 
@@ -2641,6 +3181,8 @@ FIO_SFUNC void *FIO_NAME(FIO_MEMORY_NAME, __mem_realloc2_big)(
       FIO_MEMORY_SYS_ALLOCATION_SIZE_LOG);
   if (!c)
     return NULL;
+  fio_atomic_add(&FIO_NAME(FIO_MEMORY_NAME, __mem_mmap_bytes),
+                 new_len - ((size_t)c->marker << FIO_MEM_PAGE_SIZE_LOG));
   c->marker = (uint32_t)(new_len >> FIO_MEM_PAGE_SIZE_LOG);
   return (void *)((uintptr_t)c + offset);
 }
@@ -3135,6 +3677,11 @@ Memory pool cleanup
 // #undef FIO_MEMORY_ARENA_COUNT_FALLBACK
 // #undef FIO_MEMORY_ARENA_COUNT_MAX
 #undef FIO_MEMORY_WARMUP
+#undef FIO_MEMORY_THREAD_CACHE
+#undef FIO_MEMORY_THREAD_CACHE_CLASSES
+#undef FIO_MEMORY_THREAD_CACHE_BATCH
+#undef FIO_MEMORY_PINNED_SLICES
+#undef FIO_MEMORY_BLOCK_RETIRED
 
 #undef FIO_MEMORY_LOCK_NAME
 #undef FIO_MEMORY_LOCK_TYPE
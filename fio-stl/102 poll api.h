@@ -42,11 +42,12 @@ Possible polling engine (system call) selection
  *   #define FIO_POLL_ENGINE_POLL    - use POSIX poll() / WSAPoll
  *   #define FIO_POLL_ENGINE_EPOLL   - use Linux epoll
  *   #define FIO_POLL_ENGINE_KQUEUE  - use BSD/macOS kqueue
+ *   #define FIO_POLL_ENGINE_URING   - use Linux io_uring (5.11+, opt-in only)
  */
 
 /* Auto-select only if the user made no explicit choice. */
 #if !defined(FIO_POLL_ENGINE_POLL) && !defined(FIO_POLL_ENGINE_EPOLL) &&       \
-    !defined(FIO_POLL_ENGINE_KQUEUE)
+    !defined(FIO_POLL_ENGINE_KQUEUE) && !defined(FIO_POLL_ENGINE_URING)
 #if defined(HAVE_EPOLL) || __has_include("sys/epoll.h")
 #define FIO_POLL_ENGINE_EPOLL
 #elif defined(HAVE_KQUEUE) || __has_include("sys/event.h")
@@ -60,6 +61,8 @@ Possible polling engine (system call) selection
 #define FIO_POLL_ENGINE_STR "epoll"
 #elif defined(FIO_POLL_ENGINE_KQUEUE)
 #define FIO_POLL_ENGINE_STR "kqueue"
+#elif defined(FIO_POLL_ENGINE_URING)
+#define FIO_POLL_ENGINE_STR "io_uring"
 #else /* defined(FIO_POLL_ENGINE_POLL) */
 #define FIO_POLL_ENGINE_STR "poll"
 #endif
@@ -133,6 +136,76 @@ SFUNC int fio_poll_review(fio_poll_s *p, size_t timeout);
 /** Stops monitoring the specified file descriptor (if monitoring). */
 SFUNC int fio_poll_forget(fio_poll_s *p, fio_socket_i fd);
 
+/* *****************************************************************************
+Completion Based I/O (io_uring - other engines call the system directly)
+***************************************************************************** */
+
+#ifndef FIO_POLL_IO
+/** `fio_poll_monitor` flag: the engine may receive / send the (stream) data. */
+#define FIO_POLL_IO 0x4000
+#endif
+#ifndef FIO_POLL_ACCEPT
+/** `fio_poll_monitor` flag: the engine may accept the listener's clients. */
+#define FIO_POLL_ACCEPT 0x8000
+#endif
+
+#if defined(FIO_POLL_ENGINE_URING)
+/** Reads data the engine received for `fd`, behaves like `read`. */
+SFUNC ssize_t fio_poll_read(fio_poll_s *p,
+                            fio_socket_i fd,
+                            void *buf,
+                            size_t len);
+/** Copies data into a send request for `fd`, returning the bytes accepted. */
+SFUNC ssize_t fio_poll_write(fio_poll_s *p,
+                             fio_socket_i fd,
+                             const void *buf,
+                             size_t len);
+/** Same as `fio_poll_write`, gathering the data from `count` buffers. */
+SFUNC ssize_t fio_poll_writev(fio_poll_s *p,
+                              fio_socket_i fd,
+                              const fio_buf_info_s *vec,
+                              size_t count);
+/** Returns -1 (`EWOULDBLOCK`) while data written to `fd` is being sent. */
+SFUNC int fio_poll_flush(fio_poll_s *p, fio_socket_i fd);
+/** Returns a client the engine accepted for the listening socket `fd`. */
+SFUNC fio_socket_i fio_poll_accept(fio_poll_s *p, fio_socket_i fd);
+#else
+/** Reads data the engine received for `fd`, behaves like `read`. */
+FIO_IFUNC ssize_t fio_poll_read(fio_poll_s *p,
+                                fio_socket_i fd,
+                                void *buf,
+                                size_t len) {
+  return fio_sock_read(fd, buf, len);
+  (void)p;
+}
+/** Copies data into a send request for `fd`, returning the bytes accepted. */
+FIO_IFUNC ssize_t fio_poll_write(fio_poll_s *p,
+                                 fio_socket_i fd,
+                                 const void *buf,
+                                 size_t len) {
+  return fio_sock_write(fd, buf, len);
+  (void)p;
+}
+/** Same as `fio_poll_write`, gathering the data from `count` buffers. */
+FIO_IFUNC ssize_t fio_poll_writev(fio_poll_s *p,
+                                  fio_socket_i fd,
+                                  const fio_buf_info_s *vec,
+                                  size_t count) {
+  return fio_sock_writev(fd, vec, count);
+  (void)p;
+}
+/** Returns -1 (`EWOULDBLOCK`) while data written to `fd` is being sent. */
+FIO_IFUNC int fio_poll_flush(fio_poll_s *p, fio_socket_i fd) {
+  return 0;
+  (void)p, (void)fd;
+}
+/** Returns a client the engine accepted for the listening socket `fd`. */
+FIO_IFUNC fio_socket_i fio_poll_accept(fio_poll_s *p, fio_socket_i fd) {
+  return fio_sock_accept(fd, NULL, NULL);
+  (void)p;
+}
+#endif /* FIO_POLL_ENGINE_URING */
+
 /* *****************************************************************************
 Implementation Helpers
 ***************************************************************************** */
@@ -0,0 +1,1340 @@
+/* ************************************************************************* */
+#if !defined(FIO_INCLUDE_FILE) /* Dev test - ignore line */
+#define FIO_POLL_ENGINE_URING  /* Dev */
+#define FIO___DEV___           /* Development inclusion - ignore line */
+#define FIO_POLL               /* Development inclusion - ignore line */
+#include "./include.h"         /* Development inclusion - ignore line */
+#endif                         /* Development inclusion - ignore line */
+/* ************************************************************************* */
+#if defined(FIO_POLL) && defined(FIO_POLL_ENGINE_URING) &&                     \
+    (defined(FIO_EXTERN_COMPLETE) || !defined(FIO_EXTERN)) &&                  \
+    !defined(H___FIO_POLL_EGN___H) && !defined(H___FIO_POLL___H) &&            \
+    !defined(FIO___RECURSIVE_INCLUDE)
+#define H___FIO_POLL_EGN___H
+/* *****************************************************************************
+
+
+
+
+                      POSIX Portable Polling with `io_uring`
+
+
+
+Copyright and License: see header file (000 copyright.h) or top of file
+***************************************************************************** */
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#ifndef FIO_POLL_URING_ENTRIES
+/** Submission ring size (rounded up by the kernel to a power of 2). */
+#define FIO_POLL_URING_ENTRIES 1024
+#endif
+
+#ifndef FIO_POLL_URING_BUFFERS
+/** Provided receive buffers per ring (a power of 2, 0 disables ring I/O). */
+#define FIO_POLL_URING_BUFFERS 512
+#endif
+
+#ifndef FIO_POLL_URING_BUFFER_SIZE
+/** The size of each provided receive buffer. */
+#define FIO_POLL_URING_BUFFER_SIZE 8192
+#endif
+
+#ifndef FIO_POLL_URING_QUEUE_LIMIT
+/** Completions an fd may hold before its multishot receive / accept pauses. */
+#define FIO_POLL_URING_QUEUE_LIMIT 16
+#endif
+
+#ifndef FIO_POLL_URING_SEND_MAX
+/** Maximum number of bytes `fio_poll_write` copies into a single ring send. */
+#define FIO_POLL_URING_SEND_MAX 65536
+#endif
+
+#if (FIO_POLL_URING_BUFFERS & (FIO_POLL_URING_BUFFERS - 1)) ||                 \
+    FIO_POLL_URING_BUFFERS > 32768
+#error FIO_POLL_URING_BUFFERS must be a power of 2 (up to 32768) or zero.
+#endif
+
+/* *****************************************************************************
+Ring types and monitored descriptor map
+
+Every monitored fd gets a map entry with a generation number. Requests carry
+(fd, generation, kind) in their `user_data`, so completions that belong to a
+forgotten (or re-used) descriptor are recognized and dropped instead of
+dispatching a stale `udata`.
+
+Descriptors monitored with `FIO_POLL_IO` (or `FIO_POLL_ACCEPT`) also get an I/O
+state. A multishot receive (or accept) request stays armed in the ring and
+queues its completions in the state, where `fio_poll_read` (`fio_poll_accept`)
+collects them without a system call. Received data lands in provided buffers
+that are recycled once read. `fio_poll_write` copies its data into a send
+request that is submitted with the next review.
+***************************************************************************** */
+
+#define FIO___URING_ARMED_IN   1U   /* POLL_ADD (POLLIN) */
+#define FIO___URING_ARMED_OUT  2U   /* POLL_ADD (POLLOUT) */
+#define FIO___URING_ARMED_RECV 4U   /* multishot receive / accept */
+#define FIO___URING_CANCELING  8U   /* multishot request paused (queue full) */
+#define FIO___URING_WANT_IN    16U  /* POLLIN served by the ring I/O state */
+#define FIO___URING_WANT_OUT   32U  /* POLLOUT requested while sending */
+#define FIO___URING_DONE       64U  /* EOF or receive error (ring I/O) */
+#define FIO___URING_ACCEPT     128U /* listening socket (multishot accept) */
+#define FIO___URING_NO_IO      256U /* ring I/O unsupported by the fd */
+#define FIO___URING_READY      512U /* listed for the next review */
+
+/* request kinds, stored in bits 60-62 of the `user_data` */
+#define FIO___URING_K_POLL_IN  0U
+#define FIO___URING_K_POLL_OUT 1U
+#define FIO___URING_K_RECV   2U
+#define FIO___URING_K_ACCEPT 3U
+#define FIO___URING_K_SEND   4U
+
+#define FIO___URING_UD_KIND(k)  ((uint64_t)(k) << 60)
+#define FIO___URING_UD_INTERNAL ((uint64_t)1ULL << 63)
+#define FIO___URING_GEN_MASK    ((uint32_t)0x0FFFFFFFUL)
+
+#define FIO___URING_EV_DATA  1U
+#define FIO___URING_EV_READY 2U
+#define FIO___URING_EV_CLOSE 4U
+
+/* kernel ABI values (Linux 5.19+ / 6.0+) that older headers may lack */
+#define FIO___URING_REGISTER_PBUF_RING 22 /* IORING_REGISTER_PBUF_RING */
+#define FIO___URING_RECV_MULTISHOT     (1U << 1)
+#define FIO___URING_ACCEPT_MULTISHOT   (1U << 0)
+#define FIO___URING_CANCEL_ANY         (1U << 2) /* IORING_ASYNC_CANCEL_ANY */
+#define FIO___URING_CQE_F_BUFFER       (1U << 0)
+#define FIO___URING_CQE_F_MORE         (1U << 1)
+#define FIO___URING_CQE_BUFFER_SHIFT   16
+
+/* mirrors `struct io_uring_buf`, the ring's tail overlays `bufs[0].resv` */
+typedef struct {
+  uint64_t addr;
+  uint32_t len;
+  uint16_t bid;
+  uint16_t resv;
+} fio___uring_buf_s;
+
+/* mirrors `struct io_uring_buf_reg` */
+typedef struct {
+  uint64_t ring_addr;
+  uint32_t ring_entries;
+  uint16_t bgid;
+  uint16_t flags;
+  uint64_t resv[3];
+} fio___uring_buf_reg_s;
+
+/* a received buffer (`bid`) or an accepted fd (`len`) */
+typedef struct {
+  uint32_t len;
+  uint32_t pos;
+  uint16_t bid;
+} fio___uring_in_s;
+
+typedef struct fio___uring_io_s {
+  /* forgotten states with a send in flight (freed by its completion) */
+  struct fio___uring_io_s *next;
+  /* completions waiting to be read, a ring of `capa` (a power of 2) */
+  fio___uring_in_s *in;
+  uint32_t head;
+  uint32_t count;
+  uint32_t capa;
+  /* the receive error (0 = EOF), valid once `FIO___URING_DONE` is set */
+  int err;
+  /* the send error, reported by the following writes */
+  int send_err;
+  int fd;
+  uint32_t gen;
+  uint8_t sending;
+  uint8_t orphan;
+  /* the in-flight send's copy of the data */
+  char *out;
+  uint32_t out_pos;
+  uint32_t out_len;
+} fio___uring_io_s;
+
+typedef struct {
+  void *udata;
+  fio___uring_io_s *io;
+  int fd;
+  uint32_t gen;
+  uint32_t flags;
+} fio___uring_i_s;
+
+#define FIO___URING_IMAP_CMP(a, b) ((a)->fd == (b)->fd)
+#define FIO___URING_IMAP_HASH(o)                                               \
+  (fio_risky_ptr((void *)((uintptr_t)((o)->fd))))
+/* removed slots are zeroed by the imap, so fd 0 is never monitored here */
+#define FIO___URING_IMAP_VALID(o) ((o)->fd > 0)
+FIO_TYPEDEF_IMAP_ARRAY(fio___uring_map,
+                       fio___uring_i_s,
+                       uint32_t,
+                       FIO___URING_IMAP_HASH,
+                       FIO___URING_IMAP_CMP,
+                       FIO___URING_IMAP_VALID)
+#undef FIO___URING_IMAP_CMP
+#undef FIO___URING_IMAP_VALID
+#undef FIO___URING_IMAP_HASH
+
+FIO_LEAK_COUNTER_DEF(fio___uring_io_s)
+
+typedef struct {
+  unsigned *head;
+  unsigned *tail;
+  unsigned *mask;
+  unsigned *array;
+  unsigned entries;
+} fio___uring_sq_s;
+
+typedef struct {
+  unsigned *head;
+  unsigned *tail;
+  unsigned *mask;
+  struct io_uring_cqe *cqes;
+} fio___uring_cq_s;
+
+/** the `fio_poll_s` type should be considered opaque. */
+struct fio_poll_s {
+  fio_poll_settings_s settings;
+  fio___uring_map_s map;
+  fio___uring_sq_s sq;
+  fio___uring_cq_s cq;
+  struct io_uring_sqe *sqes;
+  void *sq_mem;
+  void *cq_mem;
+  size_t sq_mem_len;
+  size_t cq_mem_len;
+  size_t sqes_len;
+  /* provided buffer ring (`NULL` when ring I/O is unavailable) */
+  fio___uring_buf_s *br;
+  char *bufs;
+  /* I/O states waiting for their send to complete */
+  fio___uring_io_s *orphans;
+  /* `user_data` of fds with queued data, dispatched by the next review */
+  uint64_t *ready;
+  uint32_t ready_count;
+  uint32_t ready_capa;
+  /* multishot and send requests that may still access user memory */
+  uint32_t inflight;
+  unsigned sq_tail;
+  uint32_t gen;
+  uint16_t br_tail;
+  int fd;
+  FIO___LOCK_TYPE lock;
+};
+
+/* *****************************************************************************
+Ring setup / teardown
+***************************************************************************** */
+
+FIO_IFUNC int fio___uring_setup(unsigned entries, struct io_uring_params *p) {
+  return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+FIO_IFUNC int fio___uring_enter(int fd,
+                                unsigned to_submit,
+                                unsigned min_complete,
+                                unsigned flags,
+                                void *arg,
+                                size_t arg_len) {
+  return (int)syscall(__NR_io_uring_enter,
+                      fd,
+                      to_submit,
+                      min_complete,
+                      flags,
+                      arg,
+                      arg_len);
+}
+
+FIO_SFUNC void fio___uring_unmap(fio_poll_s *p) {
+  if (p->sqes)
+    munmap((void *)p->sqes, p->sqes_len);
+  if (p->cq_mem && p->cq_mem != p->sq_mem)
+    munmap(p->cq_mem, p->cq_mem_len);
+  if (p->sq_mem)
+    munmap(p->sq_mem, p->sq_mem_len);
+  if (p->fd != -1)
+    close(p->fd);
+  if (p->br)
+    munmap((void *)p->br, sizeof(*p->br) * FIO_POLL_URING_BUFFERS);
+  if (p->bufs)
+    munmap((void *)p->bufs,
+           (size_t)FIO_POLL_URING_BUFFERS * FIO_POLL_URING_BUFFER_SIZE);
+  p->sqes = NULL;
+  p->sq_mem = p->cq_mem = NULL;
+  p->br = NULL;
+  p->bufs = NULL;
+  p->fd = -1;
+}
+
+FIO_SFUNC int fio___uring_map_rings(fio_poll_s *p) {
+  struct io_uring_params prm = {.flags = 0};
+#ifdef IORING_SETUP_COOP_TASKRUN
+  prm.flags = IORING_SETUP_COOP_TASKRUN;
+#endif
+  p->fd = fio___uring_setup(FIO_POLL_URING_ENTRIES, &prm);
+  if (p->fd == -1 && errno == EINVAL && prm.flags) { /* kernel < 5.19 */
+    prm = (struct io_uring_params){.flags = 0};
+    p->fd = fio___uring_setup(FIO_POLL_URING_ENTRIES, &prm);
+  }
+  if (p->fd == -1)
+    goto setup_failed;
+  if (!(prm.features & IORING_FEAT_EXT_ARG))
+    goto no_ext_arg; /* a timed wait requires Linux 5.11 or later */
+
+  p->sq_mem_len = prm.sq_off.array + prm.sq_entries * sizeof(unsigned);
+  p->cq_mem_len =
+      prm.cq_off.cqes + prm.cq_entries * sizeof(struct io_uring_cqe);
+  if ((prm.features & IORING_FEAT_SINGLE_MMAP)) {
+    if (p->cq_mem_len > p->sq_mem_len)
+      p->sq_mem_len = p->cq_mem_len;
+    p->cq_mem_len = p->sq_mem_len;
+  }
+  p->sq_mem = mmap(NULL,
+                   p->sq_mem_len,
+                   PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE,
+                   p->fd,
+                   IORING_OFF_SQ_RING);
+  if (p->sq_mem == MAP_FAILED)
+    goto map_failed;
+  if ((prm.features & IORING_FEAT_SINGLE_MMAP)) {
+    p->cq_mem = p->sq_mem;
+  } else {
+    p->cq_mem = mmap(NULL,
+                     p->cq_mem_len,
+                     PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE,
+                     p->fd,
+                     IORING_OFF_CQ_RING);
+    if (p->cq_mem == MAP_FAILED)
+      goto map_failed;
+  }
+  p->sqes_len = prm.sq_entries * sizeof(struct io_uring_sqe);
+  p->sqes = (struct io_uring_sqe *)mmap(NULL,
+                                        p->sqes_len,
+                                        PROT_READ | PROT_WRITE,
+                                        MAP_SHARED | MAP_POPULATE,
+                                        p->fd,
+                                        IORING_OFF_SQES);
+  if ((void *)p->sqes == MAP_FAILED)
+    goto map_failed;
+
+  p->sq = (fio___uring_sq_s){
+      .head = (unsigned *)((char *)p->sq_mem + prm.sq_off.head),
+      .tail = (unsigned *)((char *)p->sq_mem + prm.sq_off.tail),
+      .mask = (unsigned *)((char *)p->sq_mem + prm.sq_off.ring_mask),
+      .array = (unsigned *)((char *)p->sq_mem + prm.sq_off.array),
+      .entries = prm.sq_entries,
+  };
+  p->cq = (fio___uring_cq_s){
+      .head = (unsigned *)((char *)p->cq_mem + prm.cq_off.head),
+      .tail = (unsigned *)((char *)p->cq_mem + prm.cq_off.tail),
+      .mask = (unsigned *)((char *)p->cq_mem + prm.cq_off.ring_mask),
+      .cqes = (struct io_uring_cqe *)((char *)p->cq_mem + prm.cq_off.cqes),
+  };
+  /* the SQ index array is an identity map, so slot == tail & mask */
+  for (unsigned i = 0; i < prm.sq_entries; ++i)
+    p->sq.array[i] = i;
+  p->sq_tail = *p->sq.tail;
+  return 0;
+
+map_failed:
+  if (p->sq_mem == MAP_FAILED)
+    p->sq_mem = NULL;
+  if (p->cq_mem == MAP_FAILED)
+    p->cq_mem = NULL;
+  if ((void *)p->sqes == MAP_FAILED)
+    p->sqes = NULL;
+  FIO_LOG_ERROR("io_uring ring mapping failed: %s", strerror(errno));
+  fio___uring_unmap(p);
+  return -1;
+no_ext_arg:
+  FIO_LOG_ERROR("io_uring polling requires IORING_FEAT_EXT_ARG (Linux 5.11+)");
+  fio___uring_unmap(p);
+  return -1;
+setup_failed:
+  FIO_LOG_ERROR("io_uring_setup failed (%s) - io_uring polling disabled.",
+                strerror(errno));
+  return -1;
+}
+
+/* *****************************************************************************
+Submission Helpers (call with the lock held)
+***************************************************************************** */
+
+/* Submits any queued SQEs without waiting. */
+FIO_SFUNC int fio___uring_flush(fio_poll_s *p) {
+  unsigned head;
+  fio_atomic_load(head, p->sq.head);
+  unsigned pending = p->sq_tail - head;
+  if (!pending)
+    return 0;
+  int r;
+  do {
+    r = fio___uring_enter(p->fd, pending, 0, 0, NULL, 0);
+  } while (r == -1 && errno == EINTR);
+  return r;
+}
+
+/* Returns a zeroed SQE (no system call unless the ring is full) or NULL. */
+FIO_SFUNC struct io_uring_sqe *fio___uring_sqe_new(fio_poll_s *p) {
+  unsigned head;
+  fio_atomic_load(head, p->sq.head);
+  if (p->sq_tail - head >= p->sq.entries) {
+    fio___uring_flush(p);
+    fio_atomic_load(head, p->sq.head);
+    if (p->sq_tail - head >= p->sq.entries)
+      return NULL;
+  }
+  struct io_uring_sqe *sqe = p->sqes + (p->sq_tail & *p->sq.mask);
+  FIO_MEMSET(sqe, 0, sizeof(*sqe));
+  return sqe;
+}
+
+/* Queues the SQE returned by `fio___uring_sqe_new`. */
+FIO_IFUNC void fio___uring_sqe_push(fio_poll_s *p) {
+  ++p->sq_tail;
+  fio_atomic_exchange(p->sq.tail, p->sq_tail); /* publish (full barrier) */
+}
+
+/* Queues a single poll (or cancellation) request. */
+FIO_SFUNC int fio___uring_push(fio_poll_s *p,
+                               uint8_t opcode,
+                               int fd,
+                               uint32_t poll_mask,
+                               uint64_t addr,
+                               uint64_t user_data) {
+  struct io_uring_sqe *sqe = fio___uring_sqe_new(p);
+  if (!sqe)
+    return -1;
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->addr = addr;
+  sqe->user_data = user_data;
+#if __BIG_ENDIAN__
+  poll_mask = (poll_mask << 16) | (poll_mask >> 16); /* word-reversed on BE */
+#endif
+  sqe->poll32_events = poll_mask;
+  fio___uring_sqe_push(p);
+  return 0;
+}
+
+FIO_IFUNC uint64_t fio___uring_ud(fio___uring_i_s *e, uint32_t kind) {
+  return (uint64_t)(uint32_t)e->fd | ((uint64_t)e->gen << 32) |
+         FIO___URING_UD_KIND(kind);
+}
+
+/* Returns a provided buffer to the kernel. */
+FIO_IFUNC void fio___uring_buf_recycle(fio_poll_s *p, uint16_t bid) {
+  fio___uring_buf_s *b =
+      p->br + (p->br_tail & (uint16_t)(FIO_POLL_URING_BUFFERS - 1));
+  b->addr = (uint64_t)(uintptr_t)(p->bufs +
+                                  ((size_t)bid * FIO_POLL_URING_BUFFER_SIZE));
+  b->len = FIO_POLL_URING_BUFFER_SIZE;
+  b->bid = bid;
+  ++p->br_tail;
+  fio_atomic_exchange(&p->br->resv, p->br_tail); /* publish the ring's tail */
+}
+
+/* Registers the provided receive buffers, enabling ring I/O (Linux 5.19+). */
+FIO_SFUNC void fio___uring_buffers_init(fio_poll_s *p) {
+  const size_t ring_len = sizeof(*p->br) * FIO_POLL_URING_BUFFERS;
+  const size_t bufs_len =
+      (size_t)FIO_POLL_URING_BUFFERS * FIO_POLL_URING_BUFFER_SIZE;
+  void *br = MAP_FAILED, *bufs = MAP_FAILED;
+  fio___uring_buf_reg_s reg = {.ring_entries = FIO_POLL_URING_BUFFERS};
+  if (!FIO_POLL_URING_BUFFERS || p->fd == -1)
+    return;
+  br = mmap(NULL,
+            ring_len,
+            PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS,
+            -1,
+            0);
+  bufs = mmap(NULL,
+              bufs_len,
+              PROT_READ | PROT_WRITE,
+              MAP_PRIVATE | MAP_ANONYMOUS,
+              -1,
+              0);
+  if (br == MAP_FAILED || bufs == MAP_FAILED)
+    goto failed;
+  reg.ring_addr = (uint64_t)(uintptr_t)br;
+  if (syscall(__NR_io_uring_register,
+              p->fd,
+              FIO___URING_REGISTER_PBUF_RING,
+              &reg,
+              1))
+    goto failed;
+  p->br = (fio___uring_buf_s *)br;
+  p->bufs = (char *)bufs;
+  p->br_tail = 0;
+  for (size_t i = 0; i < FIO_POLL_URING_BUFFERS; ++i)
+    fio___uring_buf_recycle(p, (uint16_t)i);
+  return;
+failed:
+  FIO_LOG_DEBUG2("io_uring provided buffers unavailable (%s) - "
+                 "using readiness only.",
+                 strerror(errno));
+  if (br != MAP_FAILED)
+    munmap(br, ring_len);
+  if (bufs != MAP_FAILED)
+    munmap(bufs, bufs_len);
+}
+
+/* *****************************************************************************
+Ring I/O States (call with the lock held)
+***************************************************************************** */
+
+FIO_SFUNC fio___uring_io_s *fio___uring_io_new(fio___uring_i_s *e) {
+  fio___uring_io_s *io =
+      (fio___uring_io_s *)FIO_MEM_REALLOC_(NULL, 0, sizeof(*io), 0);
+  FIO_ASSERT_ALLOC(io);
+  FIO_LEAK_COUNTER_ON_ALLOC(fio___uring_io_s);
+  *io = (fio___uring_io_s){.fd = e->fd, .gen = e->gen};
+  return io;
+}
+
+FIO_SFUNC void fio___uring_io_free(fio___uring_io_s *io) {
+  if (io->in)
+    FIO_MEM_FREE_(io->in, sizeof(*io->in) * io->capa);
+  if (io->out)
+    FIO_MEM_FREE_(io->out, io->out_len);
+  FIO_LEAK_COUNTER_ON_FREE(fio___uring_io_s);
+  FIO_MEM_FREE_(io, sizeof(*io));
+}
+
+/* Drops the queued completions, freeing the state unless it's sending. */
+FIO_SFUNC void fio___uring_io_release(fio_poll_s *p,
+                                      fio___uring_io_s *io,
+                                      uint32_t flags) {
+  for (; io->count; --io->count, ++io->head) {
+    fio___uring_in_s *i = io->in + (io->head & (io->capa - 1));
+    if ((flags & FIO___URING_ACCEPT))
+      close((int)i->len);
+    else
+      fio___uring_buf_recycle(p, i->bid);
+  }
+  if (io->sending) { /* the kernel may still read `io->out` */
+    io->orphan = 1;
+    io->next = p->orphans;
+    p->orphans = io;
+    return;
+  }
+  fio___uring_io_free(io);
+}
+
+FIO_SFUNC void fio___uring_in_push(fio___uring_io_s *io, fio___uring_in_s i) {
+  if (io->count == io->capa) {
+    const uint32_t capa = io->capa ? (io->capa << 1) : 8;
+    fio___uring_in_s *tmp = (fio___uring_in_s *)
+        FIO_MEM_REALLOC_(NULL, 0, sizeof(*tmp) * capa, 0);
+    FIO_ASSERT_ALLOC(tmp);
+    for (uint32_t n = 0; n < io->count; ++n)
+      tmp[n] = io->in[(io->head + n) & (io->capa - 1)];
+    if (io->in)
+      FIO_MEM_FREE_(io->in, sizeof(*tmp) * io->capa);
+    io->in = tmp;
+    io->head = 0;
+    io->capa = capa;
+  }
+  io->in[(io->head + io->count) & (io->capa - 1)] = i;
+  ++io->count;
+}
+
+/* Arms the fd's multishot receive (or accept) request. */
+FIO_SFUNC int fio___uring_arm_io(fio_poll_s *p, fio___uring_i_s *e) {
+  struct io_uring_sqe *sqe = fio___uring_sqe_new(p);
+  if (!sqe)
+    return -1;
+  sqe->fd = e->fd;
+  if ((e->flags & FIO___URING_ACCEPT)) {
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->ioprio = FIO___URING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    sqe->user_data = fio___uring_ud(e, FIO___URING_K_ACCEPT);
+  } else {
+    sqe->opcode = IORING_OP_RECV;
+    sqe->ioprio = FIO___URING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = 0;
+    sqe->user_data = fio___uring_ud(e, FIO___URING_K_RECV);
+  }
+  fio___uring_sqe_push(p);
+  e->flags |= FIO___URING_ARMED_RECV;
+  ++p->inflight;
+  return 0;
+}
+
+/* Queues a send request for the unsent part of `io->out`. */
+FIO_SFUNC int fio___uring_send(fio_poll_s *p, fio___uring_io_s *io) {
+  struct io_uring_sqe *sqe = fio___uring_sqe_new(p);
+  if (!sqe)
+    return -1;
+  sqe->opcode = IORING_OP_SEND;
+  sqe->fd = io->fd;
+  sqe->addr = (uint64_t)(uintptr_t)(io->out + io->out_pos);
+  sqe->len = io->out_len - io->out_pos;
+  sqe->msg_flags = MSG_NOSIGNAL;
+  sqe->user_data = (uint64_t)(uintptr_t)io |
+                   FIO___URING_UD_KIND(FIO___URING_K_SEND);
+  fio___uring_sqe_push(p);
+  ++p->inflight;
+  return 0;
+}
+
+/* Marks POLLIN as requested, dispatching queued data with the next review. */
+FIO_SFUNC int fio___uring_monitor_io(fio_poll_s *p, fio___uring_i_s *e) {
+  fio___uring_io_s *io = e->io;
+  e->flags |= FIO___URING_WANT_IN;
+  if ((io->count || (e->flags & FIO___URING_DONE)) &&
+      !(e->flags & FIO___URING_READY)) {
+    if (p->ready_count == p->ready_capa) {
+      const uint32_t capa = p->ready_capa ? (p->ready_capa << 1) : 64;
+      uint64_t *tmp = (uint64_t *)FIO_MEM_REALLOC_(p->ready,
+                                                   sizeof(*tmp) * p->ready_capa,
+                                                   sizeof(*tmp) * capa,
+                                                   sizeof(*tmp) *
+                                                       p->ready_count);
+      if (!tmp)
+        return -1;
+      p->ready = tmp;
+      p->ready_capa = capa;
+    }
+    p->ready[p->ready_count++] = fio___uring_ud(e, FIO___URING_K_POLL_IN);
+    e->flags |= FIO___URING_READY;
+  }
+  /* a pending readiness fallback (POLL_ADD) must fire first */
+  if (!(e->flags & (FIO___URING_ARMED_RECV | FIO___URING_ARMED_IN |
+                    FIO___URING_DONE)) &&
+      io->count < FIO_POLL_URING_QUEUE_LIMIT)
+    return fio___uring_arm_io(p, e);
+  return 0;
+}
+
+/* *****************************************************************************
+Completion Handling (call with the lock held)
+***************************************************************************** */
+
+/* Collects the POLLIN events of an fd served by ring I/O. */
+FIO_IFUNC uint32_t fio___uring_in_events(fio___uring_i_s *e, void **udata) {
+  fio___uring_io_s *io = e->io;
+  if (!(e->flags & FIO___URING_WANT_IN) || !io ||
+      (!io->count && !(e->flags & FIO___URING_DONE)))
+    return 0;
+  e->flags &= ~FIO___URING_WANT_IN;
+  *udata = e->udata;
+  /* errors are handled as disconnections (on_close), EOF is read as 0 */
+  if ((e->flags & FIO___URING_DONE) && io->err)
+    return (io->count ? FIO___URING_EV_DATA : 0) | FIO___URING_EV_CLOSE;
+  return FIO___URING_EV_DATA;
+}
+
+FIO_SFUNC uint32_t fio___uring_on_poll(fio___uring_i_s *e,
+                                       uint32_t kind,
+                                       int32_t res,
+                                       void **udata) {
+  if (!e || res == -ECANCELED)
+    return 0;
+  *udata = e->udata;
+  if (kind == FIO___URING_K_POLL_OUT) {
+    e->flags &= ~FIO___URING_ARMED_OUT;
+    /* an error/hangup on a writable event is a closure, not readiness */
+    if (res < 0 || (res & (POLLERR | POLLHUP | POLLRDHUP | POLLNVAL)))
+      return FIO___URING_EV_CLOSE;
+    return ((res & POLLOUT) ? FIO___URING_EV_READY : 0);
+  }
+  e->flags &= ~(FIO___URING_ARMED_IN | FIO___URING_WANT_IN);
+  if (res < 0)
+    return FIO___URING_EV_CLOSE;
+  /* errors are handled as disconnections (on_close), once per fd */
+  return ((res & POLLIN) ? FIO___URING_EV_DATA : 0) |
+         ((res & (~(POLLIN | POLLOUT))) ? FIO___URING_EV_CLOSE : 0);
+}
+
+/* multishot receive / accept completions */
+FIO_SFUNC uint32_t fio___uring_on_io(fio_poll_s *p,
+                                     fio___uring_i_s *e,
+                                     uint32_t kind,
+                                     int32_t res,
+                                     uint32_t cflags,
+                                     void **udata) {
+  fio___uring_io_s *io;
+  if (!(cflags & FIO___URING_CQE_F_MORE))
+    --p->inflight;
+  if (!e || !(io = e->io)) { /* stale: recycle the buffer / close the fd */
+    if ((cflags & FIO___URING_CQE_F_BUFFER))
+      fio___uring_buf_recycle(
+          p,
+          (uint16_t)(cflags >> FIO___URING_CQE_BUFFER_SHIFT));
+    else if (kind == FIO___URING_K_ACCEPT && res >= 0)
+      close(res);
+    return 0;
+  }
+  if (!(cflags & FIO___URING_CQE_F_MORE))
+    e->flags &= ~(FIO___URING_ARMED_RECV | FIO___URING_CANCELING);
+  if (res > 0 || (res == 0 && kind == FIO___URING_K_ACCEPT)) {
+    fio___uring_in_push(
+        io,
+        (fio___uring_in_s){
+            .len = (uint32_t)res,
+            .bid = (uint16_t)(cflags >> FIO___URING_CQE_BUFFER_SHIFT),
+        });
+    /* backpressure: pause the multishot request until the queue is read */
+    if (io->count >= FIO_POLL_URING_QUEUE_LIMIT &&
+        (e->flags & (FIO___URING_ARMED_RECV | FIO___URING_CANCELING)) ==
+            FIO___URING_ARMED_RECV &&
+        !fio___uring_push(p,
+                          IORING_OP_ASYNC_CANCEL,
+                          -1,
+                          0,
+                          fio___uring_ud(e, kind),
+                          FIO___URING_UD_INTERNAL))
+      e->flags |= FIO___URING_CANCELING;
+  } else if (res == 0) {
+    e->flags |= FIO___URING_DONE; /* EOF */
+  } else {
+    switch (-res) {
+    case ECANCELED: break; /* paused, re-armed once the queue is read */
+    case ENOBUFS:          /* out of provided buffers, wait for readiness */
+      if ((e->flags & FIO___URING_WANT_IN) &&
+          !fio___uring_push(p,
+                            IORING_OP_POLL_ADD,
+                            e->fd,
+                            (POLLIN | POLLRDHUP),
+                            0,
+                            fio___uring_ud(e, FIO___URING_K_POLL_IN)))
+        e->flags |= FIO___URING_ARMED_IN;
+      break;
+    case EINVAL: /* fallthrough */
+    case ENOTSOCK:
+    case EOPNOTSUPP:
+    case ENOTCONN: /* ring I/O unsupported, fall back to readiness */
+      e->flags |= FIO___URING_NO_IO;
+      if ((e->flags & FIO___URING_WANT_IN) &&
+          !fio___uring_push(p,
+                            IORING_OP_POLL_ADD,
+                            e->fd,
+                            (POLLIN | POLLRDHUP),
+                            0,
+                            fio___uring_ud(e, FIO___URING_K_POLL_IN)))
+        e->flags |= FIO___URING_ARMED_IN;
+      break;
+    default:
+      if (kind == FIO___URING_K_ACCEPT) { /* let `accept` report the error */
+        if (!(e->flags & FIO___URING_WANT_IN))
+          break;
+        e->flags &= ~FIO___URING_WANT_IN;
+        *udata = e->udata;
+        return FIO___URING_EV_DATA;
+      }
+      e->flags |= FIO___URING_DONE;
+      io->err = -res;
+    }
+  }
+  /* a request that ended on its own (e.g., a cancellation that raced the
+   * last read) is re-armed if the fd is still waiting for data */
+  if ((e->flags & FIO___URING_WANT_IN) && !io->count &&
+      !(e->flags & (FIO___URING_ARMED_RECV | FIO___URING_ARMED_IN |
+                    FIO___URING_DONE | FIO___URING_NO_IO)))
+    fio___uring_arm_io(p, e);
+  return fio___uring_in_events(e, udata);
+}
+
+FIO_SFUNC uint32_t fio___uring_on_send(fio_poll_s *p,
+                                       fio___uring_io_s *io,
+                                       int32_t res,
+                                       void **udata) {
+  fio___uring_i_s *e;
+  --p->inflight;
+  if (res > 0) {
+    io->out_pos += (uint32_t)res;
+    if (io->out_pos < io->out_len && !io->orphan && !fio___uring_send(p, io))
+      return 0; /* short send, the remainder was queued */
+  }
+  FIO_MEM_FREE_(io->out, io->out_len);
+  io->out = NULL;
+  io->sending = 0;
+  if (io->orphan) { /* the fd was forgotten while sending */
+    fio___uring_io_s **pos = &p->orphans;
+    while (*pos != io)
+      pos = &(*pos)->next;
+    *pos = io->next;
+    fio___uring_io_free(io);
+    return 0;
+  }
+  if (io->out_pos < io->out_len)
+    io->send_err = (res < 0 ? -res : EPIPE);
+  e = fio___uring_map_get(&p->map, (fio___uring_i_s){.fd = io->fd});
+  if (!e || e->io != io)
+    return 0;
+  *udata = e->udata;
+  if (io->send_err)
+    return FIO___URING_EV_CLOSE;
+  if (!(e->flags & FIO___URING_WANT_OUT))
+    return 0;
+  e->flags &= ~FIO___URING_WANT_OUT;
+  return FIO___URING_EV_READY;
+}
+
+/* Handles a single completion, returning the events to dispatch. */
+FIO_SFUNC uint32_t fio___uring_on_cqe(fio_poll_s *p,
+                                      struct io_uring_cqe *cqe,
+                                      void **udata) {
+  const uint64_t ud = cqe->user_data;
+  const uint32_t kind = (uint32_t)(ud >> 60) & 7;
+  fio___uring_i_s *e;
+  if ((ud & FIO___URING_UD_INTERNAL))
+    return 0;
+  if (kind == FIO___URING_K_SEND) /* `user_data` holds the I/O state */
+    return fio___uring_on_send(
+        p,
+        (fio___uring_io_s *)(uintptr_t)(ud & (FIO___URING_UD_KIND(1) - 1)),
+        cqe->res,
+        udata);
+  e = fio___uring_map_get(&p->map, (fio___uring_i_s){.fd = (int)(uint32_t)ud});
+  if (e && e->gen != ((uint32_t)(ud >> 32) & FIO___URING_GEN_MASK))
+    e = NULL; /* stale completion of a forgotten / re-used descriptor */
+  if (kind <= FIO___URING_K_POLL_OUT)
+    return fio___uring_on_poll(e, kind, cqe->res, udata);
+  return fio___uring_on_io(p, e, kind, cqe->res, cqe->flags, udata);
+}
+
+/* *****************************************************************************
+Initialization / Destruction
+***************************************************************************** */
+
+/* Cancels the requests that may still access user memory and waits (up to a
+ * second) for their completions, so the buffers can be unmapped safely. */
+FIO_SFUNC void fio___uring_cancel_all(fio_poll_s *p) {
+  struct io_uring_sqe *sqe;
+  if (!p->inflight || !(sqe = fio___uring_sqe_new(p)))
+    return;
+  sqe->opcode = IORING_OP_ASYNC_CANCEL;
+  sqe->fd = -1;
+  sqe->rw_flags = (int)FIO___URING_CANCEL_ANY; /* `cancel_flags` */
+  sqe->user_data = FIO___URING_UD_INTERNAL;
+  fio___uring_sqe_push(p);
+  for (size_t i = 0; p->inflight && i < 100; ++i) {
+    struct __kernel_timespec ts = {.tv_sec = 0, .tv_nsec = 10000000};
+    struct io_uring_getevents_arg arg = {.sigmask = 0};
+    unsigned head, tail;
+    void *udata;
+    arg.ts = (uint64_t)(uintptr_t)&ts;
+    fio_atomic_load(head, p->sq.head);
+    fio___uring_enter(p->fd,
+                      p->sq_tail - head,
+                      1,
+                      (IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG),
+                      &arg,
+                      sizeof(arg));
+    head = *p->cq.head;
+    fio_atomic_load(tail, p->cq.tail);
+    for (; head != tail; ++head)
+      fio___uring_on_cqe(p, p->cq.cqes + (head & *p->cq.mask), &udata);
+    fio_atomic_exchange(p->cq.head, head);
+  }
+}
+
+/* Frees all resources. The child of a `fork` shares the parent's ring, so it
+ * must not cancel the (parent's) requests. */
+FIO_SFUNC void fio___uring_destroy(fio_poll_s *p, int cancel) {
+  FIO_IMAP_EACH(fio___uring_map, &p->map, i) {
+    if (p->map.ary[i].io)
+      fio___uring_io_release(p, p->map.ary[i].io, p->map.ary[i].flags);
+    p->map.ary[i].io = NULL;
+  }
+  if (cancel && p->fd != -1)
+    fio___uring_cancel_all(p);
+  while (p->orphans) {
+    fio___uring_io_s *io = p->orphans;
+    p->orphans = io->next;
+    fio___uring_io_free(io);
+  }
+  if (p->ready)
+    FIO_MEM_FREE_(p->ready, sizeof(*p->ready) * p->ready_capa);
+  p->ready = NULL;
+  p->ready_count = p->ready_capa = 0;
+  fio___uring_unmap(p);
+  fio___uring_map_destroy(&p->map);
+}
+
+FIO_SFUNC void fio___uring_after_fork(void *p_) {
+  fio_poll_s *p = (fio_poll_s *)p_;
+  fio_state_callback_remove(FIO_CALL_IN_CHILD, fio___uring_after_fork, p);
+  fio___uring_destroy(p, 0);
+  FIO___LOCK_DESTROY(p->lock);
+  fio_poll_init FIO_NOOP(p, p->settings);
+}
+
+/** Initializes the polling object, allocating its resources. */
+FIO_IFUNC void fio_poll_init FIO_NOOP(fio_poll_s *p, fio_poll_settings_s args) {
+  *p = (fio_poll_s){
+      .settings = args,
+      .fd = -1,
+      .lock = FIO___LOCK_INIT,
+  };
+  FIO_POLL_VALIDATE(p->settings);
+  if (!fio___uring_map_rings(p))
+    fio___uring_buffers_init(p);
+  fio_state_callback_add(FIO_CALL_IN_CHILD, fio___uring_after_fork, p);
+}
+
+/** Destroys the polling object, freeing its resources. */
+FIO_IFUNC void fio_poll_destroy(fio_poll_s *p) {
+  fio_state_callback_remove(FIO_CALL_IN_CHILD, fio___uring_after_fork, p);
+  fio___uring_destroy(p, 1);
+  FIO___LOCK_DESTROY(p->lock);
+}
+
+/* *****************************************************************************
+Poll Monitoring Implementation - possibly externed functions.
+***************************************************************************** */
+#if defined(FIO_EXTERN_COMPLETE) || !defined(FIO_EXTERN)
+
+/**
+ * Adds a file descriptor to be monitored, adds events to be monitored or
+ * updates the monitored file's `udata`.
+ *
+ * Possible flags are: `POLLIN` and `POLLOUT`. Other flags may be set but might
+ * be ignored.
+ *
+ * Monitoring mode is always one-shot. If an event if fired, it is removed from
+ * the monitoring state.
+ *
+ * Returns -1 on error.
+ */
+SFUNC int fio_poll_monitor(fio_poll_s *p,
+                           fio_socket_i fd,
+                           void *udata,
+                           unsigned short flags) {
+  int r = -1;
+  if (!p || p->fd == -1 || fd == FIO_SOCKET_INVALID)
+    return r;
+  r = 0;
+  FIO___LOCK_LOCK(p->lock);
+  fio___uring_i_s *e =
+      fio___uring_map_get(&p->map, (fio___uring_i_s){.fd = fd});
+  if (!e) {
+    p->gen = (p->gen + 1) & FIO___URING_GEN_MASK;
+    p->gen += !p->gen;
+    e = fio___uring_map_set(
+        &p->map,
+        (fio___uring_i_s){.udata = udata, .fd = fd, .gen = p->gen},
+        1);
+    if (!e)
+      goto error;
+  }
+  e->udata = udata;
+  if ((flags & (FIO_POLL_IO | FIO_POLL_ACCEPT)) && !e->io && p->br &&
+      !(e->flags & FIO___URING_NO_IO)) {
+    e->io = fio___uring_io_new(e);
+    if ((flags & FIO_POLL_ACCEPT))
+      e->flags |= FIO___URING_ACCEPT;
+  }
+  /* re-arming an already armed direction is a no-op (one request per side) */
+  if ((flags & POLLOUT)) {
+    if (e->io && e->io->sending) /* the send's completion is the event */
+      e->flags |= FIO___URING_WANT_OUT;
+    else if (!(e->flags & FIO___URING_ARMED_OUT)) {
+      if (fio___uring_push(p,
+                           IORING_OP_POLL_ADD,
+                           fd,
+                           (POLLOUT | POLLRDHUP),
+                           0,
+                           fio___uring_ud(e, FIO___URING_K_POLL_OUT)))
+        goto error;
+      e->flags |= FIO___URING_ARMED_OUT;
+    }
+  }
+  if ((flags & POLLIN)) {
+    if (e->io && !(e->flags & FIO___URING_NO_IO)) {
+      if (fio___uring_monitor_io(p, e))
+        goto error;
+    } else if (!(e->flags & FIO___URING_ARMED_IN)) {
+      if (fio___uring_push(p,
+                           IORING_OP_POLL_ADD,
+                           fd,
+                           (POLLIN | POLLRDHUP),
+                           0,
+                           fio___uring_ud(e, FIO___URING_K_POLL_IN)))
+        goto error;
+      e->flags |= FIO___URING_ARMED_IN;
+    }
+  }
+  FIO___LOCK_UNLOCK(p->lock);
+  return r;
+error:
+  FIO___LOCK_UNLOCK(p->lock);
+  return (r = -1);
+}
+
+/**
+ * Stops monitoring the specified file descriptor (if monitoring).
+ *
+ * Armed requests hold a reference to the socket, so their cancellation is
+ * submitted immediately - otherwise a closed socket would linger in the kernel
+ * until the next review.
+ */
+SFUNC int fio_poll_forget(fio_poll_s *p, fio_socket_i fd) {
+  if (!p || p->fd == -1 || fd == FIO_SOCKET_INVALID)
+    return -1;
+  fio___uring_i_s old;
+  FIO___LOCK_LOCK(p->lock);
+  fio___uring_i_s *e =
+      fio___uring_map_get(&p->map, (fio___uring_i_s){.fd = fd});
+  if (!e)
+    goto not_found;
+  old = *e;
+  fio___uring_map_remove(&p->map, old);
+  if ((old.flags & FIO___URING_ARMED_OUT))
+    fio___uring_push(p,
+                     IORING_OP_POLL_REMOVE,
+                     -1,
+                     0,
+                     fio___uring_ud(&old, FIO___URING_K_POLL_OUT),
+                     FIO___URING_UD_INTERNAL);
+  if ((old.flags & FIO___URING_ARMED_IN))
+    fio___uring_push(p,
+                     IORING_OP_POLL_REMOVE,
+                     -1,
+                     0,
+                     fio___uring_ud(&old, FIO___URING_K_POLL_IN),
+                     FIO___URING_UD_INTERNAL);
+  if ((old.flags & FIO___URING_ARMED_RECV))
+    fio___uring_push(p,
+                     IORING_OP_ASYNC_CANCEL,
+                     -1,
+                     0,
+                     fio___uring_ud(&old,
+                                    ((old.flags & FIO___URING_ACCEPT)
+                                         ? FIO___URING_K_ACCEPT
+                                         : FIO___URING_K_RECV)),
+                     FIO___URING_UD_INTERNAL);
+  if (old.io)
+    fio___uring_io_release(p, old.io, old.flags);
+  fio___uring_flush(p); /* also submits pending sends before `close` */
+  FIO___LOCK_UNLOCK(p->lock);
+  return 0;
+not_found:
+  FIO___LOCK_UNLOCK(p->lock);
+  return -1;
+}
+
+/**
+ * Reads data received by the ring for an fd monitored with `FIO_POLL_IO`.
+ *
+ * Behaves like `read`: returns 0 on EOF and -1 with `errno` set to
+ * `EWOULDBLOCK` while the ring waits for more data. Other descriptors are read
+ * directly.
+ */
+SFUNC ssize_t fio_poll_read(fio_poll_s *p,
+                            fio_socket_i fd,
+                            void *buf,
+                            size_t len) {
+  ssize_t r = 0;
+  fio___uring_i_s *e;
+  fio___uring_io_s *io;
+  if (!p || !p->br)
+    goto direct;
+  FIO___LOCK_LOCK(p->lock);
+  e = fio___uring_map_get(&p->map, (fio___uring_i_s){.fd = fd});
+  if (!e || !(io = e->io) || (e->flags & FIO___URING_ACCEPT))
+    goto direct_unlock;
+  while (io->count && len) {
+    fio___uring_in_s *i = io->in + (io->head & (io->capa - 1));
+    size_t n = (i->len < len) ? i->len : len;
+    FIO_MEMCPY((char *)buf + r,
+               p->bufs + ((size_t)i->bid * FIO_POLL_URING_BUFFER_SIZE) +
+                   i->pos,
+               n);
+    r += n;
+    len -= n;
+    i->pos += (uint32_t)n;
+    i->len -= (uint32_t)n;
+    if (i->len)
+      continue;
+    fio___uring_buf_recycle(p, i->bid);
+    ++io->head;
+    --io->count;
+  }
+  if (r)
+    goto done;
+  if ((e->flags & FIO___URING_ARMED_RECV)) {
+    errno = EWOULDBLOCK;
+    r = -1;
+  } else if ((e->flags & FIO___URING_DONE)) {
+    if (io->err) {
+      errno = io->err;
+      r = -1;
+    }
+  } else { /* no request in flight (paused or readiness fallback) */
+    goto direct_unlock;
+  }
+done:
+  FIO___LOCK_UNLOCK(p->lock);
+  return r;
+direct_unlock:
+  FIO___LOCK_UNLOCK(p->lock);
+direct:
+  return fio_sock_read(fd, buf, len);
+}
+
+/**
+ * Queues a send for an fd monitored with `FIO_POLL_IO`, copying up to
+ * `FIO_POLL_URING_SEND_MAX` bytes. The send is submitted with the next review.
+ *
+ * Returns the number of bytes accepted, or -1 with `errno` set to
+ * `EWOULDBLOCK` while the previous send is in flight. Other descriptors are
+ * written directly.
+ */
+SFUNC ssize_t fio_poll_writev(fio_poll_s *p,
+                              fio_socket_i fd,
+                              const fio_buf_info_s *vec,
+                              size_t count) {
+  ssize_t r = -1;
+  size_t total = 0;
+  fio___uring_i_s *e;
+  fio___uring_io_s *io;
+  if (!p || !p->br)
+    goto direct;
+  FIO___LOCK_LOCK(p->lock);
+  e = fio___uring_map_get(&p->map, (fio___uring_i_s){.fd = fd});
+  if (!e || !(io = e->io))
+    goto direct_unlock;
+  if (io->sending) { /* keeps the stream's order */
+    errno = EWOULDBLOCK;
+    goto done;
+  }
+  if (io->send_err) {
+    errno = io->send_err;
+    goto done;
+  }
+  if ((e->flags & FIO___URING_NO_IO))
+    goto direct_unlock;
+  for (size_t i = 0; i < count && total < FIO_POLL_URING_SEND_MAX; ++i)
+    total += vec[i].len;
+  if (total > FIO_POLL_URING_SEND_MAX)
+    total = FIO_POLL_URING_SEND_MAX;
+  r = 0;
+  if (!total)
+    goto done;
+  io->out = (char *)FIO_MEM_REALLOC_(NULL, 0, total, 0);
+  FIO_ASSERT_ALLOC(io->out);
+  for (size_t i = 0, pos = 0; pos < total; ++i) {
+    size_t n = vec[i].len;
+    if (n > total - pos)
+      n = total - pos;
+    FIO_MEMCPY(io->out + pos, vec[i].buf, n);
+    pos += n;
+  }
+  io->out_len = (uint32_t)total;
+  io->out_pos = 0;
+  if (fio___uring_send(p, io)) {
+    FIO_MEM_FREE_(io->out, total);
+    io->out = NULL;
+    errno = EWOULDBLOCK;
+    r = -1;
+    goto done;
+  }
+  io->sending = 1;
+  r = (ssize_t)total;
+done:
+  FIO___LOCK_UNLOCK(p->lock);
+  return r;
+direct_unlock:
+  FIO___LOCK_UNLOCK(p->lock);
+direct:
+  return fio_sock_writev(fd, vec, count);
+}
+
+/** Same as `fio_poll_writev`, for a single buffer. */
+SFUNC ssize_t fio_poll_write(fio_poll_s *p,
+                             fio_socket_i fd,
+                             const void *buf,
+                             size_t len) {
+  fio_buf_info_s vec = FIO_BUF_INFO2((char *)buf, len);
+  return fio_poll_writev(p, fd, &vec, 1);
+}
+
+/**
+ * Returns 0 once all data written using `fio_poll_write` was sent.
+ *
+ * Returns -1 with `errno` set to `EWOULDBLOCK` while a send is in flight (or
+ * to the send's error).
+ */
+SFUNC int fio_poll_flush(fio_poll_s *p, fio_socket_i fd) {
+  int r = 0;
+  fio___uring_i_s *e;
+  if (!p || !p->br)
+    return r;
+  FIO___LOCK_LOCK(p->lock);
+  e = fio___uring_map_get(&p->map, (fio___uring_i_s){.fd = fd});
+  if (e && e->io && (e->io->sending || e->io->send_err)) {
+    errno = (e->io->sending ? EWOULDBLOCK : e->io->send_err);
+    r = -1;
+  }
+  FIO___LOCK_UNLOCK(p->lock);
+  return r;
+}
+
+/**
+ * Returns a client accepted by the ring for a listening socket monitored with
+ * `FIO_POLL_ACCEPT` (or accepts one directly).
+ *
+ * Returns `FIO_SOCKET_INVALID` with `errno` set to `EWOULDBLOCK` while the
+ * ring waits for clients.
+ */
+SFUNC fio_socket_i fio_poll_accept(fio_poll_s *p, fio_socket_i fd) {
+  fio_socket_i r = FIO_SOCKET_INVALID;
+  fio___uring_i_s *e;
+  fio___uring_io_s *io;
+  if (!p || !p->br)
+    goto direct;
+  FIO___LOCK_LOCK(p->lock);
+  e = fio___uring_map_get(&p->map, (fio___uring_i_s){.fd = fd});
+  if (!e || !(io = e->io) || !(e->flags & FIO___URING_ACCEPT))
+    goto direct_unlock;
+  if (io->count) {
+    r = (fio_socket_i)io->in[io->head & (io->capa - 1)].len;
+    ++io->head;
+    --io->count;
+  } else if ((e->flags & FIO___URING_ARMED_RECV)) {
+    errno = EWOULDBLOCK;
+  } else {
+    goto direct_unlock;
+  }
+  FIO___LOCK_UNLOCK(p->lock);
+  return r;
+direct_unlock:
+  FIO___LOCK_UNLOCK(p->lock);
+direct:
+  return fio_sock_accept(fd, NULL, NULL);
+}
+
+typedef struct {
+  void *udata;
+  uint32_t ev;
+} fio___uring_event_s;
+
+/**
+ * Reviews if any of the monitored file descriptors has any events.
+ *
+ * `timeout` is in milliseconds.
+ *
+ * Returns the number of events called.
+ *
+ * Polling is thread safe, but has different effects on different threads.
+ *
+ * Adding a new file descriptor from one thread while polling in a different
+ * thread will not poll that IO until `fio_poll_review` is called again.
+ */
+SFUNC int fio_poll_review(fio_poll_s *p, size_t timeout) {
+  int total = 0;
+  uint32_t ready;
+  fio___uring_event_s events[FIO_POLL_MAX_EVENTS];
+  if (!p || p->fd == -1)
+    return total;
+  struct __kernel_timespec ts = {
+      .tv_sec = (long long)(timeout / 1000),
+      .tv_nsec = (long long)((timeout % 1000) * 1000000),
+  };
+  struct io_uring_getevents_arg arg = {.sigmask = 0};
+  arg.ts = (uint64_t)(uintptr_t)&ts;
+
+  /* one system call: submit all queued requests (and sends) and wait */
+  {
+    unsigned head, tail;
+    FIO___LOCK_LOCK(p->lock);
+    fio_atomic_load(head, p->sq.head);
+    const unsigned pending = p->sq_tail - head;
+    ready = p->ready_count;
+    FIO___LOCK_UNLOCK(p->lock);
+    fio_atomic_load(tail, p->cq.tail);
+    const unsigned wait = (tail == *p->cq.head) && timeout && !ready;
+    /* GETEVENTS also runs deferred task work (completions) when not waiting */
+    int r = fio___uring_enter(p->fd,
+                              pending,
+                              wait,
+                              (IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG),
+                              &arg,
+                              sizeof(arg));
+    if (r == -1 && errno != ETIME && errno != EINTR && errno != EBUSY)
+      FIO_LOG_DEBUG2("io_uring_enter error: %s", strerror(errno));
+  }
+
+  /* harvest completions in batches, resolving udata under the lock */
+  for (;;) {
+    unsigned head = *p->cq.head, tail;
+    size_t count = 0;
+    fio_atomic_load(tail, p->cq.tail);
+    FIO___LOCK_LOCK(p->lock);
+    /* fds with queued ring I/O data, listed before this review started */
+    for (; ready && p->ready_count && count < FIO_POLL_MAX_EVENTS; --ready) {
+      const uint64_t ud = p->ready[--p->ready_count];
+      fio___uring_i_s *e = fio___uring_map_get(
+          &p->map,
+          (fio___uring_i_s){.fd = (int)(uint32_t)ud});
+      if (!e || e->gen != ((uint32_t)(ud >> 32) & FIO___URING_GEN_MASK))
+        continue;
+      e->flags &= ~FIO___URING_READY;
+      if ((events[count].ev = fio___uring_in_events(e, &events[count].udata)))
+        ++count;
+    }
+    while (head != tail && count < FIO_POLL_MAX_EVENTS) {
+      struct io_uring_cqe *cqe = p->cq.cqes + (head & *p->cq.mask);
+      ++head;
+      if ((events[count].ev = fio___uring_on_cqe(p, cqe, &events[count].udata)))
+        ++count;
+    }
+    FIO___LOCK_UNLOCK(p->lock);
+    fio_atomic_exchange(p->cq.head, head); /* release CQ slots */
+    if (!count)
+      break;
+    for (size_t i = 0; i < count; ++i) {
+      if ((events[i].ev & FIO___URING_EV_DATA))
+        p->settings.on_data(events[i].udata);
+      if ((events[i].ev & FIO___URING_EV_READY))
+        p->settings.on_ready(events[i].udata);
+      if ((events[i].ev & FIO___URING_EV_CLOSE))
+        p->settings.on_close(events[i].udata);
+    }
+    total += (int)count;
+  }
+  return total;
+}
+
+/* *****************************************************************************
+Cleanup
+***************************************************************************** */
+#endif /* FIO_EXTERN_COMPLETE */
+#undef FIO___URING_ARMED_IN
+#undef FIO___URING_ARMED_OUT
+#undef FIO___URING_ARMED_RECV
+#undef FIO___URING_CANCELING
+#undef FIO___URING_WANT_IN
+#undef FIO___URING_WANT_OUT
+#undef FIO___URING_DONE
+#undef FIO___URING_ACCEPT
+#undef FIO___URING_NO_IO
+#undef FIO___URING_READY
+#undef FIO___URING_K_POLL_IN
+#undef FIO___URING_K_POLL_OUT
+#undef FIO___URING_K_RECV
+#undef FIO___URING_K_ACCEPT
+#undef FIO___URING_K_SEND
+#undef FIO___URING_UD_KIND
+#undef FIO___URING_UD_INTERNAL
+#undef FIO___URING_GEN_MASK
+#undef FIO___URING_EV_DATA
+#undef FIO___URING_EV_READY
+#undef FIO___URING_EV_CLOSE
+#undef FIO___URING_REGISTER_PBUF_RING
+#undef FIO___URING_RECV_MULTISHOT
+#undef FIO___URING_ACCEPT_MULTISHOT
+#undef FIO___URING_CANCEL_ANY
+#undef FIO___URING_CQE_F_BUFFER
+#undef FIO___URING_CQE_F_MORE
+#undef FIO___URING_CQE_BUFFER_SHIFT
+#endif /* FIO_POLL_ENGINE_URING */
@@ -34,6 +34,16 @@ Queue Type(s)
 #endif
 #endif
 
+#ifndef FIO_QUEUE_STEAL_CAPACITY
+/** Tasks held by each work-stealing worker's local deque (a power of 2). */
+#define FIO_QUEUE_STEAL_CAPACITY 256
+#endif
+
+#ifndef FIO_QUEUE_STEAL_BATCH
+/** Tasks a work-stealing worker moves from the shared ring per lock. */
+#define FIO_QUEUE_STEAL_BATCH 16
+#endif
+
 /** Task information */
 typedef struct {
   /** The function to call */
@@ -59,8 +69,12 @@ typedef struct {
   fio___task_ring_s *r;
   /** task write pointer. */
   fio___task_ring_s *w;
-  /** the number of tasks waiting to be performed. */
+  /** the number of tasks waiting in the shared ring buffer. */
   uint32_t count;
+  /** the number of tasks waiting in work-stealing worker deques. */
+  volatile uint32_t local;
+  /** the number of urgent tasks at the head of the shared ring buffer. */
+  volatile uint32_t urgent;
   /** global queue lock. */
   FIO___LOCK_TYPE lock;
   /** linked lists of consumer threads. */
@@ -69,6 +83,8 @@ typedef struct {
   fio___task_ring_s mem;
 } fio_queue_s;
 
+typedef struct fio___queue_deque_s fio___queue_deque_s;
+
 typedef struct {
   FIO_LIST_NODE node;
   fio_queue_s *queue;
@@ -77,6 +93,14 @@ typedef struct {
   fio_thread_cond_t cond;
   size_t workers;
   volatile int stop;
+  /** work-stealing deques (one per worker), or NULL. */
+  fio___queue_deque_s *deques;
+  /** the number of workers waiting for a signal. */
+  volatile size_t idle;
+  /** used to assign deques to workers. */
+  volatile size_t started;
+  /** set if the group should use work-stealing deques. */
+  int steal;
 } fio___thread_group_s;
 
 /* *****************************************************************************
@@ -122,6 +146,16 @@ SFUNC int fio_queue_push(fio_queue_s *q, fio_queue_task_s task);
 #define fio_queue_push(q, ...)                                                 \
   fio_queue_push((q), (fio_queue_task_s){__VA_ARGS__})
 
+/**
+ * Pushes the tasks returned by `next` (until it returns a NULL task) under a
+ * single lock. `next` is called with the queue locked.
+ *
+ * Returns the number of tasks pushed (stops early if out of memory).
+ */
+SFUNC size_t fio_queue_push_batch(fio_queue_s *q,
+                                  fio_queue_task_s (*next)(void *udata),
+                                  void *udata);
+
 /** Pushes a task to the head of the queue. Returns -1 on error (no memory). */
 SFUNC int fio_queue_push_urgent(fio_queue_s *q, fio_queue_task_s task);
 
@@ -147,6 +181,18 @@ FIO_IFUNC uint32_t fio_queue_count(fio_queue_s *q);
 /** Adds worker / consumer threads to perform the jobs in the queue. */
 SFUNC int fio_queue_workers_add(fio_queue_s *q, size_t count);
 
+/**
+ * Adds work-stealing worker threads to perform the jobs in the queue.
+ *
+ * Each worker owns a local deque. Tasks pushed by a worker are placed in its
+ * own deque (no lock), other threads push to the shared ring, which workers
+ * drain in batches. Idle workers steal tasks from their peers.
+ *
+ * NOTE: tasks are no longer performed in a global FIFO order (urgent tasks are
+ * still performed before other tasks).
+ */
+SFUNC int fio_queue_workers_add_stealing(fio_queue_s *q, size_t count);
+
 /** Signals all worker threads to stop performing tasks and terminate. */
 SFUNC void fio_queue_workers_stop(fio_queue_s *q);
 
@@ -160,10 +206,33 @@ SFUNC void fio_queue_workers_wake(fio_queue_s *q);
 Timer Queue Types and API
 ***************************************************************************** */
 
+#ifndef FIO_TIMER_WHEEL_LEVELS
+/**
+ * The number of timing wheel levels (64 slots each), by default 6.
+ *
+ * Each level covers 64 times the range of the previous one, starting at 1ms
+ * slots, so 6 levels cover 2^36ms (~2 years). Timers beyond that range (or
+ * overdue timers) are kept in a short sorted list.
+ */
+#define FIO_TIMER_WHEEL_LEVELS 6
+#endif
+
 typedef struct fio___timer_event_s fio___timer_event_s;
+/** An opaque timer handle, returned by `fio_timer_schedule`. */
+typedef struct fio___timer_event_s fio_timer_s;
 
+/** A hierarchical timing wheel (O(1) insertion). See FIO_TIMER_QUEUE_INIT. */
 typedef struct {
+  /** Wheel slots (unsorted lists, `head->prev` points at the tail). */
+  fio___timer_event_s *slots[FIO_TIMER_WHEEL_LEVELS * 64];
+  /** Occupied slot bitmaps, one per level. */
+  uint64_t map[FIO_TIMER_WHEEL_LEVELS];
+  /** Sorted list for overdue / out of range events. */
   fio___timer_event_s *next;
+  /** The wheel's current millisecond (anything earlier was pushed). */
+  int64_t at;
+  /** The number of events in the wheel and the sorted list. */
+  size_t count;
   FIO___LOCK_TYPE lock;
 } fio_timer_queue_s;
 
@@ -192,15 +261,52 @@ typedef struct {
   int64_t start_at;
 } fio_timer_schedule_args_s;
 
-/** Adds a time-bound event to the timer queue. */
-SFUNC void fio_timer_schedule(fio_timer_queue_s *timer_queue,
-                              fio_timer_schedule_args_s args);
+/**
+ * Adds a time-bound event to the timer queue.
+ *
+ * Returns a timer handle (or NULL on error). The handle is owned by the caller
+ * and must be released using `fio_timer_free` (it remains valid, even after
+ * the timer finished, until released).
+ */
+SFUNC fio_timer_s *fio_timer_schedule(fio_timer_queue_s *timer_queue,
+                                     fio_timer_schedule_args_s args);
 
 /** A MACRO allowing named arguments to be used. See fio_timer_schedule_args_s.
  */
 #define fio_timer_schedule(timer_queue, ...)                                   \
   fio_timer_schedule((timer_queue), (fio_timer_schedule_args_s){__VA_ARGS__})
 
+/**
+ * Cancels a timer, calling its `on_finish` callback. Thread safe.
+ *
+ * A pending timer is removed immediately (O(1)). A timer that is currently
+ * performing (or waiting in a task queue) will not be performed again.
+ *
+ * Returns 0 on success or -1 if the timer was already finished / cancelled.
+ */
+SFUNC int fio_timer_cancel(fio_timer_s *timer);
+
+/**
+ * Sets a timer's next due time to `start_at + every`. Thread safe.
+ *
+ * If `every` is zero, the timer's interval is unchanged. If `start_at` is zero,
+ * `fio_time_milli()` is used.
+ *
+ * NOTE: a timer performing its final repetition (or whose callback returns a
+ * non-zero value) still finishes.
+ *
+ * Returns 0 on success or -1 if the timer was already finished / cancelled.
+ */
+SFUNC int fio_timer_reschedule(fio_timer_s *timer,
+                               uint32_t every,
+                               int64_t start_at);
+
+/** Increases a timer handle's reference count, returning the handle. */
+SFUNC fio_timer_s *fio_timer_dup(fio_timer_s *timer);
+
+/** Releases a timer handle reference (see `fio_timer_schedule`). */
+SFUNC void fio_timer_free(fio_timer_s *timer);
+
 /** Pushes due events from the timer queue to an event queue. */
 SFUNC size_t fio_timer_push2queue(fio_queue_s *queue,
                                   fio_timer_queue_s *timer_queue,
@@ -234,7 +340,9 @@ Queue Inline Helpers
 ***************************************************************************** */
 
 /** returns the number of tasks in the queue. */
-FIO_IFUNC uint32_t fio_queue_count(fio_queue_s *q) { return q->count; }
+FIO_IFUNC uint32_t fio_queue_count(fio_queue_s *q) {
+  return q->count + q->local;
+}
 
 /** Initializes a fio_queue_s object. */
 FIO_IFUNC void fio_queue_init(fio_queue_s *q) {
@@ -242,6 +350,8 @@ FIO_IFUNC void fio_queue_init(fio_queue_s *q) {
   q->r = &q->mem;
   q->w = &q->mem;
   q->count = 0;
+  q->local = 0;
+  q->urgent = 0;
   q->consumers = FIO_LIST_INIT(q->consumers);
   q->lock = FIO___LOCK_INIT;
   q->mem.next = NULL;
@@ -257,12 +367,45 @@ struct fio___timer_event_s {
   void *udata1;
   void *udata2;
   void (*on_finish)(void *udata1, void *udata2);
+  fio_timer_queue_s *tq;
   int64_t due;
   uint32_t every;
   int32_t repetitions;
+  volatile uint32_t ref;
+  /** wheel slot, `FIO___TIMER_SLOT_LIST` or `FIO___TIMER_SLOT_NONE` */
+  uint16_t slot;
+  volatile uint8_t flags;
   struct fio___timer_event_s *next;
+  struct fio___timer_event_s *prev;
 };
 
+#define FIO___TIMER_SLOT_LIST       (FIO_TIMER_WHEEL_LEVELS * 64)
+#define FIO___TIMER_SLOT_NONE       (FIO___TIMER_SLOT_LIST + 1)
+#define FIO___TIMER_FLAG_CANCELED   1
+#define FIO___TIMER_FLAG_DONE       2
+#define FIO___TIMER_FLAG_RESCHEDULE 4
+
+/* Returns the first millisecond (>= `at`) when the wheel has work to do. */
+FIO_IFUNC int64_t fio___timer_wheel_next(fio_timer_queue_s *tq) {
+  /* upper level slots reached by `at` must cascade before anything else */
+  for (size_t l = 1; l < FIO_TIMER_WHEEL_LEVELS; ++l)
+    if (tq->map[l] & ((uint64_t)1 << ((tq->at >> (6 * l)) & 63)))
+      return tq->at;
+  for (size_t l = 0; l < FIO_TIMER_WHEEL_LEVELS; ++l) {
+    const size_t shift = 6 * l;
+    const size_t index = (size_t)(tq->at >> shift) & 63;
+    /* the current slot of an upper level only holds events pending cascade */
+    uint64_t m = tq->map[l] & ~(((uint64_t)1 << index) - 1);
+    int64_t t;
+    if (!m)
+      continue;
+    t = ((tq->at >> (shift + 6)) << (shift + 6)) |
+        ((int64_t)fio_lsb_index_unsafe(m) << shift);
+    return (t < tq->at) ? tq->at : t;
+  }
+  return (int64_t)((~(uint64_t)0) >> 1);
+}
+
 /*
  * Returns the millisecond at which the next event should occur.
  *
@@ -270,15 +413,20 @@ struct fio___timer_event_s {
  *
  * NOTE: unless manually specified, millisecond timers are relative to
  * `fio_time_milli()`.
+ *
+ * NOTE: events held in upper wheel levels report the start of their slot,
+ * which may be earlier than the event's actual due time.
  */
 FIO_IFUNC int64_t fio_timer_next_at(fio_timer_queue_s *tq) {
   int64_t v = (int64_t)((~(uint64_t)0) >> 1);
   if (!tq)
     goto missing_tq;
-  if (!tq || !tq->next)
+  if (!tq || !tq->count)
     return v;
   FIO___LOCK_LOCK(tq->lock);
-  if (tq->next)
+  if (tq->count)
+    v = fio___timer_wheel_next(tq);
+  if (tq->next && tq->next->due < v)
     v = tq->next->due;
   FIO___LOCK_UNLOCK(tq->lock);
   return v;
@@ -296,6 +444,93 @@ Queue Implementation
 /* task queue leak detection */
 FIO_LEAK_COUNTER_DEF(fio_queue)
 FIO_LEAK_COUNTER_DEF(fio_queue_task_rings)
+
+/* *****************************************************************************
+Work-Stealing Deques
+
+Each work-stealing worker owns a bounded ring (Vyukov's MPMC cell sequence
+scheme): only the owner pushes, while the owner and its peers pop (FIFO, so a
+task that re-schedules itself can't starve the rest of the deque).
+***************************************************************************** */
+
+typedef struct {
+  volatile size_t seq;
+  fio_queue_task_s task;
+} fio___queue_deque_cell_s;
+
+struct fio___queue_deque_s {
+  /** consumer position (owner and thieves). */
+  volatile size_t head;
+  uint8_t padding_[64 - sizeof(size_t)];
+  /** producer position (owner only). */
+  size_t tail;
+  fio_queue_s *q;
+  fio___thread_group_s *grp;
+  size_t index;
+  fio___queue_deque_cell_s cells[FIO_QUEUE_STEAL_CAPACITY];
+};
+
+/* the work-stealing deque owned by the current thread (if any) */
+static __thread fio___queue_deque_s *fio___queue_deque;
+
+FIO_IFUNC void fio___queue_deque_init(fio___queue_deque_s *d,
+                                      fio___thread_group_s *grp,
+                                      size_t index) {
+  d->head = d->tail = 0;
+  d->q = grp->queue;
+  d->grp = grp;
+  d->index = index;
+  for (size_t i = 0; i < FIO_QUEUE_STEAL_CAPACITY; ++i)
+    d->cells[i].seq = i;
+}
+
+/* returns the number of free cells (owner only, may under-report). */
+FIO_IFUNC size_t fio___queue_deque_space(fio___queue_deque_s *d) {
+  size_t head;
+  fio_atomic_load(head, &d->head);
+  return FIO_QUEUE_STEAL_CAPACITY - (d->tail - head);
+}
+
+/* pushes a task to the deque (owner only). Returns -1 if full. */
+FIO_IFUNC int fio___queue_deque_push(fio___queue_deque_s *d,
+                                     fio_queue_task_s task) {
+  fio___queue_deque_cell_s *c =
+      d->cells + (d->tail & (FIO_QUEUE_STEAL_CAPACITY - 1));
+  size_t seq;
+  fio_atomic_load(seq, &c->seq);
+  if (seq != d->tail)
+    return -1;
+  c->task = task;
+  fio_atomic_exchange(&c->seq, d->tail + 1);
+  ++d->tail;
+  return 0;
+}
+
+/* pops a task from the deque (any thread). */
+FIO_IFUNC fio_queue_task_s fio___queue_deque_pop(fio___queue_deque_s *d) {
+  fio_queue_task_s t = {.fn = NULL};
+  fio___queue_deque_cell_s *c;
+  size_t pos, seq;
+  fio_atomic_load(pos, &d->head);
+  for (;;) {
+    c = d->cells + (pos & (FIO_QUEUE_STEAL_CAPACITY - 1));
+    fio_atomic_load(seq, &c->seq);
+    if (seq == pos + 1) {
+      if (fio_atomic_compare_exchange_p(&d->head, &pos, &(size_t){pos + 1}))
+        break;
+      fio_atomic_load(pos, &d->head);
+    } else if ((intptr_t)(seq - (pos + 1)) < 0) {
+      return t; /* empty */
+    } else {
+      fio_atomic_load(pos, &d->head);
+    }
+  }
+  t = c->task;
+  fio_atomic_exchange(&c->seq, pos + FIO_QUEUE_STEAL_CAPACITY);
+  fio_atomic_sub(&d->q->local, 1);
+  return t;
+}
+
 /** Destroys a queue and re-initializes it, after freeing any used resources. */
 SFUNC void fio_queue_destroy(fio_queue_s *q) {
   for (;;) {
@@ -311,9 +546,11 @@ SFUNC void fio_queue_destroy(fio_queue_s *q) {
       break;
     }
     FIO_LIST_EACH(fio___thread_group_s, node, &q->consumers, pos) {
+      fio_thread_mutex_lock(&pos->mutex);
       fio_atomic_or(&pos->stop, 1);
       for (size_t i = 0; i < pos->workers; ++i)
         fio_thread_cond_signal(&pos->cond);
+      fio_thread_mutex_unlock(&pos->mutex);
     }
     FIO_LIST_EACH(fio___thread_group_s, node, &q->consumers, pos) {
       FIO___LOCK_UNLOCK(q->lock);
@@ -389,12 +626,74 @@ FIO_IFUNC fio_queue_task_s fio___task_ring_pop(fio___task_ring_s *r) {
   return t;
 }
 
-int fio_queue_push___(void); /* sublime text marker */
-/** Pushes a task to the queue. Returns -1 on error. */
-SFUNC int fio_queue_push FIO_NOOP(fio_queue_s *q, fio_queue_task_s task) {
-  if (!task.fn)
-    return 0;
-  FIO___LOCK_LOCK(q->lock);
+/* adds a drained ring buffer to a list of buffers to be freed. Locked. */
+FIO_IFUNC void fio___queue_ring_release(fio_queue_s *q,
+                                        fio___task_ring_s *r,
+                                        fio___task_ring_s **to_free) {
+  if (r == &q->mem) {
+    r->next = NULL;
+    return;
+  }
+  r->next = *to_free;
+  *to_free = r;
+}
+
+/* pops a task from the shared ring buffer. Call with lock held. */
+FIO_IFUNC fio_queue_task_s fio___queue_ring_pop(fio_queue_s *q,
+                                                fio___task_ring_s **to_free) {
+  fio_queue_task_s t = {.fn = NULL};
+  if (!q->count)
+    return t;
+  if (!(t = fio___task_ring_pop(q->r)).fn) {
+    fio___task_ring_s *drained = q->r;
+    q->r = drained->next;
+    fio___queue_ring_release(q, drained, to_free);
+    t = fio___task_ring_pop(q->r);
+  }
+  if (!t.fn)
+    return t;
+  if (q->urgent)
+    fio_atomic_sub(&q->urgent, 1);
+  if (!(--q->count) && q->r != &q->mem) {
+    fio___queue_ring_release(q, q->r, to_free);
+    q->r = q->w = &q->mem;
+    q->mem.w = q->mem.r = q->mem.dir = 0;
+  }
+  return t;
+}
+
+/* frees the ring buffers collected by `fio___queue_ring_pop`. */
+FIO_IFUNC void fio___queue_ring_free(fio___task_ring_s *to_free) {
+  while (to_free) {
+    fio___task_ring_s *tmp = to_free;
+    to_free = to_free->next;
+    FIO_LEAK_COUNTER_ON_FREE(fio_queue_task_rings);
+    FIO_MEM_FREE_(tmp, sizeof(*tmp));
+  }
+}
+
+/* returns the number of idle workers in a group. */
+FIO_IFUNC size_t fio___queue_idle(fio___thread_group_s *grp) {
+  size_t r;
+  fio_atomic_load(r, &grp->idle);
+  return r;
+}
+
+/* pushes a task to the calling worker's deque, waking an idle peer. */
+FIO_IFUNC int fio___queue_deque_push_local(fio___queue_deque_s *d,
+                                           fio_queue_task_s task) {
+  fio_atomic_add(&d->q->local, 1);
+  if (fio___queue_deque_push(d, task)) {
+    fio_atomic_sub(&d->q->local, 1);
+    return -1;
+  }
+  if (fio___queue_idle(d->grp))
+    fio_thread_cond_signal(&d->grp->cond);
+  return 0;
+}
+
+/* pushes a task to the shared ring buffer (-1 if out of memory). Locked. */
+FIO_IFUNC int fio___queue_ring_push(fio_queue_s *q, fio_queue_task_s task) {
   if (fio___task_ring_push(q->w, task)) {
     if (q->w != &q->mem && q->mem.next == NULL) {
       q->w->next = &q->mem;
@@ -403,7 +702,7 @@ SFUNC int fio_queue_push FIO_NOOP(fio_queue_s *q, fio_queue_task_s task) {
       void *tmp = (fio___task_ring_s *)
           FIO_MEM_REALLOC_(NULL, 0, sizeof(*q->w->next), 0);
       if (!tmp)
-        goto no_mem;
+        return -1;
       FIO_LEAK_COUNTER_ON_ALLOC(fio_queue_task_rings);
       q->w->next = (fio___task_ring_s *)tmp;
       if (!FIO_MEM_REALLOC_IS_SAFE_) {
@@ -416,18 +715,55 @@ SFUNC int fio_queue_push FIO_NOOP(fio_queue_s *q, fio_queue_task_s task) {
     fio___task_ring_push(q->w, task);
   }
   ++q->count;
+  return 0;
+}
+
+/* signals the queue's consumers. Call with lock held. */
+FIO_IFUNC void fio___queue_signal(fio_queue_s *q) {
   if (!FIO_LIST_IS_EMPTY(&q->consumers)) {
     FIO_LIST_EACH(fio___thread_group_s, node, &q->consumers, pos) {
       fio_thread_cond_signal(&pos->cond);
     }
   }
+}
+
+int fio_queue_push___(void); /* sublime text marker */
+/** Pushes a task to the queue. Returns -1 on error. */
+SFUNC int fio_queue_push FIO_NOOP(fio_queue_s *q, fio_queue_task_s task) {
+  int r;
+  if (!task.fn)
+    return 0;
+  if (fio___queue_deque && fio___queue_deque->q == q &&
+      !fio___queue_deque_push_local(fio___queue_deque, task))
+    return 0;
+  FIO___LOCK_LOCK(q->lock);
+  if (!(r = fio___queue_ring_push(q, task)))
+    fio___queue_signal(q);
   FIO___LOCK_UNLOCK(q->lock);
-  return 0;
-no_mem:
+  if (r)
+    FIO_LOG_ERROR("No memory for Queue %p to increase task ring buffer.",
+                  (void *)q);
+  return r;
+}
+
+int fio_queue_push_batch___(void); /* IDE marker */
+/** Pushes the tasks returned by `next` under a single lock. */
+SFUNC size_t fio_queue_push_batch FIO_NOOP(fio_queue_s *q,
+                                           fio_queue_task_s (*next)(void *),
+                                           void *udata) {
+  size_t r = 0;
+  int err = 0;
+  fio_queue_task_s task;
+  FIO___LOCK_LOCK(q->lock);
+  while ((task = next(udata)).fn && !(err = fio___queue_ring_push(q, task)))
+    ++r;
+  if (r)
+    fio___queue_signal(q);
   FIO___LOCK_UNLOCK(q->lock);
-  FIO_LOG_ERROR("No memory for Queue %p to increase task ring buffer.",
-                (void *)q);
-  return -1;
+  if (err)
+    FIO_LOG_ERROR("No memory for Queue %p to increase task ring buffer.",
+                  (void *)q);
+  return r;
 }
 
 int fio_queue_push_urgent___(void); /* IDE marker */
@@ -451,6 +787,7 @@ SFUNC int fio_queue_push_urgent FIO_NOOP(fio_queue_s *q,
     tmp->buf[0] = task;
   }
   ++q->count;
+  fio_atomic_add(&q->urgent, 1);
   if (!FIO_LIST_IS_EMPTY(&q->consumers)) {
     FIO_LIST_EACH(fio___thread_group_s, node, &q->consumers, pos) {
       fio_thread_cond_signal(&pos->cond);
@@ -465,38 +802,73 @@ no_mem:
   return -1;
 }
 
+/* steals a task from a work-stealing group, starting after `skip`. */
+FIO_IFUNC fio_queue_task_s fio___queue_steal(fio___thread_group_s *grp,
+                                             size_t skip) {
+  fio_queue_task_s t = {.fn = NULL};
+  for (size_t i = 1; i <= grp->workers; ++i) {
+    t = fio___queue_deque_pop(grp->deques + ((skip + i) % grp->workers));
+    if (t.fn)
+      break;
+  }
+  return t;
+}
+
+/* pops a task for a work-stealing worker (urgent, local, shared, peers). */
+FIO_SFUNC fio_queue_task_s fio___queue_pop_worker(fio___queue_deque_s *d) {
+  fio_queue_s *q = d->q;
+  fio_queue_task_s t = {.fn = NULL};
+  fio___task_ring_s *to_free = NULL;
+  if (!q->urgent && (t = fio___queue_deque_pop(d)).fn)
+    return t;
+  if (q->count) {
+    /* move a batch of tasks from the shared ring to the local deque */
+    size_t batch = fio___queue_deque_space(d);
+    if (batch > FIO_QUEUE_STEAL_BATCH)
+      batch = FIO_QUEUE_STEAL_BATCH;
+    FIO___LOCK_LOCK(q->lock);
+    t = fio___queue_ring_pop(q, &to_free);
+    for (size_t i = 1; t.fn && i < batch && q->count && !q->urgent; ++i) {
+      fio_queue_task_s tmp = fio___queue_ring_pop(q, &to_free);
+      fio_atomic_add(&q->local, 1);
+      if (!fio___queue_deque_push(d, tmp))
+        continue;
+      /* a thief advanced `head` but didn't release its cell yet. Return the
+       * task to the head of the ring (the slot it just left is free). */
+      fio_atomic_sub(&q->local, 1);
+      fio___task_ring_unpop(q->r, tmp);
+      ++q->count;
+      break;
+    }
+    FIO___LOCK_UNLOCK(q->lock);
+    fio___queue_ring_free(to_free);
+    if (t.fn)
+      return t;
+  }
+  if ((t = fio___queue_deque_pop(d)).fn)
+    return t;
+  return fio___queue_steal(d->grp, d->index);
+}
+
 /** Pops a task from the queue (FIFO). Returns a NULL task on error. */
 SFUNC fio_queue_task_s fio_queue_pop(fio_queue_s *q) {
   fio_queue_task_s t = {.fn = NULL};
   fio___task_ring_s *to_free = NULL;
-  fio___task_ring_s *to_free_tst = NULL;
-  if (!q->count)
+  if (fio___queue_deque && fio___queue_deque->q == q)
+    return fio___queue_pop_worker(fio___queue_deque);
+  if (!q->count && !q->local)
     return t;
   FIO___LOCK_LOCK(q->lock);
-  if (!q->count)
-    goto finish;
-  if (!(t = fio___task_ring_pop(q->r)).fn) {
-    to_free = q->r;
-    q->r = to_free->next;
-    to_free->next = NULL;
-    t = fio___task_ring_pop(q->r);
-  }
-  if (t.fn && !(--q->count) && q->r != &q->mem) {
-    if (to_free && to_free != &q->mem) { // edge case
-      FIO_LEAK_COUNTER_ON_FREE(fio_queue_task_rings);
-      FIO_MEM_FREE_(to_free, sizeof(*to_free));
+  t = fio___queue_ring_pop(q, &to_free);
+  if (!t.fn && q->local) {
+    /* steal from work-stealing workers (group list is protected by lock) */
+    FIO_LIST_EACH(fio___thread_group_s, node, &q->consumers, pos) {
+      if (pos->deques && (t = fio___queue_steal(pos, 0)).fn)
+        break;
     }
-    to_free = q->r;
-    q->r = q->w = &q->mem;
-    q->mem.w = q->mem.r = q->mem.dir = 0;
   }
-  to_free_tst = &q->mem;
-finish:
   FIO___LOCK_UNLOCK(q->lock);
-  if (to_free && to_free != to_free_tst) {
-    FIO_LEAK_COUNTER_ON_FREE(fio_queue_task_rings);
-    FIO_MEM_FREE_(to_free, sizeof(*to_free));
-  }
+  fio___queue_ring_free(to_free);
   return t;
 }
 
@@ -523,27 +895,44 @@ Queue Consumer Threads
 FIO_SFUNC void *fio___queue_worker_task(void *g_) {
   fio___thread_group_s *grp = (fio___thread_group_s *)g_;
   fio_state_callback_force(FIO_CALL_ON_WORKER_THREAD_START);
+  if (grp->deques)
+    fio___queue_deque = grp->deques + fio_atomic_add(&grp->started, 1);
   while (!grp->stop) {
     fio_queue_perform_all(grp->queue);
     fio_thread_mutex_lock(&grp->mutex);
-    if (!grp->stop)
+    fio_atomic_add(&grp->idle, 1);
+    if (!grp->stop && !fio_queue_count(grp->queue))
       fio_thread_cond_wait(&grp->cond, &grp->mutex);
+    fio_atomic_sub(&grp->idle, 1);
     fio_thread_mutex_unlock(&grp->mutex);
     fio_queue_perform_all(grp->queue);
   }
+  if (fio___queue_deque) { /* local tasks are performed before exiting */
+    fio_queue_task_s t;
+    while ((t = fio___queue_deque_pop(fio___queue_deque)).fn)
+      t.fn(t.udata1, t.udata2);
+    fio___queue_deque = NULL;
+  }
   fio_state_callback_force(FIO_CALL_ON_WORKER_THREAD_END);
   return NULL;
 }
 FIO_SFUNC void *fio___queue_worker_manager(void *g_) {
   fio_thread_t threads_buf[256];
   fio___thread_group_s grp = *(fio___thread_group_s *)g_;
-  FIO_LIST_PUSH(&grp.queue->consumers, &grp.node);
-  grp.stop = 0;
   fio_thread_t *threads =
       grp.workers > 256
           ? ((fio_thread_t *)
                  FIO_MEM_REALLOC_(NULL, 0, sizeof(*threads) * grp.workers, 0))
           : threads_buf;
+  if (grp.steal) {
+    grp.deques = (fio___queue_deque_s *)
+        FIO_MEM_REALLOC_(NULL, 0, sizeof(*grp.deques) * grp.workers, 0);
+    /* deques are valid (empty) before any worker starts */
+    for (size_t i = 0; grp.deques && i < grp.workers; ++i)
+      fio___queue_deque_init(grp.deques + i, &grp, i);
+  }
+  FIO_LIST_PUSH(&grp.queue->consumers, &grp.node);
+  grp.stop = 0;
   fio_thread_mutex_init(&grp.mutex);
   fio_thread_cond_init(&grp.cond);
   for (size_t i = 0; i < grp.workers; ++i) {
@@ -559,16 +948,23 @@ FIO_SFUNC void *fio___queue_worker_manager(void *g_) {
   FIO___LOCK_LOCK(grp.queue->lock);
   FIO_LIST_REMOVE(&grp.node);
   FIO___LOCK_UNLOCK(grp.queue->lock);
+  if (grp.deques)
+    FIO_MEM_FREE_(grp.deques, sizeof(*grp.deques) * grp.workers);
   fio_queue_perform_all(grp.queue);
   return NULL;
 }
 
-SFUNC int fio_queue_workers_add(fio_queue_s *q, size_t workers) {
+FIO_SFUNC int fio___queue_workers_add(fio_queue_s *q,
+                                      size_t workers,
+                                      int steal) {
   FIO___LOCK_LOCK(q->lock);
   if (!q->consumers.next || !q->consumers.prev) {
     q->consumers = FIO_LIST_INIT(q->consumers);
   }
-  fio___thread_group_s grp = {.queue = q, .workers = workers, .stop = 1};
+  fio___thread_group_s grp = {.queue = q,
+                              .workers = workers,
+                              .stop = 1,
+                              .steal = steal};
   if (fio_thread_create(&grp.thread, fio___queue_worker_manager, &grp)) {
     FIO___LOCK_UNLOCK(q->lock);
     return -1;
@@ -579,14 +975,25 @@ SFUNC int fio_queue_workers_add(fio_queue_s *q, size_t workers) {
   return 0;
 }
 
+SFUNC int fio_queue_workers_add(fio_queue_s *q, size_t workers) {
+  return fio___queue_workers_add(q, workers, 0);
+}
+
+SFUNC int fio_queue_workers_add_stealing(fio_queue_s *q, size_t workers) {
+  return fio___queue_workers_add(q, workers, 1);
+}
+
 SFUNC void fio_queue_workers_stop(fio_queue_s *q) {
   if (FIO_LIST_IS_EMPTY(&q->consumers))
     return;
   FIO___LOCK_LOCK(q->lock);
   FIO_LIST_EACH(fio___thread_group_s, node, &q->consumers, pos) {
+    /* holding the group's mutex prevents a lost wakeup */
+    fio_thread_mutex_lock(&pos->mutex);
     fio_atomic_or(&pos->stop, 1);
     for (size_t i = 0; i < pos->workers * 2; ++i)
       fio_thread_cond_signal(&pos->cond);
+    fio_thread_mutex_unlock(&pos->mutex);
   }
   FIO___LOCK_UNLOCK(q->lock);
 }
@@ -619,24 +1026,137 @@ Timer Queue Implementation
 ***************************************************************************** */
 FIO_LEAK_COUNTER_DEF(fio___timer_event_s)
 
-FIO_IFUNC void fio___timer_insert(fio___timer_event_s **pos,
+/* Appends an event to an unsorted slot list (`head->prev` is the tail). */
+FIO_IFUNC void fio___timer_slot_push(fio___timer_event_s **head,
+                                     fio___timer_event_s *e) {
+  e->next = NULL;
+  if (!*head) {
+    e->prev = e;
+    *head = e;
+    return;
+  }
+  e->prev = (*head)->prev;
+  (*head)->prev->next = e;
+  (*head)->prev = e;
+}
+
+/* Removes an event from a slot list or the sorted list. */
+FIO_IFUNC void fio___timer_unlink(fio___timer_event_s **head,
                                   fio___timer_event_s *e) {
-  while (*pos && e->due >= (*pos)->due)
-    pos = &((*pos)->next);
-  e->next = *pos;
-  *pos = e;
+  if (*head == e)
+    *head = e->next;
+  else
+    e->prev->next = e->next;
+  if (e->next)
+    e->next->prev = e->prev;
+  else if (*head)
+    (*head)->prev = e->prev;
+  e->next = e->prev = NULL;
 }
 
-FIO_IFUNC fio___timer_event_s *fio___timer_pop(fio___timer_event_s **pos,
-                                               int64_t due) {
-  if (!*pos || (*pos)->due > due)
-    return NULL;
-  fio___timer_event_s *t = *pos;
-  *pos = t->next;
-  return t;
+/* Inserts an event to the wheel (or the sorted list). Call with lock held. */
+FIO_IFUNC void fio___timer_insert(fio_timer_queue_s *tq,
+                                  fio___timer_event_s *e) {
+  const uint64_t x = (uint64_t)(e->due ^ tq->at);
+  ++tq->count;
+  if (e->due < tq->at || (x >> (6 * FIO_TIMER_WHEEL_LEVELS))) {
+    /* overdue or out of range - sorted list (expected to be very short) */
+    fio___timer_event_s *pos = tq->next;
+    e->slot = FIO___TIMER_SLOT_LIST;
+    if (!pos || e->due < pos->due) {
+      e->next = pos;
+      e->prev = pos ? pos->prev : e;
+      if (pos)
+        pos->prev = e;
+      tq->next = e;
+      return;
+    }
+    while (pos->next && e->due >= pos->next->due)
+      pos = pos->next;
+    e->next = pos->next;
+    e->prev = pos;
+    if (pos->next)
+      pos->next->prev = e;
+    else
+      tq->next->prev = e;
+    pos->next = e;
+    return;
+  }
+  /* the level is set by the highest bit that differs from the wheel's time */
+  const size_t l = (x < 64) ? 0 : (fio_msb_index_unsafe(x) / 6);
+  const size_t slot = (size_t)(e->due >> (6 * l)) & 63;
+  e->slot = (uint16_t)((l * 64) + slot);
+  fio___timer_slot_push(tq->slots + e->slot, e);
+  tq->map[l] |= ((uint64_t)1 << slot);
+}
+
+/* Removes a pending event from the wheel (or the sorted list). Locked. */
+FIO_IFUNC void fio___timer_remove(fio_timer_queue_s *tq,
+                                  fio___timer_event_s *e) {
+  --tq->count;
+  if (e->slot == FIO___TIMER_SLOT_LIST) {
+    fio___timer_unlink(&tq->next, e);
+  } else {
+    fio___timer_unlink(tq->slots + e->slot, e);
+    if (!tq->slots[e->slot])
+      tq->map[e->slot >> 6] &= ~((uint64_t)1 << (e->slot & 63));
+  }
+  e->slot = FIO___TIMER_SLOT_NONE;
+}
+
+/* Moves the wheel to `now + 1`, collecting due events (in order). Locked. */
+FIO_IFUNC fio___timer_event_s *fio___timer_advance(fio_timer_queue_s *tq,
+                                                   int64_t now) {
+  fio___timer_event_s *due = NULL;
+  /* overdue / out of range events first */
+  while (tq->next && tq->next->due <= now) {
+    fio___timer_event_s *e = tq->next;
+    fio___timer_remove(tq, e);
+    fio___timer_slot_push(&due, e);
+  }
+  for (;;) {
+    const int64_t t = fio___timer_wheel_next(tq);
+    if (t > now)
+      break;
+    tq->at = t;
+    /* cascade upper level slots that `t` reached, top down */
+    for (size_t l = FIO_TIMER_WHEEL_LEVELS - 1; l; --l) {
+      const size_t slot = (size_t)(t >> (6 * l)) & 63;
+      if (!(tq->map[l] & ((uint64_t)1 << slot)))
+        continue;
+      fio___timer_event_s *e = tq->slots[(l * 64) + slot];
+      tq->slots[(l * 64) + slot] = NULL;
+      tq->map[l] &= ~((uint64_t)1 << slot);
+      while (e) {
+        fio___timer_event_s *tmp = e;
+        e = e->next;
+        --tq->count;
+        fio___timer_insert(tq, tmp);
+      }
+    }
+    /* collect the level 0 slot (all events in the slot are due at `t`) */
+    const size_t slot = (size_t)t & 63;
+    if ((tq->map[0] & ((uint64_t)1 << slot))) {
+      fio___timer_event_s *e = tq->slots[slot];
+      tq->slots[slot] = NULL;
+      tq->map[0] &= ~((uint64_t)1 << slot);
+      while (e) {
+        fio___timer_event_s *tmp = e;
+        e = e->next;
+        --tq->count;
+        tmp->slot = FIO___TIMER_SLOT_NONE;
+        fio___timer_slot_push(&due, tmp);
+      }
+    }
+    tq->at = t + 1;
+  }
+  if (tq->at <= now)
+    tq->at = now + 1;
+  return due;
 }
 
 FIO_IFUNC fio___timer_event_s *fio___timer_event_new(
+    fio_timer_queue_s *tq,
     fio_timer_schedule_args_s args) {
   fio___timer_event_s *t = NULL;
   t = (fio___timer_event_s *)FIO_MEM_REALLOC_(NULL, 0, sizeof(*t), 0);
@@ -649,9 +1169,12 @@ FIO_IFUNC fio___timer_event_s *fio___timer_event_new(
       .udata1 = args.udata1,
       .udata2 = args.udata2,
       .on_finish = args.on_finish,
+      .tq = tq,
       .due = args.start_at + args.every,
       .every = args.every,
       .repetitions = args.repetitions,
+      .ref = 2, /* the timer queue's and the caller's references */
+      .slot = FIO___TIMER_SLOT_NONE,
   };
   return t;
 init_error:
@@ -660,29 +1183,51 @@ init_error:
   return NULL;
 }
 
-FIO_IFUNC void fio___timer_event_free(fio_timer_queue_s *tq,
-                                      fio___timer_event_s *t) {
-  if (!t)
-    return;
-  if (tq && (t->repetitions < 0 || fio_atomic_sub_fetch(&t->repetitions, 1))) {
-    FIO___LOCK_LOCK(tq->lock);
-    fio___timer_insert(&tq->next, t);
-    FIO___LOCK_UNLOCK(tq->lock);
+/** Increases a timer handle's reference count, returning the handle. */
+SFUNC fio_timer_s *fio_timer_dup(fio_timer_s *t) {
+  if (t)
+    fio_atomic_add(&t->ref, 1);
+  return t;
+}
+
+/** Releases a timer handle reference (see `fio_timer_schedule`). */
+SFUNC void fio_timer_free(fio_timer_s *t) {
+  if (!t || fio_atomic_sub_fetch(&t->ref, 1))
     return;
-  }
-  if (t->on_finish)
-    t->on_finish(t->udata1, t->udata2);
   FIO_LEAK_COUNTER_ON_FREE(fio___timer_event_s);
   FIO_MEM_FREE_(t, sizeof(*t));
 }
 
-FIO_SFUNC void fio___timer_perform(void *timer_, void *t_) {
-  fio_timer_queue_s *tq = (fio_timer_queue_s *)timer_;
+/* Calls `on_finish` and releases the timer queue's reference. */
+FIO_IFUNC void fio___timer_event_finish(fio___timer_event_s *t) {
+  if (t->on_finish)
+    t->on_finish(t->udata1, t->udata2);
+  fio_timer_free(t);
+}
+
+FIO_SFUNC void fio___timer_perform(void *t_, void *ignr_) {
   fio___timer_event_s *t = (fio___timer_event_s *)t_;
-  if (t->fn(t->udata1, t->udata2))
-    tq = NULL;
-  t->due += t->every;
-  fio___timer_event_free(tq, t);
+  fio_timer_queue_s *tq = t->tq;
+  uint8_t flags;
+  int stop;
+  fio_atomic_load(flags, &t->flags);
+  stop = (flags & FIO___TIMER_FLAG_CANCELED) || t->fn(t->udata1, t->udata2);
+  FIO___LOCK_LOCK(tq->lock);
+  stop |= (t->flags & FIO___TIMER_FLAG_CANCELED);
+  if (!stop && t->repetitions > 0)
+    stop = !(--t->repetitions);
+  if (stop) {
+    fio_atomic_or(&t->flags, FIO___TIMER_FLAG_DONE);
+  } else {
+    if (!(t->flags & FIO___TIMER_FLAG_RESCHEDULE))
+      t->due += t->every;
+    fio_atomic_and(&t->flags, (uint8_t)~FIO___TIMER_FLAG_RESCHEDULE);
+    fio___timer_insert(tq, t);
+  }
+  FIO___LOCK_UNLOCK(tq->lock);
+  if (stop)
+    fio___timer_event_finish(t);
+  (void)ignr_;
 }
 
 /** Pushes due events from the timer queue to an event queue. */
@@ -694,38 +1239,102 @@ SFUNC size_t fio_timer_push2queue(fio_queue_s *queue,
     start_at = fio_time_milli();
   if (FIO___LOCK_TRYLOCK(timer->lock))
     return 0;
-  fio___timer_event_s *t;
-  while ((t = fio___timer_pop(&timer->next, start_at))) {
-    fio_queue_push(queue,
-                   .fn = fio___timer_perform,
-                   .udata1 = timer,
-                   .udata2 = t);
+  fio___timer_event_s *t = fio___timer_advance(timer, start_at);
+  FIO___LOCK_UNLOCK(timer->lock);
+  while (t) {
+    fio___timer_event_s *tmp = t;
+    t = t->next;
+    fio_queue_push(queue, .fn = fio___timer_perform, .udata1 = tmp);
     ++r;
   }
-  FIO___LOCK_UNLOCK(timer->lock);
   return r;
 }
 
 void fio_timer_schedule___(void); /* IDE marker */
 /** Adds a time-bound event to the timer queue. */
-SFUNC void fio_timer_schedule FIO_NOOP(fio_timer_queue_s *timer,
-                                       fio_timer_schedule_args_s args) {
+SFUNC fio_timer_s *fio_timer_schedule FIO_NOOP(fio_timer_queue_s *timer,
+                                               fio_timer_schedule_args_s args) {
   fio___timer_event_s *t = NULL;
   if (!timer || !args.fn || !args.every)
     goto no_timer_queue;
   if (!args.start_at)
     args.start_at = fio_time_milli();
-  t = fio___timer_event_new(args);
+  t = fio___timer_event_new(timer, args);
   if (!t)
-    return;
+    return t;
   FIO___LOCK_LOCK(timer->lock);
-  fio___timer_insert(&timer->next, t);
+  if (!timer->count) /* an empty wheel may be (re)positioned safely */
+    timer->at = args.start_at;
+  fio___timer_insert(timer, t);
   FIO___LOCK_UNLOCK(timer->lock);
-  return;
+  return t;
 no_timer_queue:
   if (args.on_finish)
     args.on_finish(args.udata1, args.udata2);
   FIO_LOG_ERROR("fio_timer_schedule called with illegal arguments.");
+  return t;
+}
+
+/** Cancels a timer, calling its `on_finish` callback. Thread safe. */
+SFUNC int fio_timer_cancel(fio_timer_s *t) {
+  int pending;
+  uint8_t flags;
+  if (!t)
+    return -1;
+  /* a finished timer's queue may have been destroyed already */
+  fio_atomic_load(flags, &t->flags);
+  if (flags & FIO___TIMER_FLAG_DONE)
+    return -1;
+  FIO___LOCK_LOCK(t->tq->lock);
+  if (t->flags & (FIO___TIMER_FLAG_CANCELED | FIO___TIMER_FLAG_DONE))
+    goto gone;
+  fio_atomic_or(&t->flags, FIO___TIMER_FLAG_CANCELED);
+  /* in-flight events are finished by `fio___timer_perform` */
+  pending = (t->slot != FIO___TIMER_SLOT_NONE);
+  if (pending) {
+    fio_atomic_or(&t->flags, FIO___TIMER_FLAG_DONE);
+    fio___timer_remove(t->tq, t);
+  }
+  FIO___LOCK_UNLOCK(t->tq->lock);
+  if (pending)
+    fio___timer_event_finish(t);
+  return 0;
+gone:
+  FIO___LOCK_UNLOCK(t->tq->lock);
+  return -1;
+}
+
+/** Sets a timer's next due time to `start_at + every`. Thread safe. */
+SFUNC int fio_timer_reschedule(fio_timer_s *t,
+                               uint32_t every,
+                               int64_t start_at) {
+  uint8_t flags;
+  if (!t)
+    return -1;
+  /* a finished timer's queue may have been destroyed already */
+  fio_atomic_load(flags, &t->flags);
+  if (flags & FIO___TIMER_FLAG_DONE)
+    return -1;
+  if (!start_at)
+    start_at = fio_time_milli();
+  FIO___LOCK_LOCK(t->tq->lock);
+  if (t->flags & (FIO___TIMER_FLAG_CANCELED | FIO___TIMER_FLAG_DONE))
+    goto gone;
+  if (every)
+    t->every = every;
+  t->due = start_at + t->every;
+  if (t->slot == FIO___TIMER_SLOT_NONE) {
+    /* in-flight, `fio___timer_perform` will reinsert the event */
+    fio_atomic_or(&t->flags, FIO___TIMER_FLAG_RESCHEDULE);
+  } else {
+    fio___timer_remove(t->tq, t);
+    fio___timer_insert(t->tq, t);
+  }
+  FIO___LOCK_UNLOCK(t->tq->lock);
+  return 0;
+gone:
+  FIO___LOCK_UNLOCK(t->tq->lock);
+  return -1;
 }
 
 /**
@@ -744,14 +1353,33 @@ SFUNC void fio_timer_destroy(fio_timer_queue_s *tq) {
     return;
   fio___timer_event_s *next = NULL;
   FIO___LOCK_LOCK(tq->lock);
-  next = tq->next;
-  tq->next = NULL;
+  /* collect all events (wheel slots and sorted list) into a single list */
+  for (size_t i = 0; i < FIO_TIMER_WHEEL_LEVELS * 64; ++i) {
+    fio___timer_event_s *e = tq->slots[i];
+    tq->slots[i] = NULL;
+    while (e) {
+      fio___timer_event_s *tmp = e;
+      e = e->next;
+      fio___timer_slot_push(&next, tmp);
+    }
+  }
+  while (tq->next) {
+    fio___timer_event_s *tmp = tq->next;
+    tq->next = tmp->next;
+    fio___timer_slot_push(&next, tmp);
+  }
+  for (fio___timer_event_s *e = next; e; e = e->next) {
+    e->slot = FIO___TIMER_SLOT_NONE;
+    fio_atomic_or(&e->flags, FIO___TIMER_FLAG_DONE);
+  }
+  FIO_MEMSET(tq->map, 0, sizeof(tq->map));
+  tq->count = 0;
   FIO___LOCK_UNLOCK(tq->lock);
   FIO___LOCK_DESTROY(tq->lock);
   while (next) {
     fio___timer_event_s *tmp = next;
     next = next->next;
-    fio___timer_event_free(NULL, tmp);
+    fio___timer_event_finish(tmp);
   }
 }
 /* *****************************************************************************
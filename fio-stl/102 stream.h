@@ -115,6 +115,38 @@ Stream API - Consuming the stream
  */
 SFUNC void fio_stream_read(fio_stream_s *stream, char **buf, size_t *len);
 
+/**
+ * Gathers up to `count` buffers from the stream's in-memory packets, leaving
+ * the data in the stream (zero-copy, for use with `writev` / `sendmsg`).
+ *
+ * Returns the number of `vec` entries filled. Gathering stops at the first
+ * file packet, so `0` is returned if the stream is empty or the next packet
+ * references a file (use `fio_stream_read` in that case).
+ *
+ * The buffers are valid until the stream is advanced or destroyed.
+ *
+ * Note: this isn't thread safe.
+ */
+SFUNC size_t fio_stream_read_vec(fio_stream_s *stream,
+                                 fio_buf_info_s *vec,
+                                 size_t count);
+
+/**
+ * If the next packet in the stream references a file descriptor, sets `fd`,
+ * `offset` and `len` to the file's unconsumed byte range and returns 0.
+ *
+ * This allows the file to be sent without copying it to user space (i.e., using
+ * `sendfile`). The data is left in the stream.
+ *
+ * Returns -1 if the stream is empty or the next packet is a memory packet.
+ *
+ * Note: this isn't thread safe.
+ */
+SFUNC int fio_stream_read_fd(fio_stream_s *stream,
+                             int *fd,
+                             size_t *offset,
+                             size_t *len);
+
 /**
  * Advances the Stream, so the first `len` bytes are marked as consumed.
  *
@@ -565,6 +597,63 @@ none:
   *len = 0;
 }
 
+/**
+ * Gathers up to `count` buffers from the stream's in-memory packets, leaving
+ * the data in the stream.
+ *
+ * Note: this isn't thread safe.
+ */
+SFUNC size_t fio_stream_read_vec(fio_stream_s *s,
+                                 fio_buf_info_s *vec,
+                                 size_t count) {
+  size_t filled = 0;
+  if (!s || !vec)
+    return filled;
+  size_t offset = s->consumed;
+  for (fio_stream_packet_s *p = s->next; p && filled < count; p = p->next) {
+    union {
+      fio_stream_packet_embd_s *em;
+      fio_stream_packet_extrn_s *ext;
+    } const u = {.em = (fio_stream_packet_embd_s *)(p + 1)};
+    switch (u.em->type) {
+    case FIO_PACKET_TYPE_EMBEDDED:
+      vec[filled++] = FIO_BUF_INFO2(u.em->buf + offset,
+                                    (size_t)u.em->length - offset);
+      break;
+    case FIO_PACKET_TYPE_EXTERNAL:
+      vec[filled++] = FIO_BUF_INFO2(u.ext->buf + u.ext->offset + offset,
+                                    u.ext->length - offset);
+      break;
+    case FIO_PACKET_TYPE_FILE: /* fall through */
+    case FIO_PACKET_TYPE_FILE_NO_CLOSE: return filled;
+    }
+    offset = 0;
+  }
+  return filled;
+}
+
+/**
+ * If the next packet in the stream references a file descriptor, sets `fd`,
+ * `offset` and `len` to the file's unconsumed byte range and returns 0.
+ *
+ * Note: this isn't thread safe.
+ */
+SFUNC int fio_stream_read_fd(fio_stream_s *s,
+                             int *fd,
+                             size_t *offset,
+                             size_t *len) {
+  if (!s || !s->next || !fd || !offset || !len)
+    return -1;
+  fio_stream_packet_fd_s *f = (fio_stream_packet_fd_s *)(s->next + 1);
+  if (f->type != FIO_PACKET_TYPE_FILE &&
+      f->type != FIO_PACKET_TYPE_FILE_NO_CLOSE)
+    return -1;
+  *fd = f->fd;
+  *offset = f->offset + s->consumed;
+  *len = f->length - s->consumed;
+  return 0;
+}
+
 /**
  * Advances the Stream, so the first `len` bytes are marked as consumed.
  *
@@ -70,8 +70,10 @@ Module-Specific SIMD Implementations:
 
 ChaCha20Poly1305 (152 chacha20poly1305.h):
 - NEON: 4-block parallel (256 bytes/call), vertical SIMD layout
-- AVX2: 8-block parallel (512 bytes/call), vertical SIMD layout
+- x86: SSE2 4-block, AVX2 8-block and AVX-512F 16-block kernels, selected at
+  runtime (`target` attributes + `__builtin_cpu_supports`)
 - Uses byte shuffle for 8/16-bit rotations, shift+or for 7/12-bit
+- Poly1305 (x86): 4-way (AVX2) / 8-way (AVX-512F) Horner steps, 26-bit limbs
 
 Ed25519/X25519 (154 ed25519.h):
 - NEON: Vectorized 5-limb field add/sub/cswap for GF(2^255-19)
@@ -159,6 +159,48 @@ ChaCha20Poly1305 Implementation
 ***************************************************************************** */
 #if defined(FIO_EXTERN_COMPLETE) || !defined(FIO_EXTERN)
 
+/* *****************************************************************************
+SIMD Kernel Selection (x86)
+
+SSE2 is part of x86-64, so the 4-block ChaCha20 kernel is always available. The
+8-block (AVX2) and 16-block (AVX-512) kernels and the 4-way Poly1305 are built
+using `target` attributes and selected at runtime, so generic builds use them
+on CPUs that support them.
+***************************************************************************** */
+#if defined(FIO___HAS_X86_INTRIN) && defined(__SSE2__)
+#define FIO___CHACHA_X86 1
+
+#define FIO___CHACHA_CPU_AVX2   2
+#define FIO___CHACHA_CPU_AVX512 4
+
+/* detected once - concurrent detection is harmless (same result). */
+static int fio___chacha_cpu_flags;
+
+/** Returns the CPU features used by the ChaCha20 / Poly1305 kernels. */
+FIO_IFUNC int fio___chacha_cpu(void) {
+  int r = fio___chacha_cpu_flags;
+  if (FIO_LIKELY(r))
+    return r;
+  r = 1;
+#if defined(__AVX2__)
+  r |= FIO___CHACHA_CPU_AVX2;
+#else
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    r |= FIO___CHACHA_CPU_AVX2;
+#endif
+#if defined(__AVX512F__)
+  r |= FIO___CHACHA_CPU_AVX512;
+#else
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    r |= FIO___CHACHA_CPU_AVX512;
+#endif
+  fio___chacha_cpu_flags = r;
+  return r;
+}
+#endif /* FIO___HAS_X86_INTRIN && __SSE2__ */
+
 /* *****************************************************************************
 Poly1305 (authentication)
 Prime 2^130-5   = 0x3FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFB
@@ -350,24 +392,318 @@ FIO_IFUNC void fio___poly_finilize(fio___poly_s *pl) {
   pl->a[1] = a1;
 }
 
+/* *****************************************************************************
+Poly1305 - Multi-Block Horner Evaluation (AVX2 / AVX-512)
+
+With N lanes, each lane accumulates every Nth block, multiplying by r^N per
+step, so N blocks are processed in parallel (N = 4 shown):
+
+  h = (h + m0) * r^4 + m1 * r^3 + m2 * r^2 + m3 * r
+
+The last step multiplies the lanes by r^N ... r and adds them up. Lanes use
+5 x 26 bit limbs, so products fit `vpmuludq` (32x32 -> 64 bit).
+***************************************************************************** */
+#if FIO___CHACHA_X86
+#define FIO___POLY26_MASK 0x3FFFFFFULL
+
+/* o = a * b (mod 2^130 - 5) using 26 bit limbs (scalar, for the r powers). */
+FIO_SFUNC void fio___poly26_mul(uint32_t o[5],
+                                const uint32_t a[5],
+                                const uint32_t b[5]) {
+  const uint64_t s1 = b[1] * 5ULL, s2 = b[2] * 5ULL, s3 = b[3] * 5ULL,
+                 s4 = b[4] * 5ULL;
+  uint64_t d[5], c;
+  d[0] = (uint64_t)a[0] * b[0] + a[1] * s4 + a[2] * s3 + a[3] * s2 + a[4] * s1;
+  d[1] = (uint64_t)a[0] * b[1] + (uint64_t)a[1] * b[0] + a[2] * s4 +
+         a[3] * s3 + a[4] * s2;
+  d[2] = (uint64_t)a[0] * b[2] + (uint64_t)a[1] * b[1] +
+         (uint64_t)a[2] * b[0] + a[3] * s4 + a[4] * s3;
+  d[3] = (uint64_t)a[0] * b[3] + (uint64_t)a[1] * b[2] +
+         (uint64_t)a[2] * b[1] + (uint64_t)a[3] * b[0] + a[4] * s4;
+  d[4] = (uint64_t)a[0] * b[4] + (uint64_t)a[1] * b[3] +
+         (uint64_t)a[2] * b[2] + (uint64_t)a[3] * b[1] +
+         (uint64_t)a[4] * b[0];
+  for (size_t i = 0; i < 4; ++i) {
+    c = d[i] >> 26;
+    d[i] &= FIO___POLY26_MASK;
+    d[i + 1] += c;
+  }
+  c = d[4] >> 26;
+  d[4] &= FIO___POLY26_MASK;
+  d[0] += c * 5;
+  c = d[0] >> 26;
+  d[0] &= FIO___POLY26_MASK;
+  d[1] += c;
+  for (size_t i = 0; i < 5; ++i)
+    o[i] = (uint32_t)d[i];
+}
+
+/* Converts r to 26 bit limbs and computes r^2 ... r^count in `rp`. */
+FIO_SFUNC void fio___poly_simd_powers(uint32_t rp[][5],
+                                      fio___poly_s *pl,
+                                      size_t count) {
+  rp[0][0] = (uint32_t)(pl->r[0] & FIO___POLY26_MASK);
+  rp[0][1] =
+      (uint32_t)(((pl->r[0] >> 26) | (pl->r[1] << 18)) & FIO___POLY26_MASK);
+  rp[0][2] = (uint32_t)((pl->r[1] >> 8) & FIO___POLY26_MASK);
+  rp[0][3] =
+      (uint32_t)(((pl->r[1] >> 34) | (pl->r[2] << 10)) & FIO___POLY26_MASK);
+  rp[0][4] = (uint32_t)(pl->r[2] >> 16);
+  for (size_t i = 1; i < count; ++i)
+    fio___poly26_mul(rp[i], rp[i - 1], rp[0]);
+}
+
+/* Splits the accumulator (44 bit limbs) into 26 bit limbs. */
+FIO_IFUNC void fio___poly_simd_split(fio___poly_s *pl, uint64_t h[5]) {
+  uint64_t a0 = pl->a[0], a1 = pl->a[1], a2 = pl->a[2];
+  a2 += a1 >> 44;
+  a1 &= 0xFFFFFFFFFFF;
+  h[0] = a0 & FIO___POLY26_MASK;
+  h[1] = ((a0 >> 26) | (a1 << 18)) & FIO___POLY26_MASK;
+  h[2] = (a1 >> 8) & FIO___POLY26_MASK;
+  h[3] = ((a1 >> 34) | (a2 << 10)) & FIO___POLY26_MASK;
+  h[4] = a2 >> 16;
+}
+
+/* Carries the (lane summed) 26 bit limbs and stores them as 44 bit limbs. */
+FIO_IFUNC void fio___poly_simd_merge(fio___poly_s *pl, uint64_t l[5]) {
+  uint64_t c;
+  for (size_t i = 0; i < 4; ++i) {
+    c = l[i] >> 26;
+    l[i] &= FIO___POLY26_MASK;
+    l[i + 1] += c;
+  }
+  c = l[4] >> 26;
+  l[4] &= FIO___POLY26_MASK;
+  l[0] += c * 5;
+  pl->a[0] = l[0] + ((l[1] & 0x3FFFF) << 26);
+  c = pl->a[0] >> 44;
+  pl->a[0] &= 0xFFFFFFFFFFF;
+  pl->a[1] = (l[1] >> 18) + (l[2] << 8) + ((l[3] & 0x3FF) << 34) + c;
+  c = pl->a[1] >> 44;
+  pl->a[1] &= 0xFFFFFFFFFFF;
+  pl->a[2] = (l[3] >> 10) + (l[4] << 16) + c;
+}
+
+/* Loads one block per lane as 26 bit limbs (lane order: see the callers).
+ * `P` / `B` select the intrinsics (`_mm256` / 256 or `_mm512` / 512). */
+#define FIO___POLY_SIMD_LOAD(P, B, m, src)                                     \
+  do {                                                                         \
+    const P##_si##B##_t_ a_ = P##_loadu_si##B((const void *)(src));            \
+    const P##_si##B##_t_ b_ = P##_loadu_si##B((const void *)((src) + (B / 8)));\
+    const P##_si##B##_t_ t0_ = P##_unpacklo_epi64(a_, b_);                     \
+    const P##_si##B##_t_ t1_ = P##_unpackhi_epi64(a_, b_);                     \
+    m[0] = P##_and_si##B(t0_, mask);                                           \
+    m[1] = P##_and_si##B(P##_srli_epi64(t0_, 26), mask);                       \
+    m[2] = P##_and_si##B(                                                      \
+        P##_or_si##B(P##_srli_epi64(t0_, 52), P##_slli_epi64(t1_, 12)),        \
+        mask);                                                                 \
+    m[3] = P##_and_si##B(P##_srli_epi64(t1_, 14), mask);                       \
+    m[4] = P##_or_si##B(P##_srli_epi64(t1_, 40), hibit);                       \
+  } while (0)
+
+/* d = h * r, where s = r * 5 (unreduced, 64 bit lanes) */
+#define FIO___POLY_SIMD_MUL(P, d, h, r, s)                                     \
+  do {                                                                         \
+    d[0] = P##_add_epi64(                                                      \
+        P##_add_epi64(P##_mul_epu32(h[0], r[0]), P##_mul_epu32(h[1], s[4])),   \
+        P##_add_epi64(                                                         \
+            P##_add_epi64(P##_mul_epu32(h[2], s[3]),                           \
+                          P##_mul_epu32(h[3], s[2])),                          \
+            P##_mul_epu32(h[4], s[1])));                                       \
+    d[1] = P##_add_epi64(                                                      \
+        P##_add_epi64(P##_mul_epu32(h[0], r[1]), P##_mul_epu32(h[1], r[0])),   \
+        P##_add_epi64(                                                         \
+            P##_add_epi64(P##_mul_epu32(h[2], s[4]),                           \
+                          P##_mul_epu32(h[3], s[3])),                          \
+            P##_mul_epu32(h[4], s[2])));                                       \
+    d[2] = P##_add_epi64(                                                      \
+        P##_add_epi64(P##_mul_epu32(h[0], r[2]), P##_mul_epu32(h[1], r[1])),   \
+        P##_add_epi64(                                                         \
+            P##_add_epi64(P##_mul_epu32(h[2], r[0]),                           \
+                          P##_mul_epu32(h[3], s[4])),                          \
+            P##_mul_epu32(h[4], s[3])));                                       \
+    d[3] = P##_add_epi64(                                                      \
+        P##_add_epi64(P##_mul_epu32(h[0], r[3]), P##_mul_epu32(h[1], r[2])),   \
+        P##_add_epi64(                                                         \
+            P##_add_epi64(P##_mul_epu32(h[2], r[1]),                           \
+                          P##_mul_epu32(h[3], r[0])),                          \
+            P##_mul_epu32(h[4], s[4])));                                       \
+    d[4] = P##_add_epi64(                                                      \
+        P##_add_epi64(P##_mul_epu32(h[0], r[4]), P##_mul_epu32(h[1], r[3])),   \
+        P##_add_epi64(                                                         \
+            P##_add_epi64(P##_mul_epu32(h[2], r[2]),                           \
+                          P##_mul_epu32(h[3], r[1])),                          \
+            P##_mul_epu32(h[4], r[0])));                                       \
+  } while (0)
+
+/* h = d (partially carried, two interleaved chains) + m */
+#define FIO___POLY_SIMD_CARRY_ADD(P, B, h, d, m)                               \
+  do {                                                                         \
+    P##_si##B##_t_ t0_, t1_;                                                   \
+    t0_ = P##_srli_epi64(d[0], 26);                                            \
+    t1_ = P##_srli_epi64(d[3], 26);                                            \
+    d[0] = P##_and_si##B(d[0], mask);                                          \
+    d[3] = P##_and_si##B(d[3], mask);                                          \
+    d[1] = P##_add_epi64(d[1], t0_);                                           \
+    d[4] = P##_add_epi64(d[4], t1_);                                           \
+    t0_ = P##_srli_epi64(d[1], 26);                                            \
+    t1_ = P##_srli_epi64(d[4], 26);                                            \
+    d[1] = P##_and_si##B(d[1], mask);                                          \
+    d[4] = P##_and_si##B(d[4], mask);                                          \
+    d[2] = P##_add_epi64(d[2], t0_);                                           \
+    d[0] = P##_add_epi64(d[0], P##_add_epi64(t1_, P##_slli_epi64(t1_, 2)));    \
+    t0_ = P##_srli_epi64(d[2], 26);                                            \
+    t1_ = P##_srli_epi64(d[0], 26);                                            \
+    d[2] = P##_and_si##B(d[2], mask);                                          \
+    d[0] = P##_and_si##B(d[0], mask);                                          \
+    d[3] = P##_add_epi64(d[3], t0_);                                           \
+    d[1] = P##_add_epi64(d[1], t1_);                                           \
+    t0_ = P##_srli_epi64(d[3], 26);                                            \
+    d[3] = P##_and_si##B(d[3], mask);                                          \
+    d[4] = P##_add_epi64(d[4], t0_);                                           \
+    for (size_t i_ = 0; i_ < 5; ++i_)                                          \
+      h[i_] = P##_add_epi64(d[i_], m[i_]);                                     \
+  } while (0)
+
+/* vector type names for the macros above */
+typedef __m256i _mm256_si256_t_;
+typedef __m512i _mm512_si512_t_;
+
+/* Consumes `groups` x 64 bytes (4 blocks each), `groups` must be > 0. */
+__attribute__((target("avx2"))) FIO_SFUNC void fio___poly_avx2_consume(
+    fio___poly_s *pl,
+    const uint8_t *msg,
+    size_t groups) {
+  const __m256i mask = _mm256_set1_epi64x((long long)FIO___POLY26_MASK);
+  const __m256i hibit = _mm256_set1_epi64x(1LL << 24);
+  __m256i h[5], m[5], d[5], r[5], s[5];
+  uint64_t l[5], t[4];
+  uint32_t rp[4][5];
+  fio___poly_simd_powers(rp, pl, 4);
+  fio___poly_simd_split(pl, l);
+  /* lanes hold blocks 0, 2, 1, 3 - the accumulator joins block 0 */
+  FIO___POLY_SIMD_LOAD(_mm256, 256, h, msg);
+  for (size_t i = 0; i < 5; ++i) {
+    h[i] = _mm256_add_epi64(h[i], _mm256_set_epi64x(0, 0, 0, (long long)l[i]));
+    r[i] = _mm256_set1_epi64x((long long)rp[3][i]);
+    s[i] = _mm256_add_epi64(r[i], _mm256_slli_epi64(r[i], 2));
+  }
+  while (--groups) { /* h = h * r^4 + m */
+    msg += 64;
+    FIO___POLY_SIMD_LOAD(_mm256, 256, m, msg);
+    FIO___POLY_SIMD_MUL(_mm256, d, h, r, s);
+    FIO___POLY_SIMD_CARRY_ADD(_mm256, 256, h, d, m);
+  }
+  /* multiply blocks 0, 2, 1, 3 by r^4, r^2, r^3, r and add up the lanes */
+  for (size_t i = 0; i < 5; ++i) {
+    r[i] = _mm256_set_epi64x((long long)rp[0][i],
+                             (long long)rp[2][i],
+                             (long long)rp[1][i],
+                             (long long)rp[3][i]);
+    s[i] = _mm256_add_epi64(r[i], _mm256_slli_epi64(r[i], 2));
+  }
+  FIO___POLY_SIMD_MUL(_mm256, d, h, r, s);
+  for (size_t i = 0; i < 5; ++i) {
+    _mm256_storeu_si256((__m256i *)t, d[i]);
+    l[i] = t[0] + t[1] + t[2] + t[3];
+  }
+  fio___poly_simd_merge(pl, l);
+}
+
+/* Consumes `groups` x 128 bytes (8 blocks each), `groups` must be > 0. */
+__attribute__((target("avx512f"))) FIO_SFUNC void fio___poly_avx512_consume(
+    fio___poly_s *pl,
+    const uint8_t *msg,
+    size_t groups) {
+  const __m512i mask = _mm512_set1_epi64((long long)FIO___POLY26_MASK);
+  const __m512i hibit = _mm512_set1_epi64(1LL << 24);
+  __m512i h[5], m[5], d[5], r[5], s[5];
+  uint64_t l[5];
+  uint32_t rp[8][5];
+  fio___poly_simd_powers(rp, pl, 8);
+  fio___poly_simd_split(pl, l);
+  /* lanes hold blocks 0, 4, 1, 5, 2, 6, 3, 7 - the accumulator joins block 0 */
+  FIO___POLY_SIMD_LOAD(_mm512, 512, h, msg);
+  for (size_t i = 0; i < 5; ++i) {
+    h[i] = _mm512_add_epi64(h[i],
+                            _mm512_set_epi64(0, 0, 0, 0, 0, 0, 0, (long long)l[i]));
+    r[i] = _mm512_set1_epi64((long long)rp[7][i]);
+    s[i] = _mm512_add_epi64(r[i], _mm512_slli_epi64(r[i], 2));
+  }
+  while (--groups) { /* h = h * r^8 + m */
+    msg += 128;
+    FIO___POLY_SIMD_LOAD(_mm512, 512, m, msg);
+    FIO___POLY_SIMD_MUL(_mm512, d, h, r, s);
+    FIO___POLY_SIMD_CARRY_ADD(_mm512, 512, h, d, m);
+  }
+  /* multiply block j by r^(8-j) and add up the lanes */
+  for (size_t i = 0; i < 5; ++i) {
+    r[i] = _mm512_set_epi64((long long)rp[0][i],
+                            (long long)rp[4][i],
+                            (long long)rp[1][i],
+                            (long long)rp[5][i],
+                            (long long)rp[2][i],
+                            (long long)rp[6][i],
+                            (long long)rp[3][i],
+                            (long long)rp[7][i]);
+    s[i] = _mm512_add_epi64(r[i], _mm512_slli_epi64(r[i], 2));
+  }
+  FIO___POLY_SIMD_MUL(_mm512, d, h, r, s);
+  for (size_t i = 0; i < 5; ++i)
+    l[i] = (uint64_t)_mm512_reduce_add_epi64(d[i]);
+  fio___poly_simd_merge(pl, l);
+}
+#undef FIO___POLY_SIMD_LOAD
+#undef FIO___POLY_SIMD_MUL
+#undef FIO___POLY_SIMD_CARRY_ADD
+#endif /* FIO___CHACHA_X86 */
+
+/* Consumes `blocks` full 16 byte blocks. */
+FIO_IFUNC void fio___poly_consume_blocks(fio___poly_s *pl,
+                                         const uint8_t *msg,
+                                         size_t blocks) {
+#if FIO___CHACHA_X86
+  if (blocks > 7) {
+    const int cpu = fio___chacha_cpu();
+    if (blocks > 15 && (cpu & FIO___CHACHA_CPU_AVX512)) {
+      fio___poly_avx512_consume(pl, msg, blocks >> 3);
+      msg += (blocks & (~(size_t)7)) << 4;
+      blocks &= 7;
+    }
+    if (blocks > 7 && (cpu & FIO___CHACHA_CPU_AVX2)) {
+      fio___poly_avx2_consume(pl, msg, blocks >> 2);
+      msg += (blocks & (~(size_t)3)) << 4;
+      blocks &= 3;
+    }
+  }
+#endif
+  for (; blocks; --blocks, msg += 16)
+    fio___poly_consume128bit(pl, msg, 1);
+}
+
+/* Consumes `len` bytes, zero padding the last block (AEAD construction). */
+FIO_IFUNC void fio___poly_consume_padded(fio___poly_s *pl,
+                                         const void *msg,
+                                         size_t len) {
+  fio___poly_consume_blocks(pl, (const uint8_t *)msg, len >> 4);
+  if ((len & 15)) {
+    uint64_t tmp[2] = {0}; /* 16 byte pad */
+    fio_memcpy15x(tmp, (const uint8_t *)msg + (len & (~15ULL)), len);
+    fio___poly_consume128bit(pl, (uint8_t *)tmp, 1);
+  }
+}
+
 FIO_IFUNC void fio___poly_consume_msg(fio___poly_s *pl,
                                       uint8_t *msg,
                                       size_t len) {
   /* read 16 byte blocks */
   uint64_t n[2];
-  for (size_t i = 31; i < len; i += 32) {
-    fio___poly_consume128bit(pl, msg, 1);
-    fio___poly_consume128bit(pl, msg + 16, 1);
-    msg += 32;
-  }
-  if ((len & 16)) {
-    fio___poly_consume128bit(pl, msg, 1);
-    msg += 16;
-  }
+  fio___poly_consume_blocks(pl, msg, len >> 4);
   if ((len & 15)) {
     n[0] = 0;
     n[1] = 0;
-    fio_memcpy15x(n, msg, len);
+    fio_memcpy15x(n, msg + (len & (~15ULL)), len);
     n[0] = fio_ltole64(n[0]);
     n[1] = fio_ltole64(n[1]);
     ((uint8_t *)n)[len & 15] = 0x01;
@@ -627,6 +963,200 @@ FIO_SFUNC void fio___chacha_vround20x4(fio_u512 c, uint8_t *restrict data) {
 }
 
 #undef FIO___CHACHA_QR_NEON
+/* *****************************************************************************
+x86 Multi-Block ChaCha20 (SSE2 4-block, AVX2 8-block, AVX-512 16-block)
+
+Same vertical layout as the NEON kernel: v[w] holds word `w` of every block.
+The output is transposed back using 4x4 word transposes per 128 bit lane,
+followed by a lane permutation for the wider registers.
+***************************************************************************** */
+#elif FIO___CHACHA_X86
+
+/* column and diagonal rounds, `v` is an array of 16 state vectors */
+#define FIO___CHACHA_DOUBLE_ROUND(QR, v)                                       \
+  do {                                                                         \
+    QR(v[0], v[4], v[8], v[12]);                                               \
+    QR(v[1], v[5], v[9], v[13]);                                               \
+    QR(v[2], v[6], v[10], v[14]);                                              \
+    QR(v[3], v[7], v[11], v[15]);                                              \
+    QR(v[0], v[5], v[10], v[15]);                                              \
+    QR(v[1], v[6], v[11], v[12]);                                              \
+    QR(v[2], v[7], v[8], v[13]);                                               \
+    QR(v[3], v[4], v[9], v[14]);                                               \
+  } while (0)
+
+/* 4x4 transpose of 32 bit words within each 128 bit lane (any width) */
+#define FIO___CHACHA_TRANSPOSE4(P, W, v0, v1, v2, v3)                             \
+  do {                                                                         \
+    W t0_ = P##_unpacklo_epi32(v0, v1);                             \
+    W t1_ = P##_unpacklo_epi32(v2, v3);                             \
+    W t2_ = P##_unpackhi_epi32(v0, v1);                             \
+    W t3_ = P##_unpackhi_epi32(v2, v3);                             \
+    v0 = P##_unpacklo_epi64(t0_, t1_);                              \
+    v1 = P##_unpackhi_epi64(t0_, t1_);                              \
+    v2 = P##_unpacklo_epi64(t2_, t3_);                              \
+    v3 = P##_unpackhi_epi64(t2_, t3_);                              \
+  } while (0)
+
+/* SSE2 has no byte shuffle - ROT16 uses word shuffles, others shift + or */
+#define FIO___CHACHA_ROTL_SSE2(x, n)                                           \
+  _mm_or_si128(_mm_slli_epi32((x), (n)), _mm_srli_epi32((x), 32 - (n)))
+#define FIO___CHACHA_QR_SSE2(a, b, c, d)                                       \
+  do {                                                                         \
+    a = _mm_add_epi32(a, b);                                                   \
+    d = _mm_xor_si128(d, a);                                                   \
+    d = _mm_shufflehi_epi16(_mm_shufflelo_epi16(d, 0xB1), 0xB1);               \
+    c = _mm_add_epi32(c, d);                                                   \
+    b = _mm_xor_si128(b, c);                                                   \
+    b = FIO___CHACHA_ROTL_SSE2(b, 12);                                         \
+    a = _mm_add_epi32(a, b);                                                   \
+    d = _mm_xor_si128(d, a);                                                   \
+    d = FIO___CHACHA_ROTL_SSE2(d, 8);                                          \
+    c = _mm_add_epi32(c, d);                                                   \
+    b = _mm_xor_si128(b, c);                                                   \
+    b = FIO___CHACHA_ROTL_SSE2(b, 7);                                          \
+  } while (0)
+
+/* Processes 4 ChaCha20 blocks (256 bytes) using SSE2. */
+FIO_SFUNC void fio___chacha_vround20x4(fio_u512 c, uint8_t *restrict data) {
+  __m128i v[16], s[16];
+  for (size_t i = 0; i < 16; ++i)
+    v[i] = _mm_set1_epi32((int)c.u32[i]);
+  v[12] = _mm_add_epi32(v[12], _mm_set_epi32(3, 2, 1, 0));
+  for (size_t i = 0; i < 16; ++i)
+    s[i] = v[i];
+  for (size_t i = 0; i < 10; ++i)
+    FIO___CHACHA_DOUBLE_ROUND(FIO___CHACHA_QR_SSE2, v);
+  for (size_t i = 0; i < 16; ++i)
+    v[i] = _mm_add_epi32(v[i], s[i]);
+  /* v[w + k] now holds words w..w+3 of block k (w = 0, 4, 8, 12) */
+  for (size_t w = 0; w < 16; w += 4) {
+    FIO___CHACHA_TRANSPOSE4(_mm, __m128i, v[w], v[w + 1], v[w + 2], v[w + 3]);
+    for (size_t k = 0; k < 4; ++k) {
+      uint8_t *p = data + (k << 6) + (w << 2);
+      _mm_storeu_si128(
+          (__m128i *)p,
+          _mm_xor_si128(v[w + k], _mm_loadu_si128((const __m128i *)p)));
+    }
+  }
+}
+#undef FIO___CHACHA_QR_SSE2
+#undef FIO___CHACHA_ROTL_SSE2
+
+/* AVX2: byte shuffles for ROT16 / ROT8, shift + or for ROT12 / ROT7 */
+#define FIO___CHACHA_ROTL_AVX2(x, n)                                           \
+  _mm256_or_si256(_mm256_slli_epi32((x), (n)), _mm256_srli_epi32((x), 32 - (n)))
+#define FIO___CHACHA_QR_AVX2(a, b, c, d)                                       \
+  do {                                                                         \
+    a = _mm256_add_epi32(a, b);                                                \
+    d = _mm256_xor_si256(d, a);                                                \
+    d = _mm256_shuffle_epi8(d, rot16);                                         \
+    c = _mm256_add_epi32(c, d);                                                \
+    b = _mm256_xor_si256(b, c);                                                \
+    b = FIO___CHACHA_ROTL_AVX2(b, 12);                                         \
+    a = _mm256_add_epi32(a, b);                                                \
+    d = _mm256_xor_si256(d, a);                                                \
+    d = _mm256_shuffle_epi8(d, rot8);                                          \
+    c = _mm256_add_epi32(c, d);                                                \
+    b = _mm256_xor_si256(b, c);                                                \
+    b = FIO___CHACHA_ROTL_AVX2(b, 7);                                          \
+  } while (0)
+
+/* Processes 8 ChaCha20 blocks (512 bytes) using AVX2. */
+__attribute__((target("avx2"))) FIO_SFUNC void fio___chacha_vround20x8(
+    fio_u512 c,
+    uint8_t *restrict data) {
+  const __m256i rot16 = _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9,
+                                         14, 15, 12, 13, 2, 3, 0, 1, 6, 7, 4,
+                                         5, 10, 11, 8, 9, 14, 15, 12, 13);
+  const __m256i rot8 = _mm256_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10,
+                                        15, 12, 13, 14, 3, 0, 1, 2, 7, 4, 5, 6,
+                                        11, 8, 9, 10, 15, 12, 13, 14);
+  __m256i v[16], s[16];
+  for (size_t i = 0; i < 16; ++i)
+    v[i] = _mm256_set1_epi32((int)c.u32[i]);
+  v[12] = _mm256_add_epi32(v[12], _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+  for (size_t i = 0; i < 16; ++i)
+    s[i] = v[i];
+  for (size_t i = 0; i < 10; ++i)
+    FIO___CHACHA_DOUBLE_ROUND(FIO___CHACHA_QR_AVX2, v);
+  for (size_t i = 0; i < 16; ++i)
+    v[i] = _mm256_add_epi32(v[i], s[i]);
+  /* v[w + k]: words w..w+3 of block k (low lane) and block k + 4 (high) */
+  for (size_t w = 0; w < 16; w += 4)
+    FIO___CHACHA_TRANSPOSE4(_mm256, __m256i, v[w], v[w + 1], v[w + 2], v[w + 3]);
+  for (size_t k = 0; k < 4; ++k) {
+    __m256i o[4] = {
+        _mm256_permute2x128_si256(v[k], v[k + 4], 0x20),
+        _mm256_permute2x128_si256(v[k + 8], v[k + 12], 0x20),
+        _mm256_permute2x128_si256(v[k], v[k + 4], 0x31),
+        _mm256_permute2x128_si256(v[k + 8], v[k + 12], 0x31),
+    };
+    for (size_t i = 0; i < 4; ++i) {
+      uint8_t *p = data + (k << 6) + ((i & 2) << 7) + ((i & 1) << 5);
+      _mm256_storeu_si256(
+          (__m256i *)p,
+          _mm256_xor_si256(o[i], _mm256_loadu_si256((const __m256i *)p)));
+    }
+  }
+}
+#undef FIO___CHACHA_QR_AVX2
+#undef FIO___CHACHA_ROTL_AVX2
+
+#define FIO___CHACHA_QR_AVX512(a, b, c, d)                                     \
+  do {                                                                         \
+    a = _mm512_add_epi32(a, b);                                                \
+    d = _mm512_rol_epi32(_mm512_xor_si512(d, a), 16);                          \
+    c = _mm512_add_epi32(c, d);                                                \
+    b = _mm512_rol_epi32(_mm512_xor_si512(b, c), 12);                          \
+    a = _mm512_add_epi32(a, b);                                                \
+    d = _mm512_rol_epi32(_mm512_xor_si512(d, a), 8);                           \
+    c = _mm512_add_epi32(c, d);                                                \
+    b = _mm512_rol_epi32(_mm512_xor_si512(b, c), 7);                           \
+  } while (0)
+
+/* Processes 16 ChaCha20 blocks (1024 bytes) using AVX-512F. */
+__attribute__((target("avx512f"))) FIO_SFUNC void fio___chacha_vround20x16(
+    fio_u512 c,
+    uint8_t *restrict data) {
+  __m512i v[16], s[16];
+  for (size_t i = 0; i < 16; ++i)
+    v[i] = _mm512_set1_epi32((int)c.u32[i]);
+  v[12] = _mm512_add_epi32(
+      v[12],
+      _mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+  for (size_t i = 0; i < 16; ++i)
+    s[i] = v[i];
+  for (size_t i = 0; i < 10; ++i)
+    FIO___CHACHA_DOUBLE_ROUND(FIO___CHACHA_QR_AVX512, v);
+  for (size_t i = 0; i < 16; ++i)
+    v[i] = _mm512_add_epi32(v[i], s[i]);
+  /* v[w + k], lane q: words w..w+3 of block 4q + k */
+  for (size_t w = 0; w < 16; w += 4)
+    FIO___CHACHA_TRANSPOSE4(_mm512, __m512i, v[w], v[w + 1], v[w + 2], v[w + 3]);
+  for (size_t k = 0; k < 4; ++k) {
+    /* 4x4 transpose of 128 bit lanes */
+    __m512i a = _mm512_shuffle_i32x4(v[k], v[k + 4], 0x44);
+    __m512i b = _mm512_shuffle_i32x4(v[k], v[k + 4], 0xEE);
+    __m512i c2 = _mm512_shuffle_i32x4(v[k + 8], v[k + 12], 0x44);
+    __m512i d = _mm512_shuffle_i32x4(v[k + 8], v[k + 12], 0xEE);
+    __m512i o[4] = {
+        _mm512_shuffle_i32x4(a, c2, 0x88),
+        _mm512_shuffle_i32x4(a, c2, 0xDD),
+        _mm512_shuffle_i32x4(b, d, 0x88),
+        _mm512_shuffle_i32x4(b, d, 0xDD),
+    };
+    for (size_t q = 0; q < 4; ++q) {
+      uint8_t *p = data + (((q << 2) + k) << 6);
+      _mm512_storeu_si512((void *)p,
+                          _mm512_xor_si512(o[q], _mm512_loadu_si512(p)));
+    }
+  }
+}
+#undef FIO___CHACHA_QR_AVX512
+#undef FIO___CHACHA_TRANSPOSE4
+#undef FIO___CHACHA_DOUBLE_ROUND
+
 /* *****************************************************************************
 Scalar 4-Block ChaCha20 (fallback - processes 256 bytes per call)
 ***************************************************************************** */
@@ -768,7 +1298,37 @@ FIO_SFUNC void fio___chacha_vround20x4(fio_u512 c, uint8_t *restrict data) {
 /* *****************************************************************************
 Scalar 4-Block ChaCha20 variations end
 ***************************************************************************** */
-#endif /* FIO___HAS_ARM_INTRIN (scalar 4-block) */
+#endif /* FIO___HAS_ARM_INTRIN / FIO___CHACHA_X86 / scalar 4-block */
+
+/* XORs `len` bytes (a multiple of 64) with the key stream, advancing the block
+ * counter. Uses the widest kernel available. */
+FIO_SFUNC void fio___chacha_xor_blocks(fio_u512 *c,
+                                       uint8_t *restrict data,
+                                       size_t len) {
+#if FIO___CHACHA_X86
+  const int cpu = fio___chacha_cpu();
+  if ((cpu & FIO___CHACHA_CPU_AVX512)) {
+    for (; len > 1023; len -= 1024, data += 1024) {
+      fio___chacha_vround20x16(*c, data);
+      c->u32[12] += 16;
+    }
+  }
+  if ((cpu & FIO___CHACHA_CPU_AVX2)) {
+    for (; len > 511; len -= 512, data += 512) {
+      fio___chacha_vround20x8(*c, data);
+      c->u32[12] += 8;
+    }
+  }
+#endif
+  for (; len > 255; len -= 256, data += 256) {
+    fio___chacha_vround20x4(*c, data);
+    c->u32[12] += 4;
+  }
+  for (; len; len -= 64, data += 64) {
+    fio___chacha_vround20(*c, data);
+    ++c->u32[12];
+  }
+}
 
 SFUNC void fio_chacha20(void *restrict data,
                         size_t len,
@@ -776,26 +1336,10 @@ SFUNC void fio_chacha20(void *restrict data,
                         const void *nonce,
                         uint32_t counter) {
   fio_u512 c = fio___chacha_init(key, nonce, counter);
-  for (size_t pos = 255; pos < len; pos += 256) {
-    fio___chacha_vround20x4(c, (uint8_t *)data);
-    c.u32[12] += 4; /* block counter */
-    data = (void *)((uint8_t *)data + 256);
-  }
-  if ((len & 128)) {
-    /* Handle 128-byte remainder with single-block calls */
-    fio___chacha_vround20(c, (uint8_t *)data);
-    ++c.u32[12];
-    fio___chacha_vround20(c, (uint8_t *)data + 64);
-    ++c.u32[12];
-    data = (void *)((uint8_t *)data + 128);
-  }
-  if ((len & 64)) {
-    fio___chacha_vround20(c, (uint8_t *)data);
-    data = (void *)((uint8_t *)data + 64);
-    ++c.u32[12];
-  }
+  fio___chacha_xor_blocks(&c, (uint8_t *)data, len & (~63ULL));
   if ((len & 63)) {
     fio_u512 dest; /* no need to initialize, junk data disregarded. */
+    data = (void *)((uint8_t *)data + (len & (~63ULL)));
     fio_memcpy63x(dest.u64, data, len);
     fio___chacha_vround20(c, dest.u8);
     fio_memcpy63x(data, dest.u64, len);
@@ -806,6 +1350,9 @@ SFUNC void fio_chacha20(void *restrict data,
 ChaCha20Poly1305 Encryption with Authentication
 ***************************************************************************** */
 
+/* bytes encrypted before they are authenticated (or vice versa) */
+#define FIO___CHACHA_CHUNK 4096
+
 FIO_IFUNC fio_u512 fio___chacha20_mixround(fio_u512 c) {
   fio_u512 k = {.u64 = {0}};
   fio___chacha_vround20(c, k.u8);
@@ -825,66 +1372,20 @@ SFUNC void fio_chacha20_poly1305_enc(void *restrict mac,
     pl = fio___poly_init(&c2);
   }
   ++c.u32[12]; /* block counter */
-  for (size_t i = 31; i < adlen; i += 32) {
-    fio___poly_consume128bit(&pl, (uint8_t *)ad, 1);
-    fio___poly_consume128bit(&pl, (uint8_t *)ad + 16, 1);
-    ad = (void *)((uint8_t *)ad + 32);
-  }
-  if (adlen & 16) {
-    fio___poly_consume128bit(&pl, (uint8_t *)ad, 1);
-    ad = (void *)((uint8_t *)ad + 16);
-  }
-  if (adlen & 15) {
-    uint64_t tmp[2] = {0}; /* 16 byte pad */
-    fio_memcpy15x(tmp, ad, adlen);
-    fio___poly_consume128bit(&pl, (uint8_t *)tmp, 1);
-  }
-  for (size_t i = 255; i < len; i += 256) {
-    fio___chacha_vround20x4(c, (uint8_t *)data);
-    for (size_t j = 0; j < 256; j += 16)
-      fio___poly_consume128bit(&pl, (void *)((uint8_t *)data + j), 1);
-    c.u32[12] += 4; /* block counter */
-    data = (void *)((uint8_t *)data + 256);
-  }
-  if ((len & 128)) {
-    fio___chacha_vround20(c, (uint8_t *)data);
-    ++c.u32[12];
-    fio___chacha_vround20(c, (uint8_t *)data + 64);
-    ++c.u32[12];
-    for (size_t j = 0; j < 128; j += 16)
-      fio___poly_consume128bit(&pl, (void *)((uint8_t *)data + j), 1);
-    data = (void *)((uint8_t *)data + 128);
-  }
-  if ((len & 64)) {
-    fio___chacha_vround20(c, (uint8_t *)data);
-    fio___poly_consume128bit(&pl, data, 1);
-    fio___poly_consume128bit(&pl, (void *)((uint8_t *)data + 16), 1);
-    fio___poly_consume128bit(&pl, (void *)((uint8_t *)data + 32), 1);
-    fio___poly_consume128bit(&pl, (void *)((uint8_t *)data + 48), 1);
-    ++c.u32[12]; /* block counter */
-    data = (void *)((uint8_t *)data + 64);
+  fio___poly_consume_padded(&pl, ad, adlen);
+  /* encrypt, then authenticate, in cache sized chunks */
+  for (size_t left = len & (~63ULL), n; left; left -= n) {
+    n = (left > FIO___CHACHA_CHUNK) ? FIO___CHACHA_CHUNK : left;
+    fio___chacha_xor_blocks(&c, (uint8_t *)data, n);
+    fio___poly_consume_blocks(&pl, (uint8_t *)data, n >> 4);
+    data = (void *)((uint8_t *)data + n);
   }
   if ((len & 63)) {
     fio_u512 dest;
     fio_memcpy63x(dest.u8, data, len);
     fio___chacha_vround20(c, dest.u8);
     fio_memcpy63x(data, dest.u8, len);
-    uint8_t *p = dest.u8;
-    if ((len & 32)) {
-      fio___poly_consume128bit(&pl, p, 1);
-      fio___poly_consume128bit(&pl, (p + 16), 1);
-      p += 32;
-    }
-    if ((len & 16)) {
-      fio___poly_consume128bit(&pl, p, 1);
-      p += 16;
-    }
-    if ((len & 15)) {
-      /* zero out poly padding */
-      for (size_t i = (len & 15UL); i < 16; i++)
-        p[i] = 0;
-      fio___poly_consume128bit(&pl, p, 1);
-    }
+    fio___poly_consume_padded(&pl, dest.u8, len & 63);
   }
   {
     uint64_t mac_data[2] = {fio_ltole64(adlen), fio_ltole64(len)};
@@ -909,26 +1410,8 @@ SFUNC void fio_chacha20_poly1305_auth(void *restrict mac,
     c = fio___chacha20_mixround(c); /* computes poly1305 key */
     pl = fio___poly_init(&c);
   }
-  for (size_t i = 31; i < adlen; i += 32) {
-    fio___poly_consume128bit(&pl, (uint8_t *)ad, 1);
-    fio___poly_consume128bit(&pl, (uint8_t *)ad + 16, 1);
-    ad = (void *)((uint8_t *)ad + 32);
-  }
-  if (adlen & 16) {
-    fio___poly_consume128bit(&pl, (uint8_t *)ad, 1);
-    ad = (void *)((uint8_t *)ad + 16);
-  }
-  if (adlen & 15) {
-    uint64_t tmp[2] = {0}; /* 16 byte pad */
-    fio_memcpy15x(tmp, ad, adlen);
-    fio___poly_consume128bit(&pl, (uint8_t *)tmp, 1);
-  }
-  fio___poly_consume_msg(&pl, (uint8_t *)data, (len & (~15ULL)));
-  if ((len & 15)) {
-    fio_u128 dest = {0}; /* 16 byte pad */
-    fio_memcpy15x(dest.u64, (uint8_t *)data + (len & (~15ULL)), len);
-    fio___poly_consume128bit(&pl, (uint8_t *)(dest.u64), 1);
-  }
+  fio___poly_consume_padded(&pl, ad, adlen);
+  fio___poly_consume_padded(&pl, data, len);
   {
     uint64_t mac_data[2] = {fio_ltole64(adlen), fio_ltole64(len)};
     fio___poly_consume128bit(&pl, (uint8_t *)mac_data, 1);
@@ -954,69 +1437,18 @@ SFUNC int fio_chacha20_poly1305_dec(void *restrict mac,
     pl = fio___poly_init(&c2);
   }
   ++c.u32[12]; /* block counter */
-  /* Authenticate additional data (same as enc) */
-  for (size_t i = 31; i < adlen; i += 32) {
-    fio___poly_consume128bit(&pl, (uint8_t *)ad, 1);
-    fio___poly_consume128bit(&pl, (uint8_t *)ad + 16, 1);
-    ad = (void *)((uint8_t *)ad + 32);
-  }
-  if (adlen & 16) {
-    fio___poly_consume128bit(&pl, (uint8_t *)ad, 1);
-    ad = (void *)((uint8_t *)ad + 16);
-  }
-  if (adlen & 15) {
-    uint64_t tmp[2] = {0}; /* 16 byte pad */
-    fio_memcpy15x(tmp, ad, adlen);
-    fio___poly_consume128bit(&pl, (uint8_t *)tmp, 1);
-  }
-  /* Fused loop: Poly1305 over ciphertext, then ChaCha20 XOR to decrypt */
-  for (size_t i = 255; i < len; i += 256) {
-    for (size_t j = 0; j < 256; j += 16)
-      fio___poly_consume128bit(&pl, (void *)((uint8_t *)data + j), 1);
-    fio___chacha_vround20x4(c, (uint8_t *)data);
-    c.u32[12] += 4; /* block counter */
-    data = (void *)((uint8_t *)data + 256);
-  }
-  if ((len & 128)) {
-    for (size_t j = 0; j < 128; j += 16)
-      fio___poly_consume128bit(&pl, (void *)((uint8_t *)data + j), 1);
-    fio___chacha_vround20(c, (uint8_t *)data);
-    ++c.u32[12];
-    fio___chacha_vround20(c, (uint8_t *)data + 64);
-    ++c.u32[12];
-    data = (void *)((uint8_t *)data + 128);
-  }
-  if ((len & 64)) {
-    fio___poly_consume128bit(&pl, data, 1);
-    fio___poly_consume128bit(&pl, (void *)((uint8_t *)data + 16), 1);
-    fio___poly_consume128bit(&pl, (void *)((uint8_t *)data + 32), 1);
-    fio___poly_consume128bit(&pl, (void *)((uint8_t *)data + 48), 1);
-    fio___chacha_vround20(c, (uint8_t *)data);
-    ++c.u32[12]; /* block counter */
-    data = (void *)((uint8_t *)data + 64);
+  fio___poly_consume_padded(&pl, ad, adlen);
+  /* authenticate the ciphertext, then decrypt, in cache sized chunks */
+  for (size_t left = len & (~63ULL), n; left; left -= n) {
+    n = (left > FIO___CHACHA_CHUNK) ? FIO___CHACHA_CHUNK : left;
+    fio___poly_consume_blocks(&pl, (uint8_t *)data, n >> 4);
+    fio___chacha_xor_blocks(&c, (uint8_t *)data, n);
+    data = (void *)((uint8_t *)data + n);
   }
   if ((len & 63)) {
-    /* Poly1305 over ciphertext tail (with zero padding) */
-    fio_u512 ct;
-    FIO_MEMSET(ct.u8, 0, 64);
-    fio_memcpy63x(ct.u8, data, len);
-    uint8_t *p = ct.u8;
-    if ((len & 32)) {
-      fio___poly_consume128bit(&pl, p, 1);
-      fio___poly_consume128bit(&pl, (p + 16), 1);
-      p += 32;
-    }
-    if ((len & 16)) {
-      fio___poly_consume128bit(&pl, p, 1);
-      p += 16;
-    }
-    if ((len & 15)) {
-      /* zero padding already set by FIO_MEMSET above */
-      fio___poly_consume128bit(&pl, p, 1);
-    }
-    /* ChaCha20 XOR to decrypt tail in-place */
     fio_u512 dest;
     fio_memcpy63x(dest.u8, data, len);
+    fio___poly_consume_padded(&pl, dest.u8, len & 63);
     fio___chacha_vround20(c, dest.u8);
     fio_memcpy63x(data, dest.u8, len);
   }
@@ -284,6 +284,43 @@ SFUNC void fio_tls13_update_traffic_secret(void *restrict new_secret,
                                            const void *restrict current_secret,
                                            int use_sha384);
 
+/**
+ * Derive a resumption PSK from the resumption_master_secret (RFC 8446 4.6.1).
+ *
+ * PSK = HKDF-Expand-Label(resumption_master_secret, "resumption",
+ *                         ticket_nonce, Hash.length)
+ *
+ * @param psk Output buffer (32 or 48 bytes)
+ * @param resumption_secret The resumption_master_secret
+ * @param nonce The ticket_nonce from the NewSessionTicket message
+ * @param nonce_len Nonce length (max 255)
+ * @param use_sha384 If non-zero, use SHA-384; otherwise SHA-256
+ */
+SFUNC void fio_tls13_derive_resumption_psk(void *restrict psk,
+                                           const void *restrict
+                                               resumption_secret,
+                                           const void *restrict nonce,
+                                           size_t nonce_len,
+                                           int use_sha384);
+
+/**
+ * Compute a resumption PSK binder (RFC 8446 Section 4.2.11.2).
+ *
+ * binder_key = Derive-Secret(Early Secret, "res binder", "")
+ * binder     = HMAC(finished_key(binder_key), Transcript-Hash(Truncate(CH)))
+ *
+ * @param binder Output buffer (32 or 48 bytes)
+ * @param psk The resumption PSK
+ * @param psk_len PSK length
+ * @param transcript_hash Hash of the ClientHello, up to (excluding) binders
+ * @param use_sha384 If non-zero, use SHA-384; otherwise SHA-256
+ */
+SFUNC void fio_tls13_compute_binder(void *restrict binder,
+                                    const void *restrict psk,
+                                    size_t psk_len,
+                                    const void *restrict transcript_hash,
+                                    int use_sha384);
+
 /* *****************************************************************************
 TLS 1.3 Record Layer Constants (RFC 8446 Section 5)
 ***************************************************************************** */
@@ -344,8 +381,11 @@ typedef enum {
   FIO_TLS13_EXT_SUPPORTED_GROUPS = 10,     /* Key exchange groups */
   FIO_TLS13_EXT_SIGNATURE_ALGORITHMS = 13, /* Signature schemes */
   FIO_TLS13_EXT_ALPN = 16, /* Application-Layer Protocol Negotiation */
+  FIO_TLS13_EXT_PRE_SHARED_KEY = 41,     /* PSK identities and binders */
+  FIO_TLS13_EXT_EARLY_DATA = 42,         /* 0-RTT indication */
   FIO_TLS13_EXT_SUPPORTED_VERSIONS = 43, /* TLS version negotiation */
   FIO_TLS13_EXT_COOKIE = 44,             /* Cookie for HRR (RFC 8446 4.2.2) */
+  FIO_TLS13_EXT_PSK_KEY_EXCHANGE_MODES = 45, /* psk_ke / psk_dhe_ke */
   FIO_TLS13_EXT_CERTIFICATE_AUTHORITIES =
       47, /* Acceptable CAs (RFC 8446 4.2.4) */
   FIO_TLS13_EXT_SIGNATURE_ALGORITHMS_CERT = 50, /* Cert chain sig algs */
@@ -402,6 +442,8 @@ typedef struct {
       key_share[1120];    /* Server's key share (max size for X25519MLKEM768) */
   uint16_t key_share_len; /* Length of key share */
   uint16_t key_share_group;   /* Selected group */
+  uint16_t psk_identity;      /* Selected PSK identity (if has_psk) */
+  uint8_t has_psk;            /* 1 if the server accepted a PSK */
   int is_hello_retry_request; /* 1 if HRR */
 } fio_tls13_server_hello_s;
 
@@ -518,7 +560,7 @@ SFUNC const uint8_t *fio_tls13_record_parse_header(
  *
  * @param out          Output buffer for encrypted record
  * @param out_capacity Capacity of output buffer
- * @param plaintext    Plaintext data to encrypt
+ * @param plaintext    Plaintext data to encrypt (may be `out + 5`, in place)
  * @param plaintext_len Length of plaintext
  * @param content_type  Content type (appended to plaintext before encryption)
  * @param keys         Encryption keys (sequence number will be incremented)
@@ -1080,6 +1122,46 @@ SFUNC void fio_tls13_update_traffic_secret(void *restrict new_secret,
                               use_sha384);
 }
 
+SFUNC void fio_tls13_derive_resumption_psk(void *restrict psk,
+                                           const void *restrict
+                                               resumption_secret,
+                                           const void *restrict nonce,
+                                           size_t nonce_len,
+                                           int use_sha384) {
+  const size_t hash_len = use_sha384 ? 48 : 32;
+  fio_tls13_hkdf_expand_label(psk,
+                              hash_len,
+                              resumption_secret,
+                              hash_len,
+                              "resumption",
+                              10,
+                              nonce,
+                              nonce_len,
+                              use_sha384);
+}
+
+SFUNC void fio_tls13_compute_binder(void *restrict binder,
+                                    const void *restrict psk,
+                                    size_t psk_len,
+                                    const void *restrict transcript_hash,
+                                    int use_sha384) {
+  uint8_t secret[48];
+  uint8_t key[48];
+  fio_tls13_derive_early_secret(secret, psk, psk_len, use_sha384);
+  fio_tls13_derive_secret(key,
+                          secret,
+                          use_sha384 ? 48 : 32,
+                          "res binder",
+                          10,
+                          NULL,
+                          0,
+                          use_sha384);
+  fio_tls13_derive_finished_key(secret, key, use_sha384);
+  fio_tls13_compute_finished(binder, secret, transcript_hash, use_sha384);
+  fio_secure_zero(secret, sizeof(secret));
+  fio_secure_zero(key, sizeof(key));
+}
+
 /* *****************************************************************************
 KeyUpdate Message Handling (RFC 8446 Section 4.6.3)
 
@@ -1608,8 +1690,8 @@ SFUNC int fio_tls13_record_encrypt(uint8_t *out,
   /* Prepare inner plaintext: plaintext || content_type */
   uint8_t *ct_out = out + FIO_TLS13_RECORD_HEADER_LEN;
 
-  /* Copy plaintext if provided */
-  if (plaintext && plaintext_len > 0)
+  /* Copy plaintext if provided (unless already in place) */
+  if (plaintext && plaintext_len > 0 && plaintext != ct_out)
     FIO_MEMCPY(ct_out, plaintext, plaintext_len);
 
   /* Append content type */
@@ -2551,6 +2633,14 @@ SFUNC int fio_tls13_parse_server_hello(fio_tls13_server_hello_s *out,
       }
       break;
 
+    case FIO_TLS13_EXT_PRE_SHARED_KEY:
+      /* pre_shared_key in ServerHello: selected_identity (2 bytes) */
+      if (ext_data_len != 2)
+        return -1;
+      out->psk_identity = fio___tls13_read_u16(p);
+      out->has_psk = 1;
+      break;
+
     default:
       /* Ignore unknown extensions */
       break;
@@ -3019,6 +3109,190 @@ typedef enum {
   FIO_TLS13_ALERT_NO_APPLICATION_PROTOCOL = 120,
 } fio_tls13_alert_description_e;
 
+/* *****************************************************************************
+TLS 1.3 Session Tickets (RFC 8446 Section 4.6.1)
+
+Tickets are stateless: the server seals the resumption state (PSK, cipher
+suite, issue time and an SNI hash) using ChaCha20-Poly1305 under a key
+derived from a shared secret and the current time epoch. Any process holding
+the same secret (i.e., all workers after a fork) can resume any session.
+Tickets sealed during the previous epoch are still accepted, so a ticket
+lives for at most two rotation periods.
+
+Only `psk_dhe_ke` resumption is supported (a fresh ECDHE exchange is always
+performed, keeping forward secrecy). 0-RTT early data is not offered.
+***************************************************************************** */
+
+#ifndef FIO_TLS13_TICKET_MAX_LEN
+/** Maximal length of a session ticket a client will store. */
+#define FIO_TLS13_TICKET_MAX_LEN 512
+#endif
+
+#ifndef FIO_TLS13_TICKET_ROTATION
+/** Default ticket key rotation period in seconds (6 hours). */
+#define FIO_TLS13_TICKET_ROTATION 21600
+#endif
+
+/** A session ticket received by a client (RFC 8446 Section 4.6.1). */
+typedef struct {
+  uint64_t received;    /* fio_time_milli() when received */
+  uint32_t lifetime;    /* ticket_lifetime (seconds) */
+  uint32_t age_add;     /* ticket_age_add */
+  uint16_t cipher_suite; /* cipher suite of the original session */
+  uint16_t len;          /* ticket length (0 == no ticket) */
+  uint8_t psk_len;       /* 32 or 48 */
+  uint8_t verified;      /* 1 if the original server certificate was verified */
+  uint8_t psk[48];       /* resumption PSK */
+  uint8_t ticket[FIO_TLS13_TICKET_MAX_LEN]; /* opaque ticket (identity) */
+} fio_tls13_ticket_s;
+
+/** Server side ticket key set, may be shared by any number of servers. */
+typedef struct {
+  uint8_t secret[32]; /* ticket master secret */
+  uint32_t rotation;  /* key rotation period in seconds */
+} fio_tls13_ticket_keys_s;
+
+/**
+ * Initializes a ticket key set.
+ *
+ * If `secret` is NULL, a random secret is used (tickets will only be accepted
+ * by servers sharing this key set object, e.g., processes forked after the
+ * call). Otherwise, servers initialized with the same secret accept each
+ * other's tickets.
+ *
+ * If `rotation` is 0, `FIO_TLS13_TICKET_ROTATION` is used.
+ */
+SFUNC void fio_tls13_ticket_keys_init(fio_tls13_ticket_keys_s *keys,
+                                      const void *secret,
+                                      size_t secret_len,
+                                      uint32_t rotation);
+
+/** Returns 1 if the ticket can still be offered, 0 otherwise. */
+FIO_IFUNC int fio_tls13_ticket_is_valid(const fio_tls13_ticket_s *t) {
+  if (!t || !t->len || (t->psk_len != 32 && t->psk_len != 48))
+    return 0;
+  uint64_t age = (uint64_t)fio_time_milli() - t->received;
+  return age < ((uint64_t)t->lifetime * 1000);
+}
+
+/* Sealed ticket: epoch(4) | nonce(12) | encrypted state | tag(16) */
+#define FIO___TLS13_TICKET_HEAD 16
+/* state: version(1) | suite(2) | issued(8) | age_add(4) | sni(8) | psk_len(1) */
+#define FIO___TLS13_TICKET_STATE 24
+
+SFUNC void fio_tls13_ticket_keys_init(fio_tls13_ticket_keys_s *keys,
+                                      const void *secret,
+                                      size_t secret_len,
+                                      uint32_t rotation) {
+  uint8_t rnd[32];
+  if (!keys)
+    return;
+  if (!secret || !secret_len) {
+    fio_rand_bytes(rnd, sizeof(rnd));
+    secret = rnd;
+    secret_len = sizeof(rnd);
+  }
+  fio_hkdf_extract(keys->secret,
+                   "fio tls13 ticket keys",
+                   21,
+                   secret,
+                   secret_len,
+                   0);
+  keys->rotation = rotation ? rotation : FIO_TLS13_TICKET_ROTATION;
+  fio_secure_zero(rnd, sizeof(rnd));
+}
+
+/* Internal: derive the ticket key for an epoch */
+FIO_SFUNC void fio___tls13_ticket_key(uint8_t key[32],
+                                      const fio_tls13_ticket_keys_s *keys,
+                                      uint32_t epoch) {
+  uint8_t info[20] = {'f', 'i', 'o', ' ', 't', 'l', 's', '1', '3', ' ',
+                      't', 'i', 'c', 'k', 'e', 't'};
+  fio_u2buf32_be(info + 16, epoch);
+  fio_hkdf_expand(key, 32, keys->secret, 32, info, sizeof(info), 0);
+}
+
+/* Internal: seal session state into a ticket, returns the ticket length */
+FIO_SFUNC size_t fio___tls13_ticket_seal(uint8_t *out,
+                                         const fio_tls13_ticket_keys_s *keys,
+                                         uint16_t cipher_suite,
+                                         uint32_t age_add,
+                                         uint64_t sni_hash,
+                                         const uint8_t *psk,
+                                         size_t psk_len) {
+  uint8_t key[32];
+  uint64_t now = (uint64_t)fio_time_real().tv_sec;
+  uint32_t epoch = (uint32_t)(now / keys->rotation);
+  uint8_t *p = out + FIO___TLS13_TICKET_HEAD;
+  fio_u2buf32_be(out, epoch);
+  fio_rand_bytes(out + 4, 12);
+  p[0] = 1; /* version */
+  fio___tls13_write_u16(p + 1, cipher_suite);
+  fio_u2buf64_be(p + 3, now);
+  fio_u2buf32_be(p + 11, age_add);
+  fio_u2buf64_be(p + 15, sni_hash);
+  p[23] = (uint8_t)psk_len;
+  FIO_MEMCPY(p + FIO___TLS13_TICKET_STATE, psk, psk_len);
+  size_t len = FIO___TLS13_TICKET_STATE + psk_len;
+  fio___tls13_ticket_key(key, keys, epoch);
+  fio_chacha20_poly1305_enc(p + len,
+                            p,
+                            len,
+                            out,
+                            FIO___TLS13_TICKET_HEAD,
+                            key,
+                            out + 4);
+  fio_secure_zero(key, sizeof(key));
+  return FIO___TLS13_TICKET_HEAD + len + 16;
+}
+
+/* Internal: open a sealed ticket (in a copy), returns 0 on success */
+FIO_SFUNC int fio___tls13_ticket_open(const fio_tls13_ticket_keys_s *keys,
+                                      const uint8_t *ticket,
+                                      size_t len,
+                                      uint16_t *cipher_suite,
+                                      uint64_t *sni_hash,
+                                      uint8_t *psk,
+                                      size_t *psk_len) {
+  uint8_t buf[FIO___TLS13_TICKET_STATE + 48 + 16];
+  uint8_t key[32];
+  uint64_t now = (uint64_t)fio_time_real().tv_sec;
+  uint32_t epoch;
+  size_t state_len;
+  if (len < FIO___TLS13_TICKET_HEAD + FIO___TLS13_TICKET_STATE + 32 + 16 ||
+      len > FIO___TLS13_TICKET_HEAD + sizeof(buf))
+    return -1;
+  epoch = fio_buf2u32_be(ticket);
+  if (epoch != (uint32_t)(now / keys->rotation) &&
+      epoch + 1 != (uint32_t)(now / keys->rotation))
+    return -1;
+  state_len = len - FIO___TLS13_TICKET_HEAD - 16;
+  FIO_MEMCPY(buf, ticket + FIO___TLS13_TICKET_HEAD, state_len + 16);
+  fio___tls13_ticket_key(key, keys, epoch);
+  int r = fio_chacha20_poly1305_dec(buf + state_len,
+                                    buf,
+                                    state_len,
+                                    ticket,
+                                    FIO___TLS13_TICKET_HEAD,
+                                    key,
+                                    ticket + 4);
+  fio_secure_zero(key, sizeof(key));
+  if (r || buf[0] != 1 ||
+      (size_t)buf[23] + FIO___TLS13_TICKET_STATE != state_len ||
+      (buf[23] != 32 && buf[23] != 48) ||
+      now - fio_buf2u64_be(buf + 3) > keys->rotation)
+    goto invalid;
+  *cipher_suite = fio___tls13_read_u16(buf + 1);
+  *sni_hash = fio_buf2u64_be(buf + 15);
+  *psk_len = buf[23];
+  FIO_MEMCPY(psk, buf + FIO___TLS13_TICKET_STATE, buf[23]);
+  fio_secure_zero(buf, sizeof(buf));
+  return 0;
+invalid:
+  fio_secure_zero(buf, sizeof(buf));
+  return -1;
+}
+
 /* *****************************************************************************
 TLS 1.3 Client State Machine
 ***************************************************************************** */
@@ -3140,6 +3414,15 @@ typedef struct {
     uint8_t context[255];        /* Context from CertificateRequest */
   } auth;
 
+  /* Session resumption (RFC 8446 Section 4.6.1) */
+  struct {
+    fio_tls13_ticket_s offer;    /* Ticket offered in the ClientHello */
+    fio_tls13_ticket_s received; /* Latest NewSessionTicket (if any) */
+    uint8_t secret[48];          /* resumption_master_secret */
+    uint8_t offered;             /* 1 if the ClientHello offered a PSK */
+    uint8_t resumed;             /* 1 if the server accepted the PSK */
+  } resume;
+
   /* Internal flags */
   uint8_t encrypted_read;     /* 1 if reading encrypted records */
   uint8_t encrypted_write;    /* 1 if writing encrypted records */
@@ -3432,6 +3715,37 @@ FIO_IFUNC int fio_tls13_client_cert_requested(fio_tls13_client_s *client) {
   return client ? client->auth.requested : 0;
 }
 
+/**
+ * Sets a session ticket (from a previous connection to the same server) to be
+ * offered for resumption. Must be called before `fio_tls13_client_start`.
+ *
+ * Expired tickets are ignored. Tickets from a connection that didn't verify
+ * the server's certificate are only offered if verification is skipped.
+ */
+FIO_IFUNC void fio_tls13_client_ticket_set(fio_tls13_client_s *client,
+                                           const fio_tls13_ticket_s *ticket) {
+  if (!client || !ticket)
+    return;
+  client->resume.offer = *ticket;
+}
+
+/**
+ * Returns the latest session ticket received from the server, or NULL.
+ *
+ * The ticket should be copied and cached (per server) by the caller.
+ */
+FIO_IFUNC const fio_tls13_ticket_s *fio_tls13_client_ticket_get(
+    fio_tls13_client_s *client) {
+  if (!client || !client->resume.received.len)
+    return NULL;
+  return &client->resume.received;
+}
+
+/** Returns 1 if the handshake resumed a previous session (PSK accepted). */
+FIO_IFUNC int fio_tls13_client_is_resumed(fio_tls13_client_s *client) {
+  return client ? client->resume.resumed : 0;
+}
+
 /* *****************************************************************************
 TLS 1.3 Client Implementation
 ***************************************************************************** */
@@ -3583,8 +3897,14 @@ FIO_SFUNC int fio___tls13_derive_handshake_keys(fio_tls13_client_s *client) {
   uint8_t transcript_hash[48];
   fio___tls13_transcript_hash(client, transcript_hash);
 
-  /* Derive early secret (no PSK) */
-  fio_tls13_derive_early_secret(client->early_secret, NULL, 0, use_sha384);
+  /* Derive early secret (PSK when resuming) */
+  if (client->resume.resumed)
+    fio_tls13_derive_early_secret(client->early_secret,
+                                  client->resume.offer.psk,
+                                  client->resume.offer.psk_len,
+                                  use_sha384);
+  else
+    fio_tls13_derive_early_secret(client->early_secret, NULL, 0, use_sha384);
 
   /* Derive handshake secret
    * Note: shared_secret_len is 32 for X25519/P-256, 64 for X25519MLKEM768 */
@@ -4059,6 +4379,9 @@ FIO_SFUNC int fio___tls13_handle_hello_retry_request(
     return -1;
   }
 
+  /* ClientHello2 doesn't offer the PSK (see fio___tls13_build_client_hello2) */
+  client->resume.offered = 0;
+
   /* Validate cipher suite (same logic as normal ServerHello) */
   client->cipher_suite = sh->cipher_suite;
   switch (sh->cipher_suite) {
@@ -4240,6 +4563,18 @@ FIO_SFUNC int fio___tls13_process_server_hello(fio_tls13_client_s *client,
     return -1;
   }
 
+  /* PSK acceptance - the ticket's hash must match the selected suite */
+  if (sh.has_psk) {
+    if (!client->resume.offered || sh.psk_identity != 0 ||
+        (client->resume.offer.psk_len == 48) != (client->use_sha384 != 0)) {
+      fio___tls13_set_error(client,
+                            FIO_TLS13_ALERT_LEVEL_FATAL,
+                            FIO_TLS13_ALERT_ILLEGAL_PARAMETER);
+      return -1;
+    }
+    client->resume.resumed = 1;
+  }
+
   /* Validate key share - support X25519MLKEM768, X25519, and P-256 */
   if (sh.key_share_group == FIO_TLS13_GROUP_X25519MLKEM768 &&
       sh.key_share_len == 1120) {
@@ -4912,6 +5247,13 @@ FIO_SFUNC int fio___tls13_process_handshake_message(fio_tls13_client_s *client,
     fio___tls13_transcript_update(client, msg, 4 + body_len);
     if (fio___tls13_process_encrypted_extensions(client, body, body_len) != 0)
       return -1;
+    if (client->resume.resumed) {
+      /* PSK authenticates the server, inherit the original verification */
+      client->cert_verified = client->resume.offer.verified;
+      client->chain_verified = client->resume.offer.verified;
+      client->state = FIO_TLS13_STATE_WAIT_FINISHED;
+      break;
+    }
     client->state = FIO_TLS13_STATE_WAIT_CERT_CR;
     break;
 
@@ -5051,6 +5393,20 @@ FIO_SFUNC int fio___tls13_process_handshake_message(fio_tls13_client_s *client,
                                     (size_t)finished_len);
       hs_msgs_len += (size_t)finished_len;
 
+      /* resumption_master_secret (for NewSessionTicket PSKs) */
+      {
+        uint8_t transcript_hash[48];
+        fio___tls13_transcript_hash(client, transcript_hash);
+        fio_tls13_derive_secret(client->resume.secret,
+                                client->master_secret,
+                                fio___tls13_hash_len(client),
+                                "res master",
+                                10,
+                                transcript_hash,
+                                fio___tls13_hash_len(client),
+                                client->use_sha384);
+      }
+
       /* Encrypt all handshake messages together */
       int enc_len = fio_tls13_record_encrypt(out,
                                              out_capacity,
@@ -5093,7 +5449,8 @@ TLS 1.3 Client HelloRetryRequest - ClientHello2 Building
  * - Use the same random value as the original ClientHello
  * - Replace key_share with a single KeyShareEntry for the server-selected group
  * - Include cookie extension if provided in HRR
- * - Update pre_shared_key if present (we don't use PSK)
+ * - Omit pre_shared_key (the HRR transcript would require a new binder, the
+ *   session simply falls back to a full handshake)
  *
  * Returns: Total record length on success, -1 on error
  */
@@ -5306,6 +5663,7 @@ SFUNC void fio_tls13_client_destroy(fio_tls13_client_s *client) {
   fio_secure_zero(client->server_handshake_traffic_secret, 48);
   fio_secure_zero(client->client_app_traffic_secret, 48);
   fio_secure_zero(client->server_app_traffic_secret, 48);
+  fio_secure_zero(&client->resume, sizeof(client->resume));
 
   fio_tls13_record_keys_clear(&client->client_handshake_keys);
   fio_tls13_record_keys_clear(&client->server_handshake_keys);
@@ -5421,8 +5779,8 @@ SFUNC int fio_tls13_client_start(fio_tls13_client_s *client,
       client->alpn.offered_len > 0 ? client->alpn.offered : NULL;
 
   /* Build handshake message: need space for hybrid key share (1216 bytes)
-   * Max size: ~1600 bytes with all extensions */
-  uint8_t ch_msg[2048];
+   * and a session ticket. Max size: ~2200 bytes with all extensions */
+  uint8_t ch_msg[3072];
   uint8_t *p = ch_msg + 4; /* Skip handshake header */
   uint8_t *start = p;
 
@@ -5480,6 +5838,36 @@ SFUNC int fio_tls13_client_start(fio_tls13_client_s *client,
     p += fio___tls13_write_ext_key_share(p, client->x25519_public_key);
   }
 
+  /* Session resumption (psk_dhe_ke only), pre_shared_key MUST be last */
+  fio_tls13_ticket_s *ticket = &client->resume.offer;
+  uint8_t *binders = NULL;
+  if (fio_tls13_ticket_is_valid(ticket) &&
+      (ticket->verified || client->skip_cert_verify)) {
+    size_t binder_len = ticket->psk_len;
+    uint32_t age = (uint32_t)((uint64_t)fio_time_milli() - ticket->received);
+    /* psk_key_exchange_modes: psk_dhe_ke (1) */
+    fio___tls13_write_u16(p, FIO_TLS13_EXT_PSK_KEY_EXCHANGE_MODES);
+    fio___tls13_write_u16(p + 2, 2);
+    p[4] = 1;
+    p[5] = 1;
+    p += 6;
+    /* pre_shared_key: identities (ticket, obfuscated age) and binders */
+    fio___tls13_write_u16(p, FIO_TLS13_EXT_PRE_SHARED_KEY);
+    fio___tls13_write_u16(p + 2, (uint16_t)(2 + 2 + ticket->len + 4 + 2 + 1 +
+                                            binder_len));
+    fio___tls13_write_u16(p + 4, (uint16_t)(2 + ticket->len + 4));
+    fio___tls13_write_u16(p + 6, ticket->len);
+    p += 8;
+    FIO_MEMCPY(p, ticket->ticket, ticket->len);
+    p += ticket->len;
+    fio_u2buf32_be(p, age + ticket->age_add);
+    p += 4;
+    binders = p;
+    fio___tls13_write_u16(p, (uint16_t)(1 + binder_len));
+    p[2] = (uint8_t)binder_len;
+    p += 3 + binder_len;
+  }
+
   /* Write extensions length */
   fio___tls13_write_u16(ext_len_ptr, (uint16_t)(p - ext_start));
 
@@ -5489,6 +5877,25 @@ SFUNC int fio_tls13_client_start(fio_tls13_client_s *client,
 
   int ch_len = (int)(4 + body_len);
 
+  /* PSK binder over the ClientHello, truncated before the binders list */
+  if (binders) {
+    uint8_t ch_hash[48];
+    int sha384 = (ticket->psk_len == 48);
+    if (sha384) {
+      fio_u512 h = fio_sha384(ch_msg, (size_t)(binders - ch_msg));
+      FIO_MEMCPY(ch_hash, h.u8, 48);
+    } else {
+      fio_u256 h = fio_sha256(ch_msg, (size_t)(binders - ch_msg));
+      fio_memcpy32(ch_hash, h.u8);
+    }
+    fio_tls13_compute_binder(binders + 3,
+                             ticket->psk,
+                             ticket->psk_len,
+                             ch_hash,
+                             sha384);
+    client->resume.offered = 1;
+  }
+
   /* Update transcript with ClientHello (handshake message only) */
   fio___tls13_transcript_update(client, ch_msg, (size_t)ch_len);
 
@@ -5654,6 +6061,54 @@ SFUNC int fio_tls13_client_encrypt(fio_tls13_client_s *client,
                                   &client->client_app_keys);
 }
 
+/* Internal: Process a NewSessionTicket (body only), stores the ticket */
+FIO_SFUNC int fio___tls13_process_new_session_ticket(fio_tls13_client_s *client,
+                                                     const uint8_t *data,
+                                                     size_t len) {
+  fio_tls13_ticket_s *t = &client->resume.received;
+  const uint8_t *end = data + len;
+  /* lifetime(4) | age_add(4) | nonce<0..255> | ticket<1..2^16-1> | exts */
+  if (len < 9 || (size_t)(9 + data[8]) + 2 > len)
+    goto malformed;
+  uint32_t lifetime = fio_buf2u32_be(data);
+  uint32_t age_add = fio_buf2u32_be(data + 4);
+  const uint8_t *nonce = data + 9;
+  size_t nonce_len = data[8];
+  const uint8_t *p = nonce + nonce_len;
+  size_t ticket_len = fio___tls13_read_u16(p);
+  p += 2;
+  if (!ticket_len || p + ticket_len + 2 > end)
+    goto malformed;
+  const uint8_t *ticket = p;
+  p += ticket_len;
+  if (p + 2 + fio___tls13_read_u16(p) != end)
+    goto malformed;
+  /* lifetime of 0 means "don't use", 7 days is the maximum */
+  if (!lifetime || lifetime > 604800 || ticket_len > FIO_TLS13_TICKET_MAX_LEN) {
+    FIO_LOG_DEBUG2("TLS 1.3 Client: NewSessionTicket ignored");
+    return 0;
+  }
+  t->received = (uint64_t)fio_time_milli();
+  t->lifetime = lifetime;
+  t->age_add = age_add;
+  t->cipher_suite = client->cipher_suite;
+  t->len = (uint16_t)ticket_len;
+  t->psk_len = (uint8_t)fio___tls13_hash_len(client);
+  t->verified = !client->skip_cert_verify;
+  fio_tls13_derive_resumption_psk(t->psk,
+                                  client->resume.secret,
+                                  nonce,
+                                  nonce_len,
+                                  client->use_sha384);
+  FIO_MEMCPY(t->ticket, ticket, ticket_len);
+  FIO_LOG_DEBUG2("TLS 1.3 Client: NewSessionTicket stored (lifetime %us)",
+                 (unsigned)lifetime);
+  return 0;
+malformed:
+  FIO_LOG_DEBUG2("TLS 1.3 Client: malformed NewSessionTicket");
+  return -1;
+}
+
 SFUNC int fio_tls13_client_decrypt(fio_tls13_client_s *client,
                                    uint8_t *out,
                                    size_t out_capacity,
@@ -5706,8 +6161,12 @@ SFUNC int fio_tls13_client_decrypt(fio_tls13_client_s *client,
         /* Return 0 to indicate "no app data, try next record" */
         return 0;
       } else if (msg_type == FIO_TLS13_HS_NEW_SESSION_TICKET) {
-        /* NewSessionTicket - ignore for now */
-        FIO_LOG_DEBUG2("TLS 1.3 Client: Received NewSessionTicket (ignored)");
+        /* NewSessionTicket (RFC 8446 Section 4.6.1) */
+        if ((size_t)dec_len < 4 + (size_t)body_len ||
+            fio___tls13_process_new_session_ticket(client,
+                                                   out + 4,
+                                                   body_len) != 0)
+          return -1;
         return 0;
       }
     }
@@ -5783,6 +6242,10 @@ typedef struct {
   uint8_t random[32];               /* Client random */
   uint8_t legacy_session_id[32];    /* Legacy session ID (for middlebox) */
   uint8_t key_shares[2560]; /* Key share data (1216*2 + margin for hybrid) */
+  fio_ubuf_info_s psk_identity; /* First PSK identity (ticket, view) */
+  fio_ubuf_info_s psk_binder;   /* First PSK binder (view) */
+  const uint8_t *psk_binders;   /* Start of the binders list (view) */
+  uint8_t psk_dhe_ke;           /* 1 if psk_dhe_ke mode was offered */
 } fio___tls13_client_hello_s;
 
 /** TLS 1.3 Server Context */
@@ -5865,6 +6328,16 @@ typedef struct {
     uint8_t context[32];            /* Random context for CertRequest */
   } peer_auth;
 
+  /* Session resumption (RFC 8446 Section 4.6.1) */
+  struct {
+    const fio_tls13_ticket_keys_s *keys; /* Ticket keys (NULL: disabled) */
+    uint8_t psk[48];                     /* PSK of the resumed session */
+    uint8_t secret[48];                  /* resumption_master_secret */
+    uint8_t psk_len;                     /* PSK length (if resumed) */
+    uint8_t tickets;                     /* Tickets sent (ticket nonce) */
+    uint8_t resumed;                     /* 1 if the client's PSK accepted */
+  } resume;
+
   /* Internal flags */
   uint8_t encrypted_read;     /* 1 if reading encrypted records */
   uint8_t encrypted_write;    /* 1 if writing encrypted records */
@@ -6121,6 +6594,37 @@ FIO_IFUNC fio_ubuf_info_s fio_tls13_server_get_client_cert(
   return server->peer_auth.chain.certs[0];
 }
 
+/**
+ * Enables session tickets (resumption) using the ticket key set.
+ *
+ * The key set isn't copied and must outlive the server context. Must be
+ * called before the ClientHello is processed.
+ */
+FIO_IFUNC void fio_tls13_server_ticket_keys_set(
+    fio_tls13_server_s *server,
+    const fio_tls13_ticket_keys_s *keys) {
+  if (!server)
+    return;
+  server->resume.keys = keys;
+}
+
+/** Returns 1 if the handshake resumed a previous session (PSK accepted). */
+FIO_IFUNC int fio_tls13_server_is_resumed(fio_tls13_server_s *server) {
+  return server ? server->resume.resumed : 0;
+}
+
+/**
+ * Writes an encrypted NewSessionTicket record to `out`.
+ *
+ * `fio_tls13_server_process` already sends a ticket once the handshake
+ * completes (when ticket keys are set), this may be used to send more.
+ *
+ * Returns the number of bytes written, or -1 on error.
+ */
+SFUNC int fio_tls13_server_send_ticket(fio_tls13_server_s *server,
+                                       uint8_t *out,
+                                       size_t out_capacity);
+
 /* *****************************************************************************
 TLS 1.3 Server Implementation - Internal Helpers
 ***************************************************************************** */
@@ -6329,6 +6833,40 @@ FIO_SFUNC int fio___tls13_parse_ch_extensions(fio___tls13_client_hello_s *ch,
       break;
     }
 
+    case FIO_TLS13_EXT_PSK_KEY_EXCHANGE_MODES: {
+      if (ext_len < 1 || (size_t)ext_data[0] + 1 > ext_len)
+        break;
+      for (size_t i = 0; i < ext_data[0]; ++i)
+        ch->psk_dhe_ke |= (ext_data[1 + i] == 1);
+      break;
+    }
+
+    case FIO_TLS13_EXT_PRE_SHARED_KEY: {
+      /* MUST be the last extension (RFC 8446 Section 4.2.11) */
+      if (p != end)
+        return -1;
+      /* identities<7..2^16-1>, binders<33..2^16-1> - keep the first ones */
+      if (ext_len < 2)
+        return -1;
+      size_t ids_len = fio___tls13_read_u16(ext_data);
+      if (ids_len < 7 || 2 + ids_len + 2 > ext_len)
+        return -1;
+      size_t id_len = fio___tls13_read_u16(ext_data + 2);
+      if (!id_len || 2 + id_len + 4 > ids_len)
+        return -1;
+      const uint8_t *binders = ext_data + 2 + ids_len;
+      size_t binders_len = fio___tls13_read_u16(binders);
+      if (2 + ids_len + 2 + binders_len != ext_len || binders_len < 33 ||
+          (size_t)binders[2] + 1 > binders_len)
+        return -1;
+      ch->psk_identity.buf = (unsigned char *)ext_data + 4;
+      ch->psk_identity.len = id_len;
+      ch->psk_binder.buf = (unsigned char *)binders + 3;
+      ch->psk_binder.len = binders[2];
+      ch->psk_binders = binders;
+      break;
+    }
+
     default:
       /* Ignore unknown extensions */
       break;
@@ -6487,6 +7025,64 @@ FIO_SFUNC int fio___tls13_server_select_signature(
   return -1; /* Client doesn't support our signature algorithm */
 }
 
+/* Internal: Accept the client's ticket (PSK), returns -1 on binder failure */
+FIO_SFUNC int fio___tls13_server_accept_psk(
+    fio_tls13_server_s *server,
+    const fio___tls13_client_hello_s *ch,
+    const uint8_t *ch_msg) {
+  uint16_t suite = 0;
+  uint64_t sni_hash = 0;
+  size_t psk_len = 0;
+  uint8_t ch_hash[48];
+  uint8_t binder[48];
+  int offered = 0;
+  /* psk_ke (no ECDHE) and client certificates are never resumed */
+  if (!server->resume.keys || !ch->psk_identity.buf || !ch->psk_dhe_ke ||
+      server->peer_auth.require)
+    return 0;
+  if (fio___tls13_ticket_open(server->resume.keys,
+                              ch->psk_identity.buf,
+                              ch->psk_identity.len,
+                              &suite,
+                              &sni_hash,
+                              server->resume.psk,
+                              &psk_len))
+    return 0; /* unknown or expired ticket - full handshake */
+  if (sni_hash != fio_risky_hash(server->peer_sni, server->peer_sni_len, 0))
+    goto ignore;
+  for (size_t i = 0; i < ch->cipher_suite_count; ++i)
+    offered |= (ch->cipher_suites[i] == suite);
+  if (!offered || ch->psk_binder.len != psk_len)
+    goto ignore;
+  /* the binder proves possession of the PSK */
+  if (psk_len == 48) {
+    fio_u512 h = fio_sha384(ch_msg, (size_t)(ch->psk_binders - ch_msg));
+    FIO_MEMCPY(ch_hash, h.u8, 48);
+  } else {
+    fio_u256 h = fio_sha256(ch_msg, (size_t)(ch->psk_binders - ch_msg));
+    fio_memcpy32(ch_hash, h.u8);
+  }
+  fio_tls13_compute_binder(binder,
+                           server->resume.psk,
+                           psk_len,
+                           ch_hash,
+                           psk_len == 48);
+  if (!fio_ct_is_eq(binder, ch->psk_binder.buf, psk_len)) {
+    fio_secure_zero(binder, sizeof(binder));
+    fio_secure_zero(server->resume.psk, sizeof(server->resume.psk));
+    return -1;
+  }
+  fio_secure_zero(binder, sizeof(binder));
+  server->cipher_suite = suite;
+  server->use_sha384 = (psk_len == 48);
+  server->resume.psk_len = (uint8_t)psk_len;
+  server->resume.resumed = 1;
+  return 0;
+ignore:
+  fio_secure_zero(server->resume.psk, sizeof(server->resume.psk));
+  return 0;
+}
+
 /* *****************************************************************************
 TLS 1.3 Server Implementation - Message Building
 ***************************************************************************** */
@@ -6567,6 +7163,14 @@ FIO_SFUNC int fio___tls13_build_server_hello(fio_tls13_server_s *server,
     p += 32;
   }
 
+  /* pre_shared_key extension (selected identity, always the first) */
+  if (server->resume.resumed) {
+    fio___tls13_write_u16(p, FIO_TLS13_EXT_PRE_SHARED_KEY);
+    fio___tls13_write_u16(p + 2, 2);
+    fio___tls13_write_u16(p + 4, 0);
+    p += 6;
+  }
+
   /* Write extensions length */
   fio___tls13_write_u16(ext_len_ptr, (uint16_t)(p - ext_start));
 
@@ -6936,8 +7540,14 @@ FIO_SFUNC int fio___tls13_server_derive_handshake_keys(
   uint8_t transcript_hash[48];
   fio___tls13_server_transcript_hash(server, transcript_hash);
 
-  /* Derive early secret (no PSK) */
-  fio_tls13_derive_early_secret(server->early_secret, NULL, 0, use_sha384);
+  /* Derive early secret (PSK when resuming) */
+  if (server->resume.resumed)
+    fio_tls13_derive_early_secret(server->early_secret,
+                                  server->resume.psk,
+                                  server->resume.psk_len,
+                                  use_sha384);
+  else
+    fio_tls13_derive_early_secret(server->early_secret, NULL, 0, use_sha384);
 
   /* Derive handshake secret
    * Note: shared_secret_len is 32 for X25519, 64 for X25519MLKEM768 */
@@ -7196,6 +7806,15 @@ FIO_SFUNC int fio___tls13_server_process_client_hello(
     return -1;
   }
 
+  /* Session resumption (may switch to the ticket's cipher suite) */
+  if (fio___tls13_server_accept_psk(server, &ch, ch_msg) != 0) {
+    FIO_LOG_DEBUG2("TLS 1.3 Server: PSK binder verification failed");
+    fio___tls13_server_set_error(server,
+                                 FIO_TLS13_ALERT_LEVEL_FATAL,
+                                 FIO_TLS13_ALERT_DECRYPT_ERROR);
+    return -1;
+  }
+
   /* Select key share */
   const uint8_t *client_key_share;
   size_t client_key_share_len;
@@ -7210,8 +7829,9 @@ FIO_SFUNC int fio___tls13_server_process_client_hello(
     return -1;
   }
 
-  /* Select signature algorithm */
-  if (fio___tls13_server_select_signature(server, &ch) != 0) {
+  /* Select signature algorithm (not needed when resuming) */
+  if (!server->resume.resumed &&
+      fio___tls13_server_select_signature(server, &ch) != 0) {
     FIO_LOG_DEBUG2("TLS 1.3 Server: sig algorithm mismatch (key=0x%04x)",
                    server->credentials.signature_algo);
     fio___tls13_server_set_error(server,
@@ -7308,29 +7928,50 @@ FIO_SFUNC int fio___tls13_server_process_client_hello(
                                        (size_t)ee_len);
   hs_msgs_len += (size_t)ee_len;
 
-  /* CertificateRequest (if client auth is required/optional) */
-  if (server->peer_auth.require > 0) {
-    /* Generate random context for CertificateRequest */
-    fio_rand_bytes(server->peer_auth.context, 32);
-    server->peer_auth.context_len = 32;
-
-    /* Signature algorithms we accept from clients */
-    uint16_t signature_algos[] = {FIO_TLS13_SIGNATURE_ED25519,
-                           FIO_TLS13_SIGNATURE_ECDSA_SECP256R1_SHA256,
-                           FIO_TLS13_SIGNATURE_RSA_PSS_RSAE_SHA256,
-                           FIO_TLS13_SIGNATURE_RSA_PKCS1_SHA256};
-    size_t signature_algo_count = sizeof(signature_algos) / sizeof(signature_algos[0]);
-
-    int cr_len =
-        fio_tls13_build_certificate_request(hs_msgs + hs_msgs_len,
-                                            sizeof(hs_msgs) - hs_msgs_len,
-                                            FIO_UBUF_INFO2(
-                                                server->peer_auth.context,
-                                                server->peer_auth.context_len),
-                                            signature_algos,
-                                            signature_algo_count);
-    if (cr_len < 0) {
-      FIO_LOG_DEBUG2("TLS 1.3 Server: CertificateRequest build failed");
+  /* The PSK authenticates the server (no certificates when resuming) */
+  if (!server->resume.resumed) {
+    /* CertificateRequest (if client auth is required/optional) */
+    if (server->peer_auth.require > 0) {
+      /* Generate random context for CertificateRequest */
+      fio_rand_bytes(server->peer_auth.context, 32);
+      server->peer_auth.context_len = 32;
+
+      /* Signature algorithms we accept from clients */
+      uint16_t signature_algos[] = {FIO_TLS13_SIGNATURE_ED25519,
+                                    FIO_TLS13_SIGNATURE_ECDSA_SECP256R1_SHA256,
+                                    FIO_TLS13_SIGNATURE_RSA_PSS_RSAE_SHA256,
+                                    FIO_TLS13_SIGNATURE_RSA_PKCS1_SHA256};
+      size_t signature_algo_count =
+          sizeof(signature_algos) / sizeof(signature_algos[0]);
+
+      int cr_len = fio_tls13_build_certificate_request(
+          hs_msgs + hs_msgs_len,
+          sizeof(hs_msgs) - hs_msgs_len,
+          FIO_UBUF_INFO2(server->peer_auth.context,
+                         server->peer_auth.context_len),
+          signature_algos,
+          signature_algo_count);
+      if (cr_len < 0) {
+        FIO_LOG_DEBUG2("TLS 1.3 Server: CertificateRequest build failed");
+        fio___tls13_server_set_error(server,
+                                     FIO_TLS13_ALERT_LEVEL_FATAL,
+                                     FIO_TLS13_ALERT_INTERNAL_ERROR);
+        return -1;
+      }
+      fio___tls13_server_transcript_update(server,
+                                           hs_msgs + hs_msgs_len,
+                                           (size_t)cr_len);
+      hs_msgs_len += (size_t)cr_len;
+      FIO_LOG_DEBUG2("TLS 1.3 Server: CertificateRequest sent (mode=%d)",
+                     server->peer_auth.require);
+    }
+
+    /* Certificate */
+    int cert_len = fio___tls13_build_certificate(server,
+                                                 hs_msgs + hs_msgs_len,
+                                                 sizeof(hs_msgs) - hs_msgs_len);
+    if (cert_len < 0) {
+      FIO_LOG_DEBUG2("TLS 1.3 Server: Certificate build failed");
       fio___tls13_server_set_error(server,
                                    FIO_TLS13_ALERT_LEVEL_FATAL,
                                    FIO_TLS13_ALERT_INTERNAL_ERROR);
@@ -7338,44 +7979,26 @@ FIO_SFUNC int fio___tls13_server_process_client_hello(
     }
     fio___tls13_server_transcript_update(server,
                                          hs_msgs + hs_msgs_len,
-                                         (size_t)cr_len);
-    hs_msgs_len += (size_t)cr_len;
-    FIO_LOG_DEBUG2("TLS 1.3 Server: CertificateRequest sent (mode=%d)",
-                   server->peer_auth.require);
-  }
-
-  /* Certificate */
-  int cert_len = fio___tls13_build_certificate(server,
-                                               hs_msgs + hs_msgs_len,
-                                               sizeof(hs_msgs) - hs_msgs_len);
-  if (cert_len < 0) {
-    FIO_LOG_DEBUG2("TLS 1.3 Server: Certificate build failed");
-    fio___tls13_server_set_error(server,
-                                 FIO_TLS13_ALERT_LEVEL_FATAL,
-                                 FIO_TLS13_ALERT_INTERNAL_ERROR);
-    return -1;
-  }
-  fio___tls13_server_transcript_update(server,
-                                       hs_msgs + hs_msgs_len,
-                                       (size_t)cert_len);
-  hs_msgs_len += (size_t)cert_len;
+                                         (size_t)cert_len);
+    hs_msgs_len += (size_t)cert_len;
 
-  /* CertificateVerify */
-  int cv_len =
-      fio___tls13_build_certificate_verify(server,
-                                           hs_msgs + hs_msgs_len,
-                                           sizeof(hs_msgs) - hs_msgs_len);
-  if (cv_len < 0) {
-    FIO_LOG_DEBUG2("TLS 1.3 Server: CertificateVerify build failed");
-    fio___tls13_server_set_error(server,
-                                 FIO_TLS13_ALERT_LEVEL_FATAL,
-                                 FIO_TLS13_ALERT_INTERNAL_ERROR);
-    return -1;
+    /* CertificateVerify */
+    int cv_len =
+        fio___tls13_build_certificate_verify(server,
+                                             hs_msgs + hs_msgs_len,
+                                             sizeof(hs_msgs) - hs_msgs_len);
+    if (cv_len < 0) {
+      FIO_LOG_DEBUG2("TLS 1.3 Server: CertificateVerify build failed");
+      fio___tls13_server_set_error(server,
+                                   FIO_TLS13_ALERT_LEVEL_FATAL,
+                                   FIO_TLS13_ALERT_INTERNAL_ERROR);
+      return -1;
+    }
+    fio___tls13_server_transcript_update(server,
+                                         hs_msgs + hs_msgs_len,
+                                         (size_t)cv_len);
+    hs_msgs_len += (size_t)cv_len;
   }
-  fio___tls13_server_transcript_update(server,
-                                       hs_msgs + hs_msgs_len,
-                                       (size_t)cv_len);
-  hs_msgs_len += (size_t)cv_len;
 
   /* Server Finished */
   int fin_len =
@@ -7447,7 +8070,7 @@ FIO_SFUNC int fio___tls13_server_process_client_hello(
   server->encrypted_write = 1;
 
   /* If client auth is enabled, wait for Certificate first */
-  if (server->peer_auth.require > 0)
+  if (server->peer_auth.require > 0 && !server->resume.resumed)
     server->state = FIO_TLS13_SERVER_STATE_WAIT_CLIENT_CERT;
   else
     server->state = FIO_TLS13_SERVER_STATE_WAIT_FINISHED;
@@ -7907,6 +8530,20 @@ FIO_SFUNC int fio___tls13_server_process_client_finished(
   /* Update transcript with client Finished */
   fio___tls13_server_transcript_update(server, fin_msg, fin_msg_len);
 
+  /* resumption_master_secret (for NewSessionTicket PSKs) */
+  if (server->resume.keys) {
+    uint8_t transcript_hash[48];
+    fio___tls13_server_transcript_hash(server, transcript_hash);
+    fio_tls13_derive_secret(server->resume.secret,
+                            server->master_secret,
+                            fio___tls13_server_hash_len(server),
+                            "res master",
+                            10,
+                            transcript_hash,
+                            fio___tls13_server_hash_len(server),
+                            server->use_sha384);
+  }
+
   server->state = FIO_TLS13_SERVER_STATE_CONNECTED;
   return 0;
 }
@@ -7945,6 +8582,7 @@ SFUNC void fio_tls13_server_destroy(fio_tls13_server_s *server) {
   fio_secure_zero(server->server_handshake_traffic_secret, 48);
   fio_secure_zero(server->client_app_traffic_secret, 48);
   fio_secure_zero(server->server_app_traffic_secret, 48);
+  fio_secure_zero(&server->resume, sizeof(server->resume));
 
   fio_tls13_record_keys_clear(&server->client_handshake_keys);
   fio_tls13_record_keys_clear(&server->server_handshake_keys);
@@ -8167,6 +8805,14 @@ SFUNC int fio_tls13_server_process(fio_tls13_server_s *server,
           return -1;
         }
         FIO_LOG_DEBUG2("TLS 1.3 Server: handshake complete");
+        /* Issue a session ticket (a failure only prevents resumption) */
+        if (server->resume.keys && !server->peer_auth.require) {
+          int nst_len = fio_tls13_server_send_ticket(server,
+                                                     out + *out_len,
+                                                     out_capacity - *out_len);
+          if (nst_len > 0)
+            *out_len += (size_t)nst_len;
+        }
         break;
 
       default: break;
@@ -8187,6 +8833,58 @@ SFUNC int fio_tls13_server_process(fio_tls13_server_s *server,
   return (int)record_len;
 }
 
+SFUNC int fio_tls13_server_send_ticket(fio_tls13_server_s *server,
+                                       uint8_t *out,
+                                       size_t out_capacity) {
+  uint8_t msg[4 + 13 + FIO___TLS13_TICKET_HEAD + FIO___TLS13_TICKET_STATE +
+              48 + 16 + 2];
+  uint8_t psk[48];
+  if (!server || !out || !server->resume.keys ||
+      server->state != FIO_TLS13_SERVER_STATE_CONNECTED)
+    return -1;
+  const size_t hash_len = fio___tls13_server_hash_len(server);
+  uint32_t lifetime = server->resume.keys->rotation;
+  uint32_t age_add;
+  uint8_t nonce = server->resume.tickets++;
+  if (lifetime > 604800)
+    lifetime = 604800;
+  fio_rand_bytes(&age_add, sizeof(age_add));
+  fio_tls13_derive_resumption_psk(psk,
+                                  server->resume.secret,
+                                  &nonce,
+                                  1,
+                                  server->use_sha384);
+  /* lifetime(4) | age_add(4) | nonce<1> | ticket<2> | extensions<2> */
+  uint8_t *p = msg + 4;
+  fio_u2buf32_be(p, lifetime);
+  fio_u2buf32_be(p + 4, age_add);
+  p[8] = 1;
+  p[9] = nonce;
+  size_t ticket_len = fio___tls13_ticket_seal(
+      p + 12,
+      server->resume.keys,
+      server->cipher_suite,
+      age_add,
+      fio_risky_hash(server->peer_sni, server->peer_sni_len, 0),
+      psk,
+      hash_len);
+  fio_secure_zero(psk, sizeof(psk));
+  fio___tls13_write_u16(p + 10, (uint16_t)ticket_len);
+  p += 12 + ticket_len;
+  fio___tls13_write_u16(p, 0); /* no extensions (no early_data) */
+  p += 2;
+  size_t body_len = (size_t)(p - msg) - 4;
+  fio_tls13_write_handshake_header(msg,
+                                   FIO_TLS13_HS_NEW_SESSION_TICKET,
+                                   body_len);
+  return fio_tls13_record_encrypt(out,
+                                  out_capacity,
+                                  msg,
+                                  4 + body_len,
+                                  FIO_TLS13_CONTENT_HANDSHAKE,
+                                  &server->server_app_keys);
+}
+
 SFUNC int fio_tls13_server_encrypt(fio_tls13_server_s *server,
                                    uint8_t *out,
                                    size_t out_capacity,
@@ -30,6 +30,11 @@ developer.
 #define FIO_IO_BUFFER_PER_WRITE 65536U
 #endif
 
+#ifndef FIO_IO_WRITEV_MAX
+/** Maximum number of buffers gathered for a single vectored `writev` event. */
+#define FIO_IO_WRITEV_MAX 64U
+#endif
+
 #ifndef FIO_IO_THROTTLE_LIMIT
 /** IO will be throttled (no `on_data` events) if outgoing buffer is large. */
 #define FIO_IO_THROTTLE_LIMIT 2097152U
@@ -45,6 +50,11 @@ developer.
 #define FIO_IO_SHUTDOWN_TIMEOUT 15000
 #endif
 
+#ifndef FIO_IO_INBOX_POOL
+/** Pooled nodes for tasks deferred by non-IO threads (0 = heap only). */
+#define FIO_IO_INBOX_POOL 4096U
+#endif
+
 #ifndef FIO_IO_COUNT_STORAGE
 #ifdef DEBUG
 #define FIO_IO_COUNT_STORAGE 1
@@ -102,6 +112,23 @@ SFUNC size_t fio_io_shutdown_timeout(void);
 /** Sets the shutdown timeout for the reactor, returning the new value. */
 SFUNC size_t fio_io_shutdown_timeout_set(size_t milliseconds);
 
+/**
+ * Sets the number of IO reactors (threads) each process runs, returning the
+ * actual number. Negative values are per-core, same as `fio_io_workers`.
+ *
+ * Each reactor has its own poll set, timer queue and task queue. Additional
+ * reactors accept connections using their own `SO_REUSEPORT` socket (when
+ * possible), so call before `fio_io_listen` and `fio_io_start`.
+ *
+ * Protocol callbacks run on the thread of the reactor the IO belongs to.
+ * `fio_io_defer`, `fio_io_queue` and the process-wide modules (pub/sub, IPC,
+ * Redis) stay on the main reactor.
+ */
+SFUNC uint16_t fio_io_reactors_set(int reactors);
+
+/** Returns the number of IO reactors (threads) each process runs. */
+SFUNC uint16_t fio_io_reactors(void);
+
 /* *****************************************************************************
 The IO Reactor's State
 ***************************************************************************** */
@@ -124,7 +151,7 @@ SFUNC int fio_io_pid(void);
 /** Returns the root / master process id. */
 SFUNC int fio_io_root_pid(void);
 
-/** Returns the last millisecond when the IO reactor polled for events. */
+/** Returns the last millisecond when the (calling) reactor polled events. */
 SFUNC int64_t fio_io_last_tick(void);
 
 /** Returns a cached real-time (wall-clock) timestamp in milliseconds,
@@ -432,7 +459,8 @@ SFUNC void fio_io_write2(fio_io_s *io, fio_io_write_args_s args);
  * Once the file was sent, the `source_fd` will be closed using `close`.
  *
  * The file will be buffered to the socket chunk by chunk, so that memory
- * consumption is capped.
+ * consumption is capped. When the connection's `sendfile` IO function is
+ * available (plain-text connections on Linux) no user space copy is made.
  *
  * `offset` dictates the starting point for the data to be sent and length sets
  * the maximum amount of data to be sent.
@@ -486,6 +514,12 @@ SFUNC int fio_io_is_suspended(fio_io_s *io);
  * suspension or throttling checks. */
 SFUNC void fio_io_on_data_schedule(fio_io_s *io);
 
+/** Schedules a deferred attempt to flush the outgoing data (and `on_ready`).
+ *
+ * Used by transports that prepare output outside the IO callbacks (i.e., TLS
+ * records encrypted by worker threads). Call from the IO thread. */
+SFUNC void fio_io_on_ready_schedule(fio_io_s *io);
+
 /** Returns 1 if the IO handle is marked as open. */
 SFUNC int fio_io_is_open(fio_io_s *io);
 
@@ -504,8 +538,23 @@ SFUNC void fio_io_defer(void (*task)(void *, void *),
                         void *udata1,
                         void *udata2);
 
-/** Schedules a timer bound task, see `fio_timer_schedule`. */
-SFUNC void fio_io_run_every(fio_timer_schedule_args_s args);
+/**
+ * Schedules a task on the thread of the reactor handling `io` (the main
+ * reactor if `io` is `NULL`). This function is thread-safe.
+ */
+SFUNC void fio_io_defer_to(fio_io_s *io,
+                           void (*task)(void *, void *),
+                           void *udata1,
+                           void *udata2);
+
+/**
+ * Schedules a timer bound task, see `fio_timer_schedule`.
+ *
+ * The timer runs on the calling reactor's thread (the main one otherwise).
+ *
+ * Returns a timer handle the caller must release using `fio_timer_free`.
+ */
+SFUNC fio_timer_s *fio_io_run_every(fio_timer_schedule_args_s args);
 /**
  * Schedules a timer bound task, see `fio_timer_schedule`.
  *
@@ -574,6 +623,33 @@ struct fio_io_functions_s {
    * transformed data will be sent later by `flush`.
    */
   ssize_t (*write)(fio_socket_i fd, const void *buf, size_t len, void *context);
+  /**
+   * Called to perform a non-blocking vectored write, same as POSIX `writev(2)`.
+   *
+   * Optional - when `NULL`, the IO layer calls `write` once per buffer. Return
+   * values follow the `write` semantics (bytes consumed, possibly partial).
+   *
+   * Defaults to a `writev` system call only when the default `write` is used,
+   * so TLS implementations (custom `write`) never receive plaintext bypass.
+   */
+  ssize_t (*writev)(fio_socket_i fd,
+                    const fio_buf_info_s *vec,
+                    size_t count,
+                    void *context);
+  /**
+   * Called to send a file's byte range without copying it to user space (same
+   * as Linux `sendfile(2)`), for data added using a file descriptor.
+   *
+   * Optional - when `NULL`, or if it fails with an error other than
+   * `EWOULDBLOCK` / `EAGAIN` / `EINTR`, the file is read into a buffer and sent
+   * using `write`. Defaults to `fio_sock_sendfile` only when the default `write`
+   * is used.
+   */
+  ssize_t (*sendfile)(fio_socket_i fd,
+                      int file,
+                      size_t offset,
+                      size_t len,
+                      void *context);
   /**
    * Sends any unsent internal data. Returns `0` only if all data was sent.
    *
@@ -689,6 +765,8 @@ struct fio_io_protocol_s {
  * Performs a task for each IO in the stated protocol.
  *
  * Call ONLY from the main IO thread (consider using `fio_io_defer`).
+ *
+ * IO handled by additional reactors (see `fio_io_reactors_set`) is skipped.
  * */
 SFUNC size_t fio_io_protocol_each(fio_io_protocol_s *protocol,
                                   void (*task)(fio_io_s *, void *udata2),
@@ -954,8 +1032,13 @@ SFUNC void fio_io_async_attach(fio_io_async_s *q, uint32_t threads);
 /** Pushes a task to an IO Async Queue (macro helper). */
 #define fio_io_async(q_, ...) fio_queue_push((q_)->q, __VA_ARGS__)
 
-/** Schedules a timer bound task for the async queue (`fio_timer_schedule`). */
-SFUNC void fio_io_async_every(fio_io_async_s *q, fio_timer_schedule_args_s);
+/**
+ * Schedules a timer bound task for the async queue (`fio_timer_schedule`).
+ *
+ * Returns a timer handle the caller must release using `fio_timer_free`.
+ */
+SFUNC fio_timer_s *fio_io_async_every(fio_io_async_s *q,
+                                      fio_timer_schedule_args_s);
 
 /**
  * Schedules a timer bound task, for the async queue, see `fio_timer_schedule`.
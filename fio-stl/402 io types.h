@@ -131,12 +131,16 @@ static void fio___io_on_user_mock(fio_io_s *io, void *i_) {
 }
 static void fio___io_on_close_mock(void *p1, void *p2) { (void)p1, (void)p2; }
 
+/* Returns the poll set of the calling reactor thread. */
+FIO_IFUNC fio_poll_s *fio___io_poll_here(void);
+
 /* Called to perform a non-blocking `read`, same as the system call. */
 static ssize_t fio___io_func_default_read(fio_socket_i fd,
                                           void *buf,
                                           size_t len,
                                           void *tls) {
-  return fio_sock_read(fd, buf, len);
+  /* the poll engine may have received the data already (io_uring) */
+  return fio_poll_read(fio___io_poll_here(), fd, buf, len);
   (void)tls;
 }
 /** Called to perform a non-blocking `write`, same as the system call. */
@@ -144,13 +148,32 @@ static ssize_t fio___io_func_default_write(fio_socket_i fd,
                                            const void *buf,
                                            size_t len,
                                            void *tls) {
-  return fio_sock_write(fd, buf, len);
+  return fio_poll_write(fio___io_poll_here(), fd, buf, len);
+  (void)tls;
+}
+/** Called to perform a non-blocking `writev`, same as the system call. */
+static ssize_t fio___io_func_default_writev(fio_socket_i fd,
+                                            const fio_buf_info_s *vec,
+                                            size_t count,
+                                            void *tls) {
+  return fio_poll_writev(fio___io_poll_here(), fd, vec, count);
+  (void)tls;
+}
+/** Called to send a file's byte range without a user space copy. */
+static ssize_t fio___io_func_default_sendfile(fio_socket_i fd,
+                                              int file,
+                                              size_t offset,
+                                              size_t len,
+                                              void *tls) {
+  if (fio_poll_flush(fio___io_poll_here(), fd)) /* data sent by the engine */
+    return -1;
+  return fio_sock_sendfile(fd, file, offset, len);
   (void)tls;
 }
 /** Sends any unsent internal data. Returns 0 only if all data was sent. */
 static int fio___io_func_default_flush(fio_socket_i fd, void *tls) {
-  return 0;
-  (void)fd, (void)tls;
+  return fio_poll_flush(fio___io_poll_here(), fd);
+  (void)tls;
 }
 /** Sends any unsent internal data. Returns 0 only if all data was sent. */
 static void fio___io_func_default_finish(fio_socket_i fd, void *tls) {
@@ -217,6 +240,8 @@ FIO_SFUNC void fio___io_protocol_init(fio_io_protocol_s *pr, _Bool has_tls) {
       .start = fio_io_noop,
       .read = fio___io_func_default_read,
       .write = fio___io_func_default_write,
+      .writev = fio___io_func_default_writev,
+      .sendfile = fio___io_func_default_sendfile,
       .flush = fio___io_func_default_flush,
       .finish = fio___io_func_default_finish,
       .cleanup = fio___io_func_default_cleanup,
@@ -256,6 +281,11 @@ FIO_SFUNC void fio___io_protocol_init(fio_io_protocol_s *pr, _Bool has_tls) {
     pr->io_functions.read = io_fn.read;
   if (!pr->io_functions.write)
     pr->io_functions.write = io_fn.write;
+  /* a vectored write must never bypass a custom (i.e., TLS) `write` */
+  if (!pr->io_functions.writev && pr->io_functions.write == io_fn.write)
+    pr->io_functions.writev = io_fn.writev;
+  if (!pr->io_functions.sendfile && pr->io_functions.write == io_fn.write)
+    pr->io_functions.sendfile = io_fn.sendfile;
   if (!pr->io_functions.flush)
     pr->io_functions.flush = io_fn.flush;
   if (!pr->io_functions.finish)
@@ -278,8 +308,16 @@ static fio_io_protocol_s FIO___IO_MOCK_PROTOCOL;
 
 FIO_IFUNC void fio___io_protocol_init_test(fio_io_protocol_s *pr,
                                            _Bool has_tls) {
-  if (!fio_atomic_or(&pr->reserved.flags, 1))
+  if (FIO_LIKELY(fio_atomic_or(&pr->reserved.flags, 0) & 2))
+    return;
+  if (!fio_atomic_or(&pr->reserved.flags, 1)) {
     fio___io_protocol_init(pr, has_tls);
+    fio_atomic_or(&pr->reserved.flags, 2);
+    return;
+  }
+  /* another reactor thread is initializing the same protocol object */
+  while (!(fio_atomic_or(&pr->reserved.flags, 0) & 2))
+    FIO_THREAD_RESCHEDULE();
 }
 
 /* *****************************************************************************
@@ -297,11 +335,42 @@ typedef struct {
   volatile unsigned stop;
 } fio___io_pid_s;
 
+/* a task deferred by a non-IO thread, see `fio___io_inbox_push` */
+typedef struct fio___io_inbox_s {
+  struct fio___io_inbox_s *next;
+  void (*fn)(void *, void *);
+  void *udata1;
+  void *udata2;
+  /* the next free pool node (index + 1), see `fio___io_inbox_node_new` */
+  volatile uint32_t free_next;
+} fio___io_inbox_s;
+
+/* an additional IO reactor (thread), see `fio_io_reactors_set` */
+typedef struct fio___io_reactor_s {
+  fio_poll_s poll;
+  int64_t tick;
+  int64_t reviewed;
+  fio_queue_s queue;
+  fio_timer_queue_s timer;
+  /* lock-free MPSC inbox, see `fio_io_defer_to` */
+  fio___io_inbox_s *inbox;
+  uint32_t flags;
+  fio_socket_i wakeup_fd;
+  fio_io_s *wakeup;
+  /* every IO attached to the reactor (timeouts are reviewed by a full scan) */
+  FIO_LIST_NODE ios;
+  fio_thread_t thread;
+  /* the `on_ready` write buffer of the reactor's thread */
+  char *buf;
+} fio___io_reactor_s;
+
 static struct FIO___IO_S {
   fio_poll_s poll;
   int64_t tick;
   int64_t time_ms;
   fio_queue_s queue;
+  /* lock-free MPSC inbox (LIFO stack), drained by the reactor every tick */
+  fio___io_inbox_s *inbox;
   uint32_t flags;
   uint16_t workers;
   uint8_t is_worker;
@@ -323,6 +392,11 @@ static struct FIO___IO_S {
    * to perform the main IO queue (DEBUG tripwire, FIO___IO_ASSERT_IO_THREAD).
    */
   uintptr_t io_thread;
+  /* the additional reactors running alongside the main reactor */
+  fio___io_reactor_s **reactors;
+  uint16_t reactors_running;
+  /* the number of reactors per process (including the main reactor) */
+  uint16_t reactors_count;
 } FIO___IO = {
     .tick = 0,
     .wakeup_fd = FIO_SOCKET_INVALID,
@@ -330,8 +404,17 @@ static struct FIO___IO_S {
     .lock = FIO___LOCK_INIT,
     .shutdown_timeout = FIO_IO_SHUTDOWN_TIMEOUT,
     .io_thread = 0,
+    .reactors_count = 1,
 };
 
+/* set on the threads running an additional reactor (NULL for the main one) */
+static __thread fio___io_reactor_s *fio___io_reactor;
+
+/* Returns the poll set of the calling reactor thread. */
+FIO_IFUNC fio_poll_s *fio___io_poll_here(void) {
+  return fio___io_reactor ? &fio___io_reactor->poll : &FIO___IO.poll;
+}
+
 #if defined(DEBUG)
 /* The IO layer is single-threaded per process: exactly one reactor thread
  * performs the main queue (`FIO___IO.queue`) - polling, deferred tasks and
@@ -360,20 +443,246 @@ FIO_IFUNC void fio___io_defer_no_wakeup(void (*task)(void *, void *),
 }
 
 FIO_SFUNC void fio___io_wakeup(void);
+
+/* set on the thread running the reactor (`fio___io_work`) */
+static __thread uint8_t fio___io_is_reactor_thread;
+
+FIO_LEAK_COUNTER_DEF(fio___io_inbox_s)
+
+/* Inbox nodes come from a pool, allocated on first use (and kept for the
+ * process's lifetime). Unused nodes are handed out in order, recycled nodes
+ * are kept in a lock-free free list whose head is tagged against ABA:
+ * `(tag << 32) | (index + 1)`. The heap is used when the pool is exhausted or
+ * disabled (`FIO_IO_INBOX_POOL == 0`). */
+#if FIO_IO_INBOX_POOL
+static fio___io_inbox_s *volatile fio___io_inbox_pool;
+static volatile uint64_t fio___io_inbox_free;
+static volatile uint32_t fio___io_inbox_fresh;
+
+FIO_IFUNC int fio___io_inbox_is_pooled(fio___io_inbox_s *t) {
+  fio___io_inbox_s *pool;
+  fio_atomic_load(pool, &fio___io_inbox_pool);
+  return ((uintptr_t)t - (uintptr_t)pool) <
+         (sizeof(*pool) * FIO_IO_INBOX_POOL);
+}
+
+/* returns the pool, allocating it if missing (NULL if out of memory). */
+FIO_SFUNC fio___io_inbox_s *fio___io_inbox_pool_get(void) {
+  fio___io_inbox_s *pool, *expected = NULL;
+  fio_atomic_load(pool, &fio___io_inbox_pool);
+  if (pool)
+    return pool;
+  pool = (fio___io_inbox_s *)
+      FIO_MEM_REALLOC_(NULL, 0, sizeof(*pool) * FIO_IO_INBOX_POOL, 0);
+  if (!pool ||
+      fio_atomic_compare_exchange_p(&fio___io_inbox_pool, &expected, &pool))
+    return pool;
+  FIO_MEM_FREE_(pool, sizeof(*pool) * FIO_IO_INBOX_POOL); /* lost the race */
+  return expected;
+}
+
+FIO_SFUNC fio___io_inbox_s *fio___io_inbox_node_new(void) {
+  fio___io_inbox_s *t, *pool;
+  uint64_t head, next;
+  uint32_t i;
+  fio_atomic_load(head, &fio___io_inbox_free);
+  while ((uint32_t)head) {
+    fio_atomic_load(pool, &fio___io_inbox_pool);
+    t = pool + ((uint32_t)head - 1);
+    fio_atomic_load(i, &t->free_next);
+    next = ((((head >> 32) + 1) << 32) | i);
+    if (fio_atomic_compare_exchange_p(&fio___io_inbox_free, &head, &next))
+      return t;
+  }
+  fio_atomic_load(i, &fio___io_inbox_fresh);
+  if (i < FIO_IO_INBOX_POOL && (pool = fio___io_inbox_pool_get()) &&
+      (i = fio_atomic_add(&fio___io_inbox_fresh, 1)) < FIO_IO_INBOX_POOL)
+    return pool + i;
+  t = (fio___io_inbox_s *)FIO_MEM_REALLOC_(NULL, 0, sizeof(*t), 0);
+  if (t)
+    FIO_LEAK_COUNTER_ON_ALLOC(fio___io_inbox_s);
+  return t;
+}
+
+/* returns a chain of pool nodes (linked by `free_next`) to the free list. */
+FIO_SFUNC void fio___io_inbox_node_release(uint32_t first,
+                                           fio___io_inbox_s *last) {
+  uint64_t head, next;
+  fio_atomic_load(head, &fio___io_inbox_free);
+  do {
+    fio_atomic_exchange(&last->free_next, (uint32_t)head);
+    next = ((((head >> 32) + 1) << 32) | first);
+  } while (!fio_atomic_compare_exchange_p(&fio___io_inbox_free, &head, &next));
+}
+#else
+FIO_IFUNC int fio___io_inbox_is_pooled(fio___io_inbox_s *t) {
+  return 0;
+  (void)t;
+}
+
+FIO_SFUNC fio___io_inbox_s *fio___io_inbox_node_new(void) {
+  fio___io_inbox_s *t =
+      (fio___io_inbox_s *)FIO_MEM_REALLOC_(NULL, 0, sizeof(*t), 0);
+  if (t)
+    FIO_LEAK_COUNTER_ON_ALLOC(fio___io_inbox_s);
+  return t;
+}
+#endif /* FIO_IO_INBOX_POOL */
+
+/* Adds a task to an inbox without locking, returns 1 if the inbox was empty,
+ * 0 if it wasn't and -1 on error. */
+FIO_SFUNC int fio___io_inbox_add(fio___io_inbox_s **inbox,
+                                 void (*task)(void *, void *),
+                                 void *udata1,
+                                 void *udata2) {
+  fio___io_inbox_s *head;
+  fio___io_inbox_s *t = fio___io_inbox_node_new();
+  if (!t)
+    return -1;
+  t->fn = task;
+  t->udata1 = udata1;
+  t->udata2 = udata2;
+  fio_atomic_load(head, inbox);
+  do {
+    t->next = head;
+  } while (!fio_atomic_compare_exchange_p(inbox, &head, &t));
+  return !head;
+}
+
+/* Pushes a task to the inbox without locking, returns -1 on error. */
+FIO_SFUNC int fio___io_inbox_push(void (*task)(void *, void *),
+                                  void *udata1,
+                                  void *udata2) {
+  int r = fio___io_inbox_add(&FIO___IO.inbox, task, udata1, udata2);
+  /* only the first producer after a drain pays for the wakeup syscall */
+  if (r > 0)
+    fio___io_wakeup();
+  return (r < 0) ? -1 : 0;
+}
+
+/* returns the next inbox task for `fio_queue_push_batch` (nodes are kept). */
+FIO_SFUNC fio_queue_task_s fio___io_inbox_next(void *pos_) {
+  fio___io_inbox_s **pos = (fio___io_inbox_s **)pos_;
+  fio___io_inbox_s *t = *pos;
+  while (t && !t->fn)
+    t = t->next;
+  if (!t)
+    return (fio_queue_task_s){.fn = NULL};
+  *pos = t->next;
+  return (fio_queue_task_s){.fn = t->fn,
+                            .udata1 = t->udata1,
+                            .udata2 = t->udata2};
+}
+
+/* Moves an inbox's tasks (in FIFO order) to a queue, returns the count. */
+FIO_SFUNC size_t fio___io_inbox_move(fio___io_inbox_s **inbox,
+                                     fio_queue_s *q) {
+  size_t r;
+  fio___io_inbox_s *head, *fifo = NULL, *pos;
+  fio_atomic_load(head, inbox);
+  if (!head)
+    return 0;
+  head = fio_atomic_exchange(inbox, (fio___io_inbox_s *)NULL);
+  while (head) {
+    fio___io_inbox_s *tmp = head->next;
+    head->next = fifo;
+    fifo = head;
+    head = tmp;
+  }
+  /* the whole list is pushed under a single queue lock */
+  pos = fifo;
+  r = fio_queue_push_batch(q, fio___io_inbox_next, &pos);
+#if FIO_IO_INBOX_POOL
+  uint32_t pooled = 0;
+  fio___io_inbox_s *last = NULL, *pool;
+  fio_atomic_load(pool, &fio___io_inbox_pool);
+#endif
+  while (fifo) {
+    fio___io_inbox_s *t = fifo;
+    fifo = t->next;
+    if (!fio___io_inbox_is_pooled(t)) {
+      FIO_LEAK_COUNTER_ON_FREE(fio___io_inbox_s);
+      FIO_MEM_FREE_(t, sizeof(*t));
+      continue;
+    }
+#if FIO_IO_INBOX_POOL
+    /* collect pool nodes, released to the free list with a single CAS */
+    fio_atomic_exchange(&t->free_next, pooled);
+    pooled = (uint32_t)(t - pool) + 1;
+    if (!last)
+      last = t;
+#endif
+  }
+#if FIO_IO_INBOX_POOL
+  if (last)
+    fio___io_inbox_node_release(pooled, last);
+#endif
+  return r;
+}
+
+/* Moves the inbox tasks (in FIFO order) to the IO queue, returns the count. */
+FIO_SFUNC size_t fio___io_inbox_drain(void) {
+  return fio___io_inbox_move(&FIO___IO.inbox, &FIO___IO.queue);
+}
+
 void fio_io_defer___(void);
 /** Schedules a task for delayed execution. This function is thread-safe. */
 SFUNC void fio_io_defer FIO_NOOP(void (*task)(void *, void *),
                                  void *udata1,
                                  void *udata2) {
+  uint32_t flags;
+  fio_atomic_load(flags, &FIO___IO.flags);
+  /* non-IO threads skip the queue lock while the reactor is cycling */
+  if (!fio___io_is_reactor_thread && (flags & FIO___IO_FLAG_CYCLING) &&
+      !fio___io_inbox_push(task, udata1, udata2))
+    return;
   fio_queue_push(&FIO___IO.queue, task, udata1, udata2);
   fio___io_wakeup();
 }
 
+FIO_SFUNC void fio___io_reactor_wakeup(fio___io_reactor_s *r);
+
+/* Schedules a task on the reactor `r` (or the main reactor if `NULL`). */
+FIO_SFUNC void fio___io_reactor_defer(fio___io_reactor_s *r,
+                                      void (*task)(void *, void *),
+                                      void *udata1,
+                                      void *udata2) {
+  if (!r) {
+    fio_io_defer(task, udata1, udata2);
+    return;
+  }
+  if (fio___io_reactor == r) {
+    fio_queue_push(&r->queue, task, udata1, udata2);
+    return;
+  }
+  switch (fio___io_inbox_add(&r->inbox, task, udata1, udata2)) {
+  case 0: return;
+  case 1: break;
+  default: fio_queue_push(&r->queue, task, udata1, udata2);
+  }
+  fio___io_reactor_wakeup(r);
+}
+
+/* Schedules a task (no wakeup) on the calling thread's reactor. */
+FIO_IFUNC void fio___io_defer_here(void (*task)(void *, void *),
+                                   void *udata1,
+                                   void *udata2) {
+  fio_queue_push((fio___io_reactor ? &fio___io_reactor->queue
+                                   : &FIO___IO.queue),
+                 task,
+                 udata1,
+                 udata2);
+}
+
 void fio_io_run_every___(void);
 /** Schedules a timer bound task, see `fio_timer_schedule`. */
-SFUNC void fio_io_run_every FIO_NOOP(fio_timer_schedule_args_s args) {
+SFUNC fio_timer_s *fio_io_run_every FIO_NOOP(fio_timer_schedule_args_s args) {
+  if (fio___io_reactor) { /* timers run on the scheduling reactor */
+    args.start_at = fio___io_reactor->tick;
+    return fio_timer_schedule FIO_NOOP(&fio___io_reactor->timer, args);
+  }
   args.start_at = FIO___IO.tick;
-  fio_timer_schedule FIO_NOOP(&FIO___IO.timer, args);
+  return fio_timer_schedule FIO_NOOP(&FIO___IO.timer, args);
 }
 
 /** Returns a pointer for the IO reactor's queue. */
@@ -406,6 +715,8 @@ FIO_SFUNC void fio___io_last_tick_update(void *ignr_1, void *ignr_2) {
 
 /** Returns the last millisecond when the polled for IO events. */
 SFUNC int64_t fio_io_last_tick(void) {
+  if (fio___io_reactor)
+    return fio___io_reactor->tick;
   if (!(FIO___IO_FLAG_SET(&FIO___IO, FIO___IO_FLAG_TICK_SET) &
         FIO___IO_FLAG_TICK_SET))
     fio___io_defer_no_wakeup(fio___io_last_tick_update, NULL, NULL);
@@ -445,6 +756,10 @@ IO Type
 #define FIO___IO_FLAG_POLLOUT_SET ((uint32_t)512U)
 #define FIO___IO_FLAG_WRITE_DIRTY ((uint32_t)1024U)
 #define FIO___IO_FLAG_DATA_SCHD   ((uint32_t)2048U)
+/* the poll engine may perform the stream socket's reads and writes */
+#define FIO___IO_FLAG_POLL_IO ((uint32_t)4096U)
+/* the poll engine may accept the listening socket's clients */
+#define FIO___IO_FLAG_POLL_ACCEPT ((uint32_t)8192U)
 
 #define FIO___IO_FLAG_PREVENT_ON_DATA                                          \
   (FIO___IO_FLAG_SUSPENDED | FIO___IO_FLAG_THROTTLED)
@@ -474,8 +789,75 @@ struct fio_io_s {
   size_t total_recieved;
 #endif
   int64_t active;
+  /* the reactor polling the IO (`NULL` for the main reactor) */
+  fio___io_reactor_s *r;
 };
 
+/* Returns the task queue of the reactor handling the IO. */
+FIO_IFUNC fio_queue_s *fio___io_queue_of(fio_io_s *io) {
+  return io->r ? &io->r->queue : &FIO___IO.queue;
+}
+
+/* Returns the poll set of the reactor handling the IO. */
+FIO_IFUNC fio_poll_s *fio___io_poll_of(fio_io_s *io) {
+  return io->r ? &io->r->poll : &FIO___IO.poll;
+}
+
+/* Wakes reactor `r` (`NULL` for main), unless called from its own thread. */
+FIO_IFUNC void fio___io_wakeup_owner(fio___io_reactor_s *r) {
+  if (r) {
+    if (r != fio___io_reactor)
+      fio___io_reactor_wakeup(r);
+  } else if (!fio___io_is_reactor_thread) {
+    fio___io_wakeup();
+  }
+}
+
+/* Schedules a task on the reactor handling the IO. */
+FIO_IFUNC void fio___io_defer_io(fio_io_s *io,
+                                 void (*task)(void *, void *),
+                                 void *udata1,
+                                 void *udata2) {
+  fio___io_reactor_s *r = io->r; /* the task may release `io` */
+  fio_queue_push((r ? &r->queue : &FIO___IO.queue), task, udata1, udata2);
+  fio___io_wakeup_owner(r);
+}
+
+void fio_io_defer_to___(void); /* IDE Marker */
+/** Schedules a task on the reactor handling the IO. Thread-safe. */
+SFUNC void fio_io_defer_to FIO_NOOP(fio_io_s *io,
+                                    void (*task)(void *, void *),
+                                    void *udata1,
+                                    void *udata2) {
+  fio___io_reactor_defer((io ? io->r : NULL), task, udata1, udata2);
+}
+
+#if defined(DEBUG)
+/* IO tasks must run on the thread of the reactor handling the IO. */
+FIO_IFUNC void fio___io_assert_io_thread_of(fio_io_s *io) {
+  if (!io->r) {
+    fio___io_assert_io_thread();
+    return;
+  }
+  FIO_ASSERT_DEBUG(fio___io_reactor == io->r,
+                   "IO accessed from a thread other than its reactor's!");
+}
+#define FIO___IO_ASSERT_IO_THREAD_OF(io) fio___io_assert_io_thread_of(io)
+#else
+#define FIO___IO_ASSERT_IO_THREAD_OF(io) ((void)0)
+#endif
+
+/* The `fio_poll_monitor` flags that let the engine perform the IO's calls. */
+FIO_IFUNC unsigned short fio___io_poll_mode(fio_io_s *io) {
+  if ((io->flags & FIO___IO_FLAG_POLL_ACCEPT))
+    return FIO_POLL_ACCEPT;
+  /* only the default (plain text) functions read through the poll engine */
+  if ((io->flags & FIO___IO_FLAG_POLL_IO) &&
+      io->pr->io_functions.read == fio___io_func_default_read)
+    return FIO_POLL_IO;
+  return 0;
+}
+
 FIO_IFUNC void fio___io_monitor_in(fio_io_s *io) {
   // FIO_LOG_DDEBUG2("(%d) IO monitoring Input for %d (called)",
   //                 fio_io_pid(),
@@ -486,7 +868,10 @@ FIO_IFUNC void fio___io_monitor_in(fio_io_s *io) {
        FIO___IO_FLAG_POLLIN_SET)) {
     return;
   }
-  fio_poll_monitor(&FIO___IO.poll, io->fd, (void *)io, POLLIN);
+  fio_poll_monitor(fio___io_poll_of(io),
+                   io->fd,
+                   (void *)io,
+                   (POLLIN | fio___io_poll_mode(io)));
   // FIO_LOG_DDEBUG2("(%d) IO monitoring Input for %d", fio_io_pid(), io->fd);
 }
 FIO_IFUNC void fio___io_monitor_out(fio_io_s *io) {
@@ -498,7 +883,10 @@ FIO_IFUNC void fio___io_monitor_out(fio_io_s *io) {
   if ((FIO___IO_FLAG_SET(io, FIO___IO_FLAG_POLLOUT_SET) &
        FIO___IO_FLAG_POLLOUT_SET))
     return;
-  fio_poll_monitor(&FIO___IO.poll, io->fd, (void *)io, POLLOUT);
+  fio_poll_monitor(fio___io_poll_of(io),
+                   io->fd,
+                   (void *)io,
+                   (POLLOUT | fio___io_poll_mode(io)));
   // FIO_LOG_DDEBUG2("(%d) IO monitoring Output for %d", fio_io_pid(), io->fd);
 }
 
@@ -508,7 +896,7 @@ FIO_IFUNC void fio___io_monitor_forget(fio_io_s *io) {
    * Skipping the forget leaves a stale entry that a later review can
    * dispatch (POLLNVAL after close, or an fd-reused event) - resurrecting a
    * freed IO. Forgetting an unmonitored fd is harmless (backend returns -1). */
-  fio_poll_forget(&FIO___IO.poll, io->fd);
+  fio_poll_forget(fio___io_poll_of(io), io->fd);
   FIO___IO_FLAG_UNSET(io, FIO___IO_FLAG_POLL_SET);
   // FIO_LOG_DDEBUG2("(%d) IO monitoring Removed for %d", fio_io_pid(), io->fd);
 }
@@ -531,15 +919,16 @@ FIO_SFUNC void fio___io_destroy(fio_io_s *io) {
                   io->fd);
 #endif
   /* store info, as it might be freed if the protocol is freed. */
-  if (FIO_LIST_IS_EMPTY(&io->pr->reserved.ios))
+  if (!io->r && FIO_LIST_IS_EMPTY(&io->pr->reserved.ios))
     FIO_LIST_REMOVE_RESET(&io->pr->reserved.protocols);
   /* call on_stop / free callbacks . */
   pr->io_functions.cleanup(io->tls);
   pr->on_close((void *)(io + 1), io->udata);
   fio___io_env_safe_destroy(&io->env);
+  /* forget first, the engine submits pending sends before `close` */
+  fio___io_monitor_forget(io);
   fio_sock_close(io->fd);
   fio_stream_destroy(&io->out);
-  fio___io_monitor_forget(io);
   FIO_LOG_DDEBUG2("(%d) IO closed and destroyed for fd %d",
                   fio_io_pid(),
                   io->fd);
@@ -561,11 +950,16 @@ FIO_SFUNC void fio___io_protocol_set(void *io_, void *pr_) {
     pr = &FIO___IO_MOCK_PROTOCOL;
   fio___io_protocol_init_test(pr, (io->tls != NULL));
   FIO_LIST_REMOVE(&io->node);
-  if (FIO_LIST_IS_EMPTY(&old->reserved.ios))
-    FIO_LIST_REMOVE_RESET(&old->reserved.protocols);
-  if (FIO_LIST_IS_EMPTY(&pr->reserved.ios))
-    FIO_LIST_PUSH(&FIO___IO.protocols, &pr->reserved.protocols);
-  FIO_LIST_PUSH(&pr->reserved.ios, &io->node);
+  if (io->r) {
+    /* protocol lists belong to the main reactor, never touch them here */
+    FIO_LIST_PUSH(&io->r->ios, &io->node);
+  } else {
+    if (FIO_LIST_IS_EMPTY(&old->reserved.ios))
+      FIO_LIST_REMOVE_RESET(&old->reserved.protocols);
+    if (FIO_LIST_IS_EMPTY(&pr->reserved.ios))
+      FIO_LIST_PUSH(&FIO___IO.protocols, &pr->reserved.protocols);
+    FIO_LIST_PUSH(&pr->reserved.ios, &io->node);
+  }
   io->pr = pr;
   FIO_LOG_DEBUG2("(%d) protocol set for IO with fd %d",
                  fio_io_pid(),
@@ -595,26 +989,30 @@ SFUNC size_t fio_io_protocol_each(fio_io_protocol_s *protocol,
   return count;
 }
 
-/* Attaches the socket in `fd` to the facio.io engine (reactor). */
-SFUNC fio_io_s *fio_io_attach_fd(fio_socket_i fd,
-                                 fio_io_protocol_s *pr,
-                                 void *udata,
-                                 void *tls) {
+/* Attaches `fd` with additional `FIO___IO_FLAG_POLL_*` flags. */
+FIO_SFUNC fio_io_s *fio___io_attach_fd(fio_socket_i fd,
+                                       fio_io_protocol_s *pr,
+                                       void *udata,
+                                       void *tls,
+                                       uint32_t flags) {
   fio_io_s *io = NULL;
+  fio___io_reactor_s *r = fio___io_reactor;
   fio_io_protocol_s cpy;
   if (!pr)
     pr = &FIO___IO_MOCK_PROTOCOL;
   if (!FIO_SOCK_FD_ISVALID(fd))
     goto error;
+  fio___io_protocol_init_test(pr, (tls != NULL)); /* rounds `buffer_size` */
   io = fio___io_new2(pr->buffer_size);
   *io = (fio_io_s){
       .fd = fd,
-      .flags = FIO___IO_FLAG_OPEN,
+      .flags = (FIO___IO_FLAG_OPEN | flags),
       .pr = &FIO___IO_MOCK_PROTOCOL,
       .node = FIO_LIST_INIT(io->node),
       .udata = udata,
       .tls = tls,
-      .active = FIO___IO.tick,
+      .active = (r ? r->tick : FIO___IO.tick),
+      .r = r,
   };
   fio_sock_set_non_block(fd);
   FIO_LOG_DEBUG2("(%d) attaching fd %d to IO object %p (%zu bytes buffer)",
@@ -622,15 +1020,16 @@ SFUNC fio_io_s *fio_io_attach_fd(fio_socket_i fd,
                  fd,
                  (void *)io,
                  fio_io_buffer_len(io));
-  fio_io_defer(fio___io_protocol_set, (void *)fio___io_dup2(io), (void *)pr);
+  fio___io_reactor_defer(r,
+                         fio___io_protocol_set,
+                         (void *)fio___io_dup2(io),
+                         (void *)pr);
   return io;
 
 error:
   cpy = *pr;
   if (cpy.on_close)
-    fio___io_defer_no_wakeup((void (*)(void *, void *))cpy.on_close,
-                             NULL,
-                             udata);
+    fio___io_defer_here((void (*)(void *, void *))cpy.on_close, NULL, udata);
   /* Ownership of `tls` transfers to the reactor when `fio_io_attach_fd` is
    * called, on success AND on failure. Release it here with the CONTEXT
    * destructor: `cleanup` would be wrong, as it destroys per-connection
@@ -642,13 +1041,21 @@ error:
   return io;
 }
 
+/* Attaches the socket in `fd` to the facio.io engine (reactor). */
+SFUNC fio_io_s *fio_io_attach_fd(fio_socket_i fd,
+                                 fio_io_protocol_s *pr,
+                                 void *udata,
+                                 void *tls) {
+  return fio___io_attach_fd(fd, pr, udata, tls, 0);
+}
+
 /** Sets a new protocol object. `NULL` is a valid "only-write" protocol. */
 SFUNC fio_io_protocol_s *fio_io_protocol_set(fio_io_s *io,
                                              fio_io_protocol_s *pr) {
   uintptr_t old_flags;
   if (!io)
     goto init;
-  fio_io_defer(fio___io_protocol_set, (void *)fio___io_dup2(io), (void *)pr);
+  fio_io_defer_to(io, fio___io_protocol_set, (void *)fio___io_dup2(io), pr);
   return pr;
 init:
   old_flags = pr->reserved.flags;
@@ -692,9 +1099,13 @@ IFUNC int fio_io_peer_info_next(fio_io_s *io, fio_x509_cert_s *dest) {
 FIO_SFUNC void fio___io_touch(void *io_, void *ignr_) {
   fio_io_s *io = (fio_io_s *)io_;
   fio_atomic_and(&io->flags, ~FIO___IO_FLAG_TOUCH);
-  io->active = FIO___IO.tick;
-  FIO_LIST_REMOVE(&io->node); /* timeout IO ordering */
-  FIO_LIST_PUSH(&io->pr->reserved.ios, &io->node);
+  if (io->r) {
+    io->active = io->r->tick;
+  } else {
+    io->active = FIO___IO.tick;
+    FIO_LIST_REMOVE(&io->node); /* timeout IO ordering */
+    FIO_LIST_PUSH(&io->pr->reserved.ios, &io->node);
+  }
   fio___io_free2(io);
   (void)ignr_;
 }
@@ -702,7 +1113,9 @@ FIO_SFUNC void fio___io_touch(void *io_, void *ignr_) {
 /* Resets a socket's timeout counter. */
 SFUNC void fio_io_touch(fio_io_s *io) {
   if (!(fio_atomic_or(&io->flags, FIO___IO_FLAG_TOUCH) & FIO___IO_FLAG_TOUCH))
-    fio_queue_push_urgent(&FIO___IO.queue, fio___io_touch, fio___io_dup2(io));
+    fio_queue_push_urgent(fio___io_queue_of(io),
+                          fio___io_touch,
+                          fio___io_dup2(io));
 }
 
 /**
@@ -780,9 +1193,10 @@ SFUNC void fio_io_write2 FIO_NOOP(fio_io_s *io, fio_io_write_args_s args) {
   if ((io->flags & FIO___IO_FLAG_CLOSE))
     goto write_called_after_close;
   FIO___IO_FLAG_SET(io, FIO___IO_FLAG_WRITE_DIRTY);
-  fio___io_defer_no_wakeup(fio___io_write2,
-                           (void *)fio___io_dup2(io),
-                           (void *)packet);
+  fio___io_defer_io(io,
+                    fio___io_write2,
+                    (void *)fio___io_dup2(io),
+                    (void *)packet);
   return;
 
 error: /* note: `dealloc` already called by the `fio_stream` error handler. */
@@ -857,8 +1271,8 @@ SFUNC void fio_io_close_now(fio_io_s *io) {
 SFUNC fio_io_s *fio_io_dup(fio_io_s *io) { return fio___io_dup2(io); }
 
 SFUNC void fio___io_free_task(void *io_, void *ignr_) {
-  FIO___IO_ASSERT_IO_THREAD();
   fio_io_s *io = (fio_io_s *)io_;
+  FIO___IO_ASSERT_IO_THREAD_OF(io);
   if (FIO___IO_FLAG_UNSET(io, FIO___IO_FLAG_WRITE_DIRTY) &
       FIO___IO_FLAG_WRITE_DIRTY) {
     fio___io_poll_on_ready_schd((void *)io);
@@ -870,9 +1284,14 @@ SFUNC void fio___io_free_task(void *io_, void *ignr_) {
 SFUNC void fio_io_free(fio_io_s *io) {
   if (!io)
     return;
-  if ((io->flags & FIO___IO_FLAG_WRITE_DIRTY))
-    fio___io_wakeup();
-  fio___io_defer_no_wakeup(fio___io_free_task, (void *)io, NULL);
+  fio___io_reactor_s *r = io->r; /* the task may release `io` */
+  uint32_t dirty = (io->flags & FIO___IO_FLAG_WRITE_DIRTY);
+  fio_queue_push((r ? &r->queue : &FIO___IO.queue),
+                 fio___io_free_task,
+                 (void *)io,
+                 NULL);
+  if (dirty) /* a clean IO's release isn't urgent, don't wake for it */
+    fio___io_wakeup_owner(r);
 }
 
 /** IO-thread free that flushes dirty writes (schedules on_ready if needed). */
@@ -895,6 +1314,7 @@ SFUNC void fio___io_unsuspend(void *io_, void *ignr_) {
     fio_io_close(io);
   else
     fio___io_monitor_in(io);
+  fio___io_free2(io);
   return;
   (void)ignr_;
 }
@@ -903,7 +1323,7 @@ SFUNC void fio___io_unsuspend(void *io_, void *ignr_) {
 SFUNC void fio_io_unsuspend(fio_io_s *io) {
   if ((FIO___IO_FLAG_UNSET(io, FIO___IO_FLAG_SUSPENDED) &
        FIO___IO_FLAG_SUSPENDED))
-    fio_io_defer(fio___io_unsuspend, (void *)io, NULL);
+    fio_io_defer_to(io, fio___io_unsuspend, (void *)fio___io_dup2(io), NULL);
 }
 
 /** Returns 1 if the IO handle was suspended. */
@@ -987,8 +1407,14 @@ static void fio___io_poll_on_ready(void *io_, void *ignr_) {
   errno = 0;
 #endif
   fio_io_s *io = (fio_io_s *)io_;
-  char *buf_mem = fio___on_ready_buf_new(1);
+  char *buf_mem =
+      (fio___io_reactor ? fio___io_reactor->buf : fio___on_ready_buf_new(1));
   size_t total = 0;
+  size_t vec_count;
+  fio_buf_info_s vec[FIO_IO_WRITEV_MAX];
+  size_t file_offset;
+  int file;
+  int pending = 0; /* `flush` reported unsent internal (TLS) data */
   FIO___IO_FLAG_UNSET(io,
                       (FIO___IO_FLAG_POLLOUT_SET | FIO___IO_FLAG_WRITE_SCHD));
   // FIO_LOG_DDEBUG2("(%d) poll_on_ready callback for fd %d",
@@ -1004,14 +1430,33 @@ static void fio___io_poll_on_ready(void *io_, void *ignr_) {
     case 0:
       if ((errno != EWOULDBLOCK) && (errno != EAGAIN))
         goto connection_error;
+      pending = 1;
       break;
-    case 1: break;
-    default: total += (size_t)r; goto finish_loop;
+    case 1: pending = 0; break;
+    default: total += (size_t)r; pending = 1; goto finish_loop;
+    }
+    /* send file packets without a user space copy if possible */
+    if (io->pr->io_functions.sendfile &&
+        !fio_stream_read_fd(&io->out, &file, &file_offset, &len)) {
+      r = io->pr->io_functions
+              .sendfile(io->fd, file, file_offset, len, io->tls);
+      if (r > 0 || (r == -1 && (errno == EWOULDBLOCK || errno == EAGAIN ||
+                                errno == EINTR)))
+        goto review_write;
+      len = FIO_IO_BUFFER_PER_WRITE; /* unsupported, copy using `write` */
     }
-    fio_stream_read(&io->out, &buf, &len);
-    if (!len)
-      goto finish_loop;
-    r = io->pr->io_functions.write(io->fd, buf, len, io->tls);
+    /* flush the in-memory backlog using a single vectored write if possible */
+    if (io->pr->io_functions.writev &&
+        (vec_count = fio_stream_read_vec(&io->out, vec, FIO_IO_WRITEV_MAX)) >
+            1) {
+      r = io->pr->io_functions.writev(io->fd, vec, vec_count, io->tls);
+    } else {
+      fio_stream_read(&io->out, &buf, &len);
+      if (!len)
+        goto finish_loop;
+      r = io->pr->io_functions.write(io->fd, buf, len, io->tls);
+    }
+  review_write:
     switch (((size_t)r + 1)) {
     case 0:
       if ((errno == EWOULDBLOCK) || (errno == EAGAIN))
@@ -1048,8 +1493,12 @@ finish_loop:
     }
     fio___io_monitor_out(io);
   } else if ((io->flags & FIO___IO_FLAG_CLOSE)) {
-    io->pr->io_functions.finish(io->fd, io->tls);
-    fio_io_close_now(io);
+    if (pending) { /* don't drop data the TLS layer still holds */
+      fio___io_monitor_out(io);
+    } else {
+      io->pr->io_functions.finish(io->fd, io->tls);
+      fio_io_close_now(io);
+    }
   } else {
     if ((io->flags & FIO___IO_FLAG_THROTTLED)) {
       FIO___IO_FLAG_UNSET(io, FIO___IO_FLAG_THROTTLED);
@@ -1117,18 +1566,20 @@ static void fio___io_poll_on_data_schd(void *io) {
   //                 fio_io_pid(),
   //                 fio_io_fd((fio_io_s *)io));
   // FIO___IO_FLAG_POLLIN_SET
-  fio___io_defer_no_wakeup(fio___io_poll_on_data,
-                           (void *)fio___io_dup2((fio_io_s *)io),
-                           NULL);
+  fio___io_defer_io((fio_io_s *)io,
+                    fio___io_poll_on_data,
+                    (void *)fio___io_dup2((fio_io_s *)io),
+                    NULL);
 }
 SFUNC void fio_io_on_data_schedule(fio_io_s *io) {
   if (!io || (io->flags & FIO___IO_FLAG_CLOSED_ALL))
     return;
   if (!(FIO___IO_FLAG_SET(io, FIO___IO_FLAG_DATA_SCHD) &
         FIO___IO_FLAG_DATA_SCHD)) {
-    fio___io_defer_no_wakeup(fio___io_poll_on_data,
-                             (void *)fio___io_dup2(io),
-                             NULL);
+    fio___io_defer_io(io,
+                      fio___io_poll_on_data,
+                      (void *)fio___io_dup2(io),
+                      NULL);
   }
 }
 
@@ -1138,18 +1589,25 @@ static void fio___io_poll_on_ready_schd(void *io) {
     // FIO_LOG_DDEBUG2("(%d) `on_ready` scheduled for fd %d.",
     //                 fio_io_pid(),
     //                 fio_io_fd((fio_io_s *)io));
-    fio___io_defer_no_wakeup(fio___io_poll_on_ready,
-                             (void *)fio___io_dup2((fio_io_s *)io),
-                             NULL);
+    fio___io_defer_io((fio_io_s *)io,
+                      fio___io_poll_on_ready,
+                      (void *)fio___io_dup2((fio_io_s *)io),
+                      NULL);
   }
 }
+SFUNC void fio_io_on_ready_schedule(fio_io_s *io) {
+  if (!io || !(io->flags & FIO___IO_FLAG_OPEN))
+    return;
+  fio___io_poll_on_ready_schd((void *)io);
+}
 static void fio___io_poll_on_close_schd(void *io) {
   // FIO_LOG_DDEBUG2("(%d) remote closure for fd %d.",
   //                 fio_io_pid(),
   //                 fio_io_fd((fio_io_s *)io));
-  fio___io_defer_no_wakeup(fio___io_poll_on_close,
-                           (void *)fio___io_dup2((fio_io_s *)io),
-                           NULL);
+  fio___io_defer_io((fio_io_s *)io,
+                    fio___io_poll_on_close,
+                    (void *)fio___io_dup2((fio_io_s *)io),
+                    NULL);
 }
 
 /* *****************************************************************************
@@ -1191,6 +1649,28 @@ static int fio___io_review_timeouts(void) {
   return c;
 }
 
+/** Schedules the timeout event for timed out IO of an additional reactor. */
+static int fio___io_reactor_review_timeouts(fio___io_reactor_s *r) {
+  int c = 0;
+  /* test timeouts at whole second intervals */
+  if (r->reviewed + 1000 > r->tick)
+    return c;
+  r->reviewed = r->tick;
+  /* protocols are shared, so the IO list isn't ordered by timeout: scan it */
+  FIO_LIST_EACH(fio_io_s, node, &r->ios, io) {
+    int64_t timeout = (int64_t)io->pr->timeout;
+    if (!timeout || timeout > FIO_IO_TIMEOUT_MAX)
+      timeout = FIO_IO_TIMEOUT_MAX;
+    if (io->active >= r->tick - timeout)
+      continue;
+    fio_queue_push(&r->queue,
+                   fio___io_poll_on_timeout,
+                   (void *)fio___io_dup2(io));
+    ++c;
+  }
+  return c;
+}
+
 /* *****************************************************************************
 Wakeup Protocol
 ***************************************************************************** */
@@ -1244,6 +1724,50 @@ FIO_SFUNC void fio___io_wakeup_init(void) {
   FIO_LOG_DDEBUG2("(%d) fio___io_wakeup initialized", FIO___IO.pid);
 }
 
+FIO_SFUNC void fio___io_reactor_wakeup_cb(fio_io_s *io) {
+  char buf[512];
+  ssize_t r = fio_sock_read(fio_io_fd(io), buf, 512);
+  (void)r;
+  FIO___IO_FLAG_UNSET(io->r, FIO___IO_FLAG_WAKEUP);
+}
+FIO_SFUNC void fio___io_reactor_wakeup_on_close(void *ignr_, void *r_) {
+  fio___io_reactor_s *r = (fio___io_reactor_s *)r_;
+  fio_sock_close(r->wakeup_fd);
+  r->wakeup = NULL;
+  r->wakeup_fd = FIO_SOCKET_INVALID;
+  (void)ignr_;
+}
+
+FIO_SFUNC void fio___io_reactor_wakeup(fio___io_reactor_s *r) {
+  if (!r->wakeup ||
+      (FIO___IO_FLAG_SET(r, FIO___IO_FLAG_WAKEUP) & FIO___IO_FLAG_WAKEUP))
+    return;
+  char buf[1] = {(char)~0};
+  ssize_t ignr = fio_sock_write(r->wakeup_fd, buf, 1);
+  (void)ignr;
+}
+
+static fio_io_protocol_s FIO___IO_REACTOR_WAKEUP_PROTOCOL = {
+    .on_data = fio___io_reactor_wakeup_cb,
+    .on_close = fio___io_reactor_wakeup_on_close,
+    .on_timeout = fio_io_touch,
+};
+
+/* called before the reactor's thread starts, with `fio___io_reactor == r` */
+FIO_SFUNC void fio___io_reactor_wakeup_init(fio___io_reactor_s *r) {
+  fio_socket_i fds[2];
+  if (fio_sock_socketpair(fds)) {
+    FIO_LOG_ERROR("(%d) couldn't open reactor wakeup pipes, wakeup disabled.",
+                  FIO___IO.pid);
+    return;
+  }
+  fio_sock_set_non_block(fds[0]);
+  fio_sock_set_non_block(fds[1]);
+  r->wakeup_fd = fds[1];
+  r->wakeup =
+      fio_io_attach_fd(fds[0], &FIO___IO_REACTOR_WAKEUP_PROTOCOL, r, NULL);
+}
+
 /* *****************************************************************************
 TLS Context Type and Helpers
 ***************************************************************************** */
@@ -1667,6 +2191,8 @@ SFUNC fio_io_functions_s fio_io_tls_default_functions(fio_io_functions_s *f) {
       .start = fio_io_noop,
       .read = fio___io_func_default_read,
       .write = fio___io_func_default_write,
+      .writev = fio___io_func_default_writev,
+      .sendfile = fio___io_func_default_sendfile,
       .flush = fio___io_func_default_flush,
       .finish = fio___io_func_default_finish,
       .cleanup = fio___io_func_default_cleanup,
@@ -1682,6 +2208,10 @@ SFUNC fio_io_functions_s fio_io_tls_default_functions(fio_io_functions_s *f) {
     f->read = fio___io_func_default_read;
   if (!f->write)
     f->write = fio___io_func_default_write;
+  if (!f->writev && f->write == fio___io_func_default_write)
+    f->writev = fio___io_func_default_writev;
+  if (!f->sendfile && f->write == fio___io_func_default_write)
+    f->sendfile = fio___io_func_default_sendfile;
   if (!f->flush)
     f->flush = fio___io_func_default_flush;
   if (!f->finish)
@@ -1752,10 +2282,10 @@ SFUNC void fio_io_async_attach(fio_io_async_s *q, uint32_t threads) {
 
 void fio_io_async_every___(void); /* IDE Mark */
 /** Schedules a timer bound task for the async queue (`fio_timer_schedule`). */
-SFUNC void fio_io_async_every FIO_NOOP(fio_io_async_s *q,
-                                       fio_timer_schedule_args_s a) {
+SFUNC fio_timer_s *fio_io_async_every FIO_NOOP(fio_io_async_s *q,
+                                               fio_timer_schedule_args_s a) {
   a.start_at = FIO___IO.tick;
-  fio_timer_schedule FIO_NOOP(&q->timers, a);
+  return fio_timer_schedule FIO_NOOP(&q->timers, a);
 }
 
 /* *****************************************************************************
@@ -1790,6 +2320,8 @@ FIO_SFUNC void fio___io_cleanup_at_exit(void *ignr_) {
   fio___io_after_fork(ignr_);
   fio_poll_destroy(&FIO___IO.poll);
   FIO___IO.tick = FIO___IO_GET_TIME_MILLI();
+  /* tasks deferred (by other threads) after the reactor stopped */
+  fio___io_inbox_drain();
   fio_queue_perform_all(&FIO___IO.queue);
   fio_timer_destroy(&FIO___IO.timer);
   fio_queue_perform_all(&FIO___IO.queue);
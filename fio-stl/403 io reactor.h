@@ -80,11 +80,13 @@ FIO_SFUNC void fio___io_tick(int max_timeout) {
   static size_t performed_idle = 0;
   FIO___IO_ASSERT_IO_THREAD();
   int timeout = fio___io_queue_timers();
+  fio___io_inbox_drain();
   if (fio_queue_count(&FIO___IO.queue))
     timeout = 0;
   if (timeout > max_timeout)
     timeout = max_timeout;
   size_t idle_round = (fio_poll_review(&FIO___IO.poll, timeout) == 0);
+  fio___io_inbox_drain();
   idle_round &= (timeout > 0);
   performed_idle &= idle_round;
   idle_round ^= performed_idle;
@@ -177,8 +179,157 @@ no_run:
   return;
 }
 
+/* *****************************************************************************
+Additional Reactors (multi-reactor mode)
+***************************************************************************** */
+
+/* A single cycle of an additional reactor, see `fio___io_tick`. */
+FIO_SFUNC void fio___io_reactor_tick(fio___io_reactor_s *r, int max_timeout) {
+  r->tick = FIO___IO_GET_TIME_MILLI();
+  fio_timer_push2queue(&r->queue, &r->timer, r->tick);
+  int64_t timeout = fio_timer_next_at(&r->timer) - r->tick;
+  fio___io_inbox_move(&r->inbox, &r->queue);
+  if (timeout < 0 || fio_queue_count(&r->queue))
+    timeout = 0;
+  if (timeout > max_timeout)
+    timeout = max_timeout;
+  fio_poll_review(&r->poll, (size_t)timeout);
+  fio___io_inbox_move(&r->inbox, &r->queue);
+  r->tick = FIO___IO_GET_TIME_MILLI();
+  fio_timer_push2queue(&r->queue, &r->timer, r->tick);
+  fio___io_reactor_review_timeouts(r);
+  /* tasks scheduled by the performed tasks wait for the next cycle */
+  for (uint32_t i = fio_queue_count(&r->queue); i; --i)
+    if (fio_queue_perform(&r->queue))
+      break;
+}
+
+FIO_SFUNC void fio___io_reactor_shutdown(fio___io_reactor_s *r) {
+  const int64_t limit = (r->tick = FIO___IO_GET_TIME_MILLI()) +
+                        (int64_t)FIO___IO.shutdown_timeout;
+  FIO_LIST_EACH(fio_io_s, node, &r->ios, io) {
+    io->pr->on_shutdown(io);
+    if (!(io->flags & FIO___IO_FLAG_SUSPENDED))
+      fio_io_close(io);
+  }
+  /* cycle while connections exist. */
+  while (!FIO_LIST_IS_EMPTY(&r->ios) && r->tick < limit)
+    fio___io_reactor_tick(r, 100);
+  /* in case of timeout, force close remaining connections. */
+  FIO_LIST_EACH(fio_io_s, node, &r->ios, io) { fio_io_close_now(io); }
+  fio___io_inbox_move(&r->inbox, &r->queue);
+  fio_queue_perform_all(&r->queue);
+  /* IO objects still referenced (i.e., by the user) move to the main reactor */
+  FIO_LIST_EACH(fio_io_s, node, &r->ios, io) {
+    fio_poll_forget(&r->poll, io->fd);
+    FIO___IO_FLAG_UNSET(io, FIO___IO_FLAG_POLL_SET);
+    FIO_LIST_REMOVE_RESET(&io->node);
+    io->r = NULL;
+  }
+}
+
+FIO_SFUNC void *fio___io_reactor_work(void *r_) {
+  fio___io_reactor_s *r = (fio___io_reactor_s *)r_;
+  uint8_t stop = 0;
+  fio___io_reactor = r;
+  while (!stop) {
+    fio___io_reactor_tick(r, 500);
+    fio_atomic_load(stop, &FIO___IO.stop);
+  }
+  fio___io_reactor_shutdown(r);
+  fio___io_reactor = NULL;
+  return NULL;
+}
+
+/* Starts the additional reactor threads, if any. */
+FIO_SFUNC void fio___io_reactors_start(void) {
+  const size_t count = (size_t)FIO___IO.reactors_count - 1;
+  if (!count || FIO___IO.reactors_running)
+    return;
+  FIO___IO.reactors = (fio___io_reactor_s **)
+      FIO_MEM_REALLOC_(NULL, 0, sizeof(*FIO___IO.reactors) * count, 0);
+  FIO_ASSERT_ALLOC(FIO___IO.reactors);
+  for (size_t i = 0; i < count; ++i) {
+    fio___io_reactor_s *r =
+        (fio___io_reactor_s *)FIO_MEM_REALLOC_(NULL, 0, sizeof(*r), 0);
+    FIO_ASSERT_ALLOC(r);
+    *r = (fio___io_reactor_s){
+        .tick = FIO___IO.tick,
+        .reviewed = FIO___IO.tick,
+        .timer = FIO_TIMER_QUEUE_INIT,
+        .wakeup_fd = FIO_SOCKET_INVALID,
+        .ios = FIO_LIST_INIT(r->ios),
+        .buf = (char *)FIO_MEM_REALLOC_(NULL, 0, FIO_IO_BUFFER_PER_WRITE, 0),
+    };
+    FIO_ASSERT_ALLOC(r->buf);
+    fio_queue_init(&r->queue);
+    fio_poll_init(&r->poll,
+                  .on_data = fio___io_poll_on_data_schd,
+                  .on_ready = fio___io_poll_on_ready_schd,
+                  .on_close = fio___io_poll_on_close_schd);
+    FIO___IO.reactors[i] = r;
+    /* attached (and published) before other threads may wake the reactor */
+    fio___io_reactor = r;
+    fio___io_reactor_wakeup_init(r);
+    fio___io_reactor = NULL;
+    if (fio_thread_create(&r->thread, fio___io_reactor_work, r))
+      goto thread_failed;
+    ++FIO___IO.reactors_running;
+  }
+  FIO_LOG_DEBUG2("(%d) started %zu additional IO reactors.",
+                 fio_io_pid(),
+                 count);
+  return;
+
+thread_failed:
+  FIO_LOG_ERROR("(%d) IO reactor thread creation failed, running %d reactors.",
+                fio_io_pid(),
+                (int)FIO___IO.reactors_running + 1);
+  {
+    fio___io_reactor_s *r = FIO___IO.reactors[FIO___IO.reactors_running];
+    /* closes the wakeup IO in place, as if the thread ran and stopped */
+    fio___io_reactor = r;
+    fio_queue_perform_all(&r->queue);
+    fio___io_reactor_shutdown(r);
+    fio___io_reactor = NULL;
+    fio_timer_destroy(&r->timer);
+    fio_poll_destroy(&r->poll);
+    fio_queue_destroy(&r->queue);
+    FIO_MEM_FREE_(r->buf, FIO_IO_BUFFER_PER_WRITE);
+    FIO_MEM_FREE_(r, sizeof(*r));
+  }
+}
+
+/* Joins the additional reactor threads and frees their resources. */
+FIO_SFUNC void fio___io_reactors_stop(void) {
+  const size_t count = FIO___IO.reactors_running;
+  if (!FIO___IO.reactors)
+    return;
+  for (size_t i = 0; i < count; ++i)
+    fio_thread_join(&FIO___IO.reactors[i]->thread);
+  FIO___IO.reactors_running = 0;
+  for (size_t i = 0; i < count; ++i) {
+    fio___io_reactor_s *r = FIO___IO.reactors[i];
+    /* tasks scheduled after the reactor stopped run on the main thread */
+    fio___io_inbox_move(&r->inbox, &r->queue);
+    fio_queue_perform_all(&r->queue);
+    fio_timer_destroy(&r->timer);
+    fio___io_inbox_move(&r->inbox, &r->queue);
+    fio_queue_perform_all(&r->queue);
+    fio_poll_destroy(&r->poll);
+    fio_queue_destroy(&r->queue);
+    FIO_MEM_FREE_(r->buf, FIO_IO_BUFFER_PER_WRITE);
+    FIO_MEM_FREE_(r, sizeof(*r));
+  }
+  FIO_MEM_FREE_(FIO___IO.reactors,
+                sizeof(*FIO___IO.reactors) *
+                    ((size_t)FIO___IO.reactors_count - 1));
+  FIO___IO.reactors = NULL;
+}
+
 FIO_SFUNC void fio___io_work(int is_worker) {
   FIO___IO.is_worker = is_worker;
+  fio___io_is_reactor_thread = 1;
   FIO_LIST_EACH(fio_io_async_s, node, &FIO___IO.async, q) {
     fio___io_async_start(q);
   }
@@ -187,10 +338,12 @@ FIO_SFUNC void fio___io_work(int is_worker) {
     fio_state_callback_force(FIO_CALL_PRE_START);
   /* Performing the queued tasks will spawn any workers waiting to be spawned */
   fio_queue_perform_all(&FIO___IO.queue);
+  /* before any thread (reactor, ON_START) may call `fio_io_defer` */
+  fio___io_wakeup_init();
   if (is_worker) {
+    fio___io_reactors_start();
     fio_state_callback_force(FIO_CALL_ON_START);
   }
-  fio___io_wakeup_init();
   FIO_LOG_DEBUG2("(%d) IO reactor work loop starting (is_worker: %d).",
                  fio_io_pid(),
                  is_worker);
@@ -205,6 +358,9 @@ FIO_SFUNC void fio___io_work(int is_worker) {
   FIO_LIST_EACH(fio_io_async_s, node, &FIO___IO.async, q) {
     fio___io_async_stop(q);
   }
+  fio___io_reactors_stop();
+  /* collect tasks deferred by (now joined) worker threads */
+  fio___io_inbox_drain();
   /* signal all child workers to terminate, parent is going away. */
   FIO___LOCK_LOCK(FIO___IO.lock);
   FIO_LIST_EACH(fio___io_pid_s, node, &FIO___IO.pids, pos) {
@@ -215,8 +371,10 @@ FIO_SFUNC void fio___io_work(int is_worker) {
 
   fio_queue_perform_all(&FIO___IO.queue);
   fio_state_callback_force(FIO_CALL_ON_STOP);
+  fio___io_inbox_drain();
   fio_queue_perform_all(&FIO___IO.queue);
   FIO___IO.workers = 0;
+  fio___io_is_reactor_thread = 0;
 }
 
 /* *****************************************************************************
@@ -352,6 +510,7 @@ static void fio___io_spawn_workers_task(void *ignr_1, void *ignr_2) {
   FIO_LIST_EACH(fio_io_async_s, node, &FIO___IO.async, q) {
     fio___io_async_stop(q);
   }
+  fio___io_inbox_drain();
   fio_queue_perform_all(&FIO___IO.queue);
 
   /* perform forking procedure with the stop flag reset. */
@@ -387,6 +546,11 @@ Starting / Stopping the IO Reactor
 SFUNC void fio_io_add_workers(int workers) {
   if (!workers || !fio_io_is_master())
     return;
+  if (FIO___IO.reactors_running) {
+    FIO_LOG_ERROR("(%d) can't fork workers while IO reactor threads run.",
+                  fio_io_pid());
+    return;
+  }
   fio_atomic_add(&FIO___IO.to_spawn, (uint32_t)fio_io_workers(workers));
   fio_queue_push_urgent(&FIO___IO.queue, fio___io_spawn_workers_task);
 }
@@ -455,6 +619,20 @@ SFUNC uint16_t fio_io_workers(int workers) {
   return (uint16_t)workers;
 }
 
+/** Sets the number of IO reactors (threads) per process, see header. */
+SFUNC uint16_t fio_io_reactors_set(int reactors) {
+  if (FIO___IO.reactors_running) {
+    FIO_LOG_ERROR("fio_io_reactors_set can't be called while reactors run.");
+    return FIO___IO.reactors_count;
+  }
+  reactors = (int)fio_io_workers(reactors);
+  FIO___IO.reactors_count = (uint16_t)(reactors + !reactors);
+  return FIO___IO.reactors_count;
+}
+
+/** Returns the number of IO reactors (threads) per process. */
+SFUNC uint16_t fio_io_reactors(void) { return FIO___IO.reactors_count; }
+
 /** Retiers all existing workers and restarts with the number of workers. */
 SFUNC void fio___io_restart(void *workers_, void *ignr_) {
   int workers = (int)(uintptr_t)workers_;
@@ -488,6 +666,7 @@ SFUNC void fio___io_restart(void *workers_, void *ignr_) {
   FIO___LOCK_UNLOCK(FIO___IO.lock);
   /* switch to single mode? */
   if (!workers) {
+    fio___io_reactors_start();
     fio_state_callback_force(FIO_CALL_ON_START);
     FIO___IO.is_worker = 1;
   }
@@ -521,6 +700,9 @@ typedef struct {
   size_t ref_count;
   size_t url_len;
   uint8_t hide_from_log;
+  /* additional reactors open their own `SO_REUSEPORT` socket */
+  uint8_t reuse_port;
+  volatile uint8_t stopped;
   char url[];
 } fio___io_listen_s;
 
@@ -532,12 +714,12 @@ static fio___io_listen_s *fio___io_listen_dup(fio___io_listen_s *l) {
 }
 
 FIO_SFUNC void fio___io_listen_attach_task(void *l_);
-static void fio___io_listen_free(void *l_) {
+static void fio___io_listen_free(void *l_);
+
+/* Releases a reference without stopping the listener. */
+static void fio___io_listen_unref(void *l_, void *ignr_) {
   fio___io_listen_s *l = (fio___io_listen_s *)l_;
-  if (l->io) {
-    fio_io_close(l->io);
-    l->io = NULL;
-  }
+  (void)ignr_;
   if (fio_atomic_sub(&l->ref_count, 1))
     return;
 
@@ -578,6 +760,38 @@ static void fio___io_listen_free(void *l_) {
   FIO_MEM_FREE_(l, sizeof(*l) + l->url_len + 1);
 }
 
+static fio_io_protocol_s FIO___IO_LISTEN_REACTOR_PROTOCOL;
+
+/* Closes the listening sockets of the calling (additional) reactor. */
+FIO_SFUNC void fio___io_listen_reactor_stop_task(void *l_, void *ignr_) {
+  if (fio___io_reactor) {
+    FIO_LIST_EACH(fio_io_s, node, &fio___io_reactor->ios, io) {
+      if (io->pr == &FIO___IO_LISTEN_REACTOR_PROTOCOL && io->udata == l_)
+        fio_io_close(io);
+    }
+  }
+  /* the listener is destroyed on the main reactor's thread */
+  fio_io_defer(fio___io_listen_unref, l_, NULL);
+  (void)ignr_;
+}
+
+static void fio___io_listen_free(void *l_) {
+  fio___io_listen_s *l = (fio___io_listen_s *)l_;
+  if (l->io) {
+    fio_io_close(l->io);
+    l->io = NULL;
+  }
+  fio_atomic_exchange(&l->stopped, 1); /* read by the other reactors */
+  for (size_t i = 0; i < FIO___IO.reactors_running; ++i) {
+    fio_atomic_add(&l->ref_count, 1);
+    fio___io_reactor_defer(FIO___IO.reactors[i],
+                           fio___io_listen_reactor_stop_task,
+                           l,
+                           NULL);
+  }
+  fio___io_listen_unref(l, NULL);
+}
+
 SFUNC void fio_io_listen_stop(fio_io_listener_s *listener) {
   if (listener)
     fio___io_listen_free((fio___io_listen_s *)listener);
@@ -623,16 +837,21 @@ static void fio___io_listen_on_data_task(void *io_, void *ignr_) {
   fio_socket_i fd;
   fio___io_listen_s *l = (fio___io_listen_s *)fio_io_udata(io);
   fio_io_unsuspend(io);
-  while (FIO_SOCK_FD_ISVALID(fd = fio_sock_accept(fio_io_fd(io), NULL, NULL))) {
+  while (FIO_SOCK_FD_ISVALID(
+      fd = fio_poll_accept(fio___io_poll_of(io), fio_io_fd(io)))) {
     // FIO_LOG_DDEBUG2("(%d) accepted new connection with fd %d",
     //                 fio_io_pid(),
     //                 fd);
-    fio_io_attach_fd(fd, l->protocol, l->udata, l->tls_ctx);
+    fio___io_attach_fd(fd,
+                       l->protocol,
+                       l->udata,
+                       l->tls_ctx,
+                       FIO___IO_FLAG_POLL_IO);
   }
   fio___io_free2(io);
 }
 static void fio___io_listen_on_data_task_reschd(void *io_, void *ignr_) {
-  fio_io_defer(fio___io_listen_on_data_task, io_, ignr_);
+  fio_io_defer_to((fio_io_s *)io_, fio___io_listen_on_data_task, io_, ignr_);
 }
 static void fio___io_listen_on_attach(fio_io_s *io) {
   fio___io_listen_s *l = (fio___io_listen_s *)(io->udata);
@@ -681,6 +900,37 @@ static fio_io_protocol_s FIO___IO_LISTEN_PROTOCOL = {
     .on_shutdown = fio___io_listen_on_shutdown,
 };
 
+/* listening sockets of the additional reactors (the main one logs & starts) */
+static void fio___io_listen_reactor_on_attach(fio_io_s *io) {
+  uint8_t stopped;
+  fio_atomic_load(stopped, &((fio___io_listen_s *)(io->udata))->stopped);
+  if (stopped)
+    fio_io_close(io);
+}
+static void fio___io_listen_reactor_on_data(fio_io_s *io) {
+  fio___io_listen_s *l = (fio___io_listen_s *)(io->udata);
+  /* `l->queue` belongs to the main reactor, read the (immutable) setting */
+  if (l->queue_for_accept && l->queue_for_accept->q != &FIO___IO.queue) {
+    fio_io_suspend(io);
+    fio_queue_push(l->queue_for_accept->q,
+                   fio___io_listen_on_data_task_reschd,
+                   fio___io_dup2(io));
+    return;
+  }
+  fio___io_listen_on_data_task(fio___io_dup2(io), NULL);
+}
+static void fio___io_listen_reactor_on_close(void *buffer, void *l) {
+  fio_io_defer(fio___io_listen_unref, l, NULL);
+  (void)buffer;
+}
+
+static fio_io_protocol_s FIO___IO_LISTEN_REACTOR_PROTOCOL = {
+    .on_attach = fio___io_listen_reactor_on_attach,
+    .on_data = fio___io_listen_reactor_on_data,
+    .on_close = fio___io_listen_reactor_on_close,
+    .on_timeout = fio_io_touch,
+};
+
 FIO_SFUNC void fio___io_listen_assert_dup(fio_socket_i fd,
                                           fio_socket_i original_fd) {
 #if FIO_OS_WIN
@@ -700,6 +950,32 @@ FIO_SFUNC void fio___io_listen_assert_dup(fio_socket_i fd,
 #endif
 }
 
+/* Attaches a listening socket to the calling (additional) reactor. */
+FIO_SFUNC void fio___io_listen_attach_reactor(void *l_, void *ignr_) {
+  fio___io_listen_s *l = (fio___io_listen_s *)l_;
+  fio_socket_i fd = FIO_SOCKET_INVALID;
+  uint8_t stopped;
+  fio_atomic_load(stopped, &l->stopped);
+  if (!fio___io_reactor || stopped)
+    goto stopped;
+  if (l->reuse_port) /* an accept queue of its own, balanced by the kernel */
+    fd = fio_sock_open2(l->url,
+                        FIO_SOCK_SERVER | FIO_SOCK_TCP | FIO_SOCK_REUSE_PORT);
+  if (!FIO_SOCK_FD_ISVALID(fd)) { /* share the main reactor's accept queue */
+    fd = fio_sock_dup(l->fd);
+    fio___io_listen_assert_dup(fd, l->fd);
+  }
+  fio___io_attach_fd(fd,
+                     &FIO___IO_LISTEN_REACTOR_PROTOCOL,
+                     l,
+                     NULL,
+                     FIO___IO_FLAG_POLL_ACCEPT);
+  return;
+stopped:
+  fio_io_defer(fio___io_listen_unref, l, NULL);
+  (void)ignr_;
+}
+
 FIO_SFUNC void fio___io_listen_attach_task_deferred(void *l_, void *ignr_) {
   fio___io_listen_s *l = (fio___io_listen_s *)l_;
   l = fio___io_listen_dup(l);
@@ -707,7 +983,17 @@ FIO_SFUNC void fio___io_listen_attach_task_deferred(void *l_, void *ignr_) {
   fio___io_listen_assert_dup(fd, l->fd);
   FIO_LOG_DEBUG2("(%d) Called dup to attach new fd as a listening socket.",
                  (int)fio_io_pid());
-  l->io = fio_io_attach_fd(fd, &FIO___IO_LISTEN_PROTOCOL, l, NULL);
+  l->io = fio___io_attach_fd(fd,
+                             &FIO___IO_LISTEN_PROTOCOL,
+                             l,
+                             NULL,
+                             FIO___IO_FLAG_POLL_ACCEPT);
+  /* every additional reactor accepts connections as well */
+  for (size_t i = 0; i < FIO___IO.reactors_running; ++i)
+    fio___io_reactor_defer(FIO___IO.reactors[i],
+                           fio___io_listen_attach_reactor,
+                           fio___io_listen_dup(l),
+                           NULL);
   (void)ignr_;
 }
 
@@ -810,7 +1096,12 @@ test_url:
   if (should_free_tls)
     fio_io_tls_free(args.tls);
 
-  l->fd = fio_sock_open2(l->url, FIO_SOCK_SERVER | FIO_SOCK_TCP);
+  /* `SO_REUSEPORT` requires a fixed port (port 0 would differ per socket) */
+  l->reuse_port = (FIO___IO.reactors_count > 1 && url.port.len &&
+                   !(url.port.len == 1 && url.port.buf[0] == '0'));
+  l->fd = fio_sock_open2(l->url,
+                         FIO_SOCK_SERVER | FIO_SOCK_TCP |
+                             (l->reuse_port ? FIO_SOCK_REUSE_PORT : 0));
   if (!FIO_SOCK_FD_ISVALID(l->fd)) {
     fio___io_listen_free(l);
     return (fio_io_listener_s *)(l = NULL);
@@ -877,7 +1168,7 @@ FIO_SFUNC void fio___connecting_on_ready(fio_io_s *io) {
    * fio___io_free_with_flush), so it must be handed a fresh dup2. */
   fio___io_protocol_set((void *)fio___io_dup2(io), (void *)c->upr);
   c->on_failed = NULL;
-  fio___io_defer_no_wakeup(fio___connecting_on_close, NULL, (void *)c);
+  fio___io_defer_io(io, fio___connecting_on_close, NULL, (void *)c);
 }
 
 void fio_io_connect___(void); /* IDE Marker */
@@ -885,9 +1176,9 @@ SFUNC fio_io_s *fio_io_connect FIO_NOOP(fio_io_connect_args_s args) {
   int should_free_tls = !args.tls;
   if (!args.protocol || !args.url) {
     if (args.on_failed)
-      fio___io_defer_no_wakeup((void (*)(void *, void *))args.on_failed,
-                               args.protocol,
-                               args.udata);
+      fio___io_defer_here((void (*)(void *, void *))args.on_failed,
+                          args.protocol,
+                          args.udata);
     return NULL;
   }
   if (!args.timeout)
@@ -925,10 +1216,15 @@ SFUNC fio_io_s *fio_io_connect FIO_NOOP(fio_io_connect_args_s args) {
   fio_io_s *io = NULL;
   if (FIO_SOCK_FD_ISVALID(fd)) {
     /* the TLS context's ownership transfers to the reactor (attach_fd) */
-    io = fio_io_attach_fd(fd, &c->protocol, c, c->tls_ctx);
+    /* datagrams keep their boundaries only when written directly */
+    uint32_t flags = FIO___IO_FLAG_POLL_IO;
+    if ((c->url[0] | 32) == 'u' && (c->url[1] | 32) == 'd' &&
+        (c->url[2] | 32) == 'p' && c->url[3] == ':')
+      flags = 0;
+    io = fio___io_attach_fd(fd, &c->protocol, c, c->tls_ctx, flags);
   } else {
     /* never attached. Teardown in IO thread for safety. */
-    fio___io_defer_no_wakeup(fio___connecting_on_close, NULL, c);
+    fio___io_defer_here(fio___connecting_on_close, NULL, c);
   }
   if (should_free_tls)
     fio_io_tls_free(args.tls);
@@ -28,6 +28,10 @@ Copyright and License: see header file (000 copyright.h) or top of file
 /* maximum message length */
 #define FIO_IPC_MAX_LENGTH (128ULL * 1024U * 1024U)
 #endif
+#ifndef FIO_IPC_BATCH_LIMIT
+/* maximum length of a batch of coalesced messages (see fio_ipc_batch_set) */
+#define FIO_IPC_BATCH_LIMIT (64U * 1024U)
+#endif
 
 /* *****************************************************************************
 IPC (Inter Process Communication) Settings / Controls
@@ -43,6 +47,38 @@ SFUNC const char *fio_ipc_url(void);
  */
 SFUNC int fio_ipc_url_set(const char *url);
 
+/**
+ * Sets the capacity (in bytes, per direction) of the shared memory rings used
+ * for master <=> worker IPC. Zero (the default) keeps using only the socket.
+ *
+ * Each worker gets a pair of single producer / single consumer rings, mapped
+ * before the worker is forked, and receivers are woken through an `eventfd`.
+ * The IPC socket is kept for connection lifetime and keepalive.
+ *
+ * Can only be called on the master process and only before the IO reactor.
+ * Returns -1 on error or where unsupported (Linux only).
+ */
+SFUNC int fio_ipc_shm_set(size_t capacity);
+
+/** Returns the shared memory ring capacity (0 if the socket is used). */
+SFUNC size_t fio_ipc_shm(void);
+
+/**
+ * Coalesces master <=> worker IPC messages written during the same reactor
+ * cycle into a single frame, authenticated and encrypted once.
+ *
+ * `max_delay` (in microseconds) caps how long a message waits for its batch
+ * while the IO thread is busy. Zero (the default) writes each message as its
+ * own frame. Batches are limited to `FIO_IPC_BATCH_LIMIT` bytes.
+ *
+ * Call before the IO reactor starts (workers inherit the setting).
+ * Returns -1 on error.
+ */
+SFUNC int fio_ipc_batch_set(uint32_t max_delay);
+
+/** Returns the IPC batching latency cap (0 if batching is disabled). */
+SFUNC uint32_t fio_ipc_batch(void);
+
 /* *****************************************************************************
 IPC (Inter Process Communication) Types
 ***************************************************************************** */
@@ -288,6 +324,24 @@ SFUNC void fio_ipc_cluster_connect(const char *url);
  * */
 SFUNC uint16_t fio_ipc_cluster_port(void);
 
+/* *****************************************************************************
+Allocator Telemetry (requires FIO_MALLOC as the global allocator)
+***************************************************************************** */
+#if defined(H___FIO_MALLOC___H)
+/**
+ * Collects `fio_malloc_stats` from the master process and all its workers.
+ *
+ * `on_stats` is called (on the master process) once per process that replied.
+ * Use `fio_malloc_stats_add` to aggregate the results.
+ *
+ * Must be called by the master process.
+ */
+SFUNC void fio_ipc_malloc_stats(void (*on_stats)(int pid,
+                                                 fio_malloc_stats_s *stats,
+                                                 void *udata),
+                                void *udata);
+#endif
+
 /* *****************************************************************************
 IPC Flags - Used for message routing, settable in routing_flags
 
@@ -310,6 +364,8 @@ These are mostly for internal use, but made available for advance usage with
 /** If set, this is an internal ping/keepalive message (not dispatched to user)
  */
 #define FIO_IPC_FLAG_PING ((uint16_t)1UL << 6)
+/** If set, this is an internal batch of coalesced messages (not dispatched) */
+#define FIO_IPC_FLAG_BATCH ((uint16_t)1UL << 7)
 /** If flag is set == 1, otherwise zero */
 #define FIO_IPC_FLAG_TEST(msg, flag) (((msg)->routing_flags & flag) == flag)
 /** If flag is set == flag, otherwise zero */
@@ -436,6 +492,40 @@ FIO_IFUNC int fio___ipc_cluster_filter_window(uint64_t timestamp) {
   const uint64_t max = tick + window;
   return (int)0 - (int)(timestamp > max || timestamp < min);
 }
+/* *****************************************************************************
+IPC Shared Memory Transport - Types
+***************************************************************************** */
+
+/* a single producer / single consumer byte ring, data follows the header */
+typedef struct {
+  volatile uint64_t head; /* total bytes written (producer) */
+  uint64_t pad_0[7];
+  volatile uint64_t tail; /* total bytes read (consumer) */
+  uint64_t pad_1[7];
+  volatile uint32_t rx_waiting; /* consumer sleeps: signal after writing */
+  volatile uint32_t tx_waiting; /* producer waits for room: signal on read */
+  uint64_t pad_2[7];
+} fio___ipc_shm_ring_s;
+
+/* per worker rings (process local state), followed by a parser + buffer */
+typedef struct fio___ipc_shm_s {
+  FIO_LIST_NODE node;       /* master: slots not yet closed */
+  fio___ipc_shm_ring_s *rx; /* the ring this process reads */
+  fio___ipc_shm_ring_s *tx; /* the ring this process writes */
+  fio_io_s *wake;           /* eventfd IO waking this process (owns slot) */
+  fio_io_s *io;             /* master: bound IPC connection (borrowed) */
+  void *map;                /* shared mapping holding both rings */
+  size_t map_len;           /* length of the shared mapping */
+  size_t mask;              /* ring capacity - 1 */
+  size_t out_offset;        /* bytes of the first `out` message written */
+  fio_queue_s out;          /* messages waiting for room in `tx` */
+  int fd[2];                /* eventfd: [0] wakes the master, [1] the worker */
+  uint32_t ref;             /* wake IO + bound IPC connection */
+  uint8_t self;             /* fd[self] is polled by this process */
+  uint8_t rx_ready;         /* `rx` may be drained */
+  uint8_t tx_ready;         /* worker: writes use `tx` */
+} fio___ipc_shm_s;
+
 /* *****************************************************************************
 IPC Global State
 ***************************************************************************** */
@@ -455,9 +545,34 @@ static struct {
   fio___ipc_cluster_filter_s peers;     /* connected peers */
   fio_u128 uuid;                        /* instance ID peers */
   uint16_t cluster_port;                /* last port number in cluster_listen */
+  size_t shm_capacity;                  /* shared memory ring size (0 = off) */
+  fio___ipc_shm_s *shm;                 /* master: next fork's / worker: own */
+  FIO_LIST_HEAD shm_list;               /* master: rings of every worker */
+  fio_io_protocol_s protocol_shm;       /* eventfd wakeup protocol */
+  uint32_t batch_delay;                 /* batching latency cap (0 = off) */
   char ipc_url[FIO_IPC_URL_MAX_LENGTH]; /* IPC socket path */
 } FIO___IPC;
 
+/* Returns the shared memory rings replacing the socket of `io`, if any. */
+FIO_IFUNC fio___ipc_shm_s *fio___ipc_shm_of(fio_io_s *io) {
+  if (!FIO___IPC.shm_capacity || !io)
+    return NULL;
+  if (fio_io_is_master())
+    return (fio_io_protocol(io) == &FIO___IPC.protocol_ipc)
+               ? (fio___ipc_shm_s *)fio_io_udata(io)
+               : NULL;
+  if (io == FIO___IPC.worker_connection && FIO___IPC.shm &&
+      FIO___IPC.shm->tx_ready)
+    return FIO___IPC.shm;
+  return NULL;
+}
+
+/* implemented in "IPC Core - Shared Memory Transport" */
+FIO_SFUNC void fio___ipc_shm_send_task(void *ipc_, void *io_);
+FIO_SFUNC void fio___ipc_shm_unbind(fio___ipc_shm_s *s);
+/* implemented in "IPC Core - Batching" */
+FIO_SFUNC void fio___ipc_batch_task(void *ipc_, void *io_);
+
 /* *****************************************************************************
 IPC Settings
 ***************************************************************************** */
@@ -530,6 +645,17 @@ SFUNC int fio_ipc_url_set(const char *url) {
   return 0;
 }
 
+/** Sets the IPC batching latency cap (microseconds), before the reactor. */
+SFUNC int fio_ipc_batch_set(uint32_t max_delay) {
+  if (fio_io_is_running())
+    return -1;
+  FIO___IPC.batch_delay = max_delay;
+  return 0;
+}
+
+/** Returns the IPC batching latency cap (0 if batching is disabled). */
+SFUNC uint32_t fio_ipc_batch(void) { return FIO___IPC.batch_delay; }
+
 /* *****************************************************************************
 IPC Lifetime Management
 ***************************************************************************** */
@@ -761,6 +887,11 @@ FIO_IFUNC int fio_ipc_decrypt(fio_ipc_s *m) {
   return r;
 }
 
+/** Returns 1 if the message is in its encrypted state (runs on IO thread). */
+FIO_IFUNC int fio___ipc_is_encrypted(fio_ipc_s *m) {
+  return FIO_IPC_FLAG_TEST(m, FIO_IPC_FLAG_ENCRYPTED);
+}
+
 #undef FIO_IPC_FLAG_ENCRYPTED
 /* *****************************************************************************
 IPC / RPC - Op-Codes
@@ -839,17 +970,37 @@ SFUNC void fio___ipc_execute_task(fio_ipc_s *ipc, void *ignr_) {
 IPC Core - Sending
 ***************************************************************************** */
 
-FIO_SFUNC void fio___ipc_send_each_task(fio_io_s *to, void *ipc_) {
-  fio_ipc_s *ipc = (fio_ipc_s *)ipc_;
-  if (to == ipc->from)
+/* Encrypts and writes a message as its own frame, consuming the reference. */
+FIO_SFUNC void fio___ipc_write_frame(fio_io_s *to, fio_ipc_s *m) {
+  fio_ipc_encrypt(m);
+  if (fio___ipc_shm_of(to)) { /* rings are only accessed by the IO thread */
+    fio_io_defer(fio___ipc_shm_send_task, m, fio_io_dup(to));
     return;
+  }
   fio_io_write2(to,
-                .buf = fio_ipc_dup(ipc),
+                .buf = m,
                 .offset = FIO_PTR_FIELD_OFFSET(fio_ipc_s, len),
-                .len = fio___ipc_wire_length(ipc->len),
+                .len = fio___ipc_wire_length(m->len),
                 .dealloc = (void (*)(void *))fio___ipc_free_in_io_thread);
 }
 
+/* Writes a message to a peer, consuming the reference. */
+FIO_SFUNC void fio___ipc_write(fio_io_s *to, fio_ipc_s *m) {
+  if (FIO___IPC.batch_delay &&
+      fio_io_protocol(to) == &FIO___IPC.protocol_ipc) { /* local connection */
+    fio_io_defer(fio___ipc_batch_task, m, fio_io_dup(to));
+    return;
+  }
+  fio___ipc_write_frame(to, m);
+}
+
+FIO_SFUNC void fio___ipc_send_each_task(fio_io_s *to, void *ipc_) {
+  fio_ipc_s *ipc = (fio_ipc_s *)ipc_;
+  if (to == ipc->from)
+    return;
+  fio___ipc_write(to, fio_ipc_dup(ipc));
+}
+
 FIO_SFUNC void fio___ipc_send_master_task(void *ipc_, void *ignr_) {
   fio_ipc_s *ipc = (fio_ipc_s *)ipc_;
   size_t count = 0;
@@ -887,8 +1038,7 @@ SFUNC void fio_ipc_send(fio_ipc_s *ipc) {
     if (!FIO_IPC_FLAG_TEST(ipc, FIO_IPC_FLAG_WORKERS) &&
         !FIO_IPC_FLAG_TEST(ipc, FIO_IPC_FLAG_CLUSTER))
       goto master_only;
-    fio_ipc_encrypt(ipc);
-    /* to loop on protocol IO we must run in the IO thread */
+    /* to loop on protocol IO we must run in the IO thread (encrypts there) */
     fio_io_defer(fio___ipc_send_master_task, ipc, NULL);
     return;
   }
@@ -921,13 +1071,7 @@ SFUNC void fio_ipc_send_to(fio_io_s *to, fio_ipc_s *m) {
   //                 (size_t)m->len,
   //                 (size_t)FIO_PTR_FIELD_OFFSET(fio_ipc_s, len));
 
-  /* Encrypt message */
-  fio_ipc_encrypt(m);
-  fio_io_write2(to,
-                .buf = m,
-                .offset = FIO_PTR_FIELD_OFFSET(fio_ipc_s, len),
-                .len = fio___ipc_wire_length(m->len),
-                .dealloc = (void (*)(void *))fio___ipc_free_in_io_thread);
+  fio___ipc_write(to, m);
   return;
 
 free_send:
@@ -938,11 +1082,8 @@ free_send:
 IPC Core - Call and Reply
 ***************************************************************************** */
 
-void fio_ipc_reply___(void); /* IDE Marker */
-/** Send reply to caller */
-SFUNC void fio_ipc_reply FIO_NOOP(fio_ipc_reply_args_s args) {
-  if (!args.ipc)
-    return;
+/** Authors a reply without sending it (returns NULL on error). */
+FIO_SFUNC fio_ipc_s *fio___ipc_reply_new(fio_ipc_reply_args_s args) {
   fio_ipc_args_s ar = {
       .timestamp = args.timestamp,
       .id = (args.id ? args.id : args.ipc->id),
@@ -953,12 +1094,19 @@ SFUNC void fio_ipc_reply FIO_NOOP(fio_ipc_reply_args_s args) {
       .flags = (args.flags_set ? args.flags : args.ipc->flags),
       .data = args.data,
   };
-
-  /* Author IPC message */
-  fio_ipc_s *reply = fio___ipc_new_author(
+  return fio___ipc_new_author(
       &ar,
       (args.ipc->routing_flags & (FIO_IPC_FLAG_CLUSTER | FIO_IPC_FLAG_OPCODE)) |
           FIO_IPC_FLAG_REPLY | FIO_IPC_FLAG_IF(args.done, FIO_IPC_FLAG_DONE));
+}
+
+void fio_ipc_reply___(void); /* IDE Marker */
+/** Send reply to caller */
+SFUNC void fio_ipc_reply FIO_NOOP(fio_ipc_reply_args_s args) {
+  if (!args.ipc)
+    return;
+  /* Author IPC message */
+  fio_ipc_s *reply = fio___ipc_reply_new(args);
   if (!reply)
     return;
 
@@ -983,6 +1131,16 @@ typedef struct {
   char buffer[];         /* FIO_IPC_BUFFER_LEN for small messages */
 } fio___ipc_parser_s;
 
+/** Outgoing batch of a local IPC connection (precedes the parser) */
+typedef struct {
+  fio_ipc_s **msg;    /* messages waiting to be written */
+  uint32_t count;     /* messages in the batch */
+  uint32_t capa;      /* capacity of `msg` */
+  uint32_t bytes;     /* wire length of the batched messages */
+  uint32_t scheduled; /* a flush task is pending */
+  uint64_t start;     /* time the first message was batched (microseconds) */
+} fio___ipc_batch_s;
+
 FIO_IFUNC fio_u128 *fio___ipc_cluster_uuid(fio_io_s *io) {
   return (fio_u128 *)fio_io_buffer(io);
 }
@@ -990,9 +1148,14 @@ FIO_IFUNC fio___ipc_parser_s *fio___ipc_cluster_parser(fio_io_s *io) {
   return (fio___ipc_parser_s *)(fio___ipc_cluster_uuid(io) + 1);
 }
 
-/** Get parser from IO buffer */
+/** Get batch from IO buffer (local IPC connections) */
+FIO_IFUNC fio___ipc_batch_s *fio___ipc_batch(fio_io_s *io) {
+  return (fio___ipc_batch_s *)fio_io_buffer(io);
+}
+
+/** Get parser from IO buffer (local IPC connections) */
 FIO_IFUNC fio___ipc_parser_s *fio___ipc_parser(fio_io_s *io) {
-  return (fio___ipc_parser_s *)fio_io_buffer(io);
+  return (fio___ipc_parser_s *)(fio___ipc_batch(io) + 1);
 }
 
 /** Initialize parser */
@@ -1010,30 +1173,39 @@ FIO_IFUNC void fio___ipc_parser_destroy(fio___ipc_parser_s *p) {
 }
 
 FIO_SFUNC void fio___ipc_on_attach(fio_io_s *io) {
-  fio___ipc_parser_s *p = fio___ipc_parser(io);
-  fio___ipc_parser_init(p);
+  *fio___ipc_batch(io) = (fio___ipc_batch_s){0};
+  fio___ipc_parser_init(fio___ipc_parser(io));
 }
 
 /* *****************************************************************************
 IPC Core - Ping / Keepalive
 ***************************************************************************** */
 
-/* Shared builder — random junk fills the encrypted pointer fields.
- * No data payload: len=0, eliminating redundant random bytes. */
-FIO_SFUNC void fio___ipc_send_ping_frame(fio_io_s *io, uint16_t routing_flags) {
-  fio_ipc_s *msg = fio___ipc_new(16); /* no data payload, just header + MAC */
+/* Internal message builder — random junk fills the encrypted pointer fields.
+ * The `len` bytes of data are left for the caller to fill. */
+FIO_SFUNC fio_ipc_s *fio___ipc_new_internal(uint32_t len,
+                                            uint16_t routing_flags) {
+  fio_ipc_s *msg = fio___ipc_new(len + 16); /* header + data + MAC */
   if (!msg)
-    return;
+    return msg;
   /* Fill encrypted pointer fields with random junk to defeat known-plaintext */
   fio_rand_bytes(&msg->call,
                  sizeof(msg->call) + sizeof(msg->on_reply) +
                      sizeof(msg->on_done) + sizeof(msg->udata));
   msg->from = NULL;
-  msg->len = 0;
+  msg->len = len;
   msg->flags = 0;
   msg->routing_flags = routing_flags;
   msg->timestamp = (uint64_t)fio_io_last_tick();
   msg->id = fio_rand64();
+  return msg;
+}
+
+/* No data payload: len=0, eliminating redundant random bytes. */
+FIO_SFUNC void fio___ipc_send_ping_frame(fio_io_s *io, uint16_t routing_flags) {
+  fio_ipc_s *msg = fio___ipc_new_internal(0, routing_flags);
+  if (!msg)
+    return;
   fio_ipc_send_to(io, msg);
 }
 
@@ -1100,6 +1272,142 @@ FIO_SFUNC void fio___ipc_on_timeout_rpc(fio_io_s *io) {
   fio___ipc_send_ping(io, p);
 }
 
+/* *****************************************************************************
+IPC Core - Batching (local connections, see `fio_ipc_batch_set`)
+
+Messages written to a local IPC connection are collected by the IO thread and
+written once per reactor cycle as the data of a single `FIO_IPC_FLAG_BATCH`
+message, so the batch is authenticated and encrypted once. Batched messages
+keep their wire format (a message shared with a cluster connection may already
+be encrypted, in which case it is decrypted on its own by the receiver).
+***************************************************************************** */
+
+/** Frees the messages of a closed connection's batch. */
+FIO_SFUNC void fio___ipc_batch_destroy(fio___ipc_batch_s *b) {
+  for (uint32_t i = 0; i < b->count; ++i)
+    fio___ipc_free_in_io_thread(b->msg[i]);
+  FIO_MEM_FREE(b->msg, sizeof(*b->msg) * b->capa);
+  *b = (fio___ipc_batch_s){0};
+}
+
+/** Writes the batched messages, as a single frame when possible. */
+FIO_SFUNC void fio___ipc_batch_flush(fio_io_s *io) {
+  fio___ipc_batch_s *b = fio___ipc_batch(io);
+  fio_ipc_s *m = NULL;
+  uint32_t count = b->count;
+  char *pos;
+  if (!count)
+    return;
+  b->count = 0;
+  if (count > 1)
+    m = fio___ipc_new_internal(b->bytes, FIO_IPC_FLAG_BATCH);
+  b->bytes = 0;
+  if (!m)
+    goto each_message;
+  pos = m->data;
+  for (uint32_t i = 0; i < count; ++i) {
+    fio_ipc_s *c = b->msg[i];
+    uint32_t len = fio___ipc_wire_length(c->len);
+    if (fio___ipc_is_encrypted(c)) {
+      FIO_MEMCPY(pos, &c->len, len);
+    } else { /* the MAC is unused */
+      FIO_MEMCPY(pos, &c->len, len - 16);
+      FIO_MEMSET(pos + len - 16, 0, 16);
+    }
+    pos += len;
+    fio___ipc_free_in_io_thread(c);
+  }
+  fio___ipc_write_frame(io, m);
+  return;
+
+each_message:
+  for (uint32_t i = 0; i < count; ++i)
+    fio___ipc_write_frame(io, b->msg[i]);
+}
+
+FIO_SFUNC void fio___ipc_batch_flush_task(void *io_, void *ignr_) {
+  fio_io_s *io = (fio_io_s *)io_;
+  fio___ipc_batch(io)->scheduled = 0;
+  fio___ipc_batch_flush(io);
+  fio_io_free(io);
+  (void)ignr_;
+}
+
+/** Adds a message to the batch of a local connection (IO thread). */
+FIO_SFUNC void fio___ipc_batch_task(void *ipc_, void *io_) {
+  fio_ipc_s *m = (fio_ipc_s *)ipc_;
+  fio_io_s *io = (fio_io_s *)io_;
+  fio___ipc_batch_s *b = fio___ipc_batch(io);
+  uint32_t len = fio___ipc_wire_length(m->len);
+  if (!fio_io_is_open(io) || len > (FIO_IPC_BATCH_LIMIT >> 1))
+    goto write_now;
+  if (b->bytes + len > FIO_IPC_BATCH_LIMIT)
+    fio___ipc_batch_flush(io);
+  if (b->count == b->capa) {
+    uint32_t capa = b->capa ? (b->capa << 1) : 32;
+    void *tmp = FIO_MEM_REALLOC(b->msg,
+                                sizeof(*b->msg) * b->capa,
+                                sizeof(*b->msg) * capa,
+                                sizeof(*b->msg) * b->count);
+    if (!tmp)
+      goto write_now;
+    b->msg = (fio_ipc_s **)tmp;
+    b->capa = capa;
+  }
+  if (!b->count)
+    b->start = (uint64_t)fio_time_micro();
+  b->msg[b->count++] = m;
+  b->bytes += len;
+  if (b->count > 1 &&
+      (uint64_t)fio_time_micro() - b->start >= FIO___IPC.batch_delay) {
+    fio___ipc_batch_flush(io); /* the IO thread is busy, don't wait for it */
+  } else if (!b->scheduled) {
+    b->scheduled = 1;
+    fio_io_defer(fio___ipc_batch_flush_task, fio_io_dup(io), NULL);
+  }
+  fio_io_free(io);
+  return;
+
+write_now: /* flushing first keeps the messages in order */
+  fio___ipc_batch_flush(io);
+  fio___ipc_write_frame(io, m);
+  fio_io_free(io);
+}
+
+/** Executes every message of a received batch using `fn`. */
+FIO_SFUNC void fio___ipc_batch_unpack(fio_ipc_s *batch,
+                                      void (*fn)(void *ipc, void *io)) {
+  fio_io_s *io = batch->from;
+  uint32_t pos = 0;
+  while (pos < batch->len) {
+    fio_ipc_s *m;
+    uint32_t len, wire;
+    if (batch->len - pos < fio___ipc_wire_length(0))
+      goto malformed;
+    len = fio_buf2u32_le(batch->data + pos);
+    wire = fio___ipc_wire_length(len);
+    if (len > batch->len || wire > batch->len - pos)
+      goto malformed;
+    m = fio___ipc_new(len + 16);
+    FIO_ASSERT_ALLOC(m);
+    FIO_MEMCPY(&m->len, batch->data + pos, wire);
+    pos += wire;
+    m->from = fio_io_dup(io); /* ref ownership passed to `fn` */
+    if (FIO_IPC_FLAG_TEST(m, FIO_IPC_FLAG_BATCH)) {
+      fio___ipc_free(m);
+      goto malformed;
+    }
+    fn(m, m->from);
+  }
+  fio___ipc_free(batch);
+  return;
+
+malformed:
+  FIO_LOG_SECURITY("(%d) malformed IPC batch", fio_io_pid());
+  fio_io_close(io);
+  fio___ipc_free(batch);
+}
+
 /* *****************************************************************************
 IPC Core - executing IPC calls
 ***************************************************************************** */
@@ -1112,19 +1420,20 @@ FIO_SFUNC void fio___ipc_on_ipc_master(void *ipc_, void *io_) {
   /* Handle internal ping/pong — never dispatch to user */
   if (fio___ipc_handle_ping(ipc, fio___ipc_parser(ipc->from)))
     return;
+  if (FIO_IPC_FLAG_TEST(ipc, FIO_IPC_FLAG_BATCH)) {
+    fio___ipc_batch_unpack(ipc, fio___ipc_on_ipc_master);
+    return;
+  }
   if (FIO_IPC_FLAG_TEST(ipc, FIO_IPC_FLAG_WORKERS) ||
       FIO_IPC_FLAG_TEST(ipc, FIO_IPC_FLAG_CLUSTER)) {
     /* this message expects to be forwarded */
     if (ipc->udata == FIO_IPC_EXCLUDE_SELF &&
         FIO_IPC_FLAG_TEST(ipc, FIO_IPC_FLAG_CLUSTER)) {
       /* cluster messages with FIO_IPC_EXCLUDE_SELF are excluded from master */
-      fio_ipc_encrypt(ipc);
       fio___ipc_send_master_task(ipc, NULL);
       return;
     }
-    fio_ipc_s *cpy = fio___ipc_copy(ipc);
-    fio_ipc_encrypt(cpy);
-    fio___ipc_send_master_task(cpy, NULL);
+    fio___ipc_send_master_task(fio___ipc_copy(ipc), NULL);
   }
   fio___ipc_execute_task(ipc, io_);
   return;
@@ -1141,6 +1450,10 @@ FIO_SFUNC void fio___ipc_on_ipc_worker(void *ipc_, void *io_) {
   /* Handle internal ping/pong — never dispatch to user */
   if (fio___ipc_handle_ping(ipc, fio___ipc_parser(ipc->from)))
     return;
+  if (FIO_IPC_FLAG_TEST(ipc, FIO_IPC_FLAG_BATCH)) {
+    fio___ipc_batch_unpack(ipc, fio___ipc_on_ipc_worker);
+    return;
+  }
   fio___ipc_execute_task(ipc, io_);
   return;
 decrypt_error:
@@ -1204,30 +1517,43 @@ filtered:
 IPC Core - IPC Socket Management
 ***************************************************************************** */
 
-/** Called when data is received on IPC socket */
-FIO_IFUNC void fio___ipc_on_data_internal(fio_io_s *io,
-                                          fio___ipc_parser_s *p,
-                                          void (*fn)(void *ipc, void *io)) {
+/** Reads from the IPC socket (see fio___ipc_on_data_internal). */
+FIO_SFUNC size_t fio___ipc_read_io(void *io, void *buf, size_t len) {
+  return fio_io_read((fio_io_s *)io, buf, len);
+}
+
+/**
+ * Parses IPC messages read from `src` (the socket or shared memory ring).
+ *
+ * Returns -1 if `io` was closed due to a protocol error, otherwise 0.
+ */
+FIO_IFUNC int fio___ipc_on_data_internal(fio_io_s *io,
+                                         fio___ipc_parser_s *p,
+                                         void (*fn)(void *ipc, void *io),
+                                         size_t (*read_fn)(void *src,
+                                                           void *buf,
+                                                           size_t len),
+                                         void *src) {
   fio_ipc_s *msg;
   if (!p)
-    return;
+    return 0;
   bool had_messages = 0; /* if messages were sent, we stop reading */
   for (;;) {
     if ((msg = p->msg)) { /* read directly to message object */
-      p->msg_received += fio_io_read(io,
-                                     (char *)&msg->len + p->msg_received,
-                                     p->expected_len - p->msg_received);
+      p->msg_received += read_fn(src,
+                                 (char *)&msg->len + p->msg_received,
+                                 p->expected_len - p->msg_received);
       if (p->expected_len != p->msg_received)
-        return;
+        return 0;
       /* dup ref owned by msg->from */
       fio_queue_push(fio_io_queue(), fn, msg, fio_io_dup(io));
       fio___ipc_parser_init(p);
-      return; /* don't read more messages for now */
+      return 0; /* don't read more messages for now */
     }
     /* read into IO buffer */
-    p->buf_len += fio_io_read(io,
-                              p->buffer + p->buf_len,
-                              FIO_IPC_BUFFER_LEN - p->buf_len);
+    p->buf_len += read_fn(src,
+                          p->buffer + p->buf_len,
+                          FIO_IPC_BUFFER_LEN - p->buf_len);
     size_t consumed = 0;
     for (;;) { /* consume from IO buffer */
       if (p->buf_len < 4 + consumed)
@@ -1251,7 +1577,7 @@ FIO_IFUNC void fio___ipc_on_data_internal(fio_io_s *io,
                          p->expected_len,
                          p->buf_len);
         fio_io_close(io);
-        return;
+        return -1;
       }
 
       if (p->buf_len >= consumed + p->expected_len) {
@@ -1283,24 +1609,34 @@ FIO_IFUNC void fio___ipc_on_data_internal(fio_io_s *io,
       p->buf_len -= consumed;
     }
     if (had_messages || !p->msg)
-      return;
+      return 0;
   }
 }
 
 /** Called when data is received on IPC socket */
 FIO_SFUNC void fio___ipc_on_data_master(fio_io_s *io) {
-  fio___ipc_on_data_internal(io, fio___ipc_parser(io), fio___ipc_on_ipc_master);
+  fio___ipc_on_data_internal(io,
+                             fio___ipc_parser(io),
+                             fio___ipc_on_ipc_master,
+                             fio___ipc_read_io,
+                             io);
 }
 /** Called when data is received on IPC socket */
 FIO_SFUNC void fio___ipc_on_data_worker(fio_io_s *io) {
-  fio___ipc_on_data_internal(io, fio___ipc_parser(io), fio___ipc_on_ipc_worker);
+  fio___ipc_on_data_internal(io,
+                             fio___ipc_parser(io),
+                             fio___ipc_on_ipc_worker,
+                             fio___ipc_read_io,
+                             io);
 }
 
 /** Called when data is received on a cluster connection */
 FIO_SFUNC void fio___ipc_on_data_cluster(fio_io_s *io) {
   fio___ipc_on_data_internal(io,
                              fio___ipc_cluster_parser(io),
-                             fio___ipc_on_rpc_master);
+                             fio___ipc_on_rpc_master,
+                             fio___ipc_read_io,
+                             io);
 }
 
 /** Called when data is received on a cluster connection */
@@ -1318,8 +1654,11 @@ FIO_SFUNC void fio___ipc_on_shutdown_master(fio_io_s *io) {
 
 /** Called when IPC socket is closed */
 FIO_SFUNC void fio___ipc_on_close(void *buffer, void *udata) {
-  fio___ipc_parser_s *p = (fio___ipc_parser_s *)buffer;
-  fio___ipc_parser_destroy(p);
+  fio___ipc_batch_s *b = (fio___ipc_batch_s *)buffer;
+  fio___ipc_batch_destroy(b);
+  fio___ipc_parser_destroy((fio___ipc_parser_s *)(b + 1));
+  if (udata) /* master side connection, bound to shared memory rings */
+    fio___ipc_shm_unbind((fio___ipc_shm_s *)udata);
   /*
    * Only the worker's OWN connection to the master is fatal when closed.
    *
@@ -1338,7 +1677,6 @@ FIO_SFUNC void fio___ipc_on_close(void *buffer, void *udata) {
     FIO___IPC.worker_buffer = NULL;
     fio_io_stop();
   }
-  (void)udata;
 }
 
 /* *****************************************************************************
@@ -1404,6 +1742,444 @@ FIO_SFUNC void fio___ipc_listen(void *ignr_) {
   (void)ignr_;
 }
 
+/* *****************************************************************************
+IPC Core - Shared Memory Transport (master <=> worker rings)
+
+Every worker gets two rings (one per direction) in a shared mapping, created
+by the master before the worker is forked. Frames keep the (encrypted) socket
+wire format and are read by the same parser, so op-codes, replies and
+`after_send` callbacks behave the same. Rings are only accessed by the IO
+thread. A sleeping reader (or a writer waiting for room) is woken by an
+`eventfd` attached to the reactor.
+
+The switch is negotiated over the socket, which preserves message order:
+
+1. the worker calls `fio___ipc_shm_on_bind` (by socket);
+2. the master replies (its last frame by socket) and writes to the ring;
+3. the worker calls `fio___ipc_shm_on_ready` (its last frame by socket), then
+   writes to the ring and drains the master's ring;
+4. the master drains the worker's ring once `fio___ipc_shm_on_ready` runs.
+***************************************************************************** */
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+
+FIO_IFUNC size_t fio___ipc_shm_sizeof(void) {
+  return sizeof(fio___ipc_shm_s) + sizeof(fio___ipc_parser_s) +
+         FIO_IPC_BUFFER_LEN;
+}
+
+FIO_IFUNC fio___ipc_parser_s *fio___ipc_shm_parser(fio___ipc_shm_s *s) {
+  return (fio___ipc_parser_s *)(s + 1);
+}
+
+FIO_IFUNC char *fio___ipc_shm_data(fio___ipc_shm_ring_s *r) {
+  return (char *)(r + 1);
+}
+
+/* wakes the process polling `fd` */
+FIO_IFUNC void fio___ipc_shm_signal(int fd) {
+  uint64_t one = 1;
+  ssize_t r = write(fd, &one, sizeof(one)); /* EAGAIN: already signaled */
+  (void)r;
+}
+
+/* bytes waiting in the ring this process reads */
+FIO_IFUNC size_t fio___ipc_shm_unread(fio___ipc_shm_s *s) {
+  uint64_t head;
+  fio_atomic_load(head, &s->rx->head);
+  return (size_t)(head - s->rx->tail);
+}
+
+/* free space in the ring this process writes */
+FIO_IFUNC size_t fio___ipc_shm_room(fio___ipc_shm_s *s) {
+  uint64_t tail;
+  fio_atomic_load(tail, &s->tx->tail);
+  return (size_t)((s->mask + 1) - (s->tx->head - tail));
+}
+
+/* *****************************************************************************
+Shared Memory Transport - Rings Lifetime
+***************************************************************************** */
+
+FIO_SFUNC void fio___ipc_shm_free(fio___ipc_shm_s *s) {
+  if (--s->ref)
+    return;
+  FIO_LIST_REMOVE(&s->node);
+  fio___ipc_parser_destroy(fio___ipc_shm_parser(s));
+  fio_queue_perform_all(&s->out); /* frees messages waiting for room */
+  fio_queue_destroy(&s->out);
+  if (s->map)
+    munmap(s->map, s->map_len);
+  for (size_t i = 0; i < 2; ++i)
+    if (s->fd[i] != -1)
+      close(s->fd[i]);
+  FIO_MEM_FREE(s, fio___ipc_shm_sizeof());
+}
+
+/* master: maps the rings for the next worker (inherited by `fork`) */
+FIO_SFUNC fio___ipc_shm_s *fio___ipc_shm_new(void) {
+  const size_t ring_len =
+      sizeof(fio___ipc_shm_ring_s) + FIO___IPC.shm_capacity;
+  fio___ipc_shm_s *s =
+      (fio___ipc_shm_s *)FIO_MEM_REALLOC(NULL, 0, fio___ipc_shm_sizeof(), 0);
+  if (!s)
+    return s;
+  *s = (fio___ipc_shm_s){
+      .node = FIO_LIST_INIT(s->node),
+      .map_len = ring_len << 1,
+      .mask = FIO___IPC.shm_capacity - 1,
+      .fd = {eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC),
+             eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)},
+      .ref = 1,
+  };
+  fio_queue_init(&s->out);
+  fio___ipc_parser_init(fio___ipc_shm_parser(s));
+  FIO_LIST_PUSH(&FIO___IPC.shm_list, &s->node);
+  if (s->fd[0] == -1 || s->fd[1] == -1)
+    goto error;
+  s->map = mmap(NULL,
+                s->map_len,
+                PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_ANONYMOUS,
+                -1,
+                0);
+  if (s->map == MAP_FAILED) {
+    s->map = NULL;
+    goto error;
+  }
+  s->tx = (fio___ipc_shm_ring_s *)s->map; /* master => worker */
+  s->rx = (fio___ipc_shm_ring_s *)((char *)s->map + ring_len);
+  s->tx->rx_waiting = s->rx->rx_waiting = 1; /* readers start asleep */
+  return s;
+error:
+  FIO_LOG_ERROR("(%d) IPC shared memory unavailable, using socket: %s",
+                fio_io_pid(),
+                strerror(errno));
+  fio___ipc_shm_free(s);
+  return NULL;
+}
+
+/* called when the master side IPC connection bound to the rings closes */
+FIO_SFUNC void fio___ipc_shm_unbind(fio___ipc_shm_s *s) {
+  s->io = NULL;
+  if (s->wake && fio_io_is_master())
+    fio_io_close(s->wake);
+  fio___ipc_shm_free(s);
+}
+
+/* *****************************************************************************
+Shared Memory Transport - Reading / Writing (IO thread only)
+***************************************************************************** */
+
+/* reads from the `rx` ring (see fio___ipc_on_data_internal) */
+FIO_SFUNC size_t fio___ipc_shm_read(void *s_, void *buf, size_t len) {
+  fio___ipc_shm_s *s = (fio___ipc_shm_s *)s_;
+  fio___ipc_shm_ring_s *r = s->rx;
+  size_t unread = fio___ipc_shm_unread(s);
+  uint64_t tail = r->tail;
+  size_t pos = (size_t)tail & s->mask;
+  size_t part = (s->mask + 1) - pos;
+  if (len > unread)
+    len = unread;
+  if (part > len)
+    part = len;
+  FIO_MEMCPY(buf, fio___ipc_shm_data(r) + pos, part);
+  FIO_MEMCPY((char *)buf + part, fio___ipc_shm_data(r), len - part);
+  fio_atomic_exchange(&r->tail, tail + len); /* publishes the room */
+  return len;
+}
+
+/* writes what fits of `m`, returns non-zero once all of it was written */
+FIO_SFUNC int fio___ipc_shm_write(fio___ipc_shm_s *s, fio_ipc_s *m) {
+  fio___ipc_shm_ring_s *r = s->tx;
+  const size_t total = fio___ipc_wire_length(m->len);
+  const char *src = (const char *)&m->len + s->out_offset;
+  size_t len = total - s->out_offset;
+  size_t room = fio___ipc_shm_room(s);
+  uint64_t head = r->head;
+  size_t pos = (size_t)head & s->mask;
+  size_t part = (s->mask + 1) - pos;
+  if (len > room)
+    len = room;
+  if (part > len)
+    part = len;
+  FIO_MEMCPY(fio___ipc_shm_data(r) + pos, src, part);
+  FIO_MEMCPY(fio___ipc_shm_data(r), src + part, len - part);
+  fio_atomic_exchange(&r->head, head + len); /* publishes the data */
+  s->out_offset += len;
+  if (s->out_offset != total)
+    return 0;
+  s->out_offset = 0;
+  return 1;
+}
+
+/* wakes the peer if it sleeps, waiting for the data we wrote */
+FIO_IFUNC void fio___ipc_shm_notify(fio___ipc_shm_s *s) {
+  uint32_t waiting;
+  fio_atomic_load(waiting, &s->tx->rx_waiting);
+  if (waiting && fio_atomic_exchange(&s->tx->rx_waiting, 0))
+    fio___ipc_shm_signal(s->fd[!s->self]);
+}
+
+/* asks the peer to wake us once it reads from our (full) `tx` ring */
+FIO_SFUNC void fio___ipc_shm_await_room(fio___ipc_shm_s *s) {
+  fio_atomic_exchange(&s->tx->tx_waiting, 1);
+  if (fio___ipc_shm_room(s) && fio_atomic_exchange(&s->tx->tx_waiting, 0))
+    fio___ipc_shm_signal(s->fd[s->self]); /* room was made meanwhile */
+}
+
+/* writes (or queues) an encrypted message, consuming the reference */
+FIO_SFUNC void fio___ipc_shm_send(fio___ipc_shm_s *s, fio_ipc_s *m) {
+  if (!fio_queue_count(&s->out) && fio___ipc_shm_write(s, m)) {
+    fio___ipc_shm_notify(s);
+    fio___ipc_free_in_io_thread(m);
+    return;
+  }
+  fio_queue_push(&s->out,
+                 .fn = (void (*)(void *, void *))fio___ipc_free_task,
+                 .udata1 = m);
+  fio___ipc_shm_notify(s);
+  fio___ipc_shm_await_room(s);
+}
+
+/* writes queued messages, in order, while there's room */
+FIO_SFUNC void fio___ipc_shm_flush(fio___ipc_shm_s *s) {
+  fio_queue_task_s t;
+  if (!fio_queue_count(&s->out))
+    return;
+  while ((t = fio_queue_pop(&s->out)).fn) {
+    if (!fio___ipc_shm_write(s, (fio_ipc_s *)t.udata1)) {
+      fio_queue_push_urgent(&s->out, .fn = t.fn, .udata1 = t.udata1);
+      fio___ipc_shm_await_room(s);
+      break;
+    }
+    fio___ipc_free_in_io_thread((fio_ipc_s *)t.udata1);
+  }
+  fio___ipc_shm_notify(s);
+}
+
+/* parses messages from the `rx` ring, yielding to the reactor after a batch */
+FIO_SFUNC void fio___ipc_shm_drain(fio___ipc_shm_s *s) {
+  fio_io_s *io = s->self ? FIO___IPC.worker_connection : s->io;
+  void (*fn)(void *, void *) =
+      s->self ? fio___ipc_on_ipc_worker : fio___ipc_on_ipc_master;
+  if (!s->rx_ready || !io)
+    return;
+  fio_io_touch(io); /* the socket is quiet, don't let it time out */
+  for (size_t i = 0; i < 32; ++i) {
+    if (!fio___ipc_shm_unread(s))
+      goto sleep;
+    if (fio___ipc_on_data_internal(io,
+                                   fio___ipc_shm_parser(s),
+                                   fn,
+                                   fio___ipc_shm_read,
+                                   s))
+      return;
+  }
+  fio___ipc_shm_signal(s->fd[s->self]); /* more to read on the next cycle */
+  goto room_made;
+sleep:
+  fio_atomic_exchange(&s->rx->rx_waiting, 1);
+  if (fio___ipc_shm_unread(s) && fio_atomic_exchange(&s->rx->rx_waiting, 0))
+    fio___ipc_shm_signal(s->fd[s->self]); /* data arrived meanwhile */
+room_made:
+  if (fio_atomic_exchange(&s->rx->tx_waiting, 0))
+    fio___ipc_shm_signal(s->fd[!s->self]);
+}
+
+FIO_SFUNC void fio___ipc_shm_send_task(void *ipc_, void *io_) {
+  fio_io_s *io = (fio_io_s *)io_;
+  fio___ipc_shm_s *s = fio___ipc_shm_of(io);
+  if (s)
+    fio___ipc_shm_send(s, (fio_ipc_s *)ipc_);
+  else /* rings were closed meanwhile */
+    fio___ipc_write_frame(io, (fio_ipc_s *)ipc_);
+  fio_io_free(io);
+}
+
+/* *****************************************************************************
+Shared Memory Transport - eventfd Protocol
+***************************************************************************** */
+
+FIO_SFUNC void fio___ipc_shm_on_data(fio_io_s *io) {
+  fio___ipc_shm_s *s = (fio___ipc_shm_s *)fio_io_udata(io);
+  uint64_t count;
+  fio_io_read(io, &count, sizeof(count)); /* resets the eventfd */
+  fio___ipc_shm_flush(s);
+  fio___ipc_shm_drain(s);
+}
+
+FIO_SFUNC void fio___ipc_shm_on_timeout(fio_io_s *io) {
+  fio___ipc_shm_s *s = (fio___ipc_shm_s *)fio_io_udata(io);
+  if (!s->self && !s->io) { /* the worker never bound these rings */
+    fio_io_close(io);
+    return;
+  }
+  fio_io_touch(io);
+}
+
+FIO_SFUNC void fio___ipc_shm_on_close(void *buffer, void *udata) {
+  fio___ipc_shm_s *s = (fio___ipc_shm_s *)udata;
+  (void)buffer;
+  if (!s)
+    return;
+  s->wake = NULL;
+  s->fd[s->self] = -1; /* closed by the IO */
+  if (FIO___IPC.shm == s)
+    FIO___IPC.shm = NULL;
+  if (s->io) {
+    fio_io_udata_set(s->io, NULL);
+    s->io = NULL;
+    fio___ipc_shm_free(s);
+  }
+  fio___ipc_shm_free(s);
+}
+
+/* *****************************************************************************
+Shared Memory Transport - Switching from the Socket
+***************************************************************************** */
+
+/* worker: the master writes to the ring, so do we (see steps above) */
+FIO_SFUNC void fio___ipc_shm_on_ready(fio_ipc_s *msg) {
+  fio___ipc_shm_s *s = fio___ipc_shm_of(msg->from);
+  if (!s || (void *)s != msg->udata)
+    return;
+  s->rx_ready = 1;
+  fio___ipc_shm_drain(s);
+}
+
+/* worker: the master switched to the rings, so do we (see steps above) */
+FIO_SFUNC void fio___ipc_shm_on_bound(fio_ipc_s *msg) {
+  fio___ipc_shm_s *s = FIO___IPC.shm;
+  fio_ipc_s *ready;
+  if (!s || (void *)s != msg->udata || !FIO___IPC.worker_connection)
+    return;
+  /* batched messages and then `on_ready` are the last frames on the socket */
+  fio___ipc_batch_flush(FIO___IPC.worker_connection);
+  ready = fio_ipc_new(.call = fio___ipc_shm_on_ready, .udata = s);
+  if (!ready)
+    return;
+  fio___ipc_write_frame(FIO___IPC.worker_connection, ready);
+  s->tx_ready = 1;
+  s->rx_ready = 1;
+  fio___ipc_shm_drain(s);
+}
+
+/* master: a worker asks to use its rings (see steps above) */
+FIO_SFUNC void fio___ipc_shm_on_bind(fio_ipc_s *msg) {
+  fio___ipc_shm_s *s = NULL;
+  fio_ipc_s *reply;
+  FIO_LIST_EACH(fio___ipc_shm_s, node, &FIO___IPC.shm_list, pos) {
+    if ((void *)pos == msg->udata)
+      s = pos;
+  }
+  if (!s || s->io || !s->wake || !msg->from || fio_io_udata(msg->from))
+    return; /* keep using the socket */
+  /* batched messages and then the reply are the last frames on the socket */
+  fio___ipc_batch_flush(msg->from);
+  reply = fio___ipc_reply_new((fio_ipc_reply_args_s){.ipc = msg, .done = 1});
+  if (!reply)
+    return;
+  fio___ipc_write_frame(msg->from, reply);
+  s->io = msg->from;
+  ++s->ref;
+  fio_io_udata_set(s->io, s);
+}
+
+/* master, FIO_CALL_BEFORE_FORK / FIO_CALL_IN_MASTER: rings for the next fork */
+FIO_SFUNC void fio___ipc_shm_before_fork(void *ignr_) {
+  if (FIO___IPC.shm_capacity && fio_io_is_master())
+    FIO___IPC.shm = fio___ipc_shm_new();
+  (void)ignr_;
+}
+
+/* master, FIO_CALL_AFTER_FORK: drops the spare rings, listens to the rest */
+FIO_SFUNC void fio___ipc_shm_after_fork(void *ignr_) {
+  if (!fio_io_is_master())
+    return;
+  if (FIO___IPC.shm)
+    fio___ipc_shm_free(FIO___IPC.shm);
+  FIO___IPC.shm = NULL;
+  FIO_LIST_EACH(fio___ipc_shm_s, node, &FIO___IPC.shm_list, s) {
+    if (!s->wake)
+      s->wake = fio_io_attach_fd(s->fd[0], &FIO___IPC.protocol_shm, s, NULL);
+  }
+  (void)ignr_;
+}
+
+/* worker (after connecting to the master): keeps only its own rings */
+FIO_SFUNC void fio___ipc_shm_on_fork(void) {
+  fio___ipc_shm_s *own = FIO___IPC.shm;
+  fio___ipc_shm_ring_s *tmp;
+  FIO_LIST_EACH(fio___ipc_shm_s, node, &FIO___IPC.shm_list, s) {
+    if (s == own)
+      FIO_LIST_REMOVE_RESET(&s->node);
+    else if (!s->wake) /* a sibling's (attached rings close with their IO) */
+      fio___ipc_shm_free(s);
+  }
+  if (!own)
+    return;
+  if (!FIO___IPC.worker_connection) {
+    FIO___IPC.shm = NULL;
+    fio___ipc_shm_free(own);
+    return;
+  }
+  tmp = own->rx;
+  own->rx = own->tx;
+  own->tx = tmp;
+  own->self = 1;
+  own->wake = fio_io_attach_fd(own->fd[1], &FIO___IPC.protocol_shm, own, NULL);
+  fio_ipc_call(.call = fio___ipc_shm_on_bind,
+               .on_done = fio___ipc_shm_on_bound,
+               .udata = own);
+}
+
+FIO_SFUNC void fio___ipc_shm_init(void) {
+  FIO___IPC.shm_list = FIO_LIST_INIT(FIO___IPC.shm_list);
+  FIO___IPC.protocol_shm = (fio_io_protocol_s){
+      .on_data = fio___ipc_shm_on_data,
+      .on_close = fio___ipc_shm_on_close,
+      .on_timeout = fio___ipc_shm_on_timeout,
+      .timeout = (360 * 1024), /* same as the IPC connection */
+  };
+  fio_state_callback_add(FIO_CALL_BEFORE_FORK, fio___ipc_shm_before_fork, NULL);
+  fio_state_callback_add(FIO_CALL_IN_MASTER, fio___ipc_shm_before_fork, NULL);
+  fio_state_callback_add(FIO_CALL_AFTER_FORK, fio___ipc_shm_after_fork, NULL);
+}
+
+/** Sets the shared memory ring capacity (master only, before the reactor). */
+SFUNC int fio_ipc_shm_set(size_t capacity) {
+  size_t c = 4096;
+  if (!fio_io_is_master() || fio_io_is_running() ||
+      capacity > ((size_t)1 << 30))
+    return -1;
+  while (c < capacity)
+    c <<= 1;
+  FIO___IPC.shm_capacity = capacity ? c : 0;
+  return 0;
+}
+
+#else /* __linux__ */
+
+FIO_SFUNC void fio___ipc_shm_send_task(void *ipc_, void *io_) {
+  fio___ipc_write_frame((fio_io_s *)io_, (fio_ipc_s *)ipc_);
+  fio_io_free((fio_io_s *)io_);
+}
+FIO_SFUNC void fio___ipc_shm_unbind(fio___ipc_shm_s *s) { (void)s; }
+FIO_SFUNC void fio___ipc_shm_on_fork(void) {}
+FIO_SFUNC void fio___ipc_shm_init(void) {
+  FIO___IPC.shm_list = FIO_LIST_INIT(FIO___IPC.shm_list);
+}
+
+/** Sets the shared memory ring capacity (unsupported on this platform). */
+SFUNC int fio_ipc_shm_set(size_t capacity) { return 0 - !!capacity; }
+
+#endif /* __linux__ */
+
+/** Returns the shared memory ring capacity (0 if the socket is used). */
+SFUNC size_t fio_ipc_shm(void) { return FIO___IPC.shm_capacity; }
+
 /* *****************************************************************************
 IPC - Remote - Peer 2 Peer Negotiations (UDP broadcast & connect)
 ***************************************************************************** */
@@ -1523,11 +2299,12 @@ FIO_SFUNC void fio___ipc_udp_on_attach(fio_io_s *io) {
   /* Send initial broadcast */
   fio___ipc_udp_broadcast_hello(io);
   /* Schedule periodic broadcasts (every 1-2 seconds with jitter) */
-  fio_io_run_every(.fn = fio___ipc_udp_broadcast_task,
-                   .udata1 = fio_io_dup(io),
-                   .every = (uint32_t)(2048 | (1023 & FIO___IPC.uuid.u64[0])),
-                   .on_finish = fio___ipc_udp_broadcast_task_done,
-                   .repetitions = 0); /* Repeat indefinitely */
+  fio_timer_free(fio_io_run_every(
+      .fn = fio___ipc_udp_broadcast_task,
+      .udata1 = fio_io_dup(io),
+      .every = (uint32_t)(2048 | (1023 & FIO___IPC.uuid.u64[0])),
+      .on_finish = fio___ipc_udp_broadcast_task_done,
+      .repetitions = 0)); /* Repeat indefinitely */
 }
 
 /** Called when UDP socket is closed */
@@ -1777,6 +2554,67 @@ SFUNC void fio_ipc_cluster_connect(const char *url) {
   FIO_LOG_INFO("(%d) Connecting to cluster IPC peer: %s", fio_io_pid(), url);
 }
 
+/* *****************************************************************************
+IPC - Allocator Telemetry
+***************************************************************************** */
+#if defined(H___FIO_MALLOC___H)
+
+typedef struct {
+  void (*on_stats)(int pid, fio_malloc_stats_s *stats, void *udata);
+  void *udata;
+} fio___ipc_malloc_stats_req_s;
+
+typedef struct {
+  fio___ipc_malloc_stats_req_s req;
+  int pid;
+  fio_malloc_stats_s stats;
+} fio___ipc_malloc_stats_s;
+
+/* runs on every local process, replies with its allocator's state */
+FIO_SFUNC void fio___ipc_malloc_stats_call(fio_ipc_s *ipc) {
+  fio___ipc_malloc_stats_s r;
+  if (ipc->len != sizeof(r.req))
+    return;
+  FIO_MEMCPY(&r.req, ipc->data, sizeof(r.req));
+  r.pid = fio_io_pid();
+  r.stats = fio_malloc_stats();
+  fio_ipc_reply(ipc,
+                .data = FIO_IPC_DATA(FIO_BUF_INFO2((char *)&r, sizeof(r))),
+                .done = 1);
+}
+
+/* runs on the master process, once per reply */
+FIO_SFUNC void fio___ipc_malloc_stats_reply(fio_ipc_s *ipc) {
+  fio___ipc_malloc_stats_s r;
+  if (ipc->len != sizeof(r))
+    return;
+  FIO_MEMCPY(&r, ipc->data, sizeof(r));
+  if (r.req.on_stats)
+    r.req.on_stats(r.pid, &r.stats, r.req.udata);
+}
+
+void fio_ipc_malloc_stats___(void); /* IDE Marker */
+SFUNC void fio_ipc_malloc_stats(void (*on_stats)(int pid,
+                                                 fio_malloc_stats_s *stats,
+                                                 void *udata),
+                                void *udata) {
+  fio___ipc_malloc_stats_req_s req = {.on_stats = on_stats, .udata = udata};
+  if (!on_stats)
+    return;
+  if (!fio_io_is_master()) {
+    FIO_LOG_WARNING("(%d) fio_ipc_malloc_stats called by a worker process",
+                    fio_io_pid());
+    return;
+  }
+  fio_ipc_local(.call = fio___ipc_malloc_stats_call,
+                .on_reply = fio___ipc_malloc_stats_reply,
+                .on_done = fio___ipc_malloc_stats_reply,
+                .data = FIO_IPC_DATA(
+                    FIO_BUF_INFO2((char *)&req, sizeof(req))));
+}
+
+#endif /* H___FIO_MALLOC___H */
+
 /* *****************************************************************************
 IPC - Initialization & Destruction
 ***************************************************************************** */
@@ -1812,6 +2650,7 @@ FIO_SFUNC void fio___ipc_on_fork(void *ignr_) {
     /* remember the connection's buffer identity (see fio___ipc_on_close) */
     FIO___IPC.worker_buffer = (void *)(FIO___IPC.worker_connection + 1);
   }
+  fio___ipc_shm_on_fork();
 }
 void fio___ipc_init____(void); /* IDE Marker */
 /* Master initialization - runs automatically at startup */
@@ -1823,7 +2662,8 @@ FIO_CONSTRUCTOR(fio___ipc_init) {
       .on_shutdown = fio___ipc_on_shutdown_master,
       .on_close = fio___ipc_on_close,
       .on_timeout = fio___ipc_on_timeout_ipc,
-      .buffer_size = sizeof(fio___ipc_parser_s) + FIO_IPC_BUFFER_LEN,
+      .buffer_size = sizeof(fio___ipc_batch_s) + sizeof(fio___ipc_parser_s) +
+                     FIO_IPC_BUFFER_LEN,
       .timeout = (360 * 1024), /* IPC (local) timeout: ~6 minutes */
   };
   FIO___IPC.protocol_rpc = (fio_io_protocol_s){
@@ -1839,6 +2679,7 @@ FIO_CONSTRUCTOR(fio___ipc_init) {
   fio_io_protocol_set(NULL, &FIO___IPC.protocol_rpc); /* initialize - safety */
   FIO___IPC.uuid = fio_u128_init64(fio_rand64(), fio_rand64());
   fio_ipc_url_set(NULL);
+  fio___ipc_shm_init();
   fio_state_callback_add(FIO_CALL_BEFORE_FORK, fio___ipc_listen, NULL);
   fio_state_callback_add(FIO_CALL_IN_CHILD, fio___ipc_on_fork, NULL);
   fio_state_callback_add(FIO_CALL_AT_EXIT, fio___ipc_destroy, NULL);
@@ -37,6 +37,31 @@ TLS 1.3 IO Function Getter
 /** Returns the TLS 1.3 IO functions. */
 SFUNC fio_io_functions_s fio_tls13_io_functions(void);
 
+/**
+ * Sets the secret used to seal TLS 1.3 session tickets (resumption).
+ *
+ * Servers sharing the secret (i.e., a cluster behind a load balancer) accept
+ * each other's tickets. Ticket keys are derived per `rotation` seconds
+ * (0 == `FIO_TLS13_TICKET_ROTATION`).
+ *
+ * By default, a random secret is created when the first server context is
+ * built, so all workers forked afterwards share it.
+ */
+SFUNC void fio_tls13_io_ticket_secret(const void *secret,
+                                      size_t len,
+                                      uint32_t rotation);
+
+/**
+ * Encrypts outgoing TLS 1.3 records using `threads` worker threads.
+ *
+ * Application data written by all connections during a reactor cycle is
+ * gathered and sealed in parallel, then handed back to the IO thread for
+ * sending. Pass 0 to encrypt on the IO thread (the default).
+ *
+ * Call before `fio_io_start`.
+ */
+SFUNC void fio_tls13_io_async(uint32_t threads);
+
 /* *****************************************************************************
 TLS 1.3 IO Functions Implementation
 ***************************************************************************** */
@@ -216,6 +241,16 @@ typedef struct {
   size_t app_buf_pos;
   uint8_t is_client;
   uint8_t handshake_complete;
+  /* Client session ticket cache key (server name hash, 0 == none). */
+  uint64_t ticket_key;
+
+  /* Records queued for worker thread encryption (see `fio_tls13_io_async`). */
+  volatile uint8_t async_state;
+  uint8_t async_error;
+  size_t async_pos;
+  size_t async_len;
+  size_t async_end;
+  fio_tls13_record_keys_s *async_keys;
 
   /* Connection metadata. */
   fio_io_s *io;
@@ -251,10 +286,122 @@ FIO_IFUNC uint8_t *fio___tls13_app_buf(fio___tls13_connection_s *c) {
 
 FIO_LEAK_COUNTER_DEF(fio___tls13_connection_s)
 
-FIO_STATIC_ALLOC_DEF(fio___tls13_buffer_alloc,
-                     uint8_t,
-                     FIO___TLS13_READ_SCRATCH_CAP,
-                     4)
+/* read scratch, one per thread since every reactor thread reads */
+typedef struct fio___tls13_scratch_s {
+  struct fio___tls13_scratch_s *next; /* all scratch buffers, freed at exit */
+  uint8_t buf[FIO___TLS13_READ_SCRATCH_CAP];
+} fio___tls13_scratch_s;
+
+static __thread fio___tls13_scratch_s *fio___tls13_scratch;
+static fio___tls13_scratch_s *fio___tls13_scratch_all;
+static fio_lock_i fio___tls13_scratch_lock = FIO_LOCK_INIT;
+
+/** Frees every thread's scratch buffer (AT_EXIT). */
+FIO_SFUNC void fio___tls13_scratch_free(void *ignr_) {
+  fio_lock(&fio___tls13_scratch_lock);
+  fio___tls13_scratch_s *s = fio___tls13_scratch_all;
+  fio___tls13_scratch_all = NULL;
+  fio_unlock(&fio___tls13_scratch_lock);
+  while (s) {
+    fio___tls13_scratch_s *next = s->next;
+    FIO_MEM_FREE_(s, sizeof(*s));
+    s = next;
+  }
+  fio___tls13_scratch = NULL;
+  (void)ignr_;
+}
+
+/** Returns the calling thread's read scratch, or NULL (errno ENOMEM). */
+FIO_SFUNC uint8_t *fio___tls13_scratch_get(void) {
+  fio___tls13_scratch_s *s = fio___tls13_scratch;
+  if (s)
+    return s->buf;
+  s = (fio___tls13_scratch_s *)FIO_MEM_REALLOC_(NULL, 0, sizeof(*s), 0);
+  if (!s) {
+    errno = ENOMEM;
+    return NULL;
+  }
+  fio_lock(&fio___tls13_scratch_lock);
+  if (!fio___tls13_scratch_all)
+    fio_state_callback_add(FIO_CALL_AT_EXIT, fio___tls13_scratch_free, NULL);
+  s->next = fio___tls13_scratch_all;
+  fio___tls13_scratch_all = s;
+  fio_unlock(&fio___tls13_scratch_lock);
+  fio___tls13_scratch = s;
+  return s->buf;
+}
+
+/* *****************************************************************************
+TLS 1.3 Session Tickets (Resumption)
+
+Servers share a single (process wide) ticket key set. Clients cache the
+latest ticket per server name (SNI), so a reconnection to the same host skips
+the certificate exchange and signature. Tickets are used once: a resumed
+connection receives a fresh ticket. Connections without a server name are
+never cached.
+***************************************************************************** */
+#ifndef FIO_TLS13_TICKET_CACHE
+/** Number of client session tickets cached (one per server name). */
+#define FIO_TLS13_TICKET_CACHE 64
+#endif
+
+static fio_tls13_ticket_keys_s fio___tls13_ticket_keys;
+static struct {
+  uint64_t hash;
+  fio_tls13_ticket_s ticket;
+} fio___tls13_ticket_cache[FIO_TLS13_TICKET_CACHE];
+static fio_lock_i fio___tls13_ticket_lock = FIO_LOCK_INIT;
+
+SFUNC void fio_tls13_io_ticket_secret(const void *secret,
+                                      size_t len,
+                                      uint32_t rotation) {
+  fio_lock(&fio___tls13_ticket_lock);
+  fio_tls13_ticket_keys_init(&fio___tls13_ticket_keys, secret, len, rotation);
+  fio_unlock(&fio___tls13_ticket_lock);
+}
+
+/** Initializes the server ticket keys (once, with a random secret). */
+FIO_SFUNC void fio___tls13_ticket_keys_init(void) {
+  fio_lock(&fio___tls13_ticket_lock);
+  if (!fio___tls13_ticket_keys.rotation)
+    fio_tls13_ticket_keys_init(&fio___tls13_ticket_keys, NULL, 0, 0);
+  fio_unlock(&fio___tls13_ticket_lock);
+}
+
+/** Takes a cached ticket for the server name (if any).
+ *
+ * The client context is freed once the connection is established, so the
+ * cache key is kept by the connection. */
+FIO_SFUNC void fio___tls13_ticket_take(fio___tls13_connection_s *conn) {
+  fio___tls13_context_s *ctx = conn->ctx;
+  fio_tls13_client_s *client = &conn->state.client;
+  if (!ctx->server_name[0])
+    return;
+  uint64_t h = fio_risky_hash(ctx->server_name, strlen(ctx->server_name), 0);
+  size_t i = (size_t)(h % FIO_TLS13_TICKET_CACHE);
+  conn->ticket_key = h | 1;
+  fio_lock(&fio___tls13_ticket_lock);
+  if (fio___tls13_ticket_cache[i].hash == conn->ticket_key) {
+    fio_tls13_client_ticket_set(client, &fio___tls13_ticket_cache[i].ticket);
+    fio_secure_zero(&fio___tls13_ticket_cache[i],
+                    sizeof(fio___tls13_ticket_cache[i]));
+  }
+  fio_unlock(&fio___tls13_ticket_lock);
+}
+
+/** Caches a newly received ticket (if any) for the server name. */
+FIO_SFUNC void fio___tls13_ticket_store(fio___tls13_connection_s *conn) {
+  fio_tls13_client_s *client = &conn->state.client;
+  const fio_tls13_ticket_s *t = fio_tls13_client_ticket_get(client);
+  if (!t || !conn->ticket_key)
+    return;
+  size_t i = (size_t)(conn->ticket_key % FIO_TLS13_TICKET_CACHE);
+  fio_lock(&fio___tls13_ticket_lock);
+  fio___tls13_ticket_cache[i].hash = conn->ticket_key;
+  fio___tls13_ticket_cache[i].ticket = *t;
+  fio_unlock(&fio___tls13_ticket_lock);
+  fio_secure_zero(&client->resume.received, sizeof(client->resume.received));
+}
 
 /* *****************************************************************************
 TLS 1.3 Context Builder - Self-Signed Certificate Generation
@@ -945,6 +1092,8 @@ FIO_SFUNC void *fio___tls13_build_context(fio_io_tls_s *tls,
     }
 #endif     /* H___FIO_X509___H && H___FIO_PEM___H */
   } else { /* For server, load certificates */
+    /* Ticket keys are created before workers are forked (shared secret) */
+    fio___tls13_ticket_keys_init();
     /* Check if certificates are configured */
     if (!fio_io_tls_cert_count(tls)) {
       /* No certificates configured - generate self-signed into context */
@@ -1144,6 +1293,267 @@ FIO_SFUNC ssize_t fio___tls13_out_flush(fio_socket_i fd,
   return (ssize_t)total_flushed;
 }
 
+/* *****************************************************************************
+TLS 1.3 Worker Thread Encryption (optional)
+
+`write` places the plaintext at its final record offsets in `out_buf` and
+queues the connection. Once per reactor cycle, queued connections are split
+into slices of roughly equal size and sealed in place by worker threads. Each
+reactor (thread) batches its own connections and collects its own slices. No
+further writes are accepted until the records are sealed and collected, so
+sequence numbers are always consumed in order.
+***************************************************************************** */
+#ifndef FIO_TLS13_ASYNC_MIN_BATCH
+/** Batches smaller than this (in bytes) are encrypted by the IO thread. */
+#define FIO_TLS13_ASYNC_MIN_BATCH (1UL << 14)
+#endif
+
+#define FIO___TLS13_ASYNC_NONE    0
+#define FIO___TLS13_ASYNC_QUEUED  1
+#define FIO___TLS13_ASYNC_SEALING 2
+#define FIO___TLS13_ASYNC_SEALED  3
+
+typedef struct {
+  size_t count;
+  fio___tls13_connection_s *conn[];
+} fio___tls13_async_slice_s;
+
+static fio_io_async_s fio___tls13_async;
+/* connections queued during the current reactor cycle */
+typedef struct fio___tls13_async_batch_s {
+  struct fio___tls13_async_batch_s *next; /* all batches, freed at exit */
+  fio___tls13_connection_s **conn;
+  size_t count;
+  size_t capa;
+  size_t bytes;
+} fio___tls13_async_batch_s;
+
+/* the calling reactor's batch, every IO is written by its reactor's thread */
+static __thread fio___tls13_async_batch_s *fio___tls13_async_batch;
+static fio___tls13_async_batch_s *fio___tls13_async_batches;
+static fio_lock_i fio___tls13_async_lock = FIO_LOCK_INIT;
+
+SFUNC void fio_tls13_io_async(uint32_t threads) {
+  fio_io_async_attach(&fio___tls13_async, threads);
+}
+
+/** Seals queued records in place, unless another thread already does. */
+FIO_SFUNC void fio___tls13_async_seal(fio___tls13_connection_s *conn) {
+  uint8_t expected = FIO___TLS13_ASYNC_QUEUED;
+  uint8_t desired = FIO___TLS13_ASYNC_SEALING;
+  if (!fio_atomic_compare_exchange_p(&conn->async_state, &expected, &desired))
+    return;
+  size_t pos = conn->async_pos;
+  size_t len = conn->async_len;
+  while (len) {
+    size_t chunk = len;
+    if (chunk > FIO_TLS13_MAX_PLAINTEXT_LEN)
+      chunk = FIO_TLS13_MAX_PLAINTEXT_LEN;
+    int r = fio_tls13_record_encrypt(conn->out_buf + pos,
+                                     sizeof(conn->out_buf) - pos,
+                                     conn->out_buf + pos +
+                                         FIO_TLS13_RECORD_HEADER_LEN,
+                                     chunk,
+                                     FIO_TLS13_CONTENT_APPLICATION_DATA,
+                                     conn->async_keys);
+    if (r < 0) {
+      conn->async_error = 1;
+      break;
+    }
+    pos += (size_t)r;
+    len -= chunk;
+  }
+  fio_atomic_exchange(&conn->async_state, FIO___TLS13_ASYNC_SEALED);
+}
+
+/** Moves sealed records to the output queue, returns -1 if still pending. */
+FIO_SFUNC int fio___tls13_async_collect(fio___tls13_connection_s *conn) {
+  uint8_t state;
+  fio_atomic_load(state, &conn->async_state);
+  if (state == FIO___TLS13_ASYNC_NONE)
+    return 0;
+  if (state != FIO___TLS13_ASYNC_SEALED) {
+    errno = EWOULDBLOCK;
+    return -1;
+  }
+  conn->async_state = FIO___TLS13_ASYNC_NONE;
+  if (conn->async_error) {
+    FIO_LOG_DEBUG2("TLS 1.3: encryption error");
+    errno = ECONNRESET;
+    return -1;
+  }
+  conn->out_buf_len = conn->async_end;
+  conn->out_buf_sent = 0;
+  return 0;
+}
+
+/** Called on the IO thread once a connection's records were sealed. */
+FIO_SFUNC void fio___tls13_async_sealed(fio___tls13_connection_s *conn) {
+  fio_io_s *io = conn->io; /* `conn` may be freed with the IO */
+  fio_io_on_ready_schedule(io);
+  fio_io_free(io);
+}
+
+FIO_SFUNC void fio___tls13_async_done(void *slice_, void *ignr_) {
+  fio___tls13_async_slice_s *slice = (fio___tls13_async_slice_s *)slice_;
+  for (size_t i = 0; i < slice->count; ++i)
+    fio___tls13_async_sealed(slice->conn[i]);
+  FIO_MEM_FREE_(slice,
+                sizeof(*slice) + (slice->count * sizeof(slice->conn[0])));
+  (void)ignr_;
+}
+
+/** Worker thread task - seals a slice of the batch. */
+FIO_SFUNC void fio___tls13_async_task(void *slice_, void *ignr_) {
+  fio___tls13_async_slice_s *slice = (fio___tls13_async_slice_s *)slice_;
+  for (size_t i = 0; i < slice->count; ++i)
+    fio___tls13_async_seal(slice->conn[i]);
+  /* a slice's connections share the reactor that batched them */
+  fio_io_defer_to(slice->conn[0]->io, fio___tls13_async_done, slice_, NULL);
+  (void)ignr_;
+}
+
+/** Splits the batch between worker threads (once per reactor cycle). */
+FIO_SFUNC void fio___tls13_async_dispatch(void *batch_, void *ignr_) {
+  fio___tls13_async_batch_s *batch = (fio___tls13_async_batch_s *)batch_;
+  size_t count = batch->count;
+  size_t bytes = batch->bytes;
+  fio___tls13_connection_s **conn = batch->conn;
+  size_t threads = fio___tls13_async.count;
+  const int offload = (threads && bytes >= FIO_TLS13_ASYNC_MIN_BATCH);
+  batch->count = 0;
+  batch->bytes = 0;
+  if (!offload)
+    threads = 1;
+  size_t target = (bytes / threads) + 1;
+  for (size_t i = 0; i < count;) {
+    size_t end = i;
+    for (size_t slice_bytes = 0; end < count && slice_bytes < target; ++end)
+      slice_bytes += conn[end]->async_len;
+    fio___tls13_async_slice_s *slice = NULL;
+    if (offload)
+      slice = (fio___tls13_async_slice_s *)FIO_MEM_REALLOC_(
+          NULL,
+          0,
+          sizeof(*slice) + ((end - i) * sizeof(slice->conn[0])),
+          0);
+    if (!slice) { /* small batch (or no memory): seal on the IO thread */
+      for (; i < end; ++i) {
+        fio___tls13_async_seal(conn[i]);
+        fio___tls13_async_sealed(conn[i]);
+      }
+      continue;
+    }
+    slice->count = end - i;
+    FIO_MEMCPY(slice->conn, conn + i, slice->count * sizeof(slice->conn[0]));
+    fio_io_async(&fio___tls13_async, fio___tls13_async_task, slice, NULL);
+    i = end;
+  }
+  (void)ignr_;
+}
+
+FIO_SFUNC void fio___tls13_async_batch_free(void *ignr_) {
+  fio___tls13_async_batch_s *batch;
+  fio_lock(&fio___tls13_async_lock);
+  batch = fio___tls13_async_batches;
+  fio___tls13_async_batches = NULL;
+  fio_unlock(&fio___tls13_async_lock);
+  while (batch) {
+    fio___tls13_async_batch_s *next = batch->next;
+    FIO_MEM_FREE_(batch->conn, batch->capa * sizeof(batch->conn[0]));
+    FIO_MEM_FREE_(batch, sizeof(*batch));
+    batch = next;
+  }
+  fio___tls13_async_batch = NULL;
+  (void)ignr_;
+}
+
+/** Returns the calling thread's batch, allocating it on first use. */
+FIO_SFUNC fio___tls13_async_batch_s *fio___tls13_async_batch_get(void) {
+  fio___tls13_async_batch_s *batch = fio___tls13_async_batch;
+  if (batch)
+    return batch;
+  batch = (fio___tls13_async_batch_s *)FIO_MEM_REALLOC_(NULL,
+                                                        0,
+                                                        sizeof(*batch),
+                                                        0);
+  if (!batch)
+    return NULL;
+  *batch = (fio___tls13_async_batch_s){0};
+  fio_lock(&fio___tls13_async_lock);
+  if (!fio___tls13_async_batches)
+    fio_state_callback_add(FIO_CALL_AT_EXIT,
+                           fio___tls13_async_batch_free,
+                           NULL);
+  batch->next = fio___tls13_async_batches;
+  fio___tls13_async_batches = batch;
+  fio_unlock(&fio___tls13_async_lock);
+  fio___tls13_async_batch = batch;
+  return batch;
+}
+
+/** Adds a connection with queued records to the reactor's current batch. */
+FIO_SFUNC void fio___tls13_async_push(fio___tls13_connection_s *conn) {
+  fio___tls13_async_batch_s *batch = fio___tls13_async_batch_get();
+  if (!batch)
+    goto no_memory;
+  if (batch->count == batch->capa) {
+    size_t capa = batch->capa;
+    size_t new_capa = capa ? (capa << 1) : 256;
+    void *tmp = FIO_MEM_REALLOC_(batch->conn,
+                                 capa * sizeof(batch->conn[0]),
+                                 new_capa * sizeof(batch->conn[0]),
+                                 batch->count * sizeof(batch->conn[0]));
+    if (!tmp)
+      goto no_memory;
+    batch->conn = (fio___tls13_connection_s **)tmp;
+    batch->capa = new_capa;
+  }
+  if (!batch->count)
+    fio_io_defer_to(conn->io, fio___tls13_async_dispatch, batch, NULL);
+  batch->conn[batch->count++] = conn;
+  batch->bytes += conn->async_len;
+  fio_io_dup(conn->io); /* keeps `conn` valid until sealed */
+  return;
+
+no_memory: /* seal on the IO thread, collected by the next flush */
+  fio___tls13_async_seal(conn);
+}
+
+/** Queues plaintext for worker thread encryption, returns bytes accepted. */
+FIO_SFUNC size_t fio___tls13_async_write(fio___tls13_connection_s *conn,
+                                         size_t out_pos,
+                                         const uint8_t *src,
+                                         size_t len) {
+  size_t total = 0;
+  conn->async_pos = out_pos;
+  while (total < len) {
+    size_t out_space = sizeof(conn->out_buf) - out_pos;
+    if (out_space <= FIO_TLS13_RECORD_HEADER_LEN + 1 + FIO_TLS13_TAG_LEN)
+      break;
+    size_t chunk = len - total;
+    if (chunk > FIO_TLS13_MAX_PLAINTEXT_LEN)
+      chunk = FIO_TLS13_MAX_PLAINTEXT_LEN;
+    if (chunk > out_space - FIO_TLS13_RECORD_HEADER_LEN - 1 - FIO_TLS13_TAG_LEN)
+      chunk = out_space - FIO_TLS13_RECORD_HEADER_LEN - 1 - FIO_TLS13_TAG_LEN;
+    FIO_MEMCPY(conn->out_buf + out_pos + FIO_TLS13_RECORD_HEADER_LEN,
+               src + total,
+               chunk);
+    out_pos += FIO_TLS13_RECORD_HEADER_LEN + chunk + 1 + FIO_TLS13_TAG_LEN;
+    total += chunk;
+  }
+  if (!total)
+    return 0;
+  conn->async_len = total;
+  conn->async_end = out_pos;
+  conn->async_error = 0;
+  conn->async_keys = conn->is_client ? &conn->state.client.client_app_keys
+                                     : &conn->state.server.server_app_keys;
+  fio_atomic_exchange(&conn->async_state, FIO___TLS13_ASYNC_QUEUED);
+  fio___tls13_async_push(conn);
+  return total;
+}
+
 /* *****************************************************************************
 TLS 1.3 IO Functions - Start
 ***************************************************************************** */
@@ -1195,6 +1605,9 @@ FIO_SFUNC void fio___tls13_start(fio_io_s *io) {
     fio_tls13_client_skip_verification(&conn->state.client, 1);
 #endif /* H___FIO_X509___H && H___FIO_PEM___H */
 
+    /* Offer a cached session ticket (resumption) */
+    fio___tls13_ticket_take(conn);
+
     /* Generate ClientHello */
     int ch_len = fio_tls13_client_start(&conn->state.client,
                                         conn->out_buf,
@@ -1248,6 +1661,10 @@ FIO_SFUNC void fio___tls13_start(fio_io_s *io) {
       fio_tls13_server_set_trust_store(&conn->state.server, &ctx->trust_store);
     }
 #endif /* H___FIO_X509___H && H___FIO_PEM___H */
+
+    /* Issue session tickets (ignored when client certificates are required) */
+    fio_tls13_server_ticket_keys_set(&conn->state.server,
+                                     &fio___tls13_ticket_keys);
   }
 }
 
@@ -1261,12 +1678,16 @@ FIO_SFUNC int fio___tls13_decrypt_record(fio___tls13_connection_s *conn,
                                          size_t dest_capacity,
                                          const uint8_t *record,
                                          size_t record_len) {
-  if (conn->is_client)
-    return fio_tls13_client_decrypt(&conn->state.client,
-                                    dest,
-                                    dest_capacity,
-                                    record,
-                                    record_len);
+  if (conn->is_client) {
+    int r = fio_tls13_client_decrypt(&conn->state.client,
+                                     dest,
+                                     dest_capacity,
+                                     record,
+                                     record_len);
+    if (!r) /* post-handshake message, maybe a NewSessionTicket */
+      fio___tls13_ticket_store(conn);
+    return r;
+  }
   return fio_tls13_server_decrypt(&conn->state.server,
                                   dest,
                                   dest_capacity,
@@ -1283,7 +1704,9 @@ FIO_SFUNC ssize_t fio___tls13_read_connected(fio_socket_i fd,
                                              void *buf,
                                              size_t len,
                                              fio___tls13_connection_s *conn) {
-  uint8_t *scratch = fio___tls13_buffer_alloc(1);
+  uint8_t *scratch = fio___tls13_scratch_get();
+  if (!scratch)
+    return -1;
   uint8_t *user_buf = (uint8_t *)buf;
   size_t user_written = 0;
 
@@ -1342,9 +1765,10 @@ FIO_SFUNC ssize_t fio___tls13_read_connected(fio_socket_i fd,
     }
     conn->recv_buf_len = 0;
     conn->recv_buf_pos = 0;
-    if (target == user_buf)
+    if (target != user_buf)
+      conn->app_buf_len = (size_t)decrypted;
+    else if (decrypted) /* 0 == post-handshake message, not EOF */
       return decrypted;
-    conn->app_buf_len = (size_t)decrypted;
   }
 
   if (conn->app_buf_len > conn->app_buf_pos) {
@@ -1412,6 +1836,9 @@ FIO_SFUNC ssize_t fio___tls13_read_connected(fio_socket_i fd,
     FIO_MEMCPY(fio___tls13_recv_buf(conn), scratch + offset, partial_len);
     conn->recv_buf_len = partial_len;
     conn->recv_buf_pos = 0;
+    /* the socket may hold the rest, a hangup mustn't strand the record */
+    if (!produced)
+      return fio___tls13_read_connected(fd, buf, len, conn);
   }
 
   if (target == user_buf)
@@ -1484,9 +1911,11 @@ FIO_SFUNC ssize_t fio___tls13_read(fio_socket_i fd,
     recv_space = FIO___TLS13_RECV_BUF_CAP - conn->recv_buf_len;
   }
 
-  /* Read ciphertext through a shared scratch buffer, retaining only an
+  /* Read ciphertext through the thread's scratch buffer, retaining only an
    * incomplete TLS record in the connection. */
-  uint8_t *read_buf = fio___tls13_buffer_alloc(1);
+  uint8_t *read_buf = fio___tls13_scratch_get();
+  if (!read_buf)
+    return -1;
   errno = 0;
   ssize_t raw_read = fio_sock_read(fd, (char *)read_buf, recv_space);
   if (raw_read <= 0) {
@@ -1571,8 +2000,15 @@ FIO_SFUNC ssize_t fio___tls13_read(fio_socket_i fd,
         }
       } else {
         if (fio_tls13_server_is_connected(&conn->state.server)) {
+          const char *alpn = fio_tls13_server_alpn_get(&conn->state.server);
           conn->handshake_complete = 1;
           FIO_LOG_DEBUG2("TLS 1.3: server handshake complete");
+          /* inform the application of the negotiated protocol (if any) */
+          if (alpn)
+            fio_io_tls_alpn_select(conn->ctx->tls,
+                                   alpn,
+                                   FIO_STRLEN(alpn),
+                                   conn->io);
         } else if (fio_tls13_server_is_error(&conn->state.server)) {
           FIO_LOG_DEBUG2("TLS 1.3: server handshake error");
           errno = ECONNRESET;
@@ -1602,19 +2038,11 @@ FIO_SFUNC ssize_t fio___tls13_read(fio_socket_i fd,
         decrypt_capacity = FIO___TLS13_APP_BUF_CAP - conn->app_buf_len;
       }
 
-      if (conn->is_client) {
-        dec_len = fio_tls13_client_decrypt(&conn->state.client,
-                                           decrypt_target,
-                                           decrypt_capacity,
-                                           recv_ptr,
-                                           total_record_len);
-      } else {
-        dec_len = fio_tls13_server_decrypt(&conn->state.server,
+      dec_len = fio___tls13_decrypt_record(conn,
                                            decrypt_target,
                                            decrypt_capacity,
                                            recv_ptr,
                                            total_record_len);
-      }
 
       if (dec_len < 0) {
         FIO_LOG_DEBUG2("TLS 1.3: decryption error");
@@ -1697,6 +2125,8 @@ FIO_SFUNC ssize_t fio___tls13_write(fio_socket_i fd,
 
   /* Serialized output must drain before new plaintext is accepted: TLS record
    * sequence numbers have already advanced for every queued record. */
+  if (fio___tls13_async_collect(conn))
+    return -1;
   if (fio___tls13_out_flush(fd, conn) < 0 || conn->out_buf_len) {
     errno = EWOULDBLOCK;
     return -1;
@@ -1748,6 +2178,15 @@ FIO_SFUNC ssize_t fio___tls13_write(fio_socket_i fd,
     }
   }
 
+  /* Worker thread encryption: queue the plaintext, records are sent once
+   * sealed (a KeyUpdate response, if any, precedes them). */
+  if (fio___tls13_async.count) {
+    size_t accepted =
+        fio___tls13_async_write(conn, out_pos, (const uint8_t *)buf, len);
+    if (accepted)
+      return (ssize_t)accepted;
+  }
+
   /* Encrypt up to four TLS records into the shared wire-output queue. */
   size_t total_plaintext = 0;
   const uint8_t *src = (const uint8_t *)buf;
@@ -1826,6 +2265,8 @@ FIO_SFUNC int fio___tls13_flush(fio_socket_i fd, void *tls_ctx) {
   if (!conn)
     return 0;
 
+  if (fio___tls13_async_collect(conn))
+    return -1;
   ssize_t flushed = fio___tls13_out_flush(fd, conn);
   if (conn->app_buf_len > conn->app_buf_pos)
     fio_io_on_data_schedule(conn->io);
@@ -1848,6 +2289,12 @@ FIO_SFUNC void fio___tls13_finish(fio_socket_i fd, void *tls_ctx) {
   if (!conn)
     return;
 
+  /* The reactor calls `finish` only once `flush` returned 0, so records
+   * queued for worker thread encryption were already sent. */
+  if (fio___tls13_async_collect(conn))
+    return;
+  (void)fio___tls13_out_flush(fd, conn); /* best effort */
+
   /* Send close_notify alert */
   if (conn->handshake_complete) {
     uint8_t alert[32];
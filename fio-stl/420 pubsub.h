@@ -96,7 +96,12 @@ typedef struct {
   void (*on_unsubscribe)(void *udata);
   /** The opaque udata value is ignored and made available to the callbacks. */
   void *udata;
-  /** The queue to which the callbacks should be routed. May be NULL. */
+  /**
+   * The queue to which the callbacks should be routed. May be NULL.
+   *
+   * If NULL, callbacks run on the thread of the reactor handling `io` (or the
+   * main reactor for global subscriptions).
+   */
   fio_queue_s *queue;
   /**
    * OPTIONAL: subscription handle return value - should be NULL when using
@@ -279,7 +284,9 @@ typedef struct fio_pubsub_history_s {
    *
    * Returns 0 if replay was handled, -1 if this manager cannot replay.
    *
-   * MUST call the `on_done` callback to handle possible cleanup.
+   * MUST call the `on_done` callback to handle possible cleanup. Replay may
+   * complete asynchronously (on the IO thread): `udata` remains valid until
+   * `on_done` is called.
    */
   int (*replay)(const struct fio_pubsub_history_s *hist,
                 fio_buf_info_s channel,
@@ -385,6 +392,7 @@ typedef struct fio___pubsub_subscription_s {
   int16_t filter;      /* Channel filter (temporary before channel is set) */
   uint8_t is_pattern;  /* Pattern flag (temporary before channel is set) */
   uint8_t master_only; /* If true, subscription exists only in master process */
+  fio_lock_i lock;     /* guards `io` while routing to its reactor */
 } fio___pubsub_subscription_s;
 
 FIO_SFUNC void fio___pubsub_subscription_on_destroy(
@@ -410,6 +418,26 @@ FIO_IFUNC fio___pubsub_subscription_s *fio___pubsub_subscription_dup(
   return fio___pubsub_subscription_dup2(s);
 }
 
+/* Schedules a subscription task on its queue or its IO's reactor thread. */
+FIO_SFUNC void fio___pubsub_subscription_push(fio___pubsub_subscription_s *s,
+                                              void (*task)(void *, void *),
+                                              void *udata1,
+                                              void *udata2) {
+  if (s->queue) {
+    fio_queue_push(s->queue, task, udata1, udata2);
+    return;
+  }
+  /* `io` is cleared (under lock) before the IO is destroyed */
+  fio_lock(&s->lock);
+  if (s->io) {
+    fio_io_defer_to(s->io, task, udata1, udata2);
+    fio_unlock(&s->lock);
+    return;
+  }
+  fio_unlock(&s->lock);
+  fio_io_defer(task, udata1, udata2);
+}
+
 /** Compute environment type key for subscription storage. */
 FIO_IFUNC intptr_t fio___pubsub_channel_env_type(int16_t filter,
                                                  uint8_t is_pattern) {
@@ -511,6 +539,10 @@ FIO_IFUNC int fio___channel_cmp(fio_pubsub_channel_s *ch, fio_str_info_s s) {
   return c.capa == s.capa && FIO_STR_INFO_IS_EQ(c, s);
 }
 
+/* Pattern index maintenance (see "Pattern Index") */
+FIO_SFUNC void fio___pubsub_pattern_index_add(fio_pubsub_channel_s *ch);
+FIO_SFUNC void fio___pubsub_pattern_index_remove(fio_pubsub_channel_s *ch);
+
 FIO_IFUNC fio_pubsub_channel_s *fio___pubsub_channel_new_for_map(
     fio_str_info_s s) {
   fio_pubsub_channel_s *ch = fio_pubsub_channel_new(s.len + 1);
@@ -525,9 +557,17 @@ FIO_IFUNC fio_pubsub_channel_s *fio___pubsub_channel_new_for_map(
     FIO_MEMCPY(ch->name, s.buf, s.len);
   ch->name[s.len] = 0;
   fio___pubsub_channel_on_create(ch);
+  if (ch->is_pattern)
+    fio___pubsub_pattern_index_add(ch);
   return ch;
 }
 
+FIO_IFUNC void fio___pubsub_channel_map_key_destroy(fio_pubsub_channel_s *ch) {
+  if (ch->is_pattern)
+    fio___pubsub_pattern_index_remove(ch);
+  fio_pubsub_channel_free(ch);
+}
+
 /* Channel map type */
 #define FIO_UMAP_NAME                 fio___pubsub_channel_map
 #define FIO_MAP_KEY                   fio_str_info_s
@@ -537,77 +577,299 @@ FIO_IFUNC fio_pubsub_channel_s *fio___pubsub_channel_new_for_map(
   ((dest) = fio___pubsub_channel_new_for_map((src)))
 #define FIO_MAP_KEY_CMP(a, b)    fio___channel_cmp((a), (b))
 #define FIO_MAP_HASH_FN(str)     fio_risky_hash(str.buf, str.len, str.capa)
-#define FIO_MAP_KEY_DESTROY(key) fio_pubsub_channel_free((key))
+#define FIO_MAP_KEY_DESTROY(key) fio___pubsub_channel_map_key_destroy((key))
 #define FIO_MAP_KEY_DISCARD(key)
 #include FIO_INCLUDE_FILE
 
 /* *****************************************************************************
-History Buffer Types
+Pattern Index Types
+
+Pattern channels are bucketed by their literal prefix (the bytes before the
+first `*`, `?`, `[` or `\`) and filter. A published channel name is only
+tested against patterns whose literal prefix is a prefix of the name, so each
+publish performs one lookup per existing prefix length.
 ***************************************************************************** */
 
-#define FIO___PUBSUB_HISTORY_CHANNEL_HASH(o)                                   \
-  (fio_risky_num((o)[0]->len, (o)[0]->timestamp) + (o)[0]->id)
-#define FIO___PUBSUB_HISTORY_CHANNEL_CMP(a, b)                                 \
-  ((a)[0]->len == (b)[0]->len && (a)[0]->id == (b)[0]->id &&                   \
-   (a)[0]->timestamp == (b)[0]->timestamp)
-
-/* History Message Array per Channel */
-FIO_TYPEDEF_IMAP_ARRAY(fio___pubsub_history_channel,
-                       fio_ipc_s *,
-                       uint64_t,
-                       FIO___PUBSUB_HISTORY_CHANNEL_HASH,
-                       FIO___PUBSUB_HISTORY_CHANNEL_CMP,
+/* longer literal prefixes are truncated (bucketed by their first 63 bytes) */
+#define FIO___PUBSUB_PATTERN_PREFIX_MAX 63
+
+#define FIO___PUBSUB_PATTERN_HASH(pch) fio_risky_ptr(*(pch))
+
+/* Patterns sharing a literal prefix */
+FIO_TYPEDEF_IMAP_ARRAY(fio___pubsub_pattern_bucket,
+                       fio_pubsub_channel_s *,
+                       uint32_t,
+                       FIO___PUBSUB_PATTERN_HASH,
+                       FIO_IMAP_SIMPLE_CMP,
                        FIO_IMAP_VALID_NON_ZERO)
+#undef FIO___PUBSUB_PATTERN_HASH
+
+/* Literal prefix (+ filter, stored in `capa`) to bucket map */
+#define FIO_UMAP_NAME        fio___pubsub_pattern_map
+#define FIO_MAP_KEY          fio_str_info_s
+#define FIO_MAP_KEY_INTERNAL char *
+
+#define FIO_MAP_KEY_FROM_INTERNAL(k)                                           \
+  ((fio_str_info_s){.buf = k + sizeof(size_t),                                 \
+                    .len = fio_bstr_len(k) - sizeof(size_t),                   \
+                    .capa = fio_buf2zu(k)})
+#define FIO_MAP_KEY_COPY(dest, src)                                            \
+  ((dest) = fio_bstr_write2(                                                   \
+       NULL,                                                                   \
+       FIO_STRING_WRITE_STR2((char *)&(src).capa, sizeof(size_t)),             \
+       FIO_STRING_WRITE_STR2((src).buf, (src).len)))
+#define FIO_MAP_KEY_CMP(a, b)                                                  \
+  ((b).capa == fio_buf2zu((a)) &&                                              \
+   (fio_bstr_len((a)) - sizeof(size_t)) == (b).len &&                          \
+   !FIO_MEMCMP((a) + sizeof(size_t), (b).buf, (b).len))
+
+#define FIO_MAP_HASH_FN(str)     fio_risky_hash(str.buf, str.len, str.capa)
+#define FIO_MAP_KEY_DESTROY(key) fio_bstr_free((key))
+#define FIO_MAP_KEY_DISCARD(key)
+
+#define FIO_MAP_VALUE fio___pubsub_pattern_bucket_s
+#define FIO_MAP_VALUE_DESTROY(val)                                             \
+  fio___pubsub_pattern_bucket_destroy(&(val))
 
-/* Sort history managers by priority (descending - highest first) */
-#define FIO_SORT_NAME            fio___pubsub_history_channel
-#define FIO_SORT_TYPE            fio_ipc_s *
-#define FIO_SORT_IS_BIGGER(a, b) ((a)->timestamp > (b)->timestamp)
 #include FIO_INCLUDE_FILE
 
-#undef FIO___PUBSUB_HISTORY_CHANNEL_HASH
-#undef FIO___PUBSUB_HISTORY_CHANNEL_CMP
+typedef struct {
+  fio___pubsub_pattern_map_s map;
+  /* bit `i` is set if a bucket with an `i` bytes long prefix exists */
+  uint64_t lengths;
+  uint32_t count[FIO___PUBSUB_PATTERN_PREFIX_MAX + 1];
+} fio___pubsub_pattern_index_s;
+
+/* *****************************************************************************
+History Cache Types
+
+The built-in cache stores messages in an append-only ring of segments (arrival
+order, which is also the eviction order). Each channel keeps an index of its
+messages ordered by timestamp (a ring buffer, usually appended to), and a
+message index filters out duplicates. Pushing and evicting are O(1), replay
+uses a binary search to find its starting point.
+***************************************************************************** */
+
+/* messages per ring segment */
+#define FIO___PUBSUB_HISTORY_SEGMENT_LEN 1024
+
+FIO_LEAK_COUNTER_DEF(fio___pubsub_history_segment_s)
+FIO_LEAK_COUNTER_DEF(fio___pubsub_history_channel_s)
+
+/* Per-channel index: a ring buffer of messages ordered by timestamp */
+typedef struct {
+  fio_ipc_s **ary;
+  uint32_t start;
+  uint32_t count;
+  uint32_t capa; /* a power of 2 */
+} fio___pubsub_history_channel_s;
+
+/* Ring segment: messages in arrival order */
+typedef struct fio___pubsub_history_segment_s {
+  struct fio___pubsub_history_segment_s *next;
+  uint32_t start;
+  uint32_t end;
+  struct {
+    fio_ipc_s *ipc;
+    fio___pubsub_history_channel_s *ch;
+  } ary[FIO___PUBSUB_HISTORY_SEGMENT_LEN];
+} fio___pubsub_history_segment_s;
+
+/* Message index (open addressing, linear probing) for duplicate filtering */
+typedef struct {
+  fio_ipc_s **ary;
+  size_t count;
+  size_t capa; /* a power of 2 */
+} fio___pubsub_history_index_s;
 
 FIO_IFUNC size_t fio___pubsub_history_cache_ipc_size(fio_ipc_s *ipc) {
   return ipc->len + sizeof(*ipc) + 8;
 }
 
-FIO_IFUNC int fio___pubsub_history_channel_push(
-    fio___pubsub_history_channel_s *map,
-    fio_ipc_s *msg) {
-  fio_ipc_s **pos = fio___pubsub_history_channel_get(map, msg);
-  if (pos) {
-    FIO_LOG_DDEBUG2("(%d) History message push filtered (existing): %p-%p",
-                    (void *)msg->timestamp,
-                    (void *)msg->id);
+/* *****************************************************************************
+History Cache - Channel Index
+***************************************************************************** */
+
+#define FIO___PUBSUB_HISTORY_CH_AT(ch, i)                                      \
+  ((ch)->ary[((ch)->start + (i)) & ((ch)->capa - 1)])
+
+/* Returns the first position with a timestamp >= `ts` (> `ts` if `after`). */
+FIO_IFUNC uint32_t
+fio___pubsub_history_channel_seek(fio___pubsub_history_channel_s *ch,
+                                  uint64_t ts,
+                                  int after) {
+  uint32_t lo = 0, hi = ch->count;
+  while (lo < hi) {
+    uint32_t mid = lo + ((hi - lo) >> 1);
+    uint64_t t = FIO___PUBSUB_HISTORY_CH_AT(ch, mid)->timestamp;
+    if (t < ts || (after && t == ts))
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+FIO_SFUNC int fio___pubsub_history_channel_grow(
+    fio___pubsub_history_channel_s *ch) {
+  uint32_t capa = ch->capa ? (ch->capa << 1) : 8;
+  fio_ipc_s **tmp =
+      (fio_ipc_s **)FIO_MEM_REALLOC_(NULL, 0, sizeof(*tmp) * capa, 0);
+  if (!tmp)
+    return -1;
+  for (uint32_t i = 0; i < ch->count; ++i)
+    tmp[i] = FIO___PUBSUB_HISTORY_CH_AT(ch, i);
+  if (ch->ary)
+    FIO_MEM_FREE_(ch->ary, sizeof(*tmp) * ch->capa);
+  ch->ary = tmp;
+  ch->start = 0;
+  ch->capa = capa;
+  return 0;
+}
+
+/* Adds a message, keeping the timestamp order (O(1) for in-order messages). */
+FIO_IFUNC int fio___pubsub_history_channel_insert(
+    fio___pubsub_history_channel_s *ch,
+    fio_ipc_s *ipc) {
+  if (ch->count == ch->capa && fio___pubsub_history_channel_grow(ch))
+    return -1;
+  uint32_t pos = ch->count;
+  if (pos &&
+      FIO___PUBSUB_HISTORY_CH_AT(ch, pos - 1)->timestamp > ipc->timestamp) {
+    /* late arrival - messages with an equal timestamp keep arrival order */
+    pos = fio___pubsub_history_channel_seek(ch, ipc->timestamp, 1);
+    for (uint32_t i = ch->count; i > pos; --i)
+      FIO___PUBSUB_HISTORY_CH_AT(ch, i) = FIO___PUBSUB_HISTORY_CH_AT(ch, i - 1);
+  }
+  FIO___PUBSUB_HISTORY_CH_AT(ch, pos) = ipc;
+  ++ch->count;
+  return 0;
+}
+
+/* Removes a message (O(1) unless the message arrived out of order). */
+FIO_IFUNC void fio___pubsub_history_channel_remove(
+    fio___pubsub_history_channel_s *ch,
+    fio_ipc_s *ipc) {
+  if (!ch->count)
+    return;
+  if (FIO___PUBSUB_HISTORY_CH_AT(ch, 0) == ipc) {
+    ch->start = (ch->start + 1) & (ch->capa - 1);
+    --ch->count;
+    return;
+  }
+  uint32_t pos = fio___pubsub_history_channel_seek(ch, ipc->timestamp, 0);
+  while (pos < ch->count && FIO___PUBSUB_HISTORY_CH_AT(ch, pos) != ipc)
+    ++pos;
+  if (pos == ch->count)
+    return;
+  for (--ch->count; pos < ch->count; ++pos)
+    FIO___PUBSUB_HISTORY_CH_AT(ch, pos) = FIO___PUBSUB_HISTORY_CH_AT(ch, pos + 1);
+}
+
+FIO_SFUNC void fio___pubsub_history_channel_free(
+    fio___pubsub_history_channel_s *ch) {
+  if (!ch)
+    return;
+  if (ch->ary)
+    FIO_MEM_FREE_(ch->ary, sizeof(*ch->ary) * ch->capa);
+  FIO_LEAK_COUNTER_ON_FREE(fio___pubsub_history_channel_s);
+  FIO_MEM_FREE_(ch, sizeof(*ch));
+}
+
+/* *****************************************************************************
+History Cache - Message Index (duplicate filtering)
+***************************************************************************** */
+
+FIO_IFUNC size_t fio___pubsub_history_index_hash(fio_ipc_s *ipc) {
+  return (size_t)(fio_risky_num(ipc->len, ipc->timestamp) + ipc->id);
+}
+
+/* Returns the slot of an equal message, or the empty slot where it belongs. */
+FIO_IFUNC fio_ipc_s **fio___pubsub_history_index_seek(
+    fio___pubsub_history_index_s *idx,
+    fio_ipc_s *ipc) {
+  const size_t mask = idx->capa - 1;
+  for (size_t i = fio___pubsub_history_index_hash(ipc) & mask;;
+       i = (i + 1) & mask) {
+    fio_ipc_s *o = idx->ary[i];
+    if (!o || (o->id == ipc->id && o->timestamp == ipc->timestamp &&
+               o->len == ipc->len))
+      return idx->ary + i;
+  }
+}
+
+FIO_SFUNC int fio___pubsub_history_index_grow(
+    fio___pubsub_history_index_s *idx) {
+  fio___pubsub_history_index_s tmp = {
+      .capa = (idx->capa ? (idx->capa << 1) : 1024),
+  };
+  tmp.ary =
+      (fio_ipc_s **)FIO_MEM_REALLOC_(NULL, 0, sizeof(*tmp.ary) * tmp.capa, 0);
+  if (!tmp.ary)
     return -1;
+  if (!FIO_MEM_REALLOC_IS_SAFE_)
+    FIO_MEMSET(tmp.ary, 0, sizeof(*tmp.ary) * tmp.capa);
+  for (size_t i = 0; i < idx->capa; ++i) {
+    if (idx->ary[i])
+      *fio___pubsub_history_index_seek(&tmp, idx->ary[i]) = idx->ary[i];
   }
-  pos = fio___pubsub_history_channel_set(map, fio_ipc_dup(msg), 1);
-  fio___pubsub_history_channel_sort(map->ary, map->w);
-  if (*pos != msg) /* did the order change? */
-    fio___pubsub_history_channel_rehash(map);
+  if (idx->ary)
+    FIO_MEM_FREE_(idx->ary, sizeof(*idx->ary) * idx->capa);
+  tmp.count = idx->count;
+  *idx = tmp;
   return 0;
 }
 
-FIO_IFUNC size_t
-fio___pubsub_history_channel_pop(fio___pubsub_history_channel_s *map) {
-  size_t r = 0;
-  if (!map->count)
-    return r;
-  fio_ipc_s *old = map->ary[0];
-  r = fio___pubsub_history_cache_ipc_size(old);
-  fio___pubsub_history_channel_remove(map, old);
-  fio_ipc_free(old);
-  return r;
+/* Returns 0 if added, 1 if an equal message exists, -1 on error. */
+FIO_IFUNC int fio___pubsub_history_index_add(fio___pubsub_history_index_s *idx,
+                                             fio_ipc_s *ipc) {
+  if (((idx->count + 1) << 1) > idx->capa &&
+      fio___pubsub_history_index_grow(idx))
+    return -1;
+  fio_ipc_s **slot = fio___pubsub_history_index_seek(idx, ipc);
+  if (*slot)
+    return 1;
+  *slot = ipc;
+  ++idx->count;
+  return 0;
 }
 
-FIO_IFUNC void fio___pubsub_history_channel_destroy_all(
-    fio___pubsub_history_channel_s *map) {
-  FIO_IMAP_EACH(fio___pubsub_history_channel, map, i)
-  fio_ipc_free(map->ary[i]);
-  fio___pubsub_history_channel_destroy(map);
+/* Removes a message, shifting back its probe sequence (no tombstones). */
+FIO_IFUNC void fio___pubsub_history_index_remove(
+    fio___pubsub_history_index_s *idx,
+    fio_ipc_s *ipc) {
+  if (!idx->count)
+    return;
+  const size_t mask = idx->capa - 1;
+  size_t i = (size_t)(fio___pubsub_history_index_seek(idx, ipc) - idx->ary);
+  if (!idx->ary[i])
+    return;
+  for (size_t j = i;;) {
+    j = (j + 1) & mask;
+    if (!idx->ary[j])
+      break;
+    size_t home = fio___pubsub_history_index_hash(idx->ary[j]) & mask;
+    /* entries with a home in the cyclic range (i, j] stay put */
+    if ((i <= j) ? (i < home && home <= j) : (i < home || home <= j))
+      continue;
+    idx->ary[i] = idx->ary[j];
+    i = j;
+  }
+  idx->ary[i] = NULL;
+  --idx->count;
+}
+
+FIO_IFUNC void fio___pubsub_history_index_destroy(
+    fio___pubsub_history_index_s *idx) {
+  if (idx->ary)
+    FIO_MEM_FREE_(idx->ary, sizeof(*idx->ary) * idx->capa);
+  *idx = (fio___pubsub_history_index_s){0};
 }
 
+/* *****************************************************************************
+History Cache - Channel Map
+***************************************************************************** */
+
 /* History map type */
 #define FIO_UMAP_NAME        fio___pubsub_history_map
 #define FIO_MAP_KEY          fio_str_info_s
@@ -631,22 +893,47 @@ FIO_IFUNC void fio___pubsub_history_channel_destroy_all(
 #define FIO_MAP_KEY_DESTROY(key) fio_bstr_free((key))
 #define FIO_MAP_KEY_DISCARD(key)
 
-#define FIO_MAP_VALUE fio___pubsub_history_channel_s
-#define FIO_MAP_VALUE_DESTROY(val)                                             \
-  fio___pubsub_history_channel_destroy_all(&(val))
+#define FIO_MAP_VALUE              fio___pubsub_history_channel_s *
+#define FIO_MAP_VALUE_DESTROY(val) fio___pubsub_history_channel_free((val))
 
 #include FIO_INCLUDE_FILE
 
+/* *****************************************************************************
+History Cache - Container
+***************************************************************************** */
+
 typedef struct {
   size_t limit;
   size_t size;
+  fio___pubsub_history_segment_s *head; /* oldest messages */
+  fio___pubsub_history_segment_s *tail; /* newest messages */
+  fio___pubsub_history_segment_s *spare;
+  fio___pubsub_history_index_s index;
   fio___pubsub_history_map_s map;
 } fio___pubsub_history_cache_s;
 
+FIO_IFUNC void fio___pubsub_history_segment_free(
+    fio___pubsub_history_segment_s *s) {
+  if (!s)
+    return;
+  FIO_LEAK_COUNTER_ON_FREE(fio___pubsub_history_segment_s);
+  FIO_MEM_FREE_(s, sizeof(*s));
+}
+
 FIO_SFUNC void fio___pubsub_history_cache_destroy(
     fio___pubsub_history_cache_s *h) {
-  h->size = 0;
+  while (h->head) {
+    fio___pubsub_history_segment_s *s = h->head;
+    h->head = s->next;
+    for (uint32_t i = s->start; i < s->end; ++i)
+      fio_ipc_free(s->ary[i].ipc);
+    fio___pubsub_history_segment_free(s);
+  }
+  fio___pubsub_history_segment_free(h->spare);
+  fio___pubsub_history_index_destroy(&h->index);
   fio___pubsub_history_map_destroy(&h->map);
+  h->tail = h->spare = NULL;
+  h->size = 0;
 }
 
 FIO_IFUNC fio___pubsub_history_channel_s *fio___pubsub_history_cache_channel(
@@ -659,24 +946,94 @@ FIO_IFUNC fio___pubsub_history_channel_s *fio___pubsub_history_cache_channel(
       fio___pubsub_history_map_get_ptr(&cache->map, cname);
   if (!pos)
     return NULL;
-
-  return &pos->value;
+  return pos->value;
 }
+
 FIO_IFUNC fio___pubsub_history_channel_s *
 fio___pubsub_history_cache_channel_new(fio___pubsub_history_cache_s *cache,
                                        fio_buf_info_s channel,
                                        int16_t filter) {
+  fio___pubsub_history_channel_s *ch =
+      fio___pubsub_history_cache_channel(cache, channel, filter);
+  if (ch)
+    return ch;
+  ch = (fio___pubsub_history_channel_s *)FIO_MEM_REALLOC_(NULL,
+                                                           0,
+                                                           sizeof(*ch),
+                                                           0);
+  if (!ch)
+    return ch;
+  FIO_LEAK_COUNTER_ON_ALLOC(fio___pubsub_history_channel_s);
+  *ch = (fio___pubsub_history_channel_s){0};
   fio_str_info_s cname =
       FIO_STR_INFO3(channel.buf, channel.len, (size_t)(uint16_t)filter);
-  fio___pubsub_history_map_node_s *pos =
-      fio___pubsub_history_map_set_ptr(&cache->map,
-                                       cname,
-                                       (fio___pubsub_history_channel_s){0},
-                                       NULL,
-                                       0);
-  if (!pos)
+  if (!fio___pubsub_history_map_set_ptr(&cache->map, cname, ch, NULL, 0)) {
+    fio___pubsub_history_channel_free(ch);
     return NULL;
-  return &pos->value;
+  }
+  return ch;
+}
+
+/* Makes sure the ring's tail segment has room for another message. */
+FIO_SFUNC int fio___pubsub_history_cache_reserve(
+    fio___pubsub_history_cache_s *cache) {
+  fio___pubsub_history_segment_s *s = cache->tail;
+  if (s && s->end < FIO___PUBSUB_HISTORY_SEGMENT_LEN)
+    return 0;
+  s = cache->spare;
+  cache->spare = NULL;
+  if (!s) {
+    s = (fio___pubsub_history_segment_s *)FIO_MEM_REALLOC_(NULL,
+                                                           0,
+                                                           sizeof(*s),
+                                                           0);
+    if (!s)
+      return -1;
+    FIO_LEAK_COUNTER_ON_ALLOC(fio___pubsub_history_segment_s);
+  }
+  s->next = NULL;
+  s->start = s->end = 0;
+  if (cache->tail)
+    cache->tail->next = s;
+  else
+    cache->head = s;
+  cache->tail = s;
+  return 0;
+}
+
+/* Forward declaration (IPC to message format helper) */
+FIO_IFUNC fio_pubsub_msg_s fio___pubsub_ipc2msg(fio_ipc_s *ipc);
+
+/* Evicts the oldest message in the ring. */
+FIO_SFUNC void fio___pubsub_history_cache_evict(
+    fio___pubsub_history_cache_s *cache) {
+  fio___pubsub_history_segment_s *s = cache->head;
+  if (!s || s->start == s->end)
+    return;
+  fio_ipc_s *ipc = s->ary[s->start].ipc;
+  fio___pubsub_history_channel_s *ch = s->ary[s->start].ch;
+  if (++s->start == s->end) {
+    if (s == cache->tail) {
+      s->start = s->end = 0;
+    } else {
+      cache->head = s->next;
+      fio___pubsub_history_segment_free(cache->spare);
+      cache->spare = s;
+    }
+  }
+  cache->size -= fio___pubsub_history_cache_ipc_size(ipc);
+  fio___pubsub_history_index_remove(&cache->index, ipc);
+  fio___pubsub_history_channel_remove(ch, ipc);
+  if (!ch->count) { /* forget empty channels */
+    fio_pubsub_msg_s msg = fio___pubsub_ipc2msg(ipc);
+    fio___pubsub_history_map_remove(
+        &cache->map,
+        FIO_STR_INFO3(msg.channel.buf,
+                      msg.channel.len,
+                      (size_t)(uint16_t)msg.filter),
+        NULL);
+  }
+  fio_ipc_free(ipc);
 }
 
 /* *****************************************************************************
@@ -686,6 +1043,7 @@ Global State
 static struct {
   fio___pubsub_channel_map_s channels;
   fio___pubsub_channel_map_s patterns;
+  fio___pubsub_pattern_index_s pattern_index;
   fio___pubsub_engines_s engines;
   fio___pubsub_history_managers_s history_managers;
   uint8_t (*match_fn)(fio_str_info_s pattern, fio_str_info_s name);
@@ -707,6 +1065,76 @@ SFUNC void fio_pubsub_match_fn_set(uint8_t (*match_cb)(fio_str_info_s,
   FIO___PUBSUB_POSTOFFICE.match_fn = match_cb;
 }
 
+/* *****************************************************************************
+Pattern Index
+***************************************************************************** */
+
+/* Returns the pattern's bucket key: its literal prefix and filter. */
+FIO_IFUNC fio_str_info_s
+fio___pubsub_pattern_index_key(fio_pubsub_channel_s *ch) {
+  size_t len = 0;
+  const size_t limit = (ch->name_len > FIO___PUBSUB_PATTERN_PREFIX_MAX)
+                           ? FIO___PUBSUB_PATTERN_PREFIX_MAX
+                           : ch->name_len;
+  for (; len < limit; ++len) {
+    switch (ch->name[len]) {
+    case '*': /* fall through */
+    case '?': /* fall through */
+    case '[': /* fall through */
+    case '\\': goto done;
+    }
+  }
+done:
+  return FIO_STR_INFO3(ch->name, len, (size_t)(uint16_t)ch->filter);
+}
+
+FIO_SFUNC void fio___pubsub_pattern_index_add(fio_pubsub_channel_s *ch) {
+  fio___pubsub_pattern_index_s *idx = &FIO___PUBSUB_POSTOFFICE.pattern_index;
+  fio_str_info_s key = fio___pubsub_pattern_index_key(ch);
+  fio___pubsub_pattern_map_node_s *node =
+      fio___pubsub_pattern_map_get_ptr(&idx->map, key);
+  if (!node) {
+    node = fio___pubsub_pattern_map_set_ptr(&idx->map,
+                                            key,
+                                            (fio___pubsub_pattern_bucket_s){0},
+                                            NULL,
+                                            0);
+    if (!node)
+      goto error;
+    ++idx->count[key.len];
+    idx->lengths |= ((uint64_t)1 << key.len);
+  }
+  if (!fio___pubsub_pattern_bucket_set(&node->value, ch, 1))
+    goto error;
+  return;
+error:
+  FIO_LOG_ERROR("(%d) (pubsub) couldn't index pattern: %.*s",
+                fio_io_pid(),
+                (int)ch->name_len,
+                ch->name);
+}
+
+FIO_SFUNC void fio___pubsub_pattern_index_remove(fio_pubsub_channel_s *ch) {
+  fio___pubsub_pattern_index_s *idx = &FIO___PUBSUB_POSTOFFICE.pattern_index;
+  fio_str_info_s key = fio___pubsub_pattern_index_key(ch);
+  fio___pubsub_pattern_map_node_s *node =
+      fio___pubsub_pattern_map_get_ptr(&idx->map, key);
+  if (!node)
+    return;
+  fio___pubsub_pattern_bucket_remove(&node->value, ch);
+  if (node->value.count)
+    return;
+  fio___pubsub_pattern_map_remove(&idx->map, key, NULL);
+  if (!--idx->count[key.len])
+    idx->lengths &= ~((uint64_t)1 << key.len);
+}
+
+FIO_SFUNC void fio___pubsub_pattern_index_destroy(void) {
+  fio___pubsub_pattern_index_s *idx = &FIO___PUBSUB_POSTOFFICE.pattern_index;
+  fio___pubsub_pattern_map_destroy(&idx->map);
+  *idx = (fio___pubsub_pattern_index_s){0};
+}
+
 /** Returns the current default engine associated with the pub/sub system. */
 SFUNC fio_pubsub_engine_s const *fio_pubsub_engine_default(void) {
   return FIO___PUBSUB_POSTOFFICE.default_engine;
@@ -761,6 +1189,7 @@ FIO_SFUNC void fio___pubsub_at_exit(void *ignr_) {
   fio___pubsub_cleanup(ignr_);
   fio___pubsub_channel_map_destroy(&FIO___PUBSUB_POSTOFFICE.channels);
   fio___pubsub_channel_map_destroy(&FIO___PUBSUB_POSTOFFICE.patterns);
+  fio___pubsub_pattern_index_destroy();
 }
 
 FIO_SFUNC void fio___pubsub_on_fork_test_unsubscribe_master(
@@ -822,7 +1251,6 @@ FIO_CONSTRUCTOR(fio___pubsub_init) {
     return;
   }
 
-  fio_pubsub_history_cache(FIO_PUBSUB_HISTORY_DEFAULT_CACHE_SIZE_LIMIT);
   fio_state_callback_add(FIO_CALL_PRE_START, fio___pubsub_pre_start, NULL);
   fio_state_callback_add(FIO_CALL_IN_CHILD, fio___pubsub_on_fork, NULL);
   fio_state_callback_add(FIO_CALL_AT_EXIT, fio___pubsub_at_exit, NULL);
@@ -875,10 +1303,10 @@ FIO_SFUNC void fio___pubsub_subscription_ipc_deliver(void *sub_, void *ipc_) {
   data.sub->on_message(&data.msg);
   data.sub->udata = data.msg.udata;
   if (data.defer_flag) {
-    fio_queue_push(data.sub->queue,
-                   fio___pubsub_subscription_ipc_deliver,
-                   sub_,
-                   ipc_);
+    fio___pubsub_subscription_push(data.sub,
+                                   fio___pubsub_subscription_ipc_deliver,
+                                   sub_,
+                                   ipc_);
     return;
   }
   fio___pubsub_subscription_free(data.sub);
@@ -1052,10 +1480,10 @@ FIO_SFUNC void fio___pubsub_engine_ipc_deliver2channel(fio_pubsub_channel_s *ch,
     /* Skip if publisher is sending to itself (IO is set)*/
     if (skip && s->io == skip)
       continue;
-    fio_queue_push(s->queue,
-                   fio___pubsub_subscription_ipc_deliver,
-                   fio___pubsub_subscription_dup(s),
-                   fio_ipc_dup(ipc));
+    fio___pubsub_subscription_push(s,
+                                   fio___pubsub_subscription_ipc_deliver,
+                                   fio___pubsub_subscription_dup(s),
+                                   fio_ipc_dup(ipc));
   }
 }
 
@@ -1085,13 +1513,38 @@ FIO_SFUNC void fio___pubsub_engine_ipc_publish_deliver(fio_ipc_s *ipc) {
   }
 
   /* Check pattern subscriptions */
-  FIO_MAP_EACH(fio___pubsub_channel_map, &FIO___PUBSUB_POSTOFFICE.patterns, i) {
-    fio_pubsub_channel_s *pch = i.node->key;
-    if (pch->filter == msg.filter &&
-        FIO___PUBSUB_POSTOFFICE.match_fn(
-            FIO_STR_INFO2(pch->name, pch->name_len),
-            ch_name))
-      fio___pubsub_engine_ipc_deliver2channel(pch, ipc);
+  if (FIO___PUBSUB_POSTOFFICE.match_fn == fio_glob_match) {
+    /* test only patterns with a literal prefix matching the channel name */
+    fio___pubsub_pattern_index_s *idx = &FIO___PUBSUB_POSTOFFICE.pattern_index;
+    uint64_t lengths = idx->lengths;
+    if (ch_name.len < FIO___PUBSUB_PATTERN_PREFIX_MAX)
+      lengths &= (((uint64_t)2 << ch_name.len) - 1);
+    while (lengths) {
+      size_t len = fio_lsb_index_unsafe(lengths);
+      lengths &= lengths - 1;
+      fio___pubsub_pattern_map_node_s *node = fio___pubsub_pattern_map_get_ptr(
+          &idx->map,
+          FIO_STR_INFO3(ch_name.buf, len, (size_t)(uint16_t)msg.filter));
+      if (!node)
+        continue;
+      FIO_IMAP_EACH(fio___pubsub_pattern_bucket, &node->value, i) {
+        fio_pubsub_channel_s *pch = node->value.ary[i];
+        if (fio_glob_match(FIO_STR_INFO2(pch->name, pch->name_len), ch_name))
+          fio___pubsub_engine_ipc_deliver2channel(pch, ipc);
+      }
+    }
+  } else {
+    /* custom matching functions require testing every pattern */
+    FIO_MAP_EACH(fio___pubsub_channel_map,
+                 &FIO___PUBSUB_POSTOFFICE.patterns,
+                 i) {
+      fio_pubsub_channel_s *pch = i.node->key;
+      if (pch->filter == msg.filter &&
+          FIO___PUBSUB_POSTOFFICE.match_fn(
+              FIO_STR_INFO2(pch->name, pch->name_len),
+              ch_name))
+        fio___pubsub_engine_ipc_deliver2channel(pch, ipc);
+    }
   }
 
   /* Push to history manager - must be now, to sync history and publishing */
@@ -1277,6 +1730,10 @@ FIO_SFUNC void fio___pubsub_subscription_env_unsubscribe(void *sub_) {
   if (!sub)
     return;
   sub->on_message = fio___pubsub_on_message_stub;
+  /* may run while the IO is destroyed, stop routing tasks to its reactor */
+  fio_lock(&sub->lock);
+  sub->io = NULL;
+  fio_unlock(&sub->lock);
   // FIO_LOG_DDEBUG2("(%d) unsubscribed called for %p -> %.*s (ref: %zu)",
   //                 fio_io_pid(),
   //                 (void *)sub,
@@ -1397,8 +1854,9 @@ SFUNC void fio_pubsub_subscribe FIO_NOOP(fio_pubsub_subscribe_args_s args) {
   if (args.channel.len && !bstr)
     goto sub_error_free_sub;
 
+  /* IO bound callbacks run on the thread of the reactor handling the IO */
   if (!args.queue || !args.on_message)
-    args.queue = fio_io_queue();
+    args.queue = (args.io ? NULL : fio_io_queue());
 
   *s = (fio___pubsub_subscription_s){
       .node = FIO_LIST_INIT(s->node),
@@ -1482,10 +1940,10 @@ FIO_SFUNC void fio___pubsub_subscription_on_destroy(
     void *tsk;
     void (*cb)(void *udata);
   } u = {.cb = s->on_unsubscribe};
-  fio_queue_push(s->queue,
-                 fio___pubsub_subscription_on_destroy_task,
-                 u.tsk,
-                 s->udata);
+  fio___pubsub_subscription_push(s,
+                                 fio___pubsub_subscription_on_destroy_task,
+                                 u.tsk,
+                                 s->udata);
 
   FIO_ASSERT_ALLOC(c);
   /* no more subscribers - remove channel from channel collection */
@@ -1515,10 +1973,11 @@ FIO_SFUNC void fio___pubsub_worker_on_history_reply(fio_ipc_s *ipc) {
   //                (int)(fio_buf2u32u(ipc->data)),
   //                ipc->data + sizeof(uint32_t[2]));
 
-  fio_queue_push(((fio___pubsub_subscription_s *)ipc->udata)->queue,
-                 fio___pubsub_subscription_ipc_deliver,
-                 fio___pubsub_subscription_dup(ipc->udata),
-                 fio_ipc_dup(ipc));
+  fio___pubsub_subscription_push(
+      (fio___pubsub_subscription_s *)ipc->udata,
+      fio___pubsub_subscription_ipc_deliver,
+      fio___pubsub_subscription_dup(ipc->udata),
+      fio_ipc_dup(ipc));
 }
 
 /** IPC handler: Worker receives history reply from master */
@@ -1552,6 +2011,7 @@ FIO_SFUNC void fio___pubsub_history_replay_ipc_cb(fio_pubsub_msg_s *msg,
 
 FIO_SFUNC void fio___pubsub_history_replay_ipc_done_cb(void *udata) {
   fio_ipc_reply(udata, .done = 1);
+  fio_ipc_free((fio_ipc_s *)udata); /* replay may complete asynchronously */
 }
 
 /** IPC handler: Master receives history request from worker */
@@ -1604,7 +2064,7 @@ FIO_SFUNC void fio___pubsub_master_on_history_request(fio_ipc_s *ipc) {
                  req->replay_since,
                  fio___pubsub_history_replay_ipc_cb,
                  fio___pubsub_history_replay_ipc_done_cb,
-                 ipc);
+                 fio_ipc_dup(ipc));
   else
     fio_ipc_reply(ipc, .done = 1);
 }
@@ -1784,36 +2244,34 @@ FIO_SFUNC void fio___pubsub_history_cache_detached(
 FIO_SFUNC int fio___pubsub_history_cache_push(
     const struct fio_pubsub_history_s *hist,
     fio_pubsub_msg_s *msg) {
-  fio___pubsub_history_channel_s *cache =
-      fio___pubsub_history_cache_channel_new(&FIO___PUBSUB_POSTOFFICE.cache,
-                                             msg->channel,
-                                             msg->filter);
-  if (!cache)
-    return -1;
+  fio___pubsub_history_cache_s *cache = &FIO___PUBSUB_POSTOFFICE.cache;
   fio_ipc_s *ipc = fio___pubsub_msg2ipc(msg);
-  fio_ipc_detach(ipc);
-  if (fio___pubsub_history_channel_push(cache, ipc))
-    return 0; /* exists */
-  FIO___PUBSUB_POSTOFFICE.cache.size +=
-      fio___pubsub_history_cache_ipc_size(ipc);
-  for (; FIO___PUBSUB_POSTOFFICE.cache.size >
-         FIO___PUBSUB_POSTOFFICE.cache.limit;) {
-    FIO_MAP_EACH(fio___pubsub_history_map,
-                 &FIO___PUBSUB_POSTOFFICE.cache.map,
-                 pos) {
-      if (FIO___PUBSUB_POSTOFFICE.cache.size <=
-          FIO___PUBSUB_POSTOFFICE.cache.limit)
-        goto done;
-      FIO___PUBSUB_POSTOFFICE.cache.size -=
-          fio___pubsub_history_channel_pop(&pos.node->value);
-    }
-    FIO_MAP_EACH(fio___pubsub_history_map,
-                 &FIO___PUBSUB_POSTOFFICE.cache.map,
-                 pos) {
-      fio___pubsub_history_channel_rehash(&pos.node->value);
-    }
+  fio___pubsub_history_channel_s *ch;
+  int r;
+  if (fio___pubsub_history_cache_reserve(cache))
+    return -1;
+  ch = fio___pubsub_history_cache_channel_new(cache, msg->channel, msg->filter);
+  if (!ch)
+    return -1;
+  r = fio___pubsub_history_index_add(&cache->index, ipc);
+  if (r) {
+    FIO_LOG_DDEBUG2("(%d) History message push filtered (existing): %p-%p",
+                    fio_io_pid(),
+                    (void *)msg->timestamp,
+                    (void *)msg->id);
+    return (r < 0) ? -1 : 0;
   }
-done:
+  if (fio___pubsub_history_channel_insert(ch, ipc)) {
+    fio___pubsub_history_index_remove(&cache->index, ipc);
+    return -1;
+  }
+  fio_ipc_detach(ipc);
+  cache->tail->ary[cache->tail->end].ipc = fio_ipc_dup(ipc);
+  cache->tail->ary[cache->tail->end].ch = ch;
+  ++cache->tail->end;
+  cache->size += fio___pubsub_history_cache_ipc_size(ipc);
+  while (cache->size > cache->limit)
+    fio___pubsub_history_cache_evict(cache);
   if (msg->timestamp >
       (uint64_t)(fio_io_last_tick() + FIO_PUBSUB_FUTURE_LIMIT_MS)) {
     /* TODO: add timer for publishing the message using fio_pubsub_publish */
@@ -1836,36 +2294,20 @@ FIO_SFUNC int fio___pubsub_history_cache_replay(
     void (*on_done)(void *udata),
     void *udata) {
   (void)hist;
-  fio___pubsub_history_channel_s *cache =
+  fio___pubsub_history_channel_s *ch =
       fio___pubsub_history_cache_channel(&FIO___PUBSUB_POSTOFFICE.cache,
                                          channel,
                                          filter);
-  if (!cache || !cache->count)
+  if (!ch || !ch->count)
     goto done;
-  size_t index = 0;
   uint64_t now = fio_io_last_tick();
-  if (since > cache->ary[cache->w - 1]->timestamp)
-    goto done;
-  if (since <= cache->ary[index]->timestamp)
-    goto loop;
-  /* find best position in array (mini binary search) */
-  for (size_t step = cache->w; (step >>= 1);) {
-    if (!cache->ary[index]) {
-      --index;
-      continue;
-    }
-    if (since > cache->ary[index]->timestamp)
-      index += step;
-    else if (since < cache->ary[index]->timestamp)
-      index -= step;
-    else
-      goto loop;
-  }
-  index -= (since < cache->ary[index]->timestamp);
-
-loop:
-  for (; index < cache->w && cache->ary[index]->timestamp <= now; ++index) {
-    fio_pubsub_msg_s msg = fio___pubsub_ipc2msg(cache->ary[index]);
+  for (uint32_t i = fio___pubsub_history_channel_seek(ch, since, 0);
+       i < ch->count;
+       ++i) {
+    fio_ipc_s *ipc = FIO___PUBSUB_HISTORY_CH_AT(ch, i);
+    if (ipc->timestamp > now)
+      break;
+    fio_pubsub_msg_s msg = fio___pubsub_ipc2msg(ipc);
     on_message(&msg, udata);
   }
 done:
@@ -1883,20 +2325,22 @@ FIO_SFUNC uint64_t
 fio___pubsub_history_cache_oldest(const struct fio_pubsub_history_s *hist,
                                   fio_buf_info_s channel,
                                   int16_t filter) {
-  fio___pubsub_history_channel_s *cache =
+  fio___pubsub_history_channel_s *ch =
       fio___pubsub_history_cache_channel(&FIO___PUBSUB_POSTOFFICE.cache,
                                          channel,
                                          filter);
-  if (!cache)
+  if (!ch || !ch->count)
     return UINT64_MAX;
-  if (!cache->count)
-    return UINT64_MAX;
-  return cache->ary[0]->timestamp;
+  return FIO___PUBSUB_HISTORY_CH_AT(ch, 0)->timestamp;
   (void)hist;
 }
 
 SFUNC const fio_pubsub_history_s *fio_pubsub_history_cache(size_t size_limit) {
-  if (!size_limit && !FIO___PUBSUB_POSTOFFICE.cache.limit) {
+  if (size_limit) {
+    FIO___PUBSUB_POSTOFFICE.cache.limit = size_limit;
+    while (FIO___PUBSUB_POSTOFFICE.cache.size > size_limit)
+      fio___pubsub_history_cache_evict(&FIO___PUBSUB_POSTOFFICE.cache);
+  } else if (!FIO___PUBSUB_POSTOFFICE.cache.limit) {
     size_t mul = 1024 * 1024;
     int64_t tmp;
     char *env = fio_sys_env("WEBSITE_MEMORY_LIMIT_MB");
@@ -313,6 +313,160 @@ SFUNC int fio_redis_send(fio_pubsub_engine_s *engine,
                          void *udata);
 
 /* *****************************************************************************
+Redis Command Client (pipelined, pooled)
+***************************************************************************** */
+
+#ifndef FIO_REDIS_CLIENT_PIPELINE
+/** Default maximum number of in-flight (pipelined) commands per connection. */
+#define FIO_REDIS_CLIENT_PIPELINE 1024
+#endif
+
+/** A pipelined RESP3 command client with a connection pool (opaque type). */
+typedef struct fio_redis_client_s fio_redis_client_s;
+
+/** Arguments for creating a Redis command client */
+typedef struct {
+  /** Redis server URL (same formats as `fio_redis_args_s.url`). */
+  const char *url;
+  /** Redis server's password, if any (folded into the HELLO 3 handshake) */
+  const char *auth;
+  /** Length of auth string (0 = auto-detect with strlen) */
+  size_t auth_len;
+  /** Cumulative payload budget per FIOBJ reply, in bytes (0 = 16MB). */
+  size_t payload_limit;
+  /** Maximum in-flight commands per connection (0 = default). */
+  uint32_t pipeline;
+  /** Number of connections in the pool (0 = 1). */
+  uint8_t connections;
+  /** Ping interval in seconds (0 = default 30 seconds) */
+  uint8_t ping_interval;
+} fio_redis_client_args_s;
+
+/** Arguments for `fio_redis_client_send` */
+typedef struct {
+  /** The command - a FIOBJ array (i.e., `["GET", "key"]`). */
+  FIOBJ cmd;
+  /**
+   * A FIOBJ array of commands (each a FIOBJ array) sent as a single
+   * MULTI / EXEC transaction. Used when `cmd` is unset. The reply is the
+   * EXEC reply (an array with one reply per command).
+   */
+  FIOBJ multi;
+  /**
+   * Called with the reply, or with FIOBJ_INVALID if the connection was lost
+   * or the client was destroyed. The reply is freed once the callback returns.
+   */
+  void (*on_reply)(fio_redis_client_s *c, FIOBJ reply, void *udata);
+  /**
+   * Optional: parses the reply straight into user objects (no FIOBJ is
+   * built). `udata` is the parser's `udata`. Top-level objects must be
+   * non-NULL (see `fio_resp3_parse`).
+   */
+  const fio_resp3_callbacks_s *callbacks;
+  /** Called with the object `callbacks` built (NULL if the reply was lost). */
+  void (*on_parsed)(fio_redis_client_s *c, void *reply, void *udata);
+  /** Opaque user data. */
+  void *udata;
+} fio_redis_client_send_args_s;
+
+/**
+ * Creates a pipelined Redis command client with reference count = 1.
+ *
+ * Each process that sends commands opens its own pool of connections (on the
+ * first command), so workers talk to Redis directly rather than through IPC.
+ *
+ * Returns NULL on error.
+ */
+SFUNC fio_redis_client_s *fio_redis_client_new(fio_redis_client_args_s args);
+
+/** Creates a Redis command client (named arguments helper macro). */
+#define fio_redis_client_new(...)                                              \
+  fio_redis_client_new((fio_redis_client_args_s){__VA_ARGS__})
+
+/** Increments the client's reference count and returns the client. */
+SFUNC fio_redis_client_s *fio_redis_client_dup(fio_redis_client_s *c);
+
+/**
+ * Releases a reference. When the last reference is released, the connections
+ * are closed and pending callbacks are called with an invalid reply.
+ */
+SFUNC void fio_redis_client_free(fio_redis_client_s *c);
+
+/**
+ * Sends a command (or a MULTI / EXEC batch) through the client.
+ *
+ * Commands are written as soon as a connection has a free pipeline slot,
+ * without waiting for earlier replies, to the least loaded connection. Replies
+ * are delivered in order, per connection, on the IO thread.
+ *
+ * Thread-safe. Never send Pub/Sub commands (SUBSCRIBE, etc') using a client.
+ *
+ * Returns 0 on success, -1 on error.
+ */
+SFUNC int fio_redis_client_send(fio_redis_client_s *c,
+                                fio_redis_client_send_args_s args);
+
+/** Sends a command through the client (named arguments helper macro). */
+#define fio_redis_client_send(c, ...)                                          \
+  fio_redis_client_send((c), (fio_redis_client_send_args_s){__VA_ARGS__})
+
+/* *****************************************************************************
+Redis Pub/Sub History (Redis Streams)
+***************************************************************************** */
+
+#ifndef FIO_REDIS_HISTORY_MAX_LEN
+/** Default (approximate) number of messages kept per channel stream. */
+#define FIO_REDIS_HISTORY_MAX_LEN 10000
+#endif
+
+#ifndef FIO_REDIS_HISTORY_PAGE
+/** Default number of stream entries fetched per replay page. */
+#define FIO_REDIS_HISTORY_PAGE 128
+#endif
+
+#ifndef FIO_REDIS_HISTORY_SKEW_MS
+/** Clock skew (ms) tolerated between publishers and the Redis server. */
+#define FIO_REDIS_HISTORY_SKEW_MS 5000
+#endif
+
+/** Arguments for creating a Redis Streams history manager */
+typedef struct {
+  /** Redis server URL (same formats as `fio_redis_args_s.url`). */
+  const char *url;
+  /** Redis server's password, if any. */
+  const char *auth;
+  /** Length of auth string (0 = auto-detect with strlen) */
+  size_t auth_len;
+  /** Stream key prefix (default: "fio:history:"). */
+  const char *prefix;
+  /** Approximate messages kept per channel (`XADD MAXLEN ~`, 0 = default). */
+  size_t max_len;
+  /** Largest message replayed, in bytes - larger ones are skipped (0 = 16MB) */
+  size_t payload_limit;
+  /** Stream entries fetched per replay page (0 = default). */
+  uint32_t page;
+  /** Number of client connections (0 = 1). */
+  uint8_t connections;
+  /** If set, this process replays history but never stores messages. */
+  uint8_t read_only;
+} fio_redis_history_args_s;
+
+/**
+ * Creates a pub/sub history manager that stores messages in Redis Streams,
+ * one stream per channel and filter.
+ *
+ * Attach it using `fio_pubsub_history_attach` - detaching frees the manager.
+ *
+ * Returns NULL on error.
+ */
+SFUNC fio_pubsub_history_s const *fio_redis_history_new(
+    fio_redis_history_args_s args);
+
+/** Creates a Redis Streams history manager (named arguments helper macro). */
+#define fio_redis_history_new(...)                                             \
+  fio_redis_history_new((fio_redis_history_args_s){__VA_ARGS__})
+
+/* *****************************************************************************
 
 
 
@@ -2076,12 +2230,13 @@ FIO_SFUNC void fio___redis_on_close_internal(fio_redis_engine_s *r,
   if (r->running && fio_io_is_running()) {
     FIO_LOG_WARNING("(redis) connection lost, reconnecting...");
     fio___redis_dup(r); /* timer ref - released by the timer's on_finish */
-    fio_io_run_every(.fn = fio___redis_connect_timer,
-                     .udata1 = r,
-                     .udata2 = conn,
-                     .every = 1000,
-                     .repetitions = 1,
-                     .on_finish = fio___redis_connect_timer_cleanup);
+    fio_timer_free(
+        fio_io_run_every(.fn = fio___redis_connect_timer,
+                         .udata1 = r,
+                         .udata2 = conn,
+                         .every = 1000,
+                         .repetitions = 1,
+                         .on_finish = fio___redis_connect_timer_cleanup));
   }
   /* No fio___redis_free here — connection holds no ownership ref */
 }
@@ -2129,12 +2284,13 @@ FIO_SFUNC void fio___redis_on_connect_failed(fio_io_protocol_s *protocol,
                     r->address,
                     r->port);
     fio___redis_dup(r); /* timer ref - released by the timer's on_finish */
-    fio_io_run_every(.fn = fio___redis_connect_timer,
-                     .udata1 = r,
-                     .udata2 = &r->conn,
-                     .every = 1000,
-                     .repetitions = 1,
-                     .on_finish = fio___redis_connect_timer_cleanup);
+    fio_timer_free(
+        fio_io_run_every(.fn = fio___redis_connect_timer,
+                         .udata1 = r,
+                         .udata2 = &r->conn,
+                         .every = 1000,
+                         .repetitions = 1,
+                         .on_finish = fio___redis_connect_timer_cleanup));
   }
 }
 
@@ -2196,12 +2352,13 @@ FIO_SFUNC void fio___redis_connect_impl(fio_redis_engine_s *r,
     FIO_LOG_ERROR("(redis) address too long: %s:%s", r->address, r->port);
     /* Same failure path as a failed connection attempt */
     fio___redis_dup(r); /* timer ref - released by the timer's on_finish */
-    fio_io_run_every(.fn = fio___redis_connect_timer,
-                     .udata1 = r,
-                     .udata2 = conn,
-                     .every = 1000,
-                     .repetitions = 1,
-                     .on_finish = fio___redis_connect_timer_cleanup);
+    fio_timer_free(
+        fio_io_run_every(.fn = fio___redis_connect_timer,
+                         .udata1 = r,
+                         .udata2 = conn,
+                         .every = 1000,
+                         .repetitions = 1,
+                         .on_finish = fio___redis_connect_timer_cleanup));
     return;
   }
   FIO_MEMCPY(url, "tcp://", 6);
@@ -2226,12 +2383,13 @@ FIO_SFUNC void fio___redis_connect_impl(fio_redis_engine_s *r,
                   r->port);
     /* Retry after delay - the timer holds its own ref (on_finish) */
     fio___redis_dup(r); /* timer ref - released by the timer's on_finish */
-    fio_io_run_every(.fn = fio___redis_connect_timer,
-                     .udata1 = r,
-                     .udata2 = conn,
-                     .every = 1000,
-                     .repetitions = 1,
-                     .on_finish = fio___redis_connect_timer_cleanup);
+    fio_timer_free(
+        fio_io_run_every(.fn = fio___redis_connect_timer,
+                         .udata1 = r,
+                         .udata2 = conn,
+                         .every = 1000,
+                         .repetitions = 1,
+                         .on_finish = fio___redis_connect_timer_cleanup));
     return;
   }
   /* Connection initiated successfully - the connection holds NO ref. */
@@ -2917,6 +3075,1104 @@ SFUNC int fio_redis_send(fio_pubsub_engine_s *engine,
   return 0;
 }
 
+/* *****************************************************************************
+Redis Command Client - Types
+
+The command client shares the engine's connection state (parser, payload
+budget, read buffer position) but not its lock-step queue: every connection in
+the pool writes commands as soon as they arrive (up to `pipeline` in flight)
+and matches replies to a per-connection FIFO of sent commands.
+
+Connections are per-process and lazy: the first command sent from a process
+opens the pool. Forked workers silently drop what they inherited (the master
+owns those sockets and callbacks) and open their own pool on demand.
+
+All queues are accessed only from the IO thread.
+***************************************************************************** */
+
+/** Client command node (the RESP bytes follow the node). */
+typedef struct {
+  FIO_LIST_NODE node;
+  void (*on_reply)(fio_redis_client_s *c, FIOBJ reply, void *udata);
+  void (*on_parsed)(fio_redis_client_s *c, void *reply, void *udata);
+  const fio_resp3_callbacks_s *callbacks;
+  void *udata;
+  /** Replies to discard before the command's own reply (MULTI / QUEUED). */
+  uint32_t skip;
+  size_t cmd_len;
+  uint8_t cmd[];
+} fio___redis_client_cmd_s;
+
+/** A pooled client connection. */
+typedef struct {
+  fio_redis_connection_s conn; /* io, parser, payload budget, ready flag */
+  fio_redis_client_s *client;
+  FIO_LIST_HEAD sent; /* commands awaiting replies, in wire order */
+  uint32_t in_flight;
+  /** The reply being parsed uses the head command's own callbacks. */
+  uint8_t user;
+  uint8_t idle; /* seconds without a reply (see `ping_interval`) */
+  uint8_t buf[FIO_REDIS_READ_BUFFER];
+} fio___redis_client_conn_s;
+
+struct fio_redis_client_s {
+  FIO_LIST_HEAD pending; /* commands waiting for a pipeline slot */
+  fio___redis_client_conn_s *pool;
+  char *url;
+  char *hello_cmd;
+  size_t hello_cmd_len;
+  uint32_t pipeline;
+  int pid; /* the process that opened the pool */
+  uint8_t count;
+  uint8_t ping_interval; /* seconds */
+  volatile uint8_t running;
+  uint8_t started;
+};
+
+FIO_SFUNC void fio___redis_client_destroy(fio_redis_client_s *c);
+FIO_SFUNC void fio___redis_client_on_fork(void *c_);
+
+/* FIO_REF: fio___redis_client_new(flex) / _dup / _free */
+#define FIO_REF_NAME             fio___redis_client
+#define FIO_REF_TYPE             fio_redis_client_s
+#define FIO_REF_DESTROY(c)       fio___redis_client_destroy(&(c))
+#define FIO_REF_CONSTRUCTOR_ONLY 1
+#define FIO_REF_FLEX_TYPE        char
+#include FIO_INCLUDE_FILE
+
+FIO_LEAK_COUNTER_DEF(fio___redis_client_cmd)
+
+/* *****************************************************************************
+Redis Command Client - Command Nodes
+***************************************************************************** */
+
+FIO_SFUNC fio___redis_client_cmd_s *fio___redis_client_cmd_alloc(size_t len) {
+  fio___redis_client_cmd_s *cmd = (fio___redis_client_cmd_s *)
+      FIO_MEM_REALLOC(NULL, 0, sizeof(*cmd) + len, 0);
+  if (!cmd)
+    return NULL;
+  FIO_LEAK_COUNTER_ON_ALLOC(fio___redis_client_cmd);
+  *cmd = (fio___redis_client_cmd_s){.cmd_len = len};
+  return cmd;
+}
+
+/** Frees a command, calling its callback with a lost reply if `notify`. */
+FIO_SFUNC void fio___redis_client_cmd_drop(fio_redis_client_s *c,
+                                           fio___redis_client_cmd_s *cmd,
+                                           int notify) {
+  if (notify) {
+    if (cmd->callbacks) {
+      if (cmd->on_parsed)
+        cmd->on_parsed(c, NULL, cmd->udata);
+    } else if (cmd->on_reply) {
+      cmd->on_reply(c, FIOBJ_INVALID, cmd->udata);
+    }
+  }
+  FIO_MEM_FREE(cmd, sizeof(*cmd) + cmd->cmd_len);
+  FIO_LEAK_COUNTER_ON_FREE(fio___redis_client_cmd);
+}
+
+FIO_SFUNC void fio___redis_client_drop_pending(fio_redis_client_s *c,
+                                               int notify) {
+  while (!FIO_LIST_IS_EMPTY(&c->pending)) {
+    fio___redis_client_cmd_s *cmd;
+    FIO_LIST_POP(fio___redis_client_cmd_s, node, cmd, &c->pending);
+    fio___redis_client_cmd_drop(c, cmd, notify);
+  }
+}
+
+/**
+ * Resets a pooled connection and drops its in-flight commands.
+ *
+ * A reply parsed by user callbacks owns user objects, which are released
+ * through the head command's `free_unused` before the FIOBJ reset runs.
+ */
+FIO_SFUNC void fio___redis_client_conn_reset(fio___redis_client_conn_s *cn,
+                                             int notify) {
+  fio_resp3_parser_s *p = &cn->conn.parser;
+  if (cn->user) {
+    fio___redis_client_cmd_s *cmd =
+        FIO_PTR_FROM_FIELD(fio___redis_client_cmd_s, node, cn->sent.next);
+    void (*free_unused)(void *, void *) = cmd->callbacks->free_unused;
+    if (free_unused) {
+      if (p->streaming_string && p->streaming_string_ctx)
+        free_unused(cmd->udata, p->streaming_string_ctx);
+      for (uint32_t i = p->depth; i--;) {
+        if (p->stack[i].key)
+          free_unused(cmd->udata, p->stack[i].key);
+        if (p->stack[i].ctx)
+          free_unused(cmd->udata, p->stack[i].ctx);
+      }
+    }
+    p->depth = 0;
+    p->streaming_string = 0;
+    cn->user = 0;
+  }
+  fio___redis_connection_reset(&cn->conn);
+  while (!FIO_LIST_IS_EMPTY(&cn->sent)) {
+    fio___redis_client_cmd_s *cmd;
+    FIO_LIST_POP(fio___redis_client_cmd_s, node, cmd, &cn->sent);
+    fio___redis_client_cmd_drop(cn->client, cmd, notify);
+  }
+  cn->in_flight = 0;
+}
+
+/* *****************************************************************************
+Redis Command Client - Dispatch (IO thread)
+***************************************************************************** */
+
+/** Writes a command to a ready connection, awaiting its reply. */
+FIO_SFUNC void fio___redis_client_write(fio___redis_client_conn_s *cn,
+                                        fio___redis_client_cmd_s *cmd,
+                                        const void *buf,
+                                        size_t len) {
+  FIO_LIST_PUSH(&cn->sent, &cmd->node);
+  ++cn->in_flight;
+  fio_io_write(cn->conn.io, (void *)buf, len);
+}
+
+/** Sends an internal command (HELLO, PING) ahead of the pending queue. */
+FIO_SFUNC int fio___redis_client_internal(
+    fio___redis_client_conn_s *cn,
+    const void *buf,
+    size_t len,
+    void (*on_reply)(fio_redis_client_s *, FIOBJ, void *)) {
+  fio___redis_client_cmd_s *cmd = fio___redis_client_cmd_alloc(0);
+  if (!cmd)
+    return -1;
+  cmd->on_reply = on_reply;
+  cmd->udata = cn;
+  fio___redis_client_write(cn, cmd, buf, len);
+  return 0;
+}
+
+/**
+ * Moves pending commands to the least loaded ready connections.
+ *
+ * Commands are written back to back without awaiting replies (the IO layer
+ * coalesces consecutive writes), until every connection's pipeline is full.
+ */
+FIO_SFUNC void fio___redis_client_flush(fio_redis_client_s *c) {
+  while (!FIO_LIST_IS_EMPTY(&c->pending)) {
+    fio___redis_client_conn_s *best = NULL;
+    for (size_t i = 0; i < c->count; ++i) {
+      fio___redis_client_conn_s *cn = c->pool + i;
+      if (!cn->conn.ready || cn->in_flight >= c->pipeline)
+        continue;
+      if (!best || cn->in_flight < best->in_flight)
+        best = cn;
+    }
+    if (!best)
+      return;
+    fio___redis_client_cmd_s *cmd;
+    FIO_LIST_POP(fio___redis_client_cmd_s, node, cmd, &c->pending);
+    fio___redis_client_write(best, cmd, cmd->cmd, cmd->cmd_len);
+  }
+}
+
+/* *****************************************************************************
+Redis Command Client - Protocol Callbacks
+***************************************************************************** */
+
+FIO_SFUNC void fio___redis_client_on_attach(fio_io_s *io);
+FIO_SFUNC void fio___redis_client_on_data(fio_io_s *io);
+FIO_SFUNC void fio___redis_client_on_close(void *buffer, void *udata);
+FIO_SFUNC void fio___redis_client_on_timeout(fio_io_s *io);
+FIO_SFUNC void fio___redis_client_connect(fio___redis_client_conn_s *cn);
+
+/**
+ * Protocol for pooled client connections (io udata is the connection).
+ *
+ * Clients share the protocol, so it times out every second and each
+ * connection counts idle seconds against its own client's `ping_interval`.
+ */
+static fio_io_protocol_s FIO___REDIS_CLIENT_PROTOCOL = {
+    .on_attach = fio___redis_client_on_attach,
+    .on_data = fio___redis_client_on_data,
+    .on_close = fio___redis_client_on_close,
+    .on_timeout = fio___redis_client_on_timeout,
+    .timeout = 1000,
+};
+
+/** HELLO 3 reply: a map, or a hard error that stops the client. */
+FIO_SFUNC void fio___redis_client_on_hello(fio_redis_client_s *c,
+                                           FIOBJ reply,
+                                           void *cn_) {
+  fio___redis_client_conn_s *cn = (fio___redis_client_conn_s *)cn_;
+  if (reply == FIOBJ_INVALID)
+    return; /* connection lost - the reconnect sends a fresh HELLO */
+  if (FIOBJ_TYPE(reply) == FIOBJ_T_HASH)
+    return;
+  FIO_LOG_ERROR("(redis) client HELLO 3 handshake failed (RESP3 requires "
+                "Redis >= 6.0; check auth) - client disabled");
+  c->running = 0;
+  fio_io_close_now(cn->conn.io); /* on_close fails everything queued */
+}
+
+FIO_SFUNC void fio___redis_client_on_attach(fio_io_s *io) {
+  fio___redis_client_conn_s *cn =
+      (fio___redis_client_conn_s *)fio_io_udata(io);
+  if (!cn)
+    return;
+  fio_redis_client_s *c = cn->client;
+  cn->conn.io = io;
+  cn->idle = 0;
+  /* HELLO leads the wire; commands pipeline right behind it. */
+  if (fio___redis_client_internal(cn,
+                                  c->hello_cmd,
+                                  c->hello_cmd_len,
+                                  fio___redis_client_on_hello)) {
+    FIO_LOG_ERROR("(redis) failed to allocate HELLO command");
+    fio_io_close_now(io);
+    return;
+  }
+  cn->conn.ready = 1;
+  fio___redis_client_flush(c);
+}
+
+/**
+ * Parses every complete reply in the connection's buffer and delivers it.
+ *
+ * Routing is decided per top-level frame: push frames (`>`) and replies to
+ * discard (MULTI's +OK / +QUEUED) are built as FIOBJ; a command that provided
+ * `callbacks` has its own reply parsed straight into user objects (with the
+ * command's udata as the parser's udata).
+ */
+FIO_SFUNC void fio___redis_client_parse(fio_redis_client_s *c,
+                                        fio___redis_client_conn_s *cn,
+                                        fio_io_s *io) {
+  fio_redis_connection_s *conn = &cn->conn;
+  uint8_t *buf = cn->buf;
+  size_t pos = 0;
+  while (pos < conn->buf_pos) {
+    fio___redis_client_cmd_s *cmd = NULL;
+    if (!FIO_LIST_IS_EMPTY(&cn->sent))
+      cmd = FIO_PTR_FROM_FIELD(fio___redis_client_cmd_s, node, cn->sent.next);
+    if (!conn->parser.depth && !conn->parser.streaming_string) {
+      cn->user = (cmd && cmd->callbacks && !cmd->skip && buf[pos] != '>');
+      conn->parser.udata = cn->user ? cmd->udata : (void *)&conn->ps;
+    }
+    const fio_resp3_callbacks_s *callbacks =
+        cn->user ? cmd->callbacks : &FIO___REDIS_RESP3_CALLBACKS;
+    fio_resp3_result_s result = fio_resp3_parse(&conn->parser,
+                                                callbacks,
+                                                buf + pos,
+                                                conn->buf_pos - pos);
+    if (result.err || conn->ps.limit_exceeded) {
+      FIO_LOG_ERROR("(redis) client %s - closing connection",
+                    conn->ps.limit_exceeded ? "payload limit exceeded"
+                                            : "parser error");
+      fio_io_close_now(io);
+      return;
+    }
+    pos += result.consumed;
+    if (!result.obj)
+      break;
+    conn->ps.msg_total = 0;
+
+    if (cn->user) {
+      cn->user = 0;
+      conn->parser.udata = &conn->ps;
+      FIO_LIST_REMOVE(&cmd->node);
+      --cn->in_flight;
+      if (cmd->on_parsed)
+        cmd->on_parsed(c, result.obj, cmd->udata);
+      fio___redis_client_cmd_drop(c, cmd, 0);
+    } else {
+      FIOBJ reply = (FIOBJ)result.obj;
+      if (conn->ps.is_push) {
+        conn->ps.is_push = 0;
+        fio___redis_capture_reset(&conn->ps);
+      } else if (!cmd) {
+        FIO_LOG_WARNING("(redis) client received a reply with no command");
+      } else if (cmd->skip) {
+        --cmd->skip;
+      } else {
+        FIO_LIST_REMOVE(&cmd->node);
+        --cn->in_flight;
+        if (cmd->on_reply)
+          cmd->on_reply(c, reply, cmd->udata);
+        fio___redis_client_cmd_drop(c, cmd, 0);
+      }
+      fiobj_free(reply);
+    }
+    if (!c->running)
+      return; /* handshake failed, the connection is closing */
+  }
+
+  if (pos) {
+    fio___redis_capture_freeze(&conn->ps);
+    conn->buf_pos -= (FIO___REDIS_BUF_POS_T)pos;
+    if (conn->buf_pos)
+      FIO_MEMMOVE(buf, buf + pos, conn->buf_pos);
+  } else if (conn->buf_pos == FIO_REDIS_READ_BUFFER) {
+    FIO_LOG_ERROR("(redis) client reply element exceeds the read buffer - "
+                  "closing connection");
+    fio_io_close_now(io);
+  }
+}
+
+FIO_SFUNC void fio___redis_client_on_data(fio_io_s *io) {
+  fio___redis_client_conn_s *cn =
+      (fio___redis_client_conn_s *)fio_io_udata(io);
+  if (!cn)
+    return;
+  fio_redis_client_s *c = cn->client;
+  fio_redis_connection_s *conn = &cn->conn;
+  size_t len = fio_io_read(io,
+                           cn->buf + conn->buf_pos,
+                           FIO_REDIS_READ_BUFFER - conn->buf_pos);
+  if (!len)
+    return;
+  cn->idle = 0;
+  conn->buf_pos += (FIO___REDIS_BUF_POS_T)len;
+  /* reply callbacks may release the last reference */
+  fio___redis_client_dup(c);
+  fio___redis_client_parse(c, cn, io);
+  if (c->running)
+    fio___redis_client_flush(c); /* replies freed pipeline slots */
+  fio___redis_client_free(c);
+}
+
+/** Retry timer: the timer's client ref is released by on_finish. */
+FIO_SFUNC int fio___redis_client_connect_timer(void *c_, void *cn_) {
+  fio___redis_client_connect((fio___redis_client_conn_s *)cn_);
+  return 0;
+  (void)c_;
+}
+
+FIO_SFUNC void fio___redis_client_connect_timer_cleanup(void *c_, void *cn_) {
+  fio___redis_client_free((fio_redis_client_s *)c_);
+  (void)cn_;
+}
+
+FIO_SFUNC void fio___redis_client_retry(fio___redis_client_conn_s *cn) {
+  fio_redis_client_s *c = cn->client;
+  if (!c->running || !fio_io_is_running())
+    return;
+  fio___redis_client_dup(c); /* timer ref - released by the timer's on_finish */
+  fio_timer_free(
+      fio_io_run_every(.fn = fio___redis_client_connect_timer,
+                       .udata1 = c,
+                       .udata2 = cn,
+                       .every = 1000,
+                       .repetitions = 1,
+                       .on_finish = fio___redis_client_connect_timer_cleanup));
+}
+
+/**
+ * Connection closed (or failed to connect).
+ *
+ * In-flight commands fail (they may or may not have executed); pending
+ * commands stay queued for the other connections or the reconnect. A socket
+ * inherited by a forked worker is dropped silently.
+ */
+FIO_SFUNC void fio___redis_client_closed(fio___redis_client_conn_s *cn) {
+  fio_redis_client_s *c = cn->client;
+  if (c->pid != fio_io_pid()) {
+    fio___redis_client_conn_reset(cn, 0);
+    return;
+  }
+  fio___redis_client_conn_reset(cn, 1);
+  if (!c->running) {
+    fio___redis_client_drop_pending(c, 1);
+    return;
+  }
+  FIO_LOG_WARNING("(redis) client connection to %s lost, reconnecting...",
+                  c->url);
+  fio___redis_client_retry(cn);
+}
+
+FIO_SFUNC void fio___redis_client_on_close(void *buffer, void *udata) {
+  if (udata)
+    fio___redis_client_closed((fio___redis_client_conn_s *)udata);
+  (void)buffer;
+}
+
+FIO_SFUNC void fio___redis_client_on_connect_failed(fio_io_protocol_s *pr,
+                                                    void *udata) {
+  if (udata)
+    fio___redis_client_closed((fio___redis_client_conn_s *)udata);
+  (void)pr;
+}
+
+FIO_SFUNC void fio___redis_client_on_timeout(fio_io_s *io) {
+  fio___redis_client_conn_s *cn =
+      (fio___redis_client_conn_s *)fio_io_udata(io);
+  if (!cn || ++cn->idle < cn->client->ping_interval)
+    return;
+  cn->idle = 0;
+  if (cn->in_flight) {
+    FIO_LOG_WARNING("(redis) client server unresponsive, disconnecting");
+    fio_io_close_now(io);
+    return;
+  }
+  fio___redis_client_internal(cn, "*1\r\n$4\r\nPING\r\n", 14, NULL);
+}
+
+/* *****************************************************************************
+Redis Command Client - Connections and Lifetime
+***************************************************************************** */
+
+FIO_SFUNC void fio___redis_client_connect(fio___redis_client_conn_s *cn) {
+  fio_redis_client_s *c = cn->client;
+  if (!c->running || cn->conn.io)
+    return;
+  fio_io_s *io =
+      fio_io_connect(c->url,
+                     .protocol = &FIO___REDIS_CLIENT_PROTOCOL,
+                     .udata = cn,
+                     .on_failed = fio___redis_client_on_connect_failed,
+                     .timeout = 30000);
+  cn->conn.io = io;
+  if (cn->conn.io)
+    return;
+  FIO_LOG_ERROR("(redis) client failed to initiate connection to %s", c->url);
+  fio___redis_client_retry(cn);
+}
+
+/** Opens the pool in the current process (on the first command). */
+FIO_SFUNC void fio___redis_client_start(fio_redis_client_s *c) {
+  c->started = 1;
+  c->pid = fio_io_pid();
+  for (size_t i = 0; i < c->count; ++i)
+    fio___redis_client_connect(c->pool + i);
+}
+
+/** Queues a command (IO thread) - consumes the task's client reference. */
+FIO_SFUNC void fio___redis_client_send_task(void *c_, void *cmd_) {
+  fio_redis_client_s *c = (fio_redis_client_s *)c_;
+  fio___redis_client_cmd_s *cmd = (fio___redis_client_cmd_s *)cmd_;
+  if (!c->running) {
+    fio___redis_client_cmd_drop(c, cmd, 1);
+  } else {
+    FIO_LIST_PUSH(&c->pending, &cmd->node);
+    if (!c->started)
+      fio___redis_client_start(c);
+    fio___redis_client_flush(c);
+  }
+  fio___redis_client_free(c);
+}
+
+/** Forked worker: the master owns inherited sockets and commands. */
+FIO_SFUNC void fio___redis_client_on_fork(void *c_) {
+  fio_redis_client_s *c = (fio_redis_client_s *)c_;
+  for (size_t i = 0; i < c->count; ++i)
+    fio___redis_client_conn_reset(c->pool + i, 0);
+  fio___redis_client_drop_pending(c, 0);
+  c->started = 0;
+  /* allocated (and freed) by the master */
+  FIO_LEAK_COUNTER_ON_FREE(fio___redis_client);
+}
+
+FIO_SFUNC void fio___redis_client_destroy(fio_redis_client_s *c) {
+  c->running = 0;
+  fio_state_callback_remove(FIO_CALL_IN_CHILD, fio___redis_client_on_fork, c);
+  for (size_t i = 0; i < c->count; ++i) {
+    fio___redis_client_conn_s *cn = c->pool + i;
+    /* detach from the io's close path (see fio___redis_destroy) */
+    fio_io_s *io = cn->conn.io;
+    if (io) {
+      void *ud = fio_io_udata(io);
+      if (cn->conn.ready || ud == (void *)cn)
+        fio_io_udata_set(io, NULL);
+      else
+        ((fio___io_connecting_s *)ud)->udata = NULL;
+      fio_io_close_now(io);
+    }
+    fio___redis_client_conn_reset(cn, 1);
+  }
+  fio___redis_client_drop_pending(c, 1);
+}
+
+/* *****************************************************************************
+Redis Command Client - Public API
+***************************************************************************** */
+
+void fio_redis_client_new____(void); /* IDE marker */
+SFUNC fio_redis_client_s *fio_redis_client_new FIO_NOOP(
+    fio_redis_client_args_s args) {
+  const char *host = "localhost";
+  size_t host_len = 9;
+  const char *port = "6379";
+  size_t port_len = 4;
+  if (args.url && args.url[0]) {
+    fio_url_s u = fio_url_parse(args.url, strlen(args.url));
+    if (u.host.buf && u.host.len) {
+      host = u.host.buf;
+      host_len = u.host.len;
+    }
+    if (u.port.buf && u.port.len) {
+      port = u.port.buf;
+      port_len = u.port.len;
+    }
+  }
+  if (!args.ping_interval)
+    args.ping_interval = 30;
+  if (!args.payload_limit)
+    args.payload_limit = FIO___REDIS_DEFAULT_PAYLOAD_LIMIT;
+  if (!args.pipeline)
+    args.pipeline = FIO_REDIS_CLIENT_PIPELINE;
+  if (!args.connections)
+    args.connections = 1;
+  size_t auth_len = args.auth_len;
+  if (args.auth && !auth_len)
+    auth_len = strlen(args.auth);
+
+  const size_t url_len = 6 + host_len + 1 + port_len; /* tcp://host:port */
+  const size_t hello_cmd_len = fio___redis_hello_cmd_len(auth_len);
+  const size_t pool_size =
+      sizeof(fio___redis_client_conn_s) * (size_t)args.connections;
+  fio_redis_client_s *c =
+      fio___redis_client_new(pool_size + url_len + 1 + hello_cmd_len + 1);
+  if (!c) {
+    FIO_LOG_ERROR("(redis) failed to allocate client");
+    return NULL;
+  }
+
+  *c = (fio_redis_client_s){
+      .pending = FIO_LIST_INIT(c->pending),
+      .pool = (fio___redis_client_conn_s *)(c + 1),
+      .pipeline = args.pipeline,
+      .count = args.connections,
+      .ping_interval = args.ping_interval,
+      .running = 1,
+  };
+  for (size_t i = 0; i < c->count; ++i) {
+    /* the read buffers need no initialization */
+    fio___redis_client_conn_s *cn = c->pool + i;
+    FIO_MEMSET(&cn->conn, 0, sizeof(cn->conn));
+    cn->conn.ps.payload_limit = args.payload_limit;
+    cn->conn.parser.udata = &cn->conn.ps;
+    cn->client = c;
+    cn->sent = FIO_LIST_INIT(cn->sent);
+    cn->in_flight = 0;
+    cn->user = 0;
+  }
+
+  c->url = (char *)(c->pool + c->count);
+  FIO_MEMCPY(c->url, "tcp://", 6);
+  FIO_MEMCPY(c->url + 6, host, host_len);
+  c->url[6 + host_len] = ':';
+  FIO_MEMCPY(c->url + 7 + host_len, port, port_len);
+  c->url[url_len] = 0;
+
+  c->hello_cmd = c->url + url_len + 1;
+  c->hello_cmd_len =
+      fio___redis_write_hello_cmd((uint8_t *)c->hello_cmd, args.auth, auth_len);
+  c->hello_cmd[c->hello_cmd_len] = 0;
+
+  fio_state_callback_add(FIO_CALL_IN_CHILD, fio___redis_client_on_fork, c);
+  FIO_LOG_DEBUG("(redis) client created for %s (%u connections)",
+                c->url,
+                (unsigned)c->count);
+  return c;
+}
+
+SFUNC fio_redis_client_s *fio_redis_client_dup(fio_redis_client_s *c) {
+  if (c)
+    fio___redis_client_dup(c);
+  return c;
+}
+
+SFUNC void fio_redis_client_free(fio_redis_client_s *c) {
+  if (c)
+    fio___redis_client_free(c);
+}
+
+SFUNC int fio_redis_client_send FIO_NOOP(fio_redis_client_s *c,
+                                         fio_redis_client_send_args_s args) {
+  static const char multi_cmd[] = "*1\r\n$5\r\nMULTI\r\n";
+  static const char exec_cmd[] = "*1\r\n$4\r\nEXEC\r\n";
+  if (!c)
+    return -1;
+  size_t len = 0;
+  uint32_t count = 0;
+  if (FIOBJ_TYPE(args.cmd) == FIOBJ_T_ARRAY) {
+    len = fio___redis_fiobj2resp_len(args.cmd, 0);
+    if (!len)
+      return -1;
+  } else {
+    if (FIOBJ_TYPE(args.multi) != FIOBJ_T_ARRAY)
+      return -1;
+    count = (uint32_t)fiobj_array_count(args.multi);
+    if (!count)
+      return -1;
+    len = (sizeof(multi_cmd) - 1) + (sizeof(exec_cmd) - 1);
+    for (uint32_t i = 0; i < count; ++i) {
+      FIOBJ o = fiobj_array_get(args.multi, i);
+      size_t l;
+      if (FIOBJ_TYPE(o) != FIOBJ_T_ARRAY ||
+          !(l = fio___redis_fiobj2resp_len(o, 0)))
+        return -1;
+      len += l;
+    }
+  }
+
+  fio___redis_client_cmd_s *cmd = fio___redis_client_cmd_alloc(len);
+  if (!cmd)
+    return -1;
+  cmd->on_reply = args.on_reply;
+  cmd->on_parsed = args.on_parsed;
+  cmd->callbacks = args.callbacks;
+  cmd->udata = args.udata;
+  if (!count) {
+    fio___redis_fiobj2resp_write(cmd->cmd, args.cmd, 0);
+  } else {
+    /* MULTI's +OK and each +QUEUED precede the EXEC reply */
+    uint8_t *pos = cmd->cmd;
+    cmd->skip = count + 1;
+    FIO_MEMCPY(pos, multi_cmd, sizeof(multi_cmd) - 1);
+    pos += sizeof(multi_cmd) - 1;
+    for (uint32_t i = 0; i < count; ++i)
+      pos = fio___redis_fiobj2resp_write(pos,
+                                         fiobj_array_get(args.multi, i),
+                                         0);
+    FIO_MEMCPY(pos, exec_cmd, sizeof(exec_cmd) - 1);
+  }
+  fio___redis_client_dup(c); /* the send task's reference */
+  fio_io_defer(fio___redis_client_send_task, c, cmd);
+  return 0;
+}
+
+/* *****************************************************************************
+Redis Pub/Sub History - Types
+***************************************************************************** */
+
+typedef struct {
+  /* MUST be the first field - the manager pointer is the history pointer */
+  fio_pubsub_history_s manager;
+  fio_redis_client_s *client; /* XADD (pipelined) */
+  fio_redis_client_s *replay; /* XRANGE (a connection of its own) */
+  size_t max_len;
+  size_t payload_limit;
+  uint32_t page;
+  uint8_t read_only;
+  size_t prefix_len;
+  char prefix[];
+} fio___redis_history_s;
+
+/* a replay in progress - entries are parsed and delivered one at a time */
+typedef struct {
+  fio_redis_client_s *client;
+  void (*on_message)(fio_pubsub_msg_s *msg, void *udata);
+  void (*on_done)(void *udata);
+  void *udata;
+  FIOBJ cmd; /* XRANGE key <start> <end> COUNT <page> */
+  FIOBJ m;   /* the entry's message, while parsed */
+  uint64_t t;
+  uint64_t i;
+  uint64_t since;
+  uint64_t until;
+  size_t limit;      /* largest message replayed */
+  uint32_t page;     /* entries requested per page */
+  uint32_t received; /* entries in the current page */
+  uint32_t depth;    /* open containers: reply, entry, field list */
+  uint32_t pos;      /* position in the field list (name, value, ...) */
+  char field;        /* the current field's (single byte) name */
+  uint8_t skip;      /* the message exceeds `limit` */
+  uint8_t stream;    /* the message is being streamed */
+  uint8_t failed;    /* the reply was an error */
+  uint8_t id_len;
+  char id[48]; /* the last entry's ID: <ms>-<seq> */
+  int16_t filter;
+  size_t channel_len;
+  char channel[];
+} fio___redis_history_replay_s;
+
+FIO_LEAK_COUNTER_DEF(fio___redis_history)
+FIO_LEAK_COUNTER_DEF(fio___redis_history_replay)
+
+/* *****************************************************************************
+Redis Pub/Sub History - Helpers
+***************************************************************************** */
+
+/** Returns a new FIOBJ String containing the decimal value of `i`. */
+FIO_SFUNC FIOBJ fio___redis_history_num(int64_t i) {
+  char buf[32];
+  return fiobj_str_new_cstr(buf, fio_ltoa(buf, i, 10));
+}
+
+/** Returns a new FIOBJ String with the stream key: <prefix><filter>:<channel> */
+FIO_SFUNC FIOBJ fio___redis_history_key(fio___redis_history_s *h,
+                                        fio_buf_info_s channel,
+                                        int16_t filter) {
+  char buf[32];
+  size_t len = fio_ltoa(buf, (int64_t)filter, 10);
+  buf[len++] = ':';
+  FIOBJ key = fiobj_str_new_buf(h->prefix_len + len + channel.len);
+  fiobj_str_write(key, h->prefix, h->prefix_len);
+  fiobj_str_write(key, buf, len);
+  fiobj_str_write(key, channel.buf, channel.len);
+  return key;
+}
+
+/* *****************************************************************************
+Redis Pub/Sub History - Replay Parser (IO thread)
+
+XRANGE replies are parsed straight from the replay connection's read buffer:
+[[id, [name, value, ...]], ...] (the field list may also be a map). Only the
+entry being parsed is kept in memory; large messages are streamed into it.
+Every callback returns the replay as its (non-NULL) object.
+***************************************************************************** */
+
+/** Delivers a complete entry and resets the entry's state. */
+FIO_SFUNC void fio___redis_history_entry_done(fio___redis_history_replay_s *r) {
+  ++r->received;
+  if (r->skip)
+    FIO_LOG_WARNING("(redis) history entry %.*s exceeds payload_limit - "
+                    "skipped",
+                    (int)r->id_len,
+                    r->id);
+  else if (r->m && r->t <= r->until && r->t >= r->since) {
+    /* newer messages are delivered live */
+    fio_str_info_s data = fiobj2cstr(r->m);
+    fio_pubsub_msg_s msg = {
+        .timestamp = r->t,
+        .id = r->i,
+        .channel = FIO_BUF_INFO2(r->channel, r->channel_len),
+        .message = FIO_BUF_INFO2(data.buf, data.len),
+        .filter = r->filter,
+    };
+    r->on_message(&msg, r->udata);
+  }
+  fiobj_free(r->m);
+  r->m = FIOBJ_INVALID;
+  r->t = r->i = 0;
+  r->skip = 0;
+}
+
+FIO_SFUNC void *fio___redis_history_on_container(void *r_,
+                                                 void *parent,
+                                                 int64_t len) {
+  fio___redis_history_replay_s *r = (fio___redis_history_replay_s *)r_;
+  if (!r->depth++)
+    r->received = 0;
+  r->pos = 0;
+  return r_;
+  (void)parent, (void)len;
+}
+
+FIO_SFUNC void *fio___redis_history_on_container_done(void *r_, void *ctx) {
+  fio___redis_history_replay_s *r = (fio___redis_history_replay_s *)r_;
+  if (r->depth-- == 2)
+    fio___redis_history_entry_done(r);
+  return ctx;
+}
+
+/** Handles a string (or a streamed string's first bytes) by position. */
+FIO_SFUNC void fio___redis_history_on_field(fio___redis_history_replay_s *r,
+                                            const void *data,
+                                            size_t len,
+                                            size_t total) {
+  if (r->depth == 2) { /* the entry's ID */
+    r->id_len = 0;
+    if (len < sizeof(r->id)) {
+      FIO_MEMCPY(r->id, data, len);
+      r->id_len = (uint8_t)len;
+    }
+    return;
+  }
+  if (r->depth != 3)
+    return;
+  if (!(r->pos++ & 1)) { /* a field name */
+    r->field = (len == 1) ? ((const char *)data)[0] : 0;
+    return;
+  }
+  char *p = (char *)data;
+  switch (r->field) {
+  case 't': r->t = (uint64_t)fio_atol(&p); break;
+  case 'i': r->i = (uint64_t)fio_atol(&p); break;
+  case 'm':
+    fiobj_free(r->m);
+    r->m = FIOBJ_INVALID;
+    if ((r->skip = (total > r->limit)))
+      break;
+    r->m = fiobj_str_new_buf(total);
+    fiobj_str_write(r->m, (const char *)data, len);
+    r->stream = !data;
+    break;
+  }
+}
+
+FIO_SFUNC void *fio___redis_history_on_string(void *r_,
+                                              const void *data,
+                                              size_t len,
+                                              uint8_t type) {
+  fio___redis_history_on_field((fio___redis_history_replay_s *)r_,
+                               data,
+                               len,
+                               len);
+  return r_;
+  (void)type;
+}
+
+FIO_SFUNC void *fio___redis_history_on_start_string(void *r_,
+                                                    size_t len,
+                                                    uint8_t type) {
+  fio___redis_history_replay_s *r = (fio___redis_history_replay_s *)r_;
+  if (len <= FIO_RESP3_STREAM_THRESHOLD)
+    return NULL; /* buffered by the parser, see `on_string` */
+  if (len == (size_t)-1) /* chunked: bounded by `limit` while written */
+    len = 0;
+  fio___redis_history_on_field(r, NULL, 0, len);
+  return r_;
+  (void)type;
+}
+
+FIO_SFUNC int fio___redis_history_on_string_write(void *r_,
+                                                  void *ctx,
+                                                  const void *data,
+                                                  size_t len) {
+  fio___redis_history_replay_s *r = (fio___redis_history_replay_s *)r_;
+  if (!r->stream)
+    return 0; /* only the message is kept (IDs are never streamed) */
+  if (len > r->limit - fiobj_str_len(r->m)) {
+    fiobj_free(r->m);
+    r->m = FIOBJ_INVALID;
+    r->skip = 1;
+    r->stream = 0;
+    return 0;
+  }
+  fiobj_str_write(r->m, (const char *)data, len);
+  return 0;
+  (void)ctx;
+}
+
+FIO_SFUNC void *fio___redis_history_on_string_done(void *r_,
+                                                   void *ctx,
+                                                   uint8_t type) {
+  ((fio___redis_history_replay_s *)r_)->stream = 0;
+  return ctx;
+  (void)type;
+}
+
+FIO_SFUNC void *fio___redis_history_on_error(void *r_,
+                                             const void *data,
+                                             size_t len,
+                                             uint8_t type) {
+  fio___redis_history_replay_s *r = (fio___redis_history_replay_s *)r_;
+  FIO_LOG_WARNING("(redis) history replay error: %.*s",
+                  (int)len,
+                  (const char *)data);
+  r->failed = 1;
+  return r_;
+  (void)type;
+}
+
+static const fio_resp3_callbacks_s FIO___REDIS_HISTORY_CALLBACKS = {
+    .on_string = fio___redis_history_on_string,
+    .on_error = fio___redis_history_on_error,
+    .on_array = fio___redis_history_on_container,
+    .on_map = fio___redis_history_on_container,
+    .array_done = fio___redis_history_on_container_done,
+    .map_done = fio___redis_history_on_container_done,
+    .on_start_string = fio___redis_history_on_start_string,
+    .on_string_write = fio___redis_history_on_string_write,
+    .on_string_done = fio___redis_history_on_string_done,
+};
+
+/* *****************************************************************************
+Redis Pub/Sub History - Replay (IO thread)
+***************************************************************************** */
+
+FIO_SFUNC void fio___redis_history_on_page(fio_redis_client_s *c,
+                                           void *reply,
+                                           void *r_);
+
+FIO_SFUNC void fio___redis_history_replay_finish(
+    fio___redis_history_replay_s *r) {
+  r->on_done(r->udata);
+  fiobj_free(r->cmd);
+  fiobj_free(r->m);
+  fio_redis_client_free(r->client);
+  FIO_LEAK_COUNTER_ON_FREE(fio___redis_history_replay);
+  FIO_MEM_FREE(r, sizeof(*r) + r->channel_len);
+}
+
+/** Sends the next XRANGE page request, returns -1 on error. */
+FIO_SFUNC int fio___redis_history_replay_next(fio___redis_history_replay_s *r) {
+  r->depth = 0;
+  return fio_redis_client_send(r->client,
+                               .cmd = r->cmd,
+                               .callbacks = &FIO___REDIS_HISTORY_CALLBACKS,
+                               .on_parsed = fio___redis_history_on_page,
+                               .udata = r);
+}
+
+FIO_SFUNC void fio___redis_history_on_page(fio_redis_client_s *c,
+                                           void *reply,
+                                           void *r_) {
+  fio___redis_history_replay_s *r = (fio___redis_history_replay_s *)r_;
+  /* lost connection, error reply, or the stream's end */
+  if (reply != r_ || r->failed || r->received < r->page || !r->id_len)
+    goto finish;
+  { /* continue after the last entry (exclusive range) */
+    FIOBJ start = fiobj_str_new_buf((size_t)r->id_len + 1);
+    fiobj_str_write(start, "(", 1);
+    fiobj_str_write(start, r->id, r->id_len);
+    fiobj_array_set(r->cmd, 2, start, NULL);
+  }
+  if (!fio___redis_history_replay_next(r))
+    return;
+finish:
+  fio___redis_history_replay_finish(r);
+  (void)c;
+}
+
+/* *****************************************************************************
+Redis Pub/Sub History - Manager Callbacks
+***************************************************************************** */
+
+FIO_SFUNC void fio___redis_history_detached(const fio_pubsub_history_s *hist) {
+  fio___redis_history_s *h = (fio___redis_history_s *)hist;
+  fio_redis_client_free(h->client);
+  fio_redis_client_free(h->replay);
+  FIO_LEAK_COUNTER_ON_FREE(fio___redis_history);
+  FIO_MEM_FREE(h, sizeof(*h) + h->prefix_len + 1);
+}
+
+FIO_SFUNC int fio___redis_history_push(const fio_pubsub_history_s *hist,
+                                       fio_pubsub_msg_s *msg) {
+  fio___redis_history_s *h = (fio___redis_history_s *)hist;
+  if (h->read_only)
+    return 0;
+  /* auto IDs: worker timestamps may arrive slightly out of order */
+  FIOBJ cmd = fiobj_array_new();
+  fiobj_array_push(cmd, fiobj_str_new_cstr("XADD", 4));
+  fiobj_array_push(cmd, fio___redis_history_key(h, msg->channel, msg->filter));
+  fiobj_array_push(cmd, fiobj_str_new_cstr("MAXLEN", 6));
+  fiobj_array_push(cmd, fiobj_str_new_cstr("~", 1));
+  fiobj_array_push(cmd, fio___redis_history_num((int64_t)h->max_len));
+  fiobj_array_push(cmd, fiobj_str_new_cstr("*", 1));
+  fiobj_array_push(cmd, fiobj_str_new_cstr("t", 1));
+  fiobj_array_push(cmd, fio___redis_history_num((int64_t)msg->timestamp));
+  fiobj_array_push(cmd, fiobj_str_new_cstr("i", 1));
+  fiobj_array_push(cmd, fio___redis_history_num((int64_t)msg->id));
+  fiobj_array_push(cmd, fiobj_str_new_cstr("m", 1));
+  fiobj_array_push(cmd,
+                   fiobj_str_new_cstr(msg->message.buf, msg->message.len));
+  int r = fio_redis_client_send(h->client, .cmd = cmd);
+  fiobj_free(cmd);
+  return r;
+}
+
+FIO_SFUNC int fio___redis_history_replay(
+    const fio_pubsub_history_s *hist,
+    fio_buf_info_s channel,
+    int16_t filter,
+    uint64_t since,
+    void (*on_message)(fio_pubsub_msg_s *msg, void *udata),
+    void (*on_done)(void *udata),
+    void *udata) {
+  fio___redis_history_s *h = (fio___redis_history_s *)hist;
+  fio___redis_history_replay_s *r = (fio___redis_history_replay_s *)
+      FIO_MEM_REALLOC(NULL, 0, sizeof(*r) + channel.len, 0);
+  if (!r)
+    goto no_memory;
+  FIO_LEAK_COUNTER_ON_ALLOC(fio___redis_history_replay);
+  *r = (fio___redis_history_replay_s){
+      .client = fio_redis_client_dup(h->replay),
+      .on_message = on_message,
+      .on_done = on_done,
+      .udata = udata,
+      .cmd = fiobj_array_new(),
+      .since = since,
+      .until = fio_io_last_tick(),
+      .limit = h->payload_limit,
+      .page = h->page,
+      .filter = filter,
+      .channel_len = channel.len,
+  };
+  if (channel.len)
+    FIO_MEMCPY(r->channel, channel.buf, channel.len);
+  /* stream IDs use the server's clock, widen the range by the skew */
+  fiobj_array_push(r->cmd, fiobj_str_new_cstr("XRANGE", 6));
+  fiobj_array_push(r->cmd, fio___redis_history_key(h, channel, filter));
+  if (since > FIO_REDIS_HISTORY_SKEW_MS)
+    fiobj_array_push(
+        r->cmd,
+        fio___redis_history_num((int64_t)(since - FIO_REDIS_HISTORY_SKEW_MS)));
+  else
+    fiobj_array_push(r->cmd, fiobj_str_new_cstr("-", 1));
+  fiobj_array_push(
+      r->cmd,
+      fio___redis_history_num((int64_t)(r->until + FIO_REDIS_HISTORY_SKEW_MS)));
+  fiobj_array_push(r->cmd, fiobj_str_new_cstr("COUNT", 5));
+  fiobj_array_push(r->cmd, fio___redis_history_num((int64_t)r->page));
+  if (!fio___redis_history_replay_next(r))
+    return 0;
+  fio___redis_history_replay_finish(r);
+  return -1;
+no_memory:
+  on_done(udata);
+  return -1;
+}
+
+FIO_SFUNC uint64_t fio___redis_history_oldest(const fio_pubsub_history_s *hist,
+                                              fio_buf_info_s channel,
+                                              int16_t filter) {
+  /* Redis is authoritative - offer to replay anything not cached locally */
+  return 0;
+  (void)hist, (void)channel, (void)filter;
+}
+
+/* *****************************************************************************
+Redis Pub/Sub History - Public API
+***************************************************************************** */
+
+void fio_redis_history_new____(void); /* IDE marker */
+SFUNC fio_pubsub_history_s const *fio_redis_history_new FIO_NOOP(
+    fio_redis_history_args_s args) {
+  if (!args.prefix)
+    args.prefix = "fio:history:";
+  if (!args.max_len)
+    args.max_len = FIO_REDIS_HISTORY_MAX_LEN;
+  if (!args.page)
+    args.page = FIO_REDIS_HISTORY_PAGE;
+  if (!args.payload_limit)
+    args.payload_limit = FIO___REDIS_DEFAULT_PAYLOAD_LIMIT;
+  const size_t prefix_len = strlen(args.prefix);
+  fio___redis_history_s *h = (fio___redis_history_s *)
+      FIO_MEM_REALLOC(NULL, 0, sizeof(*h) + prefix_len + 1, 0);
+  if (!h)
+    goto no_memory;
+  *h = (fio___redis_history_s){
+      .manager =
+          {
+              .detached = fio___redis_history_detached,
+              .push = fio___redis_history_push,
+              .replay = fio___redis_history_replay,
+              .oldest = fio___redis_history_oldest,
+          },
+      .client = fio_redis_client_new(.url = args.url,
+                                     .auth = args.auth,
+                                     .auth_len = args.auth_len,
+                                     .connections = args.connections),
+      /* replies are streamed, a failed replay never fails an XADD */
+      .replay = fio_redis_client_new(.url = args.url,
+                                     .auth = args.auth,
+                                     .auth_len = args.auth_len),
+      .max_len = args.max_len,
+      .payload_limit = args.payload_limit,
+      .page = args.page,
+      .read_only = args.read_only,
+      .prefix_len = prefix_len,
+  };
+  if (!h->client || !h->replay) {
+    fio_redis_client_free(h->client);
+    fio_redis_client_free(h->replay);
+    FIO_MEM_FREE(h, sizeof(*h) + prefix_len + 1);
+    return NULL;
+  }
+  FIO_LEAK_COUNTER_ON_ALLOC(fio___redis_history);
+  FIO_MEMCPY(h->prefix, args.prefix, prefix_len + 1);
+  return &h->manager;
+no_memory:
+  FIO_LOG_ERROR("(redis) failed to allocate history manager");
+  return NULL;
+}
+
 /* *****************************************************************************
 Redis Module Cleanup
 ***************************************************************************** */
@@ -73,6 +73,12 @@ HTTP Setting Defaults
 #define FIO_HTTP_WEBSOCKET_DEFLATE_MIN 1024
 #endif
 
+#ifndef FIO_HTTP_BROADCAST_CACHE
+/** Pre-encoded pub/sub frames kept for WebSocket / SSE subscribers (0 = off).
+ */
+#define FIO_HTTP_BROADCAST_CACHE 32
+#endif
+
 /* *****************************************************************************
 HTTP Handle Settings
 ***************************************************************************** */
@@ -142,6 +148,26 @@ HTTP Handle Settings
 #define FIO_HTTP_STATIC_FILE_COMPRESS_LIMIT (1UL << 21) /* 2 MiB */
 #endif
 
+#ifndef FIO_HTTP_STATIC_FILE_CACHE_FILE_LIMIT
+/** Maximum file size (in bytes) held by the static file cache. */
+#define FIO_HTTP_STATIC_FILE_CACHE_FILE_LIMIT (1UL << 20) /* 1 MiB */
+#endif
+
+#ifndef FIO_HTTP_STATIC_FILE_CACHE_REVALIDATE
+/** Milliseconds between `stat` revalidations of unwatched cache entries. */
+#define FIO_HTTP_STATIC_FILE_CACHE_REVALIDATE 1000
+#endif
+
+#ifndef FIO_HTTP2_MAX_CONCURRENT_STREAMS
+/** The number of concurrent HTTP/2 streams a client may open. */
+#define FIO_HTTP2_MAX_CONCURRENT_STREAMS 128
+#endif
+
+#ifndef FIO_HTTP2_WINDOW
+/** The HTTP/2 receive window (per stream and per connection). */
+#define FIO_HTTP2_WINDOW 1048576 /* (1UL << 20) */
+#endif
+
 #ifndef FIO_HTTP_LOG_X_REQUEST_START
 #define FIO_HTTP_LOG_X_REQUEST_START 1
 #endif
@@ -421,6 +447,11 @@ HTTP Routing – prefix matching
  *   `"/user/new"` and `"/user/new/..."` to `"/user/new"`. Otherwise, the
  *   `"/user"` route will continue to behave the same.
  *
+ * - Segments starting with `:` (i.e., `"/user/:id"`) match any single path
+ *   segment and a last segment starting with `*` (i.e., `*path`) matches the
+ *   rest of the path. Captured values are available using
+ *   `fio_http_route_param`. Static segments are preferred over parameters.
+ *
  * Note: the following properties are inherited (if missing) from the
  * default HTTP settings used to create the listener: `udata`, `on_finish`,
  * `on_stop`, `on_authenticate_sse`, `on_authenticate_websocket`,
@@ -456,6 +487,11 @@ SFUNC int fio_http_route(fio_http_listener_s *listener,
  *   `"/user/new"` and `"/user/new/..."` to `"/user/new"`. Otherwise, the
  *   `"/user"` route will continue to behave the same.
  *
+ * - Segments starting with `:` (i.e., `"/user/:id"`) match any single path
+ *   segment and a last segment starting with `*` (i.e., `*path`) matches the
+ *   rest of the path. Captured values are available using
+ *   `fio_http_route_param`. Static segments are preferred over parameters.
+ *
  * Note: the following properties are inherited (if missing) from the
  * default HTTP settings used to create the listener: `udata`, `on_finish`,
  * `on_stop`, `on_authenticate_sse`, `on_authenticate_websocket`,
@@ -637,6 +673,32 @@ SFUNC fio_str_info_s fio_http_version(fio_http_s *);
 /** Sets the version information associated with the HTTP handle. */
 SFUNC fio_str_info_s fio_http_version_set(fio_http_s *, fio_str_info_s);
 
+/**
+ * Returns the value of a route parameter captured by the router.
+ *
+ * Route parameters are declared using `:name` (a single path segment) or
+ * `*name` (the rest of the path) segments in `fio_http_route` URLs. Values
+ * are percent-decoded.
+ *
+ * Returns an empty string (`buf == NULL`) if `name` wasn't captured.
+ */
+SFUNC fio_str_info_s fio_http_route_param(fio_http_s *, fio_str_info_s name);
+
+/**
+ * Iterates through all route parameters captured by the router.
+ *
+ * A non-zero return will stop iteration.
+ *
+ * Returns the number of iterations performed. If `callback` is `NULL`, returns
+ * the number of route parameters available.
+ */
+SFUNC size_t fio_http_route_param_each(fio_http_s *,
+                                       int (*callback)(fio_http_s *,
+                                                       fio_str_info_s name,
+                                                       fio_str_info_s value,
+                                                       void *udata),
+                                       void *udata);
+
 /** Gets the received_at timestamp (ms) associated with the HTTP handle. */
 SFUNC int64_t fio_http_received_at(fio_http_s *);
 
@@ -1231,6 +1293,14 @@ SFUNC int fio_http_etag_is_match(fio_http_s *h);
  * detached handles), missing `.br` / `.gz` variants are also created on
  * demand.
  *
+ * When the static file cache is enabled (`fio_http_static_file_cache`),
+ * files up to `FIO_HTTP_STATIC_FILE_CACHE_FILE_LIMIT` bytes are kept in
+ * memory (together with their pre-compressed variants, `ETag` and
+ * `Last-Modified` values) and served without any filesystem calls. Entries
+ * are invalidated by `inotify` on Linux (while the IO reactor is running)
+ * and revalidated using `stat` every `FIO_HTTP_STATIC_FILE_CACHE_REVALIDATE`
+ * milliseconds otherwise. `Range` requests always bypass the cache.
+ *
  * On success the response is complete and 0 is returned. On failure -1 is
  * returned and the application should handle the request itself.
  */
@@ -1239,6 +1309,15 @@ SFUNC int fio_http_static_file_response(fio_http_s *h,
                                         fio_str_info_s file_name,
                                         size_t max_age);
 
+/**
+ * Sets the memory limit (in bytes) for the in-memory static file cache used
+ * by `fio_http_static_file_response`, returning the previous limit.
+ *
+ * The cache is disabled by default (limit 0). Setting the limit to 0 empties
+ * and disables the cache. See `fio_http_static_file_response` for details.
+ */
+SFUNC size_t fio_http_static_file_cache(size_t size_limit);
+
 /** Returns a human readable string related to the HTTP status number. */
 SFUNC fio_str_info_s fio_http_status2str(size_t status);
 
@@ -405,13 +405,29 @@ typedef enum fio___http_protocol_selector_e {
 HTTP Protocol Container (vtable + settings storage)
 ***************************************************************************** */
 
-typedef union fio___http_router_u {
-  fio_http_settings_s s;
-  void *ptr[256];
-  union fio___http_router_u *map[256];
-} fio___http_router_u;
+/* maximum number of `:param` / `*wildcard` segments in a route */
+#define FIO___HTTP_ROUTER_MAX_PARAMS 16
 
-FIO_SFUNC void fio___http_router_destroy(fio___http_router_u *router);
+/**
+ * Router node - a compressed radix tree.
+ *
+ * Static edges store byte runs (split on insertion when routes diverge) and
+ * the first byte of every static child is kept in `keys` for a single
+ * `memchr` lookup. Parameter and wildcard children store the parameter name
+ * in `edge`.
+ */
+typedef struct fio___http_router_s fio___http_router_s;
+struct fio___http_router_s {
+  fio___http_router_s **kids;    /* static children (`keys` follow them) */
+  uint8_t *keys;                 /* first byte of each static child's edge */
+  fio___http_router_s *param;    /* `:name` child - matches a segment */
+  fio___http_router_s *wildcard; /* `*name` child - matches the rest */
+  char *edge;                    /* fio_bstr: edge bytes or parameter name */
+  size_t kids_len;
+  fio_http_settings_s s; /* route settings (valid if `s.on_http`) */
+};
+
+FIO_SFUNC void fio___http_router_destroy(fio___http_router_s *router);
 
 typedef struct {
   fio_http_settings_s settings;
@@ -421,7 +437,7 @@ typedef struct {
     fio_io_protocol_s protocol;
     fio_http_controller_s controller;
   } state[FIO___HTTP_PROTOCOL_NONE + 1];
-  fio___http_router_u router;
+  fio___http_router_s router;
   char public_folder_buf[];
 } fio___http_protocol_s;
 #define FIO___RECURSIVE_INCLUDE 1
@@ -479,6 +495,14 @@ struct fio___http_connection_sse_s {
   fio_buf_info_s event;
   char *data;
 };
+/* shares its initial sequence (the callbacks) with the HTTP/1.1 state */
+struct fio___http_connection_http2_s {
+  void (*on_http_callback)(void *, void *);
+  void (*on_http)(fio_http_s *h);
+  void (*on_finish)(fio_http_s *h);
+  struct fio___http2_s *session;       /* connection: the HTTP/2 session */
+  struct fio___http2_stream_s *stream; /* per stream objects: the stream */
+};
 
 /** Connection objects for managing HTTP / WebSocket connection state. */
 typedef struct {
@@ -489,6 +513,7 @@ typedef struct {
   void *udata;
   union {
     struct fio___http_connection_http_s http;
+    struct fio___http_connection_http2_s http2;
     struct fio___http_connection_ws_s ws;
     struct fio___http_connection_sse_s sse;
   } state;
@@ -502,6 +527,7 @@ typedef struct {
   uint8_t is_client;
   uint8_t deflate_rd_reset; /* 1 = client_no_context_takeover */
   uint8_t deflate_wr_reset; /* 1 = server_no_context_takeover */
+  uint8_t deflate_wr_bits;  /* server_max_window_bits (8..15) */
   char buf[];
 } fio___http_connection_s;
 
@@ -525,12 +551,177 @@ typedef struct {
 HTTP Routing
 ***************************************************************************** */
 
-FIO_LEAK_COUNTER_DEF(fio___http_router_u)
+FIO_LEAK_COUNTER_DEF(fio___http_router_s)
+FIO_LEAK_COUNTER_DEF(fio___http_router_kids)
 FIO_LEAK_COUNTER_DEF(fio___http_router_public_folder)
 /* static-file on-demand compression scratch (src + dst share the counter;
  * both have multiple free paths). */
 FIO_LEAK_COUNTER_DEF(fio___http_static_compress_buf)
 FIO_SFUNC void fio___http_on_http_with_public_folder(void *h_, void *ignr);
+FIO_SFUNC void fio___http_route_params_clear(fio_http_s *h);
+FIO_SFUNC void fio___http_route_param_add(fio_http_s *h,
+                                          fio_str_info_s name,
+                                          fio_buf_info_s value);
+
+/* *****************************************************************************
+HTTP Router - Tree Management
+***************************************************************************** */
+
+FIO_SFUNC fio___http_router_s *fio___http_router_node_new(const char *edge,
+                                                          size_t len) {
+  fio___http_router_s *r =
+      (fio___http_router_s *)FIO_MEM_REALLOC_(NULL, 0, sizeof(*r), 0);
+  FIO_ASSERT_ALLOC(r);
+  FIO_LEAK_COUNTER_ON_ALLOC(fio___http_router_s);
+  *r = (fio___http_router_s){.edge = fio_bstr_write(NULL, edge, len)};
+  return r;
+}
+
+FIO_SFUNC void fio___http_router_node_free(fio___http_router_s *r) {
+  if (!r)
+    return;
+  fio___http_router_destroy(r);
+  FIO_MEM_FREE_(r, sizeof(*r));
+  FIO_LEAK_COUNTER_ON_FREE(fio___http_router_s);
+}
+
+/* the `kids` pointer array and the `keys` byte array share an allocation */
+FIO_SFUNC void fio___http_router_kid_add(fio___http_router_s *r,
+                                         fio___http_router_s *kid) {
+  const size_t len = r->kids_len;
+  const size_t unit = sizeof(*r->kids) + sizeof(*r->keys);
+  fio___http_router_s **kids =
+      (fio___http_router_s **)FIO_MEM_REALLOC_(NULL, 0, (len + 1) * unit, 0);
+  FIO_ASSERT_ALLOC(kids);
+  if (len) {
+    FIO_MEMCPY(kids, r->kids, len * sizeof(*kids));
+    FIO_MEMCPY(kids + len + 1, r->keys, len);
+    FIO_MEM_FREE_(r->kids, len * unit);
+    FIO_LEAK_COUNTER_ON_FREE(fio___http_router_kids);
+  }
+  FIO_LEAK_COUNTER_ON_ALLOC(fio___http_router_kids);
+  kids[len] = kid;
+  r->kids = kids;
+  r->keys = (uint8_t *)(kids + len + 1);
+  r->keys[len] = (uint8_t)kid->edge[0];
+  r->kids_len = len + 1;
+}
+
+/* returns the static child whose edge starts with `c`, if any */
+FIO_IFUNC fio___http_router_s **fio___http_router_kid(fio___http_router_s *r,
+                                                      uint8_t c) {
+  uint8_t *k;
+  if (!r->kids_len || !(k = (uint8_t *)FIO_MEMCHR(r->keys, c, r->kids_len)))
+    return NULL;
+  return r->kids + (k - r->keys);
+}
+
+/* adds a run of static bytes, splitting edges where routes diverge */
+FIO_SFUNC fio___http_router_s *fio___http_router_add_static(
+    fio___http_router_s *r,
+    const char *pos,
+    const char *end) {
+  while (pos < end) {
+    fio___http_router_s **kid = fio___http_router_kid(r, (uint8_t)*pos);
+    if (!kid) {
+      fio___http_router_s *tmp = fio___http_router_node_new(pos, end - pos);
+      fio___http_router_kid_add(r, tmp);
+      return tmp;
+    }
+    const size_t edge_len = fio_bstr_len(kid[0]->edge);
+    size_t i = 1;
+    while (i < edge_len && pos + i < end && kid[0]->edge[i] == pos[i])
+      ++i;
+    if (i < edge_len) { /* split the edge at the first difference */
+      fio___http_router_s *tmp = fio___http_router_node_new(kid[0]->edge, i);
+      char *tail = fio_bstr_write(NULL, kid[0]->edge + i, edge_len - i);
+      fio_bstr_free(kid[0]->edge);
+      kid[0]->edge = tail;
+      fio___http_router_kid_add(tmp, kid[0]);
+      kid[0] = tmp;
+    }
+    r = kid[0];
+    pos += i;
+  }
+  return r;
+}
+
+/* adds a `:param` / `*wildcard` child (names must be consistent) */
+FIO_SFUNC fio___http_router_s *fio___http_router_add_param(
+    fio___http_router_s **pr,
+    const char *name,
+    size_t len) {
+  if (!*pr) {
+    *pr = fio___http_router_node_new(name, len);
+    return *pr;
+  }
+  if (fio_bstr_len(pr[0]->edge) != len ||
+      (len && FIO_MEMCMP(pr[0]->edge, name, len)))
+    return NULL;
+  return *pr;
+}
+
+/* adds a route (without the leading and trailing `/`), returns the leaf */
+FIO_SFUNC fio___http_router_s *fio___http_router_add(fio___http_router_s *r,
+                                                     const char *start,
+                                                     const char *end) {
+  const char *pos = start;
+  size_t params = 0;
+  while (pos < end) {
+    const char *run = pos;
+    /* static bytes up to the next segment starting with `:` or `*` */
+    while (run < end && !((run[0] == ':' || run[0] == '*') &&
+                          (run == start || run[-1] == '/')))
+      ++run;
+    r = fio___http_router_add_static(r, pos, run);
+    if (run == end)
+      break;
+    const char *name = run + 1;
+    pos = name;
+    while (pos < end && *pos != '/')
+      ++pos;
+    if (++params > FIO___HTTP_ROUTER_MAX_PARAMS)
+      return NULL;
+    if (*run == '*') {
+      if (pos != end) /* a wildcard must be the last segment */
+        return NULL;
+      return fio___http_router_add_param(&r->wildcard, name, pos - name);
+    }
+    if (!(r = fio___http_router_add_param(&r->param, name, pos - name)))
+      return NULL;
+  }
+  return r;
+}
+
+FIO_SFUNC void fio___http_router_destroy(fio___http_router_s *r) {
+  if (!r)
+    return;
+  if (r->s.tls && (char *)r->s.tls == r->s.public_folder.buf) {
+    FIO_LEAK_COUNTER_ON_FREE(fio___http_router_public_folder);
+    FIO_MEM_FREE_(r->s.tls, r->s.public_folder.len + 1);
+  }
+  for (size_t i = 0; i < r->kids_len; ++i)
+    fio___http_router_node_free(r->kids[i]);
+  if (r->kids_len) {
+    FIO_MEM_FREE_(r->kids,
+                  r->kids_len * (sizeof(*r->kids) + sizeof(*r->keys)));
+    FIO_LEAK_COUNTER_ON_FREE(fio___http_router_kids);
+  }
+  fio___http_router_node_free(r->param);
+  fio___http_router_node_free(r->wildcard);
+  fio_bstr_free(r->edge);
+  r->kids = NULL;
+  r->keys = NULL;
+  r->param = r->wildcard = NULL;
+  r->edge = NULL;
+  r->kids_len = 0;
+  if (r->s.on_stop)
+    r->s.on_stop(&r->s);
+}
+
+/* *****************************************************************************
+HTTP Router - Adding Routes
+***************************************************************************** */
 
 void fio_http_route___(void);
 /** Adds a route prefix to the HTTP handler. */
@@ -539,41 +730,29 @@ SFUNC int fio_http_route FIO_NOOP(fio_http_listener_s *l,
                                   fio_http_settings_s s) {
   int err = 0;
   const uint8_t *u = (const uint8_t *)url;
+  const uint8_t *end;
   fio___http_protocol_s *p;
-  fio___http_router_u *r;
+  fio___http_router_s *r;
   if (!l)
     goto invalid_listener_error;
   p = FIO_PTR_FROM_FIELD(fio___http_protocol_s,
                          state[FIO___HTTP_PROTOCOL_ACCEPT].protocol,
                          fio_io_listener_protocol((fio_io_listener_s *)l));
-  r = &p->router;
   if (!u || !u[0]) {
     url = "/";
     u = (const uint8_t *)url;
   }
   /* skip first `/` character, they should always exist anyway */
   u += (*u == (uint8_t)'/');
-  /* skip last `/` character, to preserve memory and reduce seeking time */
-  for (; *u && (*u != (uint8_t)'/' || u[1]); ++u) {
-    if (*u < (sizeof(s) / sizeof(void *)))
+  for (end = u; *end; ++end) {
+    if (*end < 32)
       goto invalid_char_error;
-    if (!r->map[*u])
-      break;
-    r = r->map[*u];
   }
   /* skip last `/` character, to preserve memory and reduce seeking time */
-  for (; *u && (*u != (uint8_t)'/' || u[1]); ++u) {
-    if (*u < (sizeof(s) / sizeof(void *)))
-      goto invalid_char_error;
-    r->map[*u] =
-        (fio___http_router_u *)FIO_MEM_REALLOC_(NULL, 0, sizeof(*r), 0);
-    r = r->map[*u];
-    FIO_ASSERT_ALLOC(r);
-    FIO_LEAK_COUNTER_ON_ALLOC(fio___http_router_u);
-    if (!FIO_MEM_REALLOC_IS_SAFE_) {
-      FIO_MEMSET(r, 0, sizeof(*r));
-    }
-  }
+  end -= (end > u && end[-1] == (uint8_t)'/');
+  r = fio___http_router_add(&p->router, (const char *)u, (const char *)end);
+  if (!r)
+    goto invalid_route_error;
   /* we are at the leaf node of the path */
 
   /* inherit reasonable defaults */
@@ -637,12 +816,17 @@ SFUNC int fio_http_route FIO_NOOP(fio_http_listener_s *l,
   return err;
 
 invalid_char_error:
-  if (url)
-    FIO_LOG_ERROR("Invalid character found in path URL[%zu]: %s",
-                  (size_t)((const char *)u - url),
-                  url);
-  else
-    FIO_LOG_FATAL("HTTP Router requires a non-NULL URL!");
+  FIO_LOG_ERROR("Invalid character found in path URL[%zu]: %s",
+                (size_t)((const char *)end - url),
+                url);
+  err = -1;
+  return err;
+
+invalid_route_error:
+  FIO_LOG_ERROR("Invalid HTTP route (conflicting parameter names, a wildcard "
+                "that isn't the last segment or over %d parameters): %s",
+                FIO___HTTP_ROUTER_MAX_PARAMS,
+                url);
   err = -1;
   return err;
 
@@ -652,42 +836,131 @@ invalid_listener_error:
   return err;
 }
 
-void fio___http_route_settings___(void);
-FIO_SFUNC fio_http_settings_s *fio___http_route_settings(
-    fio___http_router_u *route,
-    fio_str_info_s *path) {
-  fio_http_settings_s *r = &route->s;
-  uint8_t *pos = (uint8_t *)path->buf;
-  const uint8_t *n = pos;
-  pos += (*pos == (uint8_t)'/');
-  if (!*pos)
-    return r;
-  for (uint8_t c, hi, lo;
-       route && ((c = *pos) >= (sizeof(*r) / sizeof(void *)));
-       ++pos) {
-    /* we have a possible match here - store before stepping into path */
-    if (c == (uint8_t)'/' && route->s.on_http) {
-      r = &route->s;
-      n = pos;
-    } else if (c == (uint8_t)'%' && (hi = fio_c2i(pos[1])) < 16) {
-      if ((lo = fio_c2i(pos[2])) < 16) { /* decrypt route */
-        c = (hi << 4) | lo;
-        pos += 2;
-        if (c < (sizeof(*r) / sizeof(void *)))
+/* *****************************************************************************
+HTTP Router - Routing
+***************************************************************************** */
+
+typedef struct {
+  fio___http_router_s *name;
+  fio_buf_info_s value;
+} fio___http_router_capture_s;
+
+typedef struct {
+  const uint8_t *end;
+  /* best match so far (matched prefix ends at `pos`) */
+  fio___http_router_s *node;
+  const uint8_t *pos;
+  size_t best_count;
+  /* current capture stack */
+  size_t count;
+  fio___http_router_capture_s best[FIO___HTTP_ROUTER_MAX_PARAMS];
+  fio___http_router_capture_s stack[FIO___HTTP_ROUTER_MAX_PARAMS];
+} fio___http_router_search_s;
+
+/* reads a (possibly percent encoded) path byte */
+FIO_IFUNC uint8_t fio___http_router_char(const uint8_t **pos,
+                                         const uint8_t *end) {
+  const uint8_t *p = *pos;
+  uint8_t c = *p++, hi, lo;
+  if (c == (uint8_t)'%' && p + 1 < end && (hi = fio_c2i(p[0])) < 16 &&
+      (lo = fio_c2i(p[1])) < 16) {
+    c = (hi << 4) | lo;
+    p += 2;
+  }
+  *pos = p;
+  return c;
+}
+
+/* Depth first search: static edges, then `:param`, then `*wildcard`.
+ * Returns non-zero once the whole path was matched (stops the search). */
+FIO_SFUNC int fio___http_router_search(fio___http_router_search_s *s,
+                                       fio___http_router_s *r,
+                                       const uint8_t *pos) {
+  const uint8_t *const end = s->end;
+  /* a route matches the path or any of its sub-paths (best-prefix match) */
+  if (r->s.on_http && (pos == end || *pos == (uint8_t)'/') &&
+      (!s->node || pos > s->pos)) {
+    s->node = r;
+    s->pos = pos;
+    s->best_count = s->count;
+    if (s->count)
+      FIO_MEMCPY(s->best, s->stack, s->count * sizeof(s->stack[0]));
+    if (pos == end)
+      return 1;
+  }
+  if (pos < end && r->kids_len) {
+    const uint8_t *p = pos;
+    fio___http_router_s **kid =
+        fio___http_router_kid(r, fio___http_router_char(&p, end));
+    if (kid) {
+      const uint8_t *edge = (const uint8_t *)kid[0]->edge;
+      const size_t edge_len = fio_bstr_len(kid[0]->edge);
+      size_t i = 1;
+      for (; i < edge_len && p < end; ++i) {
+        if (fio___http_router_char(&p, end) != edge[i])
           break;
       }
+      if (i == edge_len && fio___http_router_search(s, kid[0], p))
+        return 1;
     }
-    route = route->map[c];
   }
-  /* test if '/' may be inferred */
-  if (!*pos && route && route->map[0]) {
-    r = &route->s;
-    path->len = 1;
-    n = (uint8_t *)path->buf;
+  if (r->param && pos < end && *pos != (uint8_t)'/') {
+    const uint8_t *seg = (const uint8_t *)FIO_MEMCHR(pos, '/', end - pos);
+    if (!seg)
+      seg = end;
+    s->stack[s->count++] = (fio___http_router_capture_s){
+        .name = r->param,
+        .value = FIO_BUF_INFO2((char *)pos, (size_t)(seg - pos))};
+    if (fio___http_router_search(s, r->param, seg))
+      return 1;
+    --s->count;
   }
-  n -= (n == (uint8_t *)path->buf + 1);
-  *path = FIO_STR_INFO2((char *)n, path->len - ((char *)n - path->buf));
-  return r;
+  if (r->wildcard) {
+    s->stack[s->count++] = (fio___http_router_capture_s){
+        .name = r->wildcard,
+        .value = FIO_BUF_INFO2((char *)pos, (size_t)(end - pos))};
+    if (fio___http_router_search(s, r->wildcard, end))
+      return 1;
+    --s->count;
+  }
+  return 0;
+}
+
+void fio___http_route_settings___(void);
+/**
+ * Returns the settings of the route matching `path`.
+ *
+ * Updates `path` to the routed path (the part following the matched prefix)
+ * and, if `h` isn't NULL, stores any captured route parameters in `h`.
+ */
+FIO_SFUNC fio_http_settings_s *fio___http_route_settings(
+    fio___http_router_s *router,
+    fio_str_info_s *path,
+    fio_http_s *h) {
+  fio___http_router_search_s s;
+  const uint8_t *pos = (const uint8_t *)path->buf;
+  s.end = pos + path->len;
+  s.node = NULL;
+  s.pos = NULL;
+  s.count = s.best_count = 0;
+  if (!path->len)
+    return &router->s;
+  pos += (*pos == (uint8_t)'/');
+  fio___http_router_search(&s, router, pos);
+  if (h)
+    fio___http_route_params_clear(h);
+  if (!s.node) /* no matching route, use the default route */
+    return &router->s;
+  if (s.pos == s.end)
+    *path = FIO_STR_INFO2((char *)"/", 1);
+  else
+    *path = FIO_STR_INFO2((char *)s.pos, (size_t)(s.end - s.pos));
+  for (size_t i = 0; h && i < s.best_count; ++i)
+    fio___http_route_param_add(
+        h,
+        FIO_STR_INFO2(s.best[i].name->edge, fio_bstr_len(s.best[i].name->edge)),
+        s.best[i].value);
+  return &s.node->s;
 }
 
 /** Returns a link to the settings handled by the handle's route. */
@@ -700,7 +973,7 @@ FIO_SFUNC fio_http_settings_s *fio___http_handle_settings(fio_http_s *h) {
   fio___http_protocol_s *p =
       FIO_PTR_FROM_FIELD(fio___http_protocol_s, settings, connection->settings);
   fio_str_info_s path = fio_http_opath(h);
-  r = fio___http_route_settings(&p->router, &path);
+  r = fio___http_route_settings(&p->router, &path, h);
   fio_http_udata_set(h, r->udata);
   fio_http_path_set(h, path);
   connection->state.http.on_http = r->on_http;
@@ -708,35 +981,17 @@ FIO_SFUNC fio_http_settings_s *fio___http_handle_settings(fio_http_s *h) {
   return r;
 }
 
-FIO_SFUNC void fio___http_router_destroy(fio___http_router_u *r) {
-  if (!r)
-    return;
-  if (r->s.tls && (char *)r->s.tls == r->s.public_folder.buf) {
-    FIO_LEAK_COUNTER_ON_FREE(fio___http_router_public_folder);
-    FIO_MEM_FREE_(r->s.tls, r->s.public_folder.len + 1);
-  }
-  for (size_t i = (sizeof(r->s) / sizeof(void *)); i < 256; ++i) {
-    if (!r->map[i])
-      continue;
-    fio___http_router_destroy(r->map[i]);
-    FIO_MEM_FREE_(r->map[i], sizeof(*r));
-    FIO_LEAK_COUNTER_ON_FREE(fio___http_router_u);
-  }
-  if (r->s.on_stop)
-    r->s.on_stop(&r->s);
-}
-
 SFUNC fio_http_settings_s *fio_http_route_settings(fio_http_listener_s *l,
                                                    const char *url) {
   fio_http_settings_s *r = NULL;
   fio___http_protocol_s *p;
-  fio_str_info_s path = FIO_STR_INFO2((char *)url, 1);
+  fio_str_info_s path = FIO_STR_INFO1((char *)(url ? url : "/"));
   if (!l)
     return r;
   p = FIO_PTR_FROM_FIELD(fio___http_protocol_s,
                          state[FIO___HTTP_PROTOCOL_ACCEPT].protocol,
                          fio_io_listener_protocol((fio_io_listener_s *)l));
-  r = fio___http_route_settings(&p->router, &path);
+  r = fio___http_route_settings(&p->router, &path, NULL);
   return r;
 }
 
@@ -1362,6 +1617,7 @@ struct fio_http_s {
   fio_keystr_s path;
   fio_keystr_s query;
   fio_keystr_s version;
+  char *params; /* fio_bstr: route parameters (name / value pairs) */
   fio___http_hmap_s headers[2]; /* request, response */
   fio___http_cmap_s cookies[2]; /* read, write */
   struct {
@@ -1397,6 +1653,7 @@ SFUNC fio_http_s *fio_http_destroy(fio_http_s *h) {
   fio___http_hmap_destroy(h->headers + 1);
   fio___http_cmap_destroy(h->cookies);
   fio___http_cmap_destroy(h->cookies + 1);
+  fio_bstr_free(h->params);
   fio_bstr_free(h->body.buf);
   if (h->body.fd != -1)
     close(h->body.fd);
@@ -1451,6 +1708,7 @@ SFUNC fio_http_s *fio_http_new_copy_request(fio_http_s *o) {
   fio_http_method_set(h, fio_http_method(o));
   fio_http_query_set(h, fio_http_query(o));
   fio_http_version_set(h, fio_http_version(o));
+  h->params = fio_bstr_copy(o->params);
   /* copy headers */
   fio___http_hmap_reserve(h->headers, fio___http_hmap_count(o->headers));
   FIO_MAP_EACH(fio___http_hmap, o->headers, i) {
@@ -1498,6 +1756,75 @@ FIO___HTTP_MAKE_GET_SET(version)
 
 #undef FIO___HTTP_MAKE_GET_SET
 
+/* *****************************************************************************
+Route Parameters
+
+Stored in a single String as: [u32 name length][u32 value length][name][value]
+***************************************************************************** */
+
+FIO_SFUNC void fio___http_route_params_clear(fio_http_s *h) {
+  fio_bstr_free(h->params);
+  h->params = NULL;
+}
+
+FIO_SFUNC void fio___http_route_param_add(fio_http_s *h,
+                                          fio_str_info_s name,
+                                          fio_buf_info_s value) {
+  char header[8] = {0};
+  const size_t at = fio_bstr_len(h->params);
+  h->params = fio_bstr_write2(h->params,
+                              FIO_STRING_WRITE_STR2(header, 8),
+                              FIO_STRING_WRITE_STR2(name.buf, name.len));
+  fio_str_info_s i = fio_bstr_info(h->params);
+  fio_string_write_path_dec(&i, fio_bstr_reallocate, value.buf, value.len);
+  h->params = fio_bstr___len_set(i.buf, i.len);
+  fio_u2buf32u(h->params + at, (uint32_t)name.len);
+  fio_u2buf32u(h->params + at + 4, (uint32_t)(i.len - (at + 8 + name.len)));
+}
+
+/** Returns the value of a route parameter captured by the router. */
+SFUNC fio_str_info_s fio_http_route_param(fio_http_s *h, fio_str_info_s name) {
+  FIO_ASSERT_DEBUG(h, "NULL HTTP handler!");
+  char *pos = h->params;
+  char *end = pos + fio_bstr_len(pos);
+  while (pos + 8 <= end) {
+    const size_t name_len = fio_buf2u32u(pos);
+    const size_t value_len = fio_buf2u32u(pos + 4);
+    pos += 8;
+    if (name_len == name.len && !FIO_MEMCMP(pos, name.buf, name_len))
+      return FIO_STR_INFO2(pos + name_len, value_len);
+    pos += name_len + value_len;
+  }
+  return FIO_STR_INFO0;
+}
+
+/** Iterates through all route parameters captured by the router. */
+SFUNC size_t fio_http_route_param_each(fio_http_s *h,
+                                       int (*callback)(fio_http_s *,
+                                                       fio_str_info_s name,
+                                                       fio_str_info_s value,
+                                                       void *udata),
+                                       void *udata) {
+  FIO_ASSERT_DEBUG(h, "NULL HTTP handler!");
+  size_t count = 0;
+  char *pos = h->params;
+  char *end = pos + fio_bstr_len(pos);
+  while (pos + 8 <= end) {
+    const size_t name_len = fio_buf2u32u(pos);
+    const size_t value_len = fio_buf2u32u(pos + 4);
+    pos += 8;
+    ++count;
+    if (callback &&
+        callback(h,
+                 FIO_STR_INFO2(pos, name_len),
+                 FIO_STR_INFO2(pos + name_len, value_len),
+                 udata))
+      break;
+    pos += name_len + value_len;
+  }
+  return count;
+}
+
 FIO_DEF_GET_FUNC(SFUNC, fio_http, fio_http_s, size_t, status)
 /* clang-format off */
 FIO_DEF_GETSET_FUNC(SFUNC, fio_http, fio_http_s, int64_t, received_at, FIO_NOOP_FN)
@@ -2822,6 +3149,107 @@ SFUNC void fio_http_sse_set_request(fio_http_s *h) {
                               FIO_STR_INFO2((char *)"no-cache", 8));
 }
 
+/* *****************************************************************************
+Pub/Sub Broadcast Frame Cache
+
+A pub/sub message delivered to many WebSocket / SSE subscribers is encoded once
+per framing variant and the frame (a reference counted `fio_bstr`) is shared by
+all the subscribers' outgoing streams. Entries are keyed by the message's id,
+timestamp, length, channel, filter and payload (the subscribers of a message
+share its buffer) and are replaced by later messages.
+***************************************************************************** */
+
+/* framing variants: WebSocket (text / binary, deflated + window bits) or SSE */
+#define FIO___HTTP_BROADCAST_WS_TEXT    1U
+#define FIO___HTTP_BROADCAST_WS_DEFLATE 2U
+#define FIO___HTTP_BROADCAST_SSE        4U
+#define FIO___HTTP_BROADCAST_BITS(b)    ((uint32_t)(b) << 8)
+
+typedef struct {
+  uint64_t id;
+  uint64_t timestamp;
+  size_t len;
+  const char *payload; /* ids and timestamps may be chosen by the publisher */
+  char *channel;       /* a `fio_bstr` copy, compared in full */
+  uint32_t variant;
+  int16_t filter;
+  char *frame;
+} fio___http_broadcast_slot_s;
+
+#if FIO_HTTP_BROADCAST_CACHE
+static struct {
+  fio___http_broadcast_slot_s slot[FIO_HTTP_BROADCAST_CACHE];
+  FIO___LOCK_TYPE lock;
+} FIO___HTTP_BROADCAST = {.lock = FIO___LOCK_INIT};
+#endif
+
+/**
+ * Returns a new reference to the encoded frame for `msg` (a `fio_bstr`),
+ * calling `encode` only if the frame isn't cached. Returns NULL on error.
+ */
+FIO_SFUNC char *fio___http_broadcast_frame(fio_pubsub_msg_s *msg,
+                                           uint32_t variant,
+                                           char *(*encode)(fio_pubsub_msg_s *,
+                                                           uint32_t,
+                                                           void *),
+                                           void *udata) {
+#if FIO_HTTP_BROADCAST_CACHE
+  uint64_t ch_hash =
+      fio_risky_hash(msg->channel.buf, msg->channel.len, (uint64_t)msg->filter);
+  fio___http_broadcast_slot_s *s =
+      FIO___HTTP_BROADCAST.slot +
+      (fio_risky_num(msg->id ^ variant, msg->timestamp ^ ch_hash) %
+       FIO_HTTP_BROADCAST_CACHE);
+  char *frame = NULL;
+  FIO___LOCK_LOCK(FIO___HTTP_BROADCAST.lock);
+  if (s->frame && s->id == msg->id && s->timestamp == msg->timestamp &&
+      s->len == msg->message.len && s->variant == variant &&
+      s->payload == msg->message.buf && s->filter == msg->filter &&
+      fio_bstr_len(s->channel) == msg->channel.len &&
+      !FIO_MEMCMP(s->channel, msg->channel.buf, msg->channel.len))
+    frame = fio_bstr_copy(s->frame);
+  FIO___LOCK_UNLOCK(FIO___HTTP_BROADCAST.lock);
+  if (frame)
+    return frame;
+  frame = encode(msg, variant, udata);
+  if (!frame)
+    return frame;
+  fio___http_broadcast_slot_s old;
+  char *channel = fio_bstr_write(NULL, msg->channel.buf, msg->channel.len);
+  FIO___LOCK_LOCK(FIO___HTTP_BROADCAST.lock);
+  old = *s;
+  *s = (fio___http_broadcast_slot_s){
+      .id = msg->id,
+      .timestamp = msg->timestamp,
+      .len = msg->message.len,
+      .payload = msg->message.buf,
+      .channel = channel,
+      .variant = variant,
+      .filter = msg->filter,
+      .frame = fio_bstr_copy(frame),
+  };
+  FIO___LOCK_UNLOCK(FIO___HTTP_BROADCAST.lock);
+  fio_bstr_free(old.channel);
+  fio_bstr_free(old.frame);
+  return frame;
+#else
+  return encode(msg, variant, udata);
+#endif
+}
+
+/** Frees all cached broadcast frames. */
+FIO_SFUNC void fio___http_broadcast_destroy(void) {
+#if FIO_HTTP_BROADCAST_CACHE
+  FIO___LOCK_LOCK(FIO___HTTP_BROADCAST.lock);
+  for (size_t i = 0; i < FIO_HTTP_BROADCAST_CACHE; ++i) {
+    fio_bstr_free(FIO___HTTP_BROADCAST.slot[i].channel);
+    fio_bstr_free(FIO___HTTP_BROADCAST.slot[i].frame);
+    FIO___HTTP_BROADCAST.slot[i] = (fio___http_broadcast_slot_s){0};
+  }
+  FIO___LOCK_UNLOCK(FIO___HTTP_BROADCAST.lock);
+#endif
+}
+
 /* *****************************************************************************
 Header Parsing Helpers - Implementation
 ***************************************************************************** */
@@ -4286,6 +4714,577 @@ FIO_SFUNC void fio___http_static_compress_note_result(
   }
 }
 
+/** Returns non-zero if missing `.br` / `.gz` variants may be created. */
+FIO_SFUNC int fio___http_static_may_create(fio_http_s *h,
+                                           fio_http_settings_s *st,
+                                           fio_str_info_s mime_type,
+                                           size_t file_len) {
+  /* Attached handles gate on the route/listener settings (a failure-
+   * memoization shift register, read atomically); detached handles
+   * (no settings) gate on the handle cflag exactly as before. */
+  int may_compress;
+  if (st) {
+    uint8_t cv;
+    fio_atomic_load(cv, &st->compress_static);
+    may_compress = (cv != 0);
+  } else
+    may_compress = !!fio_http_cflags_is_set(h, FIO_HTTP_CFLAG_COMPRESS_STATIC);
+  return may_compress && fio___http_mime_is_compressible(mime_type) &&
+         file_len >= 1024 && file_len <= FIO_HTTP_STATIC_FILE_COMPRESS_LIMIT;
+}
+
+/* *****************************************************************************
+Static file cache
+
+Small files are held in memory (with their pre-compressed variants) as
+reference counted `fio_bstr` buffers, keyed by the `root` and `file_name`
+passed to `fio_http_static_file_response`. Entries are invalidated by inotify
+(Linux, while the IO reactor runs) or revalidated using `stat`.
+***************************************************************************** */
+#if defined(__linux__)
+#include <sys/inotify.h>
+#define FIO___HTTP_FILE_CACHE_INOTIFY 1
+#else
+#define FIO___HTTP_FILE_CACHE_INOTIFY 0
+#endif
+
+/* identity, br, zstd, gzip, deflate (in preference order) */
+#define FIO___HTTP_FILE_CACHE_VARIANTS 5
+
+typedef struct {
+  /** LRU list node (the list's tail is the most recently used entry). */
+  fio_list_node_s node;
+  /** File data (`fio_bstr`) per variant, NULL if the variant is missing. */
+  char *data[FIO___HTTP_FILE_CACHE_VARIANTS];
+  /** ETag hash per variant. */
+  uint64_t etag[FIO___HTTP_FILE_CACHE_VARIANTS];
+  /** The cache key (`fio_bstr`). */
+  char *key;
+  /** The resolved file name (`fio_bstr`), used for revalidation. */
+  char *filename;
+  /** The MIME type (`fio_bstr`), if known. */
+  char *mime;
+  /** Memory accounted for this entry. */
+  size_t size;
+  /** The original file's size, modification time (nanoseconds) and inode. */
+  size_t file_len;
+  int64_t mtime;
+  uint64_t ino;
+  /** Time (in milliseconds) of the last validation. */
+  int64_t validated;
+  /** inotify watch descriptor for the file's folder (-1 if unwatched). */
+  int wd;
+  /** Non-zero if compressed variants exist (responses should `Vary`). */
+  uint8_t vary;
+  /** Length of the `last_modified` string. */
+  uint8_t last_modified_len;
+  char last_modified[32];
+} fio___http_file_cache_entry_s;
+
+FIO_LEAK_COUNTER_DEF(fio___http_file_cache_entry)
+
+static const fio_buf_info_s
+    FIO___HTTP_FILE_CACHE_ENCODING[FIO___HTTP_FILE_CACHE_VARIANTS][2] = {
+        {{0}, {0}},
+        {{.buf = (char *)"br", .len = 2}, {.buf = (char *)".br", .len = 3}},
+        {{.buf = (char *)"zstd", .len = 4}, {.buf = (char *)".zstd", .len = 5}},
+        {{.buf = (char *)"gzip", .len = 4}, {.buf = (char *)".gz", .len = 3}},
+        {{.buf = (char *)"deflate", .len = 7},
+         {.buf = (char *)".zip", .len = 4}},
+};
+
+FIO_SFUNC void fio___http_file_cache_entry_free(
+    fio___http_file_cache_entry_s *e);
+
+#define FIO_MAP_NAME          fio___http_file_cache_map
+#define FIO_MAP_KEY_BSTR
+#define FIO_MAP_VALUE         fio___http_file_cache_entry_s *
+#define FIO_MAP_VALUE_DESTROY(e) fio___http_file_cache_entry_free((e))
+#define FIO_MAP_HASH_FN(k)                                                     \
+  fio_risky_hash((k).buf, (k).len, (uint64_t)(uintptr_t)fio_http_new)
+#define FIO___RECURSIVE_INCLUDE 1
+#include FIO_INCLUDE_FILE
+#undef FIO___RECURSIVE_INCLUDE
+
+#if FIO___HTTP_FILE_CACHE_INOTIFY
+/* inotify watch descriptor -> number of entries using it */
+#define FIO_MAP_NAME         fio___http_file_cache_wd_map
+#define FIO_MAP_KEY          int
+#define FIO_MAP_VALUE        size_t
+#define FIO_MAP_HASH_FN(k)   fio_risky_num((uint64_t)(k), 0)
+#define FIO___RECURSIVE_INCLUDE 1
+#include FIO_INCLUDE_FILE
+#undef FIO___RECURSIVE_INCLUDE
+#endif
+
+static struct {
+  fio___http_file_cache_map_s map;
+  fio_list_node_s lru;
+  size_t limit;
+  size_t size;
+#if FIO___HTTP_FILE_CACHE_INOTIFY
+  fio___http_file_cache_wd_map_s wds;
+  fio_io_s *io;
+  /* counts invalidations, so events racing an entry's insertion are seen */
+  size_t events;
+  int fd;
+#endif
+  FIO___LOCK_TYPE lock;
+} FIO___HTTP_FILE_CACHE = {
+    .lru = {.next = &FIO___HTTP_FILE_CACHE.lru,
+            .prev = &FIO___HTTP_FILE_CACHE.lru},
+#if FIO___HTTP_FILE_CACHE_INOTIFY
+    .fd = -1,
+#endif
+    .lock = FIO___LOCK_INIT,
+};
+
+/** The file's modification time in nanoseconds. */
+FIO_IFUNC int64_t fio___http_file_cache_mtime(struct stat *s) {
+#if defined(__APPLE__)
+  return ((int64_t)s->st_mtimespec.tv_sec * 1000000000) +
+         s->st_mtimespec.tv_nsec;
+#elif FIO_OS_POSIX
+  return ((int64_t)s->st_mtim.tv_sec * 1000000000) + s->st_mtim.tv_nsec;
+#else
+  return ((int64_t)s->st_mtime * 1000000000);
+#endif
+}
+
+#if FIO___HTTP_FILE_CACHE_INOTIFY
+/** Releases an entry's watch - call only while the lock is held. */
+FIO_SFUNC void fio___http_file_cache_unwatch(int wd) {
+  size_t *count;
+  if (wd == -1)
+    return;
+  count = fio___http_file_cache_wd_map_node2val_ptr(
+      fio___http_file_cache_wd_map_get_ptr(&FIO___HTTP_FILE_CACHE.wds, wd));
+  if (count && --count[0])
+    return;
+  fio___http_file_cache_wd_map_remove(&FIO___HTTP_FILE_CACHE.wds, wd, NULL);
+  if (FIO___HTTP_FILE_CACHE.fd != -1)
+    inotify_rm_watch(FIO___HTTP_FILE_CACHE.fd, wd);
+}
+#else
+#define fio___http_file_cache_unwatch(wd) ((void)(wd))
+#endif
+
+FIO_SFUNC void fio___http_file_cache_entry_free(
+    fio___http_file_cache_entry_s *e) {
+  if (!e)
+    return;
+  fio___http_file_cache_unwatch(e->wd);
+  FIO_LIST_REMOVE(&e->node);
+  FIO___HTTP_FILE_CACHE.size -= e->size;
+  for (size_t i = 0; i < FIO___HTTP_FILE_CACHE_VARIANTS; ++i)
+    fio_bstr_free(e->data[i]);
+  fio_bstr_free(e->key);
+  fio_bstr_free(e->filename);
+  fio_bstr_free(e->mime);
+  FIO_LEAK_COUNTER_ON_FREE(fio___http_file_cache_entry);
+  FIO_MEM_FREE_(e, sizeof(*e));
+}
+
+/** Removes an entry from the cache - call only while the lock is held. */
+FIO_IFUNC void fio___http_file_cache_remove(fio___http_file_cache_entry_s *e) {
+  fio___http_file_cache_map_remove(&FIO___HTTP_FILE_CACHE.map,
+                                   fio_bstr_info(e->key),
+                                   NULL);
+}
+
+/** Evicts LRU entries above the limit - call only while the lock is held. */
+FIO_SFUNC void fio___http_file_cache_evict(void) {
+  while (FIO___HTTP_FILE_CACHE.size > FIO___HTTP_FILE_CACHE.limit &&
+         !FIO_LIST_IS_EMPTY(&FIO___HTTP_FILE_CACHE.lru))
+    fio___http_file_cache_remove(
+        FIO_PTR_FROM_FIELD(fio___http_file_cache_entry_s,
+                           node,
+                           FIO___HTTP_FILE_CACHE.lru.next));
+}
+
+/** Frees all cache entries and the cache's resources. */
+FIO_SFUNC void fio___http_file_cache_destroy(void) {
+  FIO___LOCK_LOCK(FIO___HTTP_FILE_CACHE.lock);
+  fio___http_file_cache_map_destroy(&FIO___HTTP_FILE_CACHE.map);
+#if FIO___HTTP_FILE_CACHE_INOTIFY
+  fio___http_file_cache_wd_map_destroy(&FIO___HTTP_FILE_CACHE.wds);
+#endif
+  FIO___LOCK_UNLOCK(FIO___HTTP_FILE_CACHE.lock);
+}
+
+#if FIO___HTTP_FILE_CACHE_INOTIFY
+/** Drops entries watched by any of the `wd` descriptors (all if `!wds`). */
+FIO_SFUNC void fio___http_file_cache_invalidate(int *wds, size_t count) {
+  FIO___LOCK_LOCK(FIO___HTTP_FILE_CACHE.lock);
+  ++FIO___HTTP_FILE_CACHE.events;
+  FIO_LIST_EACH(fio___http_file_cache_entry_s,
+                node,
+                &FIO___HTTP_FILE_CACHE.lru,
+                e) {
+    if (e->wd == -1)
+      continue;
+    size_t i = 0;
+    if (wds)
+      while (i < count && wds[i] != e->wd)
+        ++i;
+    if (i < count || !wds)
+      fio___http_file_cache_remove(e);
+  }
+  FIO___LOCK_UNLOCK(FIO___HTTP_FILE_CACHE.lock);
+}
+
+/** Reads the pending inotify events from `fd`, invalidating entries. */
+FIO_SFUNC void fio___http_file_cache_read_events(int fd) {
+  uint64_t buf[512]; /* aligned for `struct inotify_event` */
+  ssize_t r;
+  while ((r = read(fd, buf, sizeof(buf))) > 0) {
+    int wds[64];
+    size_t count = 0;
+    int all = 0;
+    for (char *p = (char *)buf; p < (char *)buf + r;) {
+      struct inotify_event *ev = (struct inotify_event *)p;
+      if ((ev->mask & IN_Q_OVERFLOW) || count == 64)
+        all = 1;
+      else
+        wds[count++] = ev->wd;
+      p += sizeof(*ev) + ev->len;
+    }
+    fio___http_file_cache_invalidate((all ? NULL : wds), count);
+  }
+}
+
+FIO_SFUNC void fio___http_file_cache_on_events(fio_io_s *io) {
+  fio___http_file_cache_read_events(fio_io_fd(io));
+}
+
+FIO_SFUNC void fio___http_file_cache_on_close(void *ignr_, void *udata) {
+  int fd = (int)(uintptr_t)udata;
+  FIO___LOCK_LOCK(FIO___HTTP_FILE_CACHE.lock);
+  if (FIO___HTTP_FILE_CACHE.fd == fd) {
+    FIO___HTTP_FILE_CACHE.fd = -1;
+    FIO___HTTP_FILE_CACHE.io = NULL;
+  }
+  FIO___LOCK_UNLOCK(FIO___HTTP_FILE_CACHE.lock);
+  /* watched entries can't be invalidated anymore */
+  fio___http_file_cache_invalidate(NULL, 0);
+  (void)ignr_;
+}
+
+static fio_io_protocol_s FIO___HTTP_FILE_CACHE_PROTOCOL = {
+    .on_data = fio___http_file_cache_on_events,
+    .on_close = fio___http_file_cache_on_close,
+    .on_timeout = fio_io_touch,
+};
+
+/**
+ * Watches the file's folder - call only while the lock is held. A watch is
+ * released using `fio___http_file_cache_unwatch`.
+ */
+FIO_SFUNC int fio___http_file_cache_watch(char *filename, size_t len) {
+  if (FIO___HTTP_FILE_CACHE.fd == -1) {
+    if (!fio_io_is_running())
+      return -1;
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd == -1)
+      return -1;
+    FIO___HTTP_FILE_CACHE.fd = fd;
+    FIO___HTTP_FILE_CACHE.io =
+        fio_io_attach_fd(fd,
+                         &FIO___HTTP_FILE_CACHE_PROTOCOL,
+                         (void *)(uintptr_t)fd,
+                         NULL);
+  }
+  while (len && filename[len - 1] != '/')
+    --len;
+  if (!len)
+    return -1;
+  char c = filename[len - 1];
+  filename[len - 1] = 0;
+  int wd = inotify_add_watch(FIO___HTTP_FILE_CACHE.fd,
+                             (len > 1 ? filename : "/"),
+                             IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE |
+                                 IN_MOVED_FROM | IN_MOVED_TO | IN_CREATE |
+                                 IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF);
+  filename[len - 1] = c;
+  if (wd != -1) { /* a folder's watch is shared, count its entries */
+    size_t *count = fio___http_file_cache_wd_map_node2val_ptr(
+        fio___http_file_cache_wd_map_set_ptr(&FIO___HTTP_FILE_CACHE.wds,
+                                             wd,
+                                             0,
+                                             NULL,
+                                             0));
+    if (count)
+      ++count[0];
+  }
+  return wd;
+}
+#else
+#define fio___http_file_cache_watch(filename, len) (-1)
+#endif /* FIO___HTTP_FILE_CACHE_INOTIFY */
+
+SFUNC size_t fio_http_static_file_cache(size_t size_limit) {
+  FIO___LOCK_LOCK(FIO___HTTP_FILE_CACHE.lock);
+  size_t old = FIO___HTTP_FILE_CACHE.limit;
+  FIO___HTTP_FILE_CACHE.limit = size_limit;
+  if (size_limit)
+    fio___http_file_cache_evict();
+  else
+    fio___http_file_cache_map_destroy(&FIO___HTTP_FILE_CACHE.map);
+  FIO___LOCK_UNLOCK(FIO___HTTP_FILE_CACHE.lock);
+  return old;
+}
+
+/** Reads a whole file into a new `fio_bstr` (NULL on error). */
+FIO_SFUNC char *fio___http_file_cache_read(int fd, size_t len) {
+  char *data = fio_bstr_reserve(NULL, len);
+  if (!data)
+    return data;
+  if (fio_fd_read(fd, data, len, 0) != len) {
+    fio_bstr_free(data);
+    return NULL;
+  }
+  return fio_bstr_len_set(data, len);
+}
+
+/**
+ * Adds the (resolved) static file to the cache. Returns -1 if not cached.
+ *
+ * Files with variants that `fio_http_static_file_response` may create (or
+ * update) aren't cached until the variants exist on disk.
+ */
+FIO_SFUNC int fio___http_file_cache_add(fio_http_s *h,
+                                        fio_str_info_s key,
+                                        fio_str_info_s *filename,
+                                        fio_str_info_s mime_type) {
+  struct stat stt;
+  fio___http_file_cache_entry_s *e = NULL;
+  const size_t orig_len = filename->len;
+  size_t events = 0;
+  int fd = fio_filename_open(filename->buf, O_RDONLY);
+  if (fd == -1)
+    return -1;
+  if (fstat(fd, &stt) || (stt.st_mode & S_IFMT) != S_IFREG || !stt.st_size ||
+      (size_t)stt.st_size > FIO_HTTP_STATIC_FILE_CACHE_FILE_LIMIT)
+    goto no_cache;
+  const int may_create =
+      fio___http_static_may_create(h,
+                                   fio_http_settings(h),
+                                   mime_type,
+                                   (size_t)stt.st_size);
+  e = (fio___http_file_cache_entry_s *)FIO_MEM_REALLOC_(NULL, 0, sizeof(*e), 0);
+  if (!e)
+    goto no_cache;
+  FIO_LEAK_COUNTER_ON_ALLOC(fio___http_file_cache_entry);
+  *e = (fio___http_file_cache_entry_s){
+      .node = FIO_LIST_INIT(e->node),
+      .file_len = (size_t)stt.st_size,
+      .mtime = fio___http_file_cache_mtime(&stt),
+      .ino = (uint64_t)stt.st_ino,
+      .wd = -1,
+  };
+  /* watch before reading, so later changes invalidate the entry */
+  FIO___LOCK_LOCK(FIO___HTTP_FILE_CACHE.lock);
+  e->wd = fio___http_file_cache_watch(filename->buf, filename->len);
+#if FIO___HTTP_FILE_CACHE_INOTIFY
+  events = FIO___HTTP_FILE_CACHE.events;
+#endif
+  FIO___LOCK_UNLOCK(FIO___HTTP_FILE_CACHE.lock);
+  e->data[0] = fio___http_file_cache_read(fd, (size_t)stt.st_size);
+  e->etag[0] = fio_risky_hash(&stt, sizeof(stt), 0);
+  close(fd);
+  fd = -1;
+  if (!e->data[0])
+    goto no_cache;
+  e->size = sizeof(*e) + key.len + (filename->len << 1) + mime_type.len +
+            (size_t)stt.st_size;
+  for (size_t i = 1; i < FIO___HTTP_FILE_CACHE_VARIANTS; ++i) {
+    struct stat vst;
+    fio_string_write(filename,
+                     NULL,
+                     FIO___HTTP_FILE_CACHE_ENCODING[i][1].buf,
+                     FIO___HTTP_FILE_CACHE_ENCODING[i][1].len);
+    fd = fio_filename_open(filename->buf, O_RDONLY);
+    filename->len = orig_len;
+    filename->buf[orig_len] = 0;
+    if (fd != -1 && !fstat(fd, &vst) && (vst.st_mode & S_IFMT) == S_IFREG &&
+        fio___http_file_cache_mtime(&vst) >= e->mtime &&
+        (size_t)vst.st_size <= FIO_HTTP_STATIC_FILE_CACHE_FILE_LIMIT)
+      e->data[i] = fio___http_file_cache_read(fd, (size_t)vst.st_size);
+    if (fd != -1)
+      close(fd);
+    fd = -1;
+    if (!e->data[i]) {
+      /* `.br` and `.gz` variants could be created by the uncached path */
+      if (may_create && (i == 1 || i == 3))
+        goto no_cache;
+      continue;
+    }
+    e->etag[i] = fio_risky_hash(&vst, sizeof(vst), 0);
+    e->size += vst.st_size;
+    e->vary = 1;
+  }
+  e->key = fio_bstr_write(NULL, key.buf, key.len);
+  e->filename = fio_bstr_write(NULL, filename->buf, filename->len);
+  if (mime_type.len)
+    e->mime = fio_bstr_write(NULL, mime_type.buf, mime_type.len);
+  e->last_modified_len =
+      (uint8_t)fio_time2rfc7231(e->last_modified, (time_t)stt.st_mtime);
+
+  FIO___LOCK_LOCK(FIO___HTTP_FILE_CACHE.lock);
+  if (e->size > FIO___HTTP_FILE_CACHE.limit) {
+    FIO___LOCK_UNLOCK(FIO___HTTP_FILE_CACHE.lock);
+    goto no_cache;
+  }
+#if FIO___HTTP_FILE_CACHE_INOTIFY
+  /* an event may have been read before the entry could be found */
+  if (e->wd != -1 && events != FIO___HTTP_FILE_CACHE.events) {
+    FIO___LOCK_UNLOCK(FIO___HTTP_FILE_CACHE.lock);
+    goto no_cache;
+  }
+#endif
+  e->validated = fio_time_milli();
+  fio___http_file_cache_map_set(&FIO___HTTP_FILE_CACHE.map, key, e, NULL);
+  FIO_LIST_PUSH(&FIO___HTTP_FILE_CACHE.lru, &e->node);
+  FIO___HTTP_FILE_CACHE.size += e->size;
+  fio___http_file_cache_evict();
+  FIO___LOCK_UNLOCK(FIO___HTTP_FILE_CACHE.lock);
+  return 0;
+
+no_cache:
+  if (fd != -1)
+    close(fd);
+  if (e) {
+    e->size = 0;
+    FIO___LOCK_LOCK(FIO___HTTP_FILE_CACHE.lock);
+    fio___http_file_cache_entry_free(e);
+    FIO___LOCK_UNLOCK(FIO___HTTP_FILE_CACHE.lock);
+  }
+  return -1;
+  (void)events;
+}
+
+FIO_SFUNC void fio___http_file_cache_dealloc(void *data) {
+  fio_bstr_free((char *)data);
+}
+
+/** Serves a cached static file. Returns -1 if the file isn't cached. */
+FIO_SFUNC int fio___http_file_cache_serve(fio_http_s *h,
+                                          fio_str_info_s key,
+                                          size_t max_age) {
+  char *data = NULL;
+  char *mime = NULL;
+  uint64_t etag_hash;
+  size_t enc = 0;
+  uint8_t vary;
+  FIO_STR_INFO_TMP_VAR(tmp, 63);
+  fio_str_info_s ac =
+      fio_http_request_header(h,
+                              FIO_STR_INFO2((char *)"accept-encoding", 15),
+                              0);
+  FIO___LOCK_LOCK(FIO___HTTP_FILE_CACHE.lock);
+  fio___http_file_cache_entry_s *e =
+      fio___http_file_cache_map_get(&FIO___HTTP_FILE_CACHE.map, key);
+  if (!e)
+    goto not_cached;
+  if (e->wd == -1) { /* unwatched - revalidate using `stat` */
+    int64_t now = fio_time_milli();
+    if (now - e->validated >= FIO_HTTP_STATIC_FILE_CACHE_REVALIDATE) {
+      struct stat stt;
+      if (fio_filename_stat(e->filename, &stt) ||
+          (size_t)stt.st_size != e->file_len ||
+          fio___http_file_cache_mtime(&stt) != e->mtime ||
+          (uint64_t)stt.st_ino != e->ino) {
+        fio___http_file_cache_remove(e);
+        goto not_cached;
+      }
+      e->validated = now;
+    }
+  }
+  /* move to the tail of the LRU list */
+  FIO_LIST_REMOVE(&e->node);
+  FIO_LIST_PUSH(&FIO___HTTP_FILE_CACHE.lru, &e->node);
+  if (ac.len)
+    for (size_t i = 1; i < FIO___HTTP_FILE_CACHE_VARIANTS; ++i) {
+      const fio_buf_info_s name = FIO___HTTP_FILE_CACHE_ENCODING[i][0];
+      if (!e->data[i] || !fio___http_header_has_token(ac, name.buf, name.len))
+        continue;
+      enc = i;
+      break;
+    }
+  data = fio_bstr_copy(e->data[enc]);
+  mime = fio_bstr_copy(e->mime);
+  etag_hash = e->etag[enc];
+  vary = e->vary;
+  fio_string_write(&tmp, NULL, e->last_modified, e->last_modified_len);
+  FIO___LOCK_UNLOCK(FIO___HTTP_FILE_CACHE.lock);
+
+  if (vary &&
+      !fio_http_response_header(h, FIO_STR_INFO2((char *)"vary", 4), 0).buf)
+    fio_http_response_header_set(h,
+                                 FIO_STR_INFO2((char *)"vary", 4),
+                                 FIO_STR_INFO2((char *)"accept-encoding", 15));
+  if (enc)
+    fio_http_response_header_set(
+        h,
+        FIO_STR_INFO2((char *)"content-encoding", 16),
+        FIO_BUF2STR_INFO(FIO___HTTP_FILE_CACHE_ENCODING[enc][0]));
+  fio_http_response_header_set(h, FIO_STR_INFO1((char *)"last-modified"), tmp);
+  tmp.len = 0;
+  fio_string_write_hex(&tmp, NULL, etag_hash);
+  fio_http_response_header_set(h, FIO_STR_INFO2((char *)"etag", 4), tmp);
+  if (max_age) {
+    tmp.len = 0;
+    fio_string_write2(&tmp,
+                      NULL,
+                      FIO_STRING_WRITE_STR2("max-age=", 8),
+                      FIO_STRING_WRITE_UNUM(max_age));
+    fio_http_response_header_set(h,
+                                 FIO_STR_INFO1((char *)"cache-control"),
+                                 tmp);
+  }
+  if (fio___http_response_etag_if_none_match(h))
+    goto done;
+  fio_http_response_header_set(h,
+                               FIO_STR_INFO2((char *)"accept-ranges", 13),
+                               FIO_STR_INFO2((char *)"bytes", 5));
+  if (mime)
+    fio_http_response_header_set(h,
+                                 FIO_STR_INFO2((char *)"content-type", 12),
+                                 fio_bstr_info(mime));
+  { /* test for HEAD requests */
+    fio_str_info_s m = fio_keystr_info(&h->method);
+    if ((m.len == 4 && (fio_buf2u32u(m.buf) | 0x20202020UL) ==
+                           (fio_buf2u32u("head") | 0x20202020UL))) {
+      tmp.len = fio_digits10u(fio_bstr_len(data));
+      fio_ltoa10u(tmp.buf, fio_bstr_len(data), tmp.len);
+      fio_http_response_header_set(h,
+                                   FIO_STR_INFO2((char *)"content-length", 14),
+                                   tmp);
+      fio_http_write_args_s args = {.finish = 1};
+      fio_http_write FIO_NOOP(h, args);
+      goto done;
+    }
+  }
+  { /* never compress a cached response on the fly (variants are cached) */
+    fio_http_cflags_unset(h, FIO_HTTP_CFLAG_COMPRESS_DYNAMIC);
+    fio_http_write_args_s args = {
+        .buf = data,
+        .len = fio_bstr_len(data),
+        .dealloc = fio___http_file_cache_dealloc,
+        .finish = 1};
+    fio_http_write FIO_NOOP(h, args);
+    data = NULL;
+  }
+done:
+  fio_bstr_free(data);
+  fio_bstr_free(mime);
+  return 0;
+
+not_cached:
+  FIO___LOCK_UNLOCK(FIO___HTTP_FILE_CACHE.lock);
+  return -1;
+}
+
 /**
  * Attempts to send a static file from the `root` folder. On success the
  * response is complete and 0 is returned. Otherwise returns -1.
@@ -4331,12 +5330,25 @@ SFUNC int fio_http_static_file_response(fio_http_s *h,
   fio_str_info_s mime_type = {0};
   FIO_STR_INFO_TMP_VAR(etag, 31);
   FIO_STR_INFO_TMP_VAR(filename, (FIO_FILENAME_PATH_CAPA - 1));
+  FIO_STR_INFO_TMP_VAR(cache_key, (FIO_FILENAME_PATH_CAPA - 1));
   { /* test for HEAD and OPTIONS requests */
     fio_str_info_s m = fio_keystr_info(&h->method);
     if ((m.len == 7 && (fio_buf2u64u(m.buf) | 0x2020202020202020ULL) ==
                            (fio_buf2u64u("options") | 0x2020202020202020ULL)))
       goto file_not_found;
   }
+  /* serve from the static file cache (ranged requests bypass the cache) */
+  if (FIO___HTTP_FILE_CACHE.limit &&
+      rt.len + fnm.len < (FIO_FILENAME_PATH_CAPA - 16) &&
+      !fio_http_request_header(h, FIO_STR_INFO2((char *)"range", 5), 0).len) {
+    fio_string_write2(&cache_key,
+                      NULL,
+                      FIO_STRING_WRITE_STR2(rt.buf, rt.len),
+                      FIO_STRING_WRITE_STR2("\0", 1),
+                      FIO_STRING_WRITE_STR2(fnm.buf, fnm.len));
+    if (!fio___http_file_cache_serve(h, cache_key, max_age))
+      return 0;
+  }
   rt.len -= ((rt.len > 0) && (fnm.len > 0 && fnm.buf[0] == '/') &&
              (rt.buf[rt.len - 1] == '/' ||
               rt.buf[rt.len - 1] == FIO_FOLDER_SEPARATOR));
@@ -4412,6 +5424,10 @@ SFUNC int fio_http_static_file_response(fio_http_s *h,
                         ext);
     }
   }
+  if (cache_key.len &&
+      !fio___http_file_cache_add(h, cache_key, &filename, mime_type) &&
+      !fio___http_file_cache_serve(h, cache_key, max_age))
+    return 0;
   {
     fio_str_info_s ac =
         fio_http_request_header(h,
@@ -4425,23 +5441,10 @@ SFUNC int fio_http_static_file_response(fio_http_s *h,
     struct stat orig_st;
     int have_orig_st = !fio_filename_stat(filename.buf, &orig_st);
     size_t orig_len = filename.len; /* remember unextended length */
-    /* Attached handles gate on the route/listener settings (a failure-
-     * memoization shift register, read atomically); detached handles
-     * (no settings) gate on the handle cflag exactly as before. */
     fio_http_settings_s *st = fio_http_settings(h);
-    int settings_may_compress = 0;
-    if (st) {
-      uint8_t cv;
-      fio_atomic_load(cv, &st->compress_static);
-      settings_may_compress = (cv != 0);
-    }
     int can_create =
         have_orig_st &&
-        (st ? settings_may_compress
-            : fio_http_cflags_is_set(h, FIO_HTTP_CFLAG_COMPRESS_STATIC)) &&
-        fio___http_mime_is_compressible(mime_type) &&
-        (size_t)orig_st.st_size >= 1024 &&
-        (size_t)orig_st.st_size <= FIO_HTTP_STATIC_FILE_COMPRESS_LIMIT;
+        fio___http_static_may_create(h, st, mime_type, orig_st.st_size);
     if (can_create &&
         !fio_http_response_header(h, FIO_STR_INFO2((char *)"vary", 4), 0).buf)
       /* Compressed variants exist (or may be created) for this resource:
@@ -5062,6 +6065,8 @@ FIO_SFUNC void fio___http_cleanup(void *ignr_) {
     (void)names; /* if unused */
   }
 #endif /* FIO_HTTP_CACHE_LIMIT */
+  fio___http_file_cache_destroy();
+  fio___http_broadcast_destroy();
   FIO_LOG_DEBUG2("(%d) HTTP MIME hash storage count/capa: %zu / %zu",
                  fio_getpid(),
                  FIO___HTTP_MIMETYPES.count,
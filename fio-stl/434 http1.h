@@ -675,13 +675,17 @@ FIO_SFUNC void fio___http_controller_http1_on_finish(fio_http_s *h) {
   /* once the function returns, `h` may be freed (auto-finish on free).
    * so we must call this callback here (sync), no matter the thread */
   c->state.http.on_finish(h);
-  fio_io_defer(fio___http_controller_http1_on_finish_task, (void *)(c), NULL);
+  fio_io_defer_to(c->io,
+                  fio___http_controller_http1_on_finish_task,
+                  (void *)(c),
+                  NULL);
   return;
 
 upgraded:
-  fio_io_defer(fio___http_controller_http1_on_finish_task,
-               (void *)(c),
-               (void *)h);
+  fio_io_defer_to(c->io,
+                  fio___http_controller_http1_on_finish_task,
+                  (void *)(c),
+                  (void *)h);
 }
 
 /* *****************************************************************************
@@ -0,0 +1,1322 @@
+/* ************************************************************************* */
+#if !defined(FIO_INCLUDE_FILE) /* Dev test - ignore line */
+#define FIO___DEV___           /* Development inclusion - ignore line */
+#define FIO_HTTP               /* Development inclusion - ignore line */
+#include "./include.h"         /* Development inclusion - ignore line */
+#endif                         /* Development inclusion - ignore line */
+/* *****************************************************************************
+
+                  HTTP/2 - Session, Streams, Protocol and Controller
+
+Copyright and License: see header file (000 copyright.h) or top of file
+***************************************************************************** */
+#if defined(FIO_HTTP) && !defined(FIO___RECURSIVE_INCLUDE) &&                  \
+    !defined(H___FIO_HTTP2___H) &&                                             \
+    (defined(FIO_EXTERN_COMPLETE) || !defined(FIO_EXTERN))
+#define H___FIO_HTTP2___H
+
+/* *****************************************************************************
+HTTP/2 Design
+
+Each HTTP/2 connection owns a session (`fio___http2_s`) that is only ever
+touched by the IO thread. Each request stream gets its own connection object
+(`fio___http_connection_s`), so HTTP handles behave exactly as they do for
+HTTP/1.1 (`fio_http_io`, `fio_http_settings`, user queues, etc').
+
+The controller (called from any thread) never touches the session. Instead, it
+packs the response (headers, body chunks and the end of the stream) into
+output chunks that are passed to the IO thread using `fio_io_defer_to`, where
+they are framed, HPACK encoded and sent as flow control allows. A dispatched
+stream holds an IO reference until its handle is released, so the controller
+can always route these tasks to the connection's reactor.
+***************************************************************************** */
+
+/** Output beyond this backlog waits for the `on_ready` event. */
+#define FIO___HTTP2_BACKLOG_LIMIT (1UL << 18)
+
+FIO_LEAK_COUNTER_DEF(fio___http2_s)
+FIO_LEAK_COUNTER_DEF(fio___http2_stream_s)
+FIO_LEAK_COUNTER_DEF(fio___http2_out_s)
+
+typedef struct fio___http2_s fio___http2_s;
+typedef struct fio___http2_stream_s fio___http2_stream_s;
+
+#define FIO_MAP_NAME         fio___http2_map
+#define FIO_MAP_KEY          uint32_t
+#define FIO_MAP_VALUE        fio___http2_stream_s *
+#define FIO_MAP_HASH_FN(k)   fio_risky_num((uint64_t)(k), 0)
+#define FIO___RECURSIVE_INCLUDE 1
+#include FIO_INCLUDE_FILE
+#undef FIO___RECURSIVE_INCLUDE
+
+/** Output chunk kinds. */
+typedef enum {
+  FIO___HTTP2_OUT_HEADERS, /* a packed header list (see send_headers) */
+  FIO___HTTP2_OUT_DATA,    /* a body chunk (buffer or file) */
+  FIO___HTTP2_OUT_FIN,     /* the response was finished */
+} fio___http2_out_e;
+
+/** Output chunk, passed from the controller to the IO thread. */
+typedef struct {
+  FIO_LIST_NODE node;
+  const char *buf;
+  void (*dealloc)(void *);
+  size_t len;
+  size_t offset;
+  size_t mem_len;
+  int fd;
+  uint8_t kind;
+  uint8_t keep_fd;
+  char mem[];
+} fio___http2_out_s;
+
+/** Stream state flags. */
+typedef enum {
+  FIO___HTTP2_STREAM_REMOTE_CLOSED = 1,  /* END_STREAM received */
+  FIO___HTTP2_STREAM_LOCAL_CLOSED = 2,   /* END_STREAM sent (or reset) */
+  FIO___HTTP2_STREAM_ACTIVE = 4,         /* in the map, counted as active */
+  FIO___HTTP2_STREAM_RELEASED = 8,       /* the HTTP handle was destroyed */
+  FIO___HTTP2_STREAM_HEAD = 16,          /* a HEAD request, skip the body */
+  FIO___HTTP2_STREAM_MALFORMED = 32,     /* a malformed request */
+  FIO___HTTP2_STREAM_REGULAR = 64,       /* a regular header was received */
+  FIO___HTTP2_STREAM_DISPATCHED = 128,   /* the IO is held until finished */
+  FIO___HTTP2_STREAM_COUNTED = 256,      /* counted against the stream limit */
+} fio___http2_stream_flags_e;
+
+struct fio___http2_stream_s {
+  FIO_LIST_NODE node;          /* all of the session's streams */
+  FIO_LIST_NODE pending;       /* streams with output waiting to be sent */
+  FIO_LIST_HEAD out;           /* queued output chunks */
+  fio___http2_s *session;      /* NULL once the connection was closed */
+  fio___http_connection_s *sc; /* the HTTP handle's connection object */
+  fio_http_s *h;               /* the request (until dispatched) */
+  fio_io_s *io;                /* the IO held by a dispatched request */
+  int64_t window;              /* send window */
+  uint32_t recv;               /* received bytes not yet acknowledged */
+  uint32_t id;
+  uint32_t header_bytes;
+  uint16_t error; /* HTTP status for a rejected request (i.e., 413, 431) */
+  uint16_t flags;
+};
+
+struct fio___http2_s {
+  fio___http_connection_s *c;
+  fio___http2_map_s map;  /* active streams by id */
+  FIO_LIST_HEAD streams;  /* all streams */
+  FIO_LIST_HEAD pending;  /* streams with queued output */
+  char *block;            /* HEADERS + CONTINUATION payload (fio_bstr) */
+  char *scratch;          /* HPACK decoding scratch space (fio_bstr) */
+  int64_t window;         /* connection send window */
+  uint32_t recv;          /* received bytes not yet acknowledged */
+  uint32_t peer_window;   /* peer's SETTINGS_INITIAL_WINDOW_SIZE */
+  uint32_t peer_frame;    /* peer's SETTINGS_MAX_FRAME_SIZE */
+  uint32_t last_id;       /* highest stream id received */
+  uint32_t block_id;      /* stream id of an incomplete header block */
+  uint32_t active;        /* number of active streams */
+  uint32_t len;           /* bytes in `buf` */
+  uint8_t block_flags;    /* flags of the HEADERS frame for the block */
+  uint8_t goaway;         /* a GOAWAY was sent */
+  uint8_t flush;          /* a flush task was scheduled */
+  uint8_t acked;          /* the peer acknowledged our SETTINGS */
+  fio_hpack_s decoder;
+  fio_hpack_s encoder;
+  char buf[FIO_HTTP2_FRAME_HEADER_LEN + FIO_HTTP2_DEFAULT_FRAME_SIZE];
+};
+
+FIO_SFUNC void fio___http2_flush(fio___http2_s *s);
+
+/* *****************************************************************************
+HTTP/2 Frame Output (IO thread)
+***************************************************************************** */
+
+/** Sends a small frame (control frames, payload up to 64 bytes). */
+FIO_SFUNC void fio___http2_send(fio___http2_s *s,
+                                fio_http2_frame_s f,
+                                const void *payload) {
+  char buf[FIO_HTTP2_FRAME_HEADER_LEN + 64];
+  FIO_ASSERT_DEBUG(f.len <= 64, "HTTP/2 control frame too long");
+  fio_http2_frame_write(buf, f);
+  if (f.len)
+    FIO_MEMCPY(buf + FIO_HTTP2_FRAME_HEADER_LEN, payload, f.len);
+  fio_io_write2(s->c->io,
+                .buf = buf,
+                .len = FIO_HTTP2_FRAME_HEADER_LEN + f.len,
+                .copy = 1);
+}
+
+FIO_SFUNC void fio___http2_send_rst(fio___http2_s *s,
+                                    uint32_t id,
+                                    uint32_t error) {
+  char p[4];
+  fio_u2buf32_be(p, error);
+  fio___http2_send(s,
+                   (fio_http2_frame_s){.len = 4,
+                                       .stream_id = id,
+                                       .type = FIO_HTTP2_FRAME_RST_STREAM},
+                   p);
+}
+
+FIO_SFUNC void fio___http2_send_window(fio___http2_s *s,
+                                       uint32_t id,
+                                       uint32_t increment) {
+  char p[4];
+  fio_u2buf32_be(p, increment);
+  fio___http2_send(s,
+                   (fio_http2_frame_s){.len = 4,
+                                       .stream_id = id,
+                                       .type = FIO_HTTP2_FRAME_WINDOW_UPDATE},
+                   p);
+}
+
+FIO_SFUNC void fio___http2_send_goaway(fio___http2_s *s, uint32_t error) {
+  char p[8];
+  if (s->goaway)
+    return;
+  s->goaway = 1;
+  fio_u2buf32_be(p, s->last_id);
+  fio_u2buf32_be(p + 4, error);
+  fio___http2_send(s,
+                   (fio_http2_frame_s){.len = 8,
+                                       .type = FIO_HTTP2_FRAME_GOAWAY},
+                   p);
+}
+
+/* *****************************************************************************
+HTTP/2 Output Chunks
+***************************************************************************** */
+
+FIO_SFUNC fio___http2_out_s *fio___http2_out_new(uint8_t kind, size_t mem) {
+  fio___http2_out_s *o = (fio___http2_out_s *)
+      FIO_MEM_REALLOC_(NULL, 0, sizeof(*o) + mem, 0);
+  FIO_ASSERT_ALLOC(o);
+  FIO_LEAK_COUNTER_ON_ALLOC(fio___http2_out_s);
+  *o = (fio___http2_out_s){.mem_len = mem, .fd = -1, .kind = kind};
+  return o;
+}
+
+FIO_SFUNC void fio___http2_out_free(fio___http2_out_s *o) {
+  if (o->dealloc && o->buf)
+    o->dealloc((void *)o->buf);
+  if (o->fd != -1 && !o->keep_fd)
+    close(o->fd);
+  FIO_MEM_FREE_(o, sizeof(*o) + o->mem_len);
+  FIO_LEAK_COUNTER_ON_FREE(fio___http2_out_s);
+}
+
+/* *****************************************************************************
+HTTP/2 Stream Life Cycle (IO thread)
+***************************************************************************** */
+
+FIO_SFUNC void fio___http2_stream_drop_output(fio___http2_stream_s *st) {
+  FIO_LIST_REMOVE_RESET(&st->pending);
+  while (!FIO_LIST_IS_EMPTY(&st->out)) {
+    fio___http2_out_s *o;
+    FIO_LIST_POP(fio___http2_out_s, node, o, &st->out);
+    fio___http2_out_free(o);
+  }
+}
+
+/* releases a stream's slot in the concurrency limit. */
+FIO_SFUNC void fio___http2_stream_uncount(fio___http2_stream_s *st) {
+  if (!(st->flags & FIO___HTTP2_STREAM_COUNTED))
+    return;
+  st->flags ^= FIO___HTTP2_STREAM_COUNTED;
+  --st->session->active;
+}
+
+/* removes a stream from the active set (map and concurrency count). */
+FIO_SFUNC void fio___http2_stream_deactivate(fio___http2_stream_s *st) {
+  st->flags |= FIO___HTTP2_STREAM_REMOTE_CLOSED | FIO___HTTP2_STREAM_LOCAL_CLOSED;
+  if (!(st->flags & FIO___HTTP2_STREAM_ACTIVE))
+    return;
+  st->flags ^= FIO___HTTP2_STREAM_ACTIVE;
+  fio___http2_map_remove(&st->session->map, st->id, NULL);
+  /* a reset stream keeps its slot until its handler finished (rapid reset) */
+  if (!(st->flags & FIO___HTTP2_STREAM_DISPATCHED))
+    fio___http2_stream_uncount(st);
+}
+
+FIO_SFUNC void fio___http2_stream_free(fio___http2_stream_s *st) {
+  if (st->session) {
+    fio___http2_stream_deactivate(st);
+    fio___http2_stream_uncount(st);
+  }
+  fio___http2_stream_drop_output(st);
+  FIO_LIST_REMOVE_RESET(&st->node);
+  st->sc->io = NULL;
+  st->sc->state.http2.stream = NULL;
+  fio___http_connection_free(st->sc);
+  FIO_MEM_FREE_(st, sizeof(*st));
+  FIO_LEAK_COUNTER_ON_FREE(fio___http2_stream_s);
+}
+
+/* streams are freed once the handle was released and the stream is done. */
+FIO_SFUNC void fio___http2_stream_maybe_free(fio___http2_stream_s *st) {
+  if (!(st->flags & FIO___HTTP2_STREAM_RELEASED) ||
+      (st->session && !(st->flags & FIO___HTTP2_STREAM_LOCAL_CLOSED)))
+    return;
+  fio___http2_stream_free(st);
+}
+
+FIO_SFUNC fio___http2_stream_s *fio___http2_stream_new(fio___http2_s *s,
+                                                       uint32_t id) {
+  fio___http_connection_s *c = s->c;
+  fio___http_protocol_s *p =
+      FIO_PTR_FROM_FIELD(fio___http_protocol_s, settings, c->settings);
+  fio___http2_stream_s *st =
+      (fio___http2_stream_s *)FIO_MEM_REALLOC_(NULL, 0, sizeof(*st), 0);
+  FIO_ASSERT_ALLOC(st);
+  FIO_LEAK_COUNTER_ON_ALLOC(fio___http2_stream_s);
+  fio___http_connection_s *sc = fio___http_connection_new(0);
+  FIO_ASSERT_ALLOC(sc);
+  fio___http_protocol_dup(p); /* freed with the connection object */
+  *sc = (fio___http_connection_s){
+      .io = c->io,
+      .settings = c->settings,
+      .queue = c->queue,
+      .udata = c->udata,
+      .state.http2 =
+          {
+              .on_http_callback = c->state.http2.on_http_callback,
+              .on_http = c->state.http2.on_http,
+              .on_finish = c->state.http2.on_finish,
+              .stream = st,
+          },
+      .log = c->log,
+  };
+  *st = (fio___http2_stream_s){
+      .session = s,
+      .sc = sc,
+      .window = (int64_t)s->peer_window,
+      .id = id,
+      .flags = FIO___HTTP2_STREAM_ACTIVE | FIO___HTTP2_STREAM_COUNTED,
+  };
+  st->pending = FIO_LIST_INIT(st->pending);
+  st->out = FIO_LIST_INIT(st->out);
+  FIO_LIST_PUSH(&s->streams, &st->node);
+  fio___http2_map_set(&s->map, id, st, NULL);
+  ++s->active;
+  /* attach a new HTTP handle */
+  st->h = fio_http_new();
+  FIO_ASSERT_ALLOC(st->h);
+  fio_http_controller_set(st->h,
+                          &p->state[FIO___HTTP_PROTOCOL_HTTP2].controller);
+  fio_http_udata_set(st->h, c->udata);
+  fio_http_cdata_set(st->h, fio___http_connection_dup(sc));
+  if (c->settings->compress_dynamic)
+    fio_http_cflags_set(st->h, FIO_HTTP_CFLAG_COMPRESS_DYNAMIC);
+  fio_http_version_set(st->h, FIO_STR_INFO2((char *)"HTTP/2", 6));
+  return st;
+}
+
+/** Resets a stream (stream error or RST_STREAM received). */
+FIO_SFUNC void fio___http2_stream_reset(fio___http2_stream_s *st,
+                                        uint32_t error) {
+  fio_http_s *h = st->h;
+  if (error)
+    fio___http2_send_rst(st->session, st->id, error);
+  fio___http2_stream_deactivate(st);
+  fio___http2_stream_drop_output(st);
+  st->h = NULL;
+  if (h) /* the stream is freed once the handle was released */
+    fio_http_free(h);
+  else
+    fio___http2_stream_maybe_free(st);
+}
+
+/** Marks the local side as closed once END_STREAM was sent. */
+FIO_SFUNC void fio___http2_stream_local_close(fio___http2_stream_s *st) {
+  FIO_LIST_REMOVE_RESET(&st->pending);
+  if (!(st->flags & FIO___HTTP2_STREAM_REMOTE_CLOSED)) /* ignore the upload */
+    fio___http2_send_rst(st->session, st->id, FIO_HTTP2_NO_ERROR);
+  fio___http2_stream_deactivate(st);
+  fio___http2_stream_maybe_free(st);
+}
+
+/** Passes a request to the user (or responds with an error). */
+FIO_SFUNC void fio___http2_stream_dispatch(fio___http2_stream_s *st) {
+  fio_http_s *h = st->h;
+  if (!h)
+    return;
+  st->h = NULL;
+  if (st->error) {
+    fio_http_send_error_response(h, st->error);
+    fio_http_free(h);
+    return;
+  }
+  st->flags |= FIO___HTTP2_STREAM_DISPATCHED;
+  st->io = fio_io_dup(st->sc->io); /* valid until the handle was released */
+  fio_queue_push(fio_io_queue(), st->sc->state.http2.on_http_callback, h);
+}
+
+/* *****************************************************************************
+HTTP/2 Response Output (IO thread)
+***************************************************************************** */
+
+/* header fields that change too often to be worth indexing */
+FIO_IFUNC fio_hpack_indexing_e fio___http2_indexing(fio_buf_info_s n) {
+  static const fio_buf_info_s skip[] = {
+      {.buf = (char *)"date", .len = 4},
+      {.buf = (char *)"etag", .len = 4},
+      {.buf = (char *)"set-cookie", .len = 10},
+      {.buf = (char *)"content-range", .len = 13},
+      {.buf = (char *)"last-modified", .len = 13},
+      {.buf = (char *)"content-length", .len = 14},
+  };
+  for (size_t i = 0; i < sizeof(skip) / sizeof(skip[0]); ++i)
+    if (n.len == skip[i].len && !FIO_MEMCMP(n.buf, skip[i].buf, n.len))
+      return FIO_HPACK_NO_INDEX;
+  return FIO_HPACK_INDEX;
+}
+
+/** HPACK encodes a packed header list as HEADERS (+ CONTINUATION) frames. */
+FIO_SFUNC void fio___http2_write_headers(fio___http2_s *s,
+                                         fio___http2_stream_s *st,
+                                         fio___http2_out_s *o,
+                                         int end_stream) {
+  const char *pos = o->buf;
+  const char *end = o->buf + o->len;
+  const size_t frame = s->peer_frame;
+  size_t bound = 0, len = FIO_HTTP2_FRAME_HEADER_LEN;
+  fio_str_info_s b = {0};
+  /* each field is packed as [u16 name len][u32 value len][name][value] */
+  for (const char *p = pos; p < end;) {
+    const size_t nlen = fio_buf2u16_be(p), vlen = fio_buf2u32_be(p + 2);
+    bound += FIO_HPACK_ENCODE_BOUND(nlen, vlen);
+    p += 6 + nlen + vlen;
+  }
+  if (FIO_STRING_REALLOC(&b, len + bound + 64))
+    return;
+  while (pos < end) {
+    const size_t nlen = fio_buf2u16_be(pos), vlen = fio_buf2u32_be(pos + 2);
+    fio_buf_info_s n = FIO_BUF_INFO2((char *)pos + 6, nlen);
+    fio_buf_info_s v = FIO_BUF_INFO2((char *)pos + 6 + nlen, vlen);
+    len += fio_hpack_encode(&s->encoder,
+                            b.buf + len,
+                            n,
+                            v,
+                            fio___http2_indexing(n));
+    pos += 6 + nlen + vlen;
+  }
+  b.len = len;
+  len -= FIO_HTTP2_FRAME_HEADER_LEN;
+  if (len > frame) { /* (rare) split into CONTINUATION frames */
+    const size_t extra = ((len - 1) / frame) * FIO_HTTP2_FRAME_HEADER_LEN;
+    fio_str_info_s tmp = {0};
+    if (FIO_STRING_REALLOC(&tmp, b.len + extra)) {
+      FIO_STRING_FREE2(b);
+      return;
+    }
+    size_t from = FIO_HTTP2_FRAME_HEADER_LEN, to = 0;
+    for (size_t i = 0; from < b.len; ++i) {
+      const size_t n = (b.len - from > frame) ? frame : (b.len - from);
+      const uint8_t last = (from + n == b.len);
+      fio_http2_frame_write(
+          tmp.buf + to,
+          (fio_http2_frame_s){
+              .len = (uint32_t)n,
+              .stream_id = st->id,
+              .type = (uint8_t)(i ? FIO_HTTP2_FRAME_CONTINUATION
+                                  : FIO_HTTP2_FRAME_HEADERS),
+              .flags = (uint8_t)((last ? FIO_HTTP2_FLAG_END_HEADERS : 0) |
+                                 ((!i && end_stream) ? FIO_HTTP2_FLAG_END_STREAM
+                                                     : 0)),
+          });
+      FIO_MEMCPY(tmp.buf + to + FIO_HTTP2_FRAME_HEADER_LEN, b.buf + from, n);
+      to += FIO_HTTP2_FRAME_HEADER_LEN + n;
+      from += n;
+    }
+    FIO_STRING_FREE2(b);
+    b = tmp;
+    b.len = to;
+  } else {
+    fio_http2_frame_write(
+        b.buf,
+        (fio_http2_frame_s){
+            .len = (uint32_t)len,
+            .stream_id = st->id,
+            .type = FIO_HTTP2_FRAME_HEADERS,
+            .flags = (uint8_t)(FIO_HTTP2_FLAG_END_HEADERS |
+                               (end_stream ? FIO_HTTP2_FLAG_END_STREAM : 0)),
+        });
+  }
+  fio_io_write2(s->c->io,
+                .buf = b.buf,
+                .len = b.len,
+                .dealloc = FIO_STRING_FREE);
+}
+
+/** Sends a DATA frame with up to `n` bytes of the output chunk. */
+FIO_SFUNC void fio___http2_write_data(fio___http2_s *s,
+                                      fio___http2_stream_s *st,
+                                      fio___http2_out_s *o,
+                                      size_t n,
+                                      int end_stream) {
+  const fio_http2_frame_s f = {
+      .len = (uint32_t)n,
+      .stream_id = st->id,
+      .type = FIO_HTTP2_FRAME_DATA,
+      .flags = (uint8_t)(end_stream ? FIO_HTTP2_FLAG_END_STREAM : 0),
+  };
+  if (o->fd != -1) { /* send the file without a user space copy */
+    char hdr[FIO_HTTP2_FRAME_HEADER_LEN];
+    /* each queued packet owns its fd, so a reset can't close a queued file */
+    int fd = o->fd;
+    if (n == o->len && !o->keep_fd)
+      o->fd = -1; /* the last chunk takes ownership */
+    else if ((fd = fio_file_dup(fd)) == -1) {
+      FIO_LOG_ERROR("(%d) HTTP/2 couldn't dup a file descriptor: %s",
+                    fio_io_pid(),
+                    strerror(errno));
+      fio_io_close(s->c->io);
+      return;
+    }
+    fio_http2_frame_write(hdr, f);
+    fio_io_write2(s->c->io, .buf = hdr, .len = sizeof(hdr), .copy = 1);
+    fio_io_write2(s->c->io, .fd = fd, .len = n, .offset = o->offset);
+    return;
+  }
+  fio_str_info_s b = {0};
+  if (FIO_STRING_REALLOC(&b, FIO_HTTP2_FRAME_HEADER_LEN + n + 1))
+    return;
+  fio_http2_frame_write(b.buf, f);
+  if (n)
+    FIO_MEMCPY(b.buf + FIO_HTTP2_FRAME_HEADER_LEN, o->buf + o->offset, n);
+  fio_io_write2(s->c->io,
+                .buf = b.buf,
+                .len = FIO_HTTP2_FRAME_HEADER_LEN + n,
+                .dealloc = FIO_STRING_FREE);
+}
+
+/**
+ * Sends as much of a stream's output as flow control allows.
+ *
+ * Returns -1 if the stream is blocked (by flow control or the IO backlog).
+ */
+FIO_SFUNC int fio___http2_stream_flush(fio___http2_s *s,
+                                       fio___http2_stream_s *st) {
+  while (!FIO_LIST_IS_EMPTY(&st->out)) {
+    fio___http2_out_s *o =
+        FIO_PTR_FROM_FIELD(fio___http2_out_s, node, st->out.next);
+    fio___http2_out_s *fin =
+        (o->node.next != &st->out &&
+         FIO_PTR_FROM_FIELD(fio___http2_out_s, node, o->node.next)->kind ==
+             FIO___HTTP2_OUT_FIN)
+            ? FIO_PTR_FROM_FIELD(fio___http2_out_s, node, o->node.next)
+            : NULL;
+    if (o->kind == FIO___HTTP2_OUT_DATA && o->len) {
+      size_t n = o->len;
+      if (st->window < (int64_t)n)
+        n = (st->window > 0) ? (size_t)st->window : 0;
+      if (s->window < (int64_t)n)
+        n = (s->window > 0) ? (size_t)s->window : 0;
+      if (n > s->peer_frame)
+        n = s->peer_frame;
+      if (!n)
+        return -1;
+      fio___http2_write_data(s, st, o, n, (fin && n == o->len));
+      st->window -= (int64_t)n;
+      s->window -= (int64_t)n;
+      o->offset += n;
+      o->len -= n;
+      if (o->len) {
+        if (fio_io_backlog(s->c->io) > FIO___HTTP2_BACKLOG_LIMIT)
+          return -1;
+        continue;
+      }
+    } else if (o->kind == FIO___HTTP2_OUT_HEADERS) {
+      fio___http2_write_headers(s, st, o, !!fin);
+    } else if (o->kind == FIO___HTTP2_OUT_FIN) {
+      fio___http2_write_data(s, st, o, 0, 1);
+      fin = o;
+      o = NULL;
+    }
+    if (o) {
+      FIO_LIST_REMOVE(&o->node);
+      fio___http2_out_free(o);
+    }
+    if (fin) {
+      FIO_LIST_REMOVE(&fin->node);
+      fio___http2_out_free(fin);
+      fio___http2_stream_local_close(st); /* might free the stream */
+      return 0;
+    }
+  }
+  FIO_LIST_REMOVE_RESET(&st->pending);
+  return 0;
+}
+
+/** Sends pending output for all streams (in order). */
+FIO_SFUNC void fio___http2_flush(fio___http2_s *s) {
+  FIO_LIST_EACH(fio___http2_stream_s, pending, &s->pending, st) {
+    if (fio_io_backlog(s->c->io) > FIO___HTTP2_BACKLOG_LIMIT)
+      return;
+    fio___http2_stream_flush(s, st);
+  }
+}
+
+/* flushing is deferred, so a response's chunks are framed together. */
+FIO_SFUNC void fio___http2_flush_task(void *c_, void *ignr_) {
+  fio___http_connection_s *c = (fio___http_connection_s *)c_;
+  fio___http2_s *s = c->state.http2.session;
+  if (s) {
+    s->flush = 0;
+    fio___http2_flush(s);
+  }
+  fio___http_connection_free(c);
+  (void)ignr_;
+}
+
+/** Receives an output chunk from the controller. */
+FIO_SFUNC void fio___http2_on_output(void *sc_, void *o_) {
+  fio___http_connection_s *sc = (fio___http_connection_s *)sc_;
+  fio___http2_out_s *o = (fio___http2_out_s *)o_;
+  fio___http2_stream_s *st = sc->state.http2.stream;
+  fio___http2_s *s;
+  if (o->kind == FIO___HTTP2_OUT_FIN &&
+      (st->flags & FIO___HTTP2_STREAM_DISPATCHED)) {
+    st->flags ^= FIO___HTTP2_STREAM_DISPATCHED;
+    if (st->session && !(st->flags & FIO___HTTP2_STREAM_ACTIVE))
+      fio___http2_stream_uncount(st); /* the stream was reset */
+  }
+  s = st->session;
+  if (!s || (st->flags & FIO___HTTP2_STREAM_LOCAL_CLOSED) ||
+      (o->kind == FIO___HTTP2_OUT_DATA &&
+       (st->flags & FIO___HTTP2_STREAM_HEAD))) {
+    fio___http2_out_free(o);
+    return;
+  }
+  FIO_LIST_PUSH(&st->out, &o->node);
+  if (FIO_LIST_IS_EMPTY(&st->pending))
+    FIO_LIST_PUSH(&s->pending, &st->pending);
+  if (s->flush)
+    return;
+  s->flush = 1;
+  fio_io_defer_to(s->c->io,
+                  fio___http2_flush_task,
+                  fio___http_connection_dup(s->c),
+                  NULL);
+}
+
+/* *****************************************************************************
+HTTP/2 Controller (any thread)
+***************************************************************************** */
+
+/* tests for connection specific header names (forbidden in HTTP/2). */
+FIO_SFUNC int fio___http2_is_connection_header(fio_buf_info_s n) {
+  static const fio_buf_info_s names[] = {
+      {.buf = (char *)"upgrade", .len = 7},
+      {.buf = (char *)"keep-alive", .len = 10},
+      {.buf = (char *)"connection", .len = 10},
+      {.buf = (char *)"proxy-connection", .len = 16},
+      {.buf = (char *)"transfer-encoding", .len = 17},
+  };
+  for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+    if (n.len == names[i].len && !FIO_MEMCMP(n.buf, names[i].buf, n.len))
+      return 1;
+  return 0;
+}
+
+/** Packs a header field (lower case name) into the header list. */
+FIO_SFUNC int fio___http2_header_list_cb(fio_http_s *h,
+                                         fio_str_info_s name,
+                                         fio_str_info_s value,
+                                         void *udata) {
+  fio_str_info_s *buf = (fio_str_info_s *)udata;
+  char prefix[6];
+  const size_t start = buf->len + 6;
+  if (!name.len || name.len > 0xFFFF)
+    return 0;
+  fio_u2buf16_be(prefix, name.len);
+  fio_u2buf32_be(prefix + 2, value.len);
+  fio_string_write2(buf,
+                    FIO_STRING_REALLOC,
+                    FIO_STRING_WRITE_STR2(prefix, 6),
+                    FIO_STRING_WRITE_STR2(name.buf, name.len),
+                    FIO_STRING_WRITE_STR2(value.buf, value.len));
+  if (buf->len < start + name.len + value.len)
+    return -1; /* allocation failed */
+  for (size_t i = 0; i < name.len; ++i)
+    buf->buf[start + i] |= (char)(((uint8_t)(buf->buf[start + i] - 'A') < 26)
+                                  << 5);
+  if (fio___http2_is_connection_header(FIO_BUF_INFO2(buf->buf + start,
+                                                     name.len)))
+    buf->len = start - 6;
+  return 0;
+  (void)h;
+}
+
+/** Informs the controller that response headers must be sent. */
+FIO_SFUNC void fio___http2_controller_send_headers(fio_http_s *h) {
+  fio___http_connection_s *sc = (fio___http_connection_s *)fio_http_cdata(h);
+  fio_str_info_s buf = FIO_STR_INFO2(NULL, 0);
+  char status[8];
+  size_t status_len = fio_digits10u(fio_http_status(h));
+  if (status_len > 3)
+    status_len = 3;
+  fio_ltoa10u(status, fio_http_status(h), status_len);
+  fio___http2_header_list_cb(h,
+                             FIO_STR_INFO2((char *)":status", 7),
+                             FIO_STR_INFO2(status, status_len),
+                             &buf);
+  fio_http_response_header_each(h, fio___http2_header_list_cb, &buf);
+  fio_http_set_cookie_each(h, fio___http2_header_list_cb, &buf);
+  fio___http2_out_s *o = fio___http2_out_new(FIO___HTTP2_OUT_HEADERS, 0);
+  o->buf = buf.buf;
+  o->len = buf.len;
+  o->dealloc = FIO_STRING_FREE;
+  fio_io_defer_to(sc->io, fio___http2_on_output, sc, o);
+}
+
+/** Called by the HTTP handle for each body chunk. */
+FIO_SFUNC void fio___http2_controller_write_body(fio_http_s *h,
+                                                 fio_http_write_args_s args) {
+  fio___http_connection_s *sc = (fio___http_connection_s *)fio_http_cdata(h);
+  fio___http2_out_s *o;
+  if (args.buf) {
+    if (!args.len)
+      goto no_write;
+    if (args.copy) {
+      o = fio___http2_out_new(FIO___HTTP2_OUT_DATA, args.len);
+      FIO_MEMCPY(o->mem, (char *)args.buf + args.offset, args.len);
+      o->buf = o->mem;
+      if (args.dealloc)
+        args.dealloc((void *)args.buf);
+    } else {
+      o = fio___http2_out_new(FIO___HTTP2_OUT_DATA, 0);
+      o->buf = (const char *)args.buf;
+      o->offset = args.offset;
+      o->dealloc = args.dealloc;
+    }
+    o->len = args.len;
+  } else if ((uint32_t)(args.fd + 1) > 1U) {
+    if (!args.len) { /* send the rest of the file */
+      if (fio_fd_type(args.fd) != S_IFREG)
+        goto no_length;
+      off_t len = fio_fd_size(args.fd);
+      if (!args.offset) {
+        off_t offset = lseek(args.fd, 0, SEEK_CUR);
+        args.offset = (size_t)(offset > 0 ? offset : 0);
+      }
+      if (len <= (off_t)args.offset)
+        goto no_length;
+      args.len = (size_t)len - args.offset;
+    }
+    o = fio___http2_out_new(FIO___HTTP2_OUT_DATA, 0);
+    o->fd = args.fd;
+    o->keep_fd = (uint8_t)!!args.copy;
+    o->offset = args.offset;
+    o->len = args.len;
+  } else
+    return;
+  fio_io_defer_to(sc->io, fio___http2_on_output, sc, o);
+  return;
+
+no_length:
+  FIO_LOG_ERROR("HTTP/2 couldn't determine the length of the file to send.");
+no_write:
+  if (args.buf) {
+    if (args.dealloc)
+      args.dealloc((void *)args.buf);
+  } else if ((uint32_t)(args.fd + 1) > 1U && !args.copy) {
+    close(args.fd);
+  }
+}
+
+/** Called once a response had finished. */
+FIO_SFUNC void fio___http2_controller_on_finish(fio_http_s *h) {
+  fio___http_connection_s *sc = (fio___http_connection_s *)fio_http_cdata(h);
+  if (sc->log)
+    fio_http_write_log(h);
+  /* once the function returns, `h` may be freed (auto-finish on free). */
+  sc->state.http2.on_finish(h);
+  fio_io_defer_to(sc->io,
+                  fio___http2_on_output,
+                  sc,
+                  fio___http2_out_new(FIO___HTTP2_OUT_FIN, 0));
+}
+
+/* the handle's reference to the stream is released on the IO thread. */
+FIO_SFUNC void fio___http2_on_released(void *sc_, void *ignr_) {
+  fio___http_connection_s *sc = (fio___http_connection_s *)sc_;
+  fio___http2_stream_s *st = sc->state.http2.stream;
+  fio_io_s *io = st->io;
+  st->io = NULL;
+  st->flags |= FIO___HTTP2_STREAM_RELEASED;
+  fio___http2_stream_maybe_free(st);
+  fio___http_connection_free(sc);
+  fio_io_free(io); /* might close the session (never the stream) */
+  (void)ignr_;
+}
+
+/** Called when an HTTP handle is freed. */
+FIO_SFUNC void fio___http2_controller_on_destroyed(fio_http_s *h) {
+  fio___http_connection_s *sc = (fio___http_connection_s *)fio_http_cdata(h);
+  if (!(fio_http_is_upgraded(h) | fio_http_is_finished(h))) {
+    /* auto-finish if freed without finishing */
+    if (!fio_http_status(h))
+      fio_http_status_set(h, 500); /* ignored if headers already sent */
+    fio_http_write_args_s args = {.finish = 1};
+    fio_http_write FIO_NOOP(h, args);
+  }
+  fio_io_defer_to(sc->io, fio___http2_on_released, sc, NULL);
+}
+
+/* *****************************************************************************
+HTTP/2 Request Headers
+***************************************************************************** */
+
+/** Header block decoding state (the HPACK decoder's `udata`). */
+typedef struct {
+  fio___http2_s *s;
+  fio___http2_stream_s *st; /* NULL if the block is ignored */
+  uint8_t calm;             /* the scratch space reached its limit */
+} fio___http2_decode_s;
+
+/** Grows the HPACK scratch space, up to SETTINGS_MAX_HEADER_LIST_SIZE. */
+FIO_SFUNC int fio___http2_on_scratch(fio_str_info_s *scratch,
+                                     size_t capa,
+                                     void *d_) {
+  fio___http2_decode_s *d = (fio___http2_decode_s *)d_;
+  fio___http2_s *s = d->s;
+  const size_t limit = (size_t)s->c->settings->max_header_size;
+  if (capa > limit) { /* a larger field exceeds the header list limit */
+    d->calm = 1;
+    capa = limit;
+  }
+  if (capa <= scratch->capa)
+    return -1;
+  if (s->scratch) /* keep the field's decoded data */
+    fio_bstr_len_set(s->scratch, scratch->len);
+  s->scratch = fio_bstr_reserve(s->scratch, capa - scratch->len);
+  scratch->buf = s->scratch;
+  scratch->capa = fio_bstr_info(s->scratch).capa;
+  fio_bstr_len_set(s->scratch, 0);
+  return 0;
+}
+
+/** Called by the HPACK decoder for each request header field. */
+FIO_SFUNC int fio___http2_on_header(fio_buf_info_s name,
+                                    fio_buf_info_s value,
+                                    void *d_) {
+  fio___http2_stream_s *st = ((fio___http2_decode_s *)d_)->st;
+  fio_http_s *h;
+  if (!st || !(h = st->h) || st->error)
+    return 0;
+  st->header_bytes += (uint32_t)(name.len + value.len + 32);
+  if (st->header_bytes > st->sc->settings->max_header_size) {
+    st->error = 431;
+    return 0;
+  }
+  if (!name.len)
+    goto malformed;
+  if (name.buf[0] == ':') { /* pseudo-headers */
+    if ((st->flags & FIO___HTTP2_STREAM_REGULAR))
+      goto malformed;
+    if (name.len == 7 && !FIO_MEMCMP(name.buf, ":method", 7)) {
+      if (!value.len || fio_http_method(h).len)
+        goto malformed;
+      fio_http_method_set(h, FIO_BUF2STR_INFO(value));
+      if (value.len == 4 && !FIO_MEMCMP(value.buf, "HEAD", 4))
+        st->flags |= FIO___HTTP2_STREAM_HEAD;
+    } else if (name.len == 5 && !FIO_MEMCMP(name.buf, ":path", 5)) {
+      char *q;
+      if (!value.len || value.buf[0] != '/' || fio_http_path(h).len)
+        goto malformed;
+      if ((q = (char *)FIO_MEMCHR(value.buf, '?', value.len))) {
+        fio_http_query_set(
+            h,
+            FIO_STR_INFO2(q + 1, (size_t)(value.buf + value.len - (q + 1))));
+        value.len = (size_t)(q - value.buf);
+      }
+      fio_http_path_set(h, FIO_BUF2STR_INFO(value));
+      fio_http_opath_set(h, FIO_BUF2STR_INFO(value));
+    } else if (name.len == 10 && !FIO_MEMCMP(name.buf, ":authority", 10)) {
+      fio_http_request_header_set(h,
+                                  FIO_STR_INFO2((char *)"host", 4),
+                                  FIO_BUF2STR_INFO(value));
+    } else if (!(name.len == 7 && !FIO_MEMCMP(name.buf, ":scheme", 7))) {
+      goto malformed;
+    }
+    return 0;
+  }
+  st->flags |= FIO___HTTP2_STREAM_REGULAR;
+  for (size_t i = 0; i < name.len; ++i)
+    if ((uint8_t)(name.buf[i] - 'A') < 26)
+      goto malformed;
+  if (fio___http2_is_connection_header(name) ||
+      (name.len == 2 && name.buf[0] == 't' && name.buf[1] == 'e' &&
+       !(value.len == 8 && !FIO_MEMCMP(value.buf, "trailers", 8))))
+    goto malformed;
+  if (name.len == 14 && !FIO_MEMCMP(name.buf, "content-length", 14)) {
+    uint64_t len = 0; /* values aren't NUL terminated */
+    if (!value.len || value.len > 19)
+      goto malformed;
+    for (size_t i = 0; i < value.len; ++i) {
+      if ((uint8_t)(value.buf[i] - '0') > 9)
+        goto malformed;
+      len = (len * 10) + (uint64_t)(value.buf[i] - '0');
+    }
+    if (len > st->sc->settings->max_body_size) {
+      st->error = 413;
+      return 0;
+    }
+    if (len)
+      fio_http_body_expect(h, (size_t)len);
+#if FIO_HTTP_SHOW_CONTENT_LENGTH_HEADER
+    fio_http_request_header_add(h,
+                                FIO_BUF2STR_INFO(name),
+                                FIO_BUF2STR_INFO(value));
+#endif
+    return 0;
+  }
+  fio_http_request_header_add(h,
+                              FIO_BUF2STR_INFO(name),
+                              FIO_BUF2STR_INFO(value));
+  return 0;
+malformed:
+  st->flags |= FIO___HTTP2_STREAM_MALFORMED;
+  return 0;
+}
+
+/** Decodes a complete header block (HEADERS + CONTINUATION). */
+FIO_SFUNC uint32_t fio___http2_on_header_block(fio___http2_s *s) {
+  const uint32_t id = s->block_id;
+  const int end_stream = !!(s->block_flags & FIO_HTTP2_FLAG_END_STREAM);
+  fio___http2_stream_s *st = NULL;
+  fio___http2_decode_s d = {.s = s};
+  fio_str_info_s scratch = fio_bstr_info(s->scratch);
+  fio_buf_info_s block = FIO_BUF_INFO2(s->block, fio_bstr_len(s->block));
+  s->block_id = 0;
+  if (id <= s->last_id) { /* trailers (ignored) */
+    st = fio___http2_map_get(&s->map, id);
+    if (st && (!end_stream || (st->flags & FIO___HTTP2_STREAM_REMOTE_CLOSED)))
+      return FIO_HTTP2_PROTOCOL_ERROR;
+  } else {
+    s->last_id = id;
+    if (!s->goaway && s->active < FIO_HTTP2_MAX_CONCURRENT_STREAMS)
+      st = fio___http2_stream_new(s, id);
+    else if (!s->goaway)
+      fio___http2_send_rst(s, id, FIO_HTTP2_REFUSED_STREAM);
+    d.st = st;
+  }
+  /* the block must be decoded, even if ignored, to keep HPACK in sync */
+  if (fio_hpack_decode(&s->decoder,
+                       block,
+                       &scratch,
+                       fio___http2_on_scratch,
+                       fio___http2_on_header,
+                       &d))
+    return d.calm ? FIO_HTTP2_ENHANCE_YOUR_CALM : FIO_HTTP2_COMPRESSION_ERROR;
+  if (!st)
+    return FIO_HTTP2_NO_ERROR;
+  if (st->h && ((st->flags & FIO___HTTP2_STREAM_MALFORMED) ||
+                (!st->error && (!fio_http_method(st->h).len ||
+                                !fio_http_path(st->h).len)))) {
+    fio___http2_stream_reset(st, FIO_HTTP2_PROTOCOL_ERROR);
+    return FIO_HTTP2_NO_ERROR;
+  }
+  if (end_stream)
+    st->flags |= FIO___HTTP2_STREAM_REMOTE_CLOSED;
+  if (end_stream || st->error)
+    fio___http2_stream_dispatch(st);
+  return FIO_HTTP2_NO_ERROR;
+}
+
+/* *****************************************************************************
+HTTP/2 Frame Handling
+***************************************************************************** */
+
+/* the receive window the peer may assume (ours applies once acknowledged). */
+FIO_IFUNC uint32_t fio___http2_recv_window(fio___http2_s *s, uint32_t id) {
+  if (FIO_HTTP2_WINDOW >= FIO_HTTP2_DEFAULT_WINDOW || (id && s->acked))
+    return FIO_HTTP2_WINDOW;
+  return FIO_HTTP2_DEFAULT_WINDOW;
+}
+
+/* strips padding from a frame's payload, returns -1 on error. */
+FIO_IFUNC int fio___http2_unpad(fio_http2_frame_s *f, fio_buf_info_s *p) {
+  if (!(f->flags & FIO_HTTP2_FLAG_PADDED))
+    return 0;
+  if (!p->len || (size_t)(uint8_t)p->buf[0] >= p->len)
+    return -1;
+  p->len -= 1 + (size_t)(uint8_t)p->buf[0];
+  ++p->buf;
+  return 0;
+}
+
+FIO_SFUNC uint32_t fio___http2_on_frame_data(fio___http2_s *s,
+                                             fio_http2_frame_s f,
+                                             fio_buf_info_s p) {
+  fio___http2_stream_s *st;
+  if (!f.stream_id || fio___http2_unpad(&f, &p))
+    return FIO_HTTP2_PROTOCOL_ERROR;
+  if (f.len > fio___http2_recv_window(s, 0) - s->recv)
+    return FIO_HTTP2_FLOW_CONTROL_ERROR;
+  if ((s->recv += f.len) >= (FIO_HTTP2_WINDOW >> 1)) {
+    fio___http2_send_window(s, 0, s->recv);
+    s->recv = 0;
+  }
+  st = fio___http2_map_get(&s->map, f.stream_id);
+  if (!st || (st->flags & FIO___HTTP2_STREAM_REMOTE_CLOSED)) {
+    if (f.stream_id > s->last_id)
+      return FIO_HTTP2_PROTOCOL_ERROR;
+    if (st)
+      fio___http2_stream_reset(st, FIO_HTTP2_STREAM_CLOSED);
+    return FIO_HTTP2_NO_ERROR; /* data for a stream we reset - ignore */
+  }
+  if (f.len > fio___http2_recv_window(s, st->id) - st->recv) {
+    fio___http2_stream_reset(st, FIO_HTTP2_FLOW_CONTROL_ERROR);
+    return FIO_HTTP2_NO_ERROR;
+  }
+  if (st->h && !st->error && p.len) {
+    if (p.len + fio_http_body_length(st->h) > st->sc->settings->max_body_size)
+      st->error = 413;
+    else
+      fio_http_body_write(st->h, p.buf, p.len);
+  }
+  if ((f.flags & FIO_HTTP2_FLAG_END_STREAM)) {
+    st->flags |= FIO___HTTP2_STREAM_REMOTE_CLOSED;
+    fio___http2_stream_dispatch(st);
+    return FIO_HTTP2_NO_ERROR;
+  }
+  if (st->error) /* respond early (the upload will be reset) */
+    fio___http2_stream_dispatch(st);
+  if ((st->recv += f.len) >= (FIO_HTTP2_WINDOW >> 1)) {
+    fio___http2_send_window(s, st->id, st->recv);
+    st->recv = 0;
+  }
+  return FIO_HTTP2_NO_ERROR;
+}
+
+FIO_SFUNC uint32_t fio___http2_on_frame_headers(fio___http2_s *s,
+                                                fio_http2_frame_s f,
+                                                fio_buf_info_s p) {
+  if (!f.stream_id || !(f.stream_id & 1) || fio___http2_unpad(&f, &p))
+    return FIO_HTTP2_PROTOCOL_ERROR;
+  if ((f.flags & FIO_HTTP2_FLAG_PRIORITY)) { /* priority is ignored */
+    if (p.len < 5)
+      return FIO_HTTP2_FRAME_SIZE_ERROR;
+    p.buf += 5;
+    p.len -= 5;
+  }
+  s->block_id = f.stream_id;
+  s->block_flags = f.flags;
+  if (s->block)
+    fio_bstr_len_set(s->block, 0);
+  s->block = fio_bstr_write(s->block, p.buf, p.len);
+  if ((f.flags & FIO_HTTP2_FLAG_END_HEADERS))
+    return fio___http2_on_header_block(s);
+  return FIO_HTTP2_NO_ERROR;
+}
+
+FIO_SFUNC uint32_t fio___http2_on_frame_continuation(fio___http2_s *s,
+                                                     fio_http2_frame_s f,
+                                                     fio_buf_info_s p) {
+  if (f.stream_id != s->block_id)
+    return FIO_HTTP2_PROTOCOL_ERROR;
+  if (fio_bstr_len(s->block) + p.len >
+      ((size_t)s->c->settings->max_header_size << 1))
+    return FIO_HTTP2_ENHANCE_YOUR_CALM;
+  s->block = fio_bstr_write(s->block, p.buf, p.len);
+  if ((f.flags & FIO_HTTP2_FLAG_END_HEADERS))
+    return fio___http2_on_header_block(s);
+  return FIO_HTTP2_NO_ERROR;
+}
+
+FIO_SFUNC uint32_t fio___http2_on_frame_rst(fio___http2_s *s,
+                                            fio_http2_frame_s f,
+                                            fio_buf_info_s p) {
+  fio___http2_stream_s *st;
+  if (!f.stream_id || f.stream_id > s->last_id)
+    return FIO_HTTP2_PROTOCOL_ERROR;
+  if (p.len != 4)
+    return FIO_HTTP2_FRAME_SIZE_ERROR;
+  if ((st = fio___http2_map_get(&s->map, f.stream_id)))
+    fio___http2_stream_reset(st, FIO_HTTP2_NO_ERROR);
+  return FIO_HTTP2_NO_ERROR;
+}
+
+FIO_SFUNC uint32_t fio___http2_on_frame_settings(fio___http2_s *s,
+                                                 fio_http2_frame_s f,
+                                                 fio_buf_info_s p) {
+  if (f.stream_id)
+    return FIO_HTTP2_PROTOCOL_ERROR;
+  if ((f.flags & FIO_HTTP2_FLAG_ACK)) {
+    if (p.len)
+      return FIO_HTTP2_FRAME_SIZE_ERROR;
+    s->acked = 1;
+    return FIO_HTTP2_NO_ERROR;
+  }
+  if (p.len % 6)
+    return FIO_HTTP2_FRAME_SIZE_ERROR;
+  for (size_t i = 0; i < p.len; i += 6) {
+    const uint32_t value = fio_buf2u32_be(p.buf + i + 2);
+    switch (fio_buf2u16_be(p.buf + i)) {
+    case FIO_HTTP2_SETTINGS_HEADER_TABLE_SIZE:
+      fio_hpack_max_size_set(&s->encoder, value);
+      break;
+    case FIO_HTTP2_SETTINGS_ENABLE_PUSH:
+      if (value > 1)
+        return FIO_HTTP2_PROTOCOL_ERROR;
+      break;
+    case FIO_HTTP2_SETTINGS_INITIAL_WINDOW_SIZE: {
+      const int64_t delta = (int64_t)value - (int64_t)s->peer_window;
+      if (value > FIO_HTTP2_MAX_WINDOW)
+        return FIO_HTTP2_FLOW_CONTROL_ERROR;
+      FIO_LIST_EACH(fio___http2_stream_s, node, &s->streams, st) {
+        if ((st->window += delta) > (int64_t)FIO_HTTP2_MAX_WINDOW)
+          return FIO_HTTP2_FLOW_CONTROL_ERROR;
+      }
+      s->peer_window = value;
+      break;
+    }
+    case FIO_HTTP2_SETTINGS_MAX_FRAME_SIZE:
+      if (value < FIO_HTTP2_DEFAULT_FRAME_SIZE ||
+          value > FIO_HTTP2_MAX_FRAME_SIZE)
+        return FIO_HTTP2_PROTOCOL_ERROR;
+      s->peer_frame = value;
+      break;
+    }
+  }
+  fio___http2_send(s,
+                   (fio_http2_frame_s){.type = FIO_HTTP2_FRAME_SETTINGS,
+                                       .flags = FIO_HTTP2_FLAG_ACK},
+                   NULL);
+  fio___http2_flush(s);
+  return FIO_HTTP2_NO_ERROR;
+}
+
+FIO_SFUNC uint32_t fio___http2_on_frame_window(fio___http2_s *s,
+                                               fio_http2_frame_s f,
+                                               fio_buf_info_s p) {
+  fio___http2_stream_s *st;
+  if (p.len != 4)
+    return FIO_HTTP2_FRAME_SIZE_ERROR;
+  const uint32_t inc = fio_buf2u32_be(p.buf) & 0x7FFFFFFFUL;
+  if (!f.stream_id) {
+    if (!inc)
+      return FIO_HTTP2_PROTOCOL_ERROR;
+    if ((s->window += inc) > (int64_t)FIO_HTTP2_MAX_WINDOW)
+      return FIO_HTTP2_FLOW_CONTROL_ERROR;
+    fio___http2_flush(s);
+    return FIO_HTTP2_NO_ERROR;
+  }
+  if (!(st = fio___http2_map_get(&s->map, f.stream_id)))
+    return (f.stream_id > s->last_id) ? FIO_HTTP2_PROTOCOL_ERROR
+                                      : FIO_HTTP2_NO_ERROR;
+  if (!inc) {
+    fio___http2_stream_reset(st, FIO_HTTP2_PROTOCOL_ERROR);
+    return FIO_HTTP2_NO_ERROR;
+  }
+  if ((st->window += inc) > (int64_t)FIO_HTTP2_MAX_WINDOW) {
+    fio___http2_stream_reset(st, FIO_HTTP2_FLOW_CONTROL_ERROR);
+    return FIO_HTTP2_NO_ERROR;
+  }
+  if (!FIO_LIST_IS_EMPTY(&st->pending) &&
+      fio_io_backlog(s->c->io) <= FIO___HTTP2_BACKLOG_LIMIT)
+    fio___http2_stream_flush(s, st);
+  return FIO_HTTP2_NO_ERROR;
+}
+
+/** Handles a complete frame, returns an HTTP/2 (connection) error code. */
+FIO_SFUNC uint32_t fio___http2_on_frame(fio___http2_s *s,
+                                        fio_http2_frame_s f,
+                                        fio_buf_info_s p) {
+  if (s->block_id && f.type != FIO_HTTP2_FRAME_CONTINUATION)
+    return FIO_HTTP2_PROTOCOL_ERROR;
+  switch (f.type) {
+  case FIO_HTTP2_FRAME_DATA:
+    return fio___http2_on_frame_data(s, f, p);
+  case FIO_HTTP2_FRAME_HEADERS:
+    return fio___http2_on_frame_headers(s, f, p);
+  case FIO_HTTP2_FRAME_PRIORITY:
+    if (!f.stream_id)
+      return FIO_HTTP2_PROTOCOL_ERROR;
+    return (p.len == 5) ? FIO_HTTP2_NO_ERROR : FIO_HTTP2_FRAME_SIZE_ERROR;
+  case FIO_HTTP2_FRAME_RST_STREAM:
+    return fio___http2_on_frame_rst(s, f, p);
+  case FIO_HTTP2_FRAME_SETTINGS:
+    return fio___http2_on_frame_settings(s, f, p);
+  case FIO_HTTP2_FRAME_PUSH_PROMISE: /* clients must not push */
+    return FIO_HTTP2_PROTOCOL_ERROR;
+  case FIO_HTTP2_FRAME_PING:
+    if (f.stream_id)
+      return FIO_HTTP2_PROTOCOL_ERROR;
+    if (p.len != 8)
+      return FIO_HTTP2_FRAME_SIZE_ERROR;
+    if (!(f.flags & FIO_HTTP2_FLAG_ACK))
+      fio___http2_send(s,
+                       (fio_http2_frame_s){.len = 8,
+                                           .type = FIO_HTTP2_FRAME_PING,
+                                           .flags = FIO_HTTP2_FLAG_ACK},
+                       p.buf);
+    return FIO_HTTP2_NO_ERROR;
+  case FIO_HTTP2_FRAME_GOAWAY:
+    if (f.stream_id)
+      return FIO_HTTP2_PROTOCOL_ERROR;
+    return FIO_HTTP2_NO_ERROR; /* the client will close once it's done */
+  case FIO_HTTP2_FRAME_WINDOW_UPDATE:
+    return fio___http2_on_frame_window(s, f, p);
+  case FIO_HTTP2_FRAME_CONTINUATION:
+    return fio___http2_on_frame_continuation(s, f, p);
+  }
+  return FIO_HTTP2_NO_ERROR; /* unknown frame types are ignored */
+}
+
+/* *****************************************************************************
+HTTP/2 Protocol
+***************************************************************************** */
+
+/** Consumes all complete frames in the buffer. Returns -1 on error. */
+FIO_SFUNC int fio___http2_process_data(fio___http2_s *s) {
+  size_t pos = 0;
+  uint32_t error = FIO_HTTP2_NO_ERROR;
+  while (s->len - pos >= FIO_HTTP2_FRAME_HEADER_LEN) {
+    fio_http2_frame_s f = fio_http2_frame_read(s->buf + pos);
+    if (f.len > FIO_HTTP2_DEFAULT_FRAME_SIZE) {
+      error = FIO_HTTP2_FRAME_SIZE_ERROR;
+      goto http2_error;
+    }
+    if (s->len - pos < FIO_HTTP2_FRAME_HEADER_LEN + f.len)
+      break;
+    error = fio___http2_on_frame(
+        s,
+        f,
+        FIO_BUF_INFO2(s->buf + pos + FIO_HTTP2_FRAME_HEADER_LEN, f.len));
+    pos += FIO_HTTP2_FRAME_HEADER_LEN + f.len;
+    if (error)
+      goto http2_error;
+  }
+  s->len -= (uint32_t)pos;
+  if (pos && s->len)
+    FIO_MEMMOVE(s->buf, s->buf + pos, s->len);
+  return 0;
+
+http2_error:
+  FIO_LOG_DDEBUG2("(%d) HTTP/2 connection error %u, disconnecting client at %d",
+                  fio_io_pid(),
+                  (unsigned)error,
+                  fio_io_fd(s->c->io));
+  s->len = 0;
+  fio___http2_send_goaway(s, error);
+  fio_io_close(s->c->io);
+  return -1;
+}
+
+/** Called when data is available. */
+FIO_SFUNC void fio___http2_on_data(fio_io_s *io) {
+  fio___http_connection_s *c = (fio___http_connection_s *)fio_io_udata(io);
+  fio___http2_s *s = c->state.http2.session;
+  size_t r;
+  for (;;) {
+    if (!(r = fio_io_read(io, s->buf + s->len, sizeof(s->buf) - s->len)))
+      return;
+    s->len += (uint32_t)r;
+    if (fio___http2_process_data(s))
+      return;
+  }
+}
+
+/** Called when the IO is attached (the client preface was consumed). */
+FIO_SFUNC void fio___http2_on_attach(fio_io_s *io) {
+  fio___http_connection_s *c = (fio___http_connection_s *)fio_io_udata(io);
+  fio___http2_s *s =
+      (fio___http2_s *)FIO_MEM_REALLOC_(NULL, 0, sizeof(*s), 0);
+  FIO_ASSERT_ALLOC(s);
+  FIO_LEAK_COUNTER_ON_ALLOC(fio___http2_s);
+  *s = (fio___http2_s){
+      .c = c,
+      .window = FIO_HTTP2_DEFAULT_WINDOW,
+      .peer_window = FIO_HTTP2_DEFAULT_WINDOW,
+      .peer_frame = FIO_HTTP2_DEFAULT_FRAME_SIZE,
+  };
+  s->streams = FIO_LIST_INIT(s->streams);
+  s->pending = FIO_LIST_INIT(s->pending);
+  fio_hpack_init(&s->decoder);
+  fio_hpack_init(&s->encoder);
+  c->state.http2.session = s;
+  { /* the server's preface: SETTINGS and the connection's window */
+    char p[18];
+    fio_u2buf16_be(p, FIO_HTTP2_SETTINGS_MAX_CONCURRENT_STREAMS);
+    fio_u2buf32_be(p + 2, FIO_HTTP2_MAX_CONCURRENT_STREAMS);
+    fio_u2buf16_be(p + 6, FIO_HTTP2_SETTINGS_INITIAL_WINDOW_SIZE);
+    fio_u2buf32_be(p + 8, FIO_HTTP2_WINDOW);
+    fio_u2buf16_be(p + 12, FIO_HTTP2_SETTINGS_MAX_HEADER_LIST_SIZE);
+    fio_u2buf32_be(p + 14, c->settings->max_header_size);
+    fio___http2_send(s,
+                     (fio_http2_frame_s){.len = 18,
+                                         .type = FIO_HTTP2_FRAME_SETTINGS},
+                     p);
+    if (FIO_HTTP2_WINDOW > FIO_HTTP2_DEFAULT_WINDOW)
+      fio___http2_send_window(s,
+                              0,
+                              FIO_HTTP2_WINDOW - FIO_HTTP2_DEFAULT_WINDOW);
+  }
+  /* move any data read with the preface (might exceed `s->buf`) */
+  for (size_t pos = 0; pos < c->len;) {
+    size_t len = sizeof(s->buf) - s->len;
+    if (len > c->len - pos)
+      len = c->len - pos;
+    FIO_MEMCPY(s->buf + s->len, c->buf + pos, len);
+    s->len += (uint32_t)len;
+    pos += len;
+    if (fio___http2_process_data(s)) {
+      c->len = 0;
+      return;
+    }
+  }
+  c->len = 0;
+  fio___http2_on_data(io);
+}
+
+/** Called when the IO is ready to send more data. */
+FIO_SFUNC void fio___http2_on_ready(fio_io_s *io) {
+  fio___http_connection_s *c = (fio___http_connection_s *)fio_io_udata(io);
+  if (c->state.http2.session)
+    fio___http2_flush(c->state.http2.session);
+}
+
+/** Called when the server is shutting down. */
+FIO_SFUNC void fio___http2_on_shutdown(fio_io_s *io) {
+  fio___http_connection_s *c = (fio___http_connection_s *)fio_io_udata(io);
+  if (c->state.http2.session)
+    fio___http2_send_goaway(c->state.http2.session, FIO_HTTP2_NO_ERROR);
+}
+
+/** Called after the connection was closed. */
+FIO_SFUNC void fio___http2_on_close(void *buf, void *udata) {
+  fio___http_connection_s *c = (fio___http_connection_s *)udata;
+  fio___http2_s *s = c->state.http2.session;
+  c->state.http2.session = NULL;
+  if (s) {
+    while (!FIO_LIST_IS_EMPTY(&s->streams)) {
+      fio___http2_stream_s *st =
+          FIO_PTR_FROM_FIELD(fio___http2_stream_s, node, s->streams.next);
+      fio_http_s *h = st->h;
+      FIO_LIST_REMOVE_RESET(&st->node);
+      fio___http2_stream_drop_output(st);
+      st->flags |=
+          FIO___HTTP2_STREAM_REMOTE_CLOSED | FIO___HTTP2_STREAM_LOCAL_CLOSED;
+      st->flags &= ~(uint16_t)FIO___HTTP2_STREAM_ACTIVE;
+      st->session = NULL;
+      st->sc->io = NULL;
+      st->h = NULL;
+      if (h)
+        fio_http_free(h); /* the stream is freed once the handle is released */
+      else
+        fio___http2_stream_maybe_free(st);
+    }
+    fio___http2_map_destroy(&s->map);
+    fio_bstr_free(s->block);
+    fio_bstr_free(s->scratch);
+    FIO_MEM_FREE_(s, sizeof(*s));
+    FIO_LEAK_COUNTER_ON_FREE(fio___http2_s);
+  }
+  fio___http_on_close(buf, udata);
+}
+
+/* *****************************************************************************
+HTTP/2 Finish
+***************************************************************************** */
+#endif /* FIO_HTTP */
@@ -44,15 +44,8 @@ refuse_upgrade:
 EventSource (SSE) Helpers - HTTP Upgraded Connections
 ***************************************************************************** */
 
-void fio_http_sse_write___(void); /* IDE Marker */
-/** Writes an SSE message (UTF-8). Fails if connection wasn't upgraded yet. */
-SFUNC int fio_http_sse_write FIO_NOOP(fio_http_s *h,
-                                      fio_http_sse_write_args_s args) {
-  if (!args.data.len || !h || !fio_http_is_sse(h))
-    return -1;
-  fio___http_connection_s *c = (fio___http_connection_s *)fio_http_cdata(h);
-  if (!c || !c->io)
-    return -1;
+/** Encodes an SSE message as a `fio_bstr`. */
+FIO_SFUNC char *fio___http_sse_encode(fio_http_sse_write_args_s args) {
   char *payload =
       fio_bstr_reserve(NULL, args.id.len + args.event.len + args.data.len + 22);
   if (args.id.len)
@@ -90,6 +83,19 @@ SFUNC int fio_http_sse_write FIO_NOOP(fio_http_s *h,
                         FIO_STRING_WRITE_STR2("\r\n", 2));
   /* event ends on empty line */
   payload = fio_bstr_write(payload, "\r\n", 2);
+  return payload;
+}
+
+void fio_http_sse_write___(void); /* IDE Marker */
+/** Writes an SSE message (UTF-8). Fails if connection wasn't upgraded yet. */
+SFUNC int fio_http_sse_write FIO_NOOP(fio_http_s *h,
+                                      fio_http_sse_write_args_s args) {
+  if (!args.data.len || !h || !fio_http_is_sse(h))
+    return -1;
+  fio___http_connection_s *c = (fio___http_connection_s *)fio_http_cdata(h);
+  if (!c || !c->io)
+    return -1;
+  char *payload = fio___http_sse_encode(args);
   fio_io_write2(c->io,
                 .buf = payload,
                 .len = fio_bstr_len(payload),
@@ -97,17 +103,35 @@ SFUNC int fio_http_sse_write FIO_NOOP(fio_http_s *h,
   return 0;
 }
 
+/** Encodes a pub/sub message as a (shareable) SSE message. */
+FIO_SFUNC char *fio___http_sse_broadcast_encode(fio_pubsub_msg_s *msg,
+                                                uint32_t variant,
+                                                void *ignr_) {
+  FIO_STR_INFO_TMP_VAR(id_str, 64);
+  fio_string_write_hex(&id_str, NULL, msg->id);
+  return fio___http_sse_encode((fio_http_sse_write_args_s){
+      .id = FIO_STR2BUF_INFO(id_str),
+      .event = FIO_STR2BUF_INFO(msg->channel),
+      .data = FIO_STR2BUF_INFO(msg->message),
+  });
+  (void)variant, (void)ignr_;
+}
+
 /** Optional EventSource subscription callback - messages MUST be UTF-8. */
 SFUNC void FIO_HTTP_SSE_SUBSCRIBE_DIRECT(fio_pubsub_msg_s *msg) {
   fio___http_connection_s *c = (fio___http_connection_s *)fio_io_udata(msg->io);
-  if (!c)
+  if (!c || !c->io || !msg->message.len || !c->h || !fio_http_is_sse(c->h))
     return;
-  FIO_STR_INFO_TMP_VAR(id_str, 64);
-  fio_string_write_hex(&id_str, NULL, msg->id);
-  fio_http_sse_write(c->h,
-                     .id = FIO_STR2BUF_INFO(id_str),
-                     .event = FIO_STR2BUF_INFO(msg->channel),
-                     .data = FIO_STR2BUF_INFO(msg->message));
+  char *frame = fio___http_broadcast_frame(msg,
+                                           FIO___HTTP_BROADCAST_SSE,
+                                           fio___http_sse_broadcast_encode,
+                                           NULL);
+  if (!frame)
+    return;
+  fio_io_write2(c->io,
+                .buf = frame,
+                .len = fio_bstr_len(frame),
+                .dealloc = (void (*)(void *))fio_bstr_free);
 }
 
 /* *****************************************************************************
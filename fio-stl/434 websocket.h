@@ -124,6 +124,7 @@ FIO_SFUNC void fio___http_perform_user_upgrade_callback_websocket(void *cb_,
       c->deflate_wr = fio_deflate_new(1, 1);
       c->deflate_rd = fio_deflate_new(1, 0);
       fio_deflate_window_bits_set(c->deflate_wr, server_bits);
+      c->deflate_wr_bits = (uint8_t)server_bits;
       c->deflate_wr_reset = 1; /* server_no_context_takeover (always) */
       c->deflate_rd_reset = 1; /* client_no_context_takeover (always) */
       FIO_LOG_DDEBUG2("WebSocket permessage-deflate negotiated "
@@ -172,7 +173,7 @@ FIO_IFUNC void fio___websocket_on_msg_task(fio___http_connection_s *c,
   /* `fio_bstr_free(NULL)` is a no-op. */
   fio_bstr_free(c->state.ws.msg);
   c->state.ws.msg = NULL;
-  fio_io_defer(fio___websocket_on_message_finalize, c, NULL);
+  fio_io_defer_to(c->io, fio___websocket_on_message_finalize, c, NULL);
 }
 
 /** Delivers a complete text message to the user then schedules finalize. */
@@ -555,15 +556,126 @@ SFUNC int fio_http_on_message_set(fio_http_s *h,
   return 0;
 }
 
+/* *****************************************************************************
+WebSocket Compression (permessage-deflate)
+***************************************************************************** */
+
+/**
+ * Compresses a message using the connection's compressor (RFC 7692 §7.2.1).
+ *
+ * Returns NULL if permessage-deflate wasn't negotiated, the message is too
+ * short or compression doesn't pay off. Otherwise, returns a buffer of
+ * `*comp_alloc` bytes (free with `fio___websocket_deflate_free`).
+ */
+FIO_SFUNC char *fio___websocket_deflate(fio___http_connection_s *c,
+                                        const void *buf,
+                                        size_t len,
+                                        size_t *comp_len,
+                                        size_t *comp_alloc) {
+  if (!c->deflate_wr || len < FIO_HTTP_WEBSOCKET_DEFLATE_MIN)
+    return NULL;
+  /* Output bound: input + 12.5% + 32B overhead. */
+  *comp_alloc = len + (len >> 3) + 32;
+  char *comp_buf = (char *)FIO_MEM_REALLOC(NULL, 0, *comp_alloc, 0);
+  if (!comp_buf)
+    return NULL;
+  FIO_LEAK_COUNTER_ON_ALLOC(fio___websocket_deflate_buf);
+  size_t r =
+      fio_deflate_push(c->deflate_wr, comp_buf, *comp_alloc, buf, len, 1);
+  /* Reset compressor if server_no_context_takeover. */
+  if (c->deflate_wr_reset)
+    fio_deflate_destroy(c->deflate_wr);
+  if (r >= 4) {
+    /* RFC 7692 §7.2.1: strip trailing 00 00 FF FF sync marker. */
+    const uint8_t *tail = (const uint8_t *)comp_buf + r - 4;
+    if (tail[0] == 0x00 && tail[1] == 0x00 && tail[2] == 0xFF &&
+        tail[3] == 0xFF) {
+      r -= 4;
+    }
+    /* Negative gain: compression expanded the payload — the original is sent
+     * uncompressed (RSV1 stays clear) instead. */
+    if (r < len) {
+      *comp_len = r;
+      return comp_buf;
+    }
+  }
+  /* Compression failed (or didn't pay) — fall back to uncompressed. */
+  FIO_LEAK_COUNTER_ON_FREE(fio___websocket_deflate_buf);
+  FIO_MEM_FREE(comp_buf, *comp_alloc);
+  return NULL;
+}
+
+/** Frees a buffer returned by `fio___websocket_deflate`. */
+FIO_IFUNC void fio___websocket_deflate_free(char *comp_buf, size_t comp_alloc) {
+  if (!comp_buf)
+    return;
+  FIO_LEAK_COUNTER_ON_FREE(fio___websocket_deflate_buf);
+  FIO_MEM_FREE(comp_buf, comp_alloc);
+  (void)comp_alloc; /* if unused */
+}
+
 /* *****************************************************************************
 WebSocket Writing / Subscription Helpers
 ***************************************************************************** */
 
+/** Encodes a pub/sub message as a (shareable) server WebSocket frame. */
+FIO_SFUNC char *fio___websocket_broadcast_encode(fio_pubsub_msg_s *msg,
+                                                 uint32_t variant,
+                                                 void *c_) {
+  fio___http_connection_s *c = (fio___http_connection_s *)c_;
+  fio_buf_info_s payload = msg->message;
+  uint8_t rsv = 0;
+  size_t comp_len = 0, comp_alloc = 0;
+  char *comp_buf = NULL;
+  if ((variant & FIO___HTTP_BROADCAST_WS_DEFLATE))
+    comp_buf = fio___websocket_deflate(c,
+                                       payload.buf,
+                                       payload.len,
+                                       &comp_len,
+                                       &comp_alloc);
+  if (comp_buf) {
+    payload = FIO_BUF_INFO2(comp_buf, comp_len);
+    rsv = FIO_WEBSOCKET_RSV1;
+  }
+  char *frame = fio_bstr_reserve(NULL, fio_websocket_write_len(payload.len, 0));
+  frame = fio_bstr_len_set(
+      frame,
+      fio_websocket_write_message_server(
+          frame,
+          payload,
+          (_Bool)(variant & FIO___HTTP_BROADCAST_WS_TEXT),
+          rsv));
+  fio___websocket_deflate_free(comp_buf, comp_alloc);
+  return frame;
+}
+
 FIO_IFUNC void fio___http_websocket_subscribe_imp(fio_pubsub_msg_s *msg,
                                                   uint8_t is_text) {
   fio___http_connection_s *c = (fio___http_connection_s *)fio_io_udata(msg->io);
   if (!c)
     return;
+  /* client frames are masked (unique per frame), takeover needs a context */
+  if (c->is_client || (c->deflate_wr && !c->deflate_wr_reset) ||
+      !c->h || !fio_http_is_websocket(c->h))
+    goto write_message;
+  {
+    uint32_t variant = (is_text ? FIO___HTTP_BROADCAST_WS_TEXT : 0);
+    if (c->deflate_wr && msg->message.len >= FIO_HTTP_WEBSOCKET_DEFLATE_MIN)
+      variant |= FIO___HTTP_BROADCAST_WS_DEFLATE |
+                 FIO___HTTP_BROADCAST_BITS(c->deflate_wr_bits);
+    char *frame = fio___http_broadcast_frame(msg,
+                                             variant,
+                                             fio___websocket_broadcast_encode,
+                                             c);
+    if (!frame)
+      goto write_message;
+    fio_io_write2(c->io,
+                  .buf = frame,
+                  .len = fio_bstr_len(frame),
+                  .dealloc = (void (*)(void *))fio_bstr_free);
+    return;
+  }
+write_message:
   fio_http_websocket_write(c->h, msg->message.buf, msg->message.len, is_text);
 }
 
@@ -609,51 +721,17 @@ SFUNC int fio_http_websocket_write(fio_http_s *h,
   /* RFC 7692: compress with permessage-deflate if negotiated. */
   const void *send_buf = buf;
   size_t send_len = len;
-  char *comp_buf = NULL;
+  size_t comp_len = 0;
   size_t comp_alloc = 0;
-  if (c->deflate_wr && len >= FIO_HTTP_WEBSOCKET_DEFLATE_MIN) {
-    /* Output bound: input + 12.5% + 32B overhead. */
-    comp_alloc = len + (len >> 3) + 32;
-    comp_buf = (char *)FIO_MEM_REALLOC(NULL, 0, comp_alloc, 0);
-    if (comp_buf)
-      FIO_LEAK_COUNTER_ON_ALLOC(fio___websocket_deflate_buf);
-    if (comp_buf) {
-      size_t comp_len =
-          fio_deflate_push(c->deflate_wr, comp_buf, comp_alloc, buf, len, 1);
-      if (comp_len >= 4) {
-        /* RFC 7692 §7.2.1: strip trailing 00 00 FF FF sync marker. */
-        const uint8_t *tail = (const uint8_t *)comp_buf + comp_len - 4;
-        if (tail[0] == 0x00 && tail[1] == 0x00 && tail[2] == 0xFF &&
-            tail[3] == 0xFF) {
-          comp_len -= 4;
-        }
-        if (comp_len >= len) {
-          /* Negative gain: compression expanded the payload — send the
-           * original uncompressed (RSV1 stays clear) instead. */
-          FIO_LEAK_COUNTER_ON_FREE(fio___websocket_deflate_buf);
-          FIO_MEM_FREE(comp_buf, comp_alloc);
-          comp_buf = NULL;
-          comp_alloc = 0;
-        } else {
-          send_buf = comp_buf;
-          send_len = comp_len;
-          /* RSV1 (byte-0 bit 6 = 0x40) marks compressed; the write API
-           * takes the 3-bit rsv value shifted into 4..6, so RSV1 = 0x4
-           * (NOT 0x1 — that would set RSV3 and every RFC-compliant peer
-           * closes with protocol error 1002 on an unnegotiated RSV). */
-          rsv = FIO_WEBSOCKET_RSV1;
-        }
-      } else {
-        /* Compression failed — fall back to uncompressed. */
-        FIO_LEAK_COUNTER_ON_FREE(fio___websocket_deflate_buf);
-        FIO_MEM_FREE(comp_buf, comp_alloc);
-        comp_buf = NULL;
-        comp_alloc = 0;
-      }
-      /* Reset compressor if server_no_context_takeover. */
-      if (c->deflate_wr_reset)
-        fio_deflate_destroy(c->deflate_wr);
-    }
+  char *comp_buf = fio___websocket_deflate(c, buf, len, &comp_len, &comp_alloc);
+  if (comp_buf) {
+    send_buf = comp_buf;
+    send_len = comp_len;
+    /* RSV1 (byte-0 bit 6 = 0x40) marks compressed; the write API takes the
+     * 3-bit rsv value shifted into 4..6, so RSV1 = 0x4 (NOT 0x1 — that would
+     * set RSV3 and every RFC-compliant peer closes with protocol error 1002
+     * on an unnegotiated RSV). */
+    rsv = FIO_WEBSOCKET_RSV1;
   }
 
   const fio_buf_info_s msg =
@@ -666,10 +744,7 @@ SFUNC int fio_http_websocket_write(fio_http_s *h,
         c->is_client
             ? fio_websocket_write_message_client(tmp, msg, text_flag, 0, rsv)
             : fio_websocket_write_message_server(tmp, msg, text_flag, rsv);
-    if (comp_buf) {
-      FIO_LEAK_COUNTER_ON_FREE(fio___websocket_deflate_buf);
-      FIO_MEM_FREE(comp_buf, comp_alloc);
-    }
+    fio___websocket_deflate_free(comp_buf, comp_alloc);
     fio_io_write2(c->io, .buf = tmp, .len = wlen, .copy = 1);
     return 0;
   }
@@ -681,10 +756,7 @@ SFUNC int fio_http_websocket_write(fio_http_s *h,
       c->is_client
           ? fio_websocket_write_message_client(payload, msg, text_flag, 0, rsv)
           : fio_websocket_write_message_server(payload, msg, text_flag, rsv));
-  if (comp_buf) {
-    FIO_LEAK_COUNTER_ON_FREE(fio___websocket_deflate_buf);
-    FIO_MEM_FREE(comp_buf, comp_alloc);
-  }
+  fio___websocket_deflate_free(comp_buf, comp_alloc);
   fio_io_write2(c->io,
                 .buf = payload,
                 .len = fio_bstr_len(payload),
@@ -29,7 +29,8 @@ FIO_SFUNC void fio___http_on_select_h1(fio_io_s *io) {
             .protocol));
 }
 FIO_SFUNC void fio___http_on_select_h2(fio_io_s *io) {
-  FIO_LOG_ERROR("TLS ALPN HTTP/2 not supported for %p", io);
+  /* the ACCEPT protocol switches to HTTP/2 once the preface is received */
+  FIO_LOG_DDEBUG2("TLS ALPN HTTP/2 selected for %p", io);
   (void)io;
 }
 
@@ -73,7 +74,7 @@ SFUNC fio_http_listener_s *fio_http_listen FIO_NOOP(const char *url,
   fio_http_listener_s *listener = (fio_http_listener_s *)
       fio_io_listen(.url = url,
                     .protocol = &p->state[FIO___HTTP_PROTOCOL_ACCEPT].protocol,
-                    .tls = s.tls,
+                    .tls = p->settings.tls, /* with ALPN */
                     .on_start = fio___http_listen_on_start,
                     .on_stop = fio___http_listen_on_stop,
                     .queue_for_accept = p->settings.queue);
@@ -258,35 +259,6 @@ SFUNC fio_io_s *fio_http_websocket_connect FIO_NOOP(const char *url,
   return fio_http_connect FIO_NOOP(url, h, s);
 }
 
-/* *****************************************************************************
-HTTP/2 Protocol (disconnect, as HTTP/2 is unsupported)
-***************************************************************************** */
-
-// /** Called when an IO is attached to a protocol. */
-// void (*on_attach)(fio_io_s *io);
-// /** Called when a data is available. */
-// void (*on_data)(fio_io_s *io);
-// /** called once all pending `fio_io_write` calls are finished. */
-// void (*on_ready)(fio_io_s *io);
-// /** Called after the connection was closed, and pending tasks
-// completed.
-// */ void (*on_close)(void *udata);
-
-/* *****************************************************************************
-HTTP/2 Controller (TODO!)
-***************************************************************************** */
-
-// /** Called when an HTTP handle is freed. */
-// void (*on_destroyed)(fio_http_s *h, void *cdata);
-// /** Informs the controller that request / response headers must be
-// sent.
-// */ void (*send_headers)(fio_http_s *h);
-// /** called by the HTTP handle for each body chunk (or to finish a
-// response.
-// */ void (*write_body)(fio_http_s *h, fio_http_write_args_s args);
-// /** called once a request / response had finished */
-// void (*on_finish)(fio_http_s *h);
-
 /* *****************************************************************************
 Connection Lost
 ***************************************************************************** */
@@ -382,7 +354,11 @@ fio___http_protocol_get(fio___http_protocol_selector_e s, int is_client) {
     }
     return r;
   case FIO___HTTP_PROTOCOL_HTTP2:
-    r = (fio_io_protocol_s){.on_close = fio___http_on_close};
+    r = (fio_io_protocol_s){.on_attach = fio___http2_on_attach,
+                            .on_data = fio___http2_on_data,
+                            .on_ready = fio___http2_on_ready,
+                            .on_close = fio___http2_on_close,
+                            .on_shutdown = fio___http2_on_shutdown};
     return r;
   case FIO___HTTP_PROTOCOL_WS:
     r = (fio_io_protocol_s){
@@ -453,7 +429,10 @@ fio___http_controller_get(fio___http_protocol_selector_e s, int is_client) {
     return r;
   case FIO___HTTP_PROTOCOL_HTTP2:
     r = (fio_http_controller_s){
-        .on_destroyed = fio__http_controller_on_destroyed,
+        .on_destroyed = fio___http2_controller_on_destroyed,
+        .send_headers = fio___http2_controller_send_headers,
+        .write_body = fio___http2_controller_write_body,
+        .on_finish = fio___http2_controller_on_finish,
         .close_io = fio___http_default_close,
         .get_fd = fio___http_controller_get_fd,
     };
@@ -513,6 +492,8 @@ FIO_IFUNC fio___http_protocol_s *fio___http_protocol_init(
       (unsigned)s.timeout * 1000U;
   p->state[FIO___HTTP_PROTOCOL_HTTP1].protocol.timeout =
       (unsigned)s.timeout * 1000U;
+  p->state[FIO___HTTP_PROTOCOL_HTTP2].protocol.timeout =
+      (unsigned)s.timeout * 1000U;
   p->state[FIO___HTTP_PROTOCOL_NONE].protocol.timeout =
       (unsigned)s.timeout * 1000U;
   /* fill in TLS data */
@@ -521,9 +502,10 @@ FIO_IFUNC fio___http_protocol_s *fio___http_protocol_init(
     s.tls = fio_io_tls_from_url(s.tls, u);
     if (s.tls) {
       s.tls = fio_io_tls_dup(s.tls);
-      /* fio_io_tls_alpn_add(s.tls, "h2", fio___http_on_select_h2); // not yet
-       */
-      // fio_io_tls_alpn_add(s.tls, "http/1.1", fio___http_on_select_h1);
+      if (!is_client) { /* preference order: HTTP/2, then HTTP/1.1 */
+        fio_io_tls_alpn_add(s.tls, "h2", fio___http_on_select_h2);
+        fio_io_tls_alpn_add(s.tls, "http/1.1", fio___http_on_select_h1);
+      }
       fio_io_functions_s tmp_fn = fio_io_tls_default_functions(NULL);
       if (!s.tls_io_func)
         s.tls_io_func = &tmp_fn;
@@ -574,7 +556,7 @@ SFUNC fio_http_settings_s *fio_http_settings(fio_http_s *h) {
   fio___http_protocol_s *p =
       FIO_PTR_FROM_FIELD(fio___http_protocol_s, settings, c->settings);
   fio_str_info_s path = fio_http_opath(h);
-  r = fio___http_route_settings(&p->router, &path);
+  r = fio___http_route_settings(&p->router, &path, NULL);
   return r;
 }
 
@@ -65,6 +65,9 @@
 #if defined(FIO_HTTP1_PARSER)
 #include "004 http1 parser.h"
 #endif
+#if defined(FIO_HTTP2_PARSER)
+#include "004 http2 parser.h"
+#endif
 #ifdef FIO_JSON
 #include "004 json.h"
 #endif
@@ -108,6 +111,7 @@
 #if defined(FIO_POLL) && !defined(FIO___RECURSIVE_INCLUDE)
 #include "102 poll api.h"
 #include "102 poll epoll.h"
+#include "102 poll io_uring.h"
 #include "102 poll kqueue.h"
 #include "102 poll poll.h"
 #endif
@@ -256,6 +260,7 @@
 #include "432 http types.h"
 #include "434 http accept.h"
 #include "434 http1.h"
+#include "434 http2.h"
 #include "434 sse.h"
 #include "434 websocket.h"
 #include "438 http.h"
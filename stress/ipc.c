@@ -5,6 +5,11 @@ Covers the long-running multi-process IPC behavior from tests-old/ipc.c.
 This test starts the IO reactor with worker processes and exercises
 worker->master calls, broadcasts, RPC op-codes, and large message transfer.
 
+The tests run over the IPC socket and again over the shared memory rings
+(`fio_ipc_shm_set`, Linux only), with and without batching
+(`fio_ipc_batch_set`), followed by a round trip latency and throughput
+comparison of these transports.
+
 Guarded with #ifdef _WIN32 to log FIO_LOG_WARNING("SKIPPED") and return
 success on Windows, because the POSIX fork()-based worker model is not
 available there.
@@ -23,6 +28,14 @@ Configuration
 #define F_BCAST2_DELAY_MS 1500
 #define F_TIMEOUT_MS 4000
 
+#define F_SHM_CAPACITY (1UL << 20)
+#define F_BATCH_DELAY_US 1000
+#define F_PERF_ROUND_TRIPS 20000
+/* the socket deadlocks when both ends exceed FIO_IO_THROTTLE_LIMIT */
+#define F_PERF_BURST 8192
+#define F_PERF_MSG_LEN 64
+#define F_PERF_TIMEOUT_MS 30000
+
 /* *****************************************************************************
 Test State - Atomic Counters for Cross-Process Result Tracking
 ***************************************************************************** */
@@ -636,14 +649,30 @@ static int f_timeout(void *ignr_1, void *ignr_2) {
   return -1;
 }
 
+/* timers are scheduled from the reactor's last tick, which is only refreshed by
+ * `fio_io_start` - schedule them once the reactor started (not in between). */
+static void f_master_timers(void *ignr_) {
+  (void)ignr_;
+  fio_timer_free(fio_io_run_every(.fn = f_master_bcast_trigger,
+                                  .every = F_BCAST_DELAY_MS,
+                                  .repetitions = 1));
+  fio_timer_free(fio_io_run_every(.fn = f_master_bcast2_trigger,
+                                  .every = F_BCAST2_DELAY_MS,
+                                  .repetitions = 1));
+  fio_timer_free(fio_io_run_every(.fn = f_timeout,
+                                  .every = F_TIMEOUT_MS,
+                                  .repetitions = 1));
+}
+
 /* *****************************************************************************
 Run and Verify
 ***************************************************************************** */
 
-static void fio___test_ipc_stress_run(void) {
+static void fio___test_ipc_stress_run(const char *transport) {
   fprintf(stderr,
-          "* Testing IPC stress (multi-process, %d workers).\n",
-          F_TEST_WORKERS);
+          "* Testing IPC stress (multi-process, %d workers, %s).\n",
+          F_TEST_WORKERS,
+          transport);
 
   f_call_master_received = 0;
   f_udata_master_received = 0;
@@ -689,18 +718,12 @@ static void fio___test_ipc_stress_run(void) {
                           .udata = NULL);
 
   fio_state_callback_add(FIO_CALL_ON_START, f_worker_start, NULL);
-
-  fio_io_run_every(.fn = f_master_bcast_trigger,
-                   .every = F_BCAST_DELAY_MS,
-                   .repetitions = 1);
-  fio_io_run_every(.fn = f_master_bcast2_trigger,
-                   .every = F_BCAST2_DELAY_MS,
-                   .repetitions = 1);
-  fio_io_run_every(.fn = f_timeout, .every = F_TIMEOUT_MS, .repetitions = 1);
+  fio_state_callback_add(FIO_CALL_PRE_START, f_master_timers, NULL);
 
   fio_io_start(F_TEST_WORKERS);
 
   fio_state_callback_remove(FIO_CALL_ON_START, f_worker_start, NULL);
+  fio_state_callback_remove(FIO_CALL_PRE_START, f_master_timers, NULL);
   fio_ipc_opcode_register(.opcode = F_WRPC_OPCODE, .call = NULL);
   fio_ipc_opcode_register(.opcode = F_WRPCMB_OPCODE, .call = NULL);
 
@@ -857,6 +880,112 @@ static void fio___test_ipc_stress_run(void) {
   fprintf(stderr, "* IPC stress tests passed.\n");
 }
 
+/* *****************************************************************************
+Transport Performance - round trips and bursts (one worker)
+***************************************************************************** */
+
+static struct {
+  uint64_t start;
+  size_t count;
+  uint64_t round_trips_us;
+} f_perf_worker;
+
+static struct {
+  uint64_t round_trips_us;
+  uint64_t burst_us;
+  size_t reports;
+} f_perf_result;
+
+static void f_perf_echo(fio_ipc_s *msg) {
+  fio_ipc_reply(msg,
+                .data = FIO_IPC_DATA(FIO_BUF_INFO2(msg->data, msg->len)),
+                .done = 1);
+}
+
+static void f_perf_report(fio_ipc_s *msg) {
+  if (msg->len == 16) {
+    f_perf_result.round_trips_us = fio_buf2u64u(msg->data);
+    f_perf_result.burst_us = fio_buf2u64u(msg->data + 8);
+    ++f_perf_result.reports;
+  }
+  fio_io_stop();
+}
+
+static void f_perf_burst_done(fio_ipc_s *msg) {
+  char report[16];
+  if (++f_perf_worker.count != F_PERF_BURST)
+    return;
+  fio_u2buf64u(report, f_perf_worker.round_trips_us);
+  fio_u2buf64u(report + 8, (uint64_t)fio_time_micro() - f_perf_worker.start);
+  fio_ipc_call(.call = f_perf_report,
+               .data = FIO_IPC_DATA(FIO_BUF_INFO2(report, sizeof(report))));
+  (void)msg;
+}
+
+static void f_perf_round_trip_done(fio_ipc_s *msg) {
+  char payload[F_PERF_MSG_LEN] = {0};
+  if (msg->len != F_PERF_MSG_LEN)
+    return;
+  if (++f_perf_worker.count < F_PERF_ROUND_TRIPS) {
+    fio_ipc_call(.call = f_perf_echo,
+                 .on_done = f_perf_round_trip_done,
+                 .data = FIO_IPC_DATA(FIO_BUF_INFO2(payload, sizeof(payload))));
+    return;
+  }
+  f_perf_worker.round_trips_us =
+      (uint64_t)fio_time_micro() - f_perf_worker.start;
+  f_perf_worker.count = 0;
+  f_perf_worker.start = (uint64_t)fio_time_micro();
+  for (size_t i = 0; i < F_PERF_BURST; ++i)
+    fio_ipc_call(.call = f_perf_echo,
+                 .on_done = f_perf_burst_done,
+                 .data = FIO_IPC_DATA(FIO_BUF_INFO2(payload, sizeof(payload))));
+}
+
+/* runs on the worker, sent by the master once the transport is established */
+static void f_perf_start(fio_ipc_s *msg) {
+  char payload[F_PERF_MSG_LEN] = {0};
+  f_perf_worker.count = 0;
+  f_perf_worker.start = (uint64_t)fio_time_micro();
+  fio_ipc_call(.call = f_perf_echo,
+               .on_done = f_perf_round_trip_done,
+               .data = FIO_IPC_DATA(FIO_BUF_INFO2(payload, sizeof(payload))));
+  (void)msg;
+}
+
+static int f_perf_trigger(void *ignr_1, void *ignr_2) {
+  fio_ipc_local(.call = f_perf_start, .exclude = FIO_IPC_EXCLUDE_SELF);
+  return -1;
+  (void)ignr_1, (void)ignr_2;
+}
+
+static void f_perf_timers(void *ignr_) {
+  (void)ignr_;
+  fio_timer_free(fio_io_run_every(.fn = f_perf_trigger,
+                                  .every = 250,
+                                  .repetitions = 1));
+  fio_timer_free(fio_io_run_every(.fn = f_timeout,
+                                  .every = F_PERF_TIMEOUT_MS,
+                                  .repetitions = 1));
+}
+
+static void fio___test_ipc_perf_run(const char *transport) {
+  f_perf_result.reports = 0;
+  fio_state_callback_add(FIO_CALL_PRE_START, f_perf_timers, NULL);
+  fio_io_start(1);
+  fio_state_callback_remove(FIO_CALL_PRE_START, f_perf_timers, NULL);
+  FIO_ASSERT(f_perf_result.reports == 1,
+             "IPC performance run (%s) didn't complete",
+             transport);
+  f_perf_result.round_trips_us += !f_perf_result.round_trips_us;
+  f_perf_result.burst_us += !f_perf_result.burst_us;
+  fprintf(stderr,
+          "  - %-22s round trip: %7.2f us | burst: %10.2f msgs/sec\n",
+          transport,
+          (double)f_perf_result.round_trips_us / F_PERF_ROUND_TRIPS,
+          (double)F_PERF_BURST * 1000000.0 / f_perf_result.burst_us);
+}
+
 /* *****************************************************************************
 Main entry point
 ***************************************************************************** */
@@ -871,7 +1000,33 @@ int main(void) {
     FIO_LOG_LEVEL = FIO_LOG_LEVEL_WARNING;
 
   fprintf(stderr, "=== IPC stress tests ===\n");
-  fio___test_ipc_stress_run();
+  fio___test_ipc_stress_run("socket");
+  int shm = !fio_ipc_shm_set(F_SHM_CAPACITY);
+  if (shm)
+    fio___test_ipc_stress_run("shared memory");
+  fio_ipc_shm_set(0);
+  fio_ipc_batch_set(F_BATCH_DELAY_US);
+  fio___test_ipc_stress_run("socket, batched");
+  if (shm) {
+    fio_ipc_shm_set(F_SHM_CAPACITY);
+    fio___test_ipc_stress_run("shared memory, batched");
+    fio_ipc_shm_set(0);
+  }
+  fio_ipc_batch_set(0);
+
+  fprintf(stderr,
+          "* IPC transport performance (1 worker, %d byte messages):\n",
+          F_PERF_MSG_LEN);
+  for (int batch = 0; batch < 2; ++batch) {
+    fio_ipc_batch_set(batch ? F_BATCH_DELAY_US : 0);
+    fio___test_ipc_perf_run(batch ? "socket, batched" : "socket");
+    if (!shm)
+      continue;
+    fio_ipc_shm_set(F_SHM_CAPACITY);
+    fio___test_ipc_perf_run(batch ? "shared memory, batched" : "shared memory");
+    fio_ipc_shm_set(0);
+  }
+  fio_ipc_batch_set(0);
   fprintf(stderr, "=== IPC stress tests passed ===\n");
   return 0;
 #endif
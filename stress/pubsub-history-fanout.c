@@ -5,6 +5,10 @@ Multi-process fanout behavior moved from tests-old/pubsub-history2.c.
 Starts worker processes and validates that every process receives every
 message published by every process, including replay from history.
 
+Before forking, fills the built-in history cache well beyond its size limit
+and verifies that push throughput stays flat once the cache starts evicting
+(and that `replay_since` still finds its starting point).
+
 Guarded with #ifdef _WIN32 to log FIO_LOG_WARNING("SKIPPED") and return
 success on Windows, because the POSIX fork()-based worker model is not
 available there.
@@ -25,6 +29,11 @@ Configuration
 #define PSHF_SUBSCRIBE_OFFSET_MILLI 20
 #define PSHF_LISTENERS              (PSHF_WORKERS + 1)
 
+#define PSHF_FILL_LIMIT     (32ULL << 20) /* cache limit for the fill test */
+#define PSHF_FILL_CHANNELS  64
+#define PSHF_FILL_ROUNDS    16
+#define PSHF_FILL_PER_ROUND (1UL << 16)
+
 #ifdef DEBUG
 #define PSHF_CLEANUP_MILLI 5000
 #else
@@ -145,9 +154,9 @@ static int pshf_publish_message(void *ignr_, void *ignr__) {
                .data = FIO_IPC_DATA(FIO_BUF_INFO2((char *)&msg, sizeof(msg))));
   if (numerator == PSHF_MESSAGES_PER_PUBLISHER) {
     if (fio_io_is_master())
-      fio_io_run_every(.fn = pshf_stop_io_timeout,
-                       .every = PSHF_CLEANUP_MILLI,
-                       .repetitions = 0);
+      fio_timer_free(fio_io_run_every(.fn = pshf_stop_io_timeout,
+                                      .every = PSHF_CLEANUP_MILLI,
+                                      .repetitions = 0));
     return -1;
   }
   return 0;
@@ -159,9 +168,9 @@ static int pshf_subscribe_timer_setup(void *ignr_, void *ignr__) {
   if (!offset)
     pshf_subscribe(NULL, NULL);
   else
-    fio_io_run_every(.fn = pshf_subscribe,
-                     .every = offset,
-                     .repetitions = 0);
+    fio_timer_free(fio_io_run_every(.fn = pshf_subscribe,
+                                    .every = offset,
+                                    .repetitions = 0));
   return -1;
   (void)ignr_;
   (void)ignr__;
@@ -186,6 +195,129 @@ static void pshf_history_replay_on_message(fio_pubsub_msg_s *msg, void *udata) {
   (void)udata;
 }
 
+/* *****************************************************************************
+Cache Fill Throughput
+***************************************************************************** */
+
+static struct {
+  uint64_t since;
+  uint64_t last;
+  size_t total;
+  size_t since_count;
+  size_t unordered;
+} pshf_fill_replay;
+
+static void pshf_fill_on_replay(fio_pubsub_msg_s *msg, void *udata) {
+  pshf_fill_replay.unordered += (msg->timestamp < pshf_fill_replay.last);
+  pshf_fill_replay.last = msg->timestamp;
+  pshf_fill_replay.since_count += (msg->timestamp >= pshf_fill_replay.since);
+  ++pshf_fill_replay.total;
+  (void)udata;
+}
+
+static void pshf_fill_replay_run(fio_buf_info_s channel, uint64_t since) {
+  fio_pubsub_history_s const *cache = fio_pubsub_history_cache(0);
+  pshf_fill_replay.last = 0;
+  pshf_fill_replay.total = pshf_fill_replay.since_count = 0;
+  cache->replay(cache, channel, 0, since, pshf_fill_on_replay, NULL, NULL);
+}
+
+static int pshf_fill_and_verify(void) {
+  fio_pubsub_history_s const *cache = fio_pubsub_history_cache(PSHF_FILL_LIMIT);
+  const uint64_t span = (PSHF_FILL_ROUNDS * PSHF_FILL_PER_ROUND) >> 4;
+  const uint64_t now = (uint64_t)fio_io_last_tick();
+  const uint64_t base = (now > span + 1) ? (now - span - 1) : 1;
+  double rates[PSHF_FILL_ROUNDS];
+  double fastest = 0, slowest = 0;
+  char chname[32];
+  size_t n = 0;
+  int r = 0;
+
+  fprintf(stderr,
+          "\t* Filling history cache (%zu MB limit, %zu channels):\n",
+          (size_t)(PSHF_FILL_LIMIT >> 20),
+          (size_t)PSHF_FILL_CHANNELS);
+  for (size_t round = 0; round < PSHF_FILL_ROUNDS; ++round) {
+    uint64_t start = fio_time_micro();
+    for (size_t i = 0; i < PSHF_FILL_PER_ROUND; ++i, ++n) {
+      fio_buf_info_s channel = FIO_BUF_INFO2(
+          chname,
+          (size_t)snprintf(chname,
+                           sizeof(chname),
+                           "pshf-fill-%02zu",
+                           (n % PSHF_FILL_CHANNELS)));
+      uint32_t header[2] = {(uint32_t)channel.len, (uint32_t)sizeof(n)};
+      fio_ipc_s *ipc =
+          fio_ipc_new(.timestamp = base + (n >> 4),
+                      .id = n + 1,
+                      .data = FIO_IPC_DATA(
+                          FIO_BUF_INFO2((char *)header, sizeof(header)),
+                          channel,
+                          FIO_BUF_INFO2((char *)"\0", 1),
+                          FIO_BUF_INFO2((char *)&n, sizeof(n)),
+                          FIO_BUF_INFO2((char *)"\0", 1)));
+      FIO_ASSERT_ALLOC(ipc);
+      fio_pubsub_msg_s msg = fio_pubsub_ipc2msg(ipc);
+      r |= cache->push(cache, &msg);
+      fio_ipc_free(ipc);
+    }
+    uint64_t end = fio_time_micro();
+    rates[round] =
+        (double)PSHF_FILL_PER_ROUND / (double)(end - start + !(end - start));
+    if (!round || rates[round] > fastest)
+      fastest = rates[round];
+    if (!round || rates[round] < slowest)
+      slowest = rates[round];
+    fprintf(stderr,
+            "\t\tround %2zu: %8.2f M pushes/sec (%zu messages pushed)\n",
+            round,
+            rates[round],
+            n);
+  }
+  if (r)
+    FIO_LOG_ERROR("history cache push failed during fill");
+  if (slowest * 8 < fastest) {
+    r |= 1;
+    FIO_LOG_ERROR("history cache push throughput isn't flat "
+                  "(slowest %.2f vs. fastest %.2f M pushes/sec)",
+                  slowest,
+                  fastest);
+  }
+
+  /* replay_since should start exactly at the first message >= since */
+  for (size_t c = 0; c < PSHF_FILL_CHANNELS; c += 7) {
+    fio_buf_info_s channel = FIO_BUF_INFO2(
+        chname,
+        (size_t)snprintf(chname, sizeof(chname), "pshf-fill-%02zu", c));
+    uint64_t oldest = cache->oldest(cache, channel, 0);
+    if (oldest == UINT64_MAX) {
+      r |= 1;
+      FIO_LOG_ERROR("history cache lost channel %s", chname);
+      continue;
+    }
+    pshf_fill_replay.since = oldest + ((base + (n >> 4) - oldest) >> 1);
+    pshf_fill_replay_run(channel, oldest);
+    size_t expected = pshf_fill_replay.since_count;
+    size_t unordered = pshf_fill_replay.unordered;
+    pshf_fill_replay_run(channel, pshf_fill_replay.since);
+    if (!expected || expected != pshf_fill_replay.total ||
+        pshf_fill_replay.total != pshf_fill_replay.since_count || unordered ||
+        pshf_fill_replay.unordered) {
+      r |= 1;
+      FIO_LOG_ERROR("history replay error for %s: expected %zu, got %zu "
+                    "(%zu out of order)",
+                    chname,
+                    expected,
+                    pshf_fill_replay.total,
+                    unordered + pshf_fill_replay.unordered);
+    }
+  }
+
+  cache->detached(cache); /* release the cache's memory before forking */
+  fio_pubsub_history_cache(FIO_PUBSUB_HISTORY_DEFAULT_CACHE_SIZE_LIMIT);
+  return r;
+}
+
 /* *****************************************************************************
 Run and Verify
 ***************************************************************************** */
@@ -198,23 +330,24 @@ static int pshf_run_and_verify(void) {
   size_t sent_count = 0;
   size_t received_count = 0;
 
-  fio_io_run_every(.fn = pshf_stop_io_timeout,
-                   .every = (PSHF_CLEANUP_MILLI + 7000),
-                   .repetitions = 0);
+  fio_timer_free(fio_io_run_every(.fn = pshf_stop_io_timeout,
+                                  .every = (PSHF_CLEANUP_MILLI + 7000),
+                                  .repetitions = 0));
 
   fio_pubsub_history_attach(fio_pubsub_history_cache(0), 100);
 
   fio_state_callback_add(FIO_CALL_IN_MASTER, pshf_add_worker_id, NULL);
 
-  fio_io_run_every(.fn = pshf_subscribe_timer_setup,
-                   .every = PSHF_START_OFFSET_MILLI,
-                   .repetitions = 0);
+  fio_timer_free(fio_io_run_every(.fn = pshf_subscribe_timer_setup,
+                                  .every = PSHF_START_OFFSET_MILLI,
+                                  .repetitions = 0));
 
-  fio_io_run_every(.fn = pshf_publish_message,
-                   .every = (PSHF_SUBSCRIBE_OFFSET_MILLI / 2),
-                   .repetitions = PSHF_MESSAGES_PER_PUBLISHER,
-                   .start_at = fio_io_last_tick() + PSHF_START_OFFSET_MILLI +
-                               (PSHF_SUBSCRIBE_OFFSET_MILLI / PSHF_LISTENERS));
+  fio_timer_free(
+      fio_io_run_every(.fn = pshf_publish_message,
+                       .every = (PSHF_SUBSCRIBE_OFFSET_MILLI / 2),
+                       .repetitions = PSHF_MESSAGES_PER_PUBLISHER,
+                       .start_at = fio_io_last_tick() + PSHF_START_OFFSET_MILLI +
+                                   (PSHF_SUBSCRIBE_OFFSET_MILLI / PSHF_LISTENERS)));
 
   fio_io_start(PSHF_WORKERS);
 
@@ -315,7 +448,8 @@ int main(void) {
 
   fprintf(stderr, "=== Pub/Sub history fanout stress tests ===\n");
 
-  int r = pshf_run_and_verify();
+  int r = pshf_fill_and_verify();
+  r |= pshf_run_and_verify();
 
   if (r) {
     fprintf(stderr, "=== Pub/Sub history fanout stress tests FAILED ===\n");
@@ -10,7 +10,8 @@ The workload covers strings, binary/large values, multi-key commands,
 counters, bit operations, lists, hashes, sets, sorted sets, expiration,
 transactions, scripting, streams, scanning, server introspection, command
 queue pressure, exact subscriptions, pattern subscriptions, binary Pub/Sub
-payloads, large push frames, and unsubscribe behavior.
+payloads, large push frames, and unsubscribe behavior. A passing run ends by
+timing lock-step engine commands against the pipelined command client.
 ***************************************************************************** */
 #define FIO_LOG
 #define FIO_REDIS
@@ -839,9 +840,9 @@ static void redis_stress_on_publish_barrier(fio_pubsub_engine_s *engine,
   (void)engine;
   (void)udata;
   redis_stress_reply_is_pong(reply, "publish barrier");
-  fio_io_run_every(.fn = redis_stress_wait_for_messages,
-                   .every = 10,
-                   .repetitions = -1);
+  fio_timer_free(fio_io_run_every(.fn = redis_stress_wait_for_messages,
+                                  .every = 10,
+                                  .repetitions = -1));
 }
 
 static void redis_stress_on_unsubscribe_barrier(fio_pubsub_engine_s *engine,
@@ -911,9 +912,9 @@ static void redis_stress_on_post_unsubscribe_barrier(
   (void)engine;
   (void)udata;
   redis_stress_reply_is_pong(reply, "post-unsubscribe publish barrier");
-  fio_io_run_every(.fn = redis_stress_finish_post_unsubscribe,
-                   .every = 100,
-                   .repetitions = 1);
+  fio_timer_free(fio_io_run_every(.fn = redis_stress_finish_post_unsubscribe,
+                                  .every = 100,
+                                  .repetitions = 1));
 }
 
 /* ****************************************************************************
@@ -981,15 +982,165 @@ static void redis_stress_on_start(void *udata) {
                                          FIO_STRLEN(redis_stress.pattern_glob)),
                        .on_message = redis_stress_on_pattern_message,
                        .is_pattern = 1);
-  fio_io_run_every(.fn = redis_stress_poll_connection,
-                   .every = 10,
-                   .repetitions = -1);
-  fio_io_run_every(.fn = redis_stress_connect_timeout,
-                   .every = REDIS_STRESS_CONNECT_TIMEOUT_MS,
-                   .repetitions = 1);
-  fio_io_run_every(.fn = redis_stress_overall_timeout,
-                   .every = redis_stress.overall_timeout_ms,
-                   .repetitions = 1);
+  fio_timer_free(fio_io_run_every(.fn = redis_stress_poll_connection,
+                                  .every = 10,
+                                  .repetitions = -1));
+  fio_timer_free(fio_io_run_every(.fn = redis_stress_connect_timeout,
+                                  .every = REDIS_STRESS_CONNECT_TIMEOUT_MS,
+                                  .repetitions = 1));
+  fio_timer_free(fio_io_run_every(.fn = redis_stress_overall_timeout,
+                                  .every = redis_stress.overall_timeout_ms,
+                                  .repetitions = 1));
+}
+
+/* ****************************************************************************
+Throughput - lock-step engine commands vs. the pipelined command client
+***************************************************************************** */
+
+#define REDIS_STRESS_TP_COMMANDS    20000U
+#define REDIS_STRESS_TP_CONNECTIONS 4U
+
+static struct {
+  fio_pubsub_engine_s *engine;
+  fio_redis_client_s *client;
+  FIOBJ incr;
+  size_t done;
+  size_t errors;
+  int64_t max_value;
+  uint64_t start;
+  uint64_t engine_ms;
+  uint64_t client_ms;
+  int finished;
+  char key[96];
+} redis_stress_tp = {0};
+
+static void redis_stress_tp_count(FIOBJ reply) {
+  if (FIOBJ_TYPE(reply) != FIOBJ_T_NUMBER) {
+    ++redis_stress_tp.errors;
+    return;
+  }
+  int64_t n = fiobj2i(reply);
+  if (n > redis_stress_tp.max_value)
+    redis_stress_tp.max_value = n;
+}
+
+static void redis_stress_tp_on_del(fio_redis_client_s *c,
+                                   FIOBJ reply,
+                                   void *udata) {
+  (void)reply, (void)udata;
+  fio_redis_client_free(c);
+  redis_stress_tp.client = NULL;
+  redis_stress_tp.finished = 1;
+  fio_io_stop();
+}
+
+static void redis_stress_tp_on_client_reply(fio_redis_client_s *c,
+                                            FIOBJ reply,
+                                            void *udata) {
+  (void)udata;
+  redis_stress_tp_count(reply);
+  if (++redis_stress_tp.done != REDIS_STRESS_TP_COMMANDS * 2)
+    return;
+  redis_stress_tp.client_ms = fio_time_milli() - redis_stress_tp.start;
+  FIOBJ del = fiobj_array_new();
+  fiobj_array_push(del, fiobj_str_new_cstr("DEL", 3));
+  fiobj_array_push(del,
+                   fiobj_str_new_cstr(redis_stress_tp.key,
+                                      FIO_STRLEN(redis_stress_tp.key)));
+  fio_redis_client_send(c, .cmd = del, .on_reply = redis_stress_tp_on_del);
+  fiobj_free(del);
+}
+
+static void redis_stress_tp_on_engine_reply(fio_pubsub_engine_s *e,
+                                            FIOBJ reply,
+                                            void *udata) {
+  (void)e, (void)udata;
+  redis_stress_tp_count(reply);
+  if (++redis_stress_tp.done != REDIS_STRESS_TP_COMMANDS)
+    return;
+  redis_stress_tp.engine_ms = fio_time_milli() - redis_stress_tp.start;
+  redis_stress_tp.start = fio_time_milli();
+  for (size_t i = 0; i < REDIS_STRESS_TP_COMMANDS; ++i)
+    fio_redis_client_send(redis_stress_tp.client,
+                          .cmd = redis_stress_tp.incr,
+                          .on_reply = redis_stress_tp_on_client_reply);
+}
+
+static int redis_stress_tp_poll(void *u1, void *u2) {
+  (void)u1, (void)u2;
+  if (fio_redis_state(redis_stress_tp.engine) != FIO_REDIS_STATE_CONNECTED)
+    return 0;
+  redis_stress_tp.start = fio_time_milli();
+  for (size_t i = 0; i < REDIS_STRESS_TP_COMMANDS; ++i)
+    fio_redis_send(redis_stress_tp.engine,
+                   redis_stress_tp.incr,
+                   redis_stress_tp_on_engine_reply,
+                   NULL);
+  return -1;
+}
+
+static int redis_stress_tp_timeout(void *u1, void *u2) {
+  (void)u1, (void)u2;
+  if (!redis_stress_tp.finished) {
+    REDIS_STRESS_FAIL("Redis throughput run timed out (%zu replies)",
+                      redis_stress_tp.done);
+    fio_io_stop();
+  }
+  return -1;
+}
+
+static void redis_stress_tp_on_start(void *udata) {
+  (void)udata;
+  fio_timer_free(fio_io_run_every(.fn = redis_stress_tp_poll,
+                                  .every = 10,
+                                  .repetitions = -1));
+  fio_timer_free(fio_io_run_every(.fn = redis_stress_tp_timeout,
+                                  .every = 60000,
+                                  .repetitions = 1));
+}
+
+/** Compares lock-step `fio_redis_send` with the pipelined, pooled client. */
+static void redis_stress_throughput(void) {
+  snprintf(redis_stress_tp.key,
+           sizeof(redis_stress_tp.key),
+           "%s:throughput",
+           redis_stress.prefix);
+  redis_stress_tp.incr = fiobj_array_new();
+  fiobj_array_push(redis_stress_tp.incr, fiobj_str_new_cstr("INCR", 4));
+  fiobj_array_push(redis_stress_tp.incr,
+                   fiobj_str_new_cstr(redis_stress_tp.key,
+                                      FIO_STRLEN(redis_stress_tp.key)));
+  redis_stress_tp.engine = fio_redis_new(.url = NULL);
+  redis_stress_tp.client =
+      fio_redis_client_new(.url = NULL,
+                           .connections = REDIS_STRESS_TP_CONNECTIONS);
+  FIO_ASSERT(redis_stress_tp.engine && redis_stress_tp.client,
+             "Redis throughput setup failed");
+
+  fio_state_callback_add(FIO_CALL_ON_START, redis_stress_tp_on_start, NULL);
+  fio_io_start(0);
+  fio_state_callback_remove(FIO_CALL_ON_START, redis_stress_tp_on_start, NULL);
+
+  fio_redis_free(redis_stress_tp.engine);
+  fio_redis_client_free(redis_stress_tp.client); /* NULL once finished */
+  fiobj_free(redis_stress_tp.incr);
+  if (redis_stress_tp.errors ||
+      redis_stress_tp.max_value != (int64_t)REDIS_STRESS_TP_COMMANDS * 2)
+    REDIS_STRESS_FAIL("Redis throughput replies: %zu errors, INCR reached "
+                      "%lld (expected %u)",
+                      redis_stress_tp.errors,
+                      (long long)redis_stress_tp.max_value,
+                      REDIS_STRESS_TP_COMMANDS * 2);
+  if (!redis_stress_tp.finished)
+    return;
+  fprintf(stderr,
+          "\tlock-step engine:    %u INCR in %llu ms\n"
+          "\tpipelined client(%u): %u INCR in %llu ms\n",
+          REDIS_STRESS_TP_COMMANDS,
+          (unsigned long long)redis_stress_tp.engine_ms,
+          REDIS_STRESS_TP_CONNECTIONS,
+          REDIS_STRESS_TP_COMMANDS,
+          (unsigned long long)redis_stress_tp.client_ms);
 }
 
 /* ****************************************************************************
@@ -1115,6 +1266,9 @@ int main(void) {
   fio_redis_free(redis_stress.engine);
   redis_stress.engine = NULL;
 
+  if (redis_stress.phase == REDIS_STRESS_DONE && !redis_stress.failures)
+    redis_stress_throughput();
+
   int result = redis_stress.failures ? 1 : 0;
   if (redis_stress.phase == REDIS_STRESS_SKIPPED) {
     fprintf(stderr, "=== Redis stress test SKIPPED ===\n");
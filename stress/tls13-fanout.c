@@ -0,0 +1,220 @@
+/* *****************************************************************************
+Stress - TLS 1.3 Fan-Out Encryption (405 tls13.h)
+
+Starts an embedded TLS 1.3 server and many embedded TLS 1.3 clients in the
+same process. Once a client's handshake completes, the server broadcasts a
+series of messages to it, and the client verifies every byte, in order.
+
+The run is repeated with records encrypted on the IO thread and with records
+batched and encrypted by worker threads (`fio_tls13_io_async`), validating
+record ordering / sequence numbers and reporting the time each mode took.
+***************************************************************************** */
+#include "tests/test-helpers.h"
+
+#define FIO_SHA2
+#define FIO_HKDF
+#define FIO_AES
+#define FIO_CHACHA
+#define FIO_ED25519
+#define FIO_P256
+#define FIO_RSA
+#define FIO_X509
+#define FIO_IO
+#define FIO_TLS13
+#include FIO_INCLUDE_FILE
+
+/* *****************************************************************************
+Configuration
+***************************************************************************** */
+
+#define TLS13_FANOUT_URL      "tcp://127.0.0.1:29743"
+#define TLS13_FANOUT_CLIENTS  64
+#define TLS13_FANOUT_MSG_LEN  1024
+#define TLS13_FANOUT_MESSAGES 512
+#define TLS13_FANOUT_THREADS  4
+#define TLS13_FANOUT_TOTAL    (TLS13_FANOUT_MSG_LEN * TLS13_FANOUT_MESSAGES)
+
+/* *****************************************************************************
+State
+***************************************************************************** */
+
+static uint8_t tls13_fanout_payload[TLS13_FANOUT_TOTAL];
+
+static struct {
+  size_t done;
+  size_t errors;
+  int timed_out;
+} tls13_fanout_state;
+
+typedef struct {
+  size_t received;
+} tls13_fanout_client_s;
+
+/* *****************************************************************************
+Server - broadcasts once the client's handshake completed (client says "go")
+***************************************************************************** */
+
+static void tls13_fanout_server_on_data(fio_io_s *io) {
+  char buf[64];
+  size_t r = fio_io_read(io, buf, sizeof(buf));
+  if (!r || fio_io_udata(io))
+    return;
+  fio_io_udata_set(io, (void *)(uintptr_t)1);
+  for (size_t i = 0; i < TLS13_FANOUT_MESSAGES; ++i)
+    fio_io_write2(io,
+                  .buf = tls13_fanout_payload + (i * TLS13_FANOUT_MSG_LEN),
+                  .len = TLS13_FANOUT_MSG_LEN);
+}
+
+static fio_io_protocol_s tls13_fanout_server_protocol = {
+    .on_data = tls13_fanout_server_on_data,
+    .on_timeout = fio_io_touch,
+};
+
+/* *****************************************************************************
+Client - verifies the data stream
+***************************************************************************** */
+
+static void tls13_fanout_client_on_attach(fio_io_s *io) {
+  fio_io_write(io, "go", 2);
+}
+
+static void tls13_fanout_client_on_data(fio_io_s *io) {
+  tls13_fanout_client_s *c = (tls13_fanout_client_s *)fio_io_udata(io);
+  uint8_t buf[16384];
+  size_t r;
+  while ((r = fio_io_read(io, buf, sizeof(buf)))) {
+    if (c->received + r > TLS13_FANOUT_TOTAL ||
+        FIO_MEMCMP(buf, tls13_fanout_payload + c->received, r)) {
+      FIO_LOG_ERROR("TLS 1.3 fan-out: data mismatch at offset %zu",
+                    c->received);
+      ++tls13_fanout_state.errors;
+      fio_io_close(io);
+      return;
+    }
+    c->received += r;
+  }
+  if (c->received == TLS13_FANOUT_TOTAL) {
+    c->received = TLS13_FANOUT_TOTAL + 1; /* count once */
+    if (++tls13_fanout_state.done == TLS13_FANOUT_CLIENTS)
+      fio_io_stop();
+  }
+}
+
+static void tls13_fanout_client_on_close(void *buffer, void *udata) {
+  FIO_MEM_FREE(udata, sizeof(tls13_fanout_client_s));
+  (void)buffer;
+}
+
+static void tls13_fanout_client_on_failed(fio_io_protocol_s *pr, void *udata) {
+  ++tls13_fanout_state.errors;
+  FIO_MEM_FREE(udata, sizeof(tls13_fanout_client_s));
+  (void)pr;
+}
+
+static fio_io_protocol_s tls13_fanout_client_protocol = {
+    .on_attach = tls13_fanout_client_on_attach,
+    .on_data = tls13_fanout_client_on_data,
+    .on_close = tls13_fanout_client_on_close,
+    .on_timeout = fio_io_touch,
+};
+
+/* *****************************************************************************
+Runner
+***************************************************************************** */
+
+static void tls13_fanout_connect(void *tls_) {
+  for (size_t i = 0; i < TLS13_FANOUT_CLIENTS; ++i) {
+    tls13_fanout_client_s *c =
+        (tls13_fanout_client_s *)FIO_MEM_REALLOC(NULL, 0, sizeof(*c), 0);
+    FIO_ASSERT_ALLOC(c);
+    c->received = 0;
+    fio_io_connect(TLS13_FANOUT_URL,
+                   .protocol = &tls13_fanout_client_protocol,
+                   .on_failed = tls13_fanout_client_on_failed,
+                   .udata = c,
+                   .tls = (fio_io_tls_s *)tls_);
+  }
+}
+
+static int tls13_fanout_watchdog(void *ignr1_, void *ignr2_) {
+  tls13_fanout_state.timed_out = 1;
+  fio_io_stop();
+  return -1;
+  (void)ignr1_, (void)ignr2_;
+}
+
+static int tls13_fanout_run(const char *name, uint32_t threads) {
+  fio_io_functions_s funcs = fio_tls13_io_functions();
+  tls13_fanout_server_protocol.io_functions = funcs;
+  tls13_fanout_client_protocol.io_functions = funcs;
+  tls13_fanout_state.done = 0;
+  tls13_fanout_state.errors = 0;
+  tls13_fanout_state.timed_out = 0;
+  fio_tls13_io_async(threads);
+
+  fio_io_tls_s *server_tls = fio_io_tls_new();
+  fio_io_tls_s *client_tls = fio_io_tls_new();
+  FIO_ASSERT_ALLOC(server_tls && client_tls);
+  fio_io_tls_cert_add(server_tls, "localhost", NULL, NULL, NULL);
+  fio_io_listener_s *l = fio_io_listen(.url = TLS13_FANOUT_URL,
+                                       .protocol = &tls13_fanout_server_protocol,
+                                       .tls = server_tls,
+                                       .hide_from_log = 1);
+  fio_io_tls_free(server_tls);
+  FIO_ASSERT(l, "fio_io_listen failed for %s", TLS13_FANOUT_URL);
+  fio_state_callback_add(FIO_CALL_ON_START, tls13_fanout_connect, client_tls);
+  fio_timer_free(fio_io_run_every(.fn = tls13_fanout_watchdog,
+                                  .every = 30000,
+                                  .repetitions = 1));
+
+  uint64_t start = fio_time_milli();
+  fio_io_start(0);
+  uint64_t end = fio_time_milli();
+
+  fio_state_callback_remove(FIO_CALL_ON_START,
+                            tls13_fanout_connect,
+                            client_tls);
+  fio_io_listen_stop(l);
+  fio_io_tls_free(client_tls);
+
+  int r = (tls13_fanout_state.errors || tls13_fanout_state.timed_out ||
+           tls13_fanout_state.done != TLS13_FANOUT_CLIENTS);
+  fprintf(stderr,
+          "\t%-34s %s (%zu/%d clients, %zu errors) in %llu ms\n",
+          name,
+          r ? "FAILED" : "passed",
+          tls13_fanout_state.done,
+          TLS13_FANOUT_CLIENTS,
+          tls13_fanout_state.errors,
+          (unsigned long long)(end - start));
+  return r;
+}
+
+int main(void) {
+#ifdef _WIN32
+  FIO_LOG_WARNING("SKIPPED");
+  fprintf(stderr, "=== TLS 1.3 fan-out stress tests skipped on Windows ===\n");
+  return 0;
+#else
+  /* clients skip verifying the self-signed certificate, silence the notices */
+  if (FIO_LOG_LEVEL == FIO_LOG_LEVEL_INFO)
+    FIO_LOG_LEVEL = FIO_LOG_LEVEL_FATAL;
+  for (size_t i = 0; i < TLS13_FANOUT_TOTAL; ++i)
+    tls13_fanout_payload[i] = (uint8_t)((i * 7) ^ (i >> 10));
+
+  fprintf(stderr,
+          "=== TLS 1.3 fan-out stress tests (%d clients x %d KB) ===\n",
+          TLS13_FANOUT_CLIENTS,
+          TLS13_FANOUT_TOTAL >> 10);
+  int r = tls13_fanout_run("encryption on the IO thread", 0);
+  r |= tls13_fanout_run("worker thread encryption (4)", TLS13_FANOUT_THREADS);
+  fio_tls13_io_async(0);
+
+  if (r)
+    fprintf(stderr, "=== TLS 1.3 fan-out stress tests FAILED ===\n");
+  else
+    fprintf(stderr, "=== TLS 1.3 fan-out stress tests passed ===\n");
+  return r;
+#endif
+}
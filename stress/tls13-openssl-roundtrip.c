@@ -1043,9 +1043,9 @@ int main(void) {
   fio_state_callback_add(FIO_CALL_ON_START,
                          fio___tls13_openssl_rt_start_client,
                          NULL);
-  fio_io_run_every(.fn = fio___tls13_openssl_rt_watchdog,
-                   .every = 8000,
-                   .repetitions = 1);
+  fio_timer_free(fio_io_run_every(.fn = fio___tls13_openssl_rt_watchdog,
+                                  .every = 8000,
+                                  .repetitions = 1));
 
   fio_io_start(0);
 
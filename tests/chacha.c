@@ -579,6 +579,99 @@ FIO_SFUNC void FIO_NAME_TEST(stl, xchacha20_poly1305_edges)(void) {
   }
 }
 
+/* *****************************************************************************
+Multi-Block Kernels (compared with the single block / single step code)
+***************************************************************************** */
+
+/* Poly1305 reference - one block at a time. */
+FIO_SFUNC void fio___test_poly1305_ref(uint8_t *mac,
+                                       const uint8_t *msg,
+                                       size_t len,
+                                       const uint8_t *key) {
+  fio___poly_s pl = fio___poly_init(key);
+  for (; len > 15; len -= 16, msg += 16)
+    fio___poly_consume128bit(&pl, msg, 1);
+  if (len) {
+    uint8_t n[16] = {0};
+    FIO_MEMCPY(n, msg, len);
+    n[len] = 1;
+    fio___poly_consume128bit(&pl, n, 0);
+  }
+  fio___poly_finilize(&pl);
+  fio_u2buf64_le(mac, pl.a[0]);
+  fio_u2buf64_le(mac + 8, pl.a[1]);
+}
+
+FIO_SFUNC void FIO_NAME_TEST(stl, chacha20_poly1305_kernels)(void) {
+  enum { MAX_LEN = 4200 };
+  uint8_t *msg = (uint8_t *)FIO_MEM_REALLOC(NULL, 0, MAX_LEN * 2, 0);
+  uint8_t *ref = msg + MAX_LEN;
+  uint8_t key[32], nonce[12], mac[16], mac2[16];
+  FIO_ASSERT_ALLOC(msg);
+#if FIO___CHACHA_X86
+  fprintf(stderr,
+          "* ChaCha20 kernels: SSE2%s%s\n",
+          (fio___chacha_cpu() & FIO___CHACHA_CPU_AVX2) ? ", AVX2" : "",
+          (fio___chacha_cpu() & FIO___CHACHA_CPU_AVX512) ? ", AVX-512" : "");
+#endif
+  /* ChaCha20 - every kernel boundary, including a counter wrap */
+  for (size_t len = 0; len < MAX_LEN; len += 1 + (len > 300) * 13) {
+    const uint32_t counter = (len & 1) ? 0xFFFFFFF8UL : (uint32_t)len;
+    fio_rand_bytes(key, 32);
+    fio_rand_bytes(nonce, 12);
+    fio_rand_bytes(msg, len);
+    FIO_MEMCPY(ref, msg, len);
+    fio_chacha20(msg, len, key, nonce, counter);
+    fio_u512 c = fio___chacha_init(key, nonce, counter);
+    for (size_t i = 0; i < len; i += 64) {
+      fio_u512 b = {.u64 = {0}};
+      size_t n = (len - i > 64) ? 64 : len - i;
+      FIO_MEMCPY(b.u8, ref + i, n);
+      fio___chacha_vround20(c, b.u8);
+      FIO_MEMCPY(ref + i, b.u8, n);
+      ++c.u32[12];
+    }
+    FIO_ASSERT(!memcmp(msg, ref, len),
+               "ChaCha20 multi-block output mismatch (%zu bytes)",
+               len);
+  }
+  /* Poly1305 - multi-block Horner vs. single steps, random and worst case */
+  for (size_t len = 0; len < MAX_LEN; len += 1 + (len > 300) * 13) {
+    fio_rand_bytes(key, 32);
+    fio_rand_bytes(msg, len);
+    if ((len & 3) == 3) { /* largest clamped r, all ones message */
+      FIO_MEMSET(key, 0xFF, 16);
+      FIO_MEMSET(msg, 0xFF, len);
+    }
+    fio_poly1305_auth(mac, msg, len, NULL, 0, key);
+    fio___test_poly1305_ref(mac2, msg, len, key);
+    FIO_ASSERT(!memcmp(mac, mac2, 16),
+               "Poly1305 multi-block MAC mismatch (%zu bytes)",
+               len);
+  }
+  /* AEAD - chunked encryption matches `auth` and decrypts */
+  for (size_t len = 0; len < MAX_LEN; len += 1 + (len > 300) * 97) {
+    size_t adlen = len % 67;
+    fio_rand_bytes(key, 32);
+    fio_rand_bytes(nonce, 12);
+    fio_rand_bytes(msg, len + adlen);
+    FIO_MEMCPY(ref, msg, len + adlen);
+    fio_chacha20_poly1305_enc(mac, msg, len, msg + len, adlen, key, nonce);
+    fio_chacha20_poly1305_auth(mac2, msg, len, msg + len, adlen, key, nonce);
+    FIO_ASSERT(!memcmp(mac, mac2, 16),
+               "ChaCha20-Poly1305 enc / auth MAC mismatch (%zu bytes)",
+               len);
+    FIO_ASSERT(
+        !fio_chacha20_poly1305_dec(mac, msg, len, msg + len, adlen, key, nonce),
+        "ChaCha20-Poly1305 decryption failed (%zu bytes)",
+        len);
+    FIO_ASSERT(!memcmp(msg, ref, len),
+               "ChaCha20-Poly1305 roundtrip failed (%zu bytes)",
+               len);
+  }
+  FIO_MEM_FREE(msg, MAX_LEN * 2);
+}
+
 /* *****************************************************************************
 Main
 ***************************************************************************** */
@@ -590,5 +683,6 @@ int main(void) {
   FIO_NAME_TEST(stl, xchacha20_poly1305_kat)();
   FIO_NAME_TEST(stl, chacha20_poly1305_edges)();
   FIO_NAME_TEST(stl, xchacha20_poly1305_edges)();
+  FIO_NAME_TEST(stl, chacha20_poly1305_kernels)();
   return 0;
 }
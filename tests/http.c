@@ -9,6 +9,8 @@ No performance loops, no external processes, no external network calls.
 Loopback sockets are used only for listener creation (no reactor is run).
 ***************************************************************************** */
 #define FIO_HTTP
+/* revalidate static file cache entries on every request */
+#define FIO_HTTP_STATIC_FILE_CACHE_REVALIDATE 0
 #include "test-helpers.h"
 
 #include <stdio.h>
@@ -406,6 +408,88 @@ static void test_listen_and_route(void) {
   fio_io_listen_stop((fio_io_listener_s *)l);
 }
 
+static void test_route_params(void) {
+  fprintf(stderr, "  * routing with :param and *wildcard segments\n");
+
+  fio_http_listener_s *l = fio_http_listen("tcp://127.0.0.1:0",
+                                           .udata = (void *)(uintptr_t)0xABCD,
+                                           .on_http = test_http_noop_on_http);
+  FIO_ASSERT(l, "fio_http_listen should succeed on loopback port 0");
+  fio___http_protocol_s *p =
+      FIO_PTR_FROM_FIELD(fio___http_protocol_s,
+                         state[FIO___HTTP_PROTOCOL_ACCEPT].protocol,
+                         fio_io_listener_protocol((fio_io_listener_s *)l));
+
+  FIO_ASSERT(!fio_http_route(l, "/users/:id", .udata = (void *)1) &&
+                 !fio_http_route(l, "/users/new", .udata = (void *)2) &&
+                 !fio_http_route(l,
+                                 "/users/:id/posts/:post",
+                                 .udata = (void *)3) &&
+                 !fio_http_route(l, "/files/*path", .udata = (void *)4) &&
+                 !fio_http_route(l, "/user", .udata = (void *)5),
+             "parameter routes should succeed");
+  FIO_ASSERT(fio_http_route(l, "/users/:name/x", .udata = (void *)6) == -1,
+             "conflicting parameter names should fail");
+  FIO_ASSERT(fio_http_route(l, "/files/*path/x", .udata = (void *)6) == -1,
+             "a wildcard that isn't the last segment should fail");
+
+  struct {
+    const char *url;
+    uintptr_t udata;
+    const char *path;
+    const char *name[2];
+    const char *value[2];
+  } expected[] = {
+      {"/users/42", 1, "/", {"id"}, {"42"}},
+      {"/users/42/edit", 1, "/edit", {"id"}, {"42"}},
+      {"/users/new", 2, "/", {NULL}, {NULL}},
+      {"/users/newer", 1, "/", {"id"}, {"newer"}},
+      {"/users/a%20b/posts/7", 3, "/", {"id", "post"}, {"a b", "7"}},
+      {"/users/42/posts", 1, "/posts", {"id"}, {"42"}},
+      {"/files/", 4, "/", {"path"}, {""}},
+      {"/files/a/b.txt", 4, "/", {"path"}, {"a/b.txt"}},
+      {"/user", 5, "/", {NULL}, {NULL}},
+      {"/users", 0xABCD, "/users", {NULL}, {NULL}},
+      {"/us", 0xABCD, "/us", {NULL}, {NULL}},
+  };
+  for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); ++i) {
+    fio_http_s *h = fio_http_new();
+    fio_str_info_s path = FIO_STR_INFO1((char *)expected[i].url);
+    fio_http_settings_s *s = fio___http_route_settings(&p->router, &path, h);
+    FIO_ASSERT(s->udata == (void *)expected[i].udata,
+               "%s routed to the wrong route (%p)",
+               expected[i].url,
+               s->udata);
+    FIO_ASSERT(FIO_STR_INFO_IS_EQ(path,
+                                  FIO_STR_INFO1((char *)expected[i].path)),
+               "%s routed path error (%.*s)",
+               expected[i].url,
+               (int)path.len,
+               path.buf);
+    FIO_ASSERT(fio_http_route_param_each(h, NULL, NULL) ==
+                   (size_t)(!!expected[i].name[0] + !!expected[i].name[1]),
+               "%s parameter count error",
+               expected[i].url);
+    for (size_t j = 0; j < 2 && expected[i].name[j]; ++j) {
+      fio_str_info_s v =
+          fio_http_route_param(h, FIO_STR_INFO1((char *)expected[i].name[j]));
+      FIO_ASSERT(v.buf && FIO_STR_INFO_IS_EQ(
+                              v,
+                              FIO_STR_INFO1((char *)expected[i].value[j])),
+                 "%s parameter %s error (%.*s)",
+                 expected[i].url,
+                 expected[i].name[j],
+                 (int)v.len,
+                 v.buf);
+    }
+    FIO_ASSERT(!fio_http_route_param(h, FIO_STR_INFO1((char *)"missing")).buf,
+               "missing parameters should return an empty string");
+    fio_http_free(h);
+  }
+
+  fio_io_listen_stop((fio_io_listener_s *)l);
+}
+
 static void test_settings_and_io_queries(void) {
   fprintf(stderr, "  * settings and IO queries on unconnected handle\n");
 
@@ -1694,6 +1778,317 @@ static void test_static_compress_detached_creation(void) {
    ===========================================================================
  */
 
+/* ===========================================================================
+   Static file cache: hits, variants, revalidation and bypass
+   ===========================================================================
+ */
+static void test_static_cache_get(const char *dir,
+                                  size_t dir_len,
+                                  const char *accept,
+                                  const char *range,
+                                  const char *expect_cl,
+                                  const char *expect_ce,
+                                  size_t expect_status) {
+  fio_http_s *h = test_http_make_handle("GET", "/test.txt");
+  fio_http_status_set(h, 200);
+  if (accept)
+    fio_http_request_header_set(h,
+                                FIO_STR_INFO2((char *)"accept-encoding", 15),
+                                FIO_STR_INFO1((char *)accept));
+  if (range)
+    fio_http_request_header_set(h,
+                                FIO_STR_INFO2((char *)"range", 5),
+                                FIO_STR_INFO1((char *)range));
+  int r = fio_http_static_file_response(h,
+                                        FIO_STR_INFO2((char *)dir, dir_len),
+                                        FIO_STR_INFO1((char *)"/test.txt"),
+                                        0);
+  FIO_ASSERT(r == 0, "static cache: response should succeed");
+  FIO_ASSERT(fio_http_status(h) == expect_status,
+             "static cache: expected status %zu, got %zu",
+             expect_status,
+             (size_t)fio_http_status(h));
+  fio_str_info_s cl =
+      fio_http_response_header(h,
+                               FIO_STR_INFO2((char *)"content-length", 14),
+                               0);
+  FIO_ASSERT(!expect_cl ||
+                 FIO_STR_INFO_IS_EQ(cl, FIO_STR_INFO1((char *)expect_cl)),
+             "static cache: expected content-length %s (got '%.*s')",
+             expect_cl,
+             (int)cl.len,
+             cl.buf ? cl.buf : "");
+  fio_str_info_s ce =
+      fio_http_response_header(h,
+                               FIO_STR_INFO2((char *)"content-encoding", 16),
+                               0);
+  FIO_ASSERT(expect_ce
+                 ? FIO_STR_INFO_IS_EQ(ce, FIO_STR_INFO1((char *)expect_ce))
+                 : !ce.len,
+             "static cache: unexpected content-encoding '%.*s'",
+             (int)ce.len,
+             ce.buf ? ce.buf : "");
+  fio_http_free(h);
+}
+
+/** Returns the most recently used static cache entry. */
+static fio___http_file_cache_entry_s *test_static_cache_entry(void) {
+  FIO_ASSERT(!FIO_LIST_IS_EMPTY(&FIO___HTTP_FILE_CACHE.lru),
+             "static cache: cache should have an entry");
+  return FIO_PTR_FROM_FIELD(fio___http_file_cache_entry_s,
+                            node,
+                            FIO___HTTP_FILE_CACHE.lru.prev);
+}
+
+/** Rewrites the static cache test file with `len` copies of `c`. */
+static void test_static_cache_rewrite(const char *dir, char c, size_t len) {
+  char path[600];
+  char data[4096];
+  FIO_ASSERT(len <= sizeof(data), "static cache: rewrite too long");
+  FIO_MEMSET(data, c, len);
+  snprintf(path, sizeof(path), "%s%ctest.txt", dir, FIO_FOLDER_SEPARATOR);
+  FILE *f = fopen(path, "wb");
+  FIO_ASSERT(f, "failed to update static cache test file");
+  FIO_ASSERT(fwrite(data, 1, len, f) == len,
+             "failed to write static cache test file");
+  fclose(f);
+}
+
+static void test_static_file_cache(void) {
+  fprintf(stderr, "  * static file cache\n");
+  enum { CONTENT_LEN = 4096 };
+  char content[CONTENT_LEN];
+  for (size_t i = 0; i < CONTENT_LEN; ++i)
+    content[i] = (char)('a' + (i & 15));
+  char dir[512];
+  size_t dir_len =
+      test_static_make_tree(dir, sizeof(dir), content, CONTENT_LEN, 1);
+  FIO_ASSERT(dir_len > 0, "failed to create static cache test tree");
+
+  /* files larger than the cache limit aren't cached */
+  FIO_ASSERT(!fio_http_static_file_cache(1024),
+             "static cache should be disabled by default");
+  test_static_cache_get(dir, dir_len, NULL, NULL, "4096", NULL, 200);
+  FIO_ASSERT(!fio___http_file_cache_map_count(&FIO___HTTP_FILE_CACHE.map),
+             "static cache: entry above the limit should not be cached");
+
+  FIO_ASSERT(fio_http_static_file_cache(1UL << 20) == 1024,
+             "fio_http_static_file_cache should return the previous limit");
+  test_static_cache_get(dir, dir_len, NULL, NULL, "4096", NULL, 200);
+  FIO_ASSERT(fio___http_file_cache_map_count(&FIO___HTTP_FILE_CACHE.map) == 1,
+             "static cache: file should be cached");
+  /* served from the cache (identity and gzip variants) */
+  test_static_cache_get(dir, dir_len, NULL, NULL, "4096", NULL, 200);
+  test_static_cache_get(dir, dir_len, "br, gzip", NULL, NULL, "gzip", 200);
+  FIO_ASSERT(fio___http_file_cache_map_count(&FIO___HTTP_FILE_CACHE.map) == 1,
+             "static cache: cached entry should be reused");
+  /* ranged requests bypass the cache */
+  test_static_cache_get(dir, dir_len, "gzip", "bytes=0-99", "100", NULL, 206);
+
+  /* modified files are revalidated (FIO_HTTP_STATIC_FILE_CACHE_REVALIDATE) */
+  {
+    char path[600];
+    snprintf(path, sizeof(path), "%s%ctest.txt", dir, FIO_FOLDER_SEPARATOR);
+    FILE *f = fopen(path, "wb");
+    FIO_ASSERT(f, "failed to update static cache test file");
+    FIO_ASSERT(fwrite(content, 1, CONTENT_LEN / 2, f) == CONTENT_LEN / 2,
+               "failed to write static cache test file");
+    fclose(f);
+  }
+  test_static_cache_get(dir, dir_len, NULL, NULL, "2048", NULL, 200);
+  FIO_ASSERT(fio___http_file_cache_map_count(&FIO___HTTP_FILE_CACHE.map) == 1,
+             "static cache: updated file should replace the stale entry");
+
+  /* same size rewrites are detected by the nanosecond modification time */
+  FIO_THREAD_WAIT(20000000);
+  test_static_cache_rewrite(dir, 'Z', CONTENT_LEN / 2);
+  test_static_cache_get(dir, dir_len, NULL, NULL, "2048", NULL, 200);
+  FIO_ASSERT(test_static_cache_entry()->data[0][0] == 'Z',
+             "static cache: same size rewrite should replace the entry");
+
+#if FIO___HTTP_FILE_CACHE_INOTIFY
+  /* inotify invalidates entries and releases their folder's watch */
+  {
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    FIO_ASSERT(fd != -1, "static cache: inotify_init1 failed");
+    FIO___HTTP_FILE_CACHE.fd = fd; /* the reactor isn't running */
+    fio_http_static_file_cache(0);
+    fio_http_static_file_cache(1UL << 20);
+    test_static_cache_get(dir, dir_len, NULL, NULL, "2048", NULL, 200);
+    FIO_ASSERT(test_static_cache_entry()->wd != -1,
+               "static cache: entry should be watched");
+    FIO_ASSERT(
+        fio___http_file_cache_wd_map_count(&FIO___HTTP_FILE_CACHE.wds) == 1,
+        "static cache: entry's watch should be counted");
+    test_static_cache_rewrite(dir, 'Y', CONTENT_LEN / 4);
+    fio___http_file_cache_read_events(fd);
+    FIO_ASSERT(!fio___http_file_cache_map_count(&FIO___HTTP_FILE_CACHE.map),
+               "static cache: inotify event should invalidate the entry");
+    FIO_ASSERT(
+        !fio___http_file_cache_wd_map_count(&FIO___HTTP_FILE_CACHE.wds),
+        "static cache: invalidated entry should release its watch");
+    test_static_cache_get(dir, dir_len, NULL, NULL, "1024", NULL, 200);
+    FIO_ASSERT(test_static_cache_entry()->data[0][0] == 'Y' &&
+                   test_static_cache_entry()->wd != -1,
+               "static cache: updated file should be cached and watched");
+    FIO_ASSERT(fio_http_static_file_cache(0) == (1UL << 20),
+               "fio_http_static_file_cache should return the previous limit");
+    FIO_ASSERT(
+        !fio___http_file_cache_wd_map_count(&FIO___HTTP_FILE_CACHE.wds),
+        "static cache: disabling the cache should release all watches");
+    FIO___HTTP_FILE_CACHE.fd = -1;
+    close(fd);
+    fio_http_static_file_cache(1UL << 20);
+  }
+#endif
+
+  FIO_ASSERT(fio_http_static_file_cache(0) == (1UL << 20),
+             "fio_http_static_file_cache should return the previous limit");
+  FIO_ASSERT(!fio___http_file_cache_map_count(&FIO___HTTP_FILE_CACHE.map),
+             "static cache: disabling the cache should empty it");
+  test_static_tree_cleanup(dir);
+}
+
+/* ===========================================================================
+   Pub/sub broadcast frames: encoded once, shared by all subscribers
+   ===========================================================================
+ */
+static size_t test_broadcast_encoded;
+
+static char *test_broadcast_encode(fio_pubsub_msg_s *msg,
+                                   uint32_t variant,
+                                   void *udata) {
+  ++test_broadcast_encoded;
+  return fio_bstr_write(NULL, msg->message.buf, msg->message.len);
+  (void)variant, (void)udata;
+}
+
+static void test_broadcast_frame_cache(void) {
+  fprintf(stderr, "  * pub/sub broadcast frame cache\n");
+  char data[2048];
+  for (size_t i = 0; i < sizeof(data); ++i)
+    data[i] = (char)('a' + (i % 7));
+  fio_pubsub_msg_s msg = {
+      .timestamp = 1700000000000ULL,
+      .id = 0x0123456789ABCDEFULL,
+      .channel = FIO_BUF_INFO2((char *)"chat", 4),
+      .message = FIO_BUF_INFO2(data, sizeof(data)),
+  };
+
+  test_broadcast_encoded = 0;
+  char *frames[4];
+  for (size_t i = 0; i < 4; ++i)
+    frames[i] =
+        fio___http_broadcast_frame(&msg, 1, test_broadcast_encode, NULL);
+#if FIO_HTTP_BROADCAST_CACHE
+  FIO_ASSERT(test_broadcast_encoded == 1,
+             "broadcast: message should be encoded once (%zu)",
+             test_broadcast_encoded);
+  for (size_t i = 1; i < 4; ++i)
+    FIO_ASSERT(frames[i] == frames[0], "broadcast: frame should be shared");
+#endif
+  FIO_ASSERT(fio_bstr_len(frames[0]) == sizeof(data) &&
+                 !FIO_MEMCMP(frames[0], data, sizeof(data)),
+             "broadcast: frame data error");
+  for (size_t i = 0; i < 4; ++i)
+    fio_bstr_free(frames[i]);
+  /* other variants and other messages are encoded separately */
+  fio_bstr_free(
+      fio___http_broadcast_frame(&msg, 2, test_broadcast_encode, NULL));
+  msg.id ^= 1;
+  fio_bstr_free(
+      fio___http_broadcast_frame(&msg, 1, test_broadcast_encode, NULL));
+#if FIO_HTTP_BROADCAST_CACHE
+  FIO_ASSERT(test_broadcast_encoded == 3,
+             "broadcast: variants / messages must not share frames");
+#endif
+  /* publishers choose ids: equal id, timestamp and length aren't enough */
+  {
+    char other[sizeof(data)];
+    for (size_t i = 0; i < sizeof(other); ++i)
+      other[i] = (char)('A' + (i % 5));
+    fio_pubsub_msg_s msg2 = msg;
+    msg2.channel = FIO_BUF_INFO2((char *)"news", 4);
+    msg2.message = FIO_BUF_INFO2(other, sizeof(other));
+    char *a = fio___http_broadcast_frame(&msg, 1, test_broadcast_encode, NULL);
+    char *b = fio___http_broadcast_frame(&msg2, 1, test_broadcast_encode, NULL);
+    FIO_ASSERT(a != b && !FIO_MEMCMP(b, other, sizeof(other)),
+               "broadcast: other channels must not share frames");
+    fio_bstr_free(b);
+    msg2.channel = msg.channel; /* same channel, different content */
+    b = fio___http_broadcast_frame(&msg2, 1, test_broadcast_encode, NULL);
+    FIO_ASSERT(a != b && !FIO_MEMCMP(b, other, sizeof(other)),
+               "broadcast: other payloads must not share frames");
+    fio_bstr_free(b);
+    msg2 = msg; /* same message, other filter */
+    msg2.filter = 1;
+    b = fio___http_broadcast_frame(&msg2, 1, test_broadcast_encode, NULL);
+    FIO_ASSERT(a != b, "broadcast: other filters must not share frames");
+    fio_bstr_free(b);
+    fio_bstr_free(a);
+  }
+
+  /* SSE frames */
+  {
+    char *sse = fio___http_broadcast_frame(&msg,
+                                           FIO___HTTP_BROADCAST_SSE,
+                                           fio___http_sse_broadcast_encode,
+                                           NULL);
+    const char *head = "id:0123456789ABCDEE\r\nevent:chat\r\n";
+    FIO_ASSERT(sse && !FIO_MEMCMP(sse, head, 33),
+               "broadcast: SSE frame header error: %.33s",
+               sse);
+    FIO_ASSERT(fio_bstr_len(sse) == 33 + 5 + sizeof(data) + 4 &&
+                   !FIO_MEMCMP(sse + 38, data, sizeof(data)),
+               "broadcast: SSE frame data error");
+    fio_bstr_free(sse);
+  }
+
+  /* WebSocket frames, with and without permessage-deflate */
+  {
+    fio___http_connection_s *c =
+        (fio___http_connection_s *)FIO_MEM_REALLOC(NULL, 0, sizeof(*c), 0);
+    FIO_ASSERT_ALLOC(c);
+    FIO_MEMSET(c, 0, sizeof(*c));
+    char *ws = fio___websocket_broadcast_encode(&msg,
+                                                FIO___HTTP_BROADCAST_WS_TEXT,
+                                                c);
+    FIO_ASSERT(fio_bstr_len(ws) == 4 + sizeof(data) &&
+                   (uint8_t)ws[0] == 0x81 && (uint8_t)ws[1] == 126 &&
+                   !FIO_MEMCMP(ws + 4, data, sizeof(data)),
+               "broadcast: WebSocket text frame error");
+    fio_bstr_free(ws);
+
+    c->deflate_wr = fio_deflate_new(1, 1);
+    c->deflate_wr_reset = 1;
+    fio_deflate_s *rd = fio_deflate_new(1, 0);
+    for (size_t round = 0; round < 2; ++round) {
+      ws = fio___websocket_broadcast_encode(
+          &msg,
+          (FIO___HTTP_BROADCAST_WS_DEFLATE | FIO___HTTP_BROADCAST_BITS(15)),
+          c);
+      FIO_ASSERT((uint8_t)ws[0] == 0xC2 && (uint8_t)ws[1] < 126,
+                 "broadcast: compressed binary frame header error (%02X %02X)",
+                 (unsigned)(uint8_t)ws[0],
+                 (unsigned)(uint8_t)ws[1]);
+      char out[sizeof(data) + 64];
+      size_t r =
+          fio_deflate_push(rd, out, sizeof(out), ws + 2, (uint8_t)ws[1], 1);
+      fio_deflate_destroy(rd);
+      FIO_ASSERT(r == sizeof(data) && !FIO_MEMCMP(out, data, sizeof(data)),
+                 "broadcast: compressed frame should inflate to the message "
+                 "(round %zu, %zu bytes)",
+                 round,
+                 r);
+      fio_bstr_free(ws);
+    }
+    fio_deflate_free(rd);
+    fio_deflate_free(c->deflate_wr);
+    FIO_MEM_FREE(c, sizeof(*c));
+  }
+  fio___http_broadcast_destroy();
+}
+
 int main(void) {
 #if defined(_WIN32)
   /* Permanent diagnostic net: make any future Windows CI hard crash
@@ -1704,6 +2099,7 @@ int main(void) {
 
   test_resource_action();
   test_listen_and_route();
+  test_route_params();
   /* In-process reactor roundtrip omitted: running fio_io_start inside a
      correctness test reliably crashes during reactor shutdown, and the crash
      is in reactor/connection cleanup rather than HTTP logic. The listen and
@@ -1721,6 +2117,8 @@ int main(void) {
   test_static_compress_note_result();
   test_static_compress_attached_readonly();
   test_static_compress_detached_creation();
+  test_static_file_cache();
+  test_broadcast_frame_cache();
 
   fprintf(stderr, "\nAll high-level HTTP tests passed!\n");
   return 0;
@@ -518,6 +518,97 @@ static void test_chunk_size_non_rfc_rejected(void) {
              "chunk size '1_0': should be a parse error");
 }
 
+static void test_control_bytes_rejected(void) {
+  fprintf(stderr, "  * control bytes / bare CR rejected\n");
+  char bad1[] = "GET / HTTP/1.1\r\nHost: x\x01y\r\n\r\n";
+  char bad2[] = "GET / HTTP/1.1\r\nHost: x\ry\r\n\r\n";
+  char bad3[] = "GET /\x7F HTTP/1.1\r\n\r\n";
+  char bad4[] = "GET / HTTP/1.1\r\nX-Long: "
+                "0123456789012345678901234567890123456789012345678901234567"
+                "\x1B"
+                "89\r\n\r\n";
+  char *bad[] = {bad1, bad2, bad3, bad4};
+  size_t bad_len[] = {sizeof(bad1) - 1,
+                      sizeof(bad2) - 1,
+                      sizeof(bad3) - 1,
+                      sizeof(bad4) - 1};
+  for (size_t i = 0; i < 4; ++i) {
+    parser_state_s st = {0};
+    FIO_ASSERT(run_parse(&st, bad[i], bad_len[i]) == FIO_HTTP1_PARSER_ERROR,
+               "control byte (%zu): parser should have rejected input",
+               i);
+  }
+  char ok[] = "GET / HTTP/1.1\r\nX-Tab: a\tb\r\nX-UTF8: \xC3\xA9\r\n\r\n";
+  parser_state_s st = {0};
+  FIO_ASSERT(run_parse(&st, ok, sizeof(ok) - 1) == sizeof(ok) - 1 &&
+                 st.complete && st.header_count == 2,
+             "HTAB / UTF-8 header values should be accepted");
+}
+
+static void test_long_lines(void) {
+  fprintf(stderr, "  * long lines (multiple scanner windows)\n");
+  char buf[1024];
+  size_t len = 0;
+  len += (size_t)snprintf(buf + len, sizeof(buf) - len, "GET /");
+  for (size_t i = 0; i < 150; ++i)
+    buf[len++] = (char)('a' + (i % 26));
+  len += (size_t)snprintf(buf + len, sizeof(buf) - len, " HTTP/1.1\r\nX-L");
+  for (size_t i = 0; i < 130; ++i)
+    buf[len++] = 'x';
+  len += (size_t)snprintf(buf + len, sizeof(buf) - len, ":  ");
+  for (size_t i = 0; i < 200; ++i)
+    buf[len++] = (char)(i & 1 ? ':' : ' ');
+  len += (size_t)snprintf(buf + len, sizeof(buf) - len, "!\r\n\r\n");
+  parser_state_s st = {0};
+  FIO_ASSERT(run_parse(&st, buf, len) == len && st.complete,
+             "long lines: parser error");
+  FIO_ASSERT(st.url.len == 151, "long lines: URL length (%zu)", st.url.len);
+  FIO_ASSERT(st.header_count == 1, "long lines: header count");
+  /* every incomplete prefix waits for more data */
+  for (size_t i = 1; i < len - 1; ++i) {
+    fio_http1_parser_s parser = FIO_HTTP1_PARSER_INIT;
+    parser_state_s tmp = {0};
+    size_t r = run_parse_persist(&tmp, &parser, buf, i);
+    FIO_ASSERT(r != FIO_HTTP1_PARSER_ERROR && !tmp.complete,
+               "long lines: prefix of %zu bytes should be incomplete",
+               i);
+  }
+}
+
+static void test_scanner_matches_scalar(void) {
+  fprintf(stderr, "  * line scanner matches the scalar scanner\n");
+  const char alphabet[] = "ab:  \t\r\n\x01\x7F\xC3";
+  char buf[200];
+  uint64_t rnd = 0x9E3779B97F4A7C15ULL;
+  for (size_t round = 0; round < 20000; ++round) {
+    size_t len = (size_t)(round % sizeof(buf));
+    for (size_t i = 0; i < len; ++i) {
+      rnd = fio_risky_num(rnd, round);
+      /* mostly plain bytes, so lines span multiple windows */
+      buf[i] = (rnd & 7) ? 'a' + (char)(rnd & 15)
+                         : alphabet[(rnd >> 8) % (sizeof(alphabet) - 1)];
+    }
+    for (size_t s = 0; s < 3; ++s) {
+      const char seps[3] = {' ', ':', 0}; /* 0 is used for header values */
+      const char sep = seps[s];
+      char *pos = buf;
+      /* scan line after line */
+      for (;;) {
+        fio_http1___line_s a = {0}, b = {0};
+        int ra = fio_http1___scan_line(&a, pos, buf + len, sep);
+        int rb = fio_http1___scan_line_scalar(&b, pos, buf + len, sep);
+        FIO_ASSERT(ra == rb, "scanner result mismatch (%d != %d)", ra, rb);
+        if (ra)
+          break;
+        FIO_ASSERT(a.eol == b.eol && a.sep[0] == b.sep[0] &&
+                       a.sep[1] == b.sep[1],
+                   "scanner line mismatch");
+        pos = a.eol + 1;
+      }
+    }
+  }
+}
+
 /* ===========================================================================
    Main
    ===========================================================================
@@ -549,6 +640,9 @@ int main(void) {
   test_te_separator_only_prefix();
   test_content_length_underscore_rejected();
   test_chunk_size_non_rfc_rejected();
+  test_control_bytes_rejected();
+  test_long_lines();
+  test_scanner_matches_scalar();
   fprintf(stderr, "All HTTP/1 parser tests passed!\n");
   return 0;
 }
@@ -0,0 +1,444 @@
+/* *****************************************************************************
+Test: HTTP/2 framing and HPACK correctness
+***************************************************************************** */
+#define FIO_HTTP2_PARSER
+#include "test-helpers.h"
+
+/* *****************************************************************************
+Helpers
+***************************************************************************** */
+
+typedef struct {
+  size_t count;
+  char buf[4096];
+  size_t len;
+} hpack_headers_s;
+
+/* collects headers as "name: value\n" lines */
+static int hpack_on_header(fio_buf_info_s name,
+                           fio_buf_info_s value,
+                           void *udata) {
+  hpack_headers_s *h = (hpack_headers_s *)udata;
+  if (h->len + name.len + value.len + 3 > sizeof(h->buf))
+    return -1;
+  FIO_MEMCPY(h->buf + h->len, name.buf, name.len);
+  h->len += name.len;
+  h->buf[h->len++] = ':';
+  h->buf[h->len++] = ' ';
+  FIO_MEMCPY(h->buf + h->len, value.buf, value.len);
+  h->len += value.len;
+  h->buf[h->len++] = '\n';
+  ++h->count;
+  return 0;
+}
+
+static size_t hex2bin(uint8_t *dest, const char *hex) {
+  size_t r = 0;
+  while (hex[0] && hex[1]) {
+    dest[r++] = (uint8_t)((fio_c2i((unsigned char)hex[0]) << 4) |
+                          fio_c2i((unsigned char)hex[1]));
+    hex += 2;
+  }
+  return r;
+}
+
+static void hpack_decode_test(fio_hpack_s *t,
+                              const char *hex,
+                              const char *expected,
+                              size_t table_size) {
+  uint8_t block[512];
+  char scratch[1024];
+  hpack_headers_s h = {0};
+  size_t len = hex2bin(block, hex);
+  fio_str_info_s buf = FIO_STR_INFO3(scratch, 0, sizeof(scratch));
+  int r = fio_hpack_decode(t,
+                           FIO_BUF_INFO2((char *)block, len),
+                           &buf,
+                           NULL,
+                           hpack_on_header,
+                           &h);
+  FIO_ASSERT(!r, "HPACK decoding failed for:\n%s", expected);
+  FIO_ASSERT(h.len == strlen(expected) && !memcmp(h.buf, expected, h.len),
+             "HPACK decoding mismatch:\n%.*s\nexpected:\n%s",
+             (int)h.len,
+             h.buf,
+             expected);
+  FIO_ASSERT(t->size == table_size,
+             "HPACK dynamic table size error (%zu != %zu)",
+             (size_t)t->size,
+             table_size);
+}
+
+/* *****************************************************************************
+Tests
+***************************************************************************** */
+
+static void test_frame_header(void) {
+  uint8_t buf[FIO_HTTP2_FRAME_HEADER_LEN];
+  fio_http2_frame_s f = {.len = 0x123456,
+                         .stream_id = 0x7FFFFFFF,
+                         .type = FIO_HTTP2_FRAME_HEADERS,
+                         .flags = FIO_HTTP2_FLAG_END_HEADERS};
+  fio_http2_frame_write(buf, f);
+  FIO_ASSERT(buf[0] == 0x12 && buf[1] == 0x34 && buf[2] == 0x56 &&
+                 buf[3] == 1 && buf[4] == 4 && buf[5] == 0x7F,
+             "frame header write error");
+  buf[5] |= 0x80; /* reserved bit must be ignored */
+  fio_http2_frame_s r = fio_http2_frame_read(buf);
+  FIO_ASSERT(r.len == f.len && r.stream_id == f.stream_id &&
+                 r.type == f.type && r.flags == f.flags,
+             "frame header read error");
+  FIO_ASSERT(sizeof(FIO_HTTP2_PREFACE) - 1 == FIO_HTTP2_PREFACE_LEN,
+             "connection preface length error");
+}
+
+static void test_huffman(void) {
+  /* RFC 7541, Appendix C.4.1 */
+  const char *src = "www.example.com";
+  uint8_t expected[32];
+  uint8_t buf[64];
+  char dec[64];
+  size_t elen = hex2bin(expected, "f1e3c2e5f23a6ba0ab90f4ff");
+  FIO_ASSERT(fio_hpack_huffman_len(src, 15) == elen, "Huffman length error");
+  FIO_ASSERT(fio_hpack_huffman_encode(buf, src, 15) == elen &&
+                 !memcmp(buf, expected, elen),
+             "Huffman encoding error");
+  FIO_ASSERT(fio_hpack_huffman_decode(dec, sizeof(dec), buf, elen) == 15 &&
+                 !memcmp(dec, src, 15),
+             "Huffman decoding error");
+  FIO_ASSERT(fio_hpack_huffman_decode(dec, 14, buf, elen) == (size_t)-1,
+             "Huffman decoding should fail when capacity is exceeded");
+  /* padding must be a (short) prefix of EOS */
+  buf[elen - 1] &= 0xFE;
+  FIO_ASSERT(fio_hpack_huffman_decode(dec, sizeof(dec), buf, elen) ==
+                 (size_t)-1,
+             "Huffman decoding should fail on invalid padding");
+  buf[0] = buf[1] = 0xFF;
+  FIO_ASSERT(fio_hpack_huffman_decode(dec, sizeof(dec), buf, 2) == (size_t)-1,
+             "Huffman decoding should fail on 8+ bits of padding");
+  /* round trip every byte value */
+  for (size_t round = 0; round < 64; ++round) {
+    uint8_t raw[256];
+    uint8_t enc[1024];
+    uint8_t out[256];
+    for (size_t i = 0; i < 256; ++i)
+      raw[i] = (uint8_t)(i + round * 7);
+    size_t len = fio_hpack_huffman_encode(enc, raw, 256 - round);
+    FIO_ASSERT(len == fio_hpack_huffman_len(raw, 256 - round),
+               "Huffman length mismatch");
+    FIO_ASSERT(fio_hpack_huffman_decode(out, sizeof(out), enc, len) ==
+                       256 - round &&
+                   !memcmp(out, raw, 256 - round),
+               "Huffman round trip error");
+  }
+}
+
+static void test_hpack_rfc_requests(void) {
+  fio_hpack_s *t = (fio_hpack_s *)malloc(sizeof(*t));
+  FIO_ASSERT_ALLOC(t);
+  /* RFC 7541, Appendix C.3 (no Huffman) */
+  fio_hpack_init(t);
+  hpack_decode_test(t,
+                    "828684410f7777772e6578616d706c652e636f6d",
+                    ":method: GET\n:scheme: http\n:path: /\n"
+                    ":authority: www.example.com\n",
+                    57);
+  hpack_decode_test(t,
+                    "828684be58086e6f2d6361636865",
+                    ":method: GET\n:scheme: http\n:path: /\n"
+                    ":authority: www.example.com\ncache-control: no-cache\n",
+                    110);
+  hpack_decode_test(t,
+                    "828785bf400a637573746f6d2d6b65790c637573746f6d2d76616c7565",
+                    ":method: GET\n:scheme: https\n:path: /index.html\n"
+                    ":authority: www.example.com\ncustom-key: custom-value\n",
+                    164);
+  /* RFC 7541, Appendix C.4 (Huffman) */
+  fio_hpack_init(t);
+  hpack_decode_test(t,
+                    "828684418cf1e3c2e5f23a6ba0ab90f4ff",
+                    ":method: GET\n:scheme: http\n:path: /\n"
+                    ":authority: www.example.com\n",
+                    57);
+  hpack_decode_test(t,
+                    "828684be5886a8eb10649cbf",
+                    ":method: GET\n:scheme: http\n:path: /\n"
+                    ":authority: www.example.com\ncache-control: no-cache\n",
+                    110);
+  hpack_decode_test(t,
+                    "828785bf408825a849e95ba97d7f8925a849e95bb8e8b4bf",
+                    ":method: GET\n:scheme: https\n:path: /index.html\n"
+                    ":authority: www.example.com\ncustom-key: custom-value\n",
+                    164);
+  free(t);
+}
+
+static void test_hpack_rfc_responses(void) {
+  fio_hpack_s *t = (fio_hpack_s *)malloc(sizeof(*t));
+  FIO_ASSERT_ALLOC(t);
+  /* RFC 7541, Appendix C.6 (Huffman, 256 byte table with evictions) */
+  fio_hpack_init(t);
+  t->max_size = 256;
+  hpack_decode_test(t,
+                    "488264025885aec3771a4b6196d07abe941054d444a8200595040b81"
+                    "66e082a62d1bff6e919d29ad171863c78f0b97c8e9ae82ae43d3",
+                    ":status: 302\ncache-control: private\n"
+                    "date: Mon, 21 Oct 2013 20:13:21 GMT\n"
+                    "location: https://www.example.com\n",
+                    222);
+  hpack_decode_test(t,
+                    "4883640effc1c0bf",
+                    ":status: 307\ncache-control: private\n"
+                    "date: Mon, 21 Oct 2013 20:13:21 GMT\n"
+                    "location: https://www.example.com\n",
+                    222);
+  hpack_decode_test(t,
+                    "88c16196d07abe941054d444a8200595040b8166e084a62d1bffc05a"
+                    "839bd9ab77ad94e7821dd7f2e6c7b335dfdfcd5b3960d5af27087f36"
+                    "72c1ab270fb5291f9587316065c003ed4ee5b1063d5007",
+                    ":status: 200\ncache-control: private\n"
+                    "date: Mon, 21 Oct 2013 20:13:22 GMT\n"
+                    "location: https://www.example.com\n"
+                    "content-encoding: gzip\n"
+                    "set-cookie: foo=ASDJKHQKBZXOQWEOPIUAXQWEOIU; "
+                    "max-age=3600; version=1\n",
+                    215);
+  free(t);
+}
+
+static void test_hpack_encoder(void) {
+  fio_hpack_s *enc = (fio_hpack_s *)malloc(sizeof(*enc));
+  fio_hpack_s *dec = (fio_hpack_s *)malloc(sizeof(*dec));
+  FIO_ASSERT_ALLOC(enc);
+  FIO_ASSERT_ALLOC(dec);
+  fio_hpack_init(enc);
+  fio_hpack_init(dec);
+  /* the encoder reproduces RFC 7541, Appendix C.4 */
+  const char *requests[3][5][2] = {
+      {{":method", "GET"},
+       {":scheme", "http"},
+       {":path", "/"},
+       {":authority", "www.example.com"}},
+      {{":method", "GET"},
+       {":scheme", "http"},
+       {":path", "/"},
+       {":authority", "www.example.com"},
+       {"cache-control", "no-cache"}},
+      {{":method", "GET"},
+       {":scheme", "https"},
+       {":path", "/index.html"},
+       {":authority", "www.example.com"},
+       {"custom-key", "custom-value"}},
+  };
+  const char *expected[3] = {
+      "828684418cf1e3c2e5f23a6ba0ab90f4ff",
+      "828684be5886a8eb10649cbf",
+      "828785bf408825a849e95ba97d7f8925a849e95bb8e8b4bf",
+  };
+  for (size_t i = 0; i < 3; ++i) {
+    uint8_t block[256];
+    uint8_t ex[256];
+    size_t len = 0;
+    for (size_t j = 0; j < 5 && requests[i][j][0]; ++j)
+      len += fio_hpack_encode(enc,
+                              block + len,
+                              FIO_BUF_INFO1((char *)requests[i][j][0]),
+                              FIO_BUF_INFO1((char *)requests[i][j][1]),
+                              FIO_HPACK_INDEX);
+    size_t ex_len = hex2bin(ex, expected[i]);
+    FIO_ASSERT(len == ex_len && !memcmp(block, ex, len),
+               "HPACK encoding of request %zu doesn't match RFC 7541",
+               i + 1);
+  }
+  /* round trip with evictions, a size update and never indexed fields */
+  fio_hpack_init(enc);
+  fio_hpack_max_size_set(enc, 512);
+  for (size_t round = 0; round < 256; ++round) {
+    char block[4096];
+    char name[32], value[128];
+    char scratch[1024];
+    hpack_headers_s h = {0};
+    hpack_headers_s expected_h = {0};
+    size_t len = 0;
+    for (size_t j = 0; j < 8; ++j) {
+      size_t nlen = (size_t)snprintf(name, sizeof(name), "x-header-%zu", j);
+      size_t vlen = (size_t)snprintf(value,
+                                     sizeof(value),
+                                     "value %zu for round %zu",
+                                     (j * round) & 15,
+                                     round & 3);
+      fio_buf_info_s n = FIO_BUF_INFO2(name, nlen);
+      fio_buf_info_s v = FIO_BUF_INFO2(value, vlen);
+      FIO_ASSERT(len + FIO_HPACK_ENCODE_BOUND(nlen, vlen) <= sizeof(block),
+                 "test block overflow");
+      len += fio_hpack_encode(enc,
+                              block + len,
+                              n,
+                              v,
+                              (fio_hpack_indexing_e)((j + round) % 3));
+      hpack_on_header(n, v, &expected_h);
+    }
+    fio_str_info_s buf = FIO_STR_INFO3(scratch, 0, sizeof(scratch));
+    FIO_ASSERT(!fio_hpack_decode(dec,
+                                 FIO_BUF_INFO2(block, len),
+                                 &buf,
+                                 NULL,
+                                 hpack_on_header,
+                                 &h),
+               "HPACK round trip decoding failed (round %zu)",
+               round);
+    FIO_ASSERT(h.len == expected_h.len && !memcmp(h.buf, expected_h.buf, h.len),
+               "HPACK round trip mismatch (round %zu)",
+               round);
+    FIO_ASSERT(dec->size == enc->size && dec->count == enc->count,
+               "HPACK tables should be synchronized (round %zu)",
+               round);
+    FIO_ASSERT(enc->size <= 512, "HPACK table size limit exceeded");
+  }
+  free(enc);
+  free(dec);
+}
+
+static void test_hpack_errors(void) {
+  fio_hpack_s *t = (fio_hpack_s *)malloc(sizeof(*t));
+  FIO_ASSERT_ALLOC(t);
+  const char *invalid[] = {
+      "80",                 /* index 0 */
+      "be",                 /* dynamic index out of bounds */
+      "ff8001",             /* index out of bounds (multi byte integer) */
+      "ffffffffff0f",       /* integer overflow */
+      "410f7777",           /* truncated string */
+      "828fff",             /* truncated integer */
+      "823fe11f",           /* size update after a header field */
+      "3fe21f",             /* size update above the advertised limit */
+      "4081ff0161",         /* Huffman EOS / padding error */
+      NULL,
+  };
+  for (size_t i = 0; invalid[i]; ++i) {
+    uint8_t block[64];
+    char scratch[64];
+    hpack_headers_s h = {0};
+    size_t len = hex2bin(block, invalid[i]);
+    fio_str_info_s buf = FIO_STR_INFO3(scratch, 0, sizeof(scratch));
+    fio_hpack_init(t);
+    FIO_ASSERT(fio_hpack_decode(t,
+                                FIO_BUF_INFO2((char *)block, len),
+                                &buf,
+                                NULL,
+                                hpack_on_header,
+                                &h) == -1,
+               "HPACK decoding should fail for %s",
+               invalid[i]);
+  }
+  free(t);
+}
+
+/* *****************************************************************************
+Main
+***************************************************************************** */
+
+/* grows the scratch to exactly `capa` bytes (forcing it to move) */
+static int hpack_scratch_reserve(fio_str_info_s *scratch,
+                                 size_t capa,
+                                 void *udata) {
+  size_t *limit = (size_t *)udata;
+  if (capa > *limit)
+    return -1;
+  char *tmp = (char *)malloc(capa);
+  FIO_ASSERT_ALLOC(tmp);
+  if (scratch->len)
+    FIO_MEMCPY(tmp, scratch->buf, scratch->len);
+  if (scratch->buf)
+    FIO_MEMSET(scratch->buf, 0, scratch->capa); /* stale data is detectable */
+  free(scratch->buf);
+  scratch->buf = tmp;
+  scratch->capa = capa;
+  return 0;
+}
+
+typedef struct {
+  size_t limit;
+  hpack_headers_s h;
+} hpack_reserve_s;
+
+static int hpack_reserve_cb(fio_str_info_s *scratch, size_t capa, void *u) {
+  return hpack_scratch_reserve(scratch, capa, &((hpack_reserve_s *)u)->limit);
+}
+
+static int hpack_reserve_on_header(fio_buf_info_s name,
+                                   fio_buf_info_s value,
+                                   void *u) {
+  return hpack_on_header(name, value, &((hpack_reserve_s *)u)->h);
+}
+
+static void test_hpack_scratch_reserve(void) {
+  fio_hpack_s *enc = (fio_hpack_s *)malloc(sizeof(*enc));
+  fio_hpack_s *dec = (fio_hpack_s *)malloc(sizeof(*dec));
+  FIO_ASSERT_ALLOC(enc);
+  FIO_ASSERT_ALLOC(dec);
+  char value[600];
+  char expected[1024];
+  uint8_t block[1024];
+  FIO_MEMSET(value, 'a', sizeof(value) - 1);
+  value[sizeof(value) - 1] = 0;
+  fio_hpack_init(enc);
+  fio_hpack_init(dec);
+  /* Huffman name and value, a dynamic name copy and an indexed field */
+  size_t len = 0;
+  for (size_t i = 0; i < 3; ++i)
+    len += fio_hpack_encode(enc,
+                            block + len,
+                            FIO_BUF_INFO1((char *)"x-long-header"),
+                            FIO_BUF_INFO2(value, 300 + (i * 100)),
+                            FIO_HPACK_INDEX);
+  snprintf(expected,
+           sizeof(expected),
+           "x-long-header: %.300s\nx-long-header: %.400s\n",
+           value,
+           value);
+  {
+    hpack_reserve_s r = {.limit = 1024};
+    fio_str_info_s scratch = {0};
+    FIO_ASSERT(!fio_hpack_decode(dec,
+                                 FIO_BUF_INFO2((char *)block, len),
+                                 &scratch,
+                                 hpack_reserve_cb,
+                                 hpack_reserve_on_header,
+                                 &r),
+               "HPACK decoding should grow the scratch on demand");
+    FIO_ASSERT(r.h.count == 3 && scratch.capa >= 500 &&
+                   !memcmp(r.h.buf, expected, strlen(expected)),
+               "HPACK decoding with a growing scratch mismatch:\n%.*s",
+               (int)r.h.len,
+               r.h.buf);
+    free(scratch.buf);
+  }
+  { /* the growth limit is enforced */
+    hpack_reserve_s r = {.limit = 256};
+    fio_str_info_s scratch = {0};
+    fio_hpack_init(dec);
+    FIO_ASSERT(fio_hpack_decode(dec,
+                                FIO_BUF_INFO2((char *)block, len),
+                                &scratch,
+                                hpack_reserve_cb,
+                                hpack_reserve_on_header,
+                                &r) == -1,
+               "HPACK decoding should fail when the scratch can't grow");
+    free(scratch.buf);
+  }
+  free(enc);
+  free(dec);
+}
+
+int main(void) {
+  fprintf(stderr, "Testing HTTP/2 framing and HPACK correctness:\n");
+  test_frame_header();
+  test_huffman();
+  test_hpack_rfc_requests();
+  test_hpack_rfc_responses();
+  test_hpack_encoder();
+  test_hpack_errors();
+  test_hpack_scratch_reserve();
+  fprintf(stderr, "All HTTP/2 parser tests passed!\n");
+  return 0;
+}
@@ -0,0 +1,846 @@
+/* *****************************************************************************
+Test: HTTP/2 sessions (fio-stl/434 http2.h)
+
+Raw HTTP/2 clients (prior knowledge) talk to an in-process server over the
+loopback interface, covering SETTINGS, flow control, the stream life cycle,
+RST_STREAM (rapid reset and a reset during a file response), the receive
+window and data read along with the client's preface. HTTP/1.1 and WebSocket
+clients share the listener. Sessions run on several IO reactors, so controller
+tasks and pub/sub deliveries (WebSocket permessage-deflate subscribers) must
+reach the reactor owning the connection.
+***************************************************************************** */
+#define FIO_HTTP
+/* small limits, so they are easy to reach */
+#define FIO_HTTP2_MAX_CONCURRENT_STREAMS 8
+#define FIO_HTTP2_WINDOW                 16384
+#include "test-helpers.h"
+
+#define FIO___TEST_H2_URL       "tcp://127.0.0.1:19881"
+#define FIO___TEST_H2_WS_URL    "ws://127.0.0.1:19881/ws"
+#define FIO___TEST_H2_FILE_LEN  (16UL << 20)
+#define FIO___TEST_H2_BIG_LEN   100
+#define FIO___TEST_H2_FLOW_WIND 16
+#define FIO___TEST_H2_FILE_WIND (4UL << 20)
+#define FIO___TEST_H2_REACTORS  4
+#define FIO___TEST_H2_MAX_LINE  65536 /* the listener's max_header_size */
+#define FIO___TEST_H2_PEERS     8 /* HTTP/1.1 and WebSocket clients, each */
+#define FIO___TEST_H2_PS_MSGS   16   /* messages published to subscribers */
+#define FIO___TEST_H2_PS_LEN    2048 /* compressed (FIO_HTTP_WEBSOCKET_DEFLATE_MIN) */
+
+typedef enum {
+  FIO___TEST_H2_BASIC,
+  FIO___TEST_H2_FLOW,
+  FIO___TEST_H2_FILE_RST,
+  FIO___TEST_H2_RAPID_RESET,
+  FIO___TEST_H2_RECV_WINDOW,
+  FIO___TEST_H2_PREFACE,
+  FIO___TEST_H2_WINDOW_OVERFLOW,
+  FIO___TEST_H2_HEADER_LIMIT,
+  FIO___TEST_H2_COUNT,
+} fio___test_h2_e;
+
+/* results, collected once a client connection closed */
+typedef struct {
+  uint32_t max_streams;  /* the server's SETTINGS_MAX_CONCURRENT_STREAMS */
+  uint32_t rst_error;    /* the last RST_STREAM error code */
+  uint32_t goaway;       /* GOAWAY frames received */
+  uint32_t goaway_error; /* the last GOAWAY error code */
+  size_t refused;        /* REFUSED_STREAM resets */
+  size_t body;           /* DATA bytes received */
+  size_t bad_data;       /* DATA bytes that didn't match the expected body */
+  int64_t window;        /* the window we granted, minus the data received */
+  uint8_t settings;      /* the server's SETTINGS was received */
+  uint8_t settings_ack;  /* our SETTINGS was acknowledged */
+  uint8_t status_200;    /* a :status 200 response header was received */
+  uint8_t end_stream;    /* END_STREAM was received */
+  uint8_t ping_ack;      /* our PING was acknowledged (the test is done) */
+  uint8_t closed;
+} fio___test_h2_result_s;
+
+static struct {
+  fio___test_h2_result_s r[FIO___TEST_H2_COUNT];
+  char file_name[64];
+  size_t handlers; /* "/slow" handler calls */
+  size_t done;
+  size_t h1_done; /* HTTP/1.1 responses received */
+  size_t ws_done; /* WebSocket echoes received */
+  size_t ps_done; /* WebSocket subscribers that got every message */
+  size_t ps_ready; /* WebSocket subscribers, subscribed */
+  int file_fd;
+  int timeout;
+} fio___test_h2 = {.file_fd = -1};
+
+typedef struct {
+  fio___test_h2_result_s r;
+  fio___test_h2_e scenario;
+  uint32_t len;
+  uint8_t suspended;
+  fio_hpack_s encoder;
+  fio_hpack_s decoder;
+  char buf[FIO_HTTP2_FRAME_HEADER_LEN + FIO_HTTP2_DEFAULT_FRAME_SIZE];
+} fio___test_h2_client_s;
+
+/* *****************************************************************************
+Server
+***************************************************************************** */
+
+static void fio___test_h2_on_http(fio_http_s *h) {
+  static char big[FIO___TEST_H2_BIG_LEN];
+  fio_str_info_s path = fio_http_path(h);
+  if (FIO_BUF_INFO_IS_EQ(FIO_STR2BUF_INFO(path), FIO_BUF_INFO1("/file"))) {
+    int fd = open(fio___test_h2.file_name, O_RDONLY);
+    FIO_ASSERT(fd != -1, "couldn't open the test file");
+    fio___test_h2.file_fd = fd;
+    fio_http_write(h, .fd = fd, .len = FIO___TEST_H2_FILE_LEN, .finish = 1);
+    return;
+  }
+  if (FIO_BUF_INFO_IS_EQ(FIO_STR2BUF_INFO(path), FIO_BUF_INFO1("/big"))) {
+    for (size_t i = 0; i < sizeof(big); ++i)
+      big[i] = (char)(i % 251);
+    fio_http_write(h, .buf = big, .len = sizeof(big), .finish = 1);
+    return;
+  }
+  if (FIO_BUF_INFO_IS_EQ(FIO_STR2BUF_INFO(path), FIO_BUF_INFO1("/slow")))
+    ++fio___test_h2.handlers;
+  fio_http_write(h, .buf = "hello", .len = 5, .copy = 1, .finish = 1);
+}
+
+static void fio___test_h2_on_message(fio_http_s *h,
+                                     fio_buf_info_s msg,
+                                     uint8_t is_text) {
+  fio_http_websocket_write(h, msg.buf, msg.len, is_text);
+}
+
+/* "/pubsub" WebSockets subscribe, then tell the client they're ready */
+static void fio___test_h2_on_open(fio_http_s *h) {
+  fio_str_info_s path = fio_http_path(h);
+  if (!FIO_BUF_INFO_IS_EQ(FIO_STR2BUF_INFO(path), FIO_BUF_INFO1("/pubsub")))
+    return;
+  fio_http_subscribe(h,
+                     .channel = FIO_BUF_INFO1("h2-pubsub"),
+                     .on_message = FIO_HTTP_WEBSOCKET_SUBSCRIBE_DIRECT_TEXT);
+  fio_http_websocket_write(h, "ready", 5, 1);
+}
+
+/* *****************************************************************************
+Client helpers
+***************************************************************************** */
+
+/* stops the reactor once every client is done (called from any thread). */
+static void fio___test_h2_client_done(size_t *counter) {
+  fio_atomic_add(counter, 1);
+  if (fio_atomic_add(&fio___test_h2.done, 0) == FIO___TEST_H2_COUNT &&
+      fio_atomic_add(&fio___test_h2.h1_done, 0) == FIO___TEST_H2_PEERS &&
+      fio_atomic_add(&fio___test_h2.ws_done, 0) == FIO___TEST_H2_PEERS &&
+      fio_atomic_add(&fio___test_h2.ps_done, 0) == FIO___TEST_H2_PEERS)
+    fio_io_stop();
+}
+
+static void fio___test_h2_frame(fio_io_s *io,
+                                uint8_t type,
+                                uint8_t flags,
+                                uint32_t id,
+                                const void *payload,
+                                size_t len) {
+  char *buf = (char *)malloc(FIO_HTTP2_FRAME_HEADER_LEN + len);
+  FIO_ASSERT_ALLOC(buf);
+  fio_http2_frame_write(buf,
+                        (fio_http2_frame_s){.len = (uint32_t)len,
+                                            .stream_id = id,
+                                            .type = type,
+                                            .flags = flags});
+  if (len)
+    FIO_MEMCPY(buf + FIO_HTTP2_FRAME_HEADER_LEN, payload, len);
+  fio_io_write2(io,
+                .buf = buf,
+                .len = FIO_HTTP2_FRAME_HEADER_LEN + len,
+                .dealloc = free);
+}
+
+static void fio___test_h2_u32_frame(fio_io_s *io,
+                                    uint8_t type,
+                                    uint32_t id,
+                                    uint32_t value) {
+  char p[4];
+  fio_u2buf32_be(p, value);
+  fio___test_h2_frame(io, type, 0, id, p, 4);
+}
+
+static void fio___test_h2_settings(fio_io_s *io, uint16_t id, uint32_t value) {
+  char p[6];
+  fio_u2buf16_be(p, id);
+  fio_u2buf32_be(p + 2, value);
+  fio___test_h2_frame(io, FIO_HTTP2_FRAME_SETTINGS, 0, 0, p, id ? 6 : 0);
+}
+
+static void fio___test_h2_ping(fio_io_s *io) {
+  fio___test_h2_frame(io, FIO_HTTP2_FRAME_PING, 0, 0, "fio-ping", 8);
+}
+
+static void fio___test_h2_request(fio___test_h2_client_s *c,
+                                  fio_io_s *io,
+                                  uint32_t id,
+                                  const char *method,
+                                  const char *path,
+                                  int end_stream) {
+  const char *fields[4][2] = {{":method", method},
+                              {":scheme", "http"},
+                              {":path", path},
+                              {":authority", "localhost"}};
+  char block[256];
+  size_t len = 0;
+  for (size_t i = 0; i < 4; ++i)
+    len += fio_hpack_encode(&c->encoder,
+                            block + len,
+                            FIO_BUF_INFO1((char *)fields[i][0]),
+                            FIO_BUF_INFO1((char *)fields[i][1]),
+                            FIO_HPACK_INDEX);
+  fio___test_h2_frame(io,
+                      FIO_HTTP2_FRAME_HEADERS,
+                      (uint8_t)(FIO_HTTP2_FLAG_END_HEADERS |
+                                (end_stream ? FIO_HTTP2_FLAG_END_STREAM : 0)),
+                      id,
+                      block,
+                      len);
+}
+
+/* a GET request with a Huffman encoded `x-big` header of `len` bytes */
+static void fio___test_h2_big_request(fio___test_h2_client_s *c,
+                                      fio_io_s *io,
+                                      uint32_t id,
+                                      size_t len) {
+  const char *fields[4][2] = {{":method", "GET"},
+                              {":scheme", "http"},
+                              {":path", "/"},
+                              {":authority", "localhost"}};
+  char *value = (char *)malloc(len);
+  char *block = (char *)malloc(256 + FIO_HPACK_ENCODE_BOUND(5, len));
+  FIO_ASSERT_ALLOC(value);
+  FIO_ASSERT_ALLOC(block);
+  FIO_MEMSET(value, 'a', len);
+  size_t blen = 0;
+  for (size_t i = 0; i < 4; ++i)
+    blen += fio_hpack_encode(&c->encoder,
+                             block + blen,
+                             FIO_BUF_INFO1((char *)fields[i][0]),
+                             FIO_BUF_INFO1((char *)fields[i][1]),
+                             FIO_HPACK_INDEX);
+  blen += fio_hpack_encode(&c->encoder,
+                           block + blen,
+                           FIO_BUF_INFO1((char *)"x-big"),
+                           FIO_BUF_INFO2(value, len),
+                           FIO_HPACK_NO_INDEX);
+  for (size_t pos = 0; pos < blen; pos += FIO_HTTP2_DEFAULT_FRAME_SIZE) {
+    size_t chunk = blen - pos;
+    uint8_t flags = (pos ? 0 : FIO_HTTP2_FLAG_END_STREAM);
+    if (chunk > FIO_HTTP2_DEFAULT_FRAME_SIZE)
+      chunk = FIO_HTTP2_DEFAULT_FRAME_SIZE;
+    else
+      flags |= FIO_HTTP2_FLAG_END_HEADERS;
+    fio___test_h2_frame(io,
+                        (pos ? FIO_HTTP2_FRAME_CONTINUATION
+                             : FIO_HTTP2_FRAME_HEADERS),
+                        flags,
+                        id,
+                        block + pos,
+                        chunk);
+  }
+  free(block);
+  free(value);
+}
+
+static int fio___test_h2_on_header(fio_buf_info_s name,
+                                   fio_buf_info_s value,
+                                   void *c_) {
+  fio___test_h2_client_s *c = (fio___test_h2_client_s *)c_;
+  if (FIO_BUF_INFO_IS_EQ(name, FIO_BUF_INFO1(":status")) &&
+      FIO_BUF_INFO_IS_EQ(value, FIO_BUF_INFO1("200")))
+    c->r.status_200 = 1;
+  return 0;
+}
+
+static int fio___test_h2_unsuspend(void *io_, void *ignr_) {
+  fio___test_h2_client_s *c =
+      (fio___test_h2_client_s *)fio_io_udata((fio_io_s *)io_);
+  c->suspended = 0;
+  fio_io_unsuspend((fio_io_s *)io_);
+  fio_io_free((fio_io_s *)io_);
+  return -1;
+  (void)ignr_;
+}
+
+/* *****************************************************************************
+Client scenarios
+***************************************************************************** */
+
+static void fio___test_h2_on_attach(fio_io_s *io) {
+  fio___test_h2_client_s *c = (fio___test_h2_client_s *)fio_io_udata(io);
+  fio_io_write2(io,
+                .buf = (void *)FIO_HTTP2_PREFACE,
+                .len = FIO_HTTP2_PREFACE_LEN,
+                .copy = 1);
+  switch (c->scenario) {
+  case FIO___TEST_H2_BASIC:
+    fio___test_h2_settings(io, 0, 0);
+    c->r.window = FIO_HTTP2_DEFAULT_WINDOW;
+    fio___test_h2_request(c, io, 1, "GET", "/", 1);
+    return;
+  case FIO___TEST_H2_FLOW: /* the server must wait for WINDOW_UPDATE */
+    fio___test_h2_settings(io,
+                           FIO_HTTP2_SETTINGS_INITIAL_WINDOW_SIZE,
+                           FIO___TEST_H2_FLOW_WIND);
+    c->r.window = FIO___TEST_H2_FLOW_WIND;
+    fio___test_h2_request(c, io, 1, "GET", "/big", 1);
+    return;
+  case FIO___TEST_H2_FILE_RST: /* the file waits for flow control */
+    fio___test_h2_settings(io,
+                           FIO_HTTP2_SETTINGS_INITIAL_WINDOW_SIZE,
+                           FIO___TEST_H2_FILE_WIND);
+    fio___test_h2_u32_frame(io,
+                            FIO_HTTP2_FRAME_WINDOW_UPDATE,
+                            0,
+                            FIO___TEST_H2_FILE_WIND - FIO_HTTP2_DEFAULT_WINDOW);
+    c->r.window = FIO___TEST_H2_FILE_WIND;
+    fio___test_h2_request(c, io, 1, "GET", "/file", 1);
+    return;
+  case FIO___TEST_H2_RAPID_RESET: /* streams are reset as soon as opened */
+    fio___test_h2_settings(io, 0, 0);
+    for (uint32_t i = 0; i < FIO_HTTP2_MAX_CONCURRENT_STREAMS * 3; ++i) {
+      fio___test_h2_request(c, io, (i << 1) + 1, "GET", "/slow", 1);
+      fio___test_h2_u32_frame(io,
+                              FIO_HTTP2_FRAME_RST_STREAM,
+                              (i << 1) + 1,
+                              FIO_HTTP2_CANCEL);
+    }
+    fio___test_h2_ping(io);
+    return;
+  case FIO___TEST_H2_RECV_WINDOW: /* waits for the server's SETTINGS */
+    fio___test_h2_settings(io, 0, 0);
+    return;
+  case FIO___TEST_H2_PREFACE: { /* more than a frame's worth of data */
+    char *pad = (char *)calloc(1, FIO_HTTP2_DEFAULT_FRAME_SIZE);
+    FIO_ASSERT_ALLOC(pad);
+    fio___test_h2_settings(io, 0, 0);
+    for (size_t i = 0; i < 3; ++i) /* unknown frame types are ignored */
+      fio___test_h2_frame(io, 0xFA, 0, 0, pad, FIO_HTTP2_DEFAULT_FRAME_SIZE);
+    fio___test_h2_ping(io);
+    free(pad);
+    return;
+  }
+  case FIO___TEST_H2_WINDOW_OVERFLOW: /* a SETTINGS delta overflows a stream */
+    fio___test_h2_settings(io, 0, 0);
+    fio___test_h2_request(c, io, 1, "POST", "/upload", 0);
+    fio___test_h2_u32_frame(io,
+                            FIO_HTTP2_FRAME_WINDOW_UPDATE,
+                            1,
+                            FIO_HTTP2_MAX_WINDOW - FIO_HTTP2_DEFAULT_WINDOW);
+    fio___test_h2_settings(io,
+                           FIO_HTTP2_SETTINGS_INITIAL_WINDOW_SIZE,
+                           FIO_HTTP2_DEFAULT_WINDOW + 1);
+    return;
+  case FIO___TEST_H2_HEADER_LIMIT: /* HPACK scratch grows up to the limit */
+    fio___test_h2_settings(io, 0, 0);
+    fio___test_h2_big_request(c, io, 1, 20000);
+    return;
+  case FIO___TEST_H2_COUNT: return;
+  }
+}
+
+static void fio___test_h2_on_frame(fio___test_h2_client_s *c,
+                                   fio_io_s *io,
+                                   fio_http2_frame_s f,
+                                   char *p) {
+  switch (f.type) {
+  case FIO_HTTP2_FRAME_SETTINGS:
+    if ((f.flags & FIO_HTTP2_FLAG_ACK)) {
+      c->r.settings_ack = 1;
+      return;
+    }
+    c->r.settings = 1;
+    for (size_t i = 0; i + 6 <= f.len; i += 6)
+      if (fio_buf2u16_be(p + i) == FIO_HTTP2_SETTINGS_MAX_CONCURRENT_STREAMS)
+        c->r.max_streams = fio_buf2u32_be(p + i + 2);
+    fio___test_h2_frame(io,
+                        FIO_HTTP2_FRAME_SETTINGS,
+                        FIO_HTTP2_FLAG_ACK,
+                        0,
+                        NULL,
+                        0);
+    if (c->scenario == FIO___TEST_H2_RECV_WINDOW) {
+      /* the stream's window (once acknowledged) is FIO_HTTP2_WINDOW */
+      char *body = (char *)calloc(1, FIO_HTTP2_WINDOW);
+      FIO_ASSERT_ALLOC(body);
+      fio___test_h2_request(c, io, 1, "POST", "/upload", 0);
+      fio___test_h2_frame(io, FIO_HTTP2_FRAME_DATA, 0, 1, body, 1);
+      fio___test_h2_frame(io, FIO_HTTP2_FRAME_DATA, 0, 1, body, FIO_HTTP2_WINDOW);
+      fio___test_h2_ping(io);
+      free(body);
+    }
+    return;
+  case FIO_HTTP2_FRAME_HEADERS: {
+    char scratch[1024];
+    fio_str_info_s buf = FIO_STR_INFO3(scratch, 0, sizeof(scratch));
+    FIO_ASSERT(!fio_hpack_decode(&c->decoder,
+                                 FIO_BUF_INFO2(p, f.len),
+                                 &buf,
+                                 NULL,
+                                 fio___test_h2_on_header,
+                                 c),
+               "response headers should be valid HPACK");
+    c->r.end_stream |= !!(f.flags & FIO_HTTP2_FLAG_END_STREAM);
+    if (c->scenario == FIO___TEST_H2_HEADER_LIMIT && f.stream_id == 1)
+      fio___test_h2_big_request(c, io, 3, FIO___TEST_H2_MAX_LINE + 1024);
+    return;
+  }
+  case FIO_HTTP2_FRAME_DATA:
+    if (c->scenario == FIO___TEST_H2_BASIC) /* may end with an empty frame */
+      c->r.bad_data += (c->r.body + f.len > 5 ||
+                        FIO_MEMCMP(p, "hello" + c->r.body, f.len));
+    else
+      for (size_t i = 0; i < f.len; ++i)
+        c->r.bad_data += (p[i] != (char)((c->r.body + i) % 251));
+    c->r.body += f.len;
+    c->r.window -= (int64_t)f.len;
+    c->r.end_stream |= !!(f.flags & FIO_HTTP2_FLAG_END_STREAM);
+    if (c->scenario == FIO___TEST_H2_FLOW && !c->r.window &&
+        c->r.body < FIO___TEST_H2_BIG_LEN) {
+      const uint32_t inc = FIO___TEST_H2_BIG_LEN - FIO___TEST_H2_FLOW_WIND;
+      fio___test_h2_u32_frame(io, FIO_HTTP2_FRAME_WINDOW_UPDATE, 1, inc);
+      c->r.window += inc;
+    }
+    if (c->scenario == FIO___TEST_H2_FILE_RST && c->r.body == f.len) {
+      /* reset while the rest of the file is queued, then stop reading */
+      fio___test_h2_u32_frame(io, FIO_HTTP2_FRAME_RST_STREAM, 1, FIO_HTTP2_CANCEL);
+      fio___test_h2_ping(io);
+      c->suspended = 1;
+      fio_io_suspend(io);
+      fio_timer_free(fio_io_run_every(.fn = fio___test_h2_unsuspend,
+                                      .udata1 = fio_io_dup(io),
+                                      .every = 100,
+                                      .repetitions = 1));
+    }
+    if (c->scenario <= FIO___TEST_H2_FLOW && c->r.end_stream)
+      fio_io_close(io);
+    return;
+  case FIO_HTTP2_FRAME_RST_STREAM:
+    c->r.rst_error = fio_buf2u32_be(p);
+    c->r.refused += (c->r.rst_error == FIO_HTTP2_REFUSED_STREAM);
+    return;
+  case FIO_HTTP2_FRAME_PING:
+    if (!(f.flags & FIO_HTTP2_FLAG_ACK))
+      return;
+    FIO_ASSERT(f.len == 8 && !FIO_MEMCMP(p, "fio-ping", 8),
+               "PING payload should be echoed");
+    c->r.ping_ack = 1;
+    fio_io_close(io);
+    return;
+  case FIO_HTTP2_FRAME_GOAWAY:
+    ++c->r.goaway;
+    c->r.goaway_error = fio_buf2u32_be(p + 4);
+    return;
+  }
+}
+
+static void fio___test_h2_on_data(fio_io_s *io) {
+  fio___test_h2_client_s *c = (fio___test_h2_client_s *)fio_io_udata(io);
+  size_t r;
+  while (!c->suspended &&
+         (r = fio_io_read(io, c->buf + c->len, sizeof(c->buf) - c->len))) {
+    uint32_t pos = 0;
+    c->len += (uint32_t)r;
+    while (c->len - pos >= FIO_HTTP2_FRAME_HEADER_LEN) {
+      fio_http2_frame_s f = fio_http2_frame_read(c->buf + pos);
+      FIO_ASSERT(f.len <= FIO_HTTP2_DEFAULT_FRAME_SIZE,
+                 "server frames should respect SETTINGS_MAX_FRAME_SIZE");
+      if (c->len - pos < FIO_HTTP2_FRAME_HEADER_LEN + f.len)
+        break;
+      fio___test_h2_on_frame(c, io, f, c->buf + pos + FIO_HTTP2_FRAME_HEADER_LEN);
+      pos += FIO_HTTP2_FRAME_HEADER_LEN + f.len;
+    }
+    c->len -= pos;
+    if (pos && c->len)
+      FIO_MEMMOVE(c->buf, c->buf + pos, c->len);
+  }
+}
+
+static void fio___test_h2_on_close(void *buf, void *c_) {
+  fio___test_h2_client_s *c = (fio___test_h2_client_s *)c_;
+  c->r.closed = 1;
+  fio___test_h2.r[c->scenario] = c->r;
+  free(c);
+  fio___test_h2_client_done(&fio___test_h2.done);
+  (void)buf;
+}
+
+static fio_io_protocol_s fio___test_h2_client_protocol = {
+    .on_attach = fio___test_h2_on_attach,
+    .on_data = fio___test_h2_on_data,
+    .on_close = fio___test_h2_on_close,
+    .on_timeout = fio_io_touch,
+};
+
+static void fio___test_h2_on_failed(fio_io_protocol_s *p, void *c_) {
+  fio___test_h2_on_close(NULL, c_);
+  (void)p;
+}
+
+/* HTTP/1.1 client: the response to `GET /` */
+static void fio___test_h2_h1_on_response(fio_http_s *h) {
+  fio_str_info_s body = fio_http_body_read(h, (size_t)-1);
+  FIO_ASSERT(fio_http_status(h) == 200 && body.len == 5 &&
+                 !FIO_MEMCMP(body.buf, "hello", 5),
+             "HTTP/1.1 clients should get a complete response (%zu bytes)",
+             body.len);
+  fio___test_h2_client_done(&fio___test_h2.h1_done);
+}
+
+/* WebSocket client: sends a message and waits for the echo */
+static void fio___test_h2_ws_on_open(fio_http_s *h) {
+  fio_http_websocket_write(h, "echo", 4, 1);
+}
+
+static void fio___test_h2_ws_on_message(fio_http_s *h,
+                                        fio_buf_info_s msg,
+                                        uint8_t is_text) {
+  FIO_ASSERT(is_text && FIO_BUF_INFO_IS_EQ(msg, FIO_BUF_INFO1("echo")),
+             "WebSocket clients should get their message back");
+  fio___test_h2_client_done(&fio___test_h2.ws_done);
+  fio_http_close(h);
+}
+
+/* *****************************************************************************
+WebSocket subscribers (raw clients, negotiating permessage-deflate)
+***************************************************************************** */
+
+typedef struct {
+  fio_deflate_s *rd;
+  size_t len;
+  size_t msgs;
+  uint8_t upgraded;
+  char buf[8192];
+} fio___test_h2_ps_client_s;
+
+/* message `k`: a compressible text of FIO___TEST_H2_PS_LEN bytes */
+static void fio___test_h2_ps_message(char *dest, size_t k) {
+  for (size_t i = 0; i < FIO___TEST_H2_PS_LEN; ++i)
+    dest[i] = (char)('a' + ((i / 16) + k) % 26);
+}
+
+static void fio___test_h2_ps_publish(void) {
+  char msg[FIO___TEST_H2_PS_LEN];
+  for (size_t k = 0; k < FIO___TEST_H2_PS_MSGS; ++k) {
+    fio___test_h2_ps_message(msg, k);
+    fio_pubsub_publish(.channel = FIO_BUF_INFO1("h2-pubsub"),
+                       .message = FIO_BUF_INFO2(msg, sizeof(msg)));
+  }
+}
+
+/* returns the position of `str` in `buf`, or `len` if missing */
+static size_t fio___test_h2_find(const char *buf,
+                                 size_t len,
+                                 const char *str,
+                                 size_t str_len) {
+  for (size_t i = 0; i + str_len <= len; ++i)
+    if (!FIO_MEMCMP(buf + i, str, str_len))
+      return i;
+  return len;
+}
+
+static void fio___test_h2_ps_on_attach(fio_io_s *io) {
+  static const char req[] = "GET /pubsub HTTP/1.1\r\n"
+                            "Host: 127.0.0.1\r\n"
+                            "Upgrade: websocket\r\n"
+                            "Connection: Upgrade\r\n"
+                            "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                            "Sec-WebSocket-Version: 13\r\n"
+                            "Sec-WebSocket-Extensions: permessage-deflate\r\n"
+                            "\r\n";
+  fio_io_write2(io, .buf = (void *)req, .len = sizeof(req) - 1, .copy = 1);
+}
+
+/* handles a server frame, returns its length or 0 if incomplete */
+static size_t fio___test_h2_ps_frame(fio___test_h2_ps_client_s *c,
+                                     fio_io_s *io,
+                                     uint8_t *f,
+                                     size_t len) {
+  size_t hdr = 2, plen;
+  if (len < 2)
+    return 0;
+  plen = f[1] & 127;
+  FIO_ASSERT(!(f[1] & 128) && plen < 127, "unexpected server frame");
+  if (plen == 126) {
+    if (len < 4)
+      return 0;
+    plen = ((size_t)f[2] << 8) | f[3];
+    hdr = 4;
+  }
+  if (len < hdr + plen)
+    return 0;
+  FIO_ASSERT((f[0] & 0x8F) == 0x81, "subscribers should get text frames");
+  if (!(f[0] & 0x40)) { /* uncompressed: "ready" */
+    FIO_ASSERT(plen == 5 && !FIO_MEMCMP(f + hdr, "ready", 5),
+               "short frames should be sent uncompressed");
+    if (fio_atomic_add_fetch(&fio___test_h2.ps_ready, 1) == FIO___TEST_H2_PEERS)
+      fio___test_h2_ps_publish();
+    return hdr + plen;
+  }
+  char out[FIO___TEST_H2_PS_LEN + 64], expected[FIO___TEST_H2_PS_LEN];
+  size_t r = fio_deflate_push(c->rd, out, sizeof(out), f + hdr, plen, 1);
+  fio_deflate_destroy(c->rd);
+  fio___test_h2_ps_message(expected, c->msgs);
+  FIO_ASSERT(r == FIO___TEST_H2_PS_LEN && !FIO_MEMCMP(out, expected, r),
+             "published message %zu should inflate intact (%zu bytes)",
+             c->msgs,
+             r);
+  if (++c->msgs == FIO___TEST_H2_PS_MSGS) {
+    fio___test_h2_client_done(&fio___test_h2.ps_done);
+    fio_io_close(io);
+  }
+  return hdr + plen;
+}
+
+static void fio___test_h2_ps_on_data(fio_io_s *io) {
+  fio___test_h2_ps_client_s *c = (fio___test_h2_ps_client_s *)fio_io_udata(io);
+  size_t r;
+  while ((r = fio_io_read(io, c->buf + c->len, sizeof(c->buf) - c->len))) {
+    size_t pos = 0, consumed;
+    c->len += r;
+    if (!c->upgraded) {
+      pos = fio___test_h2_find(c->buf, c->len, "\r\n\r\n", 4);
+      if (pos == c->len)
+        continue;
+      pos += 4;
+      FIO_ASSERT(!FIO_MEMCMP(c->buf, "HTTP/1.1 101", 12) &&
+                     fio___test_h2_find(c->buf, pos, "permessage-deflate", 18) <
+                         pos,
+                 "subscribers should negotiate permessage-deflate");
+      c->upgraded = 1;
+    }
+    while ((consumed = fio___test_h2_ps_frame(c,
+                                              io,
+                                              (uint8_t *)c->buf + pos,
+                                              c->len - pos)))
+      pos += consumed;
+    c->len -= pos;
+    if (pos && c->len)
+      FIO_MEMMOVE(c->buf, c->buf + pos, c->len);
+  }
+}
+
+static void fio___test_h2_ps_on_close(void *buf, void *c_) {
+  fio___test_h2_ps_client_s *c = (fio___test_h2_ps_client_s *)c_;
+  fio_deflate_free(c->rd);
+  free(c);
+  (void)buf;
+}
+
+static fio_io_protocol_s fio___test_h2_ps_protocol = {
+    .on_attach = fio___test_h2_ps_on_attach,
+    .on_data = fio___test_h2_ps_on_data,
+    .on_close = fio___test_h2_ps_on_close,
+    .on_timeout = fio_io_touch,
+};
+
+static void fio___test_h2_ps_on_failed(fio_io_protocol_s *p, void *c_) {
+  fio___test_h2_ps_on_close(NULL, c_);
+  (void)p;
+}
+
+static int fio___test_h2_connect(void *u1, void *u2) {
+  for (size_t i = 0; i < FIO___TEST_H2_PEERS; ++i) {
+    fio_http_connect(FIO___TEST_H2_URL,
+                     NULL,
+                     .on_http = fio___test_h2_h1_on_response,
+                     .log = 0);
+    fio_http_websocket_connect(FIO___TEST_H2_WS_URL,
+                               NULL,
+                               .on_open = fio___test_h2_ws_on_open,
+                               .on_message = fio___test_h2_ws_on_message,
+                               .log = 0);
+    fio___test_h2_ps_client_s *ps =
+        (fio___test_h2_ps_client_s *)calloc(1, sizeof(*ps));
+    FIO_ASSERT_ALLOC(ps);
+    ps->rd = fio_deflate_new(1, 0);
+    FIO_ASSERT_ALLOC(ps->rd);
+    fio_io_connect(FIO___TEST_H2_URL,
+                   .protocol = &fio___test_h2_ps_protocol,
+                   .on_failed = fio___test_h2_ps_on_failed,
+                   .udata = ps,
+                   .timeout = 5000);
+  }
+  for (size_t i = 0; i < FIO___TEST_H2_COUNT; ++i) {
+    fio___test_h2_client_s *c =
+        (fio___test_h2_client_s *)calloc(1, sizeof(*c));
+    FIO_ASSERT_ALLOC(c);
+    c->scenario = (fio___test_h2_e)i;
+    fio_hpack_init(&c->encoder);
+    fio_hpack_init(&c->decoder);
+    fio_io_connect(FIO___TEST_H2_URL,
+                   .protocol = &fio___test_h2_client_protocol,
+                   .on_failed = fio___test_h2_on_failed,
+                   .udata = c,
+                   .timeout = 5000);
+  }
+  return -1;
+  (void)u1, (void)u2;
+}
+
+static int fio___test_h2_timeout(void *u1, void *u2) {
+  fio___test_h2.timeout = 1;
+  fio_io_stop();
+  return -1;
+  (void)u1, (void)u2;
+}
+
+/* *****************************************************************************
+Test
+***************************************************************************** */
+
+static void test_http2_sessions(void) {
+#if !FIO_OS_POSIX
+  fprintf(stderr, "* HTTP/2 session tests skipped (POSIX only).\n");
+  return;
+#else
+  { /* the file body: byte `i` is `i % 251` */
+    char *data = (char *)malloc(FIO___TEST_H2_FILE_LEN);
+    FIO_ASSERT_ALLOC(data);
+    for (size_t i = 0; i < FIO___TEST_H2_FILE_LEN; ++i)
+      data[i] = (char)(i % 251);
+    snprintf(fio___test_h2.file_name,
+             sizeof(fio___test_h2.file_name),
+             "/tmp/fio-test-http2-%d",
+             (int)getpid());
+    int fd = open(fio___test_h2.file_name, O_CREAT | O_TRUNC | O_WRONLY, 0600);
+    FIO_ASSERT(fd != -1, "couldn't create the test file");
+    FIO_ASSERT(write(fd, data, FIO___TEST_H2_FILE_LEN) ==
+                   (ssize_t)FIO___TEST_H2_FILE_LEN,
+               "couldn't write the test file");
+    close(fd);
+    free(data);
+  }
+  fio_http_listener_s *l = fio_http_listen(FIO___TEST_H2_URL,
+                                           .on_http = fio___test_h2_on_http,
+                                           .on_authenticate_websocket =
+                                               FIO_HTTP_AUTHENTICATE_ALLOW,
+                                           .on_open = fio___test_h2_on_open,
+                                           .on_message =
+                                               fio___test_h2_on_message,
+                                           .max_line_len =
+                                               FIO___TEST_H2_MAX_LINE,
+                                           .compress_ws = 1,
+                                           .log = 0);
+  FIO_ASSERT(l, "HTTP/2 test listener failed");
+  fio_timer_free(fio_io_run_every(.fn = fio___test_h2_connect,
+                                  .every = 10,
+                                  .repetitions = 1));
+  fio_timer_free(fio_io_run_every(.fn = fio___test_h2_timeout,
+                                  .every = 10000,
+                                  .repetitions = 1));
+  fio_io_reactors_set(FIO___TEST_H2_REACTORS);
+  fio_io_start(0);
+  fio_io_listen_stop((fio_io_listener_s *)l);
+  fio_queue_perform_all(fio_io_queue());
+  fio_io_reactors_set(1);
+  unlink(fio___test_h2.file_name);
+  FIO_ASSERT(!fio___test_h2.timeout,
+             "HTTP/2 session tests timed out "
+             "(%zu/%d done, %zu / %zu / %zu peers)",
+             fio___test_h2.done,
+             (int)FIO___TEST_H2_COUNT,
+             fio___test_h2.h1_done,
+             fio___test_h2.ws_done,
+             fio___test_h2.ps_done);
+
+  fio___test_h2_result_s *r = fio___test_h2.r + FIO___TEST_H2_BASIC;
+  FIO_ASSERT(r->settings && r->settings_ack,
+             "SETTINGS should be sent and acknowledged");
+  FIO_ASSERT(r->max_streams == FIO_HTTP2_MAX_CONCURRENT_STREAMS,
+             "SETTINGS_MAX_CONCURRENT_STREAMS should be advertised (%u)",
+             (unsigned)r->max_streams);
+  FIO_ASSERT(r->status_200 && r->end_stream && r->body == 5 && !r->bad_data,
+             "a GET request should get a complete response");
+  fprintf(stderr, "* HTTP/2 SETTINGS and stream life cycle: OK\n");
+
+  r = fio___test_h2.r + FIO___TEST_H2_FLOW;
+  FIO_ASSERT(r->window >= 0,
+             "DATA should never exceed the stream's window (%lld)",
+             (long long)r->window);
+  FIO_ASSERT(r->end_stream && r->body == FIO___TEST_H2_BIG_LEN && !r->bad_data,
+             "the body should complete after a WINDOW_UPDATE (%zu bytes)",
+             r->body);
+  fprintf(stderr, "* HTTP/2 send flow control: OK\n");
+
+  r = fio___test_h2.r + FIO___TEST_H2_FILE_RST;
+  FIO_ASSERT(r->ping_ack && !r->goaway,
+             "the connection should survive a reset during a file response");
+  FIO_ASSERT(r->body == FIO___TEST_H2_FILE_WIND && !r->bad_data,
+             "data queued before the reset should be sent intact "
+             "(%zu bytes, %zu bad)",
+             r->body,
+             r->bad_data);
+  FIO_ASSERT(fio___test_h2.file_fd != -1 &&
+                 fcntl(fio___test_h2.file_fd, F_GETFD) == -1,
+             "the response's file should be closed");
+  fprintf(stderr, "* HTTP/2 reset during a file response: OK\n");
+
+  r = fio___test_h2.r + FIO___TEST_H2_RAPID_RESET;
+  FIO_ASSERT(r->ping_ack && !r->goaway, "rapid reset test didn't complete");
+  FIO_ASSERT(fio___test_h2.handlers <= FIO_HTTP2_MAX_CONCURRENT_STREAMS,
+             "reset streams should count until their handler ran (%zu)",
+             fio___test_h2.handlers);
+  FIO_ASSERT(r->refused >= FIO_HTTP2_MAX_CONCURRENT_STREAMS * 2,
+             "streams beyond the limit should be refused (%zu)",
+             r->refused);
+  fprintf(stderr, "* HTTP/2 rapid reset limit: OK\n");
+
+  r = fio___test_h2.r + FIO___TEST_H2_RECV_WINDOW;
+  FIO_ASSERT(r->ping_ack && !r->goaway, "receive window test didn't complete");
+  FIO_ASSERT(r->rst_error == FIO_HTTP2_FLOW_CONTROL_ERROR,
+             "DATA beyond the stream's window should reset the stream (%u)",
+             (unsigned)r->rst_error);
+  fprintf(stderr, "* HTTP/2 receive window: OK\n");
+
+  r = fio___test_h2.r + FIO___TEST_H2_PREFACE;
+  FIO_ASSERT(r->ping_ack && !r->goaway,
+             "data read with the preface should be processed");
+  fprintf(stderr, "* HTTP/2 data read with the preface: OK\n");
+
+  r = fio___test_h2.r + FIO___TEST_H2_WINDOW_OVERFLOW;
+  FIO_ASSERT(r->goaway && r->goaway_error == FIO_HTTP2_FLOW_CONTROL_ERROR,
+             "a SETTINGS_INITIAL_WINDOW_SIZE overflowing a stream's window "
+             "should be a FLOW_CONTROL_ERROR (%u)",
+             (unsigned)r->goaway_error);
+  fprintf(stderr, "* HTTP/2 SETTINGS window overflow: OK\n");
+
+  r = fio___test_h2.r + FIO___TEST_H2_HEADER_LIMIT;
+  FIO_ASSERT(r->status_200,
+             "a large Huffman encoded header should grow the HPACK scratch");
+  FIO_ASSERT(r->goaway && r->goaway_error == FIO_HTTP2_ENHANCE_YOUR_CALM,
+             "a header field above SETTINGS_MAX_HEADER_LIST_SIZE should be "
+             "refused (%u)",
+             (unsigned)r->goaway_error);
+  fprintf(stderr, "* HTTP/2 HPACK scratch limit: OK\n");
+
+  FIO_ASSERT(fio___test_h2.h1_done == FIO___TEST_H2_PEERS &&
+                 fio___test_h2.ws_done == FIO___TEST_H2_PEERS,
+             "HTTP/1.1 and WebSocket clients should complete (%zu, %zu)",
+             fio___test_h2.h1_done,
+             fio___test_h2.ws_done);
+  fprintf(stderr,
+          "* HTTP/1.1 and WebSocket clients on %d reactors: OK\n",
+          (int)FIO___TEST_H2_REACTORS);
+  FIO_ASSERT(fio___test_h2.ps_done == FIO___TEST_H2_PEERS,
+             "WebSocket subscribers should get every message (%zu)",
+             fio___test_h2.ps_done);
+  fprintf(stderr,
+          "* WebSocket (permessage-deflate) pub/sub on %d reactors: OK\n",
+          (int)FIO___TEST_H2_REACTORS);
+#endif
+}
+
+int main(void) {
+  fprintf(stderr, "Testing HTTP/2 sessions:\n");
+  test_http2_sessions();
+  fprintf(stderr, "\nAll HTTP/2 session tests passed!\n");
+  return 0;
+}
@@ -391,6 +391,10 @@ static void test_io_default_functions(void) {
              "default functions should set build_context");
   FIO_ASSERT(d.read != NULL, "default functions should set read");
   FIO_ASSERT(d.write != NULL, "default functions should set write");
+  FIO_ASSERT(d.writev != NULL,
+             "default functions should set writev (default write)");
+  FIO_ASSERT(d.sendfile != NULL,
+             "default functions should set sendfile (default write)");
   FIO_ASSERT(d.flush != NULL, "default functions should set flush");
   FIO_ASSERT(d.finish != NULL, "default functions should set finish");
   FIO_ASSERT(d.cleanup != NULL, "default functions should set cleanup");
@@ -819,18 +823,18 @@ static void fio___test_io_on_start(void *ignr_) {
   fio_io_defer(fio___test_io_start_listen_task, NULL, NULL);
   fio_io_defer(fio___test_io_start_late_failure_task, NULL, NULL);
 
-  fio_io_run_every(.fn = fio___test_io_check_pair_task,
-                   .every = 20,
-                   .repetitions = -1);
-  fio_io_run_every(.fn = fio___test_io_check_done_task,
-                   .every = 20,
-                   .repetitions = -1);
-  fio_io_run_every(.fn = fio___test_io_timer_cb,
-                   .every = 10,
-                   .repetitions = -1);
-  fio_io_run_every(.fn = fio___test_io_timeout_cb,
-                   .every = 7000,
-                   .repetitions = 1);
+  fio_timer_free(fio_io_run_every(.fn = fio___test_io_check_pair_task,
+                                  .every = 20,
+                                  .repetitions = -1));
+  fio_timer_free(fio_io_run_every(.fn = fio___test_io_check_done_task,
+                                  .every = 20,
+                                  .repetitions = -1));
+  fio_timer_free(fio_io_run_every(.fn = fio___test_io_timer_cb,
+                                  .every = 10,
+                                  .repetitions = -1));
+  fio_timer_free(fio_io_run_every(.fn = fio___test_io_timeout_cb,
+                                  .every = 7000,
+                                  .repetitions = 1));
 }
 
 /* *****************************************************************************
@@ -961,11 +965,337 @@ static void test_io_integration(void) {
 #endif
 }
 
+/* *****************************************************************************
+Deferring from non-IO threads (lock-free inbox)
+***************************************************************************** */
+#define FIO___TEST_IO_DEFER_THREADS 4
+#define FIO___TEST_IO_DEFER_TASKS   4096
+
+static volatile size_t fio___test_io_defer_mt_count = 0;
+static volatile size_t fio___test_io_defer_mt_order = 0;
+static volatile int fio___test_io_defer_mt_timeout = 0;
+static fio_thread_t fio___test_io_defer_mt_threads[FIO___TEST_IO_DEFER_THREADS];
+
+static void fio___test_io_defer_mt_task(void *tid_, void *i_) {
+  static size_t last[FIO___TEST_IO_DEFER_THREADS];
+  const size_t tid = (size_t)(uintptr_t)tid_;
+  const size_t i = (size_t)(uintptr_t)i_;
+  FIO___IO_ASSERT_IO_THREAD();
+  /* tasks from the same producer must run in the order they were deferred */
+  if (i && last[tid] + 1 != i)
+    ++fio___test_io_defer_mt_order;
+  last[tid] = i;
+  if (++fio___test_io_defer_mt_count ==
+      FIO___TEST_IO_DEFER_THREADS * FIO___TEST_IO_DEFER_TASKS)
+    fio_io_stop();
+}
+
+static void *fio___test_io_defer_mt_producer(void *tid) {
+  for (size_t i = 0; i < FIO___TEST_IO_DEFER_TASKS; ++i) {
+    fio_io_defer(fio___test_io_defer_mt_task, tid, (void *)(uintptr_t)i);
+    if (!(i & 255))
+      FIO_THREAD_RESCHEDULE();
+  }
+  return NULL;
+}
+
+static int fio___test_io_defer_mt_timeout_cb(void *u1, void *u2) {
+  fio___test_io_defer_mt_timeout = 1;
+  fio_io_stop();
+  return -1;
+  (void)u1, (void)u2;
+}
+
+static void fio___test_io_defer_mt_on_start(void *ignr_) {
+  for (size_t i = 0; i < FIO___TEST_IO_DEFER_THREADS; ++i)
+    FIO_ASSERT(!fio_thread_create(fio___test_io_defer_mt_threads + i,
+                                  fio___test_io_defer_mt_producer,
+                                  (void *)(uintptr_t)i),
+               "couldn't spawn producer thread");
+  fio_timer_free(fio_io_run_every(.fn = fio___test_io_defer_mt_timeout_cb,
+                                  .every = 7000,
+                                  .repetitions = 1));
+  (void)ignr_;
+}
+
+static void test_io_inbox_pool(void) {
+  const size_t count = FIO_IO_INBOX_POOL + 16;
+  fio___io_inbox_s *inbox = NULL;
+  fio_queue_s q;
+  fio_queue_init(&q);
+  for (size_t round = 0; round < 2; ++round) {
+    for (size_t i = 0; i < count; ++i)
+      FIO_ASSERT(fio___io_inbox_add(&inbox,
+                                    fio___test_io_defer_mt_task,
+                                    NULL,
+                                    (void *)(uintptr_t)i) == !i,
+                 "inbox add should report an empty inbox only once");
+    {
+      size_t pooled = 0;
+      for (fio___io_inbox_s *t = inbox; t; t = t->next)
+        pooled += fio___io_inbox_is_pooled(t);
+      FIO_ASSERT(pooled == FIO_IO_INBOX_POOL,
+                 "inbox nodes should come from the pool (round %zu: %zu)",
+                 round,
+                 pooled);
+    }
+    FIO_ASSERT(!fio___io_inbox_is_pooled(inbox) &&
+                   FIO_LEAK_COUNTER_COUNT(fio___io_inbox_s) == 16,
+               "an exhausted inbox pool should fall back to the heap");
+    FIO_ASSERT(fio___io_inbox_move(&inbox, &q) == count && !inbox,
+               "inbox move should move every task");
+    FIO_ASSERT(!FIO_LEAK_COUNTER_COUNT(fio___io_inbox_s),
+               "inbox heap nodes should be freed once moved");
+    for (size_t i = 0; i < count; ++i)
+      FIO_ASSERT(fio_queue_pop(&q).udata2 == (void *)(uintptr_t)i,
+                 "inbox tasks should keep their order");
+  }
+  fio_queue_destroy(&q);
+  fprintf(stderr, "* inbox node pool (recycled, heap fallback): OK\n");
+}
+
+static void test_io_defer_threads(void) {
+#if !FIO_OS_POSIX
+  test_io_skipped();
+  return;
+#else
+  fio___test_io_defer_mt_count = 0;
+  fio___test_io_defer_mt_order = 0;
+  fio___test_io_defer_mt_timeout = 0;
+  fio_state_callback_add(FIO_CALL_ON_START,
+                         fio___test_io_defer_mt_on_start,
+                         NULL);
+  fio_io_start(0);
+  fio_state_callback_remove(FIO_CALL_ON_START,
+                            fio___test_io_defer_mt_on_start,
+                            NULL);
+  for (size_t i = 0; i < FIO___TEST_IO_DEFER_THREADS; ++i)
+    fio_thread_join(fio___test_io_defer_mt_threads + i);
+  fio_queue_perform_all(fio_io_queue());
+  FIO_ASSERT(!fio___test_io_defer_mt_timeout,
+             "deferring from threads timed out (%zu tasks performed)",
+             fio___test_io_defer_mt_count);
+  FIO_ASSERT(fio___test_io_defer_mt_count ==
+                 FIO___TEST_IO_DEFER_THREADS * FIO___TEST_IO_DEFER_TASKS,
+             "all tasks deferred from threads should run (%zu)",
+             fio___test_io_defer_mt_count);
+  FIO_ASSERT(!fio___test_io_defer_mt_order,
+             "tasks from the same thread should run in order (%zu errors)",
+             fio___test_io_defer_mt_order);
+  FIO_ASSERT(!FIO___IO.inbox && !FIO_LEAK_COUNTER_COUNT(fio___io_inbox_s),
+             "the deferred task inbox should be empty");
+  fprintf(stderr,
+          "* fio_io_defer from %d threads (%d tasks each, FIFO): OK\n",
+          FIO___TEST_IO_DEFER_THREADS,
+          FIO___TEST_IO_DEFER_TASKS);
+#endif
+}
+
+/* *****************************************************************************
+Multi-reactor mode (a reactor per thread, SO_REUSEPORT listeners)
+***************************************************************************** */
+#define FIO___TEST_IO_REACTORS         4
+#define FIO___TEST_IO_REACTORS_CLIENTS 64
+#define FIO___TEST_IO_REACTORS_URL     "tcp://127.0.0.1:19877"
+
+static struct {
+  fio_thread_mutex_t lock;
+  uintptr_t threads[FIO___TEST_IO_REACTORS + 1];
+  size_t thread_count;
+  size_t replies;
+  size_t timers;
+  size_t wrong_thread;
+  int timeout;
+} fio___test_io_mr = {.lock = FIO_THREAD_MUTEX_INIT};
+
+/* records the serving thread, returns its numeral ID */
+static uintptr_t fio___test_io_mr_thread(void) {
+  const uintptr_t t = fio_thread_nid();
+  size_t i = 0;
+  fio_thread_mutex_lock(&fio___test_io_mr.lock);
+  while (i < fio___test_io_mr.thread_count && fio___test_io_mr.threads[i] != t)
+    ++i;
+  if (i == fio___test_io_mr.thread_count &&
+      i < FIO___TEST_IO_REACTORS + 1)
+    fio___test_io_mr.threads[fio___test_io_mr.thread_count++] = t;
+  fio_thread_mutex_unlock(&fio___test_io_mr.lock);
+  return t;
+}
+
+static int fio___test_io_mr_timer(void *thread_, void *ignr_) {
+  fio_thread_mutex_lock(&fio___test_io_mr.lock);
+  if ((uintptr_t)thread_ != fio_thread_nid())
+    ++fio___test_io_mr.wrong_thread;
+  ++fio___test_io_mr.timers;
+  fio_thread_mutex_unlock(&fio___test_io_mr.lock);
+  return -1;
+  (void)ignr_;
+}
+
+/* runs on the server IO's reactor, sent there by the main reactor */
+static void fio___test_io_mr_reply(void *io_, void *thread_) {
+  fio_io_s *io = (fio_io_s *)io_;
+  if ((uintptr_t)thread_ != fio_thread_nid()) {
+    fio_thread_mutex_lock(&fio___test_io_mr.lock);
+    ++fio___test_io_mr.wrong_thread;
+    fio_thread_mutex_unlock(&fio___test_io_mr.lock);
+  }
+  fio_io_write(io, "pong", 4);
+  fio_io_free(io);
+}
+
+static void fio___test_io_mr_route(void *io_, void *thread_) {
+  FIO___IO_ASSERT_IO_THREAD();
+  fio_io_defer_to((fio_io_s *)io_, fio___test_io_mr_reply, io_, thread_);
+}
+
+static void fio___test_io_mr_server_on_attach(fio_io_s *io) {
+  fio_timer_free(fio_io_run_every(.fn = fio___test_io_mr_timer,
+                                  .udata1 = (void *)fio_thread_nid(),
+                                  .every = 1,
+                                  .repetitions = 1));
+  (void)io;
+}
+
+static void fio___test_io_mr_server_on_data(fio_io_s *io) {
+  char buf[16];
+  if (fio_io_read(io, buf, sizeof(buf)) != 4)
+    return;
+  fio_io_defer(fio___test_io_mr_route,
+               fio_io_dup(io),
+               (void *)fio___test_io_mr_thread());
+}
+
+static fio_io_protocol_s fio___test_io_mr_server_protocol = {
+    .on_attach = fio___test_io_mr_server_on_attach,
+    .on_data = fio___test_io_mr_server_on_data,
+    .on_timeout = fio_io_touch,
+};
+
+static void fio___test_io_mr_client_on_attach(fio_io_s *io) {
+  fio_io_write(io, "ping", 4);
+}
+
+static void fio___test_io_mr_client_on_data(fio_io_s *io) {
+  char buf[16];
+  if (fio_io_read(io, buf, sizeof(buf)) != 4)
+    return;
+  fio_io_close(io);
+  if (++fio___test_io_mr.replies == FIO___TEST_IO_REACTORS_CLIENTS)
+    fio_io_stop();
+}
+
+static fio_io_protocol_s fio___test_io_mr_client_protocol = {
+    .on_attach = fio___test_io_mr_client_on_attach,
+    .on_data = fio___test_io_mr_client_on_data,
+    .on_timeout = fio_io_touch,
+};
+
+static int fio___test_io_mr_timeout_cb(void *u1, void *u2) {
+  fio___test_io_mr.timeout = 1;
+  fio_io_stop();
+  return -1;
+  (void)u1, (void)u2;
+}
+
+static int fio___test_io_mr_connect(void *u1, void *u2) {
+  for (size_t i = 0; i < FIO___TEST_IO_REACTORS_CLIENTS; ++i)
+    FIO_ASSERT(fio_io_connect(FIO___TEST_IO_REACTORS_URL,
+                              .protocol = &fio___test_io_mr_client_protocol,
+                              .timeout = 5000),
+               "connect should succeed");
+  return -1;
+  (void)u1, (void)u2;
+}
+
+static void fio___test_io_mr_on_start(void *ignr_) {
+  FIO_ASSERT(FIO___IO.reactors_running == FIO___TEST_IO_REACTORS - 1,
+             "additional reactors should run (%d)",
+             (int)FIO___IO.reactors_running);
+  /* let every reactor attach its listening socket before connecting */
+  fio_timer_free(fio_io_run_every(.fn = fio___test_io_mr_connect,
+                                  .every = 50,
+                                  .repetitions = 1));
+  fio_timer_free(fio_io_run_every(.fn = fio___test_io_mr_timeout_cb,
+                                  .every = 7000,
+                                  .repetitions = 1));
+  (void)ignr_;
+}
+
+static void test_io_reactors(void) {
+#if !FIO_OS_POSIX
+  test_io_skipped();
+  return;
+#else
+  FIO_ASSERT(fio_io_reactors() == 1, "single reactor by default");
+  FIO_ASSERT(fio_io_reactors_set(FIO___TEST_IO_REACTORS) ==
+                 FIO___TEST_IO_REACTORS,
+             "fio_io_reactors_set should return the reactor count");
+  fio_io_listener_s *l =
+      fio_io_listen(.url = FIO___TEST_IO_REACTORS_URL,
+                    .protocol = &fio___test_io_mr_server_protocol,
+                    .hide_from_log = 1);
+  FIO_ASSERT(l, "multi-reactor listen should succeed");
+  FIO_ASSERT(((fio___io_listen_s *)l)->reuse_port,
+             "listeners should use SO_REUSEPORT with several reactors");
+  fio_state_callback_add(FIO_CALL_ON_START, fio___test_io_mr_on_start, NULL);
+  fio_io_start(0);
+  fio_state_callback_remove(FIO_CALL_ON_START,
+                            fio___test_io_mr_on_start,
+                            NULL);
+  fio_io_listen_stop(l);
+  fio_queue_perform_all(fio_io_queue());
+  fio_io_reactors_set(1);
+
+  FIO_ASSERT(!fio___test_io_mr.timeout,
+             "multi-reactor test timed out (%zu replies)",
+             fio___test_io_mr.replies);
+  FIO_ASSERT(fio___test_io_mr.replies == FIO___TEST_IO_REACTORS_CLIENTS,
+             "every client should get a reply (%zu)",
+             fio___test_io_mr.replies);
+  FIO_ASSERT(fio___test_io_mr.timers == FIO___TEST_IO_REACTORS_CLIENTS,
+             "every connection's timer should run (%zu)",
+             fio___test_io_mr.timers);
+  FIO_ASSERT(!fio___test_io_mr.wrong_thread,
+             "tasks and timers should run on the IO's reactor (%zu errors)",
+             fio___test_io_mr.wrong_thread);
+#ifdef SO_REUSEPORT
+  FIO_ASSERT(fio___test_io_mr.thread_count > 1,
+             "connections should be spread between reactors");
+#endif
+  FIO_ASSERT(!FIO___IO.reactors && !FIO___IO.reactors_running,
+             "additional reactors should be released after stopping");
+  FIO_ASSERT(!FIO_LEAK_COUNTER_COUNT(fio___io),
+             "IO objects should be freed (%zu)",
+             (size_t)FIO_LEAK_COUNTER_COUNT(fio___io));
+  fprintf(stderr,
+          "* %d reactors (%d clients served on %zu threads, "
+          "fio_io_defer_to): OK\n",
+          FIO___TEST_IO_REACTORS,
+          FIO___TEST_IO_REACTORS_CLIENTS,
+          fio___test_io_mr.thread_count);
+#endif
+}
+
 /* *****************************************************************************
 Main entry point
 ***************************************************************************** */
 int main(void) {
-  fprintf(stderr, "=== IO API / types / reactor tests ===\n");
+  fprintf(stderr,
+          "=== IO API / types / reactor tests (engine: %s) ===\n",
+          fio_poll_engine());
+#if defined(FIO_POLL_ENGINE_URING)
+  { /* io_uring may be disabled (e.g., by a container's seccomp policy) */
+    fio_poll_s p;
+    fio_poll_init(&p, .on_data = NULL);
+    const int available = (p.fd != -1);
+    fio_poll_destroy(&p);
+    if (!available) {
+      fprintf(stderr, "* SKIPPED: io_uring unavailable.\n");
+      return 0;
+    }
+  }
+#endif
 
   test_io_reactor_state();
   test_io_noop_and_protocol_set_init();
@@ -977,6 +1307,9 @@ int main(void) {
   test_io_connect_invalid_host();
 
   test_io_integration();
+  test_io_inbox_pool();
+  test_io_defer_threads();
+  test_io_reactors();
 
   fprintf(stderr, "=== IO tests passed ===\n");
   return 0;
@@ -0,0 +1,11 @@
+/* *****************************************************************************
+Test - IO reactor, io_uring backend
+
+Runs the tests/io.c suite with FIO_POLL_ENGINE_URING (Linux only), so accepted
+and connected sockets are accepted / received / sent through the ring.
+Skipped when io_uring is unavailable.
+***************************************************************************** */
+#if defined(__linux__)
+#define FIO_POLL_ENGINE_URING
+#endif
+#include "io.c"
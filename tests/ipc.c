@@ -11,6 +11,7 @@ non-POSIX platforms.
 #include "test-helpers.h"
 
 #define FIO_IPC
+#define FIO_MALLOC
 #include FIO_INCLUDE_FILE
 
 /* *****************************************************************************
@@ -248,6 +249,286 @@ static void test_ipc_url_management(void) {
   fio_ipc_url_set(NULL);
 }
 
+/* *****************************************************************************
+Test: Shared Memory Transport Settings
+***************************************************************************** */
+
+static void test_ipc_shm_settings(void) {
+  FIO_ASSERT(!fio_ipc_shm(), "shared memory IPC should be off by default");
+#if defined(__linux__)
+  FIO_ASSERT(!fio_ipc_shm_set(5000), "fio_ipc_shm_set should succeed");
+  FIO_ASSERT(fio_ipc_shm() == 8192,
+             "ring capacity should round up to a power of 2 (got %zu)",
+             fio_ipc_shm());
+  FIO_ASSERT(!fio_ipc_shm_set(1) && fio_ipc_shm() == 4096,
+             "ring capacity should have a minimum (got %zu)",
+             fio_ipc_shm());
+  FIO_ASSERT(fio_ipc_shm_set(((size_t)1 << 30) + 1) == -1,
+             "fio_ipc_shm_set should reject oversized rings");
+#else
+  FIO_ASSERT(fio_ipc_shm_set(4096) == -1,
+             "fio_ipc_shm_set should fail where unsupported");
+#endif
+  FIO_ASSERT(!fio_ipc_shm_set(0) && !fio_ipc_shm(),
+             "fio_ipc_shm_set(0) should disable shared memory IPC");
+}
+
+/* *****************************************************************************
+Test: Shared Memory Transport Rings (single process, no fork)
+
+The worker's view of a mapping is the master's with the rings swapped, so
+both sides run in this process: raw ring reads / writes, the bind / bound /
+ready handshake, and a frame larger than the ring waiting for room.
+***************************************************************************** */
+#if defined(__linux__)
+
+static char fio___test_ipc_shm_data[3 * 4096];
+
+/* the worker's side of the master's rings (shares the mapping and eventfds) */
+static fio___ipc_shm_s *fio___test_ipc_shm_peer(fio___ipc_shm_s *s) {
+  fio___ipc_shm_s *p =
+      (fio___ipc_shm_s *)FIO_MEM_REALLOC(NULL, 0, fio___ipc_shm_sizeof(), 0);
+  FIO_ASSERT_ALLOC(p);
+  *p = (fio___ipc_shm_s){
+      .node = FIO_LIST_INIT(p->node),
+      .rx = s->tx,
+      .tx = s->rx,
+      .mask = s->mask,
+      .fd = {s->fd[0], s->fd[1]},
+      .ref = 1,
+      .self = 1,
+  };
+  fio_queue_init(&p->out);
+  fio___ipc_parser_init(fio___ipc_shm_parser(p));
+  return p;
+}
+
+/* returns the eventfd counter (resetting it), 0 if it wasn't signaled */
+static uint64_t fio___test_ipc_shm_signaled(int fd) {
+  uint64_t count = 0;
+  if (read(fd, &count, sizeof(count)) != (ssize_t)sizeof(count))
+    return 0;
+  return count;
+}
+
+static void fio___test_ipc_shm_call_big(fio_ipc_s *msg) {
+  ++fio___test_ipc_call_count;
+  FIO_ASSERT(msg->len == sizeof(fio___test_ipc_shm_data) - 1000 &&
+                 !FIO_MEMCMP(msg->data, fio___test_ipc_shm_data, msg->len),
+             "a frame larger than the ring should arrive intact");
+}
+
+static fio_io_s *fio___test_ipc_shm_attach(fio_socket_i fd) {
+  fio_io_s *io = fio_io_attach_fd(fd, &FIO___IPC.protocol_ipc, NULL, NULL);
+  FIO_ASSERT(io, "fio_io_attach_fd failed");
+  fio_queue_perform_all(fio_io_queue()); /* sets the protocol */
+  return io;
+}
+#endif
+
+static void test_ipc_shm_rings(void) {
+#if defined(__linux__)
+  for (size_t i = 0; i < sizeof(fio___test_ipc_shm_data); ++i)
+    fio___test_ipc_shm_data[i] = (char)(i * 31 + (i >> 8));
+  FIO_ASSERT(!fio_ipc_shm_set(4096), "fio_ipc_shm_set failed");
+  fio___ipc_shm_s *m = fio___ipc_shm_new();
+  FIO_ASSERT(m, "fio___ipc_shm_new failed");
+  fio___ipc_shm_s *w = fio___test_ipc_shm_peer(m);
+  FIO_ASSERT(m->tx->rx_waiting && m->rx->rx_waiting,
+             "readers should start asleep");
+
+  /* raw reads / writes: a small frame, then one that wraps (and exceeds) */
+  fio_ipc_s *small = fio_ipc_new(.call = fio___test_ipc_call_simple,
+                                 .data = FIO_IPC_DATA(FIO_BUF_INFO1("wrap")));
+  fio_ipc_s *big = fio_ipc_new(
+      .call = fio___test_ipc_shm_call_big,
+      .data = FIO_IPC_DATA(FIO_BUF_INFO2(fio___test_ipc_shm_data,
+                                         sizeof(fio___test_ipc_shm_data) -
+                                             1000)));
+  FIO_ASSERT(small && big, "fio_ipc_new failed");
+  const size_t small_len = fio___ipc_wire_length(small->len);
+  const size_t big_len = fio___ipc_wire_length(big->len);
+  char *got = (char *)FIO_MEM_REALLOC(NULL, 0, big_len, 0);
+  FIO_ASSERT_ALLOC(got);
+  FIO_ASSERT(big_len > 2 * fio_ipc_shm(), "the frame should exceed the ring");
+  FIO_ASSERT(fio___ipc_shm_write(m, small) && fio___ipc_shm_unread(w) ==
+                                                  small_len,
+             "a small frame should be written at once");
+  FIO_ASSERT(fio___ipc_shm_read(w, got, big_len) == small_len &&
+                 !FIO_MEMCMP(got, &small->len, small_len),
+             "the peer should read the small frame");
+  FIO_ASSERT(!fio___ipc_shm_read(w, got, big_len), "the ring should be empty");
+  size_t len = 0;
+  int done = 0;
+  for (size_t rounds = 0; len < big_len; ++rounds) {
+    FIO_ASSERT(rounds < 64, "ring transfer stalled at %zu/%zu", len, big_len);
+    if (!done) {
+      done = fio___ipc_shm_write(m, big);
+      FIO_ASSERT(done || !fio___ipc_shm_room(m),
+                 "a partial write should fill the ring");
+    }
+    len += fio___ipc_shm_read(w, got + len, 1021); /* odd sized reads */
+  }
+  FIO_ASSERT(done && !FIO_MEMCMP(got, &big->len, big_len),
+             "frame bytes should survive wrapping around the ring");
+  FIO_ASSERT(m->tx->head == small_len + big_len && m->tx->tail == m->tx->head,
+             "ring positions should count every byte (%zu / %zu)",
+             (size_t)m->tx->head,
+             (size_t)m->tx->tail);
+  FIO_MEM_FREE(got, big_len);
+
+  /* bind / bound / ready handshake, over a socketpair standing in for IPC */
+  fio_socket_i fds[2];
+  FIO_ASSERT(!fio_sock_socketpair(fds), "socketpair failed");
+  fio_io_s *mio = fio___test_ipc_shm_attach(fds[0]);
+  fio_io_s *wio = fio___test_ipc_shm_attach(fds[1]);
+  fio___ipc_shm_after_fork(NULL); /* attaches the master's eventfd */
+  FIO_ASSERT(m->wake, "the master should listen to its eventfd");
+  FIO___IPC.worker_connection = wio;
+  FIO___IPC.shm = w;
+
+  fio_ipc_s *bind = fio_ipc_new(.call = fio___ipc_shm_on_bind, .udata = m);
+  bind->from = fio_io_dup(mio);
+  fio___ipc_shm_on_bind(bind);
+  FIO_ASSERT(m->io == mio && fio___ipc_shm_of(mio) == m && m->ref == 2,
+             "bind should attach the rings to the worker's connection");
+  fio___ipc_shm_on_bind(bind);
+  FIO_ASSERT(m->ref == 2, "a second bind should be ignored");
+  FIO_ASSERT(!m->rx_ready, "the master waits for `ready` before draining");
+
+  fio_ipc_s *bound = fio_ipc_new(.udata = w);
+  fio___ipc_shm_on_bound(bound);
+  FIO_ASSERT(w->tx_ready && w->rx_ready, "bound should switch the worker");
+
+  /* the worker writes at once, the master reads only after `ready` */
+  fio___test_ipc_reset_state();
+  fio_ipc_s *msg = fio_ipc_new(.call = fio___test_ipc_call_capture,
+                               .data = FIO_IPC_DATA(FIO_BUF_INFO1("shm")));
+  fio_ipc_encrypt(msg);
+  fio___ipc_shm_send(w, msg);
+  FIO_ASSERT(fio___test_ipc_shm_signaled(m->fd[0]) == 1,
+             "writing should wake the sleeping master");
+  fio___ipc_shm_drain(m);
+  fio_queue_perform_all(fio_io_queue());
+  FIO_ASSERT(!fio___test_ipc_call_count, "the master drained before `ready`");
+  fio_ipc_s *ready = fio_ipc_new(.call = fio___ipc_shm_on_ready, .udata = m);
+  ready->from = fio_io_dup(mio);
+  fio___ipc_shm_on_ready(ready);
+  fio_queue_perform_all(fio_io_queue());
+  FIO_ASSERT(m->rx_ready && fio___test_ipc_call_count == 1 &&
+                 fio___test_ipc_received_len == 3 &&
+                 !FIO_MEMCMP(fio___test_ipc_received_data, "shm", 3),
+             "`ready` should drain the worker's ring");
+
+  /* a frame larger than the ring waits for room (`await_room`) */
+  fio___test_ipc_reset_state();
+  fio_ipc_encrypt(big);
+  fio___ipc_shm_send(m, fio_ipc_dup(big));
+  FIO_ASSERT(fio_queue_count(&m->out) == 1 && m->tx->tx_waiting &&
+                 !fio___test_ipc_shm_signaled(m->fd[0]),
+             "a frame larger than the ring should wait for room");
+  for (size_t rounds = 0; fio_queue_count(&m->out); ++rounds) {
+    FIO_ASSERT(rounds < 16, "the writer was never woken to flush");
+    fio___ipc_shm_drain(w); /* reads, then wakes the waiting writer */
+    FIO_ASSERT(!w->rx->tx_waiting &&
+                   fio___test_ipc_shm_signaled(m->fd[0]) == 1,
+               "reading should hand the room back to the waiting writer");
+    fio___ipc_shm_flush(m); /* what the woken master does */
+  }
+  fio___ipc_shm_drain(w);
+  fio_queue_perform_all(fio_io_queue());
+  FIO_ASSERT(fio___test_ipc_call_count == 1,
+             "the worker should receive the large frame once");
+
+  /* cleanup: the connection's rings close with it */
+  FIO___IPC.worker_connection = NULL;
+  FIO___IPC.shm = NULL;
+  w->fd[0] = w->fd[1] = -1; /* owned by the master's view */
+  fio___ipc_shm_free(w);
+  fio_ipc_free(small);
+  fio_ipc_free(big);
+  fio_ipc_free(bind);
+  fio_ipc_free(bound);
+  fio_ipc_free(ready);
+  fio_io_close_now(wio);
+  fio_io_close_now(mio);
+  for (size_t i = 0; i < 4; ++i)
+    fio_queue_perform_all(fio_io_queue());
+  FIO_ASSERT(FIO_LIST_IS_EMPTY(&FIO___IPC.shm_list),
+             "closing the connection should free the rings");
+  FIO_ASSERT(!fio_ipc_shm_set(0), "fio_ipc_shm_set(0) failed");
+#else
+  FIO_LOG_WARNING("SKIPPED: shared memory rings require Linux");
+#endif
+}
+
+/* *****************************************************************************
+Test: Batching Settings and Batch Frames
+***************************************************************************** */
+
+static size_t fio___test_ipc_batch_count = 0;
+
+static void fio___test_ipc_batch_capture(void *ipc_, void *io_) {
+  fio_ipc_s *m = (fio_ipc_s *)ipc_;
+  static const char *expected[] = {"plain", "encrypted"};
+  FIO_ASSERT(!fio_ipc_decrypt(m), "batched message should decrypt");
+  FIO_ASSERT(fio___test_ipc_batch_count < 2, "too many batched messages");
+  FIO_ASSERT(m->len == FIO_STRLEN(expected[fio___test_ipc_batch_count]) &&
+                 !FIO_MEMCMP(m->data,
+                             expected[fio___test_ipc_batch_count],
+                             m->len),
+             "batched message %zu data mismatch",
+             fio___test_ipc_batch_count);
+  FIO_ASSERT(m->call == fio___test_ipc_call_simple,
+             "batched message should keep its call");
+  ++fio___test_ipc_batch_count;
+  fio___ipc_free(m);
+  (void)io_;
+}
+
+static void test_ipc_batch(void) {
+  FIO_ASSERT(!fio_ipc_batch(), "IPC batching should be off by default");
+  FIO_ASSERT(!fio_ipc_batch_set(500) && fio_ipc_batch() == 500,
+             "fio_ipc_batch_set should store the latency cap");
+  FIO_ASSERT(!fio_ipc_batch_set(0) && !fio_ipc_batch(),
+             "fio_ipc_batch_set(0) should disable batching");
+
+  /* a batch holds a plaintext and an encrypted frame, back to back */
+  fio_ipc_s *m[2];
+  m[0] = fio_ipc_new(.call = fio___test_ipc_call_simple,
+                     .data = FIO_IPC_DATA(FIO_BUF_INFO1((char *)"plain")));
+  m[1] = fio_ipc_new(.call = fio___test_ipc_call_simple,
+                     .data = FIO_IPC_DATA(FIO_BUF_INFO1((char *)"encrypted")));
+  FIO_ASSERT(m[0] && m[1], "fio_ipc_new should allocate messages");
+  fio_ipc_encrypt(m[1]);
+  uint32_t l0 = fio___ipc_wire_length(m[0]->len);
+  uint32_t l1 = fio___ipc_wire_length(m[1]->len);
+  fio_ipc_s *batch = fio___ipc_new_internal(l0 + l1, FIO_IPC_FLAG_BATCH);
+  FIO_ASSERT(batch, "batch allocation failed");
+  FIO_MEMSET(m[0]->data + m[0]->len, 0, 16); /* unused MAC */
+  FIO_MEMCPY(batch->data, &m[0]->len, l0);
+  FIO_MEMCPY(batch->data + l0, &m[1]->len, l1);
+  fio_ipc_s *truncated = fio___ipc_copy(batch);
+  FIO_ASSERT(truncated, "batch copy failed");
+  truncated->len -= 1;
+
+  fio___test_ipc_batch_count = 0;
+  fio___ipc_batch_unpack(batch, fio___test_ipc_batch_capture);
+  FIO_ASSERT(fio___test_ipc_batch_count == 2,
+             "batch should unpack 2 messages (got %zu)",
+             fio___test_ipc_batch_count);
+
+  /* a truncated batch is rejected once the valid frames were delivered */
+  fio___test_ipc_batch_count = 0;
+  fprintf(stderr, "      (expect SECURITY message about a malformed batch)\n");
+  fio___ipc_batch_unpack(truncated, fio___test_ipc_batch_capture);
+  FIO_ASSERT(fio___test_ipc_batch_count == 1,
+             "truncated batch should stop at the broken frame (got %zu)",
+             fio___test_ipc_batch_count);
+  fio___ipc_free(m[0]);
+  fio___ipc_free(m[1]);
+}
+
 /* *****************************************************************************
 Test: Message Structure Fields
 ***************************************************************************** */
@@ -1428,6 +1709,42 @@ static void test_ipc_udp_discovery_message(void) {
   }
 }
 
+/* *****************************************************************************
+Test: Allocator Telemetry Collection
+***************************************************************************** */
+
+static size_t fio___test_ipc_stats_count = 0;
+
+static void fio___test_ipc_on_stats(int pid,
+                                    fio_malloc_stats_s *stats,
+                                    void *udata) {
+  FIO_ASSERT(pid == fio_io_pid(), "stats should be reported by the master");
+#if !defined(FIO_MEMORY_DISABLE) /* the system allocator reports nothing */
+  FIO_ASSERT(stats->arenas, "stats should list the allocator's arenas");
+#endif
+  FIO_ASSERT(stats->bytes_held >= stats->bytes_in_use,
+             "held memory should cover the memory in use");
+  fio_malloc_stats_add((fio_malloc_stats_s *)udata, stats);
+  ++fio___test_ipc_stats_count;
+}
+
+static void test_ipc_malloc_stats(void) {
+  fio_malloc_stats_s total = {0};
+  void *mem = fio_malloc(4096);
+  FIO_ASSERT_ALLOC(mem);
+  fio___test_ipc_stats_count = 0;
+  fio_ipc_malloc_stats(fio___test_ipc_on_stats, &total);
+  fio_queue_perform_all(fio_io_queue());
+  FIO_ASSERT(fio___test_ipc_stats_count == 1,
+             "master (without workers) should report once (%zu)",
+             fio___test_ipc_stats_count);
+#if !defined(FIO_MEMORY_DISABLE)
+  FIO_ASSERT(total.bytes_in_use >= 4096,
+             "aggregated stats should include live allocations");
+#endif
+  fio_free(mem);
+}
+
 /* *****************************************************************************
 Main entry point
 ***************************************************************************** */
@@ -1447,6 +1764,9 @@ int main(void) {
 
   test_ipc_message_lifecycle();
   test_ipc_url_management();
+  test_ipc_shm_settings();
+  test_ipc_shm_rings();
+  test_ipc_batch();
   test_ipc_message_fields();
   test_ipc_error_handling();
   test_ipc_data_integrity();
@@ -1466,6 +1786,7 @@ int main(void) {
   test_ipc_rpc_encryption();
   test_ipc_rpc_filter();
   test_ipc_udp_discovery_message();
+  test_ipc_malloc_stats();
 
   fprintf(stderr, "=== IPC correctness tests passed ===\n");
   return 0;
@@ -1058,6 +1058,80 @@ FIO_SFUNC void fio___test_json_large_array(void) {
   test_json_value_free(v);
 }
 
+/* *****************************************************************************
+Test: SIMD Index (strings and white space across 64 byte blocks)
+***************************************************************************** */
+
+FIO_SFUNC void fio___test_json_index(void) {
+#if FIO___JSON_INDEX
+  /* stage 1 matches a byte by byte escape model */
+  const char alphabet[] = "\\\\\\\"a \n";
+  char buf[300];
+  uint64_t rnd = 0x9E3779B97F4A7C15ULL;
+  for (size_t round = 0; round < 2000; ++round) {
+    const size_t len = round % sizeof(buf);
+    fio___json_index_s ix = {.next = buf};
+    _Bool escaped = 0;
+    for (size_t i = 0; i < len; ++i) {
+      rnd = fio_risky_num(rnd, round);
+      buf[i] = alphabet[rnd % (sizeof(alphabet) - 1)];
+    }
+    for (size_t i = 0; i < len; ++i) {
+      if (!(i & 63))
+        fio___json_index_next(&ix, buf + len);
+      const uint64_t bit = (uint64_t)1 << (i & 63);
+      FIO_ASSERT(!(ix.quote & bit) == !(buf[i] == '"' && !escaped),
+                 "JSON index quote mismatch at %zu (round %zu)",
+                 i,
+                 round);
+      FIO_ASSERT(!(ix.ws & bit) == !(buf[i] == ' ' || buf[i] == '\n'),
+                 "JSON index white space mismatch at %zu",
+                 i);
+      escaped = !escaped && buf[i] == '\\';
+    }
+  }
+#endif
+  /* escapes and white space at (and across) block boundaries */
+  for (size_t pad = 0; pad < 140; ++pad) {
+    char json[512];
+    fio_str_info_s s = FIO_STR_INFO3(json, 0, sizeof(json));
+    fio_string_write(&s, NULL, "[", 1);
+    for (size_t i = 0; i < pad; ++i)
+      fio_string_write(&s, NULL, " ", 1);
+    fio_string_write(&s, NULL, "\"", 1);
+    for (size_t i = 0; i < pad; ++i)
+      fio_string_write(&s, NULL, "a", 1);
+    fio_string_write(&s, NULL, "\\\\\\\"b\" , \"", 10);
+    for (size_t i = 0; i < pad; ++i)
+      fio_string_write(&s, NULL, "c", 1);
+    fio_string_write(&s, NULL, "\"]", 2);
+    test_json_value_s *v = test_json_parse(json, s.len);
+    FIO_ASSERT(v && v->type == TEST_JSON_ARRAY && v->data.arr.count == 2,
+               "JSON index parsing failed (pad %zu)",
+               pad);
+    test_json_value_s *a = v->data.arr.items[0], *c = v->data.arr.items[1];
+    FIO_ASSERT(a->data.str.len == pad + 3 &&
+                   !FIO_MEMCMP(a->data.str.buf + pad, "\\\"b", 3),
+               "JSON index escaped string mismatch (pad %zu)",
+               pad);
+    FIO_ASSERT(c->data.str.len == pad, "JSON index string mismatch");
+    test_json_value_free(v);
+  }
+  /* quotes in comments and single quoted strings don't confuse the index */
+  {
+    const char *json = "/* \" */ [\"a\", 'b\"c', // \"\n \"d\"]";
+    test_json_value_s *v = test_json_parse(json, FIO_STRLEN(json));
+    FIO_ASSERT(v && v->type == TEST_JSON_ARRAY && v->data.arr.count == 3,
+               "JSON index comment / single quote parsing failed");
+    FIO_ASSERT(!FIO_MEMCMP(v->data.arr.items[2]->data.str.buf, "d", 2),
+               "JSON index comment / single quote value mismatch");
+    test_json_value_free(v);
+  }
+  /* unterminated strings are still detected */
+  FIO_ASSERT(!test_json_parse("[\"abc", 5), "unterminated string accepted");
+  FIO_ASSERT(!test_json_parse("[\"abc\\\"]", 8), "escaped quote accepted");
+}
+
 /* *****************************************************************************
 Test: Real-world JSON Examples
 ***************************************************************************** */
@@ -1228,6 +1302,7 @@ FIO_SFUNC void fio_test_json(void) {
   /* Stress tests */
   fio___test_json_depth();
   fio___test_json_large_array();
+  fio___test_json_index();
 
   /* Real-world examples */
   fio___test_json_realworld();
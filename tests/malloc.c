@@ -264,6 +264,152 @@ FIO_SFUNC void fio___test_malloc_refcounted_aligned(void) {
   fio___test_refaligned_free2(o2);
 }
 
+/* *****************************************************************************
+Per-thread caches (small allocations freed by other threads)
+***************************************************************************** */
+#if !defined(FIO_MEMORY_DISABLE)
+#define FIO___TEST_MALLOC_TCACHE_THREADS 4
+#define FIO___TEST_MALLOC_TCACHE_COUNT   2048
+
+static uint8_t *fio___test_malloc_tcache_ptrs[FIO___TEST_MALLOC_TCACHE_THREADS]
+                                             [FIO___TEST_MALLOC_TCACHE_COUNT];
+
+FIO_SFUNC void *fio___test_malloc_tcache_task(void *ptrs_) {
+  uint8_t **ptrs = (uint8_t **)ptrs_;
+  /* release slices allocated by the main thread into this thread's cache */
+  for (size_t i = 0; i < FIO___TEST_MALLOC_TCACHE_COUNT; ++i) {
+    for (size_t j = 0; j < 1 + (i & 511); ++j)
+      FIO_ASSERT(ptrs[i][j] == (uint8_t)i, "cross-thread data corrupted");
+    fio_free(ptrs[i]);
+  }
+  for (size_t round = 0; round < 8; ++round) {
+    for (size_t i = 0; i < FIO___TEST_MALLOC_TCACHE_COUNT; ++i) {
+      const size_t len = 1 + ((i * 7 + round) & 511);
+      ptrs[i] = (uint8_t *)fio_malloc(len);
+      FIO_ASSERT(ptrs[i], "small allocation failed");
+      memset(ptrs[i], (int)(i + round), len);
+    }
+    for (size_t i = 0; i < FIO___TEST_MALLOC_TCACHE_COUNT; ++i) {
+      const size_t len = 1 + ((i * 7 + round) & 511);
+      for (size_t j = 0; j < len; ++j)
+        FIO_ASSERT(ptrs[i][j] == (uint8_t)(i + round),
+                   "cached allocation overlaps another allocation");
+    }
+    for (size_t i = 0; i < FIO___TEST_MALLOC_TCACHE_COUNT; ++i)
+      fio_free(ptrs[i]);
+  }
+  return NULL;
+}
+
+FIO_SFUNC void fio___test_malloc_thread_cache(void) {
+  fio_thread_t threads[FIO___TEST_MALLOC_TCACHE_THREADS];
+  for (size_t t = 0; t < FIO___TEST_MALLOC_TCACHE_THREADS; ++t) {
+    for (size_t i = 0; i < FIO___TEST_MALLOC_TCACHE_COUNT; ++i) {
+      fio___test_malloc_tcache_ptrs[t][i] = (uint8_t *)fio_malloc(1 + (i & 511));
+      FIO_ASSERT(fio___test_malloc_tcache_ptrs[t][i], "allocation failed");
+      memset(fio___test_malloc_tcache_ptrs[t][i], (int)i, 1 + (i & 511));
+    }
+  }
+  for (size_t t = 0; t < FIO___TEST_MALLOC_TCACHE_THREADS; ++t)
+    FIO_ASSERT(!fio_thread_create(threads + t,
+                                  fio___test_malloc_tcache_task,
+                                  fio___test_malloc_tcache_ptrs[t]),
+               "couldn't spawn thread");
+  for (size_t t = 0; t < FIO___TEST_MALLOC_TCACHE_THREADS; ++t)
+    fio_thread_join(threads + t);
+
+  /* a freed small slice is reused by the next allocation of its size class */
+  void *p = fio_malloc(100);
+  fio_free(p);
+  void *q = fio_malloc(100);
+  FIO_ASSERT(p == q, "freed slice should be reused from the thread cache");
+  fio_free(q);
+}
+#else
+FIO_SFUNC void fio___test_malloc_thread_cache(void) {}
+#endif /* FIO_MEMORY_DISABLE */
+
+/* *****************************************************************************
+Telemetry
+***************************************************************************** */
+#if !defined(FIO_MEMORY_DISABLE)
+#define FIO___TEST_MALLOC_STATS_COUNT 4096
+
+FIO_SFUNC void fio___test_malloc_stats(void) {
+  static void *ptrs[FIO___TEST_MALLOC_STATS_COUNT];
+  fio_malloc_stats_s s0 = fio_malloc_stats(), s1, s2;
+  FIO_ASSERT(s0.arenas == fio_malloc_arenas(), "arena count mismatch");
+  FIO_ASSERT(s0.chunks && s0.bytes_held >= s0.bytes_in_use,
+             "allocator should hold memory (%zu held, %zu in use)",
+             s0.bytes_held,
+             s0.bytes_in_use);
+
+  /* fill blocks, then keep every 64th allocation to pin the full blocks */
+  for (size_t i = 0; i < FIO___TEST_MALLOC_STATS_COUNT; ++i) {
+    ptrs[i] = fio_malloc(1000);
+    FIO_ASSERT(ptrs[i], "allocation failed");
+  }
+  s1 = fio_malloc_stats();
+  FIO_ASSERT(s1.bytes_in_use >=
+                 s0.bytes_in_use + (FIO___TEST_MALLOC_STATS_COUNT * 1000),
+             "bytes in use should grow (%zu => %zu)",
+             s0.bytes_in_use,
+             s1.bytes_in_use);
+  FIO_ASSERT(s1.blocks > s0.blocks, "blocks held should grow");
+  for (size_t i = 0; i < FIO___TEST_MALLOC_STATS_COUNT; ++i) {
+    if ((i & 63))
+      fio_free(ptrs[i]);
+  }
+  s2 = fio_malloc_stats();
+  FIO_ASSERT(s2.blocks_pinned >= s0.blocks_pinned + 8,
+             "full blocks kept by a few slices should be pinned (%zu => %zu)",
+             s0.blocks_pinned,
+             s2.blocks_pinned);
+  for (size_t i = 0; i < FIO___TEST_MALLOC_STATS_COUNT; i += 64)
+    fio_free(ptrs[i]);
+  s2 = fio_malloc_stats();
+  FIO_ASSERT(s2.blocks_pinned <= s0.blocks_pinned,
+             "released blocks should no longer be pinned (%zu => %zu)",
+             s0.blocks_pinned,
+             s2.blocks_pinned);
+  FIO_ASSERT(s2.bytes_in_use < s1.bytes_in_use,
+             "bytes in use should drop once blocks are released");
+
+  /* page-backed allocations */
+  {
+    const size_t len = fio_malloc_alloc_limit() << 1;
+    void *p = fio_malloc(len);
+    FIO_ASSERT(p, "mmap allocation failed");
+    s1 = fio_malloc_stats();
+    FIO_ASSERT(s1.mmap_count == s2.mmap_count + 1 &&
+                   s1.mmap_bytes >= s2.mmap_bytes + len,
+               "mmap allocations should be counted");
+    fio_free(p);
+    s1 = fio_malloc_stats();
+    FIO_ASSERT(s1.mmap_count == s2.mmap_count &&
+                   s1.mmap_bytes == s2.mmap_bytes,
+               "freed mmap allocations should be uncounted");
+  }
+
+#if FIO_OS_POSIX
+  /* thread cache hits are published in batches */
+  for (size_t i = 0; i < FIO___TEST_MALLOC_STATS_COUNT; ++i)
+    fio_free(fio_malloc(64));
+  s1 = fio_malloc_stats();
+  FIO_ASSERT(s1.thread_cache_hits > s0.thread_cache_hits,
+             "thread cache hits should be reported");
+#endif
+
+  /* aggregation helper */
+  s2 = s1;
+  fio_malloc_stats_add(&s2, &s1);
+  FIO_ASSERT(s2.chunks == (s1.chunks << 1) && s2.arenas == (s1.arenas << 1),
+             "fio_malloc_stats_add should sum all fields");
+}
+#else
+FIO_SFUNC void fio___test_malloc_stats(void) {}
+#endif /* FIO_MEMORY_DISABLE */
+
 /* *****************************************************************************
 Invalid alignment requests
 ***************************************************************************** */
@@ -293,5 +439,7 @@ int main(void) {
   fio___test_malloc_aligned_macros();
   fio___test_malloc_refcounted_aligned();
   fio___test_malloc_aligned_invalid();
+  fio___test_malloc_thread_cache();
+  fio___test_malloc_stats();
   return 0;
 }
@@ -304,10 +304,218 @@ static void test_poll_invalid_arguments(void) {
 
 #endif /* FIO_POLL_ENGINE_POLL */
 
+#if defined(FIO_POLL_ENGINE_URING)
+/* Re-arm requests are only submitted by the next review, so a descriptor that
+ * is forgotten, closed and re-used in between must not see stale events. */
+static void test_poll_uring_fd_reuse(void) {
+  fio_socket_i fds[2] = {FIO_SOCKET_INVALID, FIO_SOCKET_INVALID};
+  poll_counts_s stale = {0}, fresh = {0};
+  fio_poll_s p;
+  fio_poll_init(&p,
+                .on_data = cb_on_data,
+                .on_ready = cb_on_ready,
+                .on_close = cb_on_close);
+
+  FIO_ASSERT(!fio_sock_socketpair(fds), "fio_sock_socketpair failed");
+  FIO_ASSERT(!fio_poll_monitor(&p, fds[0], &stale, POLLIN | POLLOUT),
+             "fio_poll_monitor failed for fd re-use test");
+  FIO_ASSERT(fio_poll_review(&p, 100) == 1 && stale.on_ready_count == 1,
+             "on_ready should fire before fd re-use");
+  FIO_ASSERT(!fio_poll_forget(&p, fds[0]),
+             "fio_poll_forget should find an armed (POLLIN) descriptor");
+  fio_sock_close(fds[0]);
+  fio_sock_close(fds[1]);
+
+  FIO_ASSERT(!fio_sock_socketpair(fds), "fio_sock_socketpair failed");
+  FIO_ASSERT(!fio_poll_monitor(&p, fds[0], &fresh, POLLIN),
+             "fio_poll_monitor failed for re-used fd");
+  FIO_ASSERT(fio_sock_write(fds[1], "x", 1) == 1, "fio_sock_write failed");
+  int events = 0;
+  for (size_t i = 0; i < 8 && !fresh.on_data_count; ++i)
+    events += fio_poll_review(&p, 100);
+  FIO_ASSERT(events == 1 && fresh.on_data_count == 1,
+             "re-used fd should fire once (events=%d, on_data=%d)",
+             events,
+             fresh.on_data_count);
+  FIO_ASSERT(stale.on_data_count == 0 && stale.on_close_count == 0 &&
+                 stale.on_ready_count == 1,
+             "stale udata must not receive events after forget");
+
+  fio_poll_destroy(&p);
+  fio_sock_close(fds[0]);
+  fio_sock_close(fds[1]);
+  fprintf(stderr, "* io_uring fd re-use (stale completions): OK\n");
+}
+
+/* reviews until `done` is set (or about a second passed) */
+#define TEST_URING_REVIEW_UNTIL(p, done)                                       \
+  for (size_t review_ = 0; review_ < 100 && !(done); ++review_)                \
+    fio_poll_review((p), 10);
+
+/* Receives and sends through the ring (`FIO_POLL_IO`), including the pause /
+ * resume of the multishot receive when its queue isn't read. */
+static void test_poll_uring_io(void) {
+  fio_socket_i fds[2] = {FIO_SOCKET_INVALID, FIO_SOCKET_INVALID};
+  poll_counts_s counts = {0};
+  char buf[4096];
+  fio_poll_s p;
+  fio_poll_init(&p,
+                .on_data = cb_on_data,
+                .on_ready = cb_on_ready,
+                .on_close = cb_on_close);
+  FIO_ASSERT(!fio_sock_socketpair(fds), "fio_sock_socketpair failed");
+  fio_sock_set_non_block(fds[0]);
+  FIO_ASSERT(!fio_poll_monitor(&p, fds[0], &counts, POLLIN | FIO_POLL_IO),
+             "fio_poll_monitor failed for ring I/O");
+  fio_poll_review(&p, 0); /* submits the multishot receive */
+  FIO_ASSERT(fio_poll_read(&p, fds[0], buf, sizeof(buf)) == -1 &&
+                 (errno == EWOULDBLOCK || errno == EAGAIN),
+             "ring read without data should return EWOULDBLOCK");
+
+  FIO_ASSERT(fio_sock_write(fds[1], "hello", 5) == 5, "write failed");
+  TEST_URING_REVIEW_UNTIL(&p, counts.on_data_count);
+  FIO_ASSERT(counts.on_data_count == 1, "ring receive should fire on_data");
+  FIO_ASSERT(fio_poll_read(&p, fds[0], buf, sizeof(buf)) == 5 &&
+                 !memcmp(buf, "hello", 5),
+             "ring read should return the received data");
+
+  /* unread completions pause the receive, ordering must be kept */
+  const size_t total = FIO_POLL_URING_QUEUE_LIMIT * 3;
+  for (size_t i = 0; i < total; ++i) {
+    char c = (char)('a' + (i % 26));
+    FIO_ASSERT(fio_sock_write(fds[1], &c, 1) == 1, "write failed");
+    fio_poll_review(&p, 1);
+  }
+  counts = (poll_counts_s){0};
+  FIO_ASSERT(!fio_poll_monitor(&p, fds[0], &counts, POLLIN | FIO_POLL_IO),
+             "fio_poll_monitor failed for queued data");
+  FIO_ASSERT(fio_poll_review(&p, 0) >= 1 && counts.on_data_count == 1,
+             "queued data should be dispatched by the next review");
+  size_t received = 0;
+  for (ssize_t r; (r = fio_poll_read(&p, fds[0], buf, 3)) > 0;) {
+    for (ssize_t i = 0; i < r; ++i)
+      FIO_ASSERT(buf[i] == (char)('a' + ((received + i) % 26)),
+                 "ring read out of order at byte %zu",
+                 (size_t)(received + i));
+    received += (size_t)r;
+  }
+  FIO_ASSERT(received == total,
+             "all data should be read after a pause (%zu/%zu)",
+             received,
+             total);
+
+  /* sends are copied, submitted by the review and completed as on_ready */
+  FIO_ASSERT(fio_poll_write(&p, fds[0], "world", 5) == 5,
+             "ring write should accept the data");
+  FIO_ASSERT(fio_poll_flush(&p, fds[0]) == -1 && errno == EWOULDBLOCK,
+             "fio_poll_flush should report an in-flight send");
+  FIO_ASSERT(fio_poll_write(&p, fds[0], "!", 1) == -1 && errno == EWOULDBLOCK,
+             "a second send must wait for the first");
+  counts = (poll_counts_s){0};
+  FIO_ASSERT(!fio_poll_monitor(&p, fds[0], &counts, POLLOUT | FIO_POLL_IO),
+             "fio_poll_monitor failed for ring send");
+  TEST_URING_REVIEW_UNTIL(&p, counts.on_ready_count);
+  FIO_ASSERT(counts.on_ready_count == 1 && !fio_poll_flush(&p, fds[0]),
+             "send completion should fire on_ready");
+  FIO_ASSERT(fio_sock_read(fds[1], buf, sizeof(buf)) == 5 &&
+                 !memcmp(buf, "world", 5),
+             "peer should receive the ring send");
+
+  /* EOF is read as 0 once the queue is empty */
+  fio_sock_close(fds[1]);
+  counts = (poll_counts_s){0};
+  FIO_ASSERT(!fio_poll_monitor(&p, fds[0], &counts, POLLIN | FIO_POLL_IO),
+             "fio_poll_monitor failed for EOF");
+  TEST_URING_REVIEW_UNTIL(&p, counts.on_data_count);
+  FIO_ASSERT(fio_poll_read(&p, fds[0], buf, sizeof(buf)) == 0,
+             "ring read should report EOF");
+
+  /* forgetting an fd while sending must not leak or touch freed memory */
+  FIO_ASSERT(!fio_sock_socketpair(fds), "fio_sock_socketpair failed");
+  FIO_ASSERT(!fio_poll_monitor(&p, fds[0], &counts, POLLIN | FIO_POLL_IO),
+             "fio_poll_monitor failed for forget test");
+  FIO_ASSERT(fio_poll_write(&p, fds[0], buf, sizeof(buf)) > 0,
+             "ring write should accept the data");
+  FIO_ASSERT(!fio_poll_forget(&p, fds[0]), "fio_poll_forget failed");
+  fio_sock_close(fds[0]);
+  fio_poll_review(&p, 10);
+  fio_poll_destroy(&p);
+  fio_sock_close(fds[1]);
+  FIO_ASSERT(!FIO_LEAK_COUNTER_COUNT(fio___uring_io_s),
+             "ring I/O states leaked");
+  fprintf(stderr, "* io_uring ring receive / send: OK\n");
+}
+
+/* Accepts clients through the ring (`FIO_POLL_ACCEPT`). */
+static void test_poll_uring_accept(void) {
+  poll_counts_s counts = {0};
+  fio_socket_i listener =
+      fio_sock_open("127.0.0.1", "0", FIO_SOCK_TCP | FIO_SOCK_SERVER);
+  FIO_ASSERT(FIO_SOCK_FD_ISVALID(listener), "listener failed to open");
+  struct sockaddr_storage addr = {0};
+  socklen_t addrlen = sizeof(addr);
+  FIO_ASSERT(!getsockname(listener, (struct sockaddr *)&addr, &addrlen),
+             "getsockname failed");
+  char port_str[8];
+  snprintf(port_str,
+           sizeof(port_str),
+           "%u",
+           ntohs(((struct sockaddr_in *)&addr)->sin_port));
+  fio_poll_s p;
+  fio_poll_init(&p,
+                .on_data = cb_on_data,
+                .on_ready = cb_on_ready,
+                .on_close = cb_on_close);
+  FIO_ASSERT(!fio_poll_monitor(&p, listener, &counts, POLLIN | FIO_POLL_ACCEPT),
+             "fio_poll_monitor failed for ring accept");
+  fio_poll_review(&p, 0);
+  fio_socket_i clients[3];
+  for (size_t i = 0; i < 3; ++i) {
+    clients[i] =
+        fio_sock_open("127.0.0.1", port_str, FIO_SOCK_TCP | FIO_SOCK_CLIENT);
+    FIO_ASSERT(FIO_SOCK_FD_ISVALID(clients[i]), "client failed to open");
+  }
+  TEST_URING_REVIEW_UNTIL(&p, counts.on_data_count);
+  FIO_ASSERT(counts.on_data_count == 1, "ring accept should fire on_data");
+  size_t accepted = 0;
+  for (size_t i = 0; i < 100 && accepted < 3; ++i) {
+    fio_socket_i fd = fio_poll_accept(&p, listener);
+    if (!FIO_SOCK_FD_ISVALID(fd)) {
+      FIO_ASSERT(errno == EWOULDBLOCK || errno == EAGAIN,
+                 "fio_poll_accept failed: %s",
+                 strerror(errno));
+      fio_poll_review(&p, 10);
+      continue;
+    }
+    ++accepted;
+    fio_sock_close(fd);
+  }
+  FIO_ASSERT(accepted == 3, "all clients should be accepted (%zu)", accepted);
+  fio_poll_destroy(&p);
+  for (size_t i = 0; i < 3; ++i)
+    fio_sock_close(clients[i]);
+  fio_sock_close(listener);
+  fprintf(stderr, "* io_uring ring accept: OK\n");
+}
+#undef TEST_URING_REVIEW_UNTIL
+#endif /* FIO_POLL_ENGINE_URING */
+
 int main(void) {
   fprintf(stderr,
           "=== Poll subsystem test (engine: %s) ===\n",
           FIO_POLL_ENGINE_STR);
+#if defined(FIO_POLL_ENGINE_URING)
+  { /* io_uring may be disabled (e.g., by a container's seccomp policy) */
+    fio_poll_s p;
+    fio_poll_init(&p, .on_data = cb_on_data);
+    const int available = (p.fd != -1);
+    fio_poll_destroy(&p);
+    if (!available) {
+      fprintf(stderr, "* SKIPPED: io_uring unavailable.\n");
+      return 0;
+    }
+  }
+#endif
 
   test_poll_engine_and_init();
   test_poll_on_ready();
@@ -320,6 +528,11 @@ int main(void) {
 #if defined(FIO_POLL_ENGINE_POLL)
   test_poll_invalid_arguments();
 #endif
+#if defined(FIO_POLL_ENGINE_URING)
+  test_poll_uring_fd_reuse();
+  test_poll_uring_io();
+  test_poll_uring_accept();
+#endif
 
   fprintf(stderr, "=== All poll tests passed ===\n");
   return 0;
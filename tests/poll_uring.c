@@ -0,0 +1,10 @@
+/* *****************************************************************************
+Test - POSIX portable polling, io_uring backend
+
+Runs the tests/poll.c suite with FIO_POLL_ENGINE_URING (Linux only), which is
+never selected automatically. Skipped when io_uring is unavailable.
+***************************************************************************** */
+#if defined(__linux__)
+#define FIO_POLL_ENGINE_URING
+#endif
+#include "poll.c"
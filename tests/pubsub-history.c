@@ -47,6 +47,121 @@ static void test_history_cache_api(void) {
   fprintf(stderr, "* FIO_PUBSUB history cache API tests passed.\n");
 }
 
+/* *****************************************************************************
+Unit Tests - History Cache Ordering, Duplicates and Eviction
+***************************************************************************** */
+
+static uint64_t psh_cache_ids[32];
+static size_t psh_cache_ids_count = 0;
+
+/* authors a message in the IPC format used by pub/sub (payload == id) */
+static int psh_cache_push(const char *channel, uint64_t timestamp, uint64_t id) {
+  fio_pubsub_history_s const *cache = fio_pubsub_history_cache(0);
+  uint32_t header[2] = {(uint32_t)FIO_STRLEN(channel), (uint32_t)sizeof(id)};
+  fio_ipc_s *ipc = fio_ipc_new(
+      .timestamp = timestamp,
+      .id = id,
+      .data = FIO_IPC_DATA(FIO_BUF_INFO2((char *)header, sizeof(header)),
+                           FIO_BUF_INFO1((char *)channel),
+                           FIO_BUF_INFO2((char *)"\0", 1),
+                           FIO_BUF_INFO2((char *)&id, sizeof(id)),
+                           FIO_BUF_INFO2((char *)"\0", 1)));
+  FIO_ASSERT_ALLOC(ipc);
+  fio_pubsub_msg_s msg = fio_pubsub_ipc2msg(ipc);
+  int r = cache->push(cache, &msg);
+  fio_ipc_free(ipc);
+  return r;
+}
+
+static void psh_cache_collect(fio_pubsub_msg_s *msg, void *udata) {
+  uint64_t id;
+  FIO_ASSERT(msg->message.len == sizeof(id), "replayed message corrupted");
+  FIO_MEMCPY(&id, msg->message.buf, sizeof(id));
+  FIO_ASSERT(id == msg->id, "replayed message payload mismatch");
+  if (psh_cache_ids_count < 32)
+    psh_cache_ids[psh_cache_ids_count] = id;
+  ++psh_cache_ids_count;
+  (void)udata;
+}
+
+static void psh_cache_expect(const char *channel,
+                             uint64_t since,
+                             const uint64_t *ids,
+                             size_t count) {
+  fio_pubsub_history_s const *cache = fio_pubsub_history_cache(0);
+  psh_cache_ids_count = 0;
+  cache->replay(cache,
+                FIO_BUF_INFO1((char *)channel),
+                0,
+                since,
+                psh_cache_collect,
+                NULL,
+                NULL);
+  FIO_ASSERT(psh_cache_ids_count == count,
+             "replay of %s since %zu should return %zu messages (got %zu)",
+             channel,
+             (size_t)since,
+             count,
+             psh_cache_ids_count);
+  for (size_t i = 0; i < count; ++i)
+    FIO_ASSERT(psh_cache_ids[i] == ids[i],
+               "replay order error at %zu: expected %zu, got %zu",
+               i,
+               (size_t)ids[i],
+               (size_t)psh_cache_ids[i]);
+}
+
+static void test_history_cache_ordering(void) {
+  fprintf(stderr, "* Testing FIO_PUBSUB history cache ordering / eviction.\n");
+  fio_pubsub_history_s const *cache = fio_pubsub_history_cache(0);
+  const uint64_t base = 1000;
+
+  for (uint64_t i = 0; i < 10; ++i)
+    FIO_ASSERT(!psh_cache_push("a", base + i, i + 1), "push failed");
+  /* late arrival: placed after messages with an equal timestamp */
+  FIO_ASSERT(!psh_cache_push("a", base + 4, 100), "push failed");
+  {
+    size_t size = FIO___PUBSUB_POSTOFFICE.cache.size;
+    FIO_ASSERT(!psh_cache_push("a", base + 5, 6), "duplicate push failed");
+    FIO_ASSERT(size == FIO___PUBSUB_POSTOFFICE.cache.size,
+               "duplicate messages should be filtered");
+  }
+  {
+    const uint64_t expected[] = {5, 100, 6, 7, 8, 9, 10};
+    psh_cache_expect("a", base + 4, expected, 7);
+    psh_cache_expect("a", base + 10, NULL, 0);
+  }
+  FIO_ASSERT(cache->oldest(cache, FIO_BUF_INFO1((char *)"a"), 0) == base,
+             "oldest timestamp error");
+  FIO_ASSERT(cache->oldest(cache, FIO_BUF_INFO1((char *)"a"), 1) == UINT64_MAX,
+             "filter should be part of the channel's identity");
+
+  /* limit the cache to its current size, so each push evicts a message */
+  fio_pubsub_history_cache(FIO___PUBSUB_POSTOFFICE.cache.size);
+  for (uint64_t i = 0; i < 6; ++i)
+    FIO_ASSERT(!psh_cache_push("b", base + 20 + i, 200 + i), "push failed");
+  {
+    /* evicted in arrival order (1-6), even though 100 is older than 6 */
+    const uint64_t expected[] = {100, 7, 8, 9, 10};
+    psh_cache_expect("a", 1, expected, 5);
+  }
+  for (uint64_t i = 6; i < 11; ++i)
+    FIO_ASSERT(!psh_cache_push("b", base + 20 + i, 200 + i), "push failed");
+  FIO_ASSERT(cache->oldest(cache, FIO_BUF_INFO1((char *)"a"), 0) == UINT64_MAX,
+             "evicted channel should have no history");
+  FIO_ASSERT(!fio___pubsub_history_cache_channel(&FIO___PUBSUB_POSTOFFICE.cache,
+                                                 FIO_BUF_INFO1((char *)"a"),
+                                                 0),
+             "empty channels should be removed from the cache");
+  FIO_ASSERT(cache->oldest(cache, FIO_BUF_INFO1((char *)"b"), 0) == base + 20,
+             "oldest timestamp error after eviction");
+
+  cache->detached(cache);
+  FIO_ASSERT(!FIO___PUBSUB_POSTOFFICE.cache.size, "cache should be empty");
+  fio_pubsub_history_cache(FIO_PUBSUB_HISTORY_DEFAULT_CACHE_SIZE_LIMIT);
+  fprintf(stderr, "* FIO_PUBSUB history cache ordering tests passed.\n");
+}
+
 /* *****************************************************************************
 Unit Tests - Custom History Manager Attach/Detach
 ***************************************************************************** */
@@ -219,9 +334,15 @@ static void test_history_replay_integration(void) {
   FIO_ASSERT(fio_pubsub_history_attach(fio_pubsub_history_cache(0), 100) == 0,
              "attaching cache manager should succeed");
 
-  fio_io_run_every(.fn = psh_publish_history, .every = 50, .repetitions = 1);
-  fio_io_run_every(.fn = psh_subscribe_history, .every = 100, .repetitions = 1);
-  fio_io_run_every(.fn = psh_timeout, .every = 500, .repetitions = 1);
+  fio_timer_free(fio_io_run_every(.fn = psh_publish_history,
+                                  .every = 50,
+                                  .repetitions = 1));
+  fio_timer_free(fio_io_run_every(.fn = psh_subscribe_history,
+                                  .every = 100,
+                                  .repetitions = 1));
+  fio_timer_free(fio_io_run_every(.fn = psh_timeout,
+                                  .every = 500,
+                                  .repetitions = 1));
 
   fio_io_start(0);
 
@@ -258,6 +379,7 @@ int main(void) {
   fprintf(stderr, "=== Pub/Sub history correctness tests ===\n");
 
   test_history_cache_api();
+  test_history_cache_ordering();
   test_history_manager_api();
   test_history_replay_integration();
 
@@ -29,6 +29,7 @@ static volatile size_t ps_ipc_received = 0;
 static volatile size_t ps_cluster_received = 0;
 static volatile size_t ps_handle_received = 0;
 static volatile size_t ps_handle_unsub = 0;
+static volatile size_t ps_index_received[5] = {0};
 
 /* *****************************************************************************
 Unit Tests - Type Sizes and Layouts
@@ -220,6 +221,23 @@ FIO_SFUNC void ps_handle_on_unsubscribe(void *udata) {
   fio_atomic_add(&ps_handle_unsub, 1);
 }
 
+/* patterns with different literal prefixes (tests the pattern index) */
+static struct {
+  const char *pattern;
+  int16_t filter;
+  size_t expected;
+} ps_index_patterns[5] = {
+    {"ps-idx/*", 0, 3},
+    {"*/ps-idx", 0, 1},
+    {"ps-idx/a?pha/[0-9]", 0, 1},
+    {"ps-idx/*", 3, 1},
+    {"ps-idx/alpha/1/longer-literal-prefix-than-the-index-keeps-????", 0, 1},
+};
+
+FIO_SFUNC void ps_index_on_message(fio_pubsub_msg_s *msg) {
+  fio_atomic_add(ps_index_received + (uintptr_t)msg->udata, 1);
+}
+
 static uintptr_t ps_handle = 0;
 
 FIO_SFUNC int ps_subscribe_all(void *ignr_1, void *ignr_2) {
@@ -256,6 +274,14 @@ FIO_SFUNC int ps_subscribe_all(void *ignr_1, void *ignr_2) {
                        .on_unsubscribe = ps_handle_on_unsubscribe,
                        .subscription_handle_ptr = &ps_handle);
 
+  for (size_t i = 0; i < 5; ++i)
+    fio_pubsub_subscribe(
+        .channel = FIO_BUF_INFO1((char *)ps_index_patterns[i].pattern),
+        .on_message = ps_index_on_message,
+        .udata = (void *)(uintptr_t)i,
+        .filter = ps_index_patterns[i].filter,
+        .is_pattern = 1);
+
   return -1;
 }
 
@@ -320,6 +346,22 @@ FIO_SFUNC int ps_publish_all(void *ignr_1, void *ignr_2) {
   fio_pubsub_publish(.channel = FIO_BUF_INFO1(PS_HANDLE_CHANNEL),
                      .message = FIO_BUF_INFO1("handle-message-1"));
 
+  fio_pubsub_publish(.channel = FIO_BUF_INFO1("ps-idx/alpha/1"),
+                     .message = FIO_BUF_INFO1("index"));
+  fio_pubsub_publish(.channel = FIO_BUF_INFO1("ps-idx/beta/2"),
+                     .message = FIO_BUF_INFO1("index"));
+  fio_pubsub_publish(.channel = FIO_BUF_INFO1("ps-idxed"),
+                     .message = FIO_BUF_INFO1("index"));
+  fio_pubsub_publish(.channel = FIO_BUF_INFO1("other/ps-idx"),
+                     .message = FIO_BUF_INFO1("index"));
+  fio_pubsub_publish(.channel = FIO_BUF_INFO1("ps-idx/filtered"),
+                     .message = FIO_BUF_INFO1("index"),
+                     .filter = 3);
+  fio_pubsub_publish(
+      .channel = FIO_BUF_INFO1(
+          "ps-idx/alpha/1/longer-literal-prefix-than-the-index-keeps-tail"),
+      .message = FIO_BUF_INFO1("index"));
+
   return -1;
 }
 
@@ -362,6 +404,8 @@ static void test_pubsub_integration(void) {
   ps_handle_received = 0;
   ps_handle_unsub = 0;
   ps_handle = 0;
+  for (size_t i = 0; i < 5; ++i)
+    ps_index_received[i] = 0;
 
   for (size_t i = 0; i < 4; ++i) {
     fio_pubsub_subscribe(.channel = FIO_BUF_INFO1("should_auto_free1"),
@@ -372,14 +416,24 @@ static void test_pubsub_integration(void) {
                          .on_message = ps_handle_on_message_noop);
   }
 
-  fio_io_run_every(.fn = ps_subscribe_all, .every = 50, .repetitions = 1);
-  fio_io_run_every(.fn = ps_unsubscribe, .every = 100, .repetitions = 1);
-  fio_io_run_every(.fn = ps_publish_all, .every = 150, .repetitions = 1);
-  fio_io_run_every(.fn = ps_unsubscribe_handle, .every = 200, .repetitions = 1);
-  fio_io_run_every(.fn = ps_publish_after_handle_unsub,
-                   .every = 250,
-                   .repetitions = 1);
-  fio_io_run_every(.fn = ps_timeout, .every = 500, .repetitions = 1);
+  fio_timer_free(fio_io_run_every(.fn = ps_subscribe_all,
+                                  .every = 50,
+                                  .repetitions = 1));
+  fio_timer_free(fio_io_run_every(.fn = ps_unsubscribe,
+                                  .every = 100,
+                                  .repetitions = 1));
+  fio_timer_free(fio_io_run_every(.fn = ps_publish_all,
+                                  .every = 150,
+                                  .repetitions = 1));
+  fio_timer_free(fio_io_run_every(.fn = ps_unsubscribe_handle,
+                                  .every = 200,
+                                  .repetitions = 1));
+  fio_timer_free(fio_io_run_every(.fn = ps_publish_after_handle_unsub,
+                                  .every = 250,
+                                  .repetitions = 1));
+  fio_timer_free(fio_io_run_every(.fn = ps_timeout,
+                                  .every = 500,
+                                  .repetitions = 1));
 
   fio_io_start(0);
 
@@ -404,6 +458,16 @@ static void test_pubsub_integration(void) {
              ps_pattern_received);
   fprintf(stderr, "PASS\n");
 
+  fprintf(stderr, "  - Pattern index: ");
+  for (size_t i = 0; i < 5; ++i)
+    FIO_ASSERT(ps_index_received[i] == ps_index_patterns[i].expected,
+               "Pattern %s (filter %d) should match %zu messages (got %zu)",
+               ps_index_patterns[i].pattern,
+               (int)ps_index_patterns[i].filter,
+               ps_index_patterns[i].expected,
+               ps_index_received[i]);
+  fprintf(stderr, "PASS\n");
+
   fprintf(stderr, "  - Filter namespace: ");
   FIO_ASSERT(ps_filter0_received == 1,
              "Filter 0 should receive exactly 1 message (got %zu)",
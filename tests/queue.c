@@ -116,19 +116,143 @@ FIO_SFUNC void test_queue_urgent_and_recursive_tasks(void) {
   fio_queue_destroy(&q);
 }
 
+/* returns ordered tasks until `*remaining` reaches zero */
+FIO_SFUNC fio_queue_task_s fio___queue_batch_next(void *remaining_) {
+  size_t *remaining = (size_t *)remaining_;
+  size_t i = FIO___QUEUE_TEST_COUNT - *remaining;
+  if (!*remaining)
+    return (fio_queue_task_s){.fn = NULL};
+  --*remaining;
+  return (fio_queue_task_s){.fn = fio___queue_order_task,
+                            .udata1 = (void *)(i + 1),
+                            .udata2 = (void *)(i + 2)};
+}
+
+FIO_SFUNC void test_queue_push_batch(void) {
+  fio_queue_s q;
+  fio_queue_init(&q);
+  size_t remaining = FIO___QUEUE_TEST_COUNT;
+  fio___queue_order_task(NULL, NULL);
+  FIO_ASSERT(fio_queue_push_batch(&q, fio___queue_batch_next, &remaining) ==
+                     FIO___QUEUE_TEST_COUNT &&
+                 !remaining,
+             "fio_queue_push_batch should push every task");
+  FIO_ASSERT(fio_queue_count(&q) == FIO___QUEUE_TEST_COUNT,
+             "queue count after batch push");
+  FIO_ASSERT(!fio_queue_push_batch(&q, fio___queue_batch_next, &remaining),
+             "an empty batch should push nothing");
+  fio_queue_perform_all(&q); /* asserts the FIFO order */
+  FIO_ASSERT(!fio_queue_count(&q), "queue should be empty after perform_all");
+  fio_queue_destroy(&q);
+}
+
+/* a binary tree of tasks: workers push the children to their local deques */
+FIO_SFUNC void fio___queue_spawn_task(void *info_, void *depth_) {
+  fio___queue_test_s *info = (fio___queue_test_s *)info_;
+  uintptr_t depth = (uintptr_t)depth_;
+  fio_atomic_add(info->counter, 1);
+  if (!depth--)
+    return;
+  for (size_t i = 0; i < 2; ++i)
+    FIO_ASSERT(!fio_queue_push(info->q,
+                               fio___queue_spawn_task,
+                               info,
+                               (void *)depth),
+               "work-stealing push from task failed");
+}
+
+FIO_SFUNC void test_queue_work_stealing(void) {
+  const size_t roots = 8;
+  const uintptr_t depth = 10; /* 2047 tasks per root */
+  const uintptr_t expected = roots * ((2U << depth) - 1) + 1;
+  fio_queue_s q;
+  fio_queue_init(&q);
+  uintptr_t counter = 0;
+  fio___queue_test_s info = {.q = &q, .counter = &counter};
+  FIO_ASSERT(!fio_queue_workers_add_stealing(&q, 4),
+             "fio_queue_workers_add_stealing failed");
+  for (size_t i = 0; i < roots; ++i)
+    FIO_ASSERT(
+        !fio_queue_push(&q, fio___queue_spawn_task, &info, (void *)depth),
+        "work-stealing push failed");
+  FIO_ASSERT(!fio_queue_push_urgent(&q, fio___queue_increment_task, &counter),
+             "work-stealing urgent push failed");
+  for (;;) {
+    uintptr_t done;
+    /* a non-worker thread may help (steals from the workers' deques) */
+    fio_queue_perform(&q);
+    fio_atomic_load(done, &counter);
+    if (done == expected)
+      break;
+    FIO_ASSERT(done < expected, "work-stealing performed too many tasks");
+    FIO_THREAD_RESCHEDULE();
+  }
+  fio_queue_workers_join(&q);
+  FIO_ASSERT(!fio_queue_count(&q), "work-stealing queue should be empty");
+  fio_queue_destroy(&q);
+}
+
+/* a worker refilling its deque while thieves still hold claimed cells */
+FIO_SFUNC void test_queue_work_stealing_refill(void) {
+  static fio___queue_deque_s d;
+  fio_queue_s q;
+  fio_queue_init(&q);
+  fio___thread_group_s grp = {.queue = &q, .workers = 1, .deques = &d};
+  uintptr_t counter = 0;
+  fio_queue_task_s t, claimed[2];
+  fio___queue_deque_init(&d, &grp, 0);
+  for (size_t i = 0; i < FIO_QUEUE_STEAL_CAPACITY; ++i) {
+    fio_atomic_add(&q.local, 1);
+    FIO_ASSERT(!fio___queue_deque_push(
+                   &d,
+                   (fio_queue_task_s){.fn = fio___queue_increment_task,
+                                      .udata1 = &counter}),
+               "deque push failed");
+  }
+  /* two thieves advanced `head`, neither republished its cell yet */
+  for (size_t i = 0; i < 2; ++i) {
+    claimed[i] = d.cells[i].task;
+    fio_atomic_add(&d.head, 1);
+  }
+  fio_queue_push_urgent(&q, fio___queue_increment_task, &counter, (void *)1);
+  fio_queue_push(&q, fio___queue_increment_task, &counter, (void *)2);
+  fio_queue_push(&q, fio___queue_increment_task, &counter, (void *)3);
+  t = fio___queue_pop_worker(&d);
+  FIO_ASSERT(t.udata2 == (void *)1, "urgent task should be popped first");
+  FIO_ASSERT(q.count == 2 && q.local == FIO_QUEUE_STEAL_CAPACITY,
+             "a task that didn't fit the deque was lost (%zu, %zu)",
+             (size_t)q.count,
+             (size_t)q.local);
+  /* the thieves complete */
+  for (size_t i = 0; i < 2; ++i) {
+    fio_atomic_exchange(&d.cells[i].seq, i + FIO_QUEUE_STEAL_CAPACITY);
+    fio_atomic_sub(&q.local, 1);
+    claimed[i].fn(claimed[i].udata1, claimed[i].udata2);
+  }
+  FIO_ASSERT(fio_queue_pop(&q).udata2 == (void *)2 &&
+                 fio_queue_pop(&q).udata2 == (void *)3,
+             "returned task should keep its place in the shared ring");
+  while ((t = fio___queue_deque_pop(&d)).fn)
+    t.fn(t.udata1, t.udata2);
+  FIO_ASSERT(counter == FIO_QUEUE_STEAL_CAPACITY && !fio_queue_count(&q),
+             "work-stealing refill lost tasks (%zu)",
+             (size_t)counter);
+  fio_queue_destroy(&q);
+}
+
 FIO_SFUNC void test_timer_queue(void) {
   fio_queue_s q;
   fio_queue_init(&q);
   fio_timer_queue_s timers = FIO_TIMER_QUEUE_INIT;
   uintptr_t counter = 0;
 
-  fio_timer_schedule(&timers,
-                     .fn = fio___queue_timer_task,
-                     .udata1 = &counter,
-                     .on_finish = fio___queue_increment_task,
-                     .every = 1,
-                     .repetitions = -1,
-                     .start_at = fio_time_milli() - 10);
+  fio_timer_free(fio_timer_schedule(&timers,
+                                    .fn = fio___queue_timer_task,
+                                    .udata1 = &counter,
+                                    .on_finish = fio___queue_increment_task,
+                                    .every = 1,
+                                    .repetitions = -1,
+                                    .start_at = fio_time_milli() - 10));
   FIO_ASSERT(counter == 0, "valid timer should be scheduled, not run inline");
   for (size_t i = 0; i < 8; ++i) {
     uint64_t now = fio_time_milli();
@@ -145,26 +269,294 @@ FIO_SFUNC void test_timer_queue(void) {
 
   counter = 0;
   int64_t now = fio_time_milli();
-  fio_timer_schedule(&timers,
-                     .fn = fio___queue_timer_task,
-                     .udata1 = &counter,
-                     .on_finish = fio___queue_increment_task,
-                     .every = 1,
-                     .repetitions = 1,
-                     .start_at = now - 10);
+  fio_timer_free(fio_timer_schedule(&timers,
+                                    .fn = fio___queue_timer_task,
+                                    .udata1 = &counter,
+                                    .on_finish = fio___queue_increment_task,
+                                    .every = 1,
+                                    .repetitions = 1,
+                                    .start_at = now - 10));
   fio_timer_push2queue(&q, &timers, now);
   FIO_ASSERT(fio_queue_count(&q) == 1, "single-use timer not enqueued");
   fio_queue_perform(&q);
   FIO_ASSERT(counter == 2, "single-use timer plus on_finish count mismatch");
   fio_timer_destroy(&timers);
-  FIO_ASSERT(!timers.next, "timer queue should be empty after destroy");
+  FIO_ASSERT(!timers.next && !timers.count,
+             "timer queue should be empty after destroy");
+
+  fio_queue_destroy(&q);
+}
+
+/* timing wheel: events fire on the first push at / after their due time */
+typedef struct {
+  int64_t due;
+  uint32_t every;
+  uint32_t fired;
+  uint32_t overdue;
+} fio___queue_wheel_test_s;
+
+static int64_t fio___queue_wheel_now;
+static int64_t fio___queue_wheel_prev;
+
+FIO_SFUNC int fio___queue_wheel_task(void *t_, void *ignr_) {
+  fio___queue_wheel_test_s *t = (fio___queue_wheel_test_s *)t_;
+  FIO_ASSERT(t->due <= fio___queue_wheel_now,
+             "timer fired early (due %lld, now %lld)",
+             (long long)t->due,
+             (long long)fio___queue_wheel_now);
+  FIO_ASSERT(t->overdue || t->due > fio___queue_wheel_prev,
+             "timer fired late (due %lld, previous push %lld)",
+             (long long)t->due,
+             (long long)fio___queue_wheel_prev);
+  t->due += t->every;
+  /* repeating timers that fell behind are performed on the next push */
+  t->overdue = (t->due <= fio___queue_wheel_now);
+  ++t->fired;
+  return 0;
+  (void)ignr_;
+}
+
+FIO_SFUNC void test_timer_queue_wheel(void) {
+  const size_t count = 4096;
+  const uint32_t repetitions = 3;
+  fio_queue_s q;
+  fio_queue_init(&q);
+  fio_timer_queue_s timers = FIO_TIMER_QUEUE_INIT;
+  fio___queue_wheel_test_s *t = (fio___queue_wheel_test_s *)calloc(
+      count,
+      sizeof(*t));
+  FIO_ASSERT_ALLOC(t);
+  fio___queue_wheel_now = fio___queue_wheel_prev = 1000000;
+  for (size_t i = 0; i < count; ++i) {
+    /* a mix of short, medium and long (multi-level) intervals */
+    t[i].every = (uint32_t)(fio_rand64() >> (40 + (i & 15)));
+    t[i].every += !t[i].every;
+    t[i].due = fio___queue_wheel_now + t[i].every;
+    fio_timer_free(fio_timer_schedule(&timers,
+                                      .fn = fio___queue_wheel_task,
+                                      .udata1 = t + i,
+                                      .every = t[i].every,
+                                      .repetitions = (int32_t)repetitions,
+                                      .start_at = fio___queue_wheel_now));
+  }
+  size_t done = 0;
+  while (done < count) {
+    /* mix tiny and large clock steps (wheel cascades / idle skips) */
+    const uint64_t rnd = fio_rand64();
+    fio___queue_wheel_now += (int64_t)(1 + (rnd >> (48 + (rnd & 15))));
+    fio_timer_push2queue(&q, &timers, fio___queue_wheel_now);
+    fio_queue_perform_all(&q);
+    fio___queue_wheel_prev = fio___queue_wheel_now;
+    int64_t min_due = (int64_t)((~(uint64_t)0) >> 1);
+    done = 0;
+    for (size_t i = 0; i < count; ++i) {
+      if (t[i].fired == repetitions) {
+        ++done;
+        continue;
+      }
+      if (t[i].due < min_due)
+        min_due = t[i].due;
+    }
+    const int64_t next_at = fio_timer_next_at(&timers);
+    FIO_ASSERT(next_at > fio___queue_wheel_now ||
+                   min_due <= fio___queue_wheel_now,
+               "fio_timer_next_at should point to the future (%lld <= %lld)",
+               (long long)next_at,
+               (long long)fio___queue_wheel_now);
+    FIO_ASSERT(next_at <= min_due,
+               "fio_timer_next_at after the earliest event (%lld > %lld)",
+               (long long)next_at,
+               (long long)min_due);
+  }
+  FIO_ASSERT(!timers.count, "all finished timers should leave the wheel");
+  fio_timer_destroy(&timers);
+  fio_queue_destroy(&q);
+  free(t);
+}
+
+/* udata1 points to {performed, finished} counters */
+FIO_SFUNC int fio___queue_cancel_task(void *counters_, void *ignr_) {
+  fio_atomic_add((uintptr_t *)counters_, 1);
+  return 0;
+  (void)ignr_;
+}
+
+FIO_SFUNC void fio___queue_cancel_finish(void *counters_, void *ignr_) {
+  fio_atomic_add((uintptr_t *)counters_ + 1, 1);
+  (void)ignr_;
+}
+
+typedef struct {
+  fio_timer_s **handles;
+  size_t count;
+} fio___queue_cancel_thread_s;
+
+FIO_SFUNC void *fio___queue_cancel_thread(void *info_) {
+  fio___queue_cancel_thread_s *info = (fio___queue_cancel_thread_s *)info_;
+  for (size_t i = 0; i < info->count; ++i)
+    fio_timer_cancel(info->handles[i]);
+  return NULL;
+}
+
+FIO_SFUNC void test_timer_queue_cancel(void) {
+  fio_queue_s q;
+  fio_queue_init(&q);
+  fio_timer_queue_s timers = FIO_TIMER_QUEUE_INIT;
+  uintptr_t c[2] = {0};
+  const int64_t now = 1000000;
+  fio_timer_s *h;
 
+  /* cancelling a pending timer finishes it immediately */
+  h = fio_timer_schedule(&timers,
+                         .fn = fio___queue_cancel_task,
+                         .udata1 = c,
+                         .on_finish = fio___queue_cancel_finish,
+                         .every = 10,
+                         .repetitions = -1,
+                         .start_at = now);
+  FIO_ASSERT(h, "fio_timer_schedule should return a handle");
+  FIO_ASSERT(!fio_timer_cancel(h), "fio_timer_cancel failed");
+  FIO_ASSERT(c[0] == 0 && c[1] == 1, "cancel should call on_finish at once");
+  FIO_ASSERT(!timers.count, "cancelled timer should leave the wheel");
+  FIO_ASSERT(fio_timer_cancel(h) == -1, "double cancel should fail");
+  FIO_ASSERT(fio_timer_reschedule(h, 1, now) == -1,
+             "rescheduling a cancelled timer should fail");
+  fio_timer_free(h);
+  FIO_ASSERT(!fio_timer_push2queue(&q, &timers, now + 100),
+             "cancelled timer shouldn't fire");
+
+  /* rescheduling a pending timer */
+  c[0] = c[1] = 0;
+  h = fio_timer_schedule(&timers,
+                         .fn = fio___queue_cancel_task,
+                         .udata1 = c,
+                         .on_finish = fio___queue_cancel_finish,
+                         .every = 100000,
+                         .repetitions = 2,
+                         .start_at = now);
+  FIO_ASSERT(!fio_timer_reschedule(h, 5, now + 1), "reschedule failed");
+  FIO_ASSERT(fio_timer_next_at(&timers) <= now + 6,
+             "rescheduled timer should be due sooner");
+  FIO_ASSERT(!fio_timer_push2queue(&q, &timers, now + 5),
+             "rescheduled timer fired early");
+  FIO_ASSERT(fio_timer_push2queue(&q, &timers, now + 6) == 1,
+             "rescheduled timer didn't fire");
+  fio_queue_perform_all(&q);
+  FIO_ASSERT(c[0] == 1 && !c[1], "rescheduled timer should repeat once more");
+
+  /* rescheduling an in-flight timer */
+  FIO_ASSERT(fio_timer_push2queue(&q, &timers, now + 11) == 1,
+             "repeating timer didn't fire");
+  FIO_ASSERT(!fio_timer_reschedule(h, 0, now + 100),
+             "rescheduling an in-flight timer failed");
+  fio_queue_perform_all(&q);
+  FIO_ASSERT(c[0] == 2 && c[1] == 1, "final repetition should still finish");
+  FIO_ASSERT(fio_timer_cancel(h) == -1, "finished timer can't be cancelled");
+  fio_timer_free(h);
+
+  /* cancelling an in-flight timer */
+  c[0] = c[1] = 0;
+  h = fio_timer_schedule(&timers,
+                         .fn = fio___queue_cancel_task,
+                         .udata1 = c,
+                         .on_finish = fio___queue_cancel_finish,
+                         .every = 10,
+                         .repetitions = -1,
+                         .start_at = now);
+  FIO_ASSERT(!fio_timer_reschedule(h, 0, now + 100),
+             "rescheduling a pending timer failed");
+  FIO_ASSERT(fio_timer_push2queue(&q, &timers, now + 110) == 1,
+             "pending timer didn't fire");
+  FIO_ASSERT(!fio_timer_reschedule(h, 0, now + 200),
+             "rescheduling an in-flight timer failed");
+  fio_queue_perform_all(&q);
+  FIO_ASSERT(c[0] == 1 && !c[1], "in-flight reschedule should keep the timer");
+  FIO_ASSERT(!fio_timer_push2queue(&q, &timers, now + 209),
+             "in-flight reschedule ignored");
+  FIO_ASSERT(fio_timer_push2queue(&q, &timers, now + 210) == 1,
+             "in-flight reschedule lost the timer");
+  FIO_ASSERT(!fio_timer_cancel(h), "cancelling an in-flight timer failed");
+  FIO_ASSERT(!c[1], "in-flight timers finish after their queued task");
+  fio_queue_perform_all(&q);
+  FIO_ASSERT(c[0] == 1 && c[1] == 1,
+             "cancelled in-flight timer shouldn't be performed");
+  FIO_ASSERT(!timers.count, "cancelled timer shouldn't be rescheduled");
+  fio_timer_free(h);
+
+  /* cancelling a fired timer after its timer queue was destroyed */
+  {
+    fio_timer_queue_s *tq = (fio_timer_queue_s *)malloc(sizeof(*tq));
+    FIO_ASSERT_ALLOC(tq);
+    *tq = (fio_timer_queue_s)FIO_TIMER_QUEUE_INIT;
+    c[0] = c[1] = 0;
+    h = fio_timer_schedule(tq,
+                           .fn = fio___queue_cancel_task,
+                           .udata1 = c,
+                           .on_finish = fio___queue_cancel_finish,
+                           .every = 10,
+                           .repetitions = 1,
+                           .start_at = now);
+    FIO_ASSERT(fio_timer_push2queue(&q, tq, now + 10) == 1,
+               "one-shot timer didn't fire");
+    fio_queue_perform_all(&q);
+    FIO_ASSERT(c[0] == 1 && c[1] == 1, "one-shot timer should finish");
+    fio_timer_destroy(tq);
+    free(tq);
+    FIO_ASSERT(fio_timer_cancel(h) == -1,
+               "cancelling a fired timer should fail");
+    FIO_ASSERT(fio_timer_reschedule(h, 5, now) == -1,
+               "rescheduling a fired timer should fail");
+    fio_timer_free(h);
+    FIO_ASSERT(c[1] == 1, "a fired timer should finish only once");
+  }
+
+  /* cancelling from another thread while the timers fire */
+  {
+    const size_t count = 1024;
+    fio_timer_s *handles[1024];
+    fio___queue_cancel_thread_s info = {.handles = handles, .count = count};
+    fio_thread_t thread;
+    c[0] = c[1] = 0;
+    for (size_t i = 0; i < count; ++i)
+      handles[i] = fio_timer_schedule(&timers,
+                                      .fn = fio___queue_cancel_task,
+                                      .udata1 = c,
+                                      .on_finish = fio___queue_cancel_finish,
+                                      .every = (uint32_t)(1 + (i & 7)),
+                                      .repetitions = -1,
+                                      .start_at = now);
+    FIO_ASSERT(!fio_thread_create(&thread, fio___queue_cancel_thread, &info),
+               "couldn't spawn cancelling thread");
+    for (int64_t t = now;; ++t) {
+      uintptr_t finished;
+      fio_timer_push2queue(&q, &timers, t);
+      fio_queue_perform_all(&q);
+      fio_atomic_load(finished, c + 1);
+      if (finished == count)
+        break;
+    }
+    fio_thread_join(&thread);
+    FIO_ASSERT(!timers.count && !fio_queue_count(&q),
+               "cancelled timers should leave the wheel and the queue");
+    for (size_t i = 0; i < count; ++i)
+      fio_timer_free(handles[i]);
+    FIO_ASSERT(c[1] == count,
+               "every cancelled timer should finish exactly once (%zu/%zu)",
+               (size_t)c[1],
+               count);
+  }
+  fio_timer_destroy(&timers);
   fio_queue_destroy(&q);
 }
 
 int main(void) {
   test_queue_basic_ordering();
   test_queue_urgent_and_recursive_tasks();
+  test_queue_push_batch();
+  test_queue_work_stealing();
+  test_queue_work_stealing_refill();
   test_timer_queue();
+  test_timer_queue_wheel();
+  test_timer_queue_cancel();
   return 0;
 }
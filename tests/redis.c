@@ -1644,12 +1644,12 @@ static void fio___redis_live_on_start(void *udata) {
    * SUBSCRIBE for all registered channels after HELLO. */
   fio_pubsub_subscribe(.channel = FIO_BUF_INFO1(FIO___REDIS_LIVE_CH),
                        .on_message = fio___redis_live_on_message);
-  fio_io_run_every(.fn = fio___redis_live_poll,
-                   .every = 10,
-                   .repetitions = -1);
-  fio_io_run_every(.fn = fio___redis_live_timeout,
-                   .every = 5000,
-                   .repetitions = 1);
+  fio_timer_free(fio_io_run_every(.fn = fio___redis_live_poll,
+                                  .every = 10,
+                                  .repetitions = -1));
+  fio_timer_free(fio_io_run_every(.fn = fio___redis_live_timeout,
+                                  .every = 5000,
+                                  .repetitions = 1));
 }
 
 static void test_redis_live_server(void) {
@@ -1891,12 +1891,12 @@ static void fio___redis_test_rof_on_start(void *udata) {
   fio_io_defer(fio___redis_connect,
                fio___redis_test_rof.engine,
                &fio___redis_test_rof.engine->conn);
-  fio_io_run_every(.fn = fio___redis_test_rof_poll,
-                   .every = 20,
-                   .repetitions = -1);
-  fio_io_run_every(.fn = fio___redis_test_rof_timeout,
-                   .every = 10000,
-                   .repetitions = 1);
+  fio_timer_free(fio_io_run_every(.fn = fio___redis_test_rof_poll,
+                                  .every = 20,
+                                  .repetitions = -1));
+  fio_timer_free(fio_io_run_every(.fn = fio___redis_test_rof_timeout,
+                                  .every = 10000,
+                                  .repetitions = 1));
 }
 
 static void test_redis_reconnect_on_drop(void) {
@@ -1930,6 +1930,668 @@ static void test_redis_reconnect_on_drop(void) {
              fio___redis_test_rof.attempts);
 }
 
+/* *****************************************************************************
+Pipelined Command Client (in-test RESP server)
+
+A minimal RESP server answers HELLO, PING, ECHO, INCR, MULTI and EXEC, so
+pipelining, pool distribution, transactions and direct parsing are verified
+without a live Redis server. XADD and XRANGE are emulated (IDs are "<n>-0")
+for the Redis Streams history manager.
+***************************************************************************** */
+
+#define FIO___REDIS_TEST_CL_COMMANDS 2000
+
+typedef struct {
+  fio_resp3_parser_s parser;
+  size_t len;
+  size_t commands;
+  uint8_t in_multi;
+  uint8_t streams; /* stream commands seen: 1 = XADD, 2 = XRANGE */
+  uint32_t queued;
+  size_t queued_len;
+  char queued_replies[1024];
+  char buf[65536];
+} fio___redis_test_srv_s;
+
+static struct {
+  fio_redis_client_s *client;
+  size_t accepted;
+  size_t busy;      /* server connections that received user commands */
+  size_t max_batch; /* most commands read by the server at once */
+  size_t errors;
+  size_t replies;
+  size_t parsed;
+  size_t pings;
+  int64_t counter;
+  int multi_ok;
+} fio___redis_test_cl;
+
+static char fio___redis_test_srv_out[1 << 17];
+
+static struct {
+  FIOBJ streams; /* key => array of [id, [field, value, ...]] */
+  int64_t last_id;
+  size_t ranges; /* XRANGE requests served */
+  fio_pubsub_history_s const *hist;
+  size_t replayed;
+  size_t large; /* streamed messages replayed */
+  size_t done;
+  size_t errors;
+  size_t shared; /* XADD and XRANGE sent on the same connection */
+} fio___redis_test_hs;
+
+/** Answers XADD / XRANGE (returns bytes written). */
+static size_t fio___redis_test_srv_stream(FIOBJ cmd, char *out) {
+  fio_str_info_s verb = fiobj2cstr(fiobj_array_get(cmd, 0));
+  fio_str_info_s key = fiobj2cstr(fiobj_array_get(cmd, 1));
+  if (!fio___redis_test_hs.streams)
+    fio___redis_test_hs.streams = fiobj_hash_new();
+  FIOBJ stream = fiobj_hash_get2(fio___redis_test_hs.streams, key.buf, key.len);
+  if (!stream) {
+    stream = fiobj_array_new();
+    fiobj_hash_set2(fio___redis_test_hs.streams, key.buf, key.len, stream);
+  }
+  FIOBJ reply;
+  if (verb.len == 4 && !FIO_MEMCMP(verb.buf, "XADD", 4)) {
+    /* XADD key MAXLEN ~ <max> * field value ... */
+    char id[32];
+    size_t len = fio_ltoa(id, ++fio___redis_test_hs.last_id, 10);
+    id[len++] = '-';
+    id[len++] = '0';
+    FIOBJ entry = fiobj_array_new();
+    FIOBJ fields = fiobj_array_new();
+    for (uint32_t i = 6; i < (uint32_t)fiobj_array_count(cmd); ++i)
+      fiobj_array_push(fields, fiobj_dup(fiobj_array_get(cmd, (int32_t)i)));
+    fiobj_array_push(entry, fiobj_str_new_cstr(id, len));
+    fiobj_array_push(entry, fields);
+    fiobj_array_push(stream, entry);
+    reply = fiobj_str_new_cstr(id, len);
+  } else {
+    /* XRANGE key <start> <end> COUNT <count> */
+    fio_str_info_s start = fiobj2cstr(fiobj_array_get(cmd, 2));
+    int64_t last = fiobj2i(fiobj_array_get(cmd, 3));
+    uint32_t count = (uint32_t)fiobj2i(fiobj_array_get(cmd, 5));
+    int64_t first = 0;
+    char *p = start.buf + (start.buf[0] == '(');
+    if (start.buf[0] != '-')
+      first = fio_atol(&p) + (start.buf[0] == '(');
+    ++fio___redis_test_hs.ranges;
+    reply = fiobj_array_new();
+    for (uint32_t i = 0; i < (uint32_t)fiobj_array_count(stream) &&
+                         (uint32_t)fiobj_array_count(reply) < count;
+         ++i) {
+      FIOBJ entry = fiobj_array_get(stream, (int32_t)i);
+      fio_str_info_s id = fiobj2cstr(fiobj_array_get(entry, 0));
+      p = id.buf;
+      int64_t n = fio_atol(&p);
+      if (n >= first && n <= last)
+        fiobj_array_push(reply, fiobj_dup(entry));
+    }
+  }
+  size_t len = (size_t)(fio___redis_fiobj2resp_write((uint8_t *)out, reply, 0) -
+                        (uint8_t *)out);
+  fiobj_free(reply);
+  return len;
+}
+
+static void fio___redis_test_srv_on_attach(fio_io_s *io) {
+  fio___redis_test_srv_s *s =
+      (fio___redis_test_srv_s *)FIO_MEM_REALLOC(NULL, 0, sizeof(*s), 0);
+  FIO_ASSERT_ALLOC(s);
+  FIO_MEMSET(s, 0, offsetof(fio___redis_test_srv_s, buf));
+  fio_io_udata_set(io, s);
+  ++fio___redis_test_cl.accepted;
+}
+
+static void fio___redis_test_srv_on_close(void *buffer, void *udata) {
+  (void)buffer;
+  FIO_MEM_FREE(udata, sizeof(fio___redis_test_srv_s));
+}
+
+/** Writes the reply to a single command (returns bytes written). */
+static size_t fio___redis_test_srv_reply(fio___redis_test_srv_s *s,
+                                         FIOBJ cmd,
+                                         char *out) {
+  fio_str_info_s verb = fiobj2cstr(fiobj_array_get(cmd, 0));
+  fio_str_info_s arg = fiobj2cstr(fiobj_array_get(cmd, 1));
+  size_t len = 0;
+  if (verb.len == 5 && !FIO_MEMCMP(verb.buf, "HELLO", 5)) {
+    if (s->commands)
+      ++fio___redis_test_cl.errors; /* HELLO must lead every connection */
+    FIO_MEMCPY(out, "%0\r\n", 4);
+    return 4;
+  }
+  if (s->commands++ == 1)
+    ++fio___redis_test_cl.busy;
+  if (verb.len > 1 && verb.buf[0] == 'X') {
+    s->streams |= (verb.len == 4) ? 1 : 2;
+    fio___redis_test_hs.shared += (s->streams == 3);
+    return fio___redis_test_srv_stream(cmd, out);
+  }
+  if (verb.len == 5 && !FIO_MEMCMP(verb.buf, "MULTI", 5)) {
+    s->in_multi = 1;
+    FIO_MEMCPY(out, "+OK\r\n", 5);
+    return 5;
+  }
+  if (verb.len == 4 && !FIO_MEMCMP(verb.buf, "EXEC", 4)) {
+    out[len++] = '*';
+    len += fio_ltoa(out + len, (int64_t)s->queued, 10);
+    out[len++] = '\r';
+    out[len++] = '\n';
+    FIO_MEMCPY(out + len, s->queued_replies, s->queued_len);
+    len += s->queued_len;
+    s->in_multi = 0;
+    s->queued = 0;
+    s->queued_len = 0;
+    return len;
+  }
+  char *dest = s->in_multi ? s->queued_replies + s->queued_len : out;
+  if (verb.len == 4 && !FIO_MEMCMP(verb.buf, "INCR", 4)) {
+    dest[len++] = ':';
+    len += fio_ltoa(dest + len, ++fio___redis_test_cl.counter, 10);
+  } else if (verb.len == 4 && !FIO_MEMCMP(verb.buf, "PING", 4)) {
+    ++fio___redis_test_cl.pings;
+    FIO_MEMCPY(dest, "+PONG", 5);
+    len = 5;
+  } else if (verb.len == 4 && !FIO_MEMCMP(verb.buf, "ECHO", 4)) {
+    dest[len++] = '$';
+    len += fio_ltoa(dest + len, (int64_t)arg.len, 10);
+    dest[len++] = '\r';
+    dest[len++] = '\n';
+    FIO_MEMCPY(dest + len, arg.buf, arg.len);
+    len += arg.len;
+  } else {
+    FIO_MEMCPY(dest, "-ERR unknown command", 20);
+    len = 20;
+  }
+  dest[len++] = '\r';
+  dest[len++] = '\n';
+  if (!s->in_multi)
+    return len;
+  ++s->queued;
+  s->queued_len += len;
+  FIO_MEMCPY(out, "+QUEUED\r\n", 9);
+  return 9;
+}
+
+static void fio___redis_test_srv_on_data(fio_io_s *io) {
+  fio___redis_test_srv_s *s = (fio___redis_test_srv_s *)fio_io_udata(io);
+  size_t r = fio_io_read(io, s->buf + s->len, sizeof(s->buf) - s->len);
+  if (!r)
+    return;
+  s->len += r;
+  size_t pos = 0, out = 0, batch = 0;
+  for (;;) {
+    fio_resp3_result_s result = fio_resp3_parse(&s->parser,
+                                                &FIO___REDIS_RESP3_CALLBACKS,
+                                                s->buf + pos,
+                                                s->len - pos);
+    FIO_ASSERT(!result.err, "in-test RESP server: bad command");
+    pos += result.consumed;
+    if (!result.obj)
+      break;
+    ++batch;
+    out += fio___redis_test_srv_reply(s,
+                                      (FIOBJ)result.obj,
+                                      fio___redis_test_srv_out + out);
+    fiobj_free((FIOBJ)result.obj);
+  }
+  if (batch > fio___redis_test_cl.max_batch)
+    fio___redis_test_cl.max_batch = batch;
+  s->len -= pos;
+  if (s->len)
+    FIO_MEMMOVE(s->buf, s->buf + pos, s->len);
+  if (out)
+    fio_io_write(io, fio___redis_test_srv_out, out);
+}
+
+static fio_io_protocol_s fio___redis_test_srv_protocol = {
+    .on_attach = fio___redis_test_srv_on_attach,
+    .on_data = fio___redis_test_srv_on_data,
+    .on_close = fio___redis_test_srv_on_close,
+};
+
+static void fio___redis_test_cl_done(void) {
+  if (fio___redis_test_cl.replies != FIO___REDIS_TEST_CL_COMMANDS ||
+      !fio___redis_test_cl.multi_ok || fio___redis_test_cl.parsed != 1)
+    return;
+  /* releasing the last reference from within a reply callback */
+  fio_redis_client_free(fio___redis_test_cl.client);
+  fio___redis_test_cl.client = NULL;
+  fio_io_stop();
+}
+
+static void fio___redis_test_cl_on_echo(fio_redis_client_s *c,
+                                        FIOBJ reply,
+                                        void *udata) {
+  char expect[32];
+  size_t len = fio_ltoa(expect, (int64_t)(uintptr_t)udata, 10);
+  fio_str_info_s got = fiobj2cstr(reply);
+  if (FIOBJ_TYPE(reply) != FIOBJ_T_STRING || got.len != len ||
+      FIO_MEMCMP(got.buf, expect, len))
+    ++fio___redis_test_cl.errors;
+  ++fio___redis_test_cl.replies;
+  fio___redis_test_cl_done();
+  (void)c;
+}
+
+static void fio___redis_test_cl_on_exec(fio_redis_client_s *c,
+                                        FIOBJ reply,
+                                        void *udata) {
+  (void)c, (void)udata;
+  if (FIOBJ_TYPE(reply) != FIOBJ_T_ARRAY || fiobj_array_count(reply) != 3) {
+    ++fio___redis_test_cl.errors;
+    return;
+  }
+  int64_t first = fiobj2i(fiobj_array_get(reply, 0));
+  fio___redis_test_cl.multi_ok =
+      (fiobj2i(fiobj_array_get(reply, 1)) == first + 1 &&
+       fiobj2i(fiobj_array_get(reply, 2)) == first + 2);
+  fio___redis_test_cl_done();
+}
+
+static void *fio___redis_test_cl_on_string(void *udata,
+                                           const void *data,
+                                           size_t len,
+                                           uint8_t type) {
+  (void)type;
+  if (len != 6 || FIO_MEMCMP(data, "direct", 6))
+    ++fio___redis_test_cl.errors;
+  return udata; /* the parsed "object" */
+}
+
+static const fio_resp3_callbacks_s fio___redis_test_cl_callbacks = {
+    .on_string = fio___redis_test_cl_on_string,
+};
+
+static void fio___redis_test_cl_on_parsed(fio_redis_client_s *c,
+                                          void *reply,
+                                          void *udata) {
+  (void)c;
+  if (reply != udata)
+    ++fio___redis_test_cl.errors;
+  ++fio___redis_test_cl.parsed;
+  fio___redis_test_cl_done();
+}
+
+static void fio___redis_test_cl_on_start(void *udata) {
+  (void)udata;
+  fio_redis_client_s *c = fio___redis_test_cl.client;
+  for (size_t i = 0; i < FIO___REDIS_TEST_CL_COMMANDS; ++i) {
+    char num[32];
+    size_t len = fio_ltoa(num, (int64_t)i, 10);
+    FIOBJ cmd = fiobj_array_new();
+    fiobj_array_push(cmd, fiobj_str_new_cstr("ECHO", 4));
+    fiobj_array_push(cmd, fiobj_str_new_cstr(num, len));
+    FIO_ASSERT(!fio_redis_client_send(c,
+                                      .cmd = cmd,
+                                      .on_reply = fio___redis_test_cl_on_echo,
+                                      .udata = (void *)(uintptr_t)i),
+               "fio_redis_client_send failed");
+    fiobj_free(cmd);
+  }
+
+  FIOBJ multi = fiobj_array_new();
+  for (size_t i = 0; i < 3; ++i) {
+    FIOBJ cmd = fiobj_array_new();
+    fiobj_array_push(cmd, fiobj_str_new_cstr("INCR", 4));
+    fiobj_array_push(cmd, fiobj_str_new_cstr("counter", 7));
+    fiobj_array_push(multi, cmd);
+  }
+  FIO_ASSERT(!fio_redis_client_send(c,
+                                    .multi = multi,
+                                    .on_reply = fio___redis_test_cl_on_exec),
+             "MULTI / EXEC send failed");
+  fiobj_free(multi);
+
+  FIOBJ cmd = fiobj_array_new();
+  fiobj_array_push(cmd, fiobj_str_new_cstr("ECHO", 4));
+  fiobj_array_push(cmd, fiobj_str_new_cstr("direct", 6));
+  FIO_ASSERT(!fio_redis_client_send(c,
+                                    .cmd = cmd,
+                                    .callbacks = &fio___redis_test_cl_callbacks,
+                                    .on_parsed = fio___redis_test_cl_on_parsed,
+                                    .udata = &fio___redis_test_cl),
+             "direct parsing send failed");
+  fiobj_free(cmd);
+  FIO_ASSERT(fio_redis_client_send(c, .cmd = FIOBJ_INVALID) == -1,
+             "sending a non-array command should fail");
+}
+
+static int fio___redis_test_cl_timeout(void *u1, void *u2) {
+  (void)u1, (void)u2;
+  if (!fio___redis_test_cl.client)
+    return -1;
+  FIO_ASSERT(0,
+             "pipelined client timed out (replies=%zu, multi=%d, parsed=%zu)",
+             fio___redis_test_cl.replies,
+             fio___redis_test_cl.multi_ok,
+             fio___redis_test_cl.parsed);
+  return -1;
+}
+
+static void fio___redis_test_cl_on_start_timer(void *udata) {
+  (void)udata;
+  fio_timer_free(fio_io_run_every(.fn = fio___redis_test_cl_timeout,
+                                  .every = 10000,
+                                  .repetitions = 1));
+}
+
+static void test_redis_client_pipeline(void) {
+  fprintf(stderr, "* Testing Redis pipelined command client...\n");
+  fio_io_listener_s *l = NULL;
+  unsigned port = 0;
+  for (int i = 0; i < 8 && !l; ++i) {
+    char url[64];
+    port = fio___redis_test_rof_free_port();
+    if (!port)
+      continue;
+    snprintf(url, sizeof(url), "tcp://127.0.0.1:%u", port);
+    l = fio_io_listen(.url = url,
+                      .protocol = &fio___redis_test_srv_protocol,
+                      .hide_from_log = 1);
+  }
+  FIO_ASSERT(l, "failed to bind the in-test RESP server");
+  char client_url[64];
+  snprintf(client_url, sizeof(client_url), "127.0.0.1:%u", port);
+
+  FIO_MEMSET(&fio___redis_test_cl, 0, sizeof(fio___redis_test_cl));
+  fio___redis_test_cl.client =
+      fio_redis_client_new(.url = client_url, .connections = 2, .pipeline = 64);
+  FIO_ASSERT(fio___redis_test_cl.client, "client allocation failed");
+  fio_state_callback_add(FIO_CALL_ON_START, fio___redis_test_cl_on_start, NULL);
+  fio_state_callback_add(FIO_CALL_ON_START,
+                         fio___redis_test_cl_on_start_timer,
+                         NULL);
+  fio_io_start(0);
+  fio_state_callback_remove(FIO_CALL_ON_START,
+                            fio___redis_test_cl_on_start,
+                            NULL);
+  fio_state_callback_remove(FIO_CALL_ON_START,
+                            fio___redis_test_cl_on_start_timer,
+                            NULL);
+  fio_io_listen_stop(l);
+
+  FIO_ASSERT(!fio___redis_test_cl.client,
+             "the client should have been released after the last reply");
+  FIO_ASSERT(!fio___redis_test_cl.errors,
+             "pipelined client errors: %zu",
+             fio___redis_test_cl.errors);
+  FIO_ASSERT(fio___redis_test_cl.accepted == 2 &&
+                 fio___redis_test_cl.busy == 2,
+             "both pooled connections should carry commands (%zu / %zu)",
+             fio___redis_test_cl.accepted,
+             fio___redis_test_cl.busy);
+  FIO_ASSERT(fio___redis_test_cl.max_batch > 1,
+             "commands should be pipelined (max batch %zu)",
+             fio___redis_test_cl.max_batch);
+}
+
+/* *****************************************************************************
+Per-Client Keepalive (in-test RESP server)
+***************************************************************************** */
+
+static fio_redis_client_s *fio___redis_test_ka[2];
+
+static void fio___redis_test_ka_on_start(void *udata) {
+  (void)udata;
+  /* connections open with the first command */
+  for (size_t i = 0; i < 2; ++i) {
+    FIOBJ cmd = fiobj_array_new();
+    fiobj_array_push(cmd, fiobj_str_new_cstr("ECHO", 4));
+    fiobj_array_push(cmd, fiobj_str_new_cstr("ka", 2));
+    FIO_ASSERT(!fio_redis_client_send(fio___redis_test_ka[i], .cmd = cmd),
+               "fio_redis_client_send failed");
+    fiobj_free(cmd);
+  }
+}
+
+static int fio___redis_test_ka_stop(void *u1, void *u2) {
+  (void)u1, (void)u2;
+  fio_redis_client_free(fio___redis_test_ka[0]);
+  fio_redis_client_free(fio___redis_test_ka[1]);
+  fio_io_stop();
+  return -1;
+}
+
+static void fio___redis_test_ka_on_start_timer(void *udata) {
+  (void)udata;
+  fio_timer_free(fio_io_run_every(.fn = fio___redis_test_ka_stop,
+                                  .every = 3500,
+                                  .repetitions = 1));
+}
+
+static void test_redis_client_ping_interval(void) {
+  fprintf(stderr, "* Testing Redis client per-client ping interval...\n");
+  fio_io_listener_s *l = NULL;
+  unsigned port = 0;
+  for (int i = 0; i < 8 && !l; ++i) {
+    char url[64];
+    port = fio___redis_test_rof_free_port();
+    if (!port)
+      continue;
+    snprintf(url, sizeof(url), "tcp://127.0.0.1:%u", port);
+    l = fio_io_listen(.url = url,
+                      .protocol = &fio___redis_test_srv_protocol,
+                      .hide_from_log = 1);
+  }
+  FIO_ASSERT(l, "failed to bind the in-test RESP server");
+  char client_url[64];
+  snprintf(client_url, sizeof(client_url), "127.0.0.1:%u", port);
+
+  FIO_MEMSET(&fio___redis_test_cl, 0, sizeof(fio___redis_test_cl));
+  /* a later client's interval must not change an earlier client's */
+  fio___redis_test_ka[0] =
+      fio_redis_client_new(.url = client_url, .ping_interval = 1);
+  fio___redis_test_ka[1] =
+      fio_redis_client_new(.url = client_url, .ping_interval = 255);
+  FIO_ASSERT(fio___redis_test_ka[0] && fio___redis_test_ka[1],
+             "client allocation failed");
+  fio_state_callback_add(FIO_CALL_ON_START, fio___redis_test_ka_on_start, NULL);
+  fio_state_callback_add(FIO_CALL_ON_START,
+                         fio___redis_test_ka_on_start_timer,
+                         NULL);
+  fio_io_start(0);
+  fio_state_callback_remove(FIO_CALL_ON_START,
+                            fio___redis_test_ka_on_start,
+                            NULL);
+  fio_state_callback_remove(FIO_CALL_ON_START,
+                            fio___redis_test_ka_on_start_timer,
+                            NULL);
+  fio_io_listen_stop(l);
+
+  FIO_ASSERT(!fio___redis_test_cl.errors,
+             "keepalive client errors: %zu",
+             fio___redis_test_cl.errors);
+  FIO_ASSERT(fio___redis_test_cl.pings,
+             "an idle client should PING after its own ping_interval");
+}
+
+/* *****************************************************************************
+Redis Streams History (in-test RESP server)
+***************************************************************************** */
+
+/* streamed to the replay (over FIO_RESP3_STREAM_THRESHOLD) */
+#define FIO___REDIS_TEST_HS_LARGE 6000
+/* the history's payload_limit - larger messages are skipped */
+#define FIO___REDIS_TEST_HS_LIMIT 8192
+
+static void fio___redis_test_hs_push(fio_pubsub_history_s const *h,
+                                     const char *channel,
+                                     int16_t filter,
+                                     uint64_t i) {
+  char buf[32];
+  size_t len = fio_ltoa(buf, (int64_t)i, 10);
+  fio_pubsub_msg_s msg = {
+      .timestamp = 1000 + i,
+      .id = 100 + i,
+      .channel = FIO_BUF_INFO2((char *)channel, strlen(channel)),
+      .message = FIO_BUF_INFO2(buf, len),
+      .filter = filter,
+  };
+  FIO_ASSERT(!h->push(h, &msg), "history push failed");
+}
+
+static void fio___redis_test_hs_on_message(fio_pubsub_msg_s *msg, void *u) {
+  if (msg->message.len == FIO___REDIS_TEST_HS_LARGE) {
+    ++fio___redis_test_hs.large;
+    for (size_t i = 0; i < msg->message.len; ++i)
+      fio___redis_test_hs.errors += (msg->message.buf[i] != 'x');
+    return;
+  }
+  /* messages 2..9 are expected, in order */
+  uint64_t i = 2 + fio___redis_test_hs.replayed++;
+  char buf[32];
+  size_t len = fio_ltoa(buf, (int64_t)i, 10);
+  if (u != &fio___redis_test_hs || msg->timestamp != 1000 + i ||
+      msg->id != 100 + i || msg->filter != 3 ||
+      !FIO_BUF_INFO_IS_EQ(msg->channel, FIO_BUF_INFO1((char *)"chan")) ||
+      !FIO_BUF_INFO_IS_EQ(msg->message, FIO_BUF_INFO2(buf, len)))
+    ++fio___redis_test_hs.errors;
+}
+
+static void fio___redis_test_hs_on_done(void *u) {
+  (void)u;
+  ++fio___redis_test_hs.done;
+  /* the replay still holds a client reference until this returns */
+  fio___redis_test_hs.hist->detached(fio___redis_test_hs.hist);
+  fio___redis_test_hs.hist = NULL;
+  fio_io_stop();
+}
+
+static void fio___redis_test_hs_on_start(void *ro_) {
+  fio_pubsub_history_s const *h = fio___redis_test_hs.hist;
+  fio_pubsub_history_s const *ro = (fio_pubsub_history_s const *)ro_;
+  for (uint64_t i = 0; i < 10; ++i) {
+    fio___redis_test_hs_push(h, "chan", 3, i);
+    if (i != 4)
+      continue;
+    /* a publisher clock ahead of ours - skipped, not the end of replay */
+    fio_pubsub_msg_s future = {
+        .timestamp = fio_io_last_tick() + 1000,
+        .channel = FIO_BUF_INFO1((char *)"chan"),
+        .message = FIO_BUF_INFO1((char *)"future"),
+        .filter = 3,
+    };
+    FIO_ASSERT(!h->push(h, &future), "history push failed");
+    /* a streamed message, and one that exceeds the payload_limit */
+    static char large[FIO___REDIS_TEST_HS_LIMIT + 1];
+    FIO_MEMSET(large, 'x', sizeof(large));
+    size_t sizes[] = {FIO___REDIS_TEST_HS_LARGE, sizeof(large)};
+    for (size_t j = 0; j < 2; ++j) {
+      fio_pubsub_msg_s msg = {
+          .timestamp = 1004,
+          .channel = FIO_BUF_INFO1((char *)"chan"),
+          .message = FIO_BUF_INFO2(large, sizes[j]),
+          .filter = 3,
+      };
+      FIO_ASSERT(!h->push(h, &msg), "history push failed");
+    }
+  }
+  fio___redis_test_hs_push(h, "chan", 0, 10);
+  fio___redis_test_hs_push(h, "other", 3, 11);
+  fio___redis_test_hs_push(ro, "chan", 3, 12); /* never stored */
+  FIO_ASSERT(h->oldest(h, FIO_BUF_INFO1((char *)"chan"), 3) == 0,
+             "Redis history should always offer to replay");
+  FIO_ASSERT(!h->replay(h,
+                        FIO_BUF_INFO1((char *)"chan"),
+                        3,
+                        1002,
+                        fio___redis_test_hs_on_message,
+                        fio___redis_test_hs_on_done,
+                        &fio___redis_test_hs),
+             "history replay failed");
+}
+
+static int fio___redis_test_hs_timeout(void *u1, void *u2) {
+  (void)u1, (void)u2;
+  if (fio___redis_test_hs.done)
+    return -1;
+  FIO_ASSERT(0,
+             "Redis history replay timed out (replayed=%zu)",
+             fio___redis_test_hs.replayed);
+  return -1;
+}
+
+static void fio___redis_test_hs_on_start_timer(void *udata) {
+  (void)udata;
+  fio_timer_free(fio_io_run_every(.fn = fio___redis_test_hs_timeout,
+                                  .every = 10000,
+                                  .repetitions = 1));
+}
+
+static void test_redis_history_streams(void) {
+  fprintf(stderr, "* Testing Redis Streams pub/sub history...\n");
+  fio_io_listener_s *l = NULL;
+  unsigned port = 0;
+  for (int i = 0; i < 8 && !l; ++i) {
+    char url[64];
+    port = fio___redis_test_rof_free_port();
+    if (!port)
+      continue;
+    snprintf(url, sizeof(url), "tcp://127.0.0.1:%u", port);
+    l = fio_io_listen(.url = url,
+                      .protocol = &fio___redis_test_srv_protocol,
+                      .hide_from_log = 1);
+  }
+  FIO_ASSERT(l, "failed to bind the in-test RESP server");
+  char url[64];
+  snprintf(url, sizeof(url), "127.0.0.1:%u", port);
+
+  FIO_MEMSET(&fio___redis_test_hs, 0, sizeof(fio___redis_test_hs));
+  fio___redis_test_hs.hist =
+      fio_redis_history_new(.url = url,
+                            .prefix = "test:",
+                            .page = 3,
+                            .payload_limit = FIO___REDIS_TEST_HS_LIMIT);
+  fio_pubsub_history_s const *ro =
+      fio_redis_history_new(.url = url, .prefix = "test:", .read_only = 1);
+  FIO_ASSERT(fio___redis_test_hs.hist && ro, "history allocation failed");
+  fio_state_callback_add(FIO_CALL_ON_START,
+                         fio___redis_test_hs_on_start,
+                         (void *)ro);
+  fio_state_callback_add(FIO_CALL_ON_START,
+                         fio___redis_test_hs_on_start_timer,
+                         NULL);
+  fio_io_start(0);
+  fio_state_callback_remove(FIO_CALL_ON_START,
+                            fio___redis_test_hs_on_start,
+                            (void *)ro);
+  fio_state_callback_remove(FIO_CALL_ON_START,
+                            fio___redis_test_hs_on_start_timer,
+                            NULL);
+  fio_io_listen_stop(l);
+  ro->detached(ro);
+
+  FIOBJ streams = fio___redis_test_hs.streams;
+  FIO_ASSERT(fiobj_hash_count(streams) == 3,
+             "messages should be stored per channel and filter (%zu streams)",
+             (size_t)fiobj_hash_count(streams));
+  FIO_ASSERT(fiobj_array_count(fiobj_hash_get2(streams, "test:3:chan", 11)) ==
+                 13,
+             "the read-only manager should not store messages");
+  FIO_ASSERT(fiobj_hash_get2(streams, "test:0:chan", 11) &&
+                 fiobj_hash_get2(streams, "test:3:other", 12),
+             "stream keys should be <prefix><filter>:<channel>");
+  FIO_ASSERT(!fio___redis_test_hs.errors,
+             "replayed messages should match the stored messages");
+  FIO_ASSERT(fio___redis_test_hs.done == 1 &&
+                 fio___redis_test_hs.replayed == 8,
+             "replay should deliver 8 messages and finish once (%zu / %zu)",
+             fio___redis_test_hs.replayed,
+             fio___redis_test_hs.done);
+  FIO_ASSERT(fio___redis_test_hs.large == 1,
+             "a streamed message should be replayed once, an oversized "
+             "message skipped (%zu replayed)",
+             fio___redis_test_hs.large);
+  FIO_ASSERT(!fio___redis_test_hs.shared,
+             "replay should not share the XADD connection");
+  FIO_ASSERT(fio___redis_test_hs.ranges == 5,
+             "replay should page through the stream (%zu XRANGE requests)",
+             fio___redis_test_hs.ranges);
+  fiobj_free(streams);
+}
+
 int main(void) {
   test_fiobj_command_to_resp();
   test_primitive_to_resp();
@@ -1964,6 +2626,9 @@ int main(void) {
   test_push_capture_max_batch();
   test_redis_destroy_while_connecting();
   test_redis_reconnect_on_drop();
+  test_redis_client_pipeline();
+  test_redis_client_ping_interval();
+  test_redis_history_streams();
   test_redis_live_server();
   return 0;
 }
@@ -2,7 +2,7 @@
 Test - Socket helpers (004 sock.h)
 
 Correctness coverage for fio_sock_open, fio_sock_open2, fio_sock_accept,
-fio_sock_read/write, fio_sock_dup, fio_sock_set_non_block, fio_sock_wait_io,
+fio_sock_read/write/writev, fio_sock_sendfile, fio_sock_dup, fio_sock_set_non_block, fio_sock_wait_io,
 fio_sock_socketpair, fio_sock_peer_addr, and fio_sock_maximize_limits.
 
 All roundtrips use in-process loopback or socketpair; no external processes.
@@ -219,6 +219,82 @@ static void test_sock_socketpair(void) {
   fprintf(stderr, "* fio_sock_socketpair: OK\n");
 }
 
+#if defined(__linux__) && defined(SPLICE_F_MOVE)
+typedef struct {
+  fio_socket_i fd;
+  int file;
+  int pipe_fd[2];
+  ssize_t sent;
+} fio___test_sock_splice_s;
+
+static void *fio___test_sock_splice_thread(void *arg) {
+  fio___test_sock_splice_s *t = (fio___test_sock_splice_s *)arg;
+  t->sent = fio___sock_splice(t->fd, t->file, 0, 8);
+  t->pipe_fd[0] = fio___sock_splice_pipe[0];
+  t->pipe_fd[1] = fio___sock_splice_pipe[1];
+  return NULL;
+}
+#endif
+
+static void test_sock_writev_sendfile(void) {
+  fio_socket_i fds[2] = {FIO_SOCKET_INVALID, FIO_SOCKET_INVALID};
+  FIO_ASSERT(!fio_sock_socketpair(fds), "fio_sock_socketpair failed");
+  char buf[64] = {0};
+
+  fio_buf_info_s vec[3] = {FIO_BUF_INFO1((char *)"Hello"),
+                           FIO_BUF_INFO1((char *)", "),
+                           FIO_BUF_INFO1((char *)"World")};
+  FIO_ASSERT(fio_sock_writev(fds[1], vec, 3) == 12,
+             "fio_sock_writev should write all buffers");
+  FIO_ASSERT(fio_sock_read(fds[0], buf, 12) == 12 &&
+                 !memcmp(buf, "Hello, World", 12),
+             "fio_sock_writev payload mismatch");
+
+  int file = open(__FILE__, O_RDONLY);
+  FIO_ASSERT(file != -1, "failed to open %s", __FILE__);
+  const ssize_t sent = fio_sock_sendfile(fds[1], file, 3, 20);
+#if defined(__linux__)
+  char expected[20];
+  FIO_ASSERT(sent == 20, "fio_sock_sendfile failed: %s", strerror(errno));
+  FIO_ASSERT(fio_sock_read(fds[0], buf, 20) == 20, "sendfile read failed");
+  FIO_ASSERT(pread(file, expected, 20, 3) == 20 && !memcmp(buf, expected, 20),
+             "fio_sock_sendfile payload mismatch");
+  FIO_ASSERT(lseek(file, 0, SEEK_CUR) == 0,
+             "fio_sock_sendfile must not move the file position");
+#if defined(SPLICE_F_MOVE)
+  /* the `splice` fallback (used when `sendfile` rejects the file) */
+  FIO_ASSERT(fio___sock_splice(fds[1], file, 3, 20) == 20,
+             "splice fallback failed: %s",
+             strerror(errno));
+  FIO_ASSERT(fio_sock_read(fds[0], buf, 20) == 20 &&
+                 !memcmp(buf, expected, 20),
+             "splice fallback payload mismatch");
+  /* a thread's `splice` pipe is closed when the thread exits */
+  {
+    fio___test_sock_splice_s t = {.fd = fds[1], .file = file};
+    pthread_t thread;
+    FIO_ASSERT(
+        !pthread_create(&thread, NULL, fio___test_sock_splice_thread, &t),
+        "pthread_create failed");
+    pthread_join(thread, NULL);
+    FIO_ASSERT(t.sent == 8 && fio_sock_read(fds[0], buf, 8) == 8,
+               "splice fallback failed on a thread");
+    FIO_ASSERT(t.pipe_fd[0] != -1 && fcntl(t.pipe_fd[0], F_GETFD) == -1 &&
+                   fcntl(t.pipe_fd[1], F_GETFD) == -1,
+               "splice pipe should be closed when its thread exits");
+  }
+#endif
+#else
+  FIO_ASSERT(sent == -1 && errno == ENOTSUP,
+             "fio_sock_sendfile should report ENOTSUP (%zd)",
+             sent);
+#endif
+  close(file);
+  fio_sock_close(fds[0]);
+  fio_sock_close(fds[1]);
+  fprintf(stderr, "* fio_sock_writev / fio_sock_sendfile: OK\n");
+}
+
 static void test_sock_udp(void) {
   fio_socket_i srv =
       fio_sock_open("127.0.0.1", "0", FIO_SOCK_UDP | FIO_SOCK_SERVER);
@@ -319,6 +395,7 @@ int main(void) {
   test_sock_dup();
   test_sock_nonblock();
   test_sock_socketpair();
+  test_sock_writev_sendfile();
   test_sock_udp();
   test_sock_unix();
   test_sock_maximize_limits();
@@ -1,8 +1,8 @@
 /* *****************************************************************************
 Test - Stream buffering module (102 stream.h)
 
-Correctness coverage for fio_stream_init/destroy/add/read/advance/length/any
-and packing helpers (fio_stream_pack_data / fio_stream_pack_fd).
+Correctness coverage for fio_stream_init/destroy/add/read/read_vec/read_fd/
+advance/length/any and packing helpers (fio_stream_pack_data / fio_stream_pack_fd).
 ***************************************************************************** */
 #include "test-helpers.h"
 
@@ -198,6 +198,75 @@ static void test_stream_file_packet(void) {
   fprintf(stderr, "* file descriptor packet: OK\n");
 }
 
+static void test_stream_read_vec(void) {
+  static char str[256];
+  for (size_t i = 0; i < sizeof(str); ++i)
+    str[i] = (char)('0' + (i % 64));
+  fio_stream_s s = FIO_STREAM_INIT(s);
+  fio_buf_info_s vec[4];
+
+  FIO_ASSERT(!fio_stream_read_vec(&s, vec, 4),
+             "fio_stream_read_vec should return 0 for an empty stream");
+  /* copied, referenced (long enough to skip the copy) and copied again */
+  fio_stream_add(&s, fio_stream_pack_data(str, 10, 0, 1, NULL));
+  fio_stream_add(&s, fio_stream_pack_data(str, 200, 10, 0, NULL));
+  fio_stream_add(&s, fio_stream_pack_data(str, 5, 210, 1, NULL));
+
+  int fd = open(__FILE__, O_RDONLY);
+  FIO_ASSERT(fd >= 0, "failed to open %s", __FILE__);
+  fio_stream_add(&s, fio_stream_pack_fd(fd, 20, 0, 0));
+  fio_stream_add(&s, fio_stream_pack_data(str, 3, 0, 1, NULL));
+
+  size_t count = fio_stream_read_vec(&s, vec, 4);
+  FIO_ASSERT(count == 3,
+             "fio_stream_read_vec should stop at a file packet (%zu)",
+             count);
+  FIO_ASSERT(vec[0].len == 10 && vec[1].len == 200 && vec[2].len == 5,
+             "fio_stream_read_vec lengths error (%zu, %zu, %zu)",
+             vec[0].len,
+             vec[1].len,
+             vec[2].len);
+  FIO_ASSERT(vec[1].buf == str + 10,
+             "external packets should be gathered by reference");
+  FIO_ASSERT(!memcmp(vec[0].buf, str, 10) && !memcmp(vec[2].buf, str + 210, 5),
+             "fio_stream_read_vec data error");
+  FIO_ASSERT(fio_stream_read_vec(&s, vec, 1) == 1,
+             "fio_stream_read_vec should honor `count`");
+
+  /* a partial advance offsets the first buffer */
+  fio_stream_advance(&s, 14);
+  count = fio_stream_read_vec(&s, vec, 4);
+  FIO_ASSERT(count == 2 && vec[0].len == 196 && vec[0].buf == str + 14,
+             "fio_stream_read_vec offset error (%zu, %zu)",
+             count,
+             vec[0].len);
+
+  int rfd = -1;
+  size_t roffset = 0, rlen = 0;
+  FIO_ASSERT(fio_stream_read_fd(&s, &rfd, &roffset, &rlen) == -1,
+             "fio_stream_read_fd should fail for a memory packet");
+  fio_stream_advance(&s, 201);
+  FIO_ASSERT(!fio_stream_read_vec(&s, vec, 4),
+             "fio_stream_read_vec should return 0 at a file packet");
+  FIO_ASSERT(!fio_stream_read_fd(&s, &rfd, &roffset, &rlen) && rfd == fd &&
+                 roffset == 0 && rlen == 20,
+             "fio_stream_read_fd error (%d, %zu, %zu)",
+             rfd,
+             roffset,
+             rlen);
+  fio_stream_advance(&s, 5);
+  FIO_ASSERT(!fio_stream_read_fd(&s, &rfd, &roffset, &rlen) && roffset == 5 &&
+                 rlen == 15,
+             "fio_stream_read_fd should honor partial consumption");
+  fio_stream_advance(&s, 15);
+  count = fio_stream_read_vec(&s, vec, 4);
+  FIO_ASSERT(count == 1 && vec[0].len == 3 && !memcmp(vec[0].buf, str, 3),
+             "fio_stream_read_vec should resume after the file packet");
+
+  fio_stream_destroy(&s);
+  fprintf(stderr, "* gather read (read_vec): OK\n");
+}
+
 static void test_stream_pack_free(void) {
   const char *const str = "unused packet";
   size_t expect_dealloc = FIO_NAME_TEST(stl, stream___noop_dealloc_count);
@@ -222,6 +291,7 @@ int main(void) {
   test_stream_external_reference();
   test_stream_partial_read_and_advance();
   test_stream_file_packet();
+  test_stream_read_vec();
   test_stream_pack_free();
   return 0;
 }
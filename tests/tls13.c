@@ -4,9 +4,9 @@ Test for fio-stl/190 tls13.h and fio-stl/405 tls13.h — TLS 1.3 correctness
 Coverage: key schedule derivation, handshake message parsing/building,
 client/server in-memory handshake roundtrip, ALPN negotiation, client
 certificate authentication, KeyUpdate key rotation, large application-data
-transfer, and TLS I/O function registration.  Crypto algorithm vectors are
-intentionally omitted (those live in sha.c, aes.c, chacha.c, rsa.c, x509.c,
-ed25519.c, p256.c, p384.c, hkdf.c).
+transfer, session resumption (tickets and PSK binders) and TLS I/O function
+registration.  Crypto algorithm vectors are intentionally omitted (those live
+in sha.c, aes.c, chacha.c, rsa.c, x509.c, ed25519.c, p256.c, p384.c, hkdf.c).
 ***************************************************************************** */
 #include "test-helpers.h"
 
@@ -471,6 +471,20 @@ FIO_SFUNC int tls13_test_run_handshake(fio_tls13_client_s *client,
 
     if (fio_tls13_client_is_connected(client) &&
         fio_tls13_server_is_connected(server)) {
+      /* post-handshake records (NewSessionTicket) sent with server Finished */
+      for (size_t pos = 0; pos + 5 <= server_out_len;) {
+        uint8_t plain[1024];
+        size_t rec_len = 5 + (((size_t)server_out[pos + 3] << 8) |
+                              (size_t)server_out[pos + 4]);
+        if (pos + rec_len > server_out_len ||
+            fio_tls13_client_decrypt(client,
+                                     plain,
+                                     sizeof(plain),
+                                     server_out + pos,
+                                     rec_len) < 0)
+          return 0;
+        pos += rec_len;
+      }
       return 1;
     }
   }
@@ -616,6 +630,165 @@ FIO_SFUNC void test_tls13_app_data(void) {
   fio_x509_keypair_clear(&server_kp);
 }
 
+/* *****************************************************************************
+Session resumption (session tickets)
+***************************************************************************** */
+FIO_SFUNC void tls13_test_receive_ticket(fio_tls13_client_s *client,
+                                         fio_tls13_server_s *server) {
+  uint8_t record[1024];
+  uint8_t plain[1024];
+  int len = fio_tls13_server_send_ticket(server, record, sizeof(record));
+  FIO_ASSERT(len > 0, "server failed to send a session ticket");
+  FIO_ASSERT(fio_tls13_client_decrypt(client,
+                                      plain,
+                                      sizeof(plain),
+                                      record,
+                                      (size_t)len) == 0,
+             "NewSessionTicket should not produce application data");
+  FIO_ASSERT(fio_tls13_client_ticket_get(client),
+             "client did not store the session ticket");
+}
+
+FIO_SFUNC void test_tls13_resumption(void) {
+  uint8_t *server_cert = NULL;
+  size_t server_cert_len = 0;
+  fio_x509_keypair_s server_kp;
+  fio_tls13_server_s server;
+  fio_ubuf_info_s server_chain[1];
+  fio_tls13_ticket_keys_s keys, other_keys;
+  fio_tls13_ticket_s ticket;
+  fio_tls13_client_s client;
+  fio_tls13_ticket_keys_init(&keys, NULL, 0, 0);
+  fio_tls13_ticket_keys_init(&other_keys, "other secret", 12, 0);
+
+  /* full handshake, receive a ticket */
+  tls13_test_init_server(&server, &server_cert, &server_cert_len, &server_kp, server_chain);
+  fio_tls13_server_ticket_keys_set(&server, &keys);
+  fio_tls13_client_init(&client, "localhost");
+  fio_tls13_client_skip_verification(&client, 1);
+  FIO_ASSERT(!fio_tls13_client_ticket_get(&client),
+             "client shouldn't have a ticket before connecting");
+  FIO_ASSERT(tls13_test_run_handshake(&client, &server, 0, NULL, NULL, 0),
+             "initial handshake failed");
+  FIO_ASSERT(!fio_tls13_client_is_resumed(&client) &&
+                 !fio_tls13_server_is_resumed(&server),
+             "initial handshake shouldn't be resumed");
+  tls13_test_receive_ticket(&client, &server);
+  ticket = *fio_tls13_client_ticket_get(&client);
+  FIO_ASSERT(fio_tls13_ticket_is_valid(&ticket), "ticket should be valid");
+  fio_tls13_client_destroy(&client);
+  fio_tls13_server_destroy(&server);
+
+  /* resumed handshake (no certificate messages), then application data */
+  tls13_test_init_server(&server, &server_cert, &server_cert_len, &server_kp, server_chain);
+  fio_tls13_server_ticket_keys_set(&server, &keys);
+  fio_tls13_client_init(&client, "localhost");
+  fio_tls13_client_skip_verification(&client, 1);
+  fio_tls13_client_ticket_set(&client, &ticket);
+  FIO_ASSERT(tls13_test_run_handshake(&client, &server, 0, NULL, NULL, 0),
+             "resumed handshake failed");
+  FIO_ASSERT(fio_tls13_client_is_resumed(&client),
+             "client handshake wasn't resumed");
+  FIO_ASSERT(fio_tls13_server_is_resumed(&server),
+             "server handshake wasn't resumed");
+  {
+    uint8_t msg[] = "resumed application data";
+    uint8_t ct[128];
+    uint8_t pt[128];
+    int ct_len =
+        fio_tls13_client_encrypt(&client, ct, sizeof(ct), msg, sizeof(msg));
+    FIO_ASSERT(ct_len > 0, "client encrypt failed (resumed)");
+    FIO_ASSERT(fio_tls13_server_decrypt(&server,
+                                        pt,
+                                        sizeof(pt),
+                                        ct,
+                                        (size_t)ct_len) == (int)sizeof(msg) &&
+                   !FIO_MEMCMP(pt, msg, sizeof(msg)),
+               "server decrypt failed (resumed)");
+  }
+  /* a resumed session issues a fresh ticket */
+  tls13_test_receive_ticket(&client, &server);
+  FIO_ASSERT(FIO_MEMCMP(fio_tls13_client_ticket_get(&client)->ticket,
+                        ticket.ticket,
+                        ticket.len),
+             "a new ticket should differ from the previous one");
+  fio_tls13_client_destroy(&client);
+  fio_tls13_server_destroy(&server);
+
+  /* a ticket sealed with other keys falls back to a full handshake */
+  tls13_test_init_server(&server, &server_cert, &server_cert_len, &server_kp, server_chain);
+  fio_tls13_server_ticket_keys_set(&server, &other_keys);
+  fio_tls13_client_init(&client, "localhost");
+  fio_tls13_client_skip_verification(&client, 1);
+  fio_tls13_client_ticket_set(&client, &ticket);
+  FIO_ASSERT(tls13_test_run_handshake(&client, &server, 0, NULL, NULL, 0),
+             "fallback handshake (unknown ticket) failed");
+  FIO_ASSERT(!fio_tls13_client_is_resumed(&client) &&
+                 !fio_tls13_server_is_resumed(&server),
+             "unknown ticket shouldn't resume");
+  fio_tls13_client_destroy(&client);
+  fio_tls13_server_destroy(&server);
+
+  /* a ticket for a different server name falls back to a full handshake */
+  tls13_test_init_server(&server, &server_cert, &server_cert_len, &server_kp, server_chain);
+  fio_tls13_server_ticket_keys_set(&server, &keys);
+  fio_tls13_client_init(&client, "example.com");
+  fio_tls13_client_skip_verification(&client, 1);
+  fio_tls13_client_ticket_set(&client, &ticket);
+  FIO_ASSERT(tls13_test_run_handshake(&client, &server, 0, NULL, NULL, 0),
+             "fallback handshake (server name) failed");
+  FIO_ASSERT(!fio_tls13_server_is_resumed(&server),
+             "ticket shouldn't resume for a different server name");
+  fio_tls13_client_destroy(&client);
+  fio_tls13_server_destroy(&server);
+
+  /* a ticket from an unverified session isn't offered when verifying */
+  tls13_test_init_server(&server, &server_cert, &server_cert_len, &server_kp, server_chain);
+  fio_tls13_server_ticket_keys_set(&server, &keys);
+  fio_tls13_client_init(&client, "localhost");
+  fio_tls13_client_ticket_set(&client, &ticket);
+  {
+    uint8_t ch[4096];
+    int ch_len = fio_tls13_client_start(&client, ch, sizeof(ch));
+    FIO_ASSERT(ch_len > 0, "client start failed");
+    FIO_ASSERT(!client.resume.offered,
+               "unverified ticket offered by a verifying client");
+  }
+  fio_tls13_client_destroy(&client);
+  fio_tls13_server_destroy(&server);
+
+  /* a bad binder is a fatal decrypt_error */
+  tls13_test_init_server(&server, &server_cert, &server_cert_len, &server_kp, server_chain);
+  fio_tls13_server_ticket_keys_set(&server, &keys);
+  fio_tls13_client_init(&client, "localhost");
+  fio_tls13_client_skip_verification(&client, 1);
+  fio_tls13_client_ticket_set(&client, &ticket);
+  {
+    uint8_t ch[4096];
+    uint8_t out[8192];
+    size_t out_len = 0;
+    int ch_len = fio_tls13_client_start(&client, ch, sizeof(ch));
+    FIO_ASSERT(ch_len > 0 && client.resume.offered, "ticket not offered");
+    ch[ch_len - 1] ^= 1; /* the binder is the last field of the ClientHello */
+    FIO_ASSERT(fio_tls13_server_process(&server,
+                                        ch,
+                                        (size_t)ch_len,
+                                        out,
+                                        sizeof(out),
+                                        &out_len) <= 0,
+               "server accepted a bad PSK binder");
+    FIO_ASSERT(server.alert_description == FIO_TLS13_ALERT_DECRYPT_ERROR,
+               "bad binder should raise decrypt_error (%d)",
+               server.alert_description);
+  }
+  fio_tls13_client_destroy(&client);
+  fio_tls13_server_destroy(&server);
+
+  tls13_test_free(server_cert, server_cert_len);
+  fio_x509_keypair_clear(&server_kp);
+  fio_secure_zero(&ticket, sizeof(ticket));
+}
+
 FIO_SFUNC void test_tls13_large_transfer(void) {
   uint8_t *server_cert = NULL;
   size_t server_cert_len = 0;
@@ -990,6 +1163,161 @@ FIO_SFUNC void test_tls13_peer_info_next(void) {
   fio_x509_keypair_clear(&kp2);
 }
 
+/* *****************************************************************************
+IO round trip with worker thread encryption (`fio_tls13_io_async`)
+
+Connections are spread over several IO reactors, each batching its own writes.
+***************************************************************************** */
+
+#define TLS13_TEST_ASYNC_URL      "tcp://127.0.0.1:19882"
+#define TLS13_TEST_ASYNC_CLIENTS  8
+#define TLS13_TEST_ASYNC_REACTORS 4
+#define TLS13_TEST_ASYNC_LEN      (1UL << 18)
+
+static uint8_t tls13_test_async_payload[TLS13_TEST_ASYNC_LEN];
+static struct {
+  size_t done;
+  size_t errors;
+  int timed_out;
+} tls13_test_async;
+
+/* the server sends the payload and closes (sealing may still be running) */
+FIO_SFUNC void tls13_test_async_server_on_data(fio_io_s *io) {
+  char buf[64];
+  if (!fio_io_read(io, buf, sizeof(buf)) || fio_io_udata(io))
+    return;
+  fio_io_udata_set(io, (void *)(uintptr_t)1);
+  for (size_t i = 0; i < TLS13_TEST_ASYNC_LEN; i += 4096)
+    fio_io_write2(io, .buf = tls13_test_async_payload + i, .len = 4096);
+  fio_io_close(io);
+}
+
+FIO_SFUNC void tls13_test_async_client_on_attach(fio_io_s *io) {
+  fio_io_write(io, "go", 2);
+}
+
+FIO_SFUNC void tls13_test_async_client_on_data(fio_io_s *io) {
+  size_t *received = (size_t *)fio_io_udata(io);
+  uint8_t buf[16384];
+  size_t r;
+  while ((r = fio_io_read(io, buf, sizeof(buf)))) {
+    if (*received + r > TLS13_TEST_ASYNC_LEN ||
+        FIO_MEMCMP(buf, tls13_test_async_payload + *received, r)) {
+      fio_atomic_add(&tls13_test_async.errors, 1);
+      fio_io_close(io);
+      return;
+    }
+    *received += r;
+  }
+}
+
+/* every byte must arrive before the connection closes */
+FIO_SFUNC void tls13_test_async_client_on_close(void *buf, void *udata) {
+  size_t *received = (size_t *)udata;
+  if (*received != TLS13_TEST_ASYNC_LEN)
+    fio_atomic_add(&tls13_test_async.errors, 1);
+  FIO_MEM_FREE(received, sizeof(*received));
+  if (fio_atomic_add(&tls13_test_async.done, 1) + 1 ==
+      TLS13_TEST_ASYNC_CLIENTS)
+    fio_io_stop();
+  (void)buf;
+}
+
+FIO_SFUNC void tls13_test_async_client_on_failed(fio_io_protocol_s *pr,
+                                                 void *udata) {
+  fio_atomic_add(&tls13_test_async.errors, 1);
+  tls13_test_async_client_on_close(NULL, udata);
+  (void)pr;
+}
+
+static fio_io_protocol_s tls13_test_async_server_protocol = {
+    .on_data = tls13_test_async_server_on_data,
+    .on_timeout = fio_io_touch,
+};
+
+static fio_io_protocol_s tls13_test_async_client_protocol = {
+    .on_attach = tls13_test_async_client_on_attach,
+    .on_data = tls13_test_async_client_on_data,
+    .on_close = tls13_test_async_client_on_close,
+    .on_timeout = fio_io_touch,
+};
+
+FIO_SFUNC int tls13_test_async_connect(void *tls_, void *ignr_) {
+  for (size_t i = 0; i < TLS13_TEST_ASYNC_CLIENTS; ++i) {
+    size_t *received = (size_t *)FIO_MEM_REALLOC(NULL, 0, sizeof(size_t), 0);
+    FIO_ASSERT_ALLOC(received);
+    *received = 0;
+    fio_io_connect(TLS13_TEST_ASYNC_URL,
+                   .protocol = &tls13_test_async_client_protocol,
+                   .on_failed = tls13_test_async_client_on_failed,
+                   .udata = received,
+                   .tls = (fio_io_tls_s *)tls_);
+  }
+  return -1;
+  (void)ignr_;
+}
+
+FIO_SFUNC int tls13_test_async_timeout(void *ignr1_, void *ignr2_) {
+  tls13_test_async.timed_out = 1;
+  fio_io_stop();
+  return -1;
+  (void)ignr1_, (void)ignr2_;
+}
+
+FIO_SFUNC void test_tls13_io_async_roundtrip(void) {
+#if !FIO_OS_POSIX
+  FIO_LOG_INFO("TLS 1.3 worker thread encryption test skipped (POSIX only)");
+  return;
+#else
+  const int log_level = FIO_LOG_LEVEL;
+  fio_io_functions_s funcs = fio_tls13_io_functions();
+  tls13_test_async_server_protocol.io_functions = funcs;
+  tls13_test_async_client_protocol.io_functions = funcs;
+  for (size_t i = 0; i < TLS13_TEST_ASYNC_LEN; ++i)
+    tls13_test_async_payload[i] = (uint8_t)((i * 7) ^ (i >> 10));
+  /* clients skip verifying the self-signed certificate, silence the notices */
+  if (FIO_LOG_LEVEL == FIO_LOG_LEVEL_INFO)
+    FIO_LOG_LEVEL = FIO_LOG_LEVEL_WARNING;
+  fio_tls13_io_async(2);
+
+  fio_io_tls_s *server_tls = fio_io_tls_new();
+  fio_io_tls_s *client_tls = fio_io_tls_new();
+  FIO_ASSERT_ALLOC(server_tls && client_tls);
+  fio_io_tls_cert_add(server_tls, "localhost", NULL, NULL, NULL);
+  fio_io_listener_s *l =
+      fio_io_listen(.url = TLS13_TEST_ASYNC_URL,
+                    .protocol = &tls13_test_async_server_protocol,
+                    .tls = server_tls,
+                    .hide_from_log = 1);
+  fio_io_tls_free(server_tls);
+  FIO_ASSERT(l, "fio_io_listen failed for %s", TLS13_TEST_ASYNC_URL);
+  fio_timer_free(fio_io_run_every(.fn = tls13_test_async_connect,
+                                  .udata1 = client_tls,
+                                  .every = 10,
+                                  .repetitions = 1));
+  fio_timer_free(fio_io_run_every(.fn = tls13_test_async_timeout,
+                                  .every = 60000,
+                                  .repetitions = 1));
+  fio_io_reactors_set(TLS13_TEST_ASYNC_REACTORS);
+  fio_io_start(0);
+  fio_io_listen_stop(l);
+  fio_queue_perform_all(fio_io_queue());
+  fio_io_reactors_set(1);
+  fio_io_tls_free(client_tls);
+  fio_tls13_io_async(0);
+  FIO_LOG_LEVEL = log_level;
+
+  FIO_ASSERT(!tls13_test_async.timed_out,
+             "worker thread encryption round trip timed out (%zu/%d)",
+             tls13_test_async.done,
+             TLS13_TEST_ASYNC_CLIENTS);
+  FIO_ASSERT(!tls13_test_async.errors,
+             "every byte should arrive, in order, before close_notify "
+             "(%zu errors)",
+             tls13_test_async.errors);
+#endif
+}
+
 /* *****************************************************************************
 Main
 ***************************************************************************** */
@@ -1005,8 +1333,10 @@ int main(void) {
   test_tls13_client_verifies_server();
   test_tls13_app_data();
   test_tls13_large_transfer();
+  test_tls13_resumption();
   test_tls13_context_overhead();
   test_tls13_io_functions();
   test_tls13_peer_info_next();
+  test_tls13_io_async_roundtrip();
   return 0;
 }